@@ -431,6 +431,11 @@ zbx_graph_yaxis_types_t;
 #define ZBX_HOUSEKEEPER_EXECUTE	"housekeeper_execute"
 #define ZBX_LOG_LEVEL_INCREASE	"log_level_increase"
 #define ZBX_LOG_LEVEL_DECREASE	"log_level_decrease"
+#define ZBX_DIAGINFO		"diaginfo"
+
+/* diagnostic information sections */
+#define ZBX_DIAGINFO_VALUECACHE		"valuecache"
+#define ZBX_DIAGINFO_PREPROCESSING	"preprocessing"
 
 /* value for not supported items */
 #define ZBX_NOTSUPPORTED	"ZBX_NOTSUPPORTED"
@@ -899,6 +904,12 @@ zbx_task_t;
 #define ZBX_RTC_LOG_LEVEL_DECREASE	2
 #define ZBX_RTC_HOUSEKEEPER_EXECUTE	3
 #define ZBX_RTC_CONFIG_CACHE_RELOAD	8
+#define ZBX_RTC_DIAGINFO		10
+
+/* diagnostic information section flags, passed as runtime control message data */
+#define ZBX_DIAGINFO_SECTION_VALUECACHE		0x0001
+#define ZBX_DIAGINFO_SECTION_PREPROCESSING	0x0002
+#define ZBX_DIAGINFO_SECTION_ALL		0xffff
 
 typedef enum
 {
@@ -1476,6 +1487,9 @@ int	zbx_strmatch_condition(const char *value, const char *pattern, unsigned char
 #define ZBX_PREPROC_PROMETHEUS_TO_JSON		23
 #define ZBX_PREPROC_CSV_TO_JSON			24
 
+/* the upper limit of preprocessing step types, used to size per step type arrays */
+#define ZBX_PREPROC_TYPE_MAX			25
+
 /* custom on fail actions */
 #define ZBX_PREPROC_FAIL_DEFAULT	0
 #define ZBX_PREPROC_FAIL_DISCARD_VALUE	1
@@ -165,6 +165,7 @@ typedef struct
 	unsigned char		verify_peer;
 	unsigned char		verify_host;
 	unsigned char		allow_traps;
+	unsigned char		preprocessing;	/* ZBX_ITEM_PREPROCESSING_* */
 	char			key_orig[ITEM_KEY_LEN * ZBX_MAX_BYTES_IN_UTF8_CHAR + 1], *key;
 	char			*units;
 	char			*delay;
@@ -201,6 +202,10 @@ typedef struct
 }
 DC_ITEM;
 
+/* DC_ITEM preprocessing field values */
+#define ZBX_ITEM_PREPROCESSING_REQUIRED	0	/* values must be passed to preprocessing manager */
+#define ZBX_ITEM_PREPROCESSING_NONE	1	/* values can be added directly to history cache */
+
 typedef struct
 {
 	zbx_uint64_t	functionid;
@@ -240,6 +245,10 @@ typedef struct _DC_TRIGGER
 	char			*expression;
 	char			*recovery_expression;
 
+	/* compiled expressions, NULL if expression must be evaluated as text */
+	unsigned char		*program;
+	unsigned char		*recovery_program;
+
 	char			*error;
 	char			*new_error;
 	char			*correlation_tag;
@@ -378,6 +387,7 @@ zbx_config_t;
 
 /* possible values for database extensions (if flag ZBX_CONFIG_FLAGS_DB_EXTENSION set) */
 #define ZBX_CONFIG_DB_EXTENSION_TIMESCALE		"timescaledb"
+#define ZBX_CONFIG_DB_EXTENSION_PARTITIONS		"partitions"
 
 typedef struct
 {
@@ -651,6 +661,8 @@ int	DCconfig_get_hostid_by_name(const char *host, zbx_uint64_t *hostid);
 void	DCconfig_get_hosts_by_itemids(DC_HOST *hosts, const zbx_uint64_t *itemids, int *errcodes, size_t num);
 void	DCconfig_get_items_by_keys(DC_ITEM *items, zbx_host_key_t *keys, int *errcodes, size_t num);
 void	DCconfig_get_items_by_itemids(DC_ITEM *items, const zbx_uint64_t *itemids, int *errcodes, size_t num);
+void	zbx_dc_get_active_numeric_itemids(const zbx_uint64_t *itemids, int num, zbx_vector_uint64_t *itemids_float,
+		zbx_vector_uint64_t *itemids_uint64);
 void	DCconfig_get_preprocessable_items(zbx_hashset_t *items, int *timestamp);
 void	DCconfig_get_functions_by_functionids(DC_FUNCTION *functions,
 		zbx_uint64_t *functionids, int *errcodes, size_t num);
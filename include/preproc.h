@@ -33,16 +33,72 @@ typedef struct
 }
 zbx_preproc_result_t;
 
+/* the number of preprocessing time histogram buckets - bucket N counts durations below 2^N microseconds, */
+/* the last bucket counts all durations that do not fit in the previous buckets                          */
+#define ZBX_PREPROC_TIME_BUCKETS	24
+
+/* preprocessing time statistics */
+typedef struct
+{
+	zbx_uint64_t	count;
+	double		time;
+	double		time_max;
+	zbx_uint64_t	buckets[ZBX_PREPROC_TIME_BUCKETS];
+}
+zbx_preproc_time_stats_t;
+
+/* preprocessing time statistics of an item */
+typedef struct
+{
+	zbx_uint64_t	itemid;
+	zbx_uint64_t	count;		/* the number of values preprocessed by workers */
+	double		time;		/* the preprocessing time */
+	double		time_max;
+	zbx_uint64_t	queue_count;	/* the number of values taken from queue by manager */
+	double		queue_time;	/* the time spent by values in queue */
+	double		queue_time_max;
+}
+zbx_preproc_item_stats_t;
+
+/* preprocessing worker statistics */
+typedef struct
+{
+	zbx_uint64_t	values_num;	/* the number of preprocessed values */
+	int		process_num;	/* the preprocessing worker process number */
+}
+zbx_preproc_worker_stats_t;
+
+/* preprocessing statistics collected from all preprocessing manager shards */
+typedef struct
+{
+	zbx_preproc_time_stats_t	queue;				/* time spent by values in queue */
+	zbx_preproc_time_stats_t	steps[ZBX_PREPROC_TYPE_MAX];	/* step execution time by step type */
+	double				time;				/* statistics collection period */
+	zbx_vector_ptr_t		workers;			/* zbx_preproc_worker_stats_t */
+	zbx_vector_ptr_t		items;				/* zbx_preproc_item_stats_t */
+}
+zbx_preproc_stats_t;
+
 /* the following functions are implemented differently for server and proxy */
 
 void	zbx_preprocess_item_value(zbx_uint64_t itemid, unsigned char item_value_type, unsigned char item_flags,
-		AGENT_RESULT *result, zbx_timespec_t *ts, unsigned char state, char *error);
+		unsigned char preprocessing, AGENT_RESULT *result, zbx_timespec_t *ts, unsigned char state,
+		char *error);
 void	zbx_preprocessor_flush(void);
 zbx_uint64_t	zbx_preprocessor_get_queue_size(void);
+void	zbx_preprocessor_get_stats(zbx_preproc_stats_t *stats, int items_num);
+void	zbx_preprocessor_clear_stats(zbx_preproc_stats_t *stats);
+
+int	zbx_preprocessor_init_cache(char **error);
+void	zbx_preprocessor_destroy_cache(void);
 
 void	zbx_preproc_op_free(zbx_preproc_op_t *op);
 void	zbx_preproc_result_free(zbx_preproc_result_t *result);
 
+const char	*zbx_preproc_type_string(unsigned char type);
+void	zbx_preproc_time_stats_add(zbx_preproc_time_stats_t *stats, double duration);
+void	zbx_preproc_time_stats_merge(zbx_preproc_time_stats_t *dst, const zbx_preproc_time_stats_t *src);
+
 int	zbx_preprocessor_test(unsigned char value_type, const char *value, const zbx_timespec_t *ts,
 		const zbx_vector_ptr_t *steps, zbx_vector_ptr_t *results, zbx_vector_ptr_t *history,
 		char **preproc_error, char **error);
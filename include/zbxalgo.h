@@ -324,6 +324,7 @@ typedef void (*zbx_ ## __id ## _free_func_t)(__type data);							\
 void	zbx_vector_ ## __id ## _clear_ext(zbx_vector_ ## __id ## _t *vector, zbx_ ## __id ## _free_func_t free_func);
 
 ZBX_VECTOR_DECL(uint64, zbx_uint64_t)
+ZBX_VECTOR_DECL(dbl, double)
 ZBX_PTR_VECTOR_DECL(str, char *)
 ZBX_PTR_VECTOR_DECL(ptr, void *)
 ZBX_VECTOR_DECL(ptr_pair, zbx_ptr_pair_t)
@@ -356,6 +357,30 @@ int	evaluate(double *value, const char *expression, char *error, size_t max_erro
 		zbx_vector_ptr_t *unknown_msgs);
 int	evaluate_unknown(const char *expression, double *value, char *error, size_t max_error_len);
 
+/* the function operand resolver of compiled expressions, returns SUCCEED, FAIL (error is set) or */
+/* NOTSUPPORTED if the operand value cannot be used by compiled expression                       */
+typedef int	(*zbx_expression_value_func_t)(zbx_uint64_t functionid, void *data, double *value, int *unknown_idx,
+		char *error, size_t max_error_len);
+
+int	zbx_expression_compile(const char *expression, unsigned char **program);
+size_t	zbx_expression_program_size(const unsigned char *program);
+void	zbx_expression_program_functionids(const unsigned char *program, zbx_vector_uint64_t *functionids);
+int	zbx_expression_execute(double *value, const unsigned char *program, int trigger_value,
+		zbx_expression_value_func_t value_func, void *data, zbx_vector_ptr_t *unknown_msgs, char *error,
+		size_t max_error_len);
+
+/* aggregate kernels on packed value arrays */
+
+double		zbx_dbl_array_sum(const double *values, int values_num);
+double		zbx_dbl_array_min(const double *values, int values_num);
+double		zbx_dbl_array_max(const double *values, int values_num);
+double		zbx_dbl_array_select(double *values, int values_num, int k);
+zbx_uint64_t	zbx_ui64_array_sum(const zbx_uint64_t *values, int values_num);
+double		zbx_ui64_array_sum_dbl(const zbx_uint64_t *values, int values_num);
+zbx_uint64_t	zbx_ui64_array_min(const zbx_uint64_t *values, int values_num);
+zbx_uint64_t	zbx_ui64_array_max(const zbx_uint64_t *values, int values_num);
+zbx_uint64_t	zbx_ui64_array_select(zbx_uint64_t *values, int values_num, int k);
+
 /* forecasting */
 
 #define ZBX_MATH_ERROR	-1.0
@@ -382,11 +407,37 @@ typedef enum
 }
 zbx_mode_t;
 
+#define ZBX_POLYNOMIAL_DEGREE_MAX	6
+
+/* The regression time frame origin must not lag behind the oldest data window value by more than this part */
+/* of the window length. Otherwise the sums of high powers of time grow and the Taylor shift of coefficients */
+/* to the evaluation time frame loses precision.                                                             */
+#define ZBX_REGRESSION_LAG_MAX		0.125
+
+/* least squares sums of the values in data window, see zbx_regression_init() */
+typedef struct
+{
+	zbx_fit_t	fit;
+	int		k;
+	int		n;
+	int		invalid;
+	double		sum_t[2 * ZBX_POLYNOMIAL_DEGREE_MAX + 1];
+	double		sum_xt[ZBX_POLYNOMIAL_DEGREE_MAX + 1];
+}
+zbx_regression_t;
+
 int	zbx_fit_code(char *fit_str, zbx_fit_t *fit, unsigned *k, char **error);
 int	zbx_mode_code(char *mode_str, zbx_mode_t *mode, char **error);
 double	zbx_forecast(double *t, double *x, int n, double now, double time, zbx_fit_t fit, unsigned k, zbx_mode_t mode);
 double	zbx_timeleft(double *t, double *x, int n, double now, double threshold, zbx_fit_t fit, unsigned k);
 
+int	zbx_regression_init(zbx_regression_t *regression, zbx_fit_t fit, unsigned k);
+void	zbx_regression_add(zbx_regression_t *regression, double t, double x);
+void	zbx_regression_remove(zbx_regression_t *regression, double t, double x);
+double	zbx_regression_forecast(const zbx_regression_t *regression, double shift, double now, double time,
+		zbx_mode_t mode);
+double	zbx_regression_timeleft(const zbx_regression_t *regression, double shift, double now, double threshold);
+
 
 /* fifo queue of pointers */
 
@@ -38,5 +38,6 @@ int	zbx_es_compile(zbx_es_t *es, const char *script, char **code, int *size, cha
 int	zbx_es_execute(zbx_es_t *es, const char *script, const char *code, int size, const char *param, char **output,
 	char **error);
 void	zbx_es_set_timeout(zbx_es_t *es, int timeout);
+void	zbx_es_log_stats(zbx_es_t *es);
 
 #endif /* ZABBIX_ZBXEMBED_H */
@@ -20,10 +20,25 @@
 #ifndef __zbxprometheus_h__
 #define __zbxprometheus_h__
 
+#include "zbxalgo.h"
+
+/* parsed prometheus data, indexed by metric name */
+typedef struct
+{
+	zbx_vector_ptr_t	rows;
+	zbx_hashset_t		index;
+}
+zbx_prometheus_t;
+
 int	zbx_prometheus_pattern(const char *data, const char *filter_data, const char *output,
 						char **value, char **err);
 int	zbx_prometheus_to_json(const char *data, const char *filter_data, char **value, char **err);
 
+int	zbx_prometheus_init(zbx_prometheus_t *prom, const char *data, char **error);
+void	zbx_prometheus_clear(zbx_prometheus_t *prom);
+int	zbx_prometheus_pattern_ex(zbx_prometheus_t *prom, const char *filter_data, const char *output, char **value,
+		char **error);
+
 int	zbx_prometheus_validate_filter(const char *pattern, char **error);
 int	zbx_prometheus_validate_label(const char *label);
 
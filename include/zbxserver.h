@@ -61,8 +61,11 @@ int	evaluate_function(char *value, DC_ITEM *item, const char *function, const ch
 int	substitute_simple_macros(zbx_uint64_t *actionid, const DB_EVENT *event, const DB_EVENT *r_event,
 		zbx_uint64_t *userid, const zbx_uint64_t *hostid, const DC_HOST *dc_host, const DC_ITEM *dc_item,
 		DB_ALERT *alert, const DB_ACKNOWLEDGE *ack, char **data, int macro_type, char *error, int maxerrlen);
+void	zbx_macro_items_cache_prepare(const zbx_vector_ptr_t *events);
+void	zbx_macro_items_cache_clear(void);
 
 void	evaluate_expressions(zbx_vector_ptr_t *triggers);
+void	zbx_get_function_results_stats(zbx_uint64_t *hits, zbx_uint64_t *misses);
 
 void	zbx_format_value(char *value, size_t max_len, zbx_uint64_t valuemapid,
 		const char *units, unsigned char value_type);
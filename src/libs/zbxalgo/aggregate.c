@@ -0,0 +1,216 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2019 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "common.h"
+
+#include "zbxalgo.h"
+
+/*
+ * Aggregate kernels working on packed value arrays.
+ *
+ * The reduction loops process ZBX_AGGREGATE_LANES independent accumulators
+ * per iteration. This breaks the loop carried dependency of a single
+ * accumulator and allows the compiler to keep the lanes in vector registers.
+ * The lanes are combined after the main loop and the remaining values are
+ * processed one by one.
+ */
+
+#define ZBX_AGGREGATE_LANES	4
+
+#define ZBX_AGGREGATE_MIN(a, b)	((b) < (a) ? (b) : (a))
+#define ZBX_AGGREGATE_MAX(a, b)	((b) > (a) ? (b) : (a))
+
+#define ZBX_AGGREGATE_SWAP(a, b, tmp)	do { (tmp) = (a); (a) = (b); (b) = (tmp); } while (0)
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_dbl_array_sum                                                *
+ *                                                                            *
+ * Purpose: calculate sum of floating point values                            *
+ *                                                                            *
+ * Parameters: values     - [IN] the values                                   *
+ *             values_num - [IN] the number of values                         *
+ *                                                                            *
+ * Return value: the sum of values                                            *
+ *                                                                            *
+ ******************************************************************************/
+double	zbx_dbl_array_sum(const double *values, int values_num)
+{
+	double	acc[ZBX_AGGREGATE_LANES] = {0};
+	int	i, j;
+
+	for (i = 0; i + ZBX_AGGREGATE_LANES <= values_num; i += ZBX_AGGREGATE_LANES)
+	{
+		for (j = 0; j < ZBX_AGGREGATE_LANES; j++)
+			acc[j] += values[i + j];
+	}
+
+	for (; i < values_num; i++)
+		acc[0] += values[i];
+
+	return (acc[0] + acc[1]) + (acc[2] + acc[3]);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_ui64_array_sum                                               *
+ *                                                                            *
+ * Purpose: calculate sum of unsigned integer values                          *
+ *                                                                            *
+ * Parameters: values     - [IN] the values                                   *
+ *             values_num - [IN] the number of values                         *
+ *                                                                            *
+ * Return value: the sum of values, wrapping on overflow                      *
+ *                                                                            *
+ ******************************************************************************/
+zbx_uint64_t	zbx_ui64_array_sum(const zbx_uint64_t *values, int values_num)
+{
+	zbx_uint64_t	acc[ZBX_AGGREGATE_LANES] = {0};
+	int		i, j;
+
+	for (i = 0; i + ZBX_AGGREGATE_LANES <= values_num; i += ZBX_AGGREGATE_LANES)
+	{
+		for (j = 0; j < ZBX_AGGREGATE_LANES; j++)
+			acc[j] += values[i + j];
+	}
+
+	for (; i < values_num; i++)
+		acc[0] += values[i];
+
+	return acc[0] + acc[1] + acc[2] + acc[3];
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_ui64_array_sum_dbl                                           *
+ *                                                                            *
+ * Purpose: calculate sum of unsigned integer values as floating point value  *
+ *                                                                            *
+ * Parameters: values     - [IN] the values                                   *
+ *             values_num - [IN] the number of values                         *
+ *                                                                            *
+ * Return value: the sum of values                                            *
+ *                                                                            *
+ * Comments: Used for averages where the integer sum could overflow.          *
+ *                                                                            *
+ ******************************************************************************/
+double	zbx_ui64_array_sum_dbl(const zbx_uint64_t *values, int values_num)
+{
+	double	acc[ZBX_AGGREGATE_LANES] = {0};
+	int	i, j;
+
+	for (i = 0; i + ZBX_AGGREGATE_LANES <= values_num; i += ZBX_AGGREGATE_LANES)
+	{
+		for (j = 0; j < ZBX_AGGREGATE_LANES; j++)
+			acc[j] += (double)values[i + j];
+	}
+
+	for (; i < values_num; i++)
+		acc[0] += (double)values[i];
+
+	return (acc[0] + acc[1]) + (acc[2] + acc[3]);
+}
+
+/*
+ * Minimum/maximum kernels - the values array must not be empty.
+ */
+
+#define ZBX_AGGREGATE_MINMAX_IMPL(__id, __type, __name, __op)							\
+														\
+__type	zbx_ ## __id ## _array_ ## __name(const __type *values, int values_num)					\
+{														\
+	__type	acc[ZBX_AGGREGATE_LANES];									\
+	int	i, j;												\
+														\
+	for (j = 0; j < ZBX_AGGREGATE_LANES; j++)								\
+		acc[j] = values[0];										\
+														\
+	for (i = 0; i + ZBX_AGGREGATE_LANES <= values_num; i += ZBX_AGGREGATE_LANES)				\
+	{													\
+		for (j = 0; j < ZBX_AGGREGATE_LANES; j++)							\
+			acc[j] = __op(acc[j], values[i + j]);							\
+	}													\
+														\
+	for (; i < values_num; i++)										\
+		acc[0] = __op(acc[0], values[i]);								\
+														\
+	for (j = 1; j < ZBX_AGGREGATE_LANES; j++)								\
+		acc[0] = __op(acc[0], acc[j]);									\
+														\
+	return acc[0];												\
+}
+
+ZBX_AGGREGATE_MINMAX_IMPL(dbl, double, min, ZBX_AGGREGATE_MIN)
+ZBX_AGGREGATE_MINMAX_IMPL(dbl, double, max, ZBX_AGGREGATE_MAX)
+ZBX_AGGREGATE_MINMAX_IMPL(ui64, zbx_uint64_t, min, ZBX_AGGREGATE_MIN)
+ZBX_AGGREGATE_MINMAX_IMPL(ui64, zbx_uint64_t, max, ZBX_AGGREGATE_MAX)
+
+/*
+ * Selection kernels - find the k-th smallest value (0 based) with quickselect
+ * using median of three pivot. The values array is reordered in place.
+ */
+
+#define ZBX_AGGREGATE_SELECT_IMPL(__id, __type)									\
+														\
+__type	zbx_ ## __id ## _array_select(__type *values, int values_num, int k)					\
+{														\
+	int	left = 0, right = values_num - 1;								\
+														\
+	while (left < right)											\
+	{													\
+		int	i = left, j = right, mid = left + (right - left) / 2;					\
+		__type	pivot, tmp;										\
+														\
+		if (values[mid] < values[left])									\
+			ZBX_AGGREGATE_SWAP(values[mid], values[left], tmp);					\
+		if (values[right] < values[left])								\
+			ZBX_AGGREGATE_SWAP(values[right], values[left], tmp);					\
+		if (values[right] < values[mid])								\
+			ZBX_AGGREGATE_SWAP(values[right], values[mid], tmp);					\
+														\
+		pivot = values[mid];										\
+														\
+		while (i <= j)											\
+		{												\
+			while (values[i] < pivot)								\
+				i++;										\
+			while (pivot < values[j])								\
+				j--;										\
+														\
+			if (i <= j)										\
+			{											\
+				ZBX_AGGREGATE_SWAP(values[i], values[j], tmp);					\
+				i++;										\
+				j--;										\
+			}											\
+		}												\
+														\
+		if (k <= j)											\
+			right = j;										\
+		else if (k >= i)										\
+			left = i;										\
+		else												\
+			break;											\
+	}													\
+														\
+	return values[k];											\
+}
+
+ZBX_AGGREGATE_SELECT_IMPL(dbl, double)
+ZBX_AGGREGATE_SELECT_IMPL(ui64, zbx_uint64_t)
@@ -660,6 +660,52 @@ static double	evaluate_term1(int *unknown_idx)
 	return result;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: evaluate_unknown_error                                           *
+ *                                                                            *
+ * Purpose: write error message for expression evaluated to Unknown           *
+ *                                                                            *
+ * Parameters: unknown_idx   - [IN] index of message in 'unknown_msgs' vector *
+ *             expression    - [IN] the expression for logging (optional)     *
+ *             unknown_msgs  - [IN] messages about origins of Unknown values  *
+ *             error         - [OUT] error message buffer                     *
+ *             max_error_len - [IN] error buffer size                         *
+ *                                                                            *
+ ******************************************************************************/
+static void	evaluate_unknown_error(int unknown_idx, const char *expression, const zbx_vector_ptr_t *unknown_msgs,
+		char *error, size_t max_error_len)
+{
+	if (NULL != unknown_msgs)
+	{
+		if (0 > unknown_idx)
+		{
+			THIS_SHOULD_NEVER_HAPPEN;
+			zabbix_log(LOG_LEVEL_WARNING, "%s() internal error: " ZBX_UNKNOWN_STR " index:%d"
+					" expression:'%s'", __func__, unknown_idx, ZBX_NULL2EMPTY_STR(expression));
+			zbx_snprintf(error, max_error_len, "Internal error: " ZBX_UNKNOWN_STR " index %d."
+					" Please report this to Zabbix developers.", unknown_idx);
+		}
+		else if (unknown_msgs->values_num > unknown_idx)
+		{
+			zbx_snprintf(error, max_error_len, "Cannot evaluate expression: \"%s\".",
+					(char *)(unknown_msgs->values[unknown_idx]));
+		}
+		else
+		{
+			zbx_snprintf(error, max_error_len, "Cannot evaluate expression: unsupported "
+					ZBX_UNKNOWN_STR "%d value.", unknown_idx);
+		}
+	}
+	else
+	{
+		THIS_SHOULD_NEVER_HAPPEN;
+		/* do not leave garbage in error buffer, write something helpful */
+		zbx_snprintf(error, max_error_len, "%s(): internal error: no message for unknown result",
+				__func__);
+	}
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: evaluate an expression like "(26.416>10) or (0=1)"                *
@@ -690,35 +736,7 @@ int	evaluate(double *value, const char *expression, char *error, size_t max_erro
 	if (ZBX_UNKNOWN == *value)
 	{
 		/* Map Unknown result to error. Callers currently do not operate with ZBX_UNKNOWN. */
-		if (NULL != unknown_msgs)
-		{
-			if (0 > unknown_idx)
-			{
-				THIS_SHOULD_NEVER_HAPPEN;
-				zabbix_log(LOG_LEVEL_WARNING, "%s() internal error: " ZBX_UNKNOWN_STR " index:%d"
-						" expression:'%s'", __func__, unknown_idx, expression);
-				zbx_snprintf(error, max_error_len, "Internal error: " ZBX_UNKNOWN_STR " index %d."
-						" Please report this to Zabbix developers.", unknown_idx);
-			}
-			else if (unknown_msgs->values_num > unknown_idx)
-			{
-				zbx_snprintf(error, max_error_len, "Cannot evaluate expression: \"%s\".",
-						(char *)(unknown_msgs->values[unknown_idx]));
-			}
-			else
-			{
-				zbx_snprintf(error, max_error_len, "Cannot evaluate expression: unsupported "
-						ZBX_UNKNOWN_STR "%d value.", unknown_idx);
-			}
-		}
-		else
-		{
-			THIS_SHOULD_NEVER_HAPPEN;
-			/* do not leave garbage in error buffer, write something helpful */
-			zbx_snprintf(error, max_error_len, "%s(): internal error: no message for unknown result",
-					__func__);
-		}
-
+		evaluate_unknown_error(unknown_idx, expression, unknown_msgs, error, max_error_len);
 		*value = ZBX_INFINITY;
 	}
 
@@ -781,3 +799,745 @@ int	evaluate_unknown(const char *expression, double *value, char *error, size_t
 
 	return SUCCEED;
 }
+
+/******************************************************************************
+ *                                                                            *
+ *                      Module for compiled expressions                       *
+ *                   -------------------------------------                    *
+ *                                                                            *
+ * Trigger expressions are compiled into postfix programs once, when they are *
+ * loaded into configuration cache. Executing a program does not format,      *
+ * parse or convert any strings.                                              *
+ *                                                                            *
+ * The compiler follows the same grammar as evaluate_termX() functions and    *
+ * fails for anything it cannot translate exactly (user macros, unknown       *
+ * tokens, syntax errors). Such expressions are evaluated as text, which also *
+ * produces the same error messages as before.                                *
+ *                                                                            *
+ * The program layout:                                                        *
+ *   <size><operands num><instruction 1>...<instruction N>                    *
+ *                                                                            *
+ *   size         - zbx_uint32_t, the total program size in bytes             *
+ *   operands num - zbx_uint32_t, the number of function operands             *
+ *   instruction  - opcode byte followed by a double constant                 *
+ *                  (ZBX_EVAL_OP_NUMBER) or a zbx_uint64_t functionid         *
+ *                  (ZBX_EVAL_OP_FUNCTIONID)                                  *
+ *                                                                            *
+ ******************************************************************************/
+
+#define ZBX_EVAL_OP_NUMBER		1
+#define ZBX_EVAL_OP_FUNCTIONID		2
+#define ZBX_EVAL_OP_TRIGGER_VALUE	3
+#define ZBX_EVAL_OP_NEG			4
+#define ZBX_EVAL_OP_NOT			5
+#define ZBX_EVAL_OP_MUL			6
+#define ZBX_EVAL_OP_DIV			7
+#define ZBX_EVAL_OP_ADD			8
+#define ZBX_EVAL_OP_SUB			9
+#define ZBX_EVAL_OP_LT			10
+#define ZBX_EVAL_OP_LE			11
+#define ZBX_EVAL_OP_GE			12
+#define ZBX_EVAL_OP_GT			13
+#define ZBX_EVAL_OP_EQ			14
+#define ZBX_EVAL_OP_NE			15
+#define ZBX_EVAL_OP_AND			16
+#define ZBX_EVAL_OP_OR			17
+
+#define ZBX_EVAL_HEADER_SIZE		(2 * sizeof(zbx_uint32_t))
+
+/* the maximum execution stack depth, expressions requiring deeper stack are not compiled */
+#define ZBX_EVAL_STACK_MAX		64
+
+/* the number of function operands resolved without heap allocation */
+#define ZBX_EVAL_OPERANDS_LOCAL		32
+
+typedef struct
+{
+	double	value;
+	int	unknown_idx;
+}
+zbx_eval_operand_t;
+
+static unsigned char	*code;		/* the program being compiled      */
+static size_t		code_alloc;	/* the program buffer size         */
+static size_t		code_offset;	/* the program size                */
+static int		depth;		/* the execution stack depth       */
+static zbx_uint32_t	operands_num;	/* the number of function operands */
+
+static void	compile_emit(unsigned char op, const void *data, size_t size)
+{
+	if (code_offset + 1 + size > code_alloc)
+	{
+		while (code_offset + 1 + size > code_alloc)
+			code_alloc *= 2;
+
+		code = (unsigned char *)zbx_realloc(code, code_alloc);
+	}
+
+	code[code_offset++] = op;
+
+	if (0 != size)
+	{
+		memcpy(code + code_offset, data, size);
+		code_offset += size;
+	}
+}
+
+static int	compile_push(void)
+{
+	return ZBX_EVAL_STACK_MAX < ++depth ? FAIL : SUCCEED;
+}
+
+static void	compile_skip_whitespace(void)
+{
+	while (' ' == *ptr || '\r' == *ptr || '\n' == *ptr || '\t' == *ptr)
+		ptr++;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: compile a suffixed number, {<functionid>} or {TRIGGER.VALUE}      *
+ *                                                                            *
+ ******************************************************************************/
+static int	compile_number(void)
+{
+	int		len;
+	double		number;
+	const char	*br;
+	zbx_uint64_t	functionid;
+
+	if ('{' != *ptr)
+	{
+		if (SUCCEED != zbx_suffixed_number_parse(ptr, &len) || SUCCEED != is_number_delimiter(*(ptr + len)))
+			return FAIL;
+
+		number = atof(ptr) * suffix2factor(*(ptr + len - 1));
+		compile_emit(ZBX_EVAL_OP_NUMBER, &number, sizeof(number));
+		ptr += len;
+
+		return compile_push();
+	}
+
+	if (NULL == (br = strchr(ptr, '}')))
+		return FAIL;
+
+	if (SUCCEED == is_uint64_n(ptr + 1, br - ptr - 1, &functionid))
+	{
+		compile_emit(ZBX_EVAL_OP_FUNCTIONID, &functionid, sizeof(functionid));
+		operands_num++;
+	}
+	else if (ZBX_CONST_STRLEN("{TRIGGER.VALUE}") == br - ptr + 1 &&
+			0 == strncmp(ptr, "{TRIGGER.VALUE}", ZBX_CONST_STRLEN("{TRIGGER.VALUE}")))
+	{
+		compile_emit(ZBX_EVAL_OP_TRIGGER_VALUE, NULL, 0);
+	}
+	else
+		return FAIL;
+
+	/* substituted value would merge with the following characters when evaluated as text */
+	if (SUCCEED != is_number_delimiter(*(br + 1)))
+		return FAIL;
+
+	ptr = br + 1;
+
+	return compile_push();
+}
+
+static int	compile_term1(void);
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: compile a number or a parenthesized expression, see               *
+ *          evaluate_term9()                                                  *
+ *                                                                            *
+ ******************************************************************************/
+static int	compile_term9(void)
+{
+	compile_skip_whitespace();
+
+	if ('\0' == *ptr)
+		return FAIL;
+
+	if ('(' == *ptr)
+	{
+		ptr++;
+
+		if (SUCCEED != compile_term1() || ')' != *ptr)
+			return FAIL;
+
+		ptr++;
+	}
+	else if (SUCCEED != compile_number())
+		return FAIL;
+
+	compile_skip_whitespace();
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: compile "-" (unary), see evaluate_term8()                         *
+ *                                                                            *
+ ******************************************************************************/
+static int	compile_term8(void)
+{
+	compile_skip_whitespace();
+
+	if ('-' != *ptr)
+		return compile_term9();
+
+	ptr++;
+
+	if (SUCCEED != compile_term9())
+		return FAIL;
+
+	compile_emit(ZBX_EVAL_OP_NEG, NULL, 0);
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: compile "not", see evaluate_term7()                               *
+ *                                                                            *
+ ******************************************************************************/
+static int	compile_term7(void)
+{
+	compile_skip_whitespace();
+
+	if ('n' != ptr[0] || 'o' != ptr[1] || 't' != ptr[2] || SUCCEED != is_operator_delimiter(ptr[3]))
+		return compile_term8();
+
+	ptr += 3;
+
+	if (SUCCEED != compile_term8())
+		return FAIL;
+
+	compile_emit(ZBX_EVAL_OP_NOT, NULL, 0);
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: compile "*" and "/", see evaluate_term6()                         *
+ *                                                                            *
+ ******************************************************************************/
+static int	compile_term6(void)
+{
+	unsigned char	op;
+
+	if (SUCCEED != compile_term7())
+		return FAIL;
+
+	while ('*' == *ptr || '/' == *ptr)
+	{
+		op = ('*' == *ptr++ ? ZBX_EVAL_OP_MUL : ZBX_EVAL_OP_DIV);
+
+		if (SUCCEED != compile_term7())
+			return FAIL;
+
+		compile_emit(op, NULL, 0);
+		depth--;
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: compile "+" and "-", see evaluate_term5()                         *
+ *                                                                            *
+ ******************************************************************************/
+static int	compile_term5(void)
+{
+	unsigned char	op;
+
+	if (SUCCEED != compile_term6())
+		return FAIL;
+
+	while ('+' == *ptr || '-' == *ptr)
+	{
+		op = ('+' == *ptr++ ? ZBX_EVAL_OP_ADD : ZBX_EVAL_OP_SUB);
+
+		if (SUCCEED != compile_term6())
+			return FAIL;
+
+		compile_emit(op, NULL, 0);
+		depth--;
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: compile "<", "<=", ">=", ">", see evaluate_term4()                *
+ *                                                                            *
+ ******************************************************************************/
+static int	compile_term4(void)
+{
+	unsigned char	op;
+
+	if (SUCCEED != compile_term5())
+		return FAIL;
+
+	while (1)
+	{
+		if ('<' == ptr[0] && '=' == ptr[1])
+		{
+			op = ZBX_EVAL_OP_LE;
+			ptr += 2;
+		}
+		else if ('>' == ptr[0] && '=' == ptr[1])
+		{
+			op = ZBX_EVAL_OP_GE;
+			ptr += 2;
+		}
+		else if ('<' == ptr[0] && '>' != ptr[1])
+		{
+			op = ZBX_EVAL_OP_LT;
+			ptr++;
+		}
+		else if ('>' == ptr[0])
+		{
+			op = ZBX_EVAL_OP_GT;
+			ptr++;
+		}
+		else
+			break;
+
+		if (SUCCEED != compile_term5())
+			return FAIL;
+
+		compile_emit(op, NULL, 0);
+		depth--;
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: compile "=" and "<>", see evaluate_term3()                        *
+ *                                                                            *
+ ******************************************************************************/
+static int	compile_term3(void)
+{
+	unsigned char	op;
+
+	if (SUCCEED != compile_term4())
+		return FAIL;
+
+	while (1)
+	{
+		if ('=' == *ptr)
+		{
+			op = ZBX_EVAL_OP_EQ;
+			ptr++;
+		}
+		else if ('<' == ptr[0] && '>' == ptr[1])
+		{
+			op = ZBX_EVAL_OP_NE;
+			ptr += 2;
+		}
+		else
+			break;
+
+		if (SUCCEED != compile_term4())
+			return FAIL;
+
+		compile_emit(op, NULL, 0);
+		depth--;
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: compile "and", see evaluate_term2()                               *
+ *                                                                            *
+ ******************************************************************************/
+static int	compile_term2(void)
+{
+	if (SUCCEED != compile_term3())
+		return FAIL;
+
+	while ('a' == ptr[0] && 'n' == ptr[1] && 'd' == ptr[2] && SUCCEED == is_operator_delimiter(ptr[3]))
+	{
+		ptr += 3;
+
+		if (SUCCEED != compile_term3())
+			return FAIL;
+
+		compile_emit(ZBX_EVAL_OP_AND, NULL, 0);
+		depth--;
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: compile "or", see evaluate_term1()                                *
+ *                                                                            *
+ ******************************************************************************/
+static int	compile_term1(void)
+{
+	if (32 < ++level)
+		return FAIL;
+
+	if (SUCCEED != compile_term2())
+		return FAIL;
+
+	while ('o' == ptr[0] && 'r' == ptr[1] && SUCCEED == is_operator_delimiter(ptr[2]))
+	{
+		ptr += 2;
+
+		if (SUCCEED != compile_term2())
+			return FAIL;
+
+		compile_emit(ZBX_EVAL_OP_OR, NULL, 0);
+		depth--;
+	}
+
+	level--;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_expression_compile                                           *
+ *                                                                            *
+ * Purpose: compile trigger expression like "({15}>10) or ({123}=1)" into     *
+ *          postfix program                                                   *
+ *                                                                            *
+ * Parameters: expression - [IN] the expression with expanded user macros     *
+ *             program    - [OUT] the compiled program                        *
+ *                                                                            *
+ * Return value: SUCCEED - the expression was compiled                        *
+ *               FAIL    - the expression must be evaluated as text           *
+ *                                                                            *
+ * Comments: The returned program must be freed by the caller.                *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_expression_compile(const char *expression, unsigned char **program)
+{
+	zbx_uint32_t	size;
+
+	ptr = expression;
+	level = 0;
+	depth = 0;
+	operands_num = 0;
+
+	code_alloc = 64;
+	code_offset = ZBX_EVAL_HEADER_SIZE;
+	code = (unsigned char *)zbx_malloc(NULL, code_alloc);
+
+	if (SUCCEED != compile_term1() || '\0' != *ptr)
+	{
+		zbx_free(code);
+		return FAIL;
+	}
+
+	size = (zbx_uint32_t)code_offset;
+	memcpy(code, &size, sizeof(size));
+	memcpy(code + sizeof(size), &operands_num, sizeof(operands_num));
+
+	*program = code;
+	code = NULL;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_expression_program_size                                      *
+ *                                                                            *
+ * Purpose: get the size of compiled expression program in bytes              *
+ *                                                                            *
+ ******************************************************************************/
+size_t	zbx_expression_program_size(const unsigned char *program)
+{
+	zbx_uint32_t	size;
+
+	memcpy(&size, program, sizeof(size));
+
+	return (size_t)size;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_expression_program_functionids                               *
+ *                                                                            *
+ * Purpose: get function identifiers used by compiled expression program      *
+ *                                                                            *
+ * Parameters: program     - [IN] the compiled program                        *
+ *             functionids - [OUT] the function identifiers in the order of   *
+ *                                 their appearance in expression             *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_expression_program_functionids(const unsigned char *program, zbx_vector_uint64_t *functionids)
+{
+	const unsigned char	*pc, *end;
+	zbx_uint64_t		functionid;
+
+	end = program + zbx_expression_program_size(program);
+
+	for (pc = program + ZBX_EVAL_HEADER_SIZE; pc < end;)
+	{
+		switch (*pc++)
+		{
+			case ZBX_EVAL_OP_NUMBER:
+				pc += sizeof(double);
+				break;
+			case ZBX_EVAL_OP_FUNCTIONID:
+				memcpy(&functionid, pc, sizeof(functionid));
+				zbx_vector_uint64_append(functionids, functionid);
+				pc += sizeof(functionid);
+				break;
+		}
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: apply binary operator to the two topmost stack operands           *
+ *                                                                            *
+ * Comments: Unknown values are handled in the same way as by                 *
+ *           evaluate_termX() functions.                                      *
+ *                                                                            *
+ ******************************************************************************/
+static int	execute_operator(unsigned char op, zbx_eval_operand_t *left, const zbx_eval_operand_t *right,
+		char *error, size_t max_error_len)
+{
+	switch (op)
+	{
+		case ZBX_EVAL_OP_AND:
+			if (ZBX_UNKNOWN == left->value)
+			{
+				if (ZBX_UNKNOWN == right->value)			/* Unknown and Unknown */
+					*left = *right;
+				else if (SUCCEED == zbx_double_compare(right->value, 0.0))	/* Unknown and 0 */
+					left->value = 0.0;
+			}
+			else if (ZBX_UNKNOWN == right->value)
+			{
+				if (SUCCEED == zbx_double_compare(left->value, 0.0))	/* 0 and Unknown */
+					left->value = 0.0;
+				else							/* 1 and Unknown */
+					*left = *right;
+			}
+			else
+			{
+				left->value = (SUCCEED != zbx_double_compare(left->value, 0.0) &&
+						SUCCEED != zbx_double_compare(right->value, 0.0));
+			}
+			return SUCCEED;
+		case ZBX_EVAL_OP_OR:
+			if (ZBX_UNKNOWN == left->value)
+			{
+				if (ZBX_UNKNOWN == right->value)			/* Unknown or Unknown */
+					*left = *right;
+				else if (SUCCEED != zbx_double_compare(right->value, 0.0))	/* Unknown or 1 */
+					left->value = 1;
+			}
+			else if (ZBX_UNKNOWN == right->value)
+			{
+				if (SUCCEED != zbx_double_compare(left->value, 0.0))	/* 1 or Unknown */
+					left->value = 1;
+				else							/* 0 or Unknown */
+					*left = *right;
+			}
+			else
+			{
+				left->value = (SUCCEED != zbx_double_compare(left->value, 0.0) ||
+						SUCCEED != zbx_double_compare(right->value, 0.0));
+			}
+			return SUCCEED;
+	}
+
+	/* catch division by 0 even if 1st operand is Unknown */
+	if (ZBX_EVAL_OP_DIV == op && ZBX_UNKNOWN != right->value && SUCCEED == zbx_double_compare(right->value, 0.0))
+	{
+		zbx_strlcpy(error, "Cannot evaluate expression: division by zero.", max_error_len);
+		return FAIL;
+	}
+
+	if (ZBX_UNKNOWN == right->value)	/* (anything) <op> Unknown */
+	{
+		*left = *right;
+		return SUCCEED;
+	}
+
+	if (ZBX_UNKNOWN == left->value)		/* Unknown <op> known */
+		return SUCCEED;
+
+	switch (op)
+	{
+		case ZBX_EVAL_OP_MUL:
+			left->value *= right->value;
+			break;
+		case ZBX_EVAL_OP_DIV:
+			left->value /= right->value;
+			break;
+		case ZBX_EVAL_OP_ADD:
+			left->value += right->value;
+			break;
+		case ZBX_EVAL_OP_SUB:
+			left->value -= right->value;
+			break;
+		case ZBX_EVAL_OP_LT:
+			left->value = (left->value < right->value - ZBX_DOUBLE_EPSILON);
+			break;
+		case ZBX_EVAL_OP_LE:
+			left->value = (left->value <= right->value + ZBX_DOUBLE_EPSILON);
+			break;
+		case ZBX_EVAL_OP_GE:
+			left->value = (left->value >= right->value - ZBX_DOUBLE_EPSILON);
+			break;
+		case ZBX_EVAL_OP_GT:
+			left->value = (left->value > right->value + ZBX_DOUBLE_EPSILON);
+			break;
+		case ZBX_EVAL_OP_EQ:
+			left->value = (SUCCEED == zbx_double_compare(left->value, right->value));
+			break;
+		case ZBX_EVAL_OP_NE:
+			left->value = (SUCCEED != zbx_double_compare(left->value, right->value));
+			break;
+	}
+
+	if (ZBX_INFINITY == left->value || ZBX_UNKNOWN == left->value)
+	{
+		zbx_strlcpy(error, "Cannot evaluate expression: value is out of range.", max_error_len);
+		return FAIL;
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_expression_execute                                           *
+ *                                                                            *
+ * Purpose: execute compiled expression program                               *
+ *                                                                            *
+ * Parameters: value         - [OUT] the expression evaluation result         *
+ *             program       - [IN] the compiled program                      *
+ *             trigger_value - [IN] the {TRIGGER.VALUE} macro value           *
+ *             value_func    - [IN] the function operand resolver             *
+ *             data          - [IN] the resolver data                         *
+ *             unknown_msgs  - [IN] messages about origins of Unknown values  *
+ *             error         - [OUT] error message buffer                     *
+ *             max_error_len - [IN] error buffer size                         *
+ *                                                                            *
+ * Return value: SUCCEED      - the expression was evaluated                  *
+ *               FAIL         - the expression evaluation failed              *
+ *               NOTSUPPORTED - a function operand cannot be used by compiled *
+ *                              program, the expression must be evaluated as  *
+ *                              text                                          *
+ *                                                                            *
+ * Comments: All function operands are resolved before execution in the       *
+ *           order of their appearance in expression, so operand errors are   *
+ *           reported the same way as when substituting them into text.       *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_expression_execute(double *value, const unsigned char *program, int trigger_value,
+		zbx_expression_value_func_t value_func, void *data, zbx_vector_ptr_t *unknown_msgs, char *error,
+		size_t max_error_len)
+{
+	zbx_eval_operand_t	stack[ZBX_EVAL_STACK_MAX], operands_local[ZBX_EVAL_OPERANDS_LOCAL], *operands;
+	const unsigned char	*pc, *end;
+	zbx_uint32_t		num;
+	zbx_uint64_t		functionid;
+	unsigned char		op;
+	int			i = 0, top = 0, ret;
+
+	end = program + zbx_expression_program_size(program);
+	memcpy(&num, program + sizeof(zbx_uint32_t), sizeof(num));
+
+	if (ZBX_EVAL_OPERANDS_LOCAL >= num)
+		operands = operands_local;
+	else
+		operands = (zbx_eval_operand_t *)zbx_malloc(NULL, sizeof(zbx_eval_operand_t) * num);
+
+	for (pc = program + ZBX_EVAL_HEADER_SIZE; pc < end;)
+	{
+		switch (*pc++)
+		{
+			case ZBX_EVAL_OP_NUMBER:
+				pc += sizeof(double);
+				break;
+			case ZBX_EVAL_OP_FUNCTIONID:
+				memcpy(&functionid, pc, sizeof(functionid));
+				pc += sizeof(functionid);
+				operands[i].unknown_idx = -1;
+
+				if (SUCCEED != (ret = value_func(functionid, data, &operands[i].value,
+						&operands[i].unknown_idx, error, max_error_len)))
+				{
+					goto out;
+				}
+
+				i++;
+				break;
+		}
+	}
+
+	for (pc = program + ZBX_EVAL_HEADER_SIZE, i = 0; pc < end;)
+	{
+		switch (op = *pc++)
+		{
+			case ZBX_EVAL_OP_NUMBER:
+				memcpy(&stack[top].value, pc, sizeof(double));
+				stack[top++].unknown_idx = -1;
+				pc += sizeof(double);
+				break;
+			case ZBX_EVAL_OP_FUNCTIONID:
+				stack[top++] = operands[i++];
+				pc += sizeof(zbx_uint64_t);
+				break;
+			case ZBX_EVAL_OP_TRIGGER_VALUE:
+				stack[top].value = trigger_value;
+				stack[top++].unknown_idx = -1;
+				break;
+			case ZBX_EVAL_OP_NEG:
+				if (ZBX_UNKNOWN != stack[top - 1].value)
+					stack[top - 1].value = -stack[top - 1].value;
+				break;
+			case ZBX_EVAL_OP_NOT:
+				if (ZBX_UNKNOWN != stack[top - 1].value)
+				{
+					stack[top - 1].value = (SUCCEED == zbx_double_compare(stack[top - 1].value, 0.0) ?
+							1.0 : 0.0);
+				}
+				break;
+			default:
+				top--;
+
+				if (SUCCEED != (ret = execute_operator(op, &stack[top - 1], &stack[top], error,
+						max_error_len)))
+				{
+					goto out;
+				}
+		}
+	}
+
+	*value = stack[0].value;
+
+	if (ZBX_UNKNOWN == *value)
+	{
+		evaluate_unknown_error(stack[0].unknown_idx, NULL, unknown_msgs, error, max_error_len);
+		ret = FAIL;
+	}
+	else
+		ret = SUCCEED;
+out:
+	if (operands != operands_local)
+		zbx_free(operands);
+
+	return ret;
+}
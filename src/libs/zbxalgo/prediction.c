@@ -876,7 +876,7 @@ int	zbx_fit_code(char *fit_str, zbx_fit_t *fit, unsigned *k, char **error)
 	{
 		*fit = FIT_POLYNOMIAL;
 
-		if (SUCCEED != is_uint_range(fit_str + strlen("polynomial"), k, 1, 6))
+		if (SUCCEED != is_uint_range(fit_str + strlen("polynomial"), k, 1, ZBX_POLYNOMIAL_DEGREE_MAX))
 		{
 			*error = zbx_strdup(*error, "polynomial degree is invalid");
 			return FAIL;
@@ -982,55 +982,27 @@ static void	zbx_log_expression(double now, zbx_fit_t fit, int k, zbx_matrix_t *c
 		THIS_SHOULD_NEVER_HAPPEN;
 }
 
-double	zbx_forecast(double *t, double *x, int n, double now, double time, zbx_fit_t fit, unsigned k, zbx_mode_t mode)
+static int	zbx_forecast_by_coefficients(zbx_matrix_t *coefficients, double now, double time, zbx_fit_t fit,
+		zbx_mode_t mode, double *result)
 {
-	zbx_matrix_t	*coefficients = NULL;
-	double		left, right, result;
-	int		res;
-
-	if (1 == n)
-	{
-		if (MODE_VALUE == mode || MODE_MAX == mode || MODE_MIN == mode || MODE_AVG == mode)
-			return x[0];
-
-		if (MODE_DELTA == mode)
-			return 0.0;
-
-		THIS_SHOULD_NEVER_HAPPEN;
-		return ZBX_MATH_ERROR;
-	}
-
-	zbx_matrix_struct_alloc(&coefficients);
-
-	if (SUCCEED != (res = zbx_regression(t, x, n, fit, k, coefficients)))
-		goto out;
-
-	zbx_log_expression(now, fit, (int)k, coefficients);
+	double	left, right;
 
 	if (MODE_VALUE == mode)
-	{
-		res = zbx_calculate_value(now + time, coefficients, fit, &result);
-		goto out;
-	}
+		return zbx_calculate_value(now + time, coefficients, fit, result);
 
 	if (0.0 == time)
 	{
 		if (MODE_MAX == mode || MODE_MIN == mode || MODE_AVG == mode)
+			return zbx_calculate_value(now + time, coefficients, fit, result);
+
+		if (MODE_DELTA == mode)
 		{
-			res = zbx_calculate_value(now + time, coefficients, fit, &result);
-		}
-		else if (MODE_DELTA == mode)
-		{
-			result = 0.0;
-			res = SUCCEED;
-		}
-		else
-		{
-			THIS_SHOULD_NEVER_HAPPEN;
-			res = FAIL;
+			*result = 0.0;
+			return SUCCEED;
 		}
 
-		goto out;
+		THIS_SHOULD_NEVER_HAPPEN;
+		return FAIL;
 	}
 
 	if (FIT_LINEAR == fit || FIT_EXPONENTIAL == fit || FIT_LOGARITHMIC == fit || FIT_POWER == fit)
@@ -1039,88 +1011,78 @@ double	zbx_forecast(double *t, double *x, int n, double now, double time, zbx_fi
 		if (SUCCEED != zbx_calculate_value(now, coefficients, fit, &left) ||
 				SUCCEED != zbx_calculate_value(now + time, coefficients, fit, &right))
 		{
-			res = FAIL;
-			goto out;
+			return FAIL;
 		}
 
 		if (MODE_MAX == mode)
 		{
-			result = (left > right ? left : right);
+			*result = (left > right ? left : right);
 		}
 		else if (MODE_MIN == mode)
 		{
-			result = (left < right ? left : right);
+			*result = (left < right ? left : right);
 		}
 		else if (MODE_DELTA == mode)
 		{
-			result = (left > right ? left - right : right - left);
+			*result = (left > right ? left - right : right - left);
 		}
 		else if (MODE_AVG == mode)
 		{
 			if (FIT_LINEAR == fit)
 			{
-				result = 0.5 * (left + right);
+				*result = 0.5 * (left + right);
 			}
 			else if (FIT_EXPONENTIAL == fit)
 			{
-				result = (right - left) / time / ZBX_MATRIX_EL(coefficients, 1, 0);
+				*result = (right - left) / time / ZBX_MATRIX_EL(coefficients, 1, 0);
 			}
 			else if (FIT_LOGARITHMIC == fit)
 			{
-				result = right + ZBX_MATRIX_EL(coefficients, 1, 0) *
+				*result = right + ZBX_MATRIX_EL(coefficients, 1, 0) *
 						(log(1.0 + time / now) * now / time - 1.0);
 			}
 			else if (FIT_POWER == fit)
 			{
 				if (-1.0 != ZBX_MATRIX_EL(coefficients, 1, 0))
-					result = (right * (now + time) - left * now) / time /
+					*result = (right * (now + time) - left * now) / time /
 							(ZBX_MATRIX_EL(coefficients, 1, 0) + 1.0);
 				else
-					result = exp(ZBX_MATRIX_EL(coefficients, 0, 0)) * log(1.0 + time / now) / time;
+					*result = exp(ZBX_MATRIX_EL(coefficients, 0, 0)) * log(1.0 + time / now) / time;
 			}
 			else
 			{
 				THIS_SHOULD_NEVER_HAPPEN;
-				res = FAIL;
-				goto out;
+				return FAIL;
 			}
 		}
 		else
 		{
 			THIS_SHOULD_NEVER_HAPPEN;
-			res = FAIL;
-			goto out;
+			return FAIL;
 		}
 
-		res = SUCCEED;
+		return SUCCEED;
 	}
-	else if (FIT_POLYNOMIAL == fit)
+
+	if (FIT_POLYNOMIAL == fit)
 	{
 		if (MODE_MAX == mode || MODE_MIN == mode || MODE_DELTA == mode)
+			return zbx_polynomial_minmax(now, time, mode, coefficients, result);
+
+		if (MODE_AVG == mode)
 		{
-			res = zbx_polynomial_minmax(now, time, mode, coefficients, &result);
-		}
-		else if (MODE_AVG == mode)
-		{
-			result = (zbx_polynomial_antiderivative(now + time, coefficients) -
+			*result = (zbx_polynomial_antiderivative(now + time, coefficients) -
 					zbx_polynomial_antiderivative(now, coefficients)) / time;
-			res = SUCCEED;
-		}
-		else
-		{
-			THIS_SHOULD_NEVER_HAPPEN;
-			res = FAIL;
+			return SUCCEED;
 		}
 	}
-	else
-	{
-		THIS_SHOULD_NEVER_HAPPEN;
-		res = FAIL;
-	}
 
-out:
-	zbx_matrix_free(coefficients);
+	THIS_SHOULD_NEVER_HAPPEN;
+	return FAIL;
+}
 
+static double	zbx_forecast_result(int res, double result)
+{
 	if (SUCCEED != res)
 	{
 		result = ZBX_MATH_ERROR;
@@ -1142,60 +1104,52 @@ out:
 	return result;
 }
 
-double	zbx_timeleft(double *t, double *x, int n, double now, double threshold, zbx_fit_t fit, unsigned k)
+static int	zbx_timeleft_by_coefficients(zbx_matrix_t *coefficients, double now, double threshold, zbx_fit_t fit,
+		double *result)
 {
-	zbx_matrix_t	*coefficients = NULL;
-	double		current, result;
-	int		res;
-
-	if (1 == n)
-		return (x[0] == threshold ? 0.0 : DB_INFINITY);
-
-	zbx_matrix_struct_alloc(&coefficients);
-
-	if (SUCCEED != (res = zbx_regression(t, x, n, fit, k, coefficients)))
-		goto out;
+	double	current;
 
-	zbx_log_expression(now, fit, (int)k, coefficients);
+	if (SUCCEED != zbx_calculate_value(now, coefficients, fit, &current))
+		return FAIL;
 
-	if (SUCCEED != (res = zbx_calculate_value(now, coefficients, fit, &current)))
+	if (current == threshold)
 	{
-		goto out;
-	}
-	else if (current == threshold)
-	{
-		result = 0.0;
-		goto out;
+		*result = 0.0;
+		return SUCCEED;
 	}
 
 	if (FIT_LINEAR == fit)
 	{
-		result = (threshold - ZBX_MATRIX_EL(coefficients, 0, 0)) / ZBX_MATRIX_EL(coefficients, 1, 0) - now;
+		*result = (threshold - ZBX_MATRIX_EL(coefficients, 0, 0)) / ZBX_MATRIX_EL(coefficients, 1, 0) - now;
 	}
 	else if (FIT_POLYNOMIAL == fit)
 	{
-		res = zbx_polynomial_timeleft(now, threshold, coefficients, &result);
+		return zbx_polynomial_timeleft(now, threshold, coefficients, result);
 	}
 	else if (FIT_EXPONENTIAL == fit)
 	{
-		result = (log(threshold) - ZBX_MATRIX_EL(coefficients, 0, 0)) / ZBX_MATRIX_EL(coefficients, 1, 0) - now;
+		*result = (log(threshold) - ZBX_MATRIX_EL(coefficients, 0, 0)) / ZBX_MATRIX_EL(coefficients, 1, 0) - now;
 	}
 	else if (FIT_LOGARITHMIC == fit)
 	{
-		result = exp((threshold - ZBX_MATRIX_EL(coefficients, 0, 0)) / ZBX_MATRIX_EL(coefficients, 1, 0)) - now;
+		*result = exp((threshold - ZBX_MATRIX_EL(coefficients, 0, 0)) / ZBX_MATRIX_EL(coefficients, 1, 0)) - now;
 	}
 	else if (FIT_POWER == fit)
 	{
-		result = exp((log(threshold) - ZBX_MATRIX_EL(coefficients, 0, 0)) / ZBX_MATRIX_EL(coefficients, 1, 0))
+		*result = exp((log(threshold) - ZBX_MATRIX_EL(coefficients, 0, 0)) / ZBX_MATRIX_EL(coefficients, 1, 0))
 				- now;
 	}
 	else
 	{
 		THIS_SHOULD_NEVER_HAPPEN;
-		res = FAIL;
+		return FAIL;
 	}
 
-out:
+	return SUCCEED;
+}
+
+static double	zbx_timeleft_result(int res, double result)
+{
 	if (SUCCEED != res)
 	{
 		result = ZBX_MATH_ERROR;
@@ -1210,6 +1164,303 @@ out:
 		result = DB_INFINITY;
 	}
 
-	zbx_matrix_free(coefficients);
 	return result;
 }
+
+double	zbx_forecast(double *t, double *x, int n, double now, double time, zbx_fit_t fit, unsigned k, zbx_mode_t mode)
+{
+	zbx_matrix_t	*coefficients = NULL;
+	double		result = ZBX_MATH_ERROR;
+	int		res;
+
+	if (1 == n)
+	{
+		if (MODE_VALUE == mode || MODE_MAX == mode || MODE_MIN == mode || MODE_AVG == mode)
+			return x[0];
+
+		if (MODE_DELTA == mode)
+			return 0.0;
+
+		THIS_SHOULD_NEVER_HAPPEN;
+		return ZBX_MATH_ERROR;
+	}
+
+	zbx_matrix_struct_alloc(&coefficients);
+
+	if (SUCCEED == (res = zbx_regression(t, x, n, fit, k, coefficients)))
+	{
+		zbx_log_expression(now, fit, (int)k, coefficients);
+		res = zbx_forecast_by_coefficients(coefficients, now, time, fit, mode, &result);
+	}
+
+	zbx_matrix_free(coefficients);
+
+	return zbx_forecast_result(res, result);
+}
+
+double	zbx_timeleft(double *t, double *x, int n, double now, double threshold, zbx_fit_t fit, unsigned k)
+{
+	zbx_matrix_t	*coefficients = NULL;
+	double		result = ZBX_MATH_ERROR;
+	int		res;
+
+	if (1 == n)
+		return (x[0] == threshold ? 0.0 : DB_INFINITY);
+
+	zbx_matrix_struct_alloc(&coefficients);
+
+	if (SUCCEED == (res = zbx_regression(t, x, n, fit, k, coefficients)))
+	{
+		zbx_log_expression(now, fit, (int)k, coefficients);
+		res = zbx_timeleft_by_coefficients(coefficients, now, threshold, fit, &result);
+	}
+
+	zbx_matrix_free(coefficients);
+
+	return zbx_timeleft_result(res, result);
+}
+
+/*
+ * Streaming least squares regression.
+ *
+ * Normal equations of linear, polynomial and exponential fits depend on the
+ * data only through the sums of t^j (j = 0..2k) and x*t^j (j = 0..k), where
+ * x is replaced by log(x) for exponential fit. Keeping these sums updated as
+ * values enter and leave the data window allows to solve the (k+1)x(k+1)
+ * system without revisiting the whole window. The sums are kept in their own
+ * time frame, the resulting polynomial is shifted to the evaluation frame.
+ */
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_regression_init                                              *
+ *                                                                            *
+ * Purpose: initialize streaming regression state                             *
+ *                                                                            *
+ * Parameters: regression - [OUT] the regression state                        *
+ *             fit        - [IN] the fit                                      *
+ *             k          - [IN] the polynomial degree                        *
+ *                                                                            *
+ * Return value: SUCCEED - the state was initialized                          *
+ *               FAIL    - the fit cannot be calculated from streaming sums   *
+ *                                                                            *
+ * Comments: Logarithmic and power fits use log(t), which cannot be shifted   *
+ *           to another time frame, so they are not supported.                *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_regression_init(zbx_regression_t *regression, zbx_fit_t fit, unsigned k)
+{
+	if (FIT_LINEAR != fit && FIT_POLYNOMIAL != fit && FIT_EXPONENTIAL != fit)
+		return FAIL;
+
+	if (FIT_POLYNOMIAL == fit && (1 > k || ZBX_POLYNOMIAL_DEGREE_MAX < k))
+		return FAIL;
+
+	memset(regression, 0, sizeof(zbx_regression_t));
+	regression->fit = fit;
+	regression->k = (FIT_POLYNOMIAL == fit ? (int)k : 1);
+
+	return SUCCEED;
+}
+
+static void	zbx_regression_update(zbx_regression_t *regression, double t, double x, int sign)
+{
+	double	y, pow = 1.0;
+	int	i;
+
+	regression->n += sign;
+
+	if (FIT_EXPONENTIAL == regression->fit)
+	{
+		if (0.0 >= x)
+		{
+			regression->invalid += sign;
+			return;
+		}
+
+		y = log(x);
+	}
+	else
+		y = x;
+
+	for (i = 0; i <= 2 * regression->k; i++, pow *= t)
+	{
+		regression->sum_t[i] += sign * pow;
+
+		if (i <= regression->k)
+			regression->sum_xt[i] += sign * y * pow;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_regression_add                                               *
+ *                                                                            *
+ * Purpose: add value to the regression data window                           *
+ *                                                                            *
+ * Parameters: regression - [IN/OUT] the regression state                     *
+ *             t          - [IN] the value time in regression time frame      *
+ *             x          - [IN] the value                                    *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_regression_add(zbx_regression_t *regression, double t, double x)
+{
+	zbx_regression_update(regression, t, x, 1);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_regression_remove                                            *
+ *                                                                            *
+ * Purpose: remove value previously added to the regression data window       *
+ *                                                                            *
+ * Parameters: regression - [IN/OUT] the regression state                     *
+ *             t          - [IN] the value time in regression time frame      *
+ *             x          - [IN] the value                                    *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_regression_remove(zbx_regression_t *regression, double t, double x)
+{
+	zbx_regression_update(regression, t, x, -1);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_regression_coefficients                                      *
+ *                                                                            *
+ * Purpose: solve normal equations from the streaming sums                    *
+ *                                                                            *
+ * Parameters: regression   - [IN] the regression state                       *
+ *             shift        - [IN] the offset of regression time frame from   *
+ *                            evaluation time frame                           *
+ *             coefficients - [OUT] the fit coefficients in evaluation frame  *
+ *                                                                            *
+ * Return value: SUCCEED - the coefficients were calculated                   *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	zbx_regression_coefficients(const zbx_regression_t *regression, double shift,
+		zbx_matrix_t *coefficients)
+{
+	zbx_matrix_t	*normal = NULL, *inverse = NULL, *right = NULL;
+	int		i, j, k, res = FAIL;
+
+	if (2 > regression->n)
+	{
+		THIS_SHOULD_NEVER_HAPPEN;
+		return FAIL;
+	}
+
+	if (0 != regression->invalid)
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "data contains negative or zero values");
+		return FAIL;
+	}
+
+	if ((k = regression->k) > regression->n - 1)
+		k = regression->n - 1;
+
+	zbx_matrix_struct_alloc(&normal);
+	zbx_matrix_struct_alloc(&inverse);
+	zbx_matrix_struct_alloc(&right);
+
+	if (SUCCEED != zbx_matrix_alloc(normal, k + 1, k + 1) || SUCCEED != zbx_matrix_alloc(right, k + 1, 1))
+		goto out;
+
+	for (i = 0; i <= k; i++)
+	{
+		for (j = 0; j <= k; j++)
+			ZBX_MATRIX_EL(normal, i, j) = regression->sum_t[i + j];
+
+		ZBX_MATRIX_EL(right, i, 0) = regression->sum_xt[i];
+	}
+
+	if (SUCCEED != zbx_inverse_matrix(normal, inverse) || SUCCEED != zbx_matrix_mult(inverse, right, coefficients))
+		goto out;
+
+	/* Taylor shift - p(t) in regression frame becomes p(t + shift) in evaluation frame */
+	for (i = 0; i < k; i++)
+	{
+		for (j = k - 1; j >= i; j--)
+			ZBX_MATRIX_EL(coefficients, j, 0) += shift * ZBX_MATRIX_EL(coefficients, j + 1, 0);
+	}
+
+	res = SUCCEED;
+out:
+	zbx_matrix_free(normal);
+	zbx_matrix_free(inverse);
+	zbx_matrix_free(right);
+
+	return res;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_regression_forecast                                          *
+ *                                                                            *
+ * Purpose: calculate forecast from the streaming regression state            *
+ *                                                                            *
+ * Parameters: regression - [IN] the regression state with at least 2 values  *
+ *             shift      - [IN] the offset of regression time frame from     *
+ *                          evaluation time frame                             *
+ *             now        - [IN] the current time in evaluation frame         *
+ *             time       - [IN] the forecast period                          *
+ *             mode       - [IN] the forecast mode                            *
+ *                                                                            *
+ * Return value: the same result as zbx_forecast() on the window values       *
+ *                                                                            *
+ ******************************************************************************/
+double	zbx_regression_forecast(const zbx_regression_t *regression, double shift, double now, double time,
+		zbx_mode_t mode)
+{
+	zbx_matrix_t	*coefficients = NULL;
+	double		result = ZBX_MATH_ERROR;
+	int		res;
+
+	zbx_matrix_struct_alloc(&coefficients);
+
+	if (SUCCEED == (res = zbx_regression_coefficients(regression, shift, coefficients)))
+	{
+		zbx_log_expression(now, regression->fit, coefficients->rows - 1, coefficients);
+		res = zbx_forecast_by_coefficients(coefficients, now, time, regression->fit, mode, &result);
+	}
+
+	zbx_matrix_free(coefficients);
+
+	return zbx_forecast_result(res, result);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_regression_timeleft                                          *
+ *                                                                            *
+ * Purpose: calculate time left until threshold from the streaming regression *
+ *          state                                                             *
+ *                                                                            *
+ * Parameters: regression - [IN] the regression state with at least 2 values  *
+ *             shift      - [IN] the offset of regression time frame from     *
+ *                          evaluation time frame                             *
+ *             now        - [IN] the current time in evaluation frame         *
+ *             threshold  - [IN] the threshold                                *
+ *                                                                            *
+ * Return value: the same result as zbx_timeleft() on the window values       *
+ *                                                                            *
+ ******************************************************************************/
+double	zbx_regression_timeleft(const zbx_regression_t *regression, double shift, double now, double threshold)
+{
+	zbx_matrix_t	*coefficients = NULL;
+	double		result = ZBX_MATH_ERROR;
+	int		res;
+
+	zbx_matrix_struct_alloc(&coefficients);
+
+	if (SUCCEED == (res = zbx_regression_coefficients(regression, shift, coefficients)))
+	{
+		zbx_log_expression(now, regression->fit, coefficients->rows - 1, coefficients);
+		res = zbx_timeleft_by_coefficients(coefficients, now, threshold, regression->fit, &result);
+	}
+
+	zbx_matrix_free(coefficients);
+
+	return zbx_timeleft_result(res, result);
+}
@@ -24,6 +24,7 @@
 #include "vectorimpl.h"
 
 ZBX_VECTOR_IMPL(uint64, zbx_uint64_t)
+ZBX_VECTOR_IMPL(dbl, double)
 ZBX_PTR_VECTOR_IMPL(str, char *)
 ZBX_PTR_VECTOR_IMPL(ptr, void *)
 ZBX_VECTOR_IMPL(ptr_pair, zbx_ptr_pair_t)
@@ -94,6 +94,7 @@ extern int		CONFIG_TIMER_FORKS;
 ZBX_MEM_FUNC_IMPL(__config, config_mem)
 
 static void	dc_maintenance_precache_nested_groups(void);
+static char	*dc_expression_expand_user_macros(const char *expression);
 
 /******************************************************************************
  *                                                                            *
@@ -839,6 +840,34 @@ static int	set_hk_opt(int *value, int non_zero, int value_min, const char *value
 	return SUCCEED;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: dc_hk_partitions_supported                                       *
+ *                                                                            *
+ * Purpose: checks if history and trends tables are partitioned by the        *
+ *          configured database extension                                     *
+ *                                                                            *
+ * Parameters: db_extension - [IN] the database extension                     *
+ *                                                                            *
+ * Return value: SUCCEED - housekeeping can drop partitions                    *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	dc_hk_partitions_supported(const char *db_extension)
+{
+#if defined(HAVE_POSTGRESQL)
+	if (0 == zbx_strcmp_null(db_extension, ZBX_CONFIG_DB_EXTENSION_TIMESCALE))
+		return SUCCEED;
+#endif
+#if defined(HAVE_POSTGRESQL) || defined(HAVE_MYSQL)
+	if (0 == zbx_strcmp_null(db_extension, ZBX_CONFIG_DB_EXTENSION_PARTITIONS))
+		return SUCCEED;
+#endif
+	ZBX_UNUSED(db_extension);
+
+	return FAIL;
+}
+
 static int	DCsync_config(zbx_dbsync_t *sync, int *flags)
 {
 	const ZBX_TABLE	*config_table;
@@ -971,14 +1000,12 @@ static int	DCsync_config(zbx_dbsync_t *sync, int *flags)
 		config->config->hk.history = 1;	/* just enough to make 0 == items[i].history condition fail */
 	}
 
-#ifdef HAVE_POSTGRESQL
 	if (ZBX_HK_MODE_DISABLED != config->config->hk.history_mode &&
 			ZBX_HK_OPTION_ENABLED == config->config->hk.history_global &&
-			0 == zbx_strcmp_null(config->config->db_extension, ZBX_CONFIG_DB_EXTENSION_TIMESCALE))
+			SUCCEED == dc_hk_partitions_supported(config->config->db_extension))
 	{
 		config->config->hk.history_mode = ZBX_HK_MODE_PARTITION;
 	}
-#endif
 
 	config->config->hk.trends_mode = atoi(row[23]);
 	if (ZBX_HK_OPTION_ENABLED == (config->config->hk.trends_global = atoi(row[24])) &&
@@ -990,14 +1017,12 @@ static int	DCsync_config(zbx_dbsync_t *sync, int *flags)
 		config->config->hk.trends = 1;	/* just enough to make 0 == items[i].trends condition fail */
 	}
 
-#ifdef HAVE_POSTGRESQL
 	if (ZBX_HK_MODE_DISABLED != config->config->hk.trends_mode &&
 			ZBX_HK_OPTION_ENABLED == config->config->hk.trends_global &&
-			0 == zbx_strcmp_null(config->config->db_extension, ZBX_CONFIG_DB_EXTENSION_TIMESCALE))
+			SUCCEED == dc_hk_partitions_supported(config->config->db_extension))
 	{
 		config->config->hk.trends_mode = ZBX_HK_MODE_PARTITION;
 	}
-#endif
 
 	if (SUCCEED == ret && SUCCEED == zbx_dbsync_next(sync, &rowid, &db_row, &tag))	/* table must have */
 		zabbix_log(LOG_LEVEL_ERR, "table 'config' has multiple records");	/* only one record */
@@ -3171,6 +3196,80 @@ static void	DCsync_prototype_items(zbx_dbsync_t *sync)
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: dc_trigger_compile_expression                                    *
+ *                                                                            *
+ * Purpose: compile trigger expression and store the program in configuration *
+ *          cache                                                             *
+ *                                                                            *
+ * Parameters: program    - [IN/OUT] the compiled program, set to NULL if     *
+ *                                   expression must be evaluated as text     *
+ *             expression - [IN] the trigger expression                       *
+ *                                                                            *
+ * Comments: User macros are expanded before compiling, so the program must   *
+ *           be recompiled when user macros change. Expressions with unknown  *
+ *           or non-numeric macros are evaluated as text.                     *
+ *                                                                            *
+ ******************************************************************************/
+static void	dc_trigger_compile_expression(unsigned char **program, const char *expression)
+{
+	unsigned char	*code;
+	char		*expression_ex = NULL;
+	size_t		size;
+
+	if (NULL != *program)
+	{
+		__config_mem_free_func(*program);
+		*program = NULL;
+	}
+
+	if (NULL != strstr(expression, "{$"))
+	{
+		if (NULL == (expression_ex = dc_expression_expand_user_macros(expression)))
+			return;
+
+		expression = expression_ex;
+	}
+
+	if (SUCCEED == zbx_expression_compile(expression, &code))
+	{
+		size = zbx_expression_program_size(code);
+		*program = (unsigned char *)__config_mem_malloc_func(NULL, size);
+		memcpy(*program, code, size);
+		zbx_free(code);
+	}
+
+	zbx_free(expression_ex);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: dc_trigger_compile_macro_expressions                             *
+ *                                                                            *
+ * Purpose: recompile trigger expressions containing user macros              *
+ *                                                                            *
+ * Comments: This function must be called after user macro or host template   *
+ *           changes, as the compiled programs have user macros expanded.     *
+ *                                                                            *
+ ******************************************************************************/
+static void	dc_trigger_compile_macro_expressions(void)
+{
+	zbx_hashset_iter_t	iter;
+	ZBX_DC_TRIGGER		*trigger;
+
+	zbx_hashset_iter_reset(&config->triggers, &iter);
+
+	while (NULL != (trigger = (ZBX_DC_TRIGGER *)zbx_hashset_iter_next(&iter)))
+	{
+		if (NULL != strstr(trigger->expression, "{$"))
+			dc_trigger_compile_expression(&trigger->program, trigger->expression);
+
+		if (NULL != strstr(trigger->recovery_expression, "{$"))
+			dc_trigger_compile_expression(&trigger->recovery_program, trigger->recovery_expression);
+	}
+}
+
 static void	DCsync_triggers(zbx_dbsync_t *sync)
 {
 	char		**row;
@@ -3196,9 +3295,20 @@ static void	DCsync_triggers(zbx_dbsync_t *sync)
 
 		/* store new information in trigger structure */
 
+		if (0 == found)
+		{
+			trigger->program = NULL;
+			trigger->recovery_program = NULL;
+		}
+
 		DCstrpool_replace(found, &trigger->description, row[1]);
-		DCstrpool_replace(found, &trigger->expression, row[2]);
-		DCstrpool_replace(found, &trigger->recovery_expression, row[11]);
+
+		if (SUCCEED == DCstrpool_replace(found, &trigger->expression, row[2]))
+			dc_trigger_compile_expression(&trigger->program, trigger->expression);
+
+		if (SUCCEED == DCstrpool_replace(found, &trigger->recovery_expression, row[11]))
+			dc_trigger_compile_expression(&trigger->recovery_program, trigger->recovery_expression);
+
 		DCstrpool_replace(found, &trigger->correlation_tag, row[13]);
 		DCstrpool_replace(found, &trigger->opdata, row[14]);
 		ZBX_STR2UCHAR(trigger->priority, row[4]);
@@ -3267,6 +3377,12 @@ static void	DCsync_triggers(zbx_dbsync_t *sync)
 			zbx_strpool_release(trigger->correlation_tag);
 			zbx_strpool_release(trigger->opdata);
 
+			if (NULL != trigger->program)
+				__config_mem_free_func(trigger->program);
+
+			if (NULL != trigger->recovery_program)
+				__config_mem_free_func(trigger->recovery_program);
+
 			zbx_vector_ptr_destroy(&trigger->tags);
 
 			zbx_hashset_remove_direct(&config->triggers, trigger);
@@ -3279,6 +3395,11 @@ static void	DCsync_triggers(zbx_dbsync_t *sync)
 
 static void	DCconfig_sort_triggers_topologically(void);
 
+#define ZBX_TRIGDEP_MASTERS_UNKNOWN	0
+#define ZBX_TRIGDEP_MASTERS_RESOLVING	1
+#define ZBX_TRIGDEP_MASTERS_RESOLVED	2
+#define ZBX_TRIGDEP_MASTERS_PARTIAL	3
+
 /******************************************************************************
  *                                                                            *
  * Function: dc_trigger_deplist_release                                       *
@@ -3291,6 +3412,7 @@ static int	dc_trigger_deplist_release(ZBX_DC_TRIGGER_DEPLIST *trigdep)
 	if (0 == --trigdep->refcount)
 	{
 		zbx_vector_ptr_destroy(&trigdep->dependencies);
+		zbx_vector_ptr_destroy(&trigdep->masters);
 		zbx_hashset_remove_direct(&config->trigdeps, trigdep);
 		return SUCCEED;
 	}
@@ -3311,6 +3433,9 @@ static void	dc_trigger_deplist_init(ZBX_DC_TRIGGER_DEPLIST *trigdep, ZBX_DC_TRIG
 	trigdep->trigger = trigger;
 	zbx_vector_ptr_create_ext(&trigdep->dependencies, __config_mem_malloc_func, __config_mem_realloc_func,
 			__config_mem_free_func);
+	zbx_vector_ptr_create_ext(&trigdep->masters, __config_mem_malloc_func, __config_mem_realloc_func,
+			__config_mem_free_func);
+	trigdep->masters_state = ZBX_TRIGDEP_MASTERS_UNKNOWN;
 }
 
 /******************************************************************************
@@ -3328,7 +3453,18 @@ static void	dc_trigger_deplist_reset(ZBX_DC_TRIGGER_DEPLIST *trigdep)
 			__config_mem_free_func);
 }
 
-static void	DCsync_trigdeps(zbx_dbsync_t *sync)
+/******************************************************************************
+ *                                                                            *
+ * Function: DCsync_trigdeps                                                  *
+ *                                                                            *
+ * Purpose: updates trigger dependencies in configuration cache               *
+ *                                                                            *
+ * Parameters: sync     - [IN] the db synchronization data                    *
+ *             trigdeps - [OUT] the trigger dependency lists with changed     *
+ *                              dependencies, including removed lists         *
+ *                                                                            *
+ ******************************************************************************/
+static void	DCsync_trigdeps(zbx_dbsync_t *sync, zbx_vector_ptr_t *trigdeps)
 {
 	char			**row;
 	zbx_uint64_t		rowid;
@@ -3371,6 +3507,8 @@ static void	DCsync_trigdeps(zbx_dbsync_t *sync)
 			trigdep_up->refcount++;
 
 		zbx_vector_ptr_append(&trigdep_down->dependencies, trigdep_up);
+		zbx_vector_ptr_append(trigdeps, trigdep_down);
+		zbx_vector_ptr_append(trigdeps, trigdep_up);
 	}
 
 	/* remove deleted trigger dependencies from buffer */
@@ -3383,20 +3521,24 @@ static void	DCsync_trigdeps(zbx_dbsync_t *sync)
 			continue;
 		}
 
+		zbx_vector_ptr_append(trigdeps, trigdep_down);
+
+		/* look up the dependency before its master list might be released */
 		ZBX_STR2UINT64(triggerid_up, row[1]);
+		index = zbx_vector_ptr_search(&trigdep_down->dependencies, &triggerid_up,
+				ZBX_DEFAULT_UINT64_PTR_COMPARE_FUNC);
+
 		if (NULL != (trigdep_up = (ZBX_DC_TRIGGER_DEPLIST *)zbx_hashset_search(&config->trigdeps,
 				&triggerid_up)))
 		{
+			zbx_vector_ptr_append(trigdeps, trigdep_up);
 			dc_trigger_deplist_release(trigdep_up);
 		}
 
 		if (SUCCEED != dc_trigger_deplist_release(trigdep_down))
 		{
-			if (FAIL == (index = zbx_vector_ptr_search(&trigdep_down->dependencies, &triggerid_up,
-					ZBX_DEFAULT_UINT64_PTR_COMPARE_FUNC)))
-			{
+			if (FAIL == index)
 				continue;
-			}
 
 			if (1 == trigdep_down->dependencies.values_num)
 				dc_trigger_deplist_reset(trigdep_down);
@@ -4694,14 +4836,197 @@ static void	DCsync_hostgroup_hosts(zbx_dbsync_t *sync)
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: dc_trigdep_resolve_masters                                       *
+ *                                                                            *
+ * Purpose: collect all direct and indirect master trigger dependency lists   *
+ *          of the specified trigger dependency list                          *
+ *                                                                            *
+ * Parameters: trigdep  - [IN/OUT] the trigger dependency list                *
+ *             level    - [IN] the trigger dependency level                   *
+ *             partials - [OUT] the trigger dependency lists with masters     *
+ *                              resolved only partially                       *
+ *                                                                            *
+ * Return value: SUCCEED - all masters were resolved                          *
+ *               FAIL    - the masters were cut by a dependency cycle or      *
+ *                         too deep dependencies                              *
+ *                                                                            *
+ * Comments: Master lists are resolved recursively and reused by all          *
+ *           dependent triggers, so shared parts of dependency trees are      *
+ *           walked only once. A dependency cycle is reported when a list     *
+ *           being resolved is reached again.                                 *
+ *                                                                            *
+ ******************************************************************************/
+static int	dc_trigdep_resolve_masters(ZBX_DC_TRIGGER_DEPLIST *trigdep, int level, zbx_vector_ptr_t *partials)
+{
+	int			i, ret = SUCCEED;
+	ZBX_DC_TRIGGER_DEPLIST	*master;
+
+	switch (trigdep->masters_state)
+	{
+		case ZBX_TRIGDEP_MASTERS_RESOLVED:
+			return SUCCEED;
+		case ZBX_TRIGDEP_MASTERS_PARTIAL:
+			return FAIL;
+		case ZBX_TRIGDEP_MASTERS_RESOLVING:
+			zabbix_log(LOG_LEVEL_WARNING, "trigger dependency cycle detected (triggerid:" ZBX_FS_UI64 ")",
+					trigdep->triggerid);
+			return FAIL;
+	}
+
+	if (ZBX_TRIGGER_DEPENDENCY_LEVELS_MAX < level)
+	{
+		zabbix_log(LOG_LEVEL_CRIT, "recursive trigger dependency is too deep (triggerid:" ZBX_FS_UI64 ")",
+				trigdep->triggerid);
+		return FAIL;
+	}
+
+	trigdep->masters_state = ZBX_TRIGDEP_MASTERS_RESOLVING;
+
+	for (i = 0; i < trigdep->dependencies.values_num; i++)
+	{
+		master = (ZBX_DC_TRIGGER_DEPLIST *)trigdep->dependencies.values[i];
+
+		if (SUCCEED != dc_trigdep_resolve_masters(master, level + 1, partials))
+			ret = FAIL;
+
+		zbx_vector_ptr_append(&trigdep->masters, master);
+		zbx_vector_ptr_append_array(&trigdep->masters, master->masters.values, master->masters.values_num);
+	}
+
+	zbx_vector_ptr_sort(&trigdep->masters, ZBX_DEFAULT_PTR_COMPARE_FUNC);
+	zbx_vector_ptr_uniq(&trigdep->masters, ZBX_DEFAULT_PTR_COMPARE_FUNC);
+
+	if (SUCCEED == ret)
+	{
+		trigdep->masters_state = ZBX_TRIGDEP_MASTERS_RESOLVED;
+	}
+	else
+	{
+		trigdep->masters_state = ZBX_TRIGDEP_MASTERS_PARTIAL;
+		zbx_vector_ptr_append(partials, trigdep);
+	}
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: dc_trigdep_collect_masters                                       *
+ *                                                                            *
+ * Purpose: collect all direct and indirect master trigger dependency lists   *
+ *          by walking the dependencies of every master                       *
+ *                                                                            *
+ * Parameters: trigdep - [IN/OUT] the trigger dependency list                 *
+ *                                                                            *
+ * Comments: Used for dependency lists with masters cut by dependency cycles, *
+ *           the list itself is its master if it is part of the cycle.        *
+ *                                                                            *
+ ******************************************************************************/
+static void	dc_trigdep_collect_masters(ZBX_DC_TRIGGER_DEPLIST *trigdep)
+{
+	int			i, j;
+	ZBX_DC_TRIGGER_DEPLIST	*master, *next;
+
+	zbx_vector_ptr_clear(&trigdep->masters);
+	zbx_vector_ptr_append_array(&trigdep->masters, trigdep->dependencies.values,
+			trigdep->dependencies.values_num);
+
+	for (i = 0; i < trigdep->masters.values_num; i++)
+	{
+		master = (ZBX_DC_TRIGGER_DEPLIST *)trigdep->masters.values[i];
+
+		for (j = 0; j < master->dependencies.values_num; j++)
+		{
+			next = (ZBX_DC_TRIGGER_DEPLIST *)master->dependencies.values[j];
+
+			if (FAIL == zbx_vector_ptr_search(&trigdep->masters, next, ZBX_DEFAULT_PTR_COMPARE_FUNC))
+				zbx_vector_ptr_append(&trigdep->masters, next);
+		}
+	}
+
+	zbx_vector_ptr_sort(&trigdep->masters, ZBX_DEFAULT_PTR_COMPARE_FUNC);
+	zbx_vector_ptr_uniq(&trigdep->masters, ZBX_DEFAULT_PTR_COMPARE_FUNC);
+
+	trigdep->masters_state = ZBX_TRIGDEP_MASTERS_RESOLVED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: dc_trigger_update_masters                                        *
+ *                                                                            *
+ * Purpose: resolve master trigger dependency lists affected by trigger       *
+ *          dependency changes                                                *
+ *                                                                            *
+ * Parameters: trigdeps - [IN/OUT] the trigger dependency lists with changed  *
+ *                                 dependencies, including removed lists      *
+ *                                                                            *
+ * Comments: Only the changed lists and the lists having them as masters are  *
+ *           resolved again. The removed lists are compared by pointer and    *
+ *           never accessed.                                                  *
+ *                                                                            *
+ ******************************************************************************/
+static void	dc_trigger_update_masters(zbx_vector_ptr_t *trigdeps)
+{
+	zbx_hashset_iter_t	iter;
+	ZBX_DC_TRIGGER_DEPLIST	*trigdep;
+	zbx_vector_ptr_t	updates, partials;
+	int			i;
+
+	zbx_vector_ptr_sort(trigdeps, ZBX_DEFAULT_PTR_COMPARE_FUNC);
+	zbx_vector_ptr_uniq(trigdeps, ZBX_DEFAULT_PTR_COMPARE_FUNC);
+
+	zbx_vector_ptr_create(&updates);
+	zbx_vector_ptr_create(&partials);
+
+	zbx_hashset_iter_reset(&config->trigdeps, &iter);
+	while (NULL != (trigdep = (ZBX_DC_TRIGGER_DEPLIST *)zbx_hashset_iter_next(&iter)))
+	{
+		if (FAIL == zbx_vector_ptr_bsearch(trigdeps, trigdep, ZBX_DEFAULT_PTR_COMPARE_FUNC))
+		{
+			for (i = 0; i < trigdep->masters.values_num; i++)
+			{
+				if (FAIL != zbx_vector_ptr_bsearch(trigdeps, trigdep->masters.values[i],
+						ZBX_DEFAULT_PTR_COMPARE_FUNC))
+				{
+					break;
+				}
+			}
+
+			if (i == trigdep->masters.values_num && ZBX_TRIGDEP_MASTERS_RESOLVED == trigdep->masters_state)
+				continue;
+		}
+
+		zbx_vector_ptr_clear(&trigdep->masters);
+		trigdep->masters_state = ZBX_TRIGDEP_MASTERS_UNKNOWN;
+		zbx_vector_ptr_append(&updates, trigdep);
+	}
+
+	for (i = 0; i < updates.values_num; i++)
+		dc_trigdep_resolve_masters((ZBX_DC_TRIGGER_DEPLIST *)updates.values[i], 0, &partials);
+
+	for (i = 0; i < partials.values_num; i++)
+		dc_trigdep_collect_masters((ZBX_DC_TRIGGER_DEPLIST *)partials.values[i]);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "%s() trigger dependency lists:%d updated:%d partially resolved:%d", __func__,
+			config->trigdeps.num_data, updates.values_num, partials.values_num);
+
+	zbx_vector_ptr_destroy(&partials);
+	zbx_vector_ptr_destroy(&updates);
+}
+
 /******************************************************************************
  *                                                                            *
  * Function: dc_trigger_update_topology                                       *
  *                                                                            *
  * Purpose: updates trigger topology after trigger dependency changes         *
  *                                                                            *
+ * Parameters: trigdeps - [IN/OUT] the trigger dependency lists with changed  *
+ *                                 dependencies, including removed lists      *
+ *                                                                            *
  ******************************************************************************/
-static void	dc_trigger_update_topology(void)
+static void	dc_trigger_update_topology(zbx_vector_ptr_t *trigdeps)
 {
 	zbx_hashset_iter_t	iter;
 	ZBX_DC_TRIGGER		*trigger;
@@ -4711,6 +5036,7 @@ static void	dc_trigger_update_topology(void)
 		trigger->topoindex = 1;
 
 	DCconfig_sort_triggers_topologically();
+	dc_trigger_update_masters(trigdeps);
 }
 
 static int	zbx_default_ptr_pair_ptr_compare_func(const void *d1, const void *d2)
@@ -4724,8 +5050,6 @@ static int	zbx_default_ptr_pair_ptr_compare_func(const void *d1, const void *d2)
 	return 0;
 }
 
-#define ZBX_TIMER_DELAY		30
-
 /******************************************************************************
  *                                                                            *
  * Function: dc_timer_calculate_nextcheck                                     *
@@ -4839,11 +5163,18 @@ static void	dc_trigger_update_cache(void)
 
 	/* add triggers to timer queue */
 	now = time(NULL);
-	zbx_binary_heap_clear(&config->timer_queue);
+
+	for (i = 0; i < ZBX_TIMER_DELAY; i++)
+	{
+		zbx_vector_ptr_clear(&config->timer_queue[i].triggers);
+		config->timer_queue[i].nextcheck = dc_timer_calculate_nextcheck(now, (zbx_uint64_t)i);
+		config->timer_queue[i].index = 0;
+	}
+
 	zbx_hashset_iter_reset(&config->triggers, &iter);
 	while (NULL != (trigger = (ZBX_DC_TRIGGER *)zbx_hashset_iter_next(&iter)))
 	{
-		zbx_binary_heap_elem_t	elem;
+		zbx_dc_timer_slot_t	*slot;
 
 		if (TRIGGER_STATUS_DISABLED == trigger->status)
 			continue;
@@ -4854,10 +5185,9 @@ static void	dc_trigger_update_cache(void)
 		if (ZBX_TRIGGER_TIMER_QUEUE != trigger->timer)
 			continue;
 
-		trigger->nextcheck = dc_timer_calculate_nextcheck(now, trigger->triggerid);
-		elem.key = trigger->triggerid;
-		elem.data = (void *)trigger;
-		zbx_binary_heap_insert(&config->timer_queue, &elem);
+		/* triggers are spread over timer period by their identifiers, see dc_timer_calculate_nextcheck() */
+		slot = &config->timer_queue[trigger->triggerid % ZBX_TIMER_DELAY];
+		zbx_vector_ptr_append(&slot->triggers, trigger);
 	}
 }
 
@@ -4897,7 +5227,7 @@ static void	dc_hostgroups_update_cache(void)
  ******************************************************************************/
 void	DCsync_configuration(unsigned char mode)
 {
-	int		i, flags;
+	int		i, flags, timers_num;
 	double		sec, csec, hsec, hisec, htsec, gmsec, hmsec, ifsec, isec, tsec, dsec, fsec, expr_sec, csec2,
 			hsec2, hisec2, htsec2, gmsec2, hmsec2, ifsec2, isec2, tsec2, dsec2, fsec2, expr_sec2,
 			action_sec, action_sec2, action_op_sec, action_op_sec2, action_condition_sec,
@@ -4916,10 +5246,12 @@ void	DCsync_configuration(unsigned char mode)
 	double		autoreg_csec, autoreg_csec2;
 	zbx_dbsync_t	autoreg_config_sync;
 	zbx_uint64_t	update_flags = 0;
+	zbx_vector_ptr_t	trigdeps;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
 	zbx_dbsync_init_env(config);
+	zbx_vector_ptr_create(&trigdeps);
 
 	/* global configuration must be synchronized directly with database */
 	zbx_dbsync_init(&config_sync, ZBX_DBSYNC_INIT);
@@ -5210,7 +5542,7 @@ void	DCsync_configuration(unsigned char mode)
 	tsec2 = zbx_time() - sec;
 
 	sec = zbx_time();
-	DCsync_trigdeps(&tdep_sync);
+	DCsync_trigdeps(&tdep_sync, &trigdeps);
 	dsec2 = zbx_time() - sec;
 
 	sec = zbx_time();
@@ -5265,9 +5597,20 @@ void	DCsync_configuration(unsigned char mode)
 	if (0 != tdep_sync.add_num + tdep_sync.update_num + tdep_sync.remove_num)
 		update_flags |= ZBX_DBSYNC_UPDATE_TRIGGER_DEPENDENCY;
 
+	if (0 != gmacro_sync.add_num + gmacro_sync.update_num + gmacro_sync.remove_num +
+			hmacro_sync.add_num + hmacro_sync.update_num + hmacro_sync.remove_num +
+			htmpl_sync.add_num + htmpl_sync.update_num + htmpl_sync.remove_num)
+	{
+		update_flags |= ZBX_DBSYNC_UPDATE_MACROS;
+	}
+
+	/* compiled trigger expressions have user macros expanded */
+	if (0 != (update_flags & ZBX_DBSYNC_UPDATE_MACROS))
+		dc_trigger_compile_macro_expressions();
+
 	/* update trigger topology if trigger dependency was changed */
 	if (0 != (update_flags & ZBX_DBSYNC_UPDATE_TRIGGER_DEPENDENCY))
-		dc_trigger_update_topology();
+		dc_trigger_update_topology(&trigdeps);
 
 	/* update various trigger related links in cache */
 	if (0 != (update_flags & (ZBX_DBSYNC_UPDATE_HOSTS | ZBX_DBSYNC_UPDATE_ITEMS | ZBX_DBSYNC_UPDATE_FUNCTIONS |
@@ -5514,8 +5857,10 @@ void	DCsync_configuration(unsigned char mode)
 		zabbix_log(LOG_LEVEL_DEBUG, "%s() pqueue     : %d (%d allocated)", __func__,
 				config->pqueue.elems_num, config->pqueue.elems_alloc);
 
-		zabbix_log(LOG_LEVEL_DEBUG, "%s() timer queue: %d (%d allocated)", __func__,
-				config->timer_queue.elems_num, config->timer_queue.elems_alloc);
+		for (i = 0, timers_num = 0; i < ZBX_TIMER_DELAY; i++)
+			timers_num += config->timer_queue[i].triggers.values_num;
+
+		zabbix_log(LOG_LEVEL_DEBUG, "%s() timer queue: %d", __func__, timers_num);
 
 		zabbix_log(LOG_LEVEL_DEBUG, "%s() configfree : " ZBX_FS_DBL "%%", __func__,
 				100 * ((double)config_mem->free_size / config_mem->orig_size));
@@ -5570,6 +5915,8 @@ out:
 	zbx_dbsync_clear(&maintenance_host_sync);
 	zbx_dbsync_clear(&hgroup_host_sync);
 
+	zbx_vector_ptr_destroy(&trigdeps);
+
 	zbx_dbsync_free_env();
 
 	if (SUCCEED == ZBX_CHECK_LOG_LEVEL(LOG_LEVEL_TRACE))
@@ -5860,19 +6207,6 @@ static int	__config_psk_compare(const void *d1, const void *d2)
 }
 #endif
 
-static int	__config_timer_compare(const void *d1, const void *d2)
-{
-	const zbx_binary_heap_elem_t	*e1 = (const zbx_binary_heap_elem_t *)d1;
-	const zbx_binary_heap_elem_t	*e2 = (const zbx_binary_heap_elem_t *)d2;
-
-	const ZBX_DC_TRIGGER		*t1 = (const ZBX_DC_TRIGGER *)e1->data;
-	const ZBX_DC_TRIGGER		*t2 = (const ZBX_DC_TRIGGER *)e2->data;
-
-	ZBX_RETURN_IF_NOT_EQUAL(t1->nextcheck, t2->nextcheck);
-
-	return 0;
-}
-
 static zbx_hash_t	__config_data_session_hash(const void *data)
 {
 	const zbx_data_session_t	*session = (const zbx_data_session_t *)data;
@@ -6030,12 +6364,16 @@ int	init_configuration_cache(char **error)
 					__config_mem_realloc_func,
 					__config_mem_free_func);
 
-	zbx_binary_heap_create_ext(&config->timer_queue,
-					__config_timer_compare,
-					ZBX_BINARY_HEAP_OPTION_DIRECT,
-					__config_mem_malloc_func,
-					__config_mem_realloc_func,
-					__config_mem_free_func);
+	for (i = 0; i < ZBX_TIMER_DELAY; i++)
+	{
+		zbx_vector_ptr_create_ext(&config->timer_queue[i].triggers,
+				__config_mem_malloc_func,
+				__config_mem_realloc_func,
+				__config_mem_free_func);
+
+		config->timer_queue[i].nextcheck = 0;
+		config->timer_queue[i].index = 0;
+	}
 
 	CREATE_HASHSET_EXT(config->data_sessions, 0, __config_data_session_hash, __config_data_session_compare);
 
@@ -6495,6 +6833,36 @@ static void	DCget_interface(DC_INTERFACE *dst_interface, const ZBX_DC_INTERFACE
 	dst_interface->port = 0;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: dc_item_get_preprocessing                                        *
+ *                                                                            *
+ * Purpose: check if item values must be passed to preprocessing manager      *
+ *                                                                            *
+ * Parameters: item - [IN] the item                                           *
+ *                                                                            *
+ * Return value: ZBX_ITEM_PREPROCESSING_REQUIRED - item has preprocessing     *
+ *                         steps, dependent items or is low-level discovery   *
+ *                         rule on server                                     *
+ *               ZBX_ITEM_PREPROCESSING_NONE     - item values can be added   *
+ *                         to history cache directly                          *
+ *                                                                            *
+ ******************************************************************************/
+static unsigned char	dc_item_get_preprocessing(const ZBX_DC_ITEM *item)
+{
+	if (NULL != zbx_hashset_search(&config->preprocitems, &item->itemid))
+		return ZBX_ITEM_PREPROCESSING_REQUIRED;
+
+	if (NULL != zbx_hashset_search(&config->masteritems, &item->itemid))
+		return ZBX_ITEM_PREPROCESSING_REQUIRED;
+
+	/* preprocessing manager forwards low-level discovery rule values to LLD manager on server */
+	if (0 != (ZBX_FLAG_DISCOVERY_RULE & item->flags) && 0 != (program_type & ZBX_PROGRAM_TYPE_SERVER))
+		return ZBX_ITEM_PREPROCESSING_REQUIRED;
+
+	return ZBX_ITEM_PREPROCESSING_NONE;
+}
+
 static void	DCget_item(DC_ITEM *dst_item, const ZBX_DC_ITEM *src_item)
 {
 	const ZBX_DC_NUMITEM		*numitem;
@@ -6528,6 +6896,7 @@ static void	DCget_item(DC_ITEM *dst_item, const ZBX_DC_ITEM *src_item)
 	dst_item->valuemapid = src_item->valuemapid;
 	dst_item->status = src_item->status;
 	dst_item->history_sec = src_item->history_sec;
+	dst_item->preprocessing = dc_item_get_preprocessing(src_item);
 
 	dst_item->error = zbx_strdup(NULL, src_item->error);
 
@@ -6810,6 +7179,21 @@ static void	DCget_function(DC_FUNCTION *dst_function, const ZBX_DC_FUNCTION *src
 	memcpy(dst_function->parameter, src_function->parameter, sz_parameter);
 }
 
+static unsigned char	*dc_trigger_copy_program(const unsigned char *program)
+{
+	unsigned char	*copy;
+	size_t		size;
+
+	if (NULL == program)
+		return NULL;
+
+	size = zbx_expression_program_size(program);
+	copy = (unsigned char *)zbx_malloc(NULL, size);
+	memcpy(copy, program, size);
+
+	return copy;
+}
+
 static void	DCget_trigger(DC_TRIGGER *dst_trigger, const ZBX_DC_TRIGGER *src_trigger)
 {
 	int	i;
@@ -6842,6 +7226,9 @@ static void	DCget_trigger(DC_TRIGGER *dst_trigger, const ZBX_DC_TRIGGER *src_tri
 	dst_trigger->expression = zbx_strdup(NULL, src_trigger->expression);
 	dst_trigger->recovery_expression = zbx_strdup(NULL, src_trigger->recovery_expression);
 
+	dst_trigger->program = dc_trigger_copy_program(src_trigger->program);
+	dst_trigger->recovery_program = dc_trigger_copy_program(src_trigger->recovery_program);
+
 	zbx_vector_ptr_create(&dst_trigger->tags);
 
 	if (0 != src_trigger->tags.values_num)
@@ -6884,6 +7271,8 @@ static void	DCclean_trigger(DC_TRIGGER *trigger)
 	zbx_free(trigger->recovery_expression_orig);
 	zbx_free(trigger->expression);
 	zbx_free(trigger->recovery_expression);
+	zbx_free(trigger->program);
+	zbx_free(trigger->recovery_program);
 	zbx_free(trigger->description);
 	zbx_free(trigger->correlation_tag);
 	zbx_free(trigger->opdata);
@@ -6990,6 +7379,60 @@ void	DCconfig_get_items_by_itemids(DC_ITEM *items, const zbx_uint64_t *itemids,
 	UNLOCK_CACHE;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_dc_get_active_numeric_itemids                                *
+ *                                                                            *
+ * Purpose: get identifiers of supported numeric items of monitored hosts     *
+ *          grouped by item value type                                        *
+ *                                                                            *
+ * Parameters: itemids        - [IN] array of item IDs                        *
+ *             num            - [IN] number of elements                       *
+ *             itemids_float  - [OUT] the floating point item IDs             *
+ *             itemids_uint64 - [OUT] the unsigned integer item IDs           *
+ *                                                                            *
+ * Comments: This is a lightweight alternative of                             *
+ *           DCconfig_get_items_by_itemids() for callers that need only to    *
+ *           filter items before reading their values.                        *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_dc_get_active_numeric_itemids(const zbx_uint64_t *itemids, int num, zbx_vector_uint64_t *itemids_float,
+		zbx_vector_uint64_t *itemids_uint64)
+{
+	int			i;
+	const ZBX_DC_ITEM	*dc_item;
+	const ZBX_DC_HOST	*dc_host;
+
+	RDLOCK_CACHE;
+
+	for (i = 0; i < num; i++)
+	{
+		if (NULL == (dc_item = (ZBX_DC_ITEM *)zbx_hashset_search(&config->items, &itemids[i])))
+			continue;
+
+		if (ITEM_STATUS_ACTIVE != dc_item->status || ITEM_STATE_NORMAL != dc_item->state)
+			continue;
+
+		if (NULL == (dc_host = (ZBX_DC_HOST *)zbx_hashset_search(&config->hosts, &dc_item->hostid)) ||
+				HOST_STATUS_MONITORED != dc_host->status)
+		{
+			continue;
+		}
+
+		switch (dc_item->value_type)
+		{
+			case ITEM_VALUE_TYPE_FLOAT:
+				zbx_vector_uint64_append(itemids_float, dc_item->itemid);
+				break;
+			case ITEM_VALUE_TYPE_UINT64:
+				zbx_vector_uint64_append(itemids_uint64, dc_item->itemid);
+				break;
+		}
+	}
+
+	UNLOCK_CACHE;
+}
+
 /******************************************************************************
  *                                                                            *
  * Function: dc_preproc_item_init                                             *
@@ -7590,32 +8033,48 @@ void	zbx_dc_get_timer_triggers_by_triggerids(zbx_hashset_t *trigger_info, zbx_ve
  *                                                                            *
  * Comments: This function locks returned triggerids in configuration cache.  *
  *                                                                            *
+ *           Timer triggers are grouped into slots by the second of timer     *
+ *           period they are checked at. The due slots are processed as a     *
+ *           whole, oldest first, so all triggers of a slot are returned with *
+ *           the same check time and are evaluated in one batch. If the limit *
+ *           is reached the slot processing is continued by the next call.    *
+ *                                                                            *
  ******************************************************************************/
 void	zbx_dc_get_timer_triggerids(zbx_vector_uint64_t *triggerids, int now, int limit)
 {
+	int	i, slotnum;
+
 	WRLOCK_CACHE;
 
-	while (SUCCEED != zbx_binary_heap_empty(&config->timer_queue) && 0 != limit)
+	/* the slot following the current second was due the longest time ago */
+	for (i = 1; i <= ZBX_TIMER_DELAY && 0 != limit; i++)
 	{
-		zbx_binary_heap_elem_t	*elem;
-		ZBX_DC_TRIGGER		*dc_trigger;
+		zbx_dc_timer_slot_t	*slot;
 
-		elem = zbx_binary_heap_find_min(&config->timer_queue);
-		dc_trigger = (ZBX_DC_TRIGGER *)elem->data;
+		slotnum = (now + i) % ZBX_TIMER_DELAY;
+		slot = &config->timer_queue[slotnum];
 
-		if (dc_trigger->nextcheck > now)
-			break;
+		if (slot->nextcheck > now)
+			continue;
 
-		/* locked triggers are already being processed by other processes, we can skip them */
-		if (0 == dc_trigger->locked)
+		while (slot->index < slot->triggers.values_num && 0 != limit)
 		{
-			zbx_vector_uint64_append(triggerids, dc_trigger->triggerid);
-			dc_trigger->locked = 1;
-			limit--;
+			ZBX_DC_TRIGGER	*dc_trigger = (ZBX_DC_TRIGGER *)slot->triggers.values[slot->index++];
+
+			/* locked triggers are already being processed by other processes, we can skip them */
+			if (0 == dc_trigger->locked)
+			{
+				zbx_vector_uint64_append(triggerids, dc_trigger->triggerid);
+				dc_trigger->locked = 1;
+				limit--;
+			}
 		}
 
-		dc_trigger->nextcheck = dc_timer_calculate_nextcheck(now, dc_trigger->triggerid);
-		zbx_binary_heap_update_direct(&config->timer_queue, elem);
+		if (slot->index == slot->triggers.values_num)
+		{
+			slot->nextcheck = dc_timer_calculate_nextcheck(now, (zbx_uint64_t)slotnum);
+			slot->index = 0;
+		}
 	}
 
 	UNLOCK_CACHE;
@@ -7630,8 +8089,16 @@ void	zbx_dc_get_timer_triggerids(zbx_vector_uint64_t *triggerids, int now, int l
  ******************************************************************************/
 void	zbx_dc_clear_timer_queue(void)
 {
+	int	i;
+
 	WRLOCK_CACHE;
-	zbx_binary_heap_clear(&config->timer_queue);
+
+	for (i = 0; i < ZBX_TIMER_DELAY; i++)
+	{
+		zbx_vector_ptr_clear(&config->timer_queue[i].triggers);
+		config->timer_queue[i].index = 0;
+	}
+
 	UNLOCK_CACHE;
 }
 
@@ -8906,10 +9373,11 @@ int	DCset_hosts_availability(zbx_vector_ptr_t *availabilities)
 
 /******************************************************************************
  *                                                                            *
- * Comments: helper function for trigger dependency checking                  *
+ * Function: dc_trigger_check_dependencies                                    *
+ *                                                                            *
+ * Purpose: helper function for trigger dependency checking                   *
  *                                                                            *
  * Parameters: trigdep        - [IN] the trigger dependency data              *
- *             level          - [IN] the trigger dependency level             *
  *             triggerids     - [IN] the currently processing trigger ids     *
  *                                   for bulk trigger operations              *
  *                                   (optional, can be NULL)                  *
@@ -8928,48 +9396,36 @@ int	DCset_hosts_availability(zbx_vector_ptr_t *availabilities)
  *           vector, so the dependency check can be performed after a new     *
  *           master trigger value has been calculated.                        *
  *                                                                            *
+ *           The direct and indirect masters are resolved when trigger        *
+ *           dependencies change, so the check does not walk dependency tree. *
+ *                                                                            *
  ******************************************************************************/
-static int	DCconfig_check_trigger_dependencies_rec(const ZBX_DC_TRIGGER_DEPLIST *trigdep, int level,
+static int	dc_trigger_check_dependencies(const ZBX_DC_TRIGGER_DEPLIST *trigdep,
 		const zbx_vector_uint64_t *triggerids, zbx_vector_uint64_t *master_triggerids)
 {
 	int				i;
-	const ZBX_DC_TRIGGER		*next_trigger;
-	const ZBX_DC_TRIGGER_DEPLIST	*next_trigdep;
+	const ZBX_DC_TRIGGER		*master_trigger;
+	const ZBX_DC_TRIGGER_DEPLIST	*master_trigdep;
 
-	if (ZBX_TRIGGER_DEPENDENCY_LEVELS_MAX < level)
+	for (i = 0; i < trigdep->masters.values_num; i++)
 	{
-		zabbix_log(LOG_LEVEL_CRIT, "recursive trigger dependency is too deep (triggerid:" ZBX_FS_UI64 ")",
-				trigdep->triggerid);
-		return SUCCEED;
-	}
+		master_trigdep = (const ZBX_DC_TRIGGER_DEPLIST *)trigdep->masters.values[i];
 
-	if (0 != trigdep->dependencies.values_num)
-	{
-		for (i = 0; i < trigdep->dependencies.values_num; i++)
+		if (NULL == (master_trigger = master_trigdep->trigger) ||
+				TRIGGER_STATUS_ENABLED != master_trigger->status ||
+				TRIGGER_FUNCTIONAL_TRUE != master_trigger->functional)
 		{
-			next_trigdep = (const ZBX_DC_TRIGGER_DEPLIST *)trigdep->dependencies.values[i];
-
-			if (NULL != (next_trigger = next_trigdep->trigger) &&
-					TRIGGER_STATUS_ENABLED == next_trigger->status &&
-					TRIGGER_FUNCTIONAL_TRUE == next_trigger->functional)
-			{
-
-				if (NULL == triggerids || FAIL == zbx_vector_uint64_bsearch(triggerids,
-						next_trigger->triggerid, ZBX_DEFAULT_UINT64_COMPARE_FUNC))
-				{
-					if (TRIGGER_VALUE_PROBLEM == next_trigger->value)
-						return FAIL;
-				}
-				else
-					zbx_vector_uint64_append(master_triggerids, next_trigger->triggerid);
-			}
+			continue;
+		}
 
-			if (FAIL == DCconfig_check_trigger_dependencies_rec(next_trigdep, level + 1, triggerids,
-					master_triggerids))
-			{
+		if (NULL == triggerids || FAIL == zbx_vector_uint64_bsearch(triggerids, master_trigger->triggerid,
+				ZBX_DEFAULT_UINT64_COMPARE_FUNC))
+		{
+			if (TRIGGER_VALUE_PROBLEM == master_trigger->value)
 				return FAIL;
-			}
 		}
+		else
+			zbx_vector_uint64_append(master_triggerids, master_trigger->triggerid);
 	}
 
 	return SUCCEED;
@@ -8995,7 +9451,7 @@ int	DCconfig_check_trigger_dependencies(zbx_uint64_t triggerid)
 	RDLOCK_CACHE;
 
 	if (NULL != (trigdep = (const ZBX_DC_TRIGGER_DEPLIST *)zbx_hashset_search(&config->trigdeps, &triggerid)))
-		ret = DCconfig_check_trigger_dependencies_rec(trigdep, 0, NULL, NULL);
+		ret = dc_trigger_check_dependencies(trigdep, NULL, NULL);
 
 	UNLOCK_CACHE;
 
@@ -11888,7 +12344,7 @@ void	zbx_dc_get_trigger_dependencies(const zbx_vector_uint64_t *triggerids, zbx_
 		if (NULL == (trigdep = (ZBX_DC_TRIGGER_DEPLIST *)zbx_hashset_search(&config->trigdeps, &triggerids->values[i])))
 			continue;
 
-		if (FAIL == (ret = DCconfig_check_trigger_dependencies_rec(trigdep, 0, triggerids, &masterids)) ||
+		if (FAIL == (ret = dc_trigger_check_dependencies(trigdep, triggerids, &masterids)) ||
 				0 != masterids.values_num)
 		{
 			dep = (zbx_trigger_dep_t *)zbx_malloc(NULL, sizeof(zbx_trigger_dep_t));
@@ -12258,4 +12714,7 @@ void	zbx_dc_get_item_tags_by_functionids(const zbx_uint64_t *functionids, size_t
 
 #ifdef HAVE_TESTS
 #	include "../../../tests/libs/zbxdbcache/dc_item_poller_type_update_test.c"
+#	include "../../../tests/libs/zbxdbcache/dc_trigger_compile_expression_test.c"
+#	include "../../../tests/libs/zbxdbcache/dc_timer_queue_test.c"
+#	include "../../../tests/libs/zbxdbcache/dc_trigdep_test.c"
 #endif
@@ -33,9 +33,9 @@ typedef struct
 	const char		*error;
 	const char		*correlation_tag;
 	const char		*opdata;
+	unsigned char		*program;		/* compiled expression, NULL if it must */
+	unsigned char		*recovery_program;	/* be evaluated as text                 */
 	int			lastchange;
-	int			nextcheck;		/* time of next trigger recalculation,    */
-							/* valid for triggers with time functions */
 	unsigned char		topoindex;
 	unsigned char		priority;
 	unsigned char		type;
@@ -58,6 +58,10 @@ typedef struct zbx_dc_trigger_deplist
 	int			refcount;
 	ZBX_DC_TRIGGER		*trigger;
 	zbx_vector_ptr_t	dependencies;
+
+	/* direct and indirect master trigger dependency lists, resolved after dependency changes */
+	zbx_vector_ptr_t	masters;
+	unsigned char		masters_state;
 }
 ZBX_DC_TRIGGER_DEPLIST;
 
@@ -723,6 +727,18 @@ typedef struct
 }
 zbx_dc_timer_trigger_t;
 
+/* the timer trigger queue period, timer triggers are recalculated once per period */
+#define ZBX_TIMER_DELAY		30
+
+/* timer trigger queue slot, holding the triggers recalculated at the same second of timer period */
+typedef struct
+{
+	zbx_vector_ptr_t	triggers;
+	int			nextcheck;	/* time of the next slot trigger recalculation */
+	int			index;		/* the next trigger to process when slot is processed in parts */
+}
+zbx_dc_timer_slot_t;
+
 typedef struct
 {
 	/* timestamp of the last host availability diff sent to sever, used only by proxies */
@@ -803,7 +819,7 @@ typedef struct
 	zbx_hashset_t		data_sessions;
 	zbx_binary_heap_t	queues[ZBX_POLLER_TYPE_COUNT];
 	zbx_binary_heap_t	pqueue;
-	zbx_binary_heap_t	timer_queue;
+	zbx_dc_timer_slot_t	timer_queue[ZBX_TIMER_DELAY];
 	ZBX_DC_CONFIG_TABLE	*config;
 	ZBX_DC_STATUS		*status;
 	zbx_hashset_t		strpool;
@@ -47,11 +47,22 @@
  * When cache runs out of memory to store new items it enters in low memory mode.
  * In low memory mode cache continues to function as before with few restrictions:
  *   1) items that weren't accessed during the last day are removed from cache.
- *   2) items with worst hits/values ratio might be removed from cache to free the space.
+ *   2) items with the lowest weight might be removed from cache to free the space.
+ *      The item weight depends on the configured eviction policy (ZBX_VC_EVICTION_*):
+ *        - hits/values ratio (default),
+ *        - last access time (LRU),
+ *        - number of hits (LFU),
+ *        - hits multiplied by the average database read time per cached byte (cost).
  *   3) no new items are added to the cache.
  *
- * The low memory mode can't be turned off - it will persist until server is rebooted.
+ * The low memory mode is switched back to normal mode after a day.
  * In low memory mode a warning message is written into log every 5 minutes.
+ *
+ * Additionally the memory used by history data of each value type can be limited by
+ * a quota. When the quota is reached the items of the same value type with the lowest
+ * weight are removed from cache, without entering low memory mode. The quota is applied
+ * to the accounted item memory (data chunks and value contents), where strings shared
+ * in the string pool are accounted for every referencing value.
  */
 
 /* the period of low memory warning messages */
@@ -77,6 +88,16 @@ static int	vc_state = ZBX_VC_DISABLED;
 /* the value cache size */
 extern zbx_uint64_t	CONFIG_VALUE_CACHE_SIZE;
 
+/* the value cache eviction policy, see ZBX_VC_EVICTION_* defines */
+extern int	CONFIG_VALUE_CACHE_EVICTION;
+
+/* the value cache quotas per value type, in percents of value cache size (0 - no quota) */
+extern int	CONFIG_VALUE_CACHE_QUOTA_FLOAT;
+extern int	CONFIG_VALUE_CACHE_QUOTA_STR;
+extern int	CONFIG_VALUE_CACHE_QUOTA_LOG;
+extern int	CONFIG_VALUE_CACHE_QUOTA_UINT64;
+extern int	CONFIG_VALUE_CACHE_QUOTA_TEXT;
+
 ZBX_MEM_FUNC_IMPL(__vc, vc_mem)
 
 #define VC_STRPOOL_INIT_SIZE	(1000)
@@ -179,6 +200,24 @@ typedef struct
 	/* in low memory situation.                                   */
 	zbx_uint64_t	hits;
 
+	/* the number of values read from database for this item      */
+	zbx_uint64_t	misses;
+
+	/* The number of database requests made to cache item values  */
+	/* and the total time spent on them in seconds.               */
+	/* Used to estimate the cost of dropping item from cache.     */
+	zbx_uint64_t	db_fetches;
+	double		db_fetch_time;
+
+	/* The memory used by item history data - data chunks and     */
+	/* value contents. Used to enforce value type quotas.         */
+	size_t		memory;
+
+	/* The item data revision, changed whenever new values are    */
+	/* added to item. Used to validate results calculated from    */
+	/* cached item values.                                        */
+	zbx_uint64_t	revision;
+
 	/* the last (newest) chunk of item history data               */
 	zbx_vc_chunk_t	*head;
 
@@ -208,6 +247,30 @@ typedef struct
 	/* the minimum number of bytes to be freed when cache runs out of space */
 	size_t		min_free_request;
 
+	/* the item eviction policy - see ZBX_VC_EVICTION_* defines */
+	int		eviction;
+
+	/* the memory used by item history data per value type */
+	size_t		memory[ITEM_VALUE_TYPE_MAX];
+
+	/* the memory quotas per value type, 0 - no quota */
+	size_t		quota[ITEM_VALUE_TYPE_MAX];
+
+	/* timestamps of the last quota warning messages per value type */
+	int		last_quota_warning_time[ITEM_VALUE_TYPE_MAX];
+
+	/* Timestamps of the last quota release attempts that failed to free */
+	/* enough space per value type. Used to avoid scanning all items on  */
+	/* every allocation while nothing can be dropped from cache.         */
+	int		last_quota_release_fail_time[ITEM_VALUE_TYPE_MAX];
+
+	/* the number of database requests made to cache item values and the time spent on them */
+	zbx_uint64_t	db_fetches;
+	double		db_fetch_time;
+
+	/* the last assigned item data revision, never reset so revisions are unique */
+	zbx_uint64_t	revision;
+
 	/* the cached items */
 	zbx_hashset_t	items;
 
@@ -222,7 +285,7 @@ typedef struct
 	/* a pointer to the value cache item */
 	zbx_vc_item_t	*item;
 
-	/* the item 'weight' - <number of hits> / <number of cache records> */
+	/* the item 'weight', depends on the eviction policy - see vc_item_weight() */
 	double		weight;
 }
 zbx_vc_item_weight_t;
@@ -230,6 +293,9 @@ zbx_vc_item_weight_t;
 ZBX_VECTOR_DECL(vc_itemweight, zbx_vc_item_weight_t)
 ZBX_VECTOR_IMPL(vc_itemweight, zbx_vc_item_weight_t)
 
+/* appends history record to the output vector - either history record vector or packed value vector */
+typedef void	(*vc_value_append_func_t)(void *vector, int value_type, const zbx_history_record_t *value);
+
 /* the value cache */
 static zbx_vc_cache_t	*vc_cache = NULL;
 
@@ -647,6 +713,7 @@ static void	vc_update_statistics(zbx_vc_item_t *item, int hits, int misses)
 	if (NULL != item)
 	{
 		item->hits += hits;
+		item->misses += misses;
 		item->last_accessed = time(NULL);
 	}
 
@@ -657,6 +724,144 @@ static void	vc_update_statistics(zbx_vc_item_t *item, int hits, int misses)
 	}
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: vc_item_update_db_statistics                                     *
+ *                                                                            *
+ * Purpose: updates item and cache database request statistics                *
+ *                                                                            *
+ * Parameters: item       - [IN] the item                                     *
+ *             fetch_time - [IN] the time spent reading item values from      *
+ *                               database, in seconds                         *
+ *                                                                            *
+ ******************************************************************************/
+static void	vc_item_update_db_statistics(zbx_vc_item_t *item, double fetch_time)
+{
+	item->db_fetches++;
+	item->db_fetch_time += fetch_time;
+
+	if (ZBX_VC_ENABLED == vc_state)
+	{
+		vc_cache->db_fetches++;
+		vc_cache->db_fetch_time += fetch_time;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: vc_item_value_size                                               *
+ *                                                                            *
+ * Purpose: calculates the accounted size of item value contents              *
+ *                                                                            *
+ * Parameters: value_type - [IN] the value type                               *
+ *             value      - [IN] the value                                    *
+ *                                                                            *
+ * Return value: the size of value contents stored outside data chunk         *
+ *                                                                            *
+ * Comments: Strings are accounted for every referencing value, even if they  *
+ *           are shared in the string pool. Values left unset after failed    *
+ *           copying are not accounted.                                       *
+ *                                                                            *
+ ******************************************************************************/
+static size_t	vc_item_value_size(int value_type, const zbx_history_record_t *value)
+{
+	size_t	size;
+
+	switch (value_type)
+	{
+		case ITEM_VALUE_TYPE_STR:
+		case ITEM_VALUE_TYPE_TEXT:
+			if (NULL == value->value.str)
+				return 0;
+
+			return strlen(value->value.str) + REFCOUNT_FIELD_SIZE + 1;
+		case ITEM_VALUE_TYPE_LOG:
+			if (NULL == value->value.log)
+				return 0;
+
+			size = sizeof(zbx_log_value_t) + strlen(value->value.log->value) + REFCOUNT_FIELD_SIZE + 1;
+
+			if (NULL != value->value.log->source)
+				size += strlen(value->value.log->source) + REFCOUNT_FIELD_SIZE + 1;
+
+			return size;
+		default:
+			return 0;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: vc_item_add_memory                                               *
+ *                                                                            *
+ * Purpose: accounts memory allocated for item history data                   *
+ *                                                                            *
+ * Parameters: item - [IN] the item                                           *
+ *             size - [IN] the number of bytes                                *
+ *                                                                            *
+ ******************************************************************************/
+static void	vc_item_add_memory(zbx_vc_item_t *item, size_t size)
+{
+	item->memory += size;
+	vc_cache->memory[item->value_type] += size;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: vc_item_remove_memory                                            *
+ *                                                                            *
+ * Purpose: accounts memory released from item history data                   *
+ *                                                                            *
+ * Parameters: item - [IN] the item                                           *
+ *             size - [IN] the number of bytes                                *
+ *                                                                            *
+ ******************************************************************************/
+static void	vc_item_remove_memory(zbx_vc_item_t *item, size_t size)
+{
+	item->memory -= size;
+	vc_cache->memory[item->value_type] -= size;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: vc_item_weight                                                   *
+ *                                                                            *
+ * Purpose: calculates item weight according to the cache eviction policy     *
+ *                                                                            *
+ * Parameters: item - [IN] the item                                           *
+ *                                                                            *
+ * Return value: the item weight, items with lower weight are dropped from    *
+ *               cache first                                                  *
+ *                                                                            *
+ ******************************************************************************/
+static double	vc_item_weight(const zbx_vc_item_t *item)
+{
+	double	fetch_time;
+
+	switch (vc_cache->eviction)
+	{
+		case ZBX_VC_EVICTION_LRU:
+			return (double)item->last_accessed;
+		case ZBX_VC_EVICTION_LFU:
+			return (double)item->hits;
+		case ZBX_VC_EVICTION_COST:
+			/* use average database read time of all items if item values were never read from database */
+			if (0 != item->db_fetches)
+				fetch_time = item->db_fetch_time / item->db_fetches;
+			else if (0 != vc_cache->db_fetches)
+				fetch_time = vc_cache->db_fetch_time / vc_cache->db_fetches;
+			else
+				fetch_time = 0;
+
+			return (double)(item->hits + 1) * fetch_time / (item->memory + sizeof(zbx_vc_item_t));
+		default:
+			if (0 < item->values_total)
+				return (double)item->hits / item->values_total;
+
+			return 0;
+	}
+}
+
 /******************************************************************************
  *                                                                            *
  * Function: vc_warn_low_memory                                               *
@@ -743,6 +948,72 @@ void	zbx_vc_housekeeping_value_cache(void)
 	vc_try_unlock();
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: vc_release_weighted_items                                        *
+ *                                                                            *
+ * Purpose: frees space in cache by dropping items with the lowest weight     *
+ *                                                                            *
+ * Parameters: value_type - [IN] the value type of items to drop or           *
+ *                               ITEM_VALUE_TYPE_MAX to drop items of any     *
+ *                               value type                                   *
+ *             space      - [IN] the number of bytes to free                  *
+ *                                                                            *
+ * Return value: number of bytes freed                                        *
+ *                                                                            *
+ * Comments: Items currently being accessed (including the item requesting    *
+ *           space) are not removed.                                          *
+ *           When dropping items of the specified value type the freed space  *
+ *           is measured by the accounted item memory to match value type     *
+ *           quotas, otherwise by the released cache memory.                  *
+ *                                                                            *
+ ******************************************************************************/
+static size_t	vc_release_weighted_items(int value_type, size_t space)
+{
+	zbx_hashset_iter_t		iter;
+	zbx_vc_item_t			*item;
+	int				i;
+	size_t				freed = 0;
+	zbx_vector_vc_itemweight_t	items;
+
+	zbx_vector_vc_itemweight_create(&items);
+
+	zbx_hashset_iter_reset(&vc_cache->items, &iter);
+
+	while (NULL != (item = (zbx_vc_item_t *)zbx_hashset_iter_next(&iter)))
+	{
+		if (0 != item->refcount)
+			continue;
+
+		if (ITEM_VALUE_TYPE_MAX == value_type || value_type == item->value_type)
+		{
+			zbx_vc_item_weight_t	weight = {.item = item, .weight = vc_item_weight(item)};
+
+			zbx_vector_vc_itemweight_append_ptr(&items, &weight);
+		}
+	}
+
+	zbx_vector_vc_itemweight_sort(&items, (zbx_compare_func_t)vc_item_weight_compare_func);
+
+	for (i = 0; i < items.values_num && freed < space; i++)
+	{
+		item = items.values[i].item;
+
+		if (ITEM_VALUE_TYPE_MAX != value_type)
+		{
+			freed += item->memory;
+			vch_item_free_cache(item);
+		}
+		else
+			freed += vch_item_free_cache(item) + sizeof(zbx_vc_item_t);
+
+		zbx_hashset_remove_direct(&vc_cache->items, item);
+	}
+	zbx_vector_vc_itemweight_destroy(&items);
+
+	return freed;
+}
+
 /******************************************************************************
  *                                                                            *
  * Function: vc_release_space                                                 *
@@ -762,11 +1033,7 @@ void	zbx_vc_housekeeping_value_cache(void)
  ******************************************************************************/
 static void	vc_release_space(zbx_vc_item_t *source_item, size_t space)
 {
-	zbx_hashset_iter_t		iter;
-	zbx_vc_item_t			*item;
-	int				i;
-	size_t				freed;
-	zbx_vector_vc_itemweight_t	items;
+	size_t	freed;
 
 	/* reserve at least min_free_request bytes to avoid spamming with free space requests */
 	if (space < vc_cache->min_free_request)
@@ -782,36 +1049,62 @@ static void	vc_release_space(zbx_vc_item_t *source_item, size_t space)
 
 	vc_warn_low_memory();
 
-	/* remove items with least hits/size ratio */
-	zbx_vector_vc_itemweight_create(&items);
+	vc_release_weighted_items(ITEM_VALUE_TYPE_MAX, space - freed);
+}
 
-	zbx_hashset_iter_reset(&vc_cache->items, &iter);
+/******************************************************************************
+ *                                                                            *
+ * Function: vc_item_reserve_quota                                            *
+ *                                                                            *
+ * Purpose: checks if the item value type quota allows to store the specified *
+ *          number of bytes, freeing space by dropping items of the same      *
+ *          value type if necessary                                           *
+ *                                                                            *
+ * Parameters: item - [IN] the item requesting more space to store its data   *
+ *             size - [IN] the number of bytes to store                       *
+ *                                                                            *
+ * Return value: SUCCEED - the data can be stored                             *
+ *               FAIL    - the value type quota is exceeded                   *
+ *                                                                            *
+ * Comments: If dropping items did not free enough space, then no more items  *
+ *           of this value type are dropped during the same second and the    *
+ *           allocations exceeding quota fail without scanning the cache.     *
+ *                                                                            *
+ ******************************************************************************/
+static int	vc_item_reserve_quota(zbx_vc_item_t *item, size_t size)
+{
+	size_t	quota, space;
+	int	now;
 
-	while (NULL != (item = (zbx_vc_item_t *)zbx_hashset_iter_next(&iter)))
-	{
-		/* don't remove the item that requested the space and also keep */
-		/* items currently being accessed                               */
-		if (0 == item->refcount)
-		{
-			zbx_vc_item_weight_t	weight = {.item = item};
+	if (0 == (quota = vc_cache->quota[item->value_type]) || vc_cache->memory[item->value_type] + size <= quota)
+		return SUCCEED;
 
-			if (0 < item->values_total)
-				weight.weight = (double)item->hits / item->values_total;
+	now = time(NULL);
 
-			zbx_vector_vc_itemweight_append_ptr(&items, &weight);
-		}
-	}
+	/* the items are scanned at most once per second after a failed release attempt */
+	if (now != vc_cache->last_quota_release_fail_time[item->value_type])
+	{
+		/* reserve at least min_free_request bytes to avoid spamming with free space requests */
+		if ((space = vc_cache->memory[item->value_type] + size - quota) < vc_cache->min_free_request)
+			space = vc_cache->min_free_request;
 
-	zbx_vector_vc_itemweight_sort(&items, (zbx_compare_func_t)vc_item_weight_compare_func);
+		if (vc_release_weighted_items(item->value_type, space) < space)
+			vc_cache->last_quota_release_fail_time[item->value_type] = now;
+	}
 
-	for (i = 0; i < items.values_num && freed < space; i++)
+	if (now - vc_cache->last_quota_warning_time[item->value_type] > ZBX_VC_LOW_MEMORY_WARNING_PERIOD)
 	{
-		item = items.values[i].item;
+		vc_cache->last_quota_warning_time[item->value_type] = now;
 
-		freed += vch_item_free_cache(item) + sizeof(zbx_vc_item_t);
-		zbx_hashset_remove_direct(&vc_cache->items, item);
+		zabbix_log(LOG_LEVEL_WARNING, "value cache quota for \"%s\" values is fully used: please increase"
+				" the corresponding ValueCacheQuota* configuration parameter",
+				zbx_item_value_type_string((zbx_item_value_type_t)item->value_type));
 	}
-	zbx_vector_vc_itemweight_destroy(&items);
+
+	if (vc_cache->memory[item->value_type] + size > quota)
+		return FAIL;
+
+	return SUCCEED;
 }
 
 /******************************************************************************
@@ -853,6 +1146,7 @@ static void	vc_history_record_copy(zbx_history_record_t *dst, const zbx_history_
  * Purpose: appends the specified value to value vector                       *
  *                                                                            *
  * Parameters: vector     - [IN/OUT] the value vector                         *
+ *                          (zbx_vector_history_record_t)                     *
  *             value_type - [IN] the type of value to append                  *
  *             value      - [IN] the value to append                          *
  *                                                                            *
@@ -860,13 +1154,42 @@ static void	vc_history_record_copy(zbx_history_record_t *dst, const zbx_history_
  *           value contents. This memory must be freed by the caller.         *
  *                                                                            *
  ******************************************************************************/
-static void	vc_history_record_vector_append(zbx_vector_history_record_t *vector, int value_type,
-		zbx_history_record_t *value)
+static void	vc_history_record_vector_append(void *vector, int value_type, const zbx_history_record_t *value)
 {
 	zbx_history_record_t	record;
 
 	vc_history_record_copy(&record, value, value_type);
-	zbx_vector_history_record_append_ptr(vector, &record);
+	zbx_vector_history_record_append_ptr((zbx_vector_history_record_t *)vector, &record);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: vc_dbl_vector_append                                             *
+ *                                                                            *
+ * Purpose: appends value of the specified floating point history record to   *
+ *          packed value vector                                               *
+ *                                                                            *
+ ******************************************************************************/
+static void	vc_dbl_vector_append(void *vector, int value_type, const zbx_history_record_t *value)
+{
+	ZBX_UNUSED(value_type);
+
+	zbx_vector_dbl_append((zbx_vector_dbl_t *)vector, value->value.dbl);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: vc_uint64_vector_append                                          *
+ *                                                                            *
+ * Purpose: appends value of the specified unsigned integer history record to *
+ *          packed value vector                                               *
+ *                                                                            *
+ ******************************************************************************/
+static void	vc_uint64_vector_append(void *vector, int value_type, const zbx_history_record_t *value)
+{
+	ZBX_UNUSED(value_type);
+
+	zbx_vector_uint64_append((zbx_vector_uint64_t *)vector, value->value.ui64);
 }
 
 /******************************************************************************
@@ -884,12 +1207,17 @@ static void	vc_history_record_vector_append(zbx_vector_history_record_t *vector,
  * Comments: If allocation fails this function attempts to free the required  *
  *           space in cache by calling vc_free_space() and tries again. If it *
  *           still fails a NULL value is returned.                            *
+ *           A NULL value is also returned if the item value type quota is    *
+ *           exceeded.                                                        *
  *                                                                            *
  ******************************************************************************/
 static void	*vc_item_malloc(zbx_vc_item_t *item, size_t size)
 {
 	char	*ptr;
 
+	if (SUCCEED != vc_item_reserve_quota(item, size))
+		return NULL;
+
 	if (NULL == (ptr = (char *)__vc_mem_malloc_func(NULL, size)))
 	{
 		/* If failed to allocate required memory, try to free space in      */
@@ -922,19 +1250,25 @@ static void	*vc_item_malloc(zbx_vc_item_t *item, size_t size)
  *           the required space in cache by calling vc_release_space() and    *
  *           tries again. If it still fails then a NULL value is returned.    *
  *                                                                            *
+ *           A NULL value is also returned if the item value type quota is    *
+ *           exceeded.                                                        *
+ *                                                                            *
  ******************************************************************************/
 static char	*vc_item_strdup(zbx_vc_item_t *item, const char *str)
 {
 	void	*ptr;
+	size_t	len;
+
+	len = strlen(str) + 1;
+
+	if (SUCCEED != vc_item_reserve_quota(item, len + REFCOUNT_FIELD_SIZE))
+		return NULL;
 
 	ptr = zbx_hashset_search(&vc_cache->strpool, str - REFCOUNT_FIELD_SIZE);
 
 	if (NULL == ptr)
 	{
 		int	tries = 0;
-		size_t	len;
-
-		len = strlen(str) + 1;
 
 		while (NULL == (ptr = zbx_hashset_insert_ext(&vc_cache->strpool, str - REFCOUNT_FIELD_SIZE,
 				REFCOUNT_FIELD_SIZE + len, REFCOUNT_FIELD_SIZE)))
@@ -1085,7 +1419,7 @@ static size_t	vc_item_logfree(zbx_log_value_t *log)
  ******************************************************************************/
 static size_t	vc_item_free_values(zbx_vc_item_t *item, zbx_history_record_t *values, int first, int last)
 {
-	size_t	freed = 0;
+	size_t	freed = 0, size = 0;
 	int 	i;
 
 	switch (item->value_type)
@@ -1093,14 +1427,21 @@ static size_t	vc_item_free_values(zbx_vc_item_t *item, zbx_history_record_t *val
 		case ITEM_VALUE_TYPE_STR:
 		case ITEM_VALUE_TYPE_TEXT:
 			for (i = first; i <= last; i++)
+			{
+				size += vc_item_value_size(item->value_type, &values[i]);
 				freed += vc_item_strfree(values[i].value.str);
+			}
 			break;
 		case ITEM_VALUE_TYPE_LOG:
 			for (i = first; i <= last; i++)
+			{
+				size += vc_item_value_size(item->value_type, &values[i]);
 				freed += vc_item_logfree(values[i].value.log);
+			}
 			break;
 	}
 
+	vc_item_remove_memory(item, size);
 	item->values_total -= (last - first + 1);
 
 	return freed;
@@ -1320,6 +1661,8 @@ static int	vch_item_add_chunk(zbx_vc_item_t *item, int nslots, zbx_vc_chunk_t *i
 	if (NULL == (chunk = (zbx_vc_chunk_t *)vc_item_malloc(item, chunk_size)))
 		return FAIL;
 
+	vc_item_add_memory(item, chunk_size);
+
 	memset(chunk, 0, sizeof(zbx_vc_chunk_t));
 	chunk->slots_num = nslots;
 
@@ -1493,6 +1836,8 @@ static int	vch_item_copy_value(zbx_vc_item_t *item, zbx_vc_chunk_t *chunk, int i
 	}
 	value->timestamp = source_value->timestamp;
 
+	vc_item_add_memory(item, vc_item_value_size(item->value_type, value));
+
 	ret = SUCCEED;
 out:
 	return ret;
@@ -1531,6 +1876,7 @@ static int	vch_item_copy_values_at_tail(zbx_vc_item_t *item, const zbx_history_r
 				if (NULL == (value->value.str = vc_item_strdup(item, values[i].value.str)))
 					goto out;
 
+				vc_item_add_memory(item, vc_item_value_size(item->value_type, value));
 				value->timestamp = values[i].timestamp;
 				item->tail->first_value--;
 			}
@@ -1545,6 +1891,7 @@ static int	vch_item_copy_values_at_tail(zbx_vc_item_t *item, const zbx_history_r
 				if (NULL == (value->value.log = vc_item_logdup(item, values[i].value.log)))
 					goto out;
 
+				vc_item_add_memory(item, vc_item_value_size(item->value_type, value));
 				value->timestamp = values[i].timestamp;
 				item->tail->first_value--;
 			}
@@ -1580,6 +1927,8 @@ static size_t	vch_item_free_chunk(zbx_vc_item_t *item, zbx_vc_chunk_t *chunk)
 	size_t	freed;
 
 	freed = sizeof(zbx_vc_chunk_t) + (chunk->slots_num - 1) * sizeof(zbx_history_record_t);
+	vc_item_remove_memory(item, freed);
+
 	freed += vc_item_free_values(item, chunk->slots, chunk->first_value, chunk->last_value);
 
 	__vc_mem_free_func(chunk);
@@ -1945,11 +2294,14 @@ static int	vch_item_cache_values_by_time(zbx_vc_item_t *item, int range_start)
 	if (range_start < range_end)
 	{
 		zbx_vector_history_record_t	records;
+		double				time_start;
 
 		zbx_vector_history_record_create(&records);
 
 		vc_try_unlock();
 
+		time_start = zbx_time();
+
 		if (SUCCEED == (ret = vc_db_read_values_by_time(item->itemid, item->value_type, &records,
 				range_start, range_end)))
 		{
@@ -1959,6 +2311,8 @@ static int	vch_item_cache_values_by_time(zbx_vc_item_t *item, int range_start)
 
 		vc_try_lock();
 
+		vc_item_update_db_statistics(item, zbx_time() - time_start);
+
 		if (SUCCEED == ret)
 		{
 			if (0 < records.values_num)
@@ -2031,6 +2385,7 @@ static int	vch_item_cache_values_by_time_and_count(zbx_vc_item_t *item, int rang
 	if (cached_records < count)
 	{
 		zbx_vector_history_record_t	records;
+		double				time_start;
 
 		/* get the end timestamp to which (including) the values should be cached */
 		if (NULL != item->head)
@@ -2040,6 +2395,8 @@ static int	vch_item_cache_values_by_time_and_count(zbx_vc_item_t *item, int rang
 
 		vc_try_unlock();
 
+		time_start = zbx_time();
+
 		zbx_vector_history_record_create(&records);
 
 		if (range_end > ts->sec)
@@ -2059,6 +2416,8 @@ static int	vch_item_cache_values_by_time_and_count(zbx_vc_item_t *item, int rang
 
 		vc_try_lock();
 
+		vc_item_update_db_statistics(item, zbx_time() - time_start);
+
 		if (SUCCEED == ret)
 		{
 			if (0 < records.values_num)
@@ -2089,17 +2448,21 @@ static int	vch_item_cache_values_by_time_and_count(zbx_vc_item_t *item, int rang
  *                                                                            *
  * Purpose: retrieves item history data from cache                            *
  *                                                                            *
- * Parameters: item      - [IN] the item                                      *
- *             values    - [OUT] the item history data stored time/value      *
- *                         pairs in undefined order                           *
- *             seconds   - [IN] the time period to retrieve data for          *
- *             ts        - [IN] the requested period end timestamp            *
+ * Parameters: item        - [IN] the item                                    *
+ *             values      - [OUT] the item history data stored time/value    *
+ *                           pairs in undefined order                         *
+ *             append_func - [IN] the function appending value to the output  *
+ *                           vector                                           *
+ *             seconds     - [IN] the time period to retrieve data for        *
+ *             ts          - [IN] the requested period end timestamp          *
+ *                                                                            *
+ * Return value: the number of retrieved values                               *
  *                                                                            *
  ******************************************************************************/
-static void	vch_item_get_values_by_time(zbx_vc_item_t *item, zbx_vector_history_record_t *values, int seconds,
-		const zbx_timespec_t *ts)
+static int	vch_item_get_values_by_time(zbx_vc_item_t *item, void *values, vc_value_append_func_t append_func,
+		int seconds, const zbx_timespec_t *ts)
 {
-	int		index, now;
+	int		index, now, values_num = 0;
 	zbx_timespec_t	start = {ts->sec - seconds, ts->ns};
 	zbx_vc_chunk_t	*chunk;
 
@@ -2117,20 +2480,25 @@ static void	vch_item_get_values_by_time(zbx_vc_item_t *item, zbx_vector_history_
 	{
 		/* Cache does not contain records for the specified timeshift & seconds range. */
 		/* Return empty vector with success.                                           */
-		return;
+		return 0;
 	}
 
 	/* fill the values vector with item history values until the start timestamp is reached */
 	while (0 < zbx_timespec_compare(&chunk->slots[chunk->last_value].timestamp, &start))
 	{
 		while (index >= chunk->first_value && 0 < zbx_timespec_compare(&chunk->slots[index].timestamp, &start))
-			vc_history_record_vector_append(values, item->value_type, &chunk->slots[index--]);
+		{
+			append_func(values, item->value_type, &chunk->slots[index--]);
+			values_num++;
+		}
 
 		if (NULL == (chunk = chunk->prev))
 			break;
 
 		index = chunk->last_value;
 	}
+
+	return values_num;
 }
 
 /******************************************************************************
@@ -2139,23 +2507,24 @@ static void	vch_item_get_values_by_time(zbx_vc_item_t *item, zbx_vector_history_
  *                                                                            *
  * Purpose: retrieves item history data from cache                            *
  *                                                                            *
- * Parameters: item      - [IN] the item                                      *
- *             values    - [OUT] the item history data stored time/value      *
- *                         pairs in undefined order, optional                 *
- *                         If null then cache is updated if necessary, but no *
- *                         values are returned. Used to ensure that cache     *
- *                         contains a value of the specified timestamp.       *
- *             seconds   - [IN] the time period                               *
- *             count     - [IN] the number of history values to retrieve      *
- *             timestamp - [IN] the target timestamp                          *
+ * Parameters: item        - [IN] the item                                    *
+ *             values      - [OUT] the item history data stored time/value    *
+ *                           pairs in undefined order                         *
+ *             append_func - [IN] the function appending value to the output  *
+ *                           vector                                           *
+ *             seconds     - [IN] the time period                             *
+ *             count       - [IN] the number of history values to retrieve    *
+ *             timestamp   - [IN] the target timestamp                        *
+ *                                                                            *
+ * Return value: the number of retrieved values                               *
  *                                                                            *
  ******************************************************************************/
-static void	vch_item_get_values_by_time_and_count(zbx_vc_item_t *item, zbx_vector_history_record_t *values,
-		int seconds, int count, const zbx_timespec_t *ts)
+static int	vch_item_get_values_by_time_and_count(zbx_vc_item_t *item, void *values,
+		vc_value_append_func_t append_func, int seconds, int count, const zbx_timespec_t *ts)
 {
-	int		index, now, range_timestamp;
+	int		index, now, range_timestamp, values_num = 0;
 	zbx_vc_chunk_t	*chunk;
-	zbx_timespec_t	start;
+	zbx_timespec_t	start, oldest = {0, 0};
 
 	/* set start timestamp of the requested time period */
 	if (0 != seconds)
@@ -2182,9 +2551,10 @@ static void	vch_item_get_values_by_time_and_count(zbx_vc_item_t *item, zbx_vecto
 	{
 		while (index >= chunk->first_value && 0 < zbx_timespec_compare(&chunk->slots[index].timestamp, &start))
 		{
-			vc_history_record_vector_append(values, item->value_type, &chunk->slots[index--]);
+			oldest = chunk->slots[index].timestamp;
+			append_func(values, item->value_type, &chunk->slots[index--]);
 
-			if (values->values_num == count)
+			if (++values_num == count)
 				goto out;
 		}
 
@@ -2194,7 +2564,7 @@ static void	vch_item_get_values_by_time_and_count(zbx_vc_item_t *item, zbx_vecto
 		index = chunk->last_value;
 	}
 out:
-	if (count > values->values_num)
+	if (count > values_num)
 	{
 		if (0 == seconds)
 		{
@@ -2202,7 +2572,7 @@ out:
 			item->active_range = 0;
 			item->daily_range = 0;
 			item->status = ZBX_ITEM_STATUS_CACHED_ALL;
-			return;
+			return values_num;
 		}
 		/* not enough data in the requested period, set the range equal to the period plus */
 		/* one second to include nanosecond shifts                                         */
@@ -2211,11 +2581,13 @@ out:
 	else
 	{
 		/* the requested number of values was retrieved, set the range to the oldest value timestamp */
-		range_timestamp = values->values[values->values_num - 1].timestamp.sec - 1;
+		range_timestamp = oldest.sec - 1;
 	}
 
 	now = time(NULL);
 	vch_item_update_range(item, now - range_timestamp, now);
+
+	return values_num;
 }
 
 /******************************************************************************
@@ -2224,15 +2596,14 @@ out:
  *                                                                            *
  * Purpose: get item values for the specified range                           *
  *                                                                            *
- * Parameters: item      - [IN] the item                                      *
- *             values    - [OUT] the item history data stored time/value      *
- *                         pairs in undefined order, optional                 *
- *                         If null then cache is updated if necessary, but no *
- *                         values are returned. Used to ensure that cache     *
- *                         contains a value of the specified timestamp.       *
- *             seconds   - [IN] the time period to retrieve data for          *
- *             count     - [IN] the number of history values to retrieve      *
- *             ts        - [IN] the target timestamp                          *
+ * Parameters: item        - [IN] the item                                    *
+ *             values      - [OUT] the item history data stored time/value    *
+ *                           pairs in undefined order                         *
+ *             append_func - [IN] the function appending value to the output  *
+ *                           vector                                           *
+ *             seconds     - [IN] the time period to retrieve data for        *
+ *             count       - [IN] the number of history values to retrieve    *
+ *             ts          - [IN] the target timestamp                        *
  *                                                                            *
  * Return value:  SUCCEED - the item history data was retrieved successfully  *
  *                FAIL    - the item history data was not retrieved           *
@@ -2246,12 +2617,10 @@ out:
  *           seconds before <timestamp>.                                      *
  *                                                                            *
  ******************************************************************************/
-static int	vch_item_get_values(zbx_vc_item_t *item, zbx_vector_history_record_t *values, int seconds,
-		int count, const zbx_timespec_t *ts)
+static int	vch_item_get_values(zbx_vc_item_t *item, void *values, vc_value_append_func_t append_func,
+		int seconds, int count, const zbx_timespec_t *ts)
 {
-	int	ret, records_read, hits, misses, range_start;
-
-	zbx_vector_history_record_clear(values);
+	int	ret, records_read, hits, misses, range_start, values_num;
 
 	if (0 == count)
 	{
@@ -2263,10 +2632,10 @@ static int	vch_item_get_values(zbx_vc_item_t *item, zbx_vector_history_record_t
 
 		records_read = ret;
 
-		vch_item_get_values_by_time(item, values, seconds, ts);
+		values_num = vch_item_get_values_by_time(item, values, append_func, seconds, ts);
 
-		if (records_read > values->values_num)
-			records_read = values->values_num;
+		if (records_read > values_num)
+			records_read = values_num;
 	}
 	else
 	{
@@ -2277,13 +2646,13 @@ static int	vch_item_get_values(zbx_vc_item_t *item, zbx_vector_history_record_t
 
 		records_read = ret;
 
-		vch_item_get_values_by_time_and_count(item, values, seconds, count, ts);
+		values_num = vch_item_get_values_by_time_and_count(item, values, append_func, seconds, count, ts);
 
-		if (records_read > values->values_num)
-			records_read = values->values_num;
+		if (records_read > values_num)
+			records_read = values_num;
 	}
 
-	hits = values->values_num - records_read;
+	hits = values_num - records_read;
 	misses = records_read;
 
 	vc_update_statistics(item, hits, misses);
@@ -2391,6 +2760,14 @@ int	zbx_vc_init(char **error)
 	if (vc_cache->min_free_request > 128 * ZBX_KIBIBYTE)
 		vc_cache->min_free_request = 128 * ZBX_KIBIBYTE;
 
+	vc_cache->eviction = CONFIG_VALUE_CACHE_EVICTION;
+
+	vc_cache->quota[ITEM_VALUE_TYPE_FLOAT] = CONFIG_VALUE_CACHE_SIZE / 100 * CONFIG_VALUE_CACHE_QUOTA_FLOAT;
+	vc_cache->quota[ITEM_VALUE_TYPE_STR] = CONFIG_VALUE_CACHE_SIZE / 100 * CONFIG_VALUE_CACHE_QUOTA_STR;
+	vc_cache->quota[ITEM_VALUE_TYPE_LOG] = CONFIG_VALUE_CACHE_SIZE / 100 * CONFIG_VALUE_CACHE_QUOTA_LOG;
+	vc_cache->quota[ITEM_VALUE_TYPE_UINT64] = CONFIG_VALUE_CACHE_SIZE / 100 * CONFIG_VALUE_CACHE_QUOTA_UINT64;
+	vc_cache->quota[ITEM_VALUE_TYPE_TEXT] = CONFIG_VALUE_CACHE_SIZE / 100 * CONFIG_VALUE_CACHE_QUOTA_TEXT;
+
 	ret = SUCCEED;
 out:
 	zbx_vc_disable();
@@ -2459,6 +2836,10 @@ void	zbx_vc_reset(void)
 		vc_cache->mode = ZBX_VC_MODE_NORMAL;
 		vc_cache->mode_time = 0;
 		vc_cache->last_warning_time = 0;
+		vc_cache->db_fetches = 0;
+		vc_cache->db_fetch_time = 0;
+		memset(vc_cache->last_quota_warning_time, 0, sizeof(vc_cache->last_quota_warning_time));
+		memset(vc_cache->last_quota_release_fail_time, 0, sizeof(vc_cache->last_quota_release_fail_time));
 
 		vc_try_unlock();
 	}
@@ -2507,6 +2888,8 @@ int	zbx_vc_add_values(zbx_vector_ptr_t *history)
 			{
 				vc_item_addref(item);
 
+				item->revision = ++vc_cache->revision;
+
 				/* If the new value type does not match the item's type in cache we can't  */
 				/* change the cache because other processes might still be accessing it    */
 				/* at the same time. The only thing that can be done - mark it for removal */
@@ -2532,51 +2915,41 @@ int	zbx_vc_add_values(zbx_vector_ptr_t *history)
 
 /******************************************************************************
  *                                                                            *
- * Function: zbx_vc_get_values                                                *
- *                                                                            *
- * Purpose: get item history data for the specified time period               *
+ * Function: vc_get_cached_item_values                                        *
  *                                                                            *
- * Parameters: itemid     - [IN] the item id                                  *
- *             value_type - [IN] the item value type                          *
- *             values     - [OUT] the item history data stored time/value     *
- *                          pairs in descending order                         *
- *             seconds    - [IN] the time period to retrieve data for         *
- *             count      - [IN] the number of history values to retrieve     *
- *             ts         - [IN] the period end timestamp                     *
+ * Purpose: get item history data for the specified time period from cache    *
+ *          without locking it                                                *
  *                                                                            *
- * Return value:  SUCCEED - the item history data was retrieved successfully  *
- *                FAIL    - the item history data was not retrieved           *
+ * Parameters: itemid      - [IN] the item id                                 *
+ *             value_type  - [IN] the item value type                         *
+ *             values      - [OUT] the item history data                      *
+ *             append_func - [IN] the function appending value to the output  *
+ *                           vector                                           *
+ *             seconds     - [IN] the time period to retrieve data for        *
+ *             count       - [IN] the number of history values to retrieve    *
+ *             ts          - [IN] the period end timestamp                    *
  *                                                                            *
- * Comments: If the data is not in cache, it's read from DB, so this function *
- *           will always return the requested data, unless some error occurs. *
+ * Return value:  SUCCEED - the item history data was retrieved from cache    *
+ *                FAIL    - the item history data must be read from database  *
  *                                                                            *
- *           If <count> is set then value range is defined as <count> values  *
- *           before <timestamp>. Otherwise the range is defined as <seconds>  *
- *           seconds before <timestamp>.                                      *
+ * Comments: The cache must be locked by the caller.                          *
  *                                                                            *
  ******************************************************************************/
-int	zbx_vc_get_values(zbx_uint64_t itemid, int value_type, zbx_vector_history_record_t *values, int seconds,
-		int count, const zbx_timespec_t *ts)
+static int	vc_get_cached_item_values(zbx_uint64_t itemid, int value_type, void *values,
+		vc_value_append_func_t append_func, int seconds, int count, const zbx_timespec_t *ts)
 {
 	zbx_vc_item_t	*item = NULL;
-	int 		ret = FAIL, cache_used = 1;
-
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s() itemid:" ZBX_FS_UI64 " value_type:%d seconds:%d count:%d sec:%d ns:%d",
-			__func__, itemid, value_type, seconds, count, ts->sec, ts->ns);
-
-	vc_try_lock();
+	int 		ret = FAIL;
 
 	if (ZBX_VC_DISABLED == vc_state)
 		goto out;
 
-	if (ZBX_VC_MODE_LOWMEM == vc_cache->mode)
-		vc_warn_low_memory();
-
 	if (NULL == (item = (zbx_vc_item_t *)zbx_hashset_search(&vc_cache->items, &itemid)))
 	{
 		if (ZBX_VC_MODE_NORMAL == vc_cache->mode)
 		{
-			zbx_vc_item_t   new_item = {.itemid = itemid, .value_type = value_type};
+			zbx_vc_item_t   new_item = {.itemid = itemid, .value_type = value_type,
+					.revision = ++vc_cache->revision};
 
 			if (NULL == (item = (zbx_vc_item_t *)zbx_hashset_insert(&vc_cache->items, &new_item, sizeof(zbx_vc_item_t))))
 				goto out;
@@ -2590,36 +2963,385 @@ int	zbx_vc_get_values(zbx_uint64_t itemid, int value_type, zbx_vector_history_re
 	if (0 != (item->state & ZBX_ITEM_STATE_REMOVE_PENDING) || item->value_type != value_type)
 		goto out;
 
-	ret = vch_item_get_values(item, values, seconds, count, ts);
+	ret = vch_item_get_values(item, values, append_func, seconds, count, ts);
 out:
-	if (FAIL == ret)
+	if (NULL != item)
 	{
-		if (NULL != item)
+		if (FAIL == ret)
 			item->state |= ZBX_ITEM_STATE_REMOVE_PENDING;
 
-		cache_used = 0;
+		vc_item_release(item);
+	}
 
-		vc_try_unlock();
+	return ret;
+}
 
-		ret = vc_db_get_values(itemid, value_type, values, seconds, count, ts);
+/******************************************************************************
+ *                                                                            *
+ * Function: vc_get_cached_values                                             *
+ *                                                                            *
+ * Purpose: get item history data for the specified time period from cache    *
+ *                                                                            *
+ * Parameters: itemid      - [IN] the item id                                 *
+ *             value_type  - [IN] the item value type                         *
+ *             values      - [OUT] the item history data                      *
+ *             append_func - [IN] the function appending value to the output  *
+ *                           vector                                           *
+ *             seconds     - [IN] the time period to retrieve data for        *
+ *             count       - [IN] the number of history values to retrieve    *
+ *             ts          - [IN] the period end timestamp                    *
+ *                                                                            *
+ * Return value:  SUCCEED - the item history data was retrieved from cache    *
+ *                FAIL    - the item history data must be read from database  *
+ *                                                                            *
+ ******************************************************************************/
+static int	vc_get_cached_values(zbx_uint64_t itemid, int value_type, void *values,
+		vc_value_append_func_t append_func, int seconds, int count, const zbx_timespec_t *ts)
+{
+	int 	ret;
 
-		vc_try_lock();
+	vc_try_lock();
 
-		if (SUCCEED == ret)
-			vc_update_statistics(NULL, 0, values->values_num);
-	}
+	if (ZBX_VC_DISABLED != vc_state && ZBX_VC_MODE_LOWMEM == vc_cache->mode)
+		vc_warn_low_memory();
 
-	if (NULL != item)
-		vc_item_release(item);
+	ret = vc_get_cached_item_values(itemid, value_type, values, append_func, seconds, count, ts);
 
 	vc_try_unlock();
 
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: vc_get_db_values                                                 *
+ *                                                                            *
+ * Purpose: get item history data for the specified time period from database *
+ *          bypassing value cache                                             *
+ *                                                                            *
+ * Parameters: itemid     - [IN] the item id                                  *
+ *             value_type - [IN] the item value type                          *
+ *             values     - [OUT] the item history data stored time/value     *
+ *                          pairs in descending order                         *
+ *             seconds    - [IN] the time period to retrieve data for         *
+ *             count      - [IN] the number of history values to retrieve     *
+ *             ts         - [IN] the period end timestamp                     *
+ *                                                                            *
+ * Return value:  SUCCEED - the item history data was retrieved successfully  *
+ *                FAIL    - the item history data was not retrieved           *
+ *                                                                            *
+ ******************************************************************************/
+static int	vc_get_db_values(zbx_uint64_t itemid, int value_type, zbx_vector_history_record_t *values,
+		int seconds, int count, const zbx_timespec_t *ts)
+{
+	int	ret;
+
+	if (SUCCEED == (ret = vc_db_get_values(itemid, value_type, values, seconds, count, ts)))
+	{
+		vc_try_lock();
+		vc_update_statistics(NULL, 0, values->values_num);
+		vc_try_unlock();
+	}
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_vc_get_values                                                *
+ *                                                                            *
+ * Purpose: get item history data for the specified time period               *
+ *                                                                            *
+ * Parameters: itemid     - [IN] the item id                                  *
+ *             value_type - [IN] the item value type                          *
+ *             values     - [OUT] the item history data stored time/value     *
+ *                          pairs in descending order                         *
+ *             seconds    - [IN] the time period to retrieve data for         *
+ *             count      - [IN] the number of history values to retrieve     *
+ *             ts         - [IN] the period end timestamp                     *
+ *                                                                            *
+ * Return value:  SUCCEED - the item history data was retrieved successfully  *
+ *                FAIL    - the item history data was not retrieved           *
+ *                                                                            *
+ * Comments: If the data is not in cache, it's read from DB, so this function *
+ *           will always return the requested data, unless some error occurs. *
+ *                                                                            *
+ *           If <count> is set then value range is defined as <count> values  *
+ *           before <timestamp>. Otherwise the range is defined as <seconds>  *
+ *           seconds before <timestamp>.                                      *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_vc_get_values(zbx_uint64_t itemid, int value_type, zbx_vector_history_record_t *values, int seconds,
+		int count, const zbx_timespec_t *ts)
+{
+	int 	ret, cache_used = 1;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() itemid:" ZBX_FS_UI64 " value_type:%d seconds:%d count:%d sec:%d ns:%d",
+			__func__, itemid, value_type, seconds, count, ts->sec, ts->ns);
+
+	zbx_vector_history_record_clear(values);
+
+	if (FAIL == (ret = vc_get_cached_values(itemid, value_type, values, vc_history_record_vector_append,
+			seconds, count, ts)))
+	{
+		cache_used = 0;
+		ret = vc_get_db_values(itemid, value_type, values, seconds, count, ts);
+	}
+
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s count:%d cached:%d",
 			__func__, zbx_result_string(ret), values->values_num, cache_used);
 
 	return ret;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: vc_get_packed_values                                             *
+ *                                                                            *
+ * Purpose: get numeric item history values for the specified time period     *
+ *          packed into contiguous value array                                *
+ *                                                                            *
+ * Parameters: itemid      - [IN] the item id                                 *
+ *             value_type  - [IN] the item value type                         *
+ *             values      - [OUT] the packed value vector                    *
+ *             append_func - [IN] the function appending value to the packed  *
+ *                           value vector                                     *
+ *             seconds     - [IN] the time period to retrieve data for        *
+ *             count       - [IN] the number of history values to retrieve    *
+ *             ts          - [IN] the period end timestamp                    *
+ *                                                                            *
+ * Return value:  SUCCEED - the item history data was retrieved successfully  *
+ *                FAIL    - the item history data was not retrieved           *
+ *                                                                            *
+ * Comments: The values are copied directly from cache chunks without         *
+ *           creating intermediate history records.                           *
+ *                                                                            *
+ ******************************************************************************/
+static int	vc_get_packed_values(zbx_uint64_t itemid, int value_type, void *values,
+		vc_value_append_func_t append_func, int seconds, int count, const zbx_timespec_t *ts)
+{
+	int				ret, i;
+	zbx_vector_history_record_t	records;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() itemid:" ZBX_FS_UI64 " value_type:%d seconds:%d count:%d sec:%d ns:%d",
+			__func__, itemid, value_type, seconds, count, ts->sec, ts->ns);
+
+	if (SUCCEED == (ret = vc_get_cached_values(itemid, value_type, values, append_func, seconds, count, ts)))
+		goto out;
+
+	zbx_history_record_vector_create(&records);
+
+	if (SUCCEED == (ret = vc_get_db_values(itemid, value_type, &records, seconds, count, ts)))
+	{
+		for (i = 0; i < records.values_num; i++)
+			append_func(values, value_type, &records.values[i]);
+	}
+
+	zbx_history_record_vector_destroy(&records, value_type);
+out:
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_vc_get_values_dbl                                            *
+ *                                                                            *
+ * Purpose: get floating point item history values for the specified time     *
+ *          period                                                            *
+ *                                                                            *
+ * Parameters: itemid  - [IN] the item id                                     *
+ *             values  - [OUT] the item history values in descending order of *
+ *                       their timestamps                                     *
+ *             seconds - [IN] the time period to retrieve data for            *
+ *             count   - [IN] the number of history values to retrieve        *
+ *             ts      - [IN] the period end timestamp                        *
+ *                                                                            *
+ * Return value:  SUCCEED - the item history data was retrieved successfully  *
+ *                FAIL    - the item history data was not retrieved           *
+ *                                                                            *
+ * Comments: The value range is defined the same way as for                   *
+ *           zbx_vc_get_values() function.                                    *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_vc_get_values_dbl(zbx_uint64_t itemid, zbx_vector_dbl_t *values, int seconds, int count,
+		const zbx_timespec_t *ts)
+{
+	zbx_vector_dbl_clear(values);
+
+	return vc_get_packed_values(itemid, ITEM_VALUE_TYPE_FLOAT, values, vc_dbl_vector_append, seconds, count,
+			ts);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_vc_get_values_uint64                                         *
+ *                                                                            *
+ * Purpose: get unsigned integer item history values for the specified time   *
+ *          period                                                            *
+ *                                                                            *
+ * Parameters: itemid  - [IN] the item id                                     *
+ *             values  - [OUT] the item history values in descending order of *
+ *                       their timestamps                                     *
+ *             seconds - [IN] the time period to retrieve data for            *
+ *             count   - [IN] the number of history values to retrieve        *
+ *             ts      - [IN] the period end timestamp                        *
+ *                                                                            *
+ * Return value:  SUCCEED - the item history data was retrieved successfully  *
+ *                FAIL    - the item history data was not retrieved           *
+ *                                                                            *
+ * Comments: The value range is defined the same way as for                   *
+ *           zbx_vc_get_values() function.                                    *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_vc_get_values_uint64(zbx_uint64_t itemid, zbx_vector_uint64_t *values, int seconds, int count,
+		const zbx_timespec_t *ts)
+{
+	zbx_vector_uint64_clear(values);
+
+	return vc_get_packed_values(itemid, ITEM_VALUE_TYPE_UINT64, values, vc_uint64_vector_append, seconds,
+			count, ts);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: vc_get_packed_values_bulk                                        *
+ *                                                                            *
+ * Purpose: get numeric history values of multiple items for the specified    *
+ *          time period packed into contiguous value array                    *
+ *                                                                            *
+ * Parameters: itemids     - [IN] the item ids                                *
+ *             itemids_num - [IN] the number of items                         *
+ *             value_type  - [IN] the value type of all items                 *
+ *             values      - [OUT] the packed value vector                    *
+ *             values_num  - [IN] the number of values in packed vector       *
+ *             append_func - [IN] the function appending value to the packed  *
+ *                           vector                                           *
+ *             offsets     - [OUT] the offsets of item values in the packed   *
+ *                           vector, must have itemids_num + 1 elements       *
+ *             seconds     - [IN] the time period to retrieve data for        *
+ *             count       - [IN] the number of history values to retrieve    *
+ *             ts          - [IN] the period end timestamp                    *
+ *                                                                            *
+ * Comments: The cache is locked once for all items and unlocked only to read *
+ *           values of the items not in cache from database.                  *
+ *                                                                            *
+ ******************************************************************************/
+static void	vc_get_packed_values_bulk(const zbx_uint64_t *itemids, int itemids_num, int value_type, void *values,
+		const int *values_num, vc_value_append_func_t append_func, int *offsets, int seconds, int count,
+		const zbx_timespec_t *ts)
+{
+	int				i, j, cached = 0;
+	zbx_vector_history_record_t	records;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() items:%d value_type:%d seconds:%d count:%d sec:%d ns:%d",
+			__func__, itemids_num, value_type, seconds, count, ts->sec, ts->ns);
+
+	zbx_history_record_vector_create(&records);
+
+	vc_try_lock();
+
+	if (ZBX_VC_DISABLED != vc_state && ZBX_VC_MODE_LOWMEM == vc_cache->mode)
+		vc_warn_low_memory();
+
+	for (i = 0; i < itemids_num; i++)
+	{
+		offsets[i] = *values_num;
+
+		if (SUCCEED == vc_get_cached_item_values(itemids[i], value_type, values, append_func, seconds, count,
+				ts))
+		{
+			cached++;
+			continue;
+		}
+
+		vc_try_unlock();
+
+		if (SUCCEED == vc_get_db_values(itemids[i], value_type, &records, seconds, count, ts))
+		{
+			for (j = 0; j < records.values_num; j++)
+				append_func(values, value_type, &records.values[j]);
+		}
+
+		vc_history_record_vector_clean(&records, value_type);
+
+		vc_try_lock();
+	}
+
+	offsets[itemids_num] = *values_num;
+
+	vc_try_unlock();
+
+	zbx_history_record_vector_destroy(&records, value_type);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s() values:%d cached:%d", __func__, *values_num, cached);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_vc_get_values_dbl_bulk                                       *
+ *                                                                            *
+ * Purpose: get floating point history values of multiple items for the       *
+ *          specified time period                                             *
+ *                                                                            *
+ * Parameters: itemids     - [IN] the item ids                                *
+ *             itemids_num - [IN] the number of items                         *
+ *             values      - [OUT] the history values of all items            *
+ *             offsets     - [OUT] the offsets of item values, values of the  *
+ *                           i-th item are stored from offsets[i] up to       *
+ *                           offsets[i + 1] in descending order of their      *
+ *                           timestamps. Must have itemids_num + 1 elements.  *
+ *             seconds     - [IN] the time period to retrieve data for        *
+ *             count       - [IN] the number of history values to retrieve    *
+ *             ts          - [IN] the period end timestamp                    *
+ *                                                                            *
+ * Comments: The value range is defined the same way as for                   *
+ *           zbx_vc_get_values() function. Items whose values could not be    *
+ *           retrieved have empty value range.                                *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_vc_get_values_dbl_bulk(const zbx_uint64_t *itemids, int itemids_num, zbx_vector_dbl_t *values,
+		int *offsets, int seconds, int count, const zbx_timespec_t *ts)
+{
+	zbx_vector_dbl_clear(values);
+
+	vc_get_packed_values_bulk(itemids, itemids_num, ITEM_VALUE_TYPE_FLOAT, values, &values->values_num,
+			vc_dbl_vector_append, offsets, seconds, count, ts);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_vc_get_values_uint64_bulk                                    *
+ *                                                                            *
+ * Purpose: get unsigned integer history values of multiple items for the     *
+ *          specified time period                                             *
+ *                                                                            *
+ * Parameters: itemids     - [IN] the item ids                                *
+ *             itemids_num - [IN] the number of items                         *
+ *             values      - [OUT] the history values of all items            *
+ *             offsets     - [OUT] the offsets of item values, values of the  *
+ *                           i-th item are stored from offsets[i] up to       *
+ *                           offsets[i + 1] in descending order of their      *
+ *                           timestamps. Must have itemids_num + 1 elements.  *
+ *             seconds     - [IN] the time period to retrieve data for        *
+ *             count       - [IN] the number of history values to retrieve    *
+ *             ts          - [IN] the period end timestamp                    *
+ *                                                                            *
+ * Comments: The value range is defined the same way as for                   *
+ *           zbx_vc_get_values() function. Items whose values could not be    *
+ *           retrieved have empty value range.                                *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_vc_get_values_uint64_bulk(const zbx_uint64_t *itemids, int itemids_num, zbx_vector_uint64_t *values,
+		int *offsets, int seconds, int count, const zbx_timespec_t *ts)
+{
+	zbx_vector_uint64_clear(values);
+
+	vc_get_packed_values_bulk(itemids, itemids_num, ITEM_VALUE_TYPE_UINT64, values, &values->values_num,
+			vc_uint64_vector_append, offsets, seconds, count, ts);
+}
+
 /******************************************************************************
  *                                                                            *
  * Function: zbx_vc_get_value                                                 *
@@ -2662,6 +3384,244 @@ out:
 	return ret;
 }
 
+/* the prefetched item range */
+typedef struct
+{
+	zbx_vc_item_t		*item;
+	int			range_start;
+	zbx_history_request_t	request;
+}
+zbx_vc_prefetch_item_t;
+
+static int	vc_prefetch_item_compare_func(const void *d1, const void *d2)
+{
+	const zbx_vc_prefetch_item_t	*p1 = *(const zbx_vc_prefetch_item_t **)d1;
+	const zbx_vc_prefetch_item_t	*p2 = *(const zbx_vc_prefetch_item_t **)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(p1->item->value_type, p2->item->value_type);
+	ZBX_RETURN_IF_NOT_EQUAL(p1->item->itemid, p2->item->itemid);
+
+	return 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: vc_prefetch_item_add                                             *
+ *                                                                            *
+ * Purpose: adds item to the prefetch list if its cached range does not cover *
+ *          the requested period                                              *
+ *                                                                            *
+ * Parameters: prefetch - [IN/OUT] the prefetched items                       *
+ *             request  - [IN] the time based value request                   *
+ *             now      - [IN] the current timestamp                          *
+ *                                                                            *
+ ******************************************************************************/
+static void	vc_prefetch_item_add(zbx_vector_ptr_t *prefetch, const zbx_vc_prefetch_t *request, int now)
+{
+	zbx_vc_item_t		*item;
+	zbx_vc_prefetch_item_t	*pitem;
+	int			range_start, range_end;
+
+	if (NULL == (item = (zbx_vc_item_t *)zbx_hashset_search(&vc_cache->items, &request->itemid)))
+	{
+		zbx_vc_item_t   new_item = {.itemid = request->itemid, .value_type = request->value_type,
+				.revision = ++vc_cache->revision};
+
+		if (NULL == (item = (zbx_vc_item_t *)zbx_hashset_insert(&vc_cache->items, &new_item,
+				sizeof(zbx_vc_item_t))))
+		{
+			return;
+		}
+	}
+
+	if (0 != (item->state & ZBX_ITEM_STATE_REMOVE_PENDING) || item->value_type != request->value_type)
+		return;
+
+	/* update the active range the same way as time based request does, so the */
+	/* prefetched values are not dropped before being requested                */
+	if (0 != item->active_range || ZBX_ITEM_STATUS_CACHED_ALL != item->status)
+		vch_item_update_range(item, request->seconds + now - request->ts.sec + 1, now);
+
+	if (ZBX_ITEM_STATUS_CACHED_ALL == item->status)
+		return;
+
+	if (0 > (range_start = request->ts.sec - request->seconds))
+		range_start = 0;
+
+	if (0 != item->db_cached_from && range_start >= item->db_cached_from)
+		return;
+
+	if (NULL != item->tail)
+		range_end = item->tail->slots[item->tail->first_value].timestamp.sec - 1;
+	else
+		range_end = ZBX_JAN_2038;
+
+	if (range_start >= range_end)
+		return;
+
+	pitem = (zbx_vc_prefetch_item_t *)zbx_malloc(NULL, sizeof(zbx_vc_prefetch_item_t));
+	pitem->item = item;
+	pitem->range_start = range_start;
+	pitem->request.itemid = item->itemid;
+	pitem->request.end = range_end;
+	zbx_vector_ptr_append(prefetch, pitem);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: vc_prefetch_items_read                                           *
+ *                                                                            *
+ * Purpose: reads prefetched item values of the same value type from history  *
+ *          storage and adds them to the cache                                *
+ *                                                                            *
+ * Parameters: pitems - [IN] the prefetched items                             *
+ *             num    - [IN] the number of prefetched items                   *
+ *                                                                            *
+ * Comments: This function must be called with unlocked cache.                *
+ *                                                                            *
+ ******************************************************************************/
+static void	vc_prefetch_items_read(zbx_vc_prefetch_item_t **pitems, int num)
+{
+	zbx_vector_ptr_t	requests;
+	int			i, ret, value_type = pitems[0]->item->value_type;
+	double			time_start, fetch_time;
+
+	zbx_vector_ptr_create(&requests);
+	zbx_vector_ptr_reserve(&requests, (size_t)num);
+
+	for (i = 0; i < num; i++)
+	{
+		zbx_history_request_t	*request = &pitems[i]->request;
+
+		/* decrement interval start point because interval starting point is excluded by history backend */
+		request->start = (0 != pitems[i]->range_start ? pitems[i]->range_start - 1 : 0);
+		zbx_history_record_vector_create(&request->values);
+		zbx_vector_ptr_append(&requests, request);
+	}
+
+	time_start = zbx_time();
+	ret = zbx_history_get_values_multi(value_type, &requests);
+	fetch_time = (zbx_time() - time_start) / num;
+
+	zbx_vector_ptr_destroy(&requests);
+
+	vc_try_lock();
+
+	for (i = 0; i < num; i++)
+	{
+		zbx_vc_item_t		*item = pitems[i]->item;
+		zbx_history_request_t	*request = &pitems[i]->request;
+
+		if (SUCCEED == ret && 0 == (item->state & ZBX_ITEM_STATE_REMOVE_PENDING))
+		{
+			vc_item_update_db_statistics(item, fetch_time);
+
+			zbx_vector_history_record_sort(&request->values,
+					(zbx_compare_func_t)zbx_history_record_compare_asc_func);
+
+			if (0 < request->values.values_num && SUCCEED != vch_item_add_values_at_tail(item,
+					request->values.values, request->values.values_num))
+			{
+				item->state |= ZBX_ITEM_STATE_REMOVE_PENDING;
+			}
+			else
+			{
+				item->status = 0;
+				vc_item_update_db_cached_from(item, pitems[i]->range_start);
+			}
+		}
+
+		vc_item_release(item);
+		zbx_history_record_vector_destroy(&request->values, value_type);
+	}
+
+	vc_try_unlock();
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_vc_prefetch_values                                           *
+ *                                                                            *
+ * Purpose: caches values of multiple items for the requested time periods    *
+ *          with one history storage request per value type                   *
+ *                                                                            *
+ * Parameters: requests     - [IN] the time based value requests              *
+ *             requests_num - [IN] the number of requests                     *
+ *                                                                            *
+ * Comments: This function is used to fill value cache misses of many items   *
+ *           at once, for example when evaluating triggers after value cache  *
+ *           reset. Items already having the requested period cached are      *
+ *           skipped. Failures are ignored - the values will be read by the   *
+ *           following zbx_vc_get_values() call.                              *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_vc_prefetch_values(const zbx_vc_prefetch_t *requests, int requests_num)
+{
+	zbx_vector_ptr_t	prefetch;
+	int			i, j, now;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() requests:%d", __func__, requests_num);
+
+	zbx_vector_ptr_create(&prefetch);
+
+	vc_try_lock();
+
+	if (ZBX_VC_DISABLED == vc_state || ZBX_VC_MODE_NORMAL != vc_cache->mode)
+	{
+		vc_try_unlock();
+		goto out;
+	}
+
+	now = time(NULL);
+
+	for (i = 0; i < requests_num; i++)
+		vc_prefetch_item_add(&prefetch, &requests[i], now);
+
+	/* merge multiple requests of the same item, keeping the largest range */
+	zbx_vector_ptr_sort(&prefetch, vc_prefetch_item_compare_func);
+
+	for (i = 0, j = 1; j < prefetch.values_num; j++)
+	{
+		zbx_vc_prefetch_item_t	*pitem = (zbx_vc_prefetch_item_t *)prefetch.values[i];
+		zbx_vc_prefetch_item_t	*pnext = (zbx_vc_prefetch_item_t *)prefetch.values[j];
+
+		if (pitem->item != pnext->item)
+		{
+			prefetch.values[++i] = pnext;
+			continue;
+		}
+
+		if (pnext->range_start < pitem->range_start)
+			pitem->range_start = pnext->range_start;
+
+		zbx_free(pnext);
+	}
+
+	if (0 != prefetch.values_num)
+		prefetch.values_num = i + 1;
+
+	for (i = 0; i < prefetch.values_num; i++)
+		vc_item_addref(((zbx_vc_prefetch_item_t *)prefetch.values[i])->item);
+
+	vc_try_unlock();
+
+	for (i = 0; i < prefetch.values_num; i = j)
+	{
+		zbx_vc_prefetch_item_t	**pitems = (zbx_vc_prefetch_item_t **)prefetch.values;
+
+		for (j = i + 1; j < prefetch.values_num && pitems[i]->item->value_type == pitems[j]->item->value_type;
+				j++)
+			;
+
+		vc_prefetch_items_read(pitems + i, j - i);
+	}
+out:
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s() prefetched:%d", __func__, prefetch.values_num);
+
+	zbx_vector_ptr_clear_ext(&prefetch, zbx_ptr_free);
+	zbx_vector_ptr_destroy(&prefetch);
+}
+
 /******************************************************************************
  *                                                                            *
  * Function: zbx_vc_get_statistics                                            *
@@ -2677,6 +3637,8 @@ out:
  ******************************************************************************/
 int	zbx_vc_get_statistics(zbx_vc_stats_t *stats)
 {
+	int	i;
+
 	if (ZBX_VC_DISABLED == vc_state)
 		return FAIL;
 
@@ -2685,6 +3647,15 @@ int	zbx_vc_get_statistics(zbx_vc_stats_t *stats)
 	stats->hits = vc_cache->hits;
 	stats->misses = vc_cache->misses;
 	stats->mode = vc_cache->mode;
+	stats->eviction = vc_cache->eviction;
+	stats->db_fetches = vc_cache->db_fetches;
+	stats->db_fetch_time = vc_cache->db_fetch_time;
+
+	for (i = 0; i < ITEM_VALUE_TYPE_MAX; i++)
+	{
+		stats->memory[i] = vc_cache->memory[i];
+		stats->quota[i] = vc_cache->quota[i];
+	}
 
 	stats->total_size = vc_mem->total_size;
 	stats->free_size = vc_mem->free_size;
@@ -2694,6 +3665,100 @@ int	zbx_vc_get_statistics(zbx_vc_stats_t *stats)
 	return SUCCEED;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_vc_get_revisions                                             *
+ *                                                                            *
+ * Purpose: get data revisions and newest value timestamps of cached items    *
+ *                                                                            *
+ * Parameters: itemids     - [IN] the item identifiers                        *
+ *             itemids_num - [IN] the number of items                         *
+ *             revisions   - [OUT] the item revisions, zero revision is       *
+ *                                 returned for items not having values in    *
+ *                                 cache                                      *
+ *                                                                            *
+ * Comments: Results calculated from item values with revision R remain valid *
+ *           while the item revision in cache is still R.                     *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_vc_get_revisions(const zbx_uint64_t *itemids, int itemids_num, zbx_vc_revision_t *revisions)
+{
+	zbx_vc_item_t	*item;
+	zbx_vc_chunk_t	*chunk;
+	int		i;
+
+	memset(revisions, 0, sizeof(zbx_vc_revision_t) * (size_t)itemids_num);
+
+	if (ZBX_VC_DISABLED == vc_state)
+		return;
+
+	vc_try_lock();
+
+	for (i = 0; i < itemids_num; i++)
+	{
+		if (NULL == (item = (zbx_vc_item_t *)zbx_hashset_search(&vc_cache->items, &itemids[i])))
+			continue;
+
+		if (0 != (item->state & ZBX_ITEM_STATE_REMOVE_PENDING) || NULL == (chunk = item->head))
+			continue;
+
+		revisions[i].revision = item->revision;
+		revisions[i].ts = chunk->slots[chunk->last_value].timestamp;
+	}
+
+	vc_try_unlock();
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_vc_get_item_stats                                            *
+ *                                                                            *
+ * Purpose: retrieves statistics of all cached items                          *
+ *                                                                            *
+ * Parameters: stats - [OUT] the cached item statistics                       *
+ *                           (zbx_vc_item_stats_t)                            *
+ *                                                                            *
+ * Return value:  SUCCEED - the item statistics were retrieved successfully   *
+ *                FAIL    - failed to retrieve item statistics                *
+ *                          (cache was not initialized)                       *
+ *                                                                            *
+ * Comments: The returned statistics must be freed by the caller.             *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_vc_get_item_stats(zbx_vector_ptr_t *stats)
+{
+	zbx_hashset_iter_t	iter;
+	zbx_vc_item_t		*item;
+	zbx_vc_item_stats_t	*item_stats;
+
+	if (ZBX_VC_DISABLED == vc_state)
+		return FAIL;
+
+	vc_try_lock();
+
+	zbx_vector_ptr_reserve(stats, vc_cache->items.num_data);
+
+	zbx_hashset_iter_reset(&vc_cache->items, &iter);
+	while (NULL != (item = (zbx_vc_item_t *)zbx_hashset_iter_next(&iter)))
+	{
+		item_stats = (zbx_vc_item_stats_t *)zbx_malloc(NULL, sizeof(zbx_vc_item_stats_t));
+		item_stats->itemid = item->itemid;
+		item_stats->value_type = item->value_type;
+		item_stats->values_num = item->values_total;
+		item_stats->memory = item->memory;
+		item_stats->hits = item->hits;
+		item_stats->misses = item->misses;
+		item_stats->db_fetches = item->db_fetches;
+		item_stats->db_fetch_time = item->db_fetch_time;
+
+		zbx_vector_ptr_append(stats, item_stats);
+	}
+
+	vc_try_unlock();
+
+	return SUCCEED;
+}
+
 /******************************************************************************
  *                                                                            *
  * Function: zbx_vc_lock                                                      *
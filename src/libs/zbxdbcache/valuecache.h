@@ -60,6 +60,12 @@
 #define ZBX_VC_MODE_NORMAL	0
 #define ZBX_VC_MODE_LOWMEM	1
 
+/* the value cache eviction policies, used to select items to drop when cache runs out of space */
+#define ZBX_VC_EVICTION_WEIGHT	0	/* drop items with the least hits per cached value */
+#define ZBX_VC_EVICTION_LRU	1	/* drop the least recently accessed items          */
+#define ZBX_VC_EVICTION_LFU	2	/* drop the least frequently accessed items        */
+#define ZBX_VC_EVICTION_COST	3	/* drop items cheapest to read back from database  */
+
 /* indicates that all values from database are cached */
 #define ZBX_ITEM_STATUS_CACHED_ALL	1
 
@@ -77,11 +83,55 @@ typedef struct
 	zbx_uint64_t	total_size;
 	zbx_uint64_t	free_size;
 
+	/* the memory used by item history data and the memory quotas (0 - no quota) per value type */
+	zbx_uint64_t	memory[ITEM_VALUE_TYPE_MAX];
+	zbx_uint64_t	quota[ITEM_VALUE_TYPE_MAX];
+
+	/* the number of database requests made to cache item values and the time spent on them */
+	zbx_uint64_t	db_fetches;
+	double		db_fetch_time;
+
 	/* value cache operating mode - see ZBX_VC_MODE_* defines */
 	int		mode;
+
+	/* value cache eviction policy - see ZBX_VC_EVICTION_* defines */
+	int		eviction;
 }
 zbx_vc_stats_t;
 
+/* the cached item statistics */
+typedef struct
+{
+	zbx_uint64_t	itemid;
+	zbx_uint64_t	hits;
+	zbx_uint64_t	misses;
+	zbx_uint64_t	db_fetches;
+	zbx_uint64_t	memory;
+	double		db_fetch_time;
+	int		values_num;
+	unsigned char	value_type;
+}
+zbx_vc_item_stats_t;
+
+/* the time based value request, used to cache values of multiple items with one history storage request */
+typedef struct
+{
+	zbx_uint64_t	itemid;
+	int		value_type;
+	int		seconds;
+	zbx_timespec_t	ts;
+}
+zbx_vc_prefetch_t;
+
+/* the cached item data revision */
+typedef struct
+{
+	zbx_uint64_t	revision;
+	/* the timestamp of the newest item value */
+	zbx_timespec_t	ts;
+}
+zbx_vc_revision_t;
+
 int	zbx_vc_init(char **error);
 
 void	zbx_vc_destroy(void);
@@ -99,12 +149,30 @@ void	zbx_vc_disable(void);
 int	zbx_vc_get_values(zbx_uint64_t itemid, int value_type, zbx_vector_history_record_t *values, int seconds,
 		int count, const zbx_timespec_t *ts);
 
+int	zbx_vc_get_values_dbl(zbx_uint64_t itemid, zbx_vector_dbl_t *values, int seconds, int count,
+		const zbx_timespec_t *ts);
+
+int	zbx_vc_get_values_uint64(zbx_uint64_t itemid, zbx_vector_uint64_t *values, int seconds, int count,
+		const zbx_timespec_t *ts);
+
+void	zbx_vc_get_values_dbl_bulk(const zbx_uint64_t *itemids, int itemids_num, zbx_vector_dbl_t *values,
+		int *offsets, int seconds, int count, const zbx_timespec_t *ts);
+
+void	zbx_vc_get_values_uint64_bulk(const zbx_uint64_t *itemids, int itemids_num, zbx_vector_uint64_t *values,
+		int *offsets, int seconds, int count, const zbx_timespec_t *ts);
+
 int	zbx_vc_get_value(zbx_uint64_t itemid, int value_type, const zbx_timespec_t *ts, zbx_history_record_t *value);
 
+void	zbx_vc_prefetch_values(const zbx_vc_prefetch_t *requests, int requests_num);
+
 int	zbx_vc_add_values(zbx_vector_ptr_t *history);
 
 int	zbx_vc_get_statistics(zbx_vc_stats_t *stats);
 
+int	zbx_vc_get_item_stats(zbx_vector_ptr_t *stats);
+
+void	zbx_vc_get_revisions(const zbx_uint64_t *itemids, int itemids_num, zbx_vc_revision_t *revisions);
+
 void	zbx_vc_housekeeping_value_cache(void);
 
 #endif	/* ZABBIX_VALUECACHE_H */
@@ -0,0 +1,343 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2019 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "common.h"
+#include "log.h"
+#include "zbxalgo.h"
+#include "valuecache.h"
+#include "preproc.h"
+#include "zbxdiag.h"
+
+static const char	*diag_value_type_string(unsigned char value_type)
+{
+	switch (value_type)
+	{
+		case ITEM_VALUE_TYPE_FLOAT:
+			return "float";
+		case ITEM_VALUE_TYPE_STR:
+			return "str";
+		case ITEM_VALUE_TYPE_LOG:
+			return "log";
+		case ITEM_VALUE_TYPE_UINT64:
+			return "uint64";
+		case ITEM_VALUE_TYPE_TEXT:
+			return "text";
+		default:
+			return "unknown";
+	}
+}
+
+static const char	*diag_eviction_string(int eviction)
+{
+	switch (eviction)
+	{
+		case ZBX_VC_EVICTION_WEIGHT:
+			return "weight";
+		case ZBX_VC_EVICTION_LRU:
+			return "lru";
+		case ZBX_VC_EVICTION_LFU:
+			return "lfu";
+		case ZBX_VC_EVICTION_COST:
+			return "cost";
+		default:
+			return "unknown";
+	}
+}
+
+static int	diag_compare_item_memory(const void *d1, const void *d2)
+{
+	const zbx_vc_item_stats_t	*s1 = *(const zbx_vc_item_stats_t **)d1;
+	const zbx_vc_item_stats_t	*s2 = *(const zbx_vc_item_stats_t **)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(s2->memory, s1->memory);
+	ZBX_RETURN_IF_NOT_EQUAL(s1->itemid, s2->itemid);
+
+	return 0;
+}
+
+static int	diag_compare_item_hits(const void *d1, const void *d2)
+{
+	const zbx_vc_item_stats_t	*s1 = *(const zbx_vc_item_stats_t **)d1;
+	const zbx_vc_item_stats_t	*s2 = *(const zbx_vc_item_stats_t **)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(s2->hits, s1->hits);
+	ZBX_RETURN_IF_NOT_EQUAL(s1->itemid, s2->itemid);
+
+	return 0;
+}
+
+static int	diag_compare_item_db_fetches(const void *d1, const void *d2)
+{
+	const zbx_vc_item_stats_t	*s1 = *(const zbx_vc_item_stats_t **)d1;
+	const zbx_vc_item_stats_t	*s2 = *(const zbx_vc_item_stats_t **)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(s2->db_fetches, s1->db_fetches);
+	ZBX_RETURN_IF_NOT_EQUAL(s1->itemid, s2->itemid);
+
+	return 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: diag_log_vc_items                                                *
+ *                                                                            *
+ * Purpose: log top value cache items sorted by the specified field           *
+ *                                                                            *
+ * Parameters: items   - [IN/OUT] the item statistics                         *
+ *             compare - [IN] the item statistics sorting function            *
+ *             title   - [IN] the sorting field name                          *
+ *                                                                            *
+ ******************************************************************************/
+static void	diag_log_vc_items(zbx_vector_ptr_t *items, zbx_compare_func_t compare, const char *title)
+{
+	int	i;
+
+	zbx_vector_ptr_sort(items, compare);
+
+	zabbix_log(LOG_LEVEL_INFORMATION, "  top %d items by %s:", ZBX_DIAG_TOP_ITEMS, title);
+
+	for (i = 0; i < items->values_num && i < ZBX_DIAG_TOP_ITEMS; i++)
+	{
+		const zbx_vc_item_stats_t	*item = (const zbx_vc_item_stats_t *)items->values[i];
+		zbx_uint64_t			requests;
+
+		requests = item->hits + item->misses;
+
+		zabbix_log(LOG_LEVEL_INFORMATION, "    itemid:" ZBX_FS_UI64 " type:%s values:%d memory:" ZBX_FS_UI64
+				" hits:" ZBX_FS_UI64 " misses:" ZBX_FS_UI64 " hit rate:%.2f%% db fetches:"
+				ZBX_FS_UI64 " db time:" ZBX_FS_DBL " sec", item->itemid,
+				diag_value_type_string(item->value_type), item->values_num, item->memory, item->hits,
+				item->misses, 0 == requests ? 0.0 : (double)item->hits * 100 / requests,
+				item->db_fetches, item->db_fetch_time);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: diag_log_valuecache                                              *
+ *                                                                            *
+ * Purpose: log value cache diagnostic information                            *
+ *                                                                            *
+ ******************************************************************************/
+static void	diag_log_valuecache(void)
+{
+	zbx_vc_stats_t		stats;
+	zbx_vector_ptr_t	items;
+	unsigned char		value_type;
+	zbx_uint64_t		requests;
+	double			time_start;
+
+	if (FAIL == zbx_vc_get_statistics(&stats))
+	{
+		zabbix_log(LOG_LEVEL_INFORMATION, "== value cache diagnostic information: disabled ==");
+		return;
+	}
+
+	time_start = zbx_time();
+
+	zabbix_log(LOG_LEVEL_INFORMATION, "== value cache diagnostic information ==");
+
+	requests = stats.hits + stats.misses;
+
+	zabbix_log(LOG_LEVEL_INFORMATION, "mode:%s eviction:%s memory total:" ZBX_FS_UI64 " free:" ZBX_FS_UI64,
+			ZBX_VC_MODE_NORMAL == stats.mode ? "normal" : "low memory",
+			diag_eviction_string(stats.eviction), stats.total_size, stats.free_size);
+	zabbix_log(LOG_LEVEL_INFORMATION, "requests:" ZBX_FS_UI64 " hits:" ZBX_FS_UI64 " misses:" ZBX_FS_UI64
+			" hit rate:%.2f%% db fetches:" ZBX_FS_UI64 " db time:" ZBX_FS_DBL " sec", requests, stats.hits,
+			stats.misses, 0 == requests ? 0.0 : (double)stats.hits * 100 / requests, stats.db_fetches,
+			stats.db_fetch_time);
+
+	for (value_type = 0; value_type < ITEM_VALUE_TYPE_MAX; value_type++)
+	{
+		zabbix_log(LOG_LEVEL_INFORMATION, "  %s memory:" ZBX_FS_UI64 " quota:" ZBX_FS_UI64,
+				diag_value_type_string(value_type), stats.memory[value_type], stats.quota[value_type]);
+	}
+
+	zbx_vector_ptr_create(&items);
+
+	if (SUCCEED == zbx_vc_get_item_stats(&items))
+	{
+		zabbix_log(LOG_LEVEL_INFORMATION, "items:%d", items.values_num);
+
+		diag_log_vc_items(&items, diag_compare_item_memory, "memory");
+		diag_log_vc_items(&items, diag_compare_item_hits, "hits");
+		diag_log_vc_items(&items, diag_compare_item_db_fetches, "db fetches");
+	}
+
+	zbx_vector_ptr_clear_ext(&items, zbx_ptr_free);
+	zbx_vector_ptr_destroy(&items);
+
+	zabbix_log(LOG_LEVEL_INFORMATION, "== value cache diagnostic information collected in " ZBX_FS_DBL " sec ==",
+			zbx_time() - time_start);
+}
+
+static int	diag_compare_preproc_item_time(const void *d1, const void *d2)
+{
+	const zbx_preproc_item_stats_t	*s1 = *(const zbx_preproc_item_stats_t **)d1;
+	const zbx_preproc_item_stats_t	*s2 = *(const zbx_preproc_item_stats_t **)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(s2->time + s2->queue_time, s1->time + s1->queue_time);
+	ZBX_RETURN_IF_NOT_EQUAL(s1->itemid, s2->itemid);
+
+	return 0;
+}
+
+static int	diag_compare_preproc_worker(const void *d1, const void *d2)
+{
+	const zbx_preproc_worker_stats_t	*s1 = *(const zbx_preproc_worker_stats_t **)d1;
+	const zbx_preproc_worker_stats_t	*s2 = *(const zbx_preproc_worker_stats_t **)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(s1->process_num, s2->process_num);
+
+	return 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: diag_log_preproc_time                                            *
+ *                                                                            *
+ * Purpose: log preprocessing time statistics with non empty histogram        *
+ *          buckets                                                           *
+ *                                                                            *
+ * Parameters: title - [IN] the statistics title                              *
+ *             stats - [IN] the time statistics                               *
+ *                                                                            *
+ ******************************************************************************/
+static void	diag_log_preproc_time(const char *title, const zbx_preproc_time_stats_t *stats)
+{
+	char		*buckets = NULL;
+	size_t		buckets_alloc = 0, buckets_offset = 0;
+	int		i;
+	zbx_uint64_t	limit = 1;
+
+	for (i = 0; i < ZBX_PREPROC_TIME_BUCKETS; i++, limit *= 2)
+	{
+		if (0 == stats->buckets[i])
+			continue;
+
+		if (ZBX_PREPROC_TIME_BUCKETS - 1 != i)
+		{
+			zbx_snprintf_alloc(&buckets, &buckets_alloc, &buckets_offset, " <" ZBX_FS_UI64 "us:" ZBX_FS_UI64,
+					limit, stats->buckets[i]);
+		}
+		else
+		{
+			zbx_snprintf_alloc(&buckets, &buckets_alloc, &buckets_offset, " >=" ZBX_FS_UI64 "us:"
+					ZBX_FS_UI64, limit / 2, stats->buckets[i]);
+		}
+	}
+
+	zabbix_log(LOG_LEVEL_INFORMATION, "  %s count:" ZBX_FS_UI64 " time:" ZBX_FS_DBL " avg:" ZBX_FS_DBL " max:"
+			ZBX_FS_DBL " sec", title, stats->count, stats->time,
+			0 == stats->count ? 0.0 : stats->time / stats->count, stats->time_max);
+
+	if (NULL != buckets)
+	{
+		zabbix_log(LOG_LEVEL_INFORMATION, "    histogram:%s", buckets);
+		zbx_free(buckets);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: diag_log_preprocessing                                           *
+ *                                                                            *
+ * Purpose: log preprocessing diagnostic information                          *
+ *                                                                            *
+ ******************************************************************************/
+static void	diag_log_preprocessing(void)
+{
+	zbx_preproc_stats_t	stats;
+	unsigned char		type;
+	int			i;
+	double			time_start;
+
+	time_start = zbx_time();
+
+	zabbix_log(LOG_LEVEL_INFORMATION, "== preprocessing diagnostic information ==");
+
+	zbx_preprocessor_get_stats(&stats, ZBX_DIAG_TOP_ITEMS);
+
+	zabbix_log(LOG_LEVEL_INFORMATION, "queue:" ZBX_FS_UI64 " statistics period:" ZBX_FS_DBL " sec",
+			zbx_preprocessor_get_queue_size(), stats.time);
+
+	diag_log_preproc_time("queue time", &stats.queue);
+
+	zabbix_log(LOG_LEVEL_INFORMATION, "workers:%d", stats.workers.values_num);
+
+	zbx_vector_ptr_sort(&stats.workers, diag_compare_preproc_worker);
+
+	for (i = 0; i < stats.workers.values_num; i++)
+	{
+		const zbx_preproc_worker_stats_t	*worker = (const zbx_preproc_worker_stats_t *)stats.workers.values[i];
+
+		zabbix_log(LOG_LEVEL_INFORMATION, "  preprocessing worker #%d values:" ZBX_FS_UI64 " values/sec:"
+				ZBX_FS_DBL, worker->process_num, worker->values_num,
+				0 == stats.time ? 0.0 : worker->values_num / stats.time);
+	}
+
+	zabbix_log(LOG_LEVEL_INFORMATION, "steps:");
+
+	for (type = 0; type < ZBX_PREPROC_TYPE_MAX; type++)
+	{
+		if (0 != stats.steps[type].count)
+			diag_log_preproc_time(zbx_preproc_type_string(type), &stats.steps[type]);
+	}
+
+	zbx_vector_ptr_sort(&stats.items, diag_compare_preproc_item_time);
+
+	zabbix_log(LOG_LEVEL_INFORMATION, "  top %d items by preprocessing and queue time:", ZBX_DIAG_TOP_ITEMS);
+
+	for (i = 0; i < stats.items.values_num && i < ZBX_DIAG_TOP_ITEMS; i++)
+	{
+		const zbx_preproc_item_stats_t	*item = (const zbx_preproc_item_stats_t *)stats.items.values[i];
+
+		zabbix_log(LOG_LEVEL_INFORMATION, "    itemid:" ZBX_FS_UI64 " values:" ZBX_FS_UI64 " time:" ZBX_FS_DBL
+				" avg:" ZBX_FS_DBL " max:" ZBX_FS_DBL " sec, queued values:" ZBX_FS_UI64 " time:"
+				ZBX_FS_DBL " avg:" ZBX_FS_DBL " max:" ZBX_FS_DBL " sec", item->itemid, item->count,
+				item->time, 0 == item->count ? 0.0 : item->time / item->count, item->time_max,
+				item->queue_count, item->queue_time,
+				0 == item->queue_count ? 0.0 : item->queue_time / item->queue_count,
+				item->queue_time_max);
+	}
+
+	zbx_preprocessor_clear_stats(&stats);
+
+	zabbix_log(LOG_LEVEL_INFORMATION, "== preprocessing diagnostic information collected in " ZBX_FS_DBL " sec ==",
+			zbx_time() - time_start);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_diag_log_info                                                *
+ *                                                                            *
+ * Purpose: log diagnostic information of the specified sections              *
+ *                                                                            *
+ * Parameters: flags - [IN] the diagnostic sections to log, see               *
+ *                          ZBX_DIAGINFO_SECTION_* defines                    *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_diag_log_info(unsigned int flags)
+{
+	if (0 != (flags & ZBX_DIAGINFO_SECTION_VALUECACHE))
+		diag_log_valuecache();
+
+	if (0 != (flags & ZBX_DIAGINFO_SECTION_PREPROCESSING))
+		diag_log_preprocessing();
+}
@@ -38,6 +38,17 @@
 #define ZBX_ES_SCRIPT_HEADER	"function(value){"
 #define ZBX_ES_SCRIPT_FOOTER	"\n}"
 
+/* maximum number of loaded script functions kept in the heap */
+#define ZBX_ES_FUNC_CACHE_SIZE	32
+
+/* maximum number of script characters used as script description in logs */
+#define ZBX_ES_FUNC_NAME_LEN	64
+
+/* number of script functions with the highest total execution time logged periodically */
+#define ZBX_ES_FUNC_STATS_TOP	10
+
+#define ZBX_ES_FUNCS_STASH	"\xff""\xff""zbx_funcs"
+
 /******************************************************************************
  *                                                                            *
  * Function: es_handle_error                                                  *
@@ -74,6 +85,10 @@ static void	*es_malloc(void *udata, duk_size_t size)
 	}
 
 	env->total_alloc += (size + 8);
+
+	if (env->peak_alloc < env->total_alloc)
+		env->peak_alloc = env->total_alloc;
+
 	uptr = zbx_malloc(NULL, size + 8);
 	*uptr++ = size;
 
@@ -103,6 +118,10 @@ static void	*es_realloc(void *udata, void *ptr, duk_size_t size)
 	}
 
 	env->total_alloc += size + 8 - old_size;
+
+	if (env->peak_alloc < env->total_alloc)
+		env->peak_alloc = env->total_alloc;
+
 	uptr = zbx_realloc(uptr, size + 8);
 	*uptr++ = size;
 
@@ -121,6 +140,210 @@ static void	es_free(void *udata, void *ptr)
 	}
 }
 
+/*
+ * Loaded script function cache. Script functions are loaded from bytecode
+ * into the heap once and kept in the global stash, indexed by function
+ * identifier. When the cache is full the least recently used function is
+ * removed.
+ */
+
+static zbx_hash_t	es_func_hash(const void *data)
+{
+	const zbx_es_func_t	*func = (const zbx_es_func_t *)data;
+
+	return ZBX_DEFAULT_STRING_HASH_ALGO(func->code, func->size, ZBX_DEFAULT_HASH_SEED);
+}
+
+static int	es_func_compare(const void *d1, const void *d2)
+{
+	const zbx_es_func_t	*func1 = (const zbx_es_func_t *)d1;
+	const zbx_es_func_t	*func2 = (const zbx_es_func_t *)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(func1->size, func2->size);
+
+	return memcmp(func1->code, func2->code, func1->size);
+}
+
+static void	es_func_clean(void *data)
+{
+	zbx_es_func_t	*func = (zbx_es_func_t *)data;
+
+	zbx_free(func->code);
+	zbx_free(func->name);
+}
+
+static int	es_func_compare_time(const void *d1, const void *d2)
+{
+	const zbx_es_func_t	*func1 = *(const zbx_es_func_t **)d1;
+	const zbx_es_func_t	*func2 = *(const zbx_es_func_t **)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(func2->time_total, func1->time_total);
+
+	return 0;
+}
+
+static void	es_func_log_stats(int level, const zbx_es_func_t *func)
+{
+	zabbix_log(level, "javascript function \"%s\": calls:" ZBX_FS_UI64 " total time:" ZBX_FS_DBL
+			" sec max time:" ZBX_FS_DBL " sec max memory:" ZBX_FS_SIZE_T, func->name, func->calls,
+			func->time_total, func->time_max, (zbx_fs_size_t)func->mem_max);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: es_log_stats                                                     *
+ *                                                                            *
+ * Purpose: logs execution statistics of the loaded script functions          *
+ *                                                                            *
+ * Parameters: env     - [IN] the scripting engine environment                *
+ *             top_num - [IN] the number of functions to log with information *
+ *                            log level                                       *
+ *                                                                            *
+ * Comments: The functions are logged in the order of total execution time.   *
+ *           The first top_num functions are logged with information log      *
+ *           level and the rest with debug log level.                         *
+ *                                                                            *
+ ******************************************************************************/
+static void	es_log_stats(zbx_es_env_t *env, int top_num)
+{
+	zbx_hashset_iter_t	iter;
+	zbx_es_func_t		*func;
+	zbx_vector_ptr_t	funcs;
+	int			i;
+
+	if (0 == env->funcs.num_data || (0 == top_num && SUCCEED != ZBX_CHECK_LOG_LEVEL(LOG_LEVEL_DEBUG)))
+		return;
+
+	zbx_vector_ptr_create(&funcs);
+
+	zbx_hashset_iter_reset(&env->funcs, &iter);
+	while (NULL != (func = (zbx_es_func_t *)zbx_hashset_iter_next(&iter)))
+		zbx_vector_ptr_append(&funcs, func);
+
+	zbx_vector_ptr_sort(&funcs, es_func_compare_time);
+
+	if (0 != top_num)
+	{
+		zabbix_log(LOG_LEVEL_INFORMATION, "top %d of %d loaded javascript functions by total time:",
+				MIN(top_num, funcs.values_num), funcs.values_num);
+	}
+
+	for (i = 0; i < funcs.values_num; i++)
+	{
+		es_func_log_stats(i < top_num ? LOG_LEVEL_INFORMATION : LOG_LEVEL_DEBUG,
+				(zbx_es_func_t *)funcs.values[i]);
+	}
+
+	zbx_vector_ptr_destroy(&funcs);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: es_func_evict                                                    *
+ *                                                                            *
+ * Purpose: removes the least recently used script function from cache        *
+ *                                                                            *
+ * Parameters: env - [IN] the scripting engine environment                    *
+ *                                                                            *
+ * Comments: The function cache object must be on the top of the stack.       *
+ *                                                                            *
+ ******************************************************************************/
+static void	es_func_evict(zbx_es_env_t *env)
+{
+	zbx_hashset_iter_t	iter;
+	zbx_es_func_t		*func, *func_lru = NULL;
+
+	zbx_hashset_iter_reset(&env->funcs, &iter);
+	while (NULL != (func = (zbx_es_func_t *)zbx_hashset_iter_next(&iter)))
+	{
+		if (NULL == func_lru || func->lastaccess < func_lru->lastaccess)
+			func_lru = func;
+	}
+
+	if (NULL == func_lru)
+		return;
+
+	es_func_log_stats(LOG_LEVEL_DEBUG, func_lru);
+
+	duk_del_prop_index(env->ctx, -1, func_lru->funcid);
+	zbx_hashset_remove_direct(&env->funcs, func_lru);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: es_func_push                                                     *
+ *                                                                            *
+ * Purpose: pushes script function on the stack, loading it from bytecode if  *
+ *          it is not cached yet                                              *
+ *                                                                            *
+ * Parameters: env    - [IN] the scripting engine environment                 *
+ *             script - [IN] the script, can be NULL                          *
+ *             code   - [IN] the precompiled bytecode                         *
+ *             size   - [IN] the size of precompiled bytecode                 *
+ *                                                                            *
+ * Return value: the cached script function                                   *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_es_func_t	*es_func_push(zbx_es_env_t *env, const char *script, const char *code, int size)
+{
+	zbx_es_func_t	func_local, *func;
+	void		*buffer;
+	char		*ptr;
+
+	func_local.code = (char *)code;
+	func_local.size = size;
+
+	duk_push_global_stash(env->ctx);
+	duk_get_prop_string(env->ctx, -1, ZBX_ES_FUNCS_STASH);
+
+	if (NULL != (func = (zbx_es_func_t *)zbx_hashset_search(&env->funcs, &func_local)))
+	{
+		duk_get_prop_index(env->ctx, -1, func->funcid);
+	}
+	else
+	{
+		if (ZBX_ES_FUNC_CACHE_SIZE <= env->funcs.num_data)
+			es_func_evict(env);
+
+		buffer = duk_push_fixed_buffer(env->ctx, size);
+		memcpy(buffer, code, size);
+		duk_load_function(env->ctx);
+
+		duk_dup(env->ctx, -1);
+		duk_put_prop_index(env->ctx, -3, env->funcid_next);
+
+		memset(&func_local, 0, sizeof(func_local));
+		func_local.code = zbx_malloc(NULL, size);
+		memcpy(func_local.code, code, size);
+		func_local.size = size;
+		func_local.funcid = env->funcid_next++;
+
+		if (NULL != script)
+		{
+			func_local.name = zbx_strdup(NULL, script);
+			func_local.name[zbx_strlen_utf8_nchars(script, ZBX_ES_FUNC_NAME_LEN)] = '\0';
+
+			for (ptr = func_local.name; '\0' != *ptr; ptr++)
+			{
+				if ('\n' == *ptr || '\r' == *ptr || '\t' == *ptr)
+					*ptr = ' ';
+			}
+		}
+		else
+			func_local.name = zbx_dsprintf(NULL, "#%u", (unsigned int)func_local.funcid);
+
+		func = (zbx_es_func_t *)zbx_hashset_insert(&env->funcs, &func_local, sizeof(func_local));
+	}
+
+	func->lastaccess = env->access_next++;
+
+	/* remove function cache and global stash objects, leaving only the function on the stack */
+	duk_remove(env->ctx, -2);
+	duk_remove(env->ctx, -2);
+
+	return func;
+}
+
 /******************************************************************************
  *                                                                            *
  * Function: zbx_es_check_timeout                                             *
@@ -189,6 +412,9 @@ int	zbx_es_init_env(zbx_es_t *es, char **error)
 	es->env = zbx_malloc(NULL, sizeof(zbx_es_env_t));
 	memset(es->env, 0, sizeof(zbx_es_env_t));
 
+	zbx_hashset_create_ext(&es->env->funcs, ZBX_ES_FUNC_CACHE_SIZE, es_func_hash, es_func_compare, es_func_clean,
+			ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC, ZBX_DEFAULT_MEM_FREE_FUNC);
+
 	if (0 != setjmp(es->env->loc))
 	{
 		*error = zbx_strdup(*error, es->env->error);
@@ -219,6 +445,14 @@ int	zbx_es_init_env(zbx_es_t *es, char **error)
 		return FAIL;
 	}
 
+	/* create object for loaded script functions */
+	duk_push_object(es->env->ctx);
+	if (1 != duk_put_prop_string(es->env->ctx, -2, ZBX_ES_FUNCS_STASH))
+	{
+		*error = zbx_strdup(*error, duk_safe_to_string(es->env->ctx, -1));
+		goto out;
+	}
+
 	/* initialize CurlHttpRequest prototype */
 	if (FAIL == zbx_es_init_httprequest(es, error))
 		goto out;
@@ -228,6 +462,7 @@ int	zbx_es_init_env(zbx_es_t *es, char **error)
 out:
 	if (SUCCEED != ret)
 	{
+		zbx_hashset_destroy(&es->env->funcs);
 		zbx_free(es->env->error);
 		zbx_free(es->env);
 	}
@@ -264,7 +499,10 @@ int	zbx_es_destroy_env(zbx_es_t *es, char **error)
 		goto out;
 	}
 
+	es_log_stats(es->env, 0);
+
 	duk_destroy_heap(es->env->ctx);
+	zbx_hashset_destroy(&es->env->funcs);
 	zbx_free(es->env->error);
 	zbx_free(es->env);
 
@@ -423,12 +661,17 @@ out:
  *           cache some compilation data that can be reused for the next      *
  *           compilation. Because of that execute function accepts script and *
  *           bytecode parameters.                                             *
+ *           The function loaded from bytecode is kept in the heap and reused *
+ *           by the following calls with the same bytecode.                   *
  *                                                                            *
  ******************************************************************************/
 int	zbx_es_execute(zbx_es_t *es, const char *script, const char *code, int size, const char *param, char **output,
 	char **error)
 {
-	void		*buffer;
+	zbx_es_func_t	*func;
+	duk_int_t	rc_exec;
+	double		time_start, time_exec;
+	size_t		alloc_start;
 	volatile int	ret = FAIL;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
@@ -439,22 +682,32 @@ int	zbx_es_execute(zbx_es_t *es, const char *script, const char *code, int size,
 		goto out;
 	}
 
-	ZBX_UNUSED(script);
-
 	if (0 != setjmp(es->env->loc))
 	{
 		*error = zbx_strdup(*error, es->env->error);
 		goto out;
 	}
 
-	buffer = duk_push_fixed_buffer(es->env->ctx, size);
-	memcpy(buffer, code, size);
-	duk_load_function(es->env->ctx);
+	func = es_func_push(es->env, script, code, size);
 	duk_push_string(es->env->ctx, param);
 
 	es->env->start_time = time(NULL);
+	es->env->peak_alloc = alloc_start = es->env->total_alloc;
+	time_start = zbx_time();
 
-	if (DUK_EXEC_SUCCESS != duk_pcall(es->env->ctx, 1))
+	rc_exec = duk_pcall(es->env->ctx, 1);
+
+	time_exec = zbx_time() - time_start;
+	func->calls++;
+	func->time_total += time_exec;
+
+	if (func->time_max < time_exec)
+		func->time_max = time_exec;
+
+	if (func->mem_max < es->env->peak_alloc - alloc_start)
+		func->mem_max = es->env->peak_alloc - alloc_start;
+
+	if (DUK_EXEC_SUCCESS != rc_exec)
 	{
 		duk_small_int_t	rc = 0;
 
@@ -514,3 +767,23 @@ void	zbx_es_set_timeout(zbx_es_t *es, int timeout)
 {
 	es->env->timeout = timeout;
 }
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_es_log_stats                                                 *
+ *                                                                            *
+ * Purpose: logs execution statistics of the loaded script functions          *
+ *                                                                            *
+ * Parameters: es - [IN] the embedded scripting engine                        *
+ *                                                                            *
+ * Comments: The functions with the highest total execution time are logged   *
+ *           with information log level, the rest with debug log level.       *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_es_log_stats(zbx_es_t *es)
+{
+	if (NULL == es->env)
+		return;
+
+	es_log_stats(es->env, ZBX_ES_FUNC_STATS_TOP);
+}
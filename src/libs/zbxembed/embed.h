@@ -21,14 +21,40 @@
 #define ZABBIX_EMBED_H
 
 #include "common.h"
+#include "zbxalgo.h"
 #include "duktape.h"
 
+/* loaded script function, cached in the heap stash */
+typedef struct
+{
+	char		*code;
+	int		size;
+	duk_uarridx_t	funcid;
+	zbx_uint64_t	lastaccess;
+
+	/* script description for logging */
+	char		*name;
+
+	/* execution statistics */
+	zbx_uint64_t	calls;
+	double		time_total;
+	double		time_max;
+	size_t		mem_max;
+}
+zbx_es_func_t;
+
 struct zbx_es_env
 {
 	duk_context	*ctx;
 	size_t		total_alloc;
+	size_t		peak_alloc;
 	time_t		start_time;
 
+	/* loaded script functions with bounded least recently used eviction */
+	zbx_hashset_t	funcs;
+	duk_uarridx_t	funcid_next;
+	zbx_uint64_t	access_next;
+
 	char		*error;
 	int		rt_error_num;
 	int		fatal_error;
@@ -29,6 +29,7 @@ ZBX_VECTOR_IMPL(history_record, zbx_history_record_t)
 
 extern char	*CONFIG_HISTORY_STORAGE_URL;
 extern char	*CONFIG_HISTORY_STORAGE_OPTS;
+extern char	*CONFIG_HISTORY_LOCAL_PATH;
 
 zbx_history_iface_t	history_ifaces[ITEM_VALUE_TYPE_MAX];
 
@@ -53,10 +54,13 @@ int	zbx_history_init(char **error)
 
 	for (i = 0; i < ITEM_VALUE_TYPE_MAX; i++)
 	{
-		if (NULL == CONFIG_HISTORY_STORAGE_URL || NULL == strstr(CONFIG_HISTORY_STORAGE_OPTS, opts[i]))
-			ret = zbx_history_sql_init(&history_ifaces[i], i, error);
-		else
+		if (NULL != CONFIG_HISTORY_STORAGE_URL && NULL != strstr(CONFIG_HISTORY_STORAGE_OPTS, opts[i]))
 			ret = zbx_history_elastic_init(&history_ifaces[i], i, error);
+		else if (NULL != CONFIG_HISTORY_LOCAL_PATH &&
+				(ITEM_VALUE_TYPE_FLOAT == i || ITEM_VALUE_TYPE_UINT64 == i))
+			ret = zbx_history_column_init(&history_ifaces[i], i, error);
+		else
+			ret = zbx_history_sql_init(&history_ifaces[i], i, error);
 
 		if (FAIL == ret)
 			return FAIL;
@@ -125,6 +129,53 @@ int	zbx_history_add_values(const zbx_vector_ptr_t *history)
 	return ret;
 }
 
+/************************************************************************************
+ *                                                                                  *
+ * Function: zbx_history_flush                                                      *
+ *                                                                                  *
+ * Purpose: flushes pending history data of all storage backends                    *
+ *                                                                                  *
+ * Comments: Asynchronous backends send data in the background, so this function   *
+ *           must be called periodically even if there are no new values to allow   *
+ *           pending and failed requests to be completed.                           *
+ *                                                                                  *
+ ************************************************************************************/
+void	zbx_history_flush(void)
+{
+	int	i;
+
+	for (i = 0; i < ITEM_VALUE_TYPE_MAX; i++)
+	{
+		zbx_history_iface_t	*writer = &history_ifaces[i];
+
+		writer->flush(writer);
+	}
+}
+
+/************************************************************************************
+ *                                                                                  *
+ * Function: zbx_history_housekeep                                                  *
+ *                                                                                  *
+ * Purpose: performs storage maintenance of history storage backends               *
+ *                                                                                  *
+ * Comments: Only backends managing their own storage (local history storage)       *
+ *           implement housekeeping. It is done by housekeeper process to keep      *
+ *           history syncers from being blocked by it.                              *
+ *                                                                                  *
+ ************************************************************************************/
+void	zbx_history_housekeep(void)
+{
+	int	i;
+
+	for (i = 0; i < ITEM_VALUE_TYPE_MAX; i++)
+	{
+		zbx_history_iface_t	*writer = &history_ifaces[i];
+
+		if (NULL != writer->housekeep)
+			writer->housekeep(writer);
+	}
+}
+
 /************************************************************************************
  *                                                                                  *
  * Function: zbx_history_get_values                                                 *
@@ -177,6 +228,43 @@ int	zbx_history_get_values(zbx_uint64_t itemid, int value_type, int start, int c
 	return ret;
 }
 
+/************************************************************************************
+ *                                                                                  *
+ * Function: zbx_history_get_values_multi                                           *
+ *                                                                                  *
+ * Purpose: gets values of multiple items from history storage in one round trip    *
+ *                                                                                  *
+ * Parameters:  value_type - [IN] the item value type                               *
+ *              requests   - [IN/OUT] the read requests (zbx_history_request_t *),  *
+ *                           the read values are appended to request values vector  *
+ *                                                                                  *
+ * Return value: SUCCEED - the history data were read successfully                  *
+ *               FAIL - otherwise                                                   *
+ *                                                                                  *
+ * Comments: This function reads all values from ]<start>,<end>] interval of each   *
+ *           request. The order of requests vector can be changed.                  *
+ *                                                                                  *
+ ************************************************************************************/
+int	zbx_history_get_values_multi(int value_type, zbx_vector_ptr_t *requests)
+{
+	int			ret, values_num = 0, i;
+	zbx_history_iface_t	*writer = &history_ifaces[value_type];
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() value_type:%d requests:%d", __func__, value_type, requests->values_num);
+
+	for (i = 0; i < requests->values_num; i++)
+		values_num -= ((zbx_history_request_t *)requests->values[i])->values.values_num;
+
+	ret = writer->get_values_multi(writer, requests);
+
+	for (i = 0; i < requests->values_num; i++)
+		values_num += ((zbx_history_request_t *)requests->values[i])->values.values_num;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s values:%d", __func__, zbx_result_string(ret), values_num);
+
+	return ret;
+}
+
 /************************************************************************************
  *                                                                                  *
  * Function: zbx_history_requires_trends                                            *
@@ -0,0 +1,1715 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2019 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "common.h"
+#include "log.h"
+#include "zbxalgo.h"
+#include "dbcache.h"
+#include "zbxhistory.h"
+#include "history.h"
+
+/* Local columnar history storage.                                                              */
+/*                                                                                              */
+/* Numeric history is stored in <HistoryStorageLocalPath>/<value type>/<partition start>/       */
+/* directories, each partition covering ZBX_COLUMN_PARTITION_PERIOD seconds of value clocks.   */
+/* Every history syncer appends to its own <pid>.zhc file in a partition. The files consist of  */
+/* chunks - a header, per item column blocks and the item table sorted by itemid:               */
+/*                                                                                              */
+/*   [zbx_column_chunk_t][item 1 block][item 2 block]...[zbx_column_item_t 1][...]              */
+/*                                                                                              */
+/* Item blocks store clock deltas, nanoseconds and values as separate columns. Clocks,          */
+/* nanoseconds and unsigned values (as zigzag deltas) are varint encoded, floating point values */
+/* are stored as the significant bytes of their xor with the previous value.                    */
+/*                                                                                              */
+/* Closed partitions are compacted into a single chunk and partitions older than                */
+/* HistoryStorageLocalRetention days are dropped by removing their directory. Both are done by  */
+/* the housekeeper, so history syncers only append new chunks.                                  */
+/*                                                                                              */
+/* The storage is used by server processes only - frontend reads history from the database, so */
+/* it cannot show values stored here. Item history storage periods are not applied, all values  */
+/* are kept for HistoryStorageLocalRetention days.                                              */
+
+/* history values are stored in partitions covering this period of time */
+#define ZBX_COLUMN_PARTITION_PERIOD	SEC_PER_HOUR
+
+/* closed partitions are compacted after this delay to allow late values to arrive */
+#define ZBX_COLUMN_COMPACT_DELAY	(10 * SEC_PER_MIN)
+
+/* item tables up to this size are read with a single call, larger tables are searched on disk */
+#define ZBX_COLUMN_TABLE_READ_MAX	2048
+
+#define ZBX_COLUMN_CHUNK_MAGIC		0x3143485a	/* "ZHC1" */
+
+#define ZBX_COLUMN_FILE_EXT		".zhc"
+#define ZBX_COLUMN_MERGE_EXT		".merging"
+#define ZBX_COLUMN_COMPACT_FILE		"compact" ZBX_COLUMN_FILE_EXT
+#define ZBX_COLUMN_COMPACT_TMP		"compact.tmp"
+#define ZBX_COLUMN_COMPACT_LOCK		"compact.lock"
+
+extern char	*CONFIG_HISTORY_LOCAL_PATH;
+extern int	CONFIG_HISTORY_LOCAL_RETENTION;
+
+typedef struct
+{
+	zbx_uint32_t	magic;
+	zbx_uint32_t	items_num;
+	zbx_uint64_t	size;
+	zbx_uint64_t	table_offset;
+}
+zbx_column_chunk_t;
+
+typedef struct
+{
+	zbx_uint64_t	itemid;
+	zbx_uint64_t	offset;
+	zbx_uint32_t	size;
+	zbx_uint32_t	values_num;
+	int		clock_min;
+	int		clock_max;
+}
+zbx_column_item_t;
+
+/* the item block reference used during partition compaction */
+typedef struct
+{
+	zbx_column_item_t	item;
+	int			file;
+}
+zbx_column_ref_t;
+
+typedef struct
+{
+	zbx_uint64_t		itemid;
+	zbx_history_record_t	record;
+}
+zbx_column_value_t;
+
+typedef struct
+{
+	unsigned char	*data;
+	size_t		alloc;
+	size_t		offset;
+}
+zbx_column_buf_t;
+
+typedef struct
+{
+	/* the value type directory */
+	char			*path;
+
+	/* the values to be written by flush */
+	zbx_column_value_t	*values;
+	int			values_num;
+	int			values_alloc;
+}
+zbx_column_data_t;
+
+/******************************************************************************************************************
+ *                                                                                                                *
+ * column encoding support                                                                                        *
+ *                                                                                                                *
+ ******************************************************************************************************************/
+
+static void	column_buf_reserve(zbx_column_buf_t *buf, size_t size)
+{
+	if (buf->offset + size <= buf->alloc)
+		return;
+
+	if (0 == buf->alloc)
+		buf->alloc = ZBX_KIBIBYTE;
+
+	while (buf->offset + size > buf->alloc)
+		buf->alloc *= 2;
+
+	buf->data = (unsigned char *)zbx_realloc(buf->data, buf->alloc);
+}
+
+static void	column_buf_append(zbx_column_buf_t *buf, const void *data, size_t size)
+{
+	column_buf_reserve(buf, size);
+	memcpy(buf->data + buf->offset, data, size);
+	buf->offset += size;
+}
+
+static void	column_encode_uint(zbx_column_buf_t *buf, zbx_uint64_t value)
+{
+	column_buf_reserve(buf, 10);
+
+	while (0x80 <= value)
+	{
+		buf->data[buf->offset++] = (unsigned char)(value | 0x80);
+		value >>= 7;
+	}
+
+	buf->data[buf->offset++] = (unsigned char)value;
+}
+
+static int	column_decode_uint(const unsigned char **ptr, const unsigned char *end, zbx_uint64_t *value)
+{
+	const unsigned char	*p = *ptr;
+	int			shift = 0;
+
+	*value = 0;
+
+	while (p < end && 64 > shift)
+	{
+		*value |= (zbx_uint64_t)(*p & 0x7f) << shift;
+
+		if (0 == (*p++ & 0x80))
+		{
+			*ptr = p;
+			return SUCCEED;
+		}
+
+		shift += 7;
+	}
+
+	return FAIL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: column_encode_xor                                                *
+ *                                                                            *
+ * Purpose: encodes xor of two consecutive floating point values              *
+ *                                                                            *
+ * Comments: The xor is stored as a byte with the number of leading (high     *
+ *           nibble) and trailing (low nibble) zero bytes followed by the     *
+ *           remaining bytes. Repeated values take one byte, values with the  *
+ *           same exponent or short mantissa take only few bytes.             *
+ *                                                                            *
+ ******************************************************************************/
+static void	column_encode_xor(zbx_column_buf_t *buf, zbx_uint64_t value)
+{
+	int	leading = 0, trailing = 0, i;
+
+	if (0 == value)
+	{
+		leading = 8;
+	}
+	else
+	{
+		while (0 == ((value >> (56 - leading * 8)) & 0xff))
+			leading++;
+
+		while (0 == ((value >> (trailing * 8)) & 0xff))
+			trailing++;
+	}
+
+	column_buf_reserve(buf, 9);
+	buf->data[buf->offset++] = (unsigned char)((leading << 4) | trailing);
+
+	for (i = trailing; i < 8 - leading; i++)
+		buf->data[buf->offset++] = (unsigned char)(value >> (i * 8));
+}
+
+static int	column_decode_xor(const unsigned char **ptr, const unsigned char *end, zbx_uint64_t *value)
+{
+	const unsigned char	*p = *ptr;
+	int			leading, trailing, i;
+
+	if (p >= end)
+		return FAIL;
+
+	leading = *p >> 4;
+	trailing = *p++ & 0x0f;
+
+	if (8 < leading + trailing || end - p < 8 - leading - trailing)
+		return FAIL;
+
+	*value = 0;
+
+	for (i = trailing; i < 8 - leading; i++)
+		*value |= (zbx_uint64_t)*p++ << (i * 8);
+
+	*ptr = p;
+
+	return SUCCEED;
+}
+
+static zbx_uint64_t	column_dbl2bits(double value)
+{
+	zbx_uint64_t	bits;
+
+	memcpy(&bits, &value, sizeof(bits));
+
+	return bits;
+}
+
+static double	column_bits2dbl(zbx_uint64_t bits)
+{
+	double	value;
+
+	memcpy(&value, &bits, sizeof(value));
+
+	return value;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: column_encode_block                                              *
+ *                                                                            *
+ * Purpose: encodes item values into column block                             *
+ *                                                                            *
+ * Parameters: buf        - [IN/OUT] the output buffer                        *
+ *             value_type - [IN] the value type                               *
+ *             records    - [IN] the values sorted by timestamps              *
+ *             num        - [IN] the number of values                         *
+ *                                                                            *
+ ******************************************************************************/
+static void	column_encode_block(zbx_column_buf_t *buf, unsigned char value_type, const zbx_history_record_t *records,
+		int num)
+{
+	int		i, clock;
+	zbx_uint64_t	prev;
+
+	for (i = 0, clock = records[0].timestamp.sec; i < num; i++)
+	{
+		column_encode_uint(buf, (zbx_uint64_t)(records[i].timestamp.sec - clock));
+		clock = records[i].timestamp.sec;
+	}
+
+	for (i = 0; i < num; i++)
+		column_encode_uint(buf, (zbx_uint64_t)records[i].timestamp.ns);
+
+	for (i = 0, prev = 0; i < num; i++)
+	{
+		zbx_uint64_t	value, delta;
+
+		if (ITEM_VALUE_TYPE_FLOAT == value_type)
+		{
+			value = column_dbl2bits(records[i].value.dbl);
+			column_encode_xor(buf, value ^ prev);
+		}
+		else
+		{
+			value = records[i].value.ui64;
+			delta = value - prev;
+			column_encode_uint(buf, (delta << 1) ^ (0 - (delta >> 63)));
+		}
+
+		prev = value;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: column_decode_block                                              *
+ *                                                                            *
+ * Purpose: decodes item values from column block                             *
+ *                                                                            *
+ * Parameters: value_type - [IN] the value type                               *
+ *             data       - [IN] the block data                               *
+ *             item       - [IN] the item table entry of the block            *
+ *             start      - [IN] the period start timestamp                   *
+ *             end        - [IN] the period end timestamp                     *
+ *             values     - [OUT] the values from ]<start>,<end>] interval    *
+ *                                                                            *
+ * Return value: SUCCEED - the block was decoded successfully                 *
+ *               FAIL    - the block is corrupted                             *
+ *                                                                            *
+ ******************************************************************************/
+static int	column_decode_block(unsigned char value_type, const unsigned char *data, const zbx_column_item_t *item,
+		int start, int end, zbx_vector_history_record_t *values)
+{
+	const unsigned char	*p = data, *pend = data + item->size;
+	int			i, num = (int)item->values_num, *clocks, *ns, ret = FAIL;
+	zbx_uint64_t		value, prev = 0;
+
+	clocks = (int *)zbx_malloc(NULL, sizeof(int) * (size_t)num * 2);
+	ns = clocks + num;
+
+	for (i = 0; i < num; i++)
+	{
+		if (SUCCEED != column_decode_uint(&p, pend, &value))
+			goto out;
+
+		clocks[i] = (0 == i ? item->clock_min : clocks[i - 1]) + (int)value;
+	}
+
+	for (i = 0; i < num; i++)
+	{
+		if (SUCCEED != column_decode_uint(&p, pend, &value))
+			goto out;
+
+		ns[i] = (int)value;
+	}
+
+	for (i = 0; i < num; i++)
+	{
+		zbx_history_record_t	record;
+
+		if (ITEM_VALUE_TYPE_FLOAT == value_type)
+		{
+			if (SUCCEED != column_decode_xor(&p, pend, &value))
+				goto out;
+
+			prev ^= value;
+			record.value.dbl = column_bits2dbl(prev);
+		}
+		else
+		{
+			if (SUCCEED != column_decode_uint(&p, pend, &value))
+				goto out;
+
+			prev += (value >> 1) ^ (0 - (value & 1));
+			record.value.ui64 = prev;
+		}
+
+		if (clocks[i] <= start || clocks[i] > end)
+			continue;
+
+		record.timestamp.sec = clocks[i];
+		record.timestamp.ns = ns[i];
+		zbx_vector_history_record_append_ptr(values, &record);
+	}
+
+	ret = SUCCEED;
+out:
+	zbx_free(clocks);
+
+	return ret;
+}
+
+/******************************************************************************************************************
+ *                                                                                                                *
+ * partition file support                                                                                         *
+ *                                                                                                                *
+ ******************************************************************************************************************/
+
+static int	column_has_ext(const char *name, const char *ext)
+{
+	size_t	len = strlen(name), ext_len = strlen(ext);
+
+	return len > ext_len && 0 == strcmp(name + len - ext_len, ext) ? SUCCEED : FAIL;
+}
+
+static int	column_is_merging_file(const char *name)
+{
+	return column_has_ext(name, ZBX_COLUMN_MERGE_EXT);
+}
+
+static int	column_is_data_file(const char *name)
+{
+	if (SUCCEED == column_has_ext(name, ZBX_COLUMN_FILE_EXT))
+		return SUCCEED;
+
+	return column_is_merging_file(name);
+}
+
+static int	column_pread(int fd, void *buf, size_t size, zbx_uint64_t offset)
+{
+	return (ssize_t)size == pread(fd, buf, size, (off_t)offset) ? SUCCEED : FAIL;
+}
+
+static int	column_write(int fd, const void *buf, size_t size)
+{
+	const unsigned char	*p = (const unsigned char *)buf;
+	ssize_t			n;
+
+	while (0 != size)
+	{
+		if (-1 == (n = write(fd, p, size)))
+		{
+			if (EINTR == errno)
+				continue;
+
+			return FAIL;
+		}
+
+		p += n;
+		size -= (size_t)n;
+	}
+
+	return SUCCEED;
+}
+
+static int	column_lock(int fd, short type)
+{
+	struct flock	fl;
+
+	fl.l_type = type;
+	fl.l_whence = SEEK_SET;
+	fl.l_start = 0;
+	fl.l_len = 0;
+	fl.l_pid = getpid();
+
+	return -1 != fcntl(fd, F_UNLCK == type ? F_SETLK : F_SETLKW, &fl) ? SUCCEED : FAIL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: column_read_chunk                                                *
+ *                                                                            *
+ * Purpose: reads and validates chunk header                                  *
+ *                                                                            *
+ * Parameters: fd     - [IN] the file descriptor                              *
+ *             offset - [IN] the chunk offset                                 *
+ *             size   - [IN] the file size                                    *
+ *             chunk  - [OUT] the chunk header                                *
+ *                                                                            *
+ * Return value: SUCCEED - a valid chunk was read                             *
+ *               FAIL    - end of file, chunk being written or corrupted      *
+ *                                                                            *
+ ******************************************************************************/
+static int	column_read_chunk(int fd, zbx_uint64_t offset, zbx_uint64_t size, zbx_column_chunk_t *chunk)
+{
+	if (offset + sizeof(zbx_column_chunk_t) > size ||
+			SUCCEED != column_pread(fd, chunk, sizeof(zbx_column_chunk_t), offset))
+	{
+		return FAIL;
+	}
+
+	if (ZBX_COLUMN_CHUNK_MAGIC != chunk->magic || chunk->size > size - offset ||
+			chunk->table_offset + (zbx_uint64_t)chunk->items_num * sizeof(zbx_column_item_t) != chunk->size)
+	{
+		return FAIL;
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: column_next_chunk                                                *
+ *                                                                            *
+ * Purpose: finds the next valid chunk starting at the specified offset       *
+ *                                                                            *
+ * Parameters: fd     - [IN] the file descriptor                              *
+ *             offset - [IN/OUT] the expected chunk offset, the offset of the *
+ *                               found chunk on return                        *
+ *             size   - [IN] the file size                                    *
+ *             chunk  - [OUT] the chunk header                                *
+ *                                                                            *
+ * Return value: SUCCEED - a valid chunk was found                            *
+ *               FAIL    - there are no more valid chunks                     *
+ *                                                                            *
+ * Comments: A chunk torn by a crash or failed write is followed by chunks    *
+ *           appended later, so the file is searched for the next chunk       *
+ *           header instead of dropping all values after the torn chunk.      *
+ *                                                                            *
+ ******************************************************************************/
+static int	column_next_chunk(int fd, zbx_uint64_t *offset, zbx_uint64_t size, zbx_column_chunk_t *chunk)
+{
+	unsigned char	buf[ZBX_KIBIBYTE];
+	zbx_uint32_t	magic = ZBX_COLUMN_CHUNK_MAGIC;
+	zbx_uint64_t	pos;
+	size_t		i, n;
+
+	if (SUCCEED == column_read_chunk(fd, *offset, size, chunk))
+		return SUCCEED;
+
+	for (pos = *offset + 1; pos + sizeof(zbx_column_chunk_t) <= size; pos += n - sizeof(magic) + 1)
+	{
+		n = (size_t)MIN(sizeof(buf), size - pos);
+
+		if (SUCCEED != column_pread(fd, buf, n, pos))
+			return FAIL;
+
+		for (i = 0; i + sizeof(magic) <= n; i++)
+		{
+			if (0 != memcmp(buf + i, &magic, sizeof(magic)))
+				continue;
+
+			if (SUCCEED == column_read_chunk(fd, pos + i, size, chunk))
+			{
+				zabbix_log(LOG_LEVEL_DEBUG, "skipped " ZBX_FS_UI64 " bytes of torn history chunk at offset "
+						ZBX_FS_UI64, pos + i - *offset, *offset);
+				*offset = pos + i;
+				return SUCCEED;
+			}
+		}
+	}
+
+	return FAIL;
+}
+
+static int	column_item_compare_func(const void *d1, const void *d2)
+{
+	const zbx_column_item_t	*i1 = (const zbx_column_item_t *)d1;
+	const zbx_column_item_t	*i2 = (const zbx_column_item_t *)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(i1->itemid, i2->itemid);
+
+	return 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: column_find_item                                                 *
+ *                                                                            *
+ * Purpose: finds item in chunk item table                                    *
+ *                                                                            *
+ * Parameters: fd     - [IN] the file descriptor                              *
+ *             offset - [IN] the chunk offset                                 *
+ *             chunk  - [IN] the chunk header                                 *
+ *             itemid - [IN] the item to find                                 *
+ *             item   - [OUT] the item table entry                            *
+ *                                                                            *
+ * Return value: SUCCEED - the item was found                                 *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	column_find_item(int fd, zbx_uint64_t offset, const zbx_column_chunk_t *chunk, zbx_uint64_t itemid,
+		zbx_column_item_t *item)
+{
+	zbx_uint64_t	table = offset + chunk->table_offset;
+	int		lo = 0, hi = (int)chunk->items_num - 1, ret = FAIL;
+
+	if (ZBX_COLUMN_TABLE_READ_MAX >= chunk->items_num)
+	{
+		zbx_column_item_t	*items, *found, local;
+		size_t			size = sizeof(zbx_column_item_t) * chunk->items_num;
+
+		items = (zbx_column_item_t *)zbx_malloc(NULL, size);
+		local.itemid = itemid;
+
+		if (SUCCEED == column_pread(fd, items, size, table) && NULL != (found = (zbx_column_item_t *)bsearch(
+				&local, items, chunk->items_num, sizeof(zbx_column_item_t), column_item_compare_func)))
+		{
+			*item = *found;
+			ret = SUCCEED;
+		}
+
+		zbx_free(items);
+
+		return ret;
+	}
+
+	while (lo <= hi)
+	{
+		int	mid = lo + (hi - lo) / 2;
+
+		if (SUCCEED != column_pread(fd, item, sizeof(zbx_column_item_t),
+				table + (zbx_uint64_t)mid * sizeof(zbx_column_item_t)))
+		{
+			break;
+		}
+
+		if (item->itemid == itemid)
+			return SUCCEED;
+
+		if (item->itemid < itemid)
+			lo = mid + 1;
+		else
+			hi = mid - 1;
+	}
+
+	return FAIL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: column_read_file                                                 *
+ *                                                                            *
+ * Purpose: reads item values from partition file                             *
+ *                                                                            *
+ * Parameters: value_type - [IN] the value type                               *
+ *             filename   - [IN] the partition file                           *
+ *             itemid     - [IN] the item                                     *
+ *             start      - [IN] the period start timestamp                   *
+ *             end        - [IN] the period end timestamp                     *
+ *             values     - [OUT] the values from ]<start>,<end>] interval    *
+ *                                                                            *
+ * Return value: SUCCEED - the file was read                                  *
+ *               FAIL    - the file was removed by compaction                 *
+ *                                                                            *
+ * Comments: Invalid chunks are skipped. A chunk at the end of file can be    *
+ *           being written by other process, other chunks were torn by a      *
+ *           crash or failed write.                                           *
+ *                                                                            *
+ ******************************************************************************/
+static int	column_read_file(unsigned char value_type, const char *filename, zbx_uint64_t itemid, int start,
+		int end, zbx_vector_history_record_t *values)
+{
+	int			fd;
+	zbx_stat_t		st;
+	zbx_uint64_t		offset;
+	zbx_column_chunk_t	chunk;
+	zbx_column_item_t	item;
+	unsigned char		*block = NULL;
+	size_t			block_alloc = 0;
+
+	if (-1 == (fd = open(filename, O_RDONLY)))
+	{
+		if (ENOENT == errno)
+			return FAIL;
+
+		zabbix_log(LOG_LEVEL_WARNING, "cannot open history file \"%s\": %s", filename, zbx_strerror(errno));
+		return SUCCEED;
+	}
+
+	if (0 != zbx_fstat(fd, &st))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot stat history file \"%s\": %s", filename, zbx_strerror(errno));
+		goto out;
+	}
+
+	for (offset = 0; SUCCEED == column_next_chunk(fd, &offset, (zbx_uint64_t)st.st_size, &chunk);
+			offset += chunk.size)
+	{
+		if (SUCCEED != column_find_item(fd, offset, &chunk, itemid, &item))
+			continue;
+
+		if (item.clock_max <= start || item.clock_min > end)
+			continue;
+
+		if (item.offset + item.size > chunk.table_offset)
+			continue;
+
+		if (block_alloc < item.size)
+		{
+			block_alloc = item.size;
+			block = (unsigned char *)zbx_realloc(block, block_alloc);
+		}
+
+		if (SUCCEED != column_pread(fd, block, item.size, offset + item.offset) ||
+				SUCCEED != column_decode_block(value_type, block, &item, start, end, values))
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "corrupted history file \"%s\" at offset " ZBX_FS_UI64,
+					filename, offset);
+			continue;
+		}
+	}
+out:
+	zbx_free(block);
+	close(fd);
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: column_get_files                                                 *
+ *                                                                            *
+ * Purpose: gets data files of a partition                                    *
+ *                                                                            *
+ * Parameters: dir   - [IN] the partition directory                           *
+ *             files - [OUT] the file names                                   *
+ *                                                                            *
+ ******************************************************************************/
+static void	column_get_files(const char *dir, zbx_vector_str_t *files)
+{
+	DIR		*dp;
+	struct dirent	*entry;
+
+	if (NULL == (dp = opendir(dir)))
+		return;
+
+	while (NULL != (entry = readdir(dp)))
+	{
+		if (SUCCEED == column_is_data_file(entry->d_name))
+			zbx_vector_str_append(files, zbx_strdup(NULL, entry->d_name));
+	}
+
+	closedir(dp);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: column_skip_merged                                               *
+ *                                                                            *
+ * Purpose: removes already merged files from partition file list             *
+ *                                                                            *
+ * Parameters: dir    - [IN] the partition directory                          *
+ *             files  - [IN/OUT] the file names                               *
+ *             remove - [IN] 1 - remove the merged files from disk            *
+ *                                                                            *
+ * Comments: Compaction publishes the compacted file only while there is no   *
+ *           other compacted file, so merging files found together with the   *
+ *           compacted file are sources of a finished (possibly interrupted)  *
+ *           compaction and their values are already in the compacted file.   *
+ *                                                                            *
+ ******************************************************************************/
+static void	column_skip_merged(const char *dir, zbx_vector_str_t *files, int remove)
+{
+	char	*filename = NULL;
+	size_t	filename_alloc = 0, filename_offset;
+	int	i;
+
+	if (FAIL == zbx_vector_str_search(files, ZBX_COLUMN_COMPACT_FILE, ZBX_DEFAULT_STR_COMPARE_FUNC))
+		return;
+
+	for (i = 0; i < files->values_num; i++)
+	{
+		if (SUCCEED != column_is_merging_file(files->values[i]))
+			continue;
+
+		if (1 == remove)
+		{
+			filename_offset = 0;
+			zbx_snprintf_alloc(&filename, &filename_alloc, &filename_offset, "%s/%s", dir, files->values[i]);
+			unlink(filename);
+		}
+
+		zbx_free(files->values[i]);
+		zbx_vector_str_remove_noorder(files, i--);
+	}
+
+	zbx_free(filename);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: column_read_partition                                            *
+ *                                                                            *
+ * Purpose: reads item values from all files of a partition                   *
+ *                                                                            *
+ ******************************************************************************/
+static void	column_read_partition(const zbx_column_data_t *data, unsigned char value_type, int partition,
+		zbx_uint64_t itemid, int start, int end, zbx_vector_history_record_t *values)
+{
+	char			*dir, *filename = NULL;
+	size_t			filename_alloc = 0, filename_offset;
+	int			i, pos = values->values_num, retries = 3;
+	zbx_vector_str_t	files;
+
+	dir = zbx_dsprintf(NULL, "%s/%d", data->path, partition);
+	zbx_vector_str_create(&files);
+retry:
+	column_get_files(dir, &files);
+	column_skip_merged(dir, &files, 0);
+
+	for (i = 0; i < files.values_num; i++)
+	{
+		filename_offset = 0;
+		zbx_snprintf_alloc(&filename, &filename_alloc, &filename_offset, "%s/%s", dir, files.values[i]);
+
+		/* the file was merged into a compacted file while reading, read the partition again */
+		if (SUCCEED != column_read_file(value_type, filename, itemid, start, end, values) && 0 < --retries)
+		{
+			values->values_num = pos;
+			zbx_vector_str_clear_ext(&files, zbx_str_free);
+			goto retry;
+		}
+	}
+
+	zbx_vector_str_clear_ext(&files, zbx_str_free);
+	zbx_vector_str_destroy(&files);
+	zbx_free(filename);
+	zbx_free(dir);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: column_get_partitions                                            *
+ *                                                                            *
+ * Purpose: gets existing partitions sorted by their start time               *
+ *                                                                            *
+ ******************************************************************************/
+static void	column_get_partitions(const zbx_column_data_t *data, zbx_vector_uint64_t *partitions)
+{
+	DIR		*dp;
+	struct dirent	*entry;
+	zbx_uint64_t	partition;
+
+	if (NULL == (dp = opendir(data->path)))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot open history directory \"%s\": %s", data->path,
+				zbx_strerror(errno));
+		return;
+	}
+
+	while (NULL != (entry = readdir(dp)))
+	{
+		if (SUCCEED == is_uint64(entry->d_name, &partition))
+			zbx_vector_uint64_append(partitions, partition);
+	}
+
+	closedir(dp);
+
+	zbx_vector_uint64_sort(partitions, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: column_remove_dir                                                *
+ *                                                                            *
+ * Purpose: removes partition directory with all its files                    *
+ *                                                                            *
+ ******************************************************************************/
+static void	column_remove_dir(const char *dir)
+{
+	DIR		*dp;
+	struct dirent	*entry;
+	char		*filename = NULL;
+	size_t		filename_alloc = 0, filename_offset;
+
+	if (NULL == (dp = opendir(dir)))
+		return;
+
+	while (NULL != (entry = readdir(dp)))
+	{
+		if (0 == strcmp(entry->d_name, ".") || 0 == strcmp(entry->d_name, ".."))
+			continue;
+
+		filename_offset = 0;
+		zbx_snprintf_alloc(&filename, &filename_alloc, &filename_offset, "%s/%s", dir, entry->d_name);
+		unlink(filename);
+	}
+
+	closedir(dp);
+	zbx_free(filename);
+
+	if (0 != rmdir(dir) && ENOENT != errno)
+		zabbix_log(LOG_LEVEL_WARNING, "cannot remove history directory \"%s\": %s", dir, zbx_strerror(errno));
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: column_write_item                                                *
+ *                                                                            *
+ * Purpose: encodes item block and adds it to the item table                  *
+ *                                                                            *
+ * Parameters: value_type - [IN] the value type                               *
+ *             itemid     - [IN] the item                                     *
+ *             records    - [IN] the item values sorted by timestamps         *
+ *             buf        - [IN/OUT] the chunk data                           *
+ *             base       - [IN] the chunk offset of the buffer start         *
+ *             table      - [IN/OUT] the item table                           *
+ *                                                                            *
+ ******************************************************************************/
+static void	column_write_item(unsigned char value_type, zbx_uint64_t itemid,
+		const zbx_vector_history_record_t *records, zbx_column_buf_t *buf, zbx_uint64_t base,
+		zbx_column_buf_t *table)
+{
+	zbx_column_item_t	item;
+	size_t			offset = buf->offset;
+
+	column_encode_block(buf, value_type, records->values, records->values_num);
+
+	item.itemid = itemid;
+	item.offset = base + offset;
+	item.size = (zbx_uint32_t)(buf->offset - offset);
+	item.values_num = (zbx_uint32_t)records->values_num;
+	item.clock_min = records->values[0].timestamp.sec;
+	item.clock_max = records->values[records->values_num - 1].timestamp.sec;
+
+	column_buf_append(table, &item, sizeof(item));
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: column_sort_records                                              *
+ *                                                                            *
+ * Purpose: sorts values by timestamps and removes duplicates                 *
+ *                                                                            *
+ * Comments: Duplicate values can be read from the same partition while it's  *
+ *           being compacted.                                                 *
+ *                                                                            *
+ ******************************************************************************/
+static void	column_sort_records(zbx_history_record_t *records, int *num, zbx_compare_func_t compare)
+{
+	int	i, j;
+
+	if (1 >= *num)
+		return;
+
+	qsort(records, (size_t)*num, sizeof(zbx_history_record_t), compare);
+
+	for (i = 0, j = 1; j < *num; j++)
+	{
+		if (0 != zbx_timespec_compare(&records[i].timestamp, &records[j].timestamp))
+			records[++i] = records[j];
+	}
+
+	*num = i + 1;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: column_open_locked                                               *
+ *                                                                            *
+ * Purpose: opens history file for appending and locks it for writing         *
+ *                                                                            *
+ * Parameters: filename - [IN] the history file                               *
+ *             st       - [OUT] the locked file status                        *
+ *                                                                            *
+ * Return value: the file descriptor or -1 on error                           *
+ *                                                                            *
+ * Comments: The lock prevents compaction from reading the file while the     *
+ *           chunk is being written. Compaction can rename, merge and remove  *
+ *           the file after it was opened and before the lock was acquired,   *
+ *           so the file is reopened until the locked file is the one having  *
+ *           the specified name.                                              *
+ *                                                                            *
+ ******************************************************************************/
+static int	column_open_locked(const char *filename, zbx_stat_t *st)
+{
+	zbx_stat_t	st_name;
+	int		fd;
+
+	while (-1 != (fd = open(filename, O_WRONLY | O_CREAT | O_APPEND, 0640)))
+	{
+		if (SUCCEED != column_lock(fd, F_WRLCK) || 0 != zbx_fstat(fd, st))
+		{
+			close(fd);
+			return -1;
+		}
+
+		if (0 != st->st_nlink && 0 == zbx_stat(filename, &st_name) && st->st_ino == st_name.st_ino &&
+				st->st_dev == st_name.st_dev)
+		{
+			break;
+		}
+
+		close(fd);
+	}
+
+	return fd;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: column_write_partition                                           *
+ *                                                                            *
+ * Purpose: appends values of a single partition as a new chunk               *
+ *                                                                            *
+ * Parameters: data       - [IN] the history storage data                     *
+ *             value_type - [IN] the value type                               *
+ *             values     - [IN] the values sorted by itemid and timestamps   *
+ *             num        - [IN] the number of values                         *
+ *                                                                            *
+ * Return value: SUCCEED - the values were written                            *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	column_write_partition(const zbx_column_data_t *data, unsigned char value_type,
+		const zbx_column_value_t *values, int num)
+{
+	char				*dir, *filename = NULL;
+	int				i, j, fd, ret = FAIL;
+	zbx_column_buf_t		buf = {0}, table = {0};
+	zbx_column_chunk_t		chunk;
+	zbx_vector_history_record_t	records;
+	zbx_stat_t			st;
+
+	dir = zbx_dsprintf(NULL, "%s/%d", data->path, values[0].record.timestamp.sec -
+			values[0].record.timestamp.sec % ZBX_COLUMN_PARTITION_PERIOD);
+
+	if (0 != mkdir(dir, 0750) && EEXIST != errno)
+	{
+		zabbix_log(LOG_LEVEL_ERR, "cannot create history directory \"%s\": %s", dir, zbx_strerror(errno));
+		goto out;
+	}
+
+	zbx_history_record_vector_create(&records);
+	column_buf_reserve(&buf, sizeof(chunk));
+	buf.offset = sizeof(chunk);
+
+	for (i = 0; i < num; i = j)
+	{
+		zbx_vector_history_record_clear(&records);
+
+		for (j = i; j < num && values[j].itemid == values[i].itemid; j++)
+			zbx_vector_history_record_append_ptr(&records, (zbx_history_record_t *)&values[j].record);
+
+		column_sort_records(records.values, &records.values_num,
+				(zbx_compare_func_t)zbx_history_record_compare_asc_func);
+		column_write_item(value_type, values[i].itemid, &records, &buf, 0, &table);
+	}
+
+	zbx_vector_history_record_destroy(&records);
+
+	chunk.magic = ZBX_COLUMN_CHUNK_MAGIC;
+	chunk.items_num = (zbx_uint32_t)(table.offset / sizeof(zbx_column_item_t));
+	chunk.table_offset = buf.offset;
+	chunk.size = buf.offset + table.offset;
+	memcpy(buf.data, &chunk, sizeof(chunk));
+	column_buf_append(&buf, table.data, table.offset);
+
+	filename = zbx_dsprintf(NULL, "%s/%d" ZBX_COLUMN_FILE_EXT, dir, (int)getpid());
+
+	if (-1 == (fd = column_open_locked(filename, &st)))
+	{
+		zabbix_log(LOG_LEVEL_ERR, "cannot open history file \"%s\": %s", filename, zbx_strerror(errno));
+		goto out;
+	}
+
+	if (SUCCEED != (ret = column_write(fd, buf.data, buf.offset)))
+	{
+		zabbix_log(LOG_LEVEL_ERR, "cannot write history file \"%s\": %s", filename, zbx_strerror(errno));
+
+		/* remove the partially written chunk so it is not followed by the next chunks */
+		if (0 != ftruncate(fd, st.st_size))
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "cannot truncate history file \"%s\": %s", filename,
+					zbx_strerror(errno));
+		}
+	}
+
+	close(fd);
+out:
+	zbx_free(filename);
+	zbx_free(table.data);
+	zbx_free(buf.data);
+	zbx_free(dir);
+
+	return ret;
+}
+
+static int	column_ref_compare_func(const void *d1, const void *d2)
+{
+	const zbx_column_ref_t	*r1 = *(const zbx_column_ref_t **)d1;
+	const zbx_column_ref_t	*r2 = *(const zbx_column_ref_t **)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(r1->item.itemid, r2->item.itemid);
+	ZBX_RETURN_IF_NOT_EQUAL(r1->file, r2->file);
+	ZBX_RETURN_IF_NOT_EQUAL(r1->item.offset, r2->item.offset);
+
+	return 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: column_get_refs                                                  *
+ *                                                                            *
+ * Purpose: gets item block references of all chunks in a file                *
+ *                                                                            *
+ ******************************************************************************/
+static void	column_get_refs(int fd, int file, zbx_vector_ptr_t *refs)
+{
+	zbx_stat_t		st;
+	zbx_uint64_t		offset;
+	zbx_column_chunk_t	chunk;
+	zbx_column_item_t	*items = NULL;
+	size_t			items_alloc = 0;
+	zbx_uint32_t		i;
+
+	if (0 != zbx_fstat(fd, &st))
+		return;
+
+	for (offset = 0; SUCCEED == column_next_chunk(fd, &offset, (zbx_uint64_t)st.st_size, &chunk);
+			offset += chunk.size)
+	{
+		if (items_alloc < chunk.items_num)
+		{
+			items_alloc = chunk.items_num;
+			items = (zbx_column_item_t *)zbx_realloc(items, sizeof(zbx_column_item_t) * items_alloc);
+		}
+
+		if (SUCCEED != column_pread(fd, items, sizeof(zbx_column_item_t) * chunk.items_num,
+				offset + chunk.table_offset))
+		{
+			break;
+		}
+
+		for (i = 0; i < chunk.items_num; i++)
+		{
+			zbx_column_ref_t	*ref;
+
+			ref = (zbx_column_ref_t *)zbx_malloc(NULL, sizeof(zbx_column_ref_t));
+			ref->item = items[i];
+			ref->item.offset += offset;
+			ref->file = file;
+			zbx_vector_ptr_append(refs, ref);
+		}
+	}
+
+	zbx_free(items);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: column_merge_files                                               *
+ *                                                                            *
+ * Purpose: merges partition files into a single chunk                        *
+ *                                                                            *
+ * Parameters: value_type - [IN] the value type                               *
+ *             fds        - [IN] the source file descriptors                  *
+ *             files_num  - [IN] the number of source files                   *
+ *             fd_out     - [IN] the output file descriptor                   *
+ *                                                                            *
+ * Return value: SUCCEED - the files were merged                              *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: Item blocks are merged one item at a time to limit the memory    *
+ *           used by compaction.                                              *
+ *                                                                            *
+ ******************************************************************************/
+static int	column_merge_files(unsigned char value_type, const int *fds, int files_num, int fd_out)
+{
+	zbx_vector_ptr_t		refs;
+	zbx_vector_history_record_t	records;
+	zbx_column_buf_t		buf = {0}, table = {0}, block = {0};
+	zbx_column_chunk_t		chunk;
+	zbx_uint64_t			offset = sizeof(chunk);
+	int				i, j, ret = FAIL;
+
+	zbx_vector_ptr_create(&refs);
+	zbx_history_record_vector_create(&records);
+
+	for (i = 0; i < files_num; i++)
+		column_get_refs(fds[i], i, &refs);
+
+	zbx_vector_ptr_sort(&refs, column_ref_compare_func);
+
+	memset(&chunk, 0, sizeof(chunk));
+
+	if (SUCCEED != column_write(fd_out, &chunk, sizeof(chunk)))
+		goto out;
+
+	for (i = 0; i < refs.values_num; i = j)
+	{
+		const zbx_column_ref_t	*first = (const zbx_column_ref_t *)refs.values[i];
+
+		zbx_vector_history_record_clear(&records);
+
+		for (j = i; j < refs.values_num; j++)
+		{
+			const zbx_column_ref_t	*ref = (const zbx_column_ref_t *)refs.values[j];
+
+			if (ref->item.itemid != first->item.itemid)
+				break;
+
+			block.offset = 0;
+			column_buf_reserve(&block, ref->item.size);
+
+			if (SUCCEED != column_pread(fds[ref->file], block.data, ref->item.size, ref->item.offset) ||
+					SUCCEED != column_decode_block(value_type, block.data, &ref->item, 0,
+					ZBX_JAN_2038, &records))
+			{
+				goto out;
+			}
+		}
+
+		if (0 == records.values_num)
+			continue;
+
+		column_sort_records(records.values, &records.values_num,
+				(zbx_compare_func_t)zbx_history_record_compare_asc_func);
+
+		buf.offset = 0;
+		column_write_item(value_type, first->item.itemid, &records, &buf, offset, &table);
+
+		if (SUCCEED != column_write(fd_out, buf.data, buf.offset))
+			goto out;
+
+		offset += buf.offset;
+	}
+
+	if (SUCCEED != column_write(fd_out, table.data, table.offset))
+		goto out;
+
+	chunk.magic = ZBX_COLUMN_CHUNK_MAGIC;
+	chunk.items_num = (zbx_uint32_t)(table.offset / sizeof(zbx_column_item_t));
+	chunk.table_offset = offset;
+	chunk.size = offset + table.offset;
+
+	if (sizeof(chunk) != pwrite(fd_out, &chunk, sizeof(chunk), 0))
+		goto out;
+
+	ret = SUCCEED;
+out:
+	zbx_free(block.data);
+	zbx_free(table.data);
+	zbx_free(buf.data);
+	zbx_vector_history_record_destroy(&records);
+	zbx_vector_ptr_clear_ext(&refs, zbx_ptr_free);
+	zbx_vector_ptr_destroy(&refs);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: column_compact_partition                                         *
+ *                                                                            *
+ * Purpose: compacts all files of a closed partition into a single chunk      *
+ *                                                                            *
+ * Parameters: value_type - [IN] the value type                               *
+ *             dir        - [IN] the partition directory                      *
+ *                                                                            *
+ * Comments: The source files are renamed before merging, so late values are  *
+ *           written to new files and compacted later. The renamed files stay *
+ *           readable until the compacted file is published.                  *
+ *                                                                            *
+ *           The previous compacted file is renamed first and compaction is   *
+ *           skipped if that fails, so the compacted file exists together     *
+ *           with merging files only after all their values were merged into  *
+ *           it. Readers skip such merging files and they are removed here if *
+ *           the compaction was interrupted before removing them.             *
+ *                                                                            *
+ ******************************************************************************/
+static void	column_compact_partition(unsigned char value_type, const char *dir)
+{
+	zbx_vector_str_t	files;
+	char			*lock, *tmp = NULL, *filename = NULL;
+	int			i, fd_lock, fd_out, *fds = NULL, files_num = 0, compact;
+	zbx_stat_t		st;
+
+	lock = zbx_dsprintf(NULL, "%s/" ZBX_COLUMN_COMPACT_LOCK, dir);
+
+	if (-1 == (fd_lock = open(lock, O_WRONLY | O_CREAT | O_EXCL, 0640)))
+	{
+		/* remove lock left by a crashed process, the partition will be compacted next time */
+		if (EEXIST == errno && 0 == zbx_stat(lock, &st) && st.st_mtime + SEC_PER_HOUR < time(NULL))
+			unlink(lock);
+
+		zbx_free(lock);
+		return;
+	}
+
+	zbx_vector_str_create(&files);
+	column_get_files(dir, &files);
+	column_skip_merged(dir, &files, 1);
+
+	if (FAIL != (compact = zbx_vector_str_search(&files, ZBX_COLUMN_COMPACT_FILE, ZBX_DEFAULT_STR_COMPARE_FUNC)))
+	{
+		if (1 == files.values_num)
+			goto unlock;
+
+		/* rename the compacted file first */
+		filename = files.values[compact];
+		files.values[compact] = files.values[0];
+		files.values[0] = filename;
+		filename = NULL;
+	}
+
+	if (0 == files.values_num)
+		goto unlock;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() dir:%s files:%d", __func__, dir, files.values_num);
+
+	tmp = zbx_dsprintf(NULL, "%s/" ZBX_COLUMN_COMPACT_TMP, dir);
+	fds = (int *)zbx_malloc(NULL, sizeof(int) * (size_t)files.values_num);
+
+	for (i = 0; i < files.values_num; i++)
+	{
+		char	*merging;
+
+		filename = zbx_dsprintf(filename, "%s/%s", dir, files.values[i]);
+
+		if (SUCCEED != column_is_merging_file(files.values[i]))
+		{
+			merging = zbx_dsprintf(NULL, "%s" ZBX_COLUMN_MERGE_EXT, filename);
+
+			/* merging file of an interrupted compaction by a process with the same pid must */
+			/* not be overwritten, the file will be compacted next time                      */
+			if (0 == zbx_stat(merging, &st) || 0 != rename(filename, merging))
+			{
+				zbx_free(merging);
+
+				if (FAIL != compact && 0 == i)
+				{
+					zabbix_log(LOG_LEVEL_WARNING, "cannot rename history file \"%s\": %s", filename,
+							zbx_strerror(errno));
+					goto close;
+				}
+
+				continue;
+			}
+
+			zbx_free(filename);
+			filename = merging;
+		}
+
+		if (-1 == (fds[files_num] = open(filename, O_RDWR)))
+			continue;
+
+		/* wait for the writers that opened the file before it was renamed */
+		column_lock(fds[files_num], F_WRLCK);
+
+		zbx_free(files.values[files_num]);
+		files.values[files_num++] = filename;
+		filename = NULL;
+	}
+
+	if (-1 == (fd_out = open(tmp, O_WRONLY | O_CREAT | O_TRUNC, 0640)))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot create history file \"%s\": %s", tmp, zbx_strerror(errno));
+	}
+	else
+	{
+		/* the compacted file must be complete on disk before the source files can be removed */
+		if (SUCCEED == column_merge_files(value_type, fds, files_num, fd_out) && 0 == fsync(fd_out))
+		{
+			filename = zbx_dsprintf(filename, "%s/" ZBX_COLUMN_COMPACT_FILE, dir);
+
+			if (0 == rename(tmp, filename))
+			{
+				for (i = 0; i < files_num; i++)
+					unlink(files.values[i]);
+			}
+		}
+		else
+			zabbix_log(LOG_LEVEL_WARNING, "cannot compact history partition \"%s\"", dir);
+
+		close(fd_out);
+		unlink(tmp);
+	}
+close:
+	for (i = 0; i < files_num; i++)
+		close(fds[i]);
+
+	zbx_free(filename);
+	zbx_free(fds);
+	zbx_free(tmp);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
+unlock:
+	close(fd_lock);
+	unlink(lock);
+	zbx_free(lock);
+
+	zbx_vector_str_clear_ext(&files, zbx_str_free);
+	zbx_vector_str_destroy(&files);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: column_maintain_partitions                                       *
+ *                                                                            *
+ * Purpose: drops expired partitions and compacts closed partitions           *
+ *                                                                            *
+ ******************************************************************************/
+static void	column_maintain_partitions(const zbx_column_data_t *data, unsigned char value_type)
+{
+	zbx_vector_uint64_t	partitions;
+	int			i, now;
+	char			*dir = NULL;
+
+	zbx_vector_uint64_create(&partitions);
+	column_get_partitions(data, &partitions);
+
+	now = (int)time(NULL);
+
+	for (i = 0; i < partitions.values_num; i++)
+	{
+		int	end = (int)partitions.values[i] + ZBX_COLUMN_PARTITION_PERIOD;
+
+		dir = zbx_dsprintf(dir, "%s/" ZBX_FS_UI64, data->path, partitions.values[i]);
+
+		if (end <= now - CONFIG_HISTORY_LOCAL_RETENTION * SEC_PER_DAY)
+		{
+			zabbix_log(LOG_LEVEL_DEBUG, "dropping history partition \"%s\"", dir);
+			column_remove_dir(dir);
+		}
+		else if (end + ZBX_COLUMN_COMPACT_DELAY <= now)
+			column_compact_partition(value_type, dir);
+	}
+
+	zbx_free(dir);
+	zbx_vector_uint64_destroy(&partitions);
+}
+
+/******************************************************************************************************************
+ *                                                                                                                *
+ * history interface support                                                                                      *
+ *                                                                                                                *
+ ******************************************************************************************************************/
+
+/************************************************************************************
+ *                                                                                  *
+ * Function: column_destroy                                                         *
+ *                                                                                  *
+ * Purpose: destroys history storage interface                                      *
+ *                                                                                  *
+ * Parameters:  hist - [IN] the history storage interface                           *
+ *                                                                                  *
+ ************************************************************************************/
+static void	column_destroy(zbx_history_iface_t *hist)
+{
+	zbx_column_data_t	*data = (zbx_column_data_t *)hist->data;
+
+	zbx_free(data->values);
+	zbx_free(data->path);
+	zbx_free(data);
+}
+
+/************************************************************************************
+ *                                                                                  *
+ * Function: column_get_values                                                      *
+ *                                                                                  *
+ * Purpose: gets item history data from history storage                             *
+ *                                                                                  *
+ * Parameters:  hist    - [IN] the history storage interface                        *
+ *              itemid  - [IN] the itemid                                           *
+ *              start   - [IN] the period start timestamp                           *
+ *              count   - [IN] the number of values to read                         *
+ *              end     - [IN] the period end timestamp                             *
+ *              values  - [OUT] the item history data values                        *
+ *                                                                                  *
+ * Return value: SUCCEED - the history data were read successfully                  *
+ *               FAIL - otherwise                                                   *
+ *                                                                                  *
+ * Comments: This function reads <count> values from ]<start>,<end>] interval or    *
+ *           all values from the specified interval if count is zero. Like other    *
+ *           backends it returns all values of the oldest returned second.          *
+ *                                                                                  *
+ ************************************************************************************/
+static int	column_get_values(zbx_history_iface_t *hist, zbx_uint64_t itemid, int start, int count, int end,
+		zbx_vector_history_record_t *values)
+{
+	zbx_column_data_t	*data = (zbx_column_data_t *)hist->data;
+	zbx_vector_uint64_t	partitions;
+	int			i, pos = values->values_num, num;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() itemid:" ZBX_FS_UI64 " start:%d count:%d end:%d", __func__, itemid,
+			start, count, end);
+
+	zbx_vector_uint64_create(&partitions);
+	column_get_partitions(data, &partitions);
+
+	/* partitions are read starting with the newest, so reading can stop as soon */
+	/* as the requested number of values has been read                            */
+	for (i = partitions.values_num - 1; 0 <= i; i--)
+	{
+		int	partition = (int)partitions.values[i];
+
+		if (partition > end)
+			continue;
+
+		if (partition + ZBX_COLUMN_PARTITION_PERIOD - 1 <= start)
+			break;
+
+		column_read_partition(data, hist->value_type, partition, itemid, start, end, values);
+
+		if (0 != count && count <= values->values_num - pos)
+			break;
+	}
+
+	zbx_vector_uint64_destroy(&partitions);
+
+	num = values->values_num - pos;
+	column_sort_records(values->values + pos, &num, (zbx_compare_func_t)zbx_history_record_compare_desc_func);
+
+	/* keep the remaining values of the oldest returned second */
+	if (0 != count && count < num)
+	{
+		int	clock = values->values[pos + count - 1].timestamp.sec, total = num;
+
+		num = count;
+
+		while (num < total && values->values[pos + num].timestamp.sec == clock)
+			num++;
+	}
+
+	values->values_num = pos + num;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s() values:%d", __func__, num);
+
+	return SUCCEED;
+}
+
+/************************************************************************************
+ *                                                                                  *
+ * Function: column_get_values_multi                                                *
+ *                                                                                  *
+ * Purpose: gets history data of multiple items from history storage                *
+ *                                                                                  *
+ * Parameters:  hist     - [IN] the history storage interface                       *
+ *              requests - [IN/OUT] the read requests                               *
+ *                                                                                  *
+ * Return value: SUCCEED - the history data were read successfully                  *
+ *               FAIL - otherwise                                                   *
+ *                                                                                  *
+ ************************************************************************************/
+static int	column_get_values_multi(zbx_history_iface_t *hist, zbx_vector_ptr_t *requests)
+{
+	int	i;
+
+	for (i = 0; i < requests->values_num; i++)
+	{
+		zbx_history_request_t	*request = (zbx_history_request_t *)requests->values[i];
+
+		column_get_values(hist, request->itemid, request->start, 0, request->end, &request->values);
+	}
+
+	return SUCCEED;
+}
+
+/************************************************************************************
+ *                                                                                  *
+ * Function: column_add_values                                                      *
+ *                                                                                  *
+ * Purpose: adds history data to be written by flush                                *
+ *                                                                                  *
+ * Parameters:  hist    - [IN] the history storage interface                        *
+ *              history - [IN] the history data vector (may have mixed value types) *
+ *                                                                                  *
+ * Return value: The number of values added                                         *
+ *                                                                                  *
+ ************************************************************************************/
+static int	column_add_values(zbx_history_iface_t *hist, const zbx_vector_ptr_t *history)
+{
+	zbx_column_data_t	*data = (zbx_column_data_t *)hist->data;
+	int			i, num = 0;
+
+	for (i = 0; i < history->values_num; i++)
+	{
+		const ZBX_DC_HISTORY	*h = (const ZBX_DC_HISTORY *)history->values[i];
+		zbx_column_value_t	*value;
+
+		if (hist->value_type != h->value_type)
+			continue;
+
+		if (data->values_num == data->values_alloc)
+		{
+			data->values_alloc = (0 == data->values_alloc ? 64 : data->values_alloc * 2);
+			data->values = (zbx_column_value_t *)zbx_realloc(data->values,
+					sizeof(zbx_column_value_t) * (size_t)data->values_alloc);
+		}
+
+		value = &data->values[data->values_num++];
+		value->itemid = h->itemid;
+		value->record.timestamp = h->ts;
+		value->record.value = h->value;
+		num++;
+	}
+
+	return num;
+}
+
+static int	column_value_compare_func(const void *d1, const void *d2)
+{
+	const zbx_column_value_t	*v1 = (const zbx_column_value_t *)d1;
+	const zbx_column_value_t	*v2 = (const zbx_column_value_t *)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(v1->record.timestamp.sec / ZBX_COLUMN_PARTITION_PERIOD,
+			v2->record.timestamp.sec / ZBX_COLUMN_PARTITION_PERIOD);
+	ZBX_RETURN_IF_NOT_EQUAL(v1->itemid, v2->itemid);
+
+	return zbx_timespec_compare(&v1->record.timestamp, &v2->record.timestamp);
+}
+
+/************************************************************************************
+ *                                                                                  *
+ * Function: column_flush                                                           *
+ *                                                                                  *
+ * Purpose: writes the added history data to partition files                       *
+ *                                                                                  *
+ * Parameters:  hist    - [IN] the history storage interface                        *
+ *                                                                                  *
+ * Return value: SUCCEED - the history data were written successfully               *
+ *               FAIL - otherwise                                                   *
+ *                                                                                  *
+ ************************************************************************************/
+static int	column_flush(zbx_history_iface_t *hist)
+{
+	zbx_column_data_t	*data = (zbx_column_data_t *)hist->data;
+	int			i, j, ret = SUCCEED;
+
+	if (0 == data->values_num)
+		return SUCCEED;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() values:%d", __func__, data->values_num);
+
+	qsort(data->values, (size_t)data->values_num, sizeof(zbx_column_value_t), column_value_compare_func);
+
+	for (i = 0; i < data->values_num; i = j)
+	{
+		int	partition = data->values[i].record.timestamp.sec / ZBX_COLUMN_PARTITION_PERIOD;
+
+		j = i + 1;
+
+		while (j < data->values_num &&
+				partition == data->values[j].record.timestamp.sec / ZBX_COLUMN_PARTITION_PERIOD)
+		{
+			j++;
+		}
+
+		if (SUCCEED != column_write_partition(data, hist->value_type, data->values + i, j - i))
+			ret = FAIL;
+	}
+
+	data->values_num = 0;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
+
+	return ret;
+}
+
+/************************************************************************************
+ *                                                                                  *
+ * Function: column_housekeep                                                       *
+ *                                                                                  *
+ * Purpose: drops expired partitions and compacts closed partitions                 *
+ *                                                                                  *
+ * Parameters:  hist    - [IN] the history storage interface                        *
+ *                                                                                  *
+ ************************************************************************************/
+static void	column_housekeep(zbx_history_iface_t *hist)
+{
+	zbx_column_data_t	*data = (zbx_column_data_t *)hist->data;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() path:%s", __func__, data->path);
+
+	column_maintain_partitions(data, hist->value_type);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
+}
+
+/************************************************************************************
+ *                                                                                  *
+ * Function: zbx_history_column_init                                                *
+ *                                                                                  *
+ * Purpose: initializes history storage interface                                   *
+ *                                                                                  *
+ * Parameters:  hist       - [IN] the history storage interface                     *
+ *              value_type - [IN] the target value type                             *
+ *              error      - [OUT] the error message                                *
+ *                                                                                  *
+ * Return value: SUCCEED - the history storage interface was initialized            *
+ *               FAIL    - otherwise                                                *
+ *                                                                                  *
+ * Comments: Only numeric value types are supported.                                *
+ *                                                                                  *
+ ************************************************************************************/
+int	zbx_history_column_init(zbx_history_iface_t *hist, unsigned char value_type, char **error)
+{
+	zbx_column_data_t	*data;
+	char			*path;
+
+	if (ITEM_VALUE_TYPE_FLOAT != value_type && ITEM_VALUE_TYPE_UINT64 != value_type)
+	{
+		*error = zbx_dsprintf(*error, "local history storage does not support value type %d", value_type);
+		return FAIL;
+	}
+
+	path = zbx_dsprintf(NULL, "%s/%s", CONFIG_HISTORY_LOCAL_PATH,
+			ITEM_VALUE_TYPE_FLOAT == value_type ? "dbl" : "uint");
+
+	if (0 != mkdir(path, 0750) && EEXIST != errno)
+	{
+		*error = zbx_dsprintf(*error, "cannot create history directory \"%s\": %s", path, zbx_strerror(errno));
+		zbx_free(path);
+		return FAIL;
+	}
+
+	data = (zbx_column_data_t *)zbx_malloc(NULL, sizeof(zbx_column_data_t));
+	memset(data, 0, sizeof(zbx_column_data_t));
+	data->path = path;
+
+	hist->value_type = value_type;
+	hist->data = data;
+	hist->destroy = column_destroy;
+	hist->add_values = column_add_values;
+	hist->flush = column_flush;
+	hist->housekeep = column_housekeep;
+	hist->get_values = column_get_values;
+	hist->get_values_multi = column_get_values_multi;
+	hist->requires_trends = 1;
+
+	return SUCCEED;
+}
+
+#ifdef HAVE_TESTS
+#	include "../../../tests/libs/zbxhistory/history_column_test.c"
+#endif
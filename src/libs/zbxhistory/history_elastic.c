@@ -34,32 +34,31 @@
 #define		ZBX_IDX_JSON_ALLOCATE		256
 #define		ZBX_JSON_ALLOCATE		2048
 
+/* the maximum number of searches in a single multi search request */
+#define		ZBX_ELASTIC_MSEARCH_BATCH_SIZE	100
+/* the maximum number of values returned by a single search of multi search request, */
+/* matches the default elasticsearch index.max_result_window setting                 */
+#define		ZBX_ELASTIC_MSEARCH_SIZE	10000
+
+/* the maximum number of bulk requests being sent or waiting to be resent, when */
+/* reached the history syncer blocks until some of the requests are completed   */
+#define		ZBX_ELASTIC_MAX_INFLIGHT	16
+
 
 const char	*value_type_str[] = {"dbl", "str", "log", "uint", "text"};
 
 extern char	*CONFIG_HISTORY_STORAGE_URL;
 extern int	CONFIG_HISTORY_STORAGE_PIPELINES;
+extern int	CONFIG_HISTORY_STORAGE_DRAIN_TIMEOUT;
 
 typedef struct
 {
 	char	*base_url;
 	char	*post_url;
-	char	*buf;
 	CURL	*handle;
 }
 zbx_elastic_data_t;
 
-typedef struct
-{
-	unsigned char		initialized;
-	zbx_vector_ptr_t	ifaces;
-
-	CURLM			*handle;
-}
-zbx_elastic_writer_t;
-
-static zbx_elastic_writer_t	writer;
-
 typedef struct
 {
 	char	*data;
@@ -70,14 +69,42 @@ zbx_httppage_t;
 
 static zbx_httppage_t	page_r;
 
+/* bulk api request with the offsets of its documents, used to resend failed documents */
 typedef struct
 {
+	char		*url;
+	char		*body;
+	size_t		body_alloc;
+	size_t		body_offset;
+	size_t		*docs;
+	int		docs_num;
+	int		docs_alloc;
+	time_t		retry_time;
+	CURL		*handle;
 	zbx_httppage_t	page;
 	char		errbuf[CURL_ERROR_SIZE];
 }
-zbx_curlpage_t;
+zbx_elastic_bulk_t;
 
-static zbx_curlpage_t	page_w[ITEM_VALUE_TYPE_MAX];
+typedef struct
+{
+	unsigned char		initialized;
+
+	/* the bulk requests being sent */
+	zbx_vector_ptr_t	inflight;
+
+	/* the bulk requests waiting to be resent */
+	zbx_vector_ptr_t	delayed;
+
+	/* the idle easy handles, reused to keep connections alive */
+	zbx_vector_ptr_t	handles;
+
+	struct curl_slist	*headers;
+	CURLM			*handle;
+}
+zbx_elastic_writer_t;
+
+static zbx_elastic_writer_t	writer;
 
 static size_t	curl_write_cb(void *ptr, size_t size, size_t nmemb, void *userdata)
 {
@@ -232,14 +259,10 @@ static void	elastic_close(zbx_history_iface_t *hist)
 {
 	zbx_elastic_data_t	*data = (zbx_elastic_data_t *)hist->data;
 
-	zbx_free(data->buf);
 	zbx_free(data->post_url);
 
 	if (NULL != data->handle)
 	{
-		if (NULL != writer.handle)
-			curl_multi_remove_handle(writer.handle, data->handle);
-
 		curl_easy_cleanup(data->handle);
 		data->handle = NULL;
 	}
@@ -323,11 +346,134 @@ static int	elastic_is_error_present(zbx_httppage_t *page, char **err)
 
 
 
+/************************************************************************************
+ *                                                                                  *
+ * Function: elastic_bulk_create                                                    *
+ *                                                                                  *
+ * Purpose: creates a new bulk request                                              *
+ *                                                                                  *
+ * Parameters: url - [IN] the bulk api url                                          *
+ *                                                                                  *
+ * Return value: the created bulk request                                           *
+ *                                                                                  *
+ ************************************************************************************/
+static zbx_elastic_bulk_t	*elastic_bulk_create(const char *url)
+{
+	zbx_elastic_bulk_t	*bulk;
+
+	bulk = (zbx_elastic_bulk_t *)zbx_malloc(NULL, sizeof(zbx_elastic_bulk_t));
+	memset(bulk, 0, sizeof(zbx_elastic_bulk_t));
+	bulk->url = zbx_strdup(NULL, url);
+
+	return bulk;
+}
+
+/************************************************************************************
+ *                                                                                  *
+ * Function: elastic_bulk_free                                                      *
+ *                                                                                  *
+ * Purpose: frees bulk request                                                      *
+ *                                                                                  *
+ ************************************************************************************/
+static void	elastic_bulk_free(zbx_elastic_bulk_t *bulk)
+{
+	zbx_free(bulk->url);
+	zbx_free(bulk->body);
+	zbx_free(bulk->docs);
+	zbx_free(bulk->page.data);
+	zbx_free(bulk);
+}
+
+/************************************************************************************
+ *                                                                                  *
+ * Function: elastic_bulk_add_doc                                                   *
+ *                                                                                  *
+ * Purpose: adds document with its action line to bulk request                      *
+ *                                                                                  *
+ * Parameters: bulk - [IN/OUT] the bulk request                                     *
+ *             doc  - [IN] the action and document lines, terminated by newlines    *
+ *             len  - [IN] the document length                                      *
+ *                                                                                  *
+ ************************************************************************************/
+static void	elastic_bulk_add_doc(zbx_elastic_bulk_t *bulk, const char *doc, size_t len)
+{
+	if (bulk->docs_num == bulk->docs_alloc)
+	{
+		bulk->docs_alloc = (0 == bulk->docs_alloc ? 16 : bulk->docs_alloc * 2);
+		bulk->docs = (size_t *)zbx_realloc(bulk->docs, sizeof(size_t) * (size_t)bulk->docs_alloc);
+	}
+
+	bulk->docs[bulk->docs_num++] = bulk->body_offset;
+	zbx_strncpy_alloc(&bulk->body, &bulk->body_alloc, &bulk->body_offset, doc, len);
+}
+
+/************************************************************************************
+ *                                                                                  *
+ * Function: elastic_bulk_get_failed_docs                                           *
+ *                                                                                  *
+ * Purpose: creates bulk request from the documents failed to be stored             *
+ *                                                                                  *
+ * Parameters: bulk - [IN] the completed bulk request                               *
+ *                                                                                  *
+ * Return value: the bulk request with documents to resend or NULL if there are     *
+ *               no such documents                                                  *
+ *                                                                                  *
+ * Comments: Bulk api reports status of every document in the order they were       *
+ *           sent. All failed documents are resent, not only the ones rejected      *
+ *           because of full queues (429) or server errors (5xx), as other errors   *
+ *           (for example read-only index) can be fixed on elasticsearch side       *
+ *           without losing the data.                                               *
+ *                                                                                  *
+ ************************************************************************************/
+static zbx_elastic_bulk_t	*elastic_bulk_get_failed_docs(const zbx_elastic_bulk_t *bulk)
+{
+	struct zbx_json_parse	jp, jp_values, jp_items, jp_item, jp_action;
+	const char		*p = NULL;
+	char			*error, status[MAX_ID_LEN + 1];
+	int			index = 0;
+	zbx_elastic_bulk_t	*failed = NULL;
+
+	if (NULL == bulk->page.data || SUCCEED != elastic_is_error_present((zbx_httppage_t *)&bulk->page, &error))
+		return NULL;
+
+	zabbix_log(LOG_LEVEL_WARNING, "cannot send data to elasticsearch: %s", error);
+	zbx_free(error);
+
+	if (SUCCEED != zbx_json_open(bulk->page.data, &jp) || SUCCEED != zbx_json_brackets_open(jp.start, &jp_values)
+			|| SUCCEED != zbx_json_brackets_by_name(&jp_values, "items", &jp_items))
+	{
+		return NULL;
+	}
+
+	for (; NULL != (p = zbx_json_next(&jp_items, p)) && index < bulk->docs_num; index++)
+	{
+		size_t	end;
+
+		if (SUCCEED != zbx_json_brackets_open(p, &jp_item) ||
+				SUCCEED != zbx_json_brackets_by_name(&jp_item, "index", &jp_action) ||
+				SUCCEED != zbx_json_value_by_name(&jp_action, "status", status, sizeof(status), NULL))
+		{
+			continue;
+		}
+
+		if (300 > atoi(status))
+			continue;
+
+		if (NULL == failed)
+			failed = elastic_bulk_create(bulk->url);
+
+		end = (index + 1 < bulk->docs_num ? bulk->docs[index + 1] : bulk->body_offset);
+		elastic_bulk_add_doc(failed, bulk->body + bulk->docs[index], end - bulk->docs[index]);
+	}
+
+	return failed;
+}
+
 /************************************************************************************
  *                                                                                  *
  * Function: elastic_writer_init                                                    *
  *                                                                                  *
- * Purpose: initializes elastic writer for a new batch of history values            *
+ * Purpose: initializes asynchronous elastic writer                                 *
  *                                                                                  *
  ************************************************************************************/
 static void	elastic_writer_init(void)
@@ -335,7 +481,9 @@ static void	elastic_writer_init(void)
 	if (0 != writer.initialized)
 		return;
 
-	zbx_vector_ptr_create(&writer.ifaces);
+	zbx_vector_ptr_create(&writer.inflight);
+	zbx_vector_ptr_create(&writer.delayed);
+	zbx_vector_ptr_create(&writer.handles);
 
 	if (NULL == (writer.handle = curl_multi_init()))
 	{
@@ -343,6 +491,8 @@ static void	elastic_writer_init(void)
 		exit(EXIT_FAILURE);
 	}
 
+	writer.headers = curl_slist_append(NULL, "Content-Type: application/x-ndjson");
+
 	writer.initialized = 1;
 }
 
@@ -358,208 +508,322 @@ static void	elastic_writer_release(void)
 {
 	int	i;
 
-	for (i = 0; i < writer.ifaces.values_num; i++)
-		elastic_close((zbx_history_iface_t *)writer.ifaces.values[i]);
+	for (i = 0; i < writer.inflight.values_num; i++)
+	{
+		zbx_elastic_bulk_t	*bulk = (zbx_elastic_bulk_t *)writer.inflight.values[i];
+
+		curl_multi_remove_handle(writer.handle, bulk->handle);
+		curl_easy_cleanup(bulk->handle);
+	}
+
+	zbx_vector_ptr_clear_ext(&writer.inflight, (zbx_clean_func_t)elastic_bulk_free);
+	zbx_vector_ptr_destroy(&writer.inflight);
+
+	zbx_vector_ptr_clear_ext(&writer.delayed, (zbx_clean_func_t)elastic_bulk_free);
+	zbx_vector_ptr_destroy(&writer.delayed);
+
+	zbx_vector_ptr_clear_ext(&writer.handles, (zbx_clean_func_t)curl_easy_cleanup);
+	zbx_vector_ptr_destroy(&writer.handles);
 
 	curl_multi_cleanup(writer.handle);
 	writer.handle = NULL;
 
-	zbx_vector_ptr_destroy(&writer.ifaces);
+	curl_slist_free_all(writer.headers);
+	writer.headers = NULL;
 
 	writer.initialized = 0;
 }
 
 /************************************************************************************
  *                                                                                  *
- * Function: elastic_writer_add_iface                                               *
+ * Function: elastic_writer_start                                                   *
+ *                                                                                  *
+ * Purpose: starts sending bulk request                                             *
  *                                                                                  *
- * Purpose: adds history storage interface to be flushed later                      *
+ * Parameters: bulk - [IN] the bulk request                                         *
  *                                                                                  *
- * Parameters: db_insert - [IN] bulk insert data                                    *
+ * Comments: The easy handles are reused, together with the connection cache of     *
+ *           multi handle this keeps connections to elasticsearch alive between     *
+ *           requests.                                                              *
  *                                                                                  *
  ************************************************************************************/
-static void	elastic_writer_add_iface(zbx_history_iface_t *hist)
+static void	elastic_writer_start(zbx_elastic_bulk_t *bulk)
 {
-	zbx_elastic_data_t	*data = (zbx_elastic_data_t *)hist->data;
-
-	elastic_writer_init();
-
-	if (NULL == (data->handle = curl_easy_init()))
+	if (0 != writer.handles.values_num)
+	{
+		bulk->handle = (CURL *)writer.handles.values[writer.handles.values_num - 1];
+		zbx_vector_ptr_remove_noorder(&writer.handles, writer.handles.values_num - 1);
+	}
+	else if (NULL == (bulk->handle = curl_easy_init()))
 	{
 		zabbix_log(LOG_LEVEL_ERR, "cannot initialize cURL session");
+		bulk->retry_time = time(NULL) + ZBX_HISTORY_STORAGE_DOWN / 1000;
+		zbx_vector_ptr_append(&writer.delayed, bulk);
 		return;
 	}
-	curl_easy_setopt(data->handle, CURLOPT_URL, data->post_url);
-	curl_easy_setopt(data->handle, CURLOPT_POST, 1L);
-	curl_easy_setopt(data->handle, CURLOPT_POSTFIELDS, data->buf);
-	curl_easy_setopt(data->handle, CURLOPT_WRITEFUNCTION, curl_write_cb);
-	curl_easy_setopt(data->handle, CURLOPT_WRITEDATA, &page_w[hist->value_type].page);
-	curl_easy_setopt(data->handle, CURLOPT_FAILONERROR, 1L);
-	curl_easy_setopt(data->handle, CURLOPT_ERRORBUFFER, page_w[hist->value_type].errbuf);
-	*page_w[hist->value_type].errbuf = '\0';
-	curl_easy_setopt(data->handle, CURLOPT_PRIVATE, &page_w[hist->value_type]);
-	page_w[hist->value_type].page.offset = 0;
-	if (0 < page_w[hist->value_type].page.alloc)
-		*page_w[hist->value_type].page.data = '\0';
 
-	curl_multi_add_handle(writer.handle, data->handle);
+	zabbix_log(LOG_LEVEL_DEBUG, "sending %s", bulk->body);
+
+	bulk->page.offset = 0;
+	if (0 < bulk->page.alloc)
+		*bulk->page.data = '\0';
+	*bulk->errbuf = '\0';
+
+	curl_easy_setopt(bulk->handle, CURLOPT_URL, bulk->url);
+	curl_easy_setopt(bulk->handle, CURLOPT_POST, 1L);
+	curl_easy_setopt(bulk->handle, CURLOPT_POSTFIELDS, bulk->body);
+	curl_easy_setopt(bulk->handle, CURLOPT_POSTFIELDSIZE, (long)bulk->body_offset);
+	curl_easy_setopt(bulk->handle, CURLOPT_HTTPHEADER, writer.headers);
+	curl_easy_setopt(bulk->handle, CURLOPT_WRITEFUNCTION, curl_write_cb);
+	curl_easy_setopt(bulk->handle, CURLOPT_WRITEDATA, &bulk->page);
+	curl_easy_setopt(bulk->handle, CURLOPT_FAILONERROR, 1L);
+	curl_easy_setopt(bulk->handle, CURLOPT_ERRORBUFFER, bulk->errbuf);
+	curl_easy_setopt(bulk->handle, CURLOPT_PRIVATE, bulk);
+#if LIBCURL_VERSION_NUM >= 0x071900
+	curl_easy_setopt(bulk->handle, CURLOPT_TCP_KEEPALIVE, 1L);
+#endif
+	curl_multi_add_handle(writer.handle, bulk->handle);
 
-	zbx_vector_ptr_append(&writer.ifaces, hist);
+	zbx_vector_ptr_append(&writer.inflight, bulk);
 }
 
 /************************************************************************************
  *                                                                                  *
- * Function: elastic_writer_flush                                                   *
+ * Function: elastic_writer_retry                                                   *
  *                                                                                  *
- * Purpose: posts historical data to elastic storage                                *
+ * Purpose: schedules bulk request to be resent after ZBX_HISTORY_STORAGE_DOWN      *
+ *          timeout                                                                 *
  *                                                                                  *
  ************************************************************************************/
-static int	elastic_writer_flush(void)
+static void	elastic_writer_retry(zbx_elastic_bulk_t *bulk)
 {
-	struct curl_slist	*curl_headers = NULL;
-	int			i, running, previous, msgnum;
-	CURLMsg			*msg;
-	zbx_vector_ptr_t	retries;
-
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
+	bulk->retry_time = time(NULL) + ZBX_HISTORY_STORAGE_DOWN / 1000;
+	zbx_vector_ptr_append(&writer.delayed, bulk);
+}
 
-	/* The writer might be uninitialized only if the history */
-	/* was already flushed. In that case, return SUCCEED */
-	if (0 == writer.initialized)
-		return SUCCEED;
+/************************************************************************************
+ *                                                                                  *
+ * Function: elastic_writer_complete_bulk                                           *
+ *                                                                                  *
+ * Purpose: processes the result of sent bulk request                               *
+ *                                                                                  *
+ * Parameters: bulk      - [IN] the sent bulk request, removed from inflight        *
+ *                              requests                                            *
+ *             result    - [IN] the transfer result                                 *
+ *             http_code - [IN] the HTTP response code                              *
+ *                                                                                  *
+ * Comments: The bulk request is either freed or scheduled to be resent.            *
+ *                                                                                  *
+ ************************************************************************************/
+static void	elastic_writer_complete_bulk(zbx_elastic_bulk_t *bulk, CURLcode result, long int http_code)
+{
+	zbx_elastic_bulk_t	*failed;
 
-	zbx_vector_ptr_create(&retries);
+	if (CURLE_HTTP_RETURNED_ERROR == result)
+	{
+		if ('\0' != *bulk->errbuf)
+		{
+			zabbix_log(LOG_LEVEL_ERR, "cannot send data to elasticsearch, HTTP error message: %s",
+					bulk->errbuf);
+		}
+		else
+			zabbix_log(LOG_LEVEL_ERR, "cannot send data to elasticsearch, HTTP status code: %ld", http_code);
 
-	curl_headers = curl_slist_append(curl_headers, "Content-Type: application/x-ndjson");
+		/* too many requests and server errors are temporary, while other errors */
+		/* are caused by malformed data and there is no sense to resend it        */
+		if (429 == http_code || 500 <= http_code)
+		{
+			elastic_writer_retry(bulk);
+			return;
+		}
+	}
+	else if (CURLE_OK != result)
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot send data to elasticsearch: %s",
+				'\0' != *bulk->errbuf ? bulk->errbuf : curl_easy_strerror(result));
 
-	for (i = 0; i < writer.ifaces.values_num; i++)
+		/* transport errors are resent with the whole request */
+		elastic_writer_retry(bulk);
+		return;
+	}
+	else if (NULL != (failed = elastic_bulk_get_failed_docs(bulk)))
 	{
-		zbx_history_iface_t	*hist = (zbx_history_iface_t *)writer.ifaces.values[i];
-		zbx_elastic_data_t	*data = (zbx_elastic_data_t *)hist->data;
+		zabbix_log(LOG_LEVEL_DEBUG, "resending %d of %d document(s)", failed->docs_num, bulk->docs_num);
+		elastic_writer_retry(failed);
+	}
 
-		(void)curl_easy_setopt(data->handle, CURLOPT_HTTPHEADER, curl_headers);
+	elastic_bulk_free(bulk);
+}
 
-		zabbix_log(LOG_LEVEL_DEBUG, "sending %s", data->buf);
-	}
+/************************************************************************************
+ *                                                                                  *
+ * Function: elastic_writer_complete                                                *
+ *                                                                                  *
+ * Purpose: processes completed bulk request                                        *
+ *                                                                                  *
+ * Parameters: msg - [IN] the curl multi handle completion message                  *
+ *                                                                                  *
+ ************************************************************************************/
+static void	elastic_writer_complete(CURLMsg *msg)
+{
+	zbx_elastic_bulk_t	*bulk = NULL;
+	long int		http_code = 0;
+	int			i;
 
-try_again:
-	previous = 0;
+	if (CURLE_OK != curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, (char **)&bulk) || NULL == bulk)
+		return;
 
-	do
+	if (CURLE_HTTP_RETURNED_ERROR == msg->data.result)
+		curl_easy_getinfo(msg->easy_handle, CURLINFO_RESPONSE_CODE, &http_code);
+
+	curl_multi_remove_handle(writer.handle, bulk->handle);
+	zbx_vector_ptr_append(&writer.handles, bulk->handle);
+	bulk->handle = NULL;
+
+	if (FAIL != (i = zbx_vector_ptr_search(&writer.inflight, bulk, ZBX_DEFAULT_PTR_COMPARE_FUNC)))
+		zbx_vector_ptr_remove_noorder(&writer.inflight, i);
+
+	elastic_writer_complete_bulk(bulk, msg->data.result, http_code);
+}
+
+/************************************************************************************
+ *                                                                                  *
+ * Function: elastic_writer_start_delayed                                           *
+ *                                                                                  *
+ * Purpose: starts resending bulk requests with expired retry delay                 *
+ *                                                                                  *
+ * Parameters: now - [IN] the current timestamp                                     *
+ *                                                                                  *
+ * Comments: The requests are resent in the order they failed.                      *
+ *                                                                                  *
+ ************************************************************************************/
+static void	elastic_writer_start_delayed(time_t now)
+{
+	int	i;
+
+	for (i = 0; i < writer.delayed.values_num; )
 	{
-		int		fds;
-		CURLMcode	code;
-		char 		*error;
-		zbx_curlpage_t	*curl_page;
+		zbx_elastic_bulk_t	*bulk = (zbx_elastic_bulk_t *)writer.delayed.values[i];
 
-		if (CURLM_OK != (code = curl_multi_perform(writer.handle, &running)))
+		if (now < bulk->retry_time)
 		{
-			zabbix_log(LOG_LEVEL_ERR, "cannot perform on curl multi handle: %s", curl_multi_strerror(code));
-			break;
+			i++;
+			continue;
 		}
 
-		if (CURLM_OK != (code = curl_multi_wait(writer.handle, NULL, 0, ZBX_HISTORY_STORAGE_DOWN, &fds)))
+		zbx_vector_ptr_remove(&writer.delayed, i);
+		elastic_writer_start(bulk);
+	}
+}
+
+/************************************************************************************
+ *                                                                                  *
+ * Function: elastic_writer_process                                                 *
+ *                                                                                  *
+ * Purpose: advances the sending of bulk requests                                   *
+ *                                                                                  *
+ * Parameters: timeout - [IN] the maximum time to wait for network activity in      *
+ *                            milliseconds, 0 - do not wait                         *
+ *                                                                                  *
+ ************************************************************************************/
+static void	elastic_writer_process(int timeout)
+{
+	int		running, msgnum, fds;
+	CURLMsg		*msg;
+	CURLMcode	code;
+
+	elastic_writer_start_delayed(time(NULL));
+
+	if (CURLM_OK != (code = curl_multi_perform(writer.handle, &running)))
+	{
+		zabbix_log(LOG_LEVEL_ERR, "cannot perform on curl multi handle: %s", curl_multi_strerror(code));
+		return;
+	}
+
+	if (0 != timeout && 0 != running)
+	{
+		if (CURLM_OK != (code = curl_multi_wait(writer.handle, NULL, 0, timeout, &fds)))
 		{
 			zabbix_log(LOG_LEVEL_ERR, "cannot wait on curl multi handle: %s", curl_multi_strerror(code));
-			break;
+			return;
 		}
 
-		if (previous == running)
-			continue;
-
-		while (NULL != (msg = curl_multi_info_read(writer.handle, &msgnum)))
+		if (CURLM_OK != (code = curl_multi_perform(writer.handle, &running)))
 		{
-			/* If the error is due to malformed data, there is no sense on re-trying to send. */
-			/* That's why we actually check for transport and curl errors separately */
-			if (CURLE_HTTP_RETURNED_ERROR == msg->data.result)
-			{
-				if (CURLE_OK == curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE,
-						(char **)&curl_page) && '\0' != *curl_page->errbuf)
-				{
-					zabbix_log(LOG_LEVEL_ERR, "cannot send data to elasticsearch, HTTP error"
-							" message: %s", curl_page->errbuf);
-				}
-				else
-				{
-					char		http_status[MAX_STRING_LEN];
-					long int	err;
-					CURLcode	curl_err;
-
-					if (CURLE_OK == (curl_err = curl_easy_getinfo(msg->easy_handle,
-							CURLINFO_RESPONSE_CODE, &err)))
-					{
-						zbx_snprintf(http_status, sizeof(http_status), "HTTP status code: %ld",
-								err);
-					}
-					else
-					{
-						zbx_strlcpy(http_status, "unknown HTTP status code",
-								sizeof(http_status));
-					}
-
-					zabbix_log(LOG_LEVEL_ERR, "cannot send data to elasticsearch, %s", http_status);
-				}
-			}
-			else if (CURLE_OK != msg->data.result)
-			{
-				if (CURLE_OK == curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE,
-						(char **)&curl_page) && '\0' != *curl_page->errbuf)
-				{
-					zabbix_log(LOG_LEVEL_WARNING, "cannot send data to elasticsearch: %s",
-							curl_page->errbuf);
-				}
-				else
-				{
-					zabbix_log(LOG_LEVEL_WARNING, "cannot send data to elasticsearch: %s",
-							curl_easy_strerror(msg->data.result));
-				}
-
-				/* If the error is due to curl internal problems or unrelated */
-				/* problems with HTTP, we put the handle in a retry list and */
-				/* remove it from the current execution loop */
-				zbx_vector_ptr_append(&retries, msg->easy_handle);
-				curl_multi_remove_handle(writer.handle, msg->easy_handle);
-			}
-			else if (CURLE_OK == curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, (char **)&curl_page)
-					&& SUCCEED == elastic_is_error_present(&curl_page->page, &error))
-			{
-				zabbix_log(LOG_LEVEL_WARNING, "%s() cannot send data to elasticsearch: %s",
-						__func__, error);
-				zbx_free(error);
-
-				/* If the error is due to elastic internal problems (for example an index */
-				/* became read-only), we put the handle in a retry list and */
-				/* remove it from the current execution loop */
-				zbx_vector_ptr_append(&retries, msg->easy_handle);
-				curl_multi_remove_handle(writer.handle, msg->easy_handle);
-			}
+			zabbix_log(LOG_LEVEL_ERR, "cannot perform on curl multi handle: %s", curl_multi_strerror(code));
+			return;
 		}
+	}
 
-		previous = running;
+	while (NULL != (msg = curl_multi_info_read(writer.handle, &msgnum)))
+	{
+		if (CURLMSG_DONE == msg->msg)
+			elastic_writer_complete(msg);
 	}
-	while (running);
+}
 
-	/* We check if we have handles to retry. If yes, we put them back in the multi */
-	/* handle and go to the beginning of the do while() for try sending the data again */
-	/* after sleeping for ZBX_HISTORY_STORAGE_DOWN / 1000 (seconds) */
-	if (0 < retries.values_num)
+/************************************************************************************
+ *                                                                                  *
+ * Function: elastic_writer_wait                                                    *
+ *                                                                                  *
+ * Purpose: waits until the number of pending requests drops to the specified limit *
+ *                                                                                  *
+ * Parameters: limit    - [IN] the number of allowed pending requests               *
+ *             deadline - [IN] the time to stop waiting, 0 - wait without limit     *
+ *                                                                                  *
+ ************************************************************************************/
+static void	elastic_writer_wait(int limit, time_t deadline)
+{
+	while (limit < writer.inflight.values_num + writer.delayed.values_num)
 	{
-		for (i = 0; i < retries.values_num; i++)
-			curl_multi_add_handle(writer.handle, retries.values[i]);
+		if (0 != deadline && deadline <= time(NULL))
+			break;
 
-		zbx_vector_ptr_clear(&retries);
+		/* only failed requests are pending, wait until they can be resent */
+		if (0 == writer.inflight.values_num)
+			sleep(1);
 
-		sleep(ZBX_HISTORY_STORAGE_DOWN / 1000);
-		goto try_again;
+		elastic_writer_process(ZBX_HISTORY_STORAGE_DOWN);
 	}
+}
 
-	curl_slist_free_all(curl_headers);
+/************************************************************************************
+ *                                                                                  *
+ * Function: elastic_writer_add_bulk                                                *
+ *                                                                                  *
+ * Purpose: queues bulk request to be sent asynchronously                           *
+ *                                                                                  *
+ * Parameters: bulk - [IN] the bulk request                                         *
+ *                                                                                  *
+ * Comments: If the number of pending requests reaches ZBX_ELASTIC_MAX_INFLIGHT     *
+ *           this function blocks until some of them are completed.                 *
+ *                                                                                  *
+ ************************************************************************************/
+static void	elastic_writer_add_bulk(zbx_elastic_bulk_t *bulk)
+{
+	elastic_writer_init();
+	elastic_writer_wait(ZBX_ELASTIC_MAX_INFLIGHT - 1, 0);
+	elastic_writer_start(bulk);
+}
 
-	zbx_vector_ptr_destroy(&retries);
+/************************************************************************************
+ *                                                                                  *
+ * Function: elastic_writer_flush                                                   *
+ *                                                                                  *
+ * Purpose: advances the sending of historical data to elastic storage without      *
+ *          waiting for completion                                                  *
+ *                                                                                  *
+ ************************************************************************************/
+static int	elastic_writer_flush(void)
+{
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
-	elastic_writer_release();
+	if (0 != writer.initialized)
+		elastic_writer_process(0);
 
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s() inflight:%d delayed:%d", __func__,
+			0 != writer.initialized ? writer.inflight.values_num : 0,
+			0 != writer.initialized ? writer.delayed.values_num : 0);
 
 	return SUCCEED;
 }
@@ -583,6 +847,24 @@ static void	elastic_destroy(zbx_history_iface_t *hist)
 {
 	zbx_elastic_data_t	*data = (zbx_elastic_data_t *)hist->data;
 
+	/* the writer is shared by all value types, send the pending data when */
+	/* the first interface is destroyed                                     */
+	if (0 != writer.initialized)
+	{
+		/* by default wait until all pending data is sent, unless it is allowed */
+		/* to be lost after HistoryStorageDrainTimeout while elasticsearch is down */
+		elastic_writer_wait(0, 0 != CONFIG_HISTORY_STORAGE_DRAIN_TIMEOUT ?
+				time(NULL) + CONFIG_HISTORY_STORAGE_DRAIN_TIMEOUT : 0);
+
+		if (0 != writer.inflight.values_num + writer.delayed.values_num)
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "cannot send data to elasticsearch: %d pending bulk request(s)"
+					" were dropped", writer.inflight.values_num + writer.delayed.values_num);
+		}
+
+		elastic_writer_release();
+	}
+
 	elastic_close(hist);
 
 	zbx_free(data->base_url);
@@ -814,6 +1096,233 @@ out:
 	return ret;
 }
 
+/************************************************************************************
+ *                                                                                  *
+ * Function: elastic_add_msearch_query                                              *
+ *                                                                                  *
+ * Purpose: adds a search for the item values from ]<start>,<end>] interval to the  *
+ *          multi search request body                                               *
+ *                                                                                  *
+ * Parameters:  body        - [IN/OUT] the request body                             *
+ *              body_alloc  - [IN/OUT] the request body allocated size              *
+ *              body_offset - [IN/OUT] the request body size                        *
+ *              request     - [IN] the read request                                 *
+ *                                                                                  *
+ ************************************************************************************/
+static void	elastic_add_msearch_query(char **body, size_t *body_alloc, size_t *body_offset,
+		const zbx_history_request_t *request)
+{
+	struct zbx_json	query;
+
+	zbx_json_init(&query, ZBX_JSON_ALLOCATE);
+
+	zbx_json_adduint64(&query, "size", ZBX_ELASTIC_MSEARCH_SIZE);
+	zbx_json_addobject(&query, "query");
+	zbx_json_addobject(&query, "bool");
+	zbx_json_addarray(&query, "must");
+	zbx_json_addobject(&query, NULL);
+	zbx_json_addobject(&query, "match");
+	zbx_json_adduint64(&query, "itemid", request->itemid);
+	zbx_json_close(&query);
+	zbx_json_close(&query);
+	zbx_json_close(&query);
+	zbx_json_addarray(&query, "filter");
+	zbx_json_addobject(&query, NULL);
+	zbx_json_addobject(&query, "range");
+	zbx_json_addobject(&query, "clock");
+
+	if (0 < request->start)
+		zbx_json_adduint64(&query, "gt", request->start);
+
+	if (0 < request->end)
+		zbx_json_adduint64(&query, "lte", request->end);
+
+	zbx_json_close(&query);
+	zbx_json_close(&query);
+	zbx_json_close(&query);
+	zbx_json_close(&query);
+	zbx_json_close(&query);
+	zbx_json_close(&query);
+	zbx_json_close(&query);
+
+	/* multi search body consists of header and query lines, header is empty as index is set by url */
+	zbx_snprintf_alloc(body, body_alloc, body_offset, "{}\n%s\n", query.buffer);
+
+	zbx_json_free(&query);
+}
+
+/************************************************************************************
+ *                                                                                  *
+ * Function: elastic_parse_msearch_response                                         *
+ *                                                                                  *
+ * Purpose: parses multi search response and stores the found values in the         *
+ *          corresponding requests                                                  *
+ *                                                                                  *
+ * Parameters:  hist     - [IN] the history storage interface                       *
+ *              requests - [IN/OUT] the read requests                               *
+ *              num      - [IN] the number of requests                              *
+ *                                                                                  *
+ * Return value: SUCCEED - the response was parsed successfully                     *
+ *               FAIL - otherwise                                                   *
+ *                                                                                  *
+ * Comments: Searches returning ZBX_ELASTIC_MSEARCH_SIZE values might be truncated, *
+ *           so their values are re-read with scroll search.                        *
+ *                                                                                  *
+ ************************************************************************************/
+static int	elastic_parse_msearch_response(zbx_history_iface_t *hist, zbx_history_request_t **requests, int num)
+{
+	struct zbx_json_parse	jp, jp_values, jp_responses, jp_response, jp_sub, jp_hits, jp_item, jp_source;
+	const char		*p = NULL, *p_hit;
+	int			i, hits_num;
+	zbx_history_record_t	hr;
+	zbx_vector_ptr_t	truncated;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "received from elasticsearch: %s", page_r.data);
+
+	if (SUCCEED != zbx_json_open(page_r.data, &jp) || SUCCEED != zbx_json_brackets_open(jp.start, &jp_values) ||
+			SUCCEED != zbx_json_brackets_by_name(&jp_values, "responses", &jp_responses))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot parse elasticsearch multi search response");
+		return FAIL;
+	}
+
+	zbx_vector_ptr_create(&truncated);
+
+	for (i = 0; i < num && NULL != (p = zbx_json_next(&jp_responses, p)); i++)
+	{
+		if (SUCCEED != zbx_json_brackets_open(p, &jp_response) ||
+				SUCCEED != zbx_json_brackets_by_name(&jp_response, "hits", &jp_sub) ||
+				SUCCEED != zbx_json_brackets_by_name(&jp_sub, "hits", &jp_hits))
+		{
+			break;
+		}
+
+		for (p_hit = NULL, hits_num = 0; NULL != (p_hit = zbx_json_next(&jp_hits, p_hit)); hits_num++)
+		{
+			if (SUCCEED != zbx_json_brackets_open(p_hit, &jp_item))
+				continue;
+
+			if (SUCCEED != zbx_json_brackets_by_name(&jp_item, "_source", &jp_source))
+				continue;
+
+			if (SUCCEED != history_parse_value(&jp_source, hist->value_type, &hr))
+				continue;
+
+			zbx_vector_history_record_append_ptr(&requests[i]->values, &hr);
+		}
+
+		if (ZBX_ELASTIC_MSEARCH_SIZE <= hits_num)
+			zbx_vector_ptr_append(&truncated, requests[i]);
+	}
+
+	if (i != num)
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "elasticsearch multi search returned %d responses out of %d searches",
+				i, num);
+		zbx_vector_ptr_destroy(&truncated);
+		return FAIL;
+	}
+
+	for (i = 0; i < truncated.values_num; i++)
+	{
+		zbx_history_request_t	*request = (zbx_history_request_t *)truncated.values[i];
+
+		zbx_history_record_vector_clean(&request->values, hist->value_type);
+
+		if (SUCCEED != elastic_get_values(hist, request->itemid, request->start, 0, request->end,
+				&request->values))
+		{
+			break;
+		}
+	}
+
+	zbx_vector_ptr_destroy(&truncated);
+
+	return i == truncated.values_num ? SUCCEED : FAIL;
+}
+
+/************************************************************************************
+ *                                                                                  *
+ * Function: elastic_get_values_multi                                               *
+ *                                                                                  *
+ * Purpose: gets history data of multiple items from history storage                *
+ *                                                                                  *
+ * Parameters:  hist     - [IN] the history storage interface                       *
+ *              requests - [IN/OUT] the read requests                               *
+ *                                                                                  *
+ * Return value: SUCCEED - the history data were read successfully                  *
+ *               FAIL - otherwise                                                   *
+ *                                                                                  *
+ * Comments: The requests are sent with _msearch requests of up to                  *
+ *           ZBX_ELASTIC_MSEARCH_BATCH_SIZE searches.                               *
+ *                                                                                  *
+ ************************************************************************************/
+static int	elastic_get_values_multi(zbx_history_iface_t *hist, zbx_vector_ptr_t *requests)
+{
+	zbx_elastic_data_t	*data = (zbx_elastic_data_t *)hist->data;
+	size_t			url_alloc = 0, url_offset = 0, body_alloc = 0, body_offset;
+	int			i, j, ret = SUCCEED;
+	CURLcode		err;
+	struct curl_slist	*curl_headers = NULL;
+	char			*body = NULL, errbuf[CURL_ERROR_SIZE];
+	zbx_history_request_t	**values = (zbx_history_request_t **)requests->values;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() requests:%d", __func__, requests->values_num);
+
+	curl_headers = curl_slist_append(curl_headers, "Content-Type: application/x-ndjson");
+
+	for (i = 0; i < requests->values_num && SUCCEED == ret; i = j)
+	{
+		if (NULL == (data->handle = curl_easy_init()))
+		{
+			zabbix_log(LOG_LEVEL_ERR, "cannot initialize cURL session");
+			ret = FAIL;
+			break;
+		}
+
+		/* post url is freed when closing session */
+		url_alloc = 0;
+		url_offset = 0;
+		zbx_snprintf_alloc(&data->post_url, &url_alloc, &url_offset, "%s/%s*/values/_msearch",
+				data->base_url, value_type_str[hist->value_type]);
+
+		body_offset = 0;
+		for (j = i; j < requests->values_num && j - i < ZBX_ELASTIC_MSEARCH_BATCH_SIZE; j++)
+			elastic_add_msearch_query(&body, &body_alloc, &body_offset, values[j]);
+
+		curl_easy_setopt(data->handle, CURLOPT_URL, data->post_url);
+		curl_easy_setopt(data->handle, CURLOPT_POSTFIELDS, body);
+		curl_easy_setopt(data->handle, CURLOPT_WRITEFUNCTION, curl_write_cb);
+		curl_easy_setopt(data->handle, CURLOPT_WRITEDATA, &page_r);
+		curl_easy_setopt(data->handle, CURLOPT_HTTPHEADER, curl_headers);
+		curl_easy_setopt(data->handle, CURLOPT_FAILONERROR, 1L);
+		curl_easy_setopt(data->handle, CURLOPT_ERRORBUFFER, errbuf);
+
+		zabbix_log(LOG_LEVEL_DEBUG, "sending query to %s; post data: %s", data->post_url, body);
+
+		page_r.offset = 0;
+		*errbuf = '\0';
+		if (CURLE_OK != (err = curl_easy_perform(data->handle)))
+		{
+			elastic_log_error(data->handle, err, errbuf);
+			ret = FAIL;
+		}
+
+		/* close the handle before parsing, truncated searches are re-read with a new session */
+		elastic_close(hist);
+
+		if (SUCCEED == ret)
+			ret = elastic_parse_msearch_response(hist, values + i, j - i);
+	}
+
+	curl_slist_free_all(curl_headers);
+	zbx_free(body);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
+
+	return ret;
+}
+
 /************************************************************************************
  *                                                                                  *
  * Function: elastic_add_values                                                     *
@@ -830,8 +1339,8 @@ static int	elastic_add_values(zbx_history_iface_t *hist, const zbx_vector_ptr_t
 	int			i, num = 0;
 	ZBX_DC_HISTORY		*h;
 	struct zbx_json		json_idx, json;
-	size_t			buf_alloc = 0, buf_offset = 0;
-	char			pipeline[14]; /* index name length + suffix "-pipeline" */
+	zbx_elastic_bulk_t	*bulk = NULL;
+	char			*doc = NULL, pipeline[14]; /* index name length + suffix "-pipeline" */
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
@@ -881,19 +1390,27 @@ static int	elastic_add_values(zbx_history_iface_t *hist, const zbx_vector_ptr_t
 
 		zbx_json_close(&json);
 
-		zbx_snprintf_alloc(&data->buf, &buf_alloc, &buf_offset, "%s\n%s\n", json_idx.buffer, json.buffer);
+		if (NULL == bulk)
+		{
+			char	*url;
+
+			url = zbx_dsprintf(NULL, "%s/_bulk?refresh=true", data->base_url);
+			bulk = elastic_bulk_create(url);
+			zbx_free(url);
+		}
+
+		doc = zbx_dsprintf(doc, "%s\n%s\n", json_idx.buffer, json.buffer);
+		elastic_bulk_add_doc(bulk, doc, strlen(doc));
 
 		zbx_json_free(&json);
 
 		num++;
 	}
 
-	if (num > 0)
-	{
-		data->post_url = zbx_dsprintf(NULL, "%s/_bulk?refresh=true", data->base_url);
-		elastic_writer_add_iface(hist);
-	}
+	if (NULL != bulk)
+		elastic_writer_add_bulk(bulk);
 
+	zbx_free(doc);
 	zbx_json_free(&json_idx);
 
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
@@ -909,8 +1426,8 @@ static int	elastic_add_values(zbx_history_iface_t *hist, const zbx_vector_ptr_t
  *                                                                                  *
  * Parameters:  hist    - [IN] the history storage interface                        *
  *                                                                                  *
- * Comments: This function will try to flush the data until it succeeds or          *
- *           unrecoverable error occurs                                             *
+ * Comments: The data is sent asynchronously, this function only advances the       *
+ *           pending requests without waiting for their completion                  *
  *                                                                                  *
  ************************************************************************************/
 static int	elastic_flush(zbx_history_iface_t *hist)
@@ -948,7 +1465,6 @@ int	zbx_history_elastic_init(zbx_history_iface_t *hist, unsigned char value_type
 	memset(data, 0, sizeof(zbx_elastic_data_t));
 	data->base_url = zbx_strdup(NULL, CONFIG_HISTORY_STORAGE_URL);
 	zbx_rtrim(data->base_url, "/");
-	data->buf = NULL;
 	data->post_url = NULL;
 	data->handle = NULL;
 
@@ -958,11 +1474,16 @@ int	zbx_history_elastic_init(zbx_history_iface_t *hist, unsigned char value_type
 	hist->add_values = elastic_add_values;
 	hist->flush = elastic_flush;
 	hist->get_values = elastic_get_values;
+	hist->get_values_multi = elastic_get_values_multi;
 	hist->requires_trends = 0;
 
 	return SUCCEED;
 }
 
+#ifdef HAVE_TESTS
+#	include "../../../tests/libs/zbxhistory/history_elastic_test.c"
+#endif
+
 #else
 
 int	zbx_history_elastic_init(zbx_history_iface_t *hist, unsigned char value_type, char **error)
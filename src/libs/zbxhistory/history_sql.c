@@ -403,6 +403,48 @@ out:
 	return SUCCEED;
 }
 
+/* the period of caching housekeeping settings used to bound history reads */
+#define ZBX_HISTORY_HK_CACHE_PERIOD	SEC_PER_MIN
+
+/************************************************************************************
+ *                                                                                  *
+ * Function: db_get_history_clock_min                                               *
+ *                                                                                  *
+ * Purpose: gets the oldest timestamp of history kept in partitioned history tables *
+ *                                                                                  *
+ * Return value: the oldest history timestamp or 0 if history tables are not        *
+ *               housekept by dropping partitions                                   *
+ *                                                                                  *
+ * Comments: Partitioned history tables are housekept with the global history       *
+ *           storage period, so older records are already expired. Using it as      *
+ *           lower time bound allows database to skip the expired partitions.       *
+ *                                                                                  *
+ *           The housekeeping settings are cached for ZBX_HISTORY_HK_CACHE_PERIOD   *
+ *           seconds to avoid locking configuration cache on every read.            *
+ *                                                                                  *
+ ************************************************************************************/
+static int	db_get_history_clock_min(void)
+{
+	static int	history = 0;
+	static time_t	expire_time = 0;
+	time_t		now;
+
+	now = time(NULL);
+
+	if (expire_time <= now)
+	{
+		zbx_config_t	cfg;
+
+		zbx_config_get(&cfg, ZBX_CONFIG_FLAGS_HOUSEKEEPER);
+		history = (ZBX_HK_MODE_PARTITION == cfg.hk.history_mode ? cfg.hk.history : 0);
+		zbx_config_clean(&cfg);
+
+		expire_time = now + ZBX_HISTORY_HK_CACHE_PERIOD;
+	}
+
+	return 0 != history ? (int)now - history : 0;
+}
+
 /************************************************************************************
  *                                                                                  *
  * Function: db_read_values_by_count                                                *
@@ -425,7 +467,8 @@ out:
  *           To speed up the reading time with huge data loads, data is read by     *
  *           smaller time segments (hours, day, week, month) and the next (larger)  *
  *           time segment is read only if the requested number of values (<count>)  *
- *           is not yet retrieved.                                                  *
+ *           is not yet retrieved. With partitioned history tables the last segment *
+ *           is limited by the global history storage period.                       *
  *                                                                                  *
  ************************************************************************************/
 static int	db_read_values_by_count(zbx_uint64_t itemid, int value_type, zbx_vector_history_record_t *values,
@@ -433,7 +476,7 @@ static int	db_read_values_by_count(zbx_uint64_t itemid, int value_type, zbx_vect
 {
 	char			*sql = NULL;
 	size_t	 		sql_alloc = 0, sql_offset;
-	int			clock_to, clock_from, step = 0, ret = FAIL;
+	int			clock_to, clock_from, clock_min, step = 0, ret = FAIL;
 	DB_RESULT		result;
 	DB_ROW			row;
 	zbx_vc_history_table_t	*table = &vc_history_tables[value_type];
@@ -449,6 +492,15 @@ static int	db_read_values_by_count(zbx_uint64_t itemid, int value_type, zbx_vect
 			step = 4;
 		}
 
+		if (clock_from == clock_to && 0 < (clock_min = db_get_history_clock_min()))
+		{
+			/* the remaining history is in expired partitions */
+			if (clock_min >= clock_to)
+				break;
+
+			clock_from = clock_min;
+		}
+
 		sql_offset = 0;
 		zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
 				"select clock,ns,%s"
@@ -602,6 +654,132 @@ out:
 	return ret;
 }
 
+/* the maximum number of items read by a single multi-item history query */
+#define ZBX_HISTORY_SQL_MULTI_BATCH_SIZE	1000
+
+static int	history_request_compare_func(const void *d1, const void *d2)
+{
+	const zbx_history_request_t	*r1 = *(const zbx_history_request_t **)d1;
+	const zbx_history_request_t	*r2 = *(const zbx_history_request_t **)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(r1->end, r2->end);
+	ZBX_RETURN_IF_NOT_EQUAL(r1->start, r2->start);
+	ZBX_RETURN_IF_NOT_EQUAL(r1->itemid, r2->itemid);
+
+	return 0;
+}
+
+static int	history_request_compare_itemid_func(const void *d1, const void *d2)
+{
+	const zbx_history_request_t	*r1 = *(const zbx_history_request_t **)d1;
+	const zbx_history_request_t	*r2 = *(const zbx_history_request_t **)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(r1->itemid, r2->itemid);
+
+	return 0;
+}
+
+/*********************************************************************************
+ *                                                                               *
+ * Function: db_read_values_by_time_multi                                        *
+ *                                                                               *
+ * Purpose: reads history data of multiple items from database                   *
+ *                                                                               *
+ * Parameters:  value_type - [IN] the value type (see ITEM_VALUE_TYPE_* defs)    *
+ *              requests   - [IN/OUT] the read requests, sorted by end, start    *
+ *                                    and itemid                                 *
+ *              num        - [IN] the number of requests                         *
+ *                                                                               *
+ * Return value: SUCCEED - the history data were read successfully               *
+ *               FAIL - otherwise                                                *
+ *                                                                               *
+ * Comments: Values are read from ]<start>,<end>] interval of each request with  *
+ *           a single query. Requests with the same time range share one         *
+ *           itemid IN (...) condition.                                          *
+ *                                                                               *
+ *********************************************************************************/
+static int	db_read_values_by_time_multi(int value_type, zbx_history_request_t **requests, int num)
+{
+	char			*sql = NULL;
+	size_t	 		sql_alloc = 0, sql_offset = 0;
+	DB_RESULT		result;
+	DB_ROW			row;
+	zbx_vc_history_table_t	*table = &vc_history_tables[value_type];
+	zbx_vector_uint64_t	itemids;
+	zbx_vector_ptr_t	index;
+	zbx_history_request_t	request_local, *prequest_local = &request_local;
+	int			i, j, ret = FAIL;
+
+	zbx_vector_uint64_create(&itemids);
+	zbx_vector_ptr_create(&index);
+	zbx_vector_ptr_reserve(&index, (size_t)num);
+
+	zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, "select itemid,clock,ns,%s from %s where",
+			table->fields, table->name);
+
+	for (i = 0; i < num; i = j)
+	{
+		zbx_vector_uint64_clear(&itemids);
+
+		for (j = i; j < num && requests[i]->start == requests[j]->start && requests[i]->end == requests[j]->end;
+				j++)
+		{
+			zbx_vector_uint64_append(&itemids, requests[j]->itemid);
+			zbx_vector_ptr_append(&index, requests[j]);
+		}
+
+		if (0 != i)
+			zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, " or");
+
+		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, " (");
+		DBadd_condition_alloc(&sql, &sql_alloc, &sql_offset, "itemid", itemids.values, itemids.values_num);
+
+		if (ZBX_JAN_2038 == requests[i]->end)
+			zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, " and clock>%d)", requests[i]->start);
+		else
+		{
+			zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, " and clock>%d and clock<=%d)",
+					requests[i]->start, requests[i]->end);
+		}
+	}
+
+	result = DBselect("%s", sql);
+
+	zbx_free(sql);
+	zbx_vector_uint64_destroy(&itemids);
+
+	if (NULL == result)
+		goto out;
+
+	zbx_vector_ptr_sort(&index, history_request_compare_itemid_func);
+
+	while (NULL != (row = DBfetch(result)))
+	{
+		zbx_history_record_t	value;
+		zbx_history_request_t	*request;
+
+		ZBX_STR2UINT64(request_local.itemid, row[0]);
+
+		if (FAIL == (i = zbx_vector_ptr_bsearch(&index, prequest_local, history_request_compare_itemid_func)))
+			continue;
+
+		request = (zbx_history_request_t *)index.values[i];
+
+		value.timestamp.sec = atoi(row[1]);
+		value.timestamp.ns = atoi(row[2]);
+		table->rtov(&value.value, row + 3);
+
+		zbx_vector_history_record_append_ptr(&request->values, &value);
+	}
+	DBfree_result(result);
+
+	ret = SUCCEED;
+out:
+	zbx_vector_ptr_destroy(&index);
+
+	return ret;
+}
+
 /******************************************************************************************************************
  *                                                                                                                *
  * history interface support                                                                                      *
@@ -654,6 +832,42 @@ static int	sql_get_values(zbx_history_iface_t *hist, zbx_uint64_t itemid, int st
 	return db_read_values_by_time_and_count(itemid, hist->value_type, values, end - start, count, end);
 }
 
+/************************************************************************************
+ *                                                                                  *
+ * Function: sql_get_values_multi                                                   *
+ *                                                                                  *
+ * Purpose: gets history data of multiple items from history storage                *
+ *                                                                                  *
+ * Parameters:  hist     - [IN] the history storage interface                       *
+ *              requests - [IN/OUT] the read requests                               *
+ *                                                                                  *
+ * Return value: SUCCEED - the history data were read successfully                  *
+ *               FAIL - otherwise                                                   *
+ *                                                                                  *
+ * Comments: Requests are read with queries of up to                               *
+ *           ZBX_HISTORY_SQL_MULTI_BATCH_SIZE items regardless of their time        *
+ *           ranges. Requests with the same time range are grouped by the query.    *
+ *                                                                                  *
+ ************************************************************************************/
+static int	sql_get_values_multi(zbx_history_iface_t *hist, zbx_vector_ptr_t *requests)
+{
+	int			i, num, ret = SUCCEED;
+	zbx_history_request_t	**values;
+
+	zbx_vector_ptr_sort(requests, history_request_compare_func);
+	values = (zbx_history_request_t **)requests->values;
+
+	for (i = 0; i < requests->values_num && SUCCEED == ret; i += num)
+	{
+		if (ZBX_HISTORY_SQL_MULTI_BATCH_SIZE < (num = requests->values_num - i))
+			num = ZBX_HISTORY_SQL_MULTI_BATCH_SIZE;
+
+		ret = db_read_values_by_time_multi(hist->value_type, values + i, num);
+	}
+
+	return ret;
+}
+
 /************************************************************************************
  *                                                                                  *
  * Function: sql_add_values                                                         *
@@ -728,6 +942,7 @@ int	zbx_history_sql_init(zbx_history_iface_t *hist, unsigned char value_type, ch
 	hist->add_values = sql_add_values;
 	hist->flush = sql_flush;
 	hist->get_values = sql_get_values;
+	hist->get_values_multi = sql_get_values_multi;
 
 	switch (value_type)
 	{
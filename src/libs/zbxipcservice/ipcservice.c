@@ -1324,6 +1324,51 @@ out:
 	return ret;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_ipc_socket_wait                                              *
+ *                                                                            *
+ * Purpose: waits for a message from IPC service                              *
+ *                                                                            *
+ * Parameters: csocket - [IN] an opened IPC socket to the service             *
+ *             timeout - [IN] the maximum time to wait in seconds             *
+ *                                                                            *
+ * Return value: SUCCEED       - there is incoming data to read               *
+ *               TIMEOUT_ERROR - no data was received within timeout          *
+ *               FAIL          - an error occurred                            *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_ipc_socket_wait(zbx_ipc_socket_t *csocket, int timeout)
+{
+	fd_set		fdset;
+	struct timeval	tv;
+	int		rc;
+
+	/* data left in buffer after the previous read can be read without waiting */
+	if (csocket->rx_buffer_bytes > csocket->rx_buffer_offset)
+		return SUCCEED;
+
+	tv.tv_sec = timeout;
+	tv.tv_usec = 0;
+
+	while (1)
+	{
+		FD_ZERO(&fdset);
+		FD_SET(csocket->fd, &fdset);
+
+		if (-1 != (rc = select(csocket->fd + 1, &fdset, NULL, NULL, &tv)))
+			break;
+
+		if (EINTR != errno)
+		{
+			zabbix_log(LOG_LEVEL_CRIT, "cannot wait for IPC service message: %s", zbx_strerror(errno));
+			return FAIL;
+		}
+	}
+
+	return 0 == rc ? TIMEOUT_ERROR : SUCCEED;
+}
+
 /******************************************************************************
  *                                                                            *
  * Function: zbx_ipc_message_free                                             *
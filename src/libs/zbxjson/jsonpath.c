@@ -2471,6 +2471,136 @@ int	zbx_jsonpath_compile(const char *path, zbx_jsonpath_t *jsonpath)
 	return ret;
 }
 
+/* compiled jsonpath cache entry */
+typedef struct
+{
+	char		*path;
+	zbx_jsonpath_t	jsonpath;
+	zbx_uint64_t	lastaccess;
+	int		refcount;
+}
+zbx_jsonpath_cache_entry_t;
+
+#define ZBX_JSONPATH_CACHE_MAX	256	/* max number of compiled jsonpaths kept by a process or thread */
+
+static ZBX_THREAD_LOCAL zbx_hashset_t	jsonpath_cache;
+static ZBX_THREAD_LOCAL zbx_uint64_t	jsonpath_cache_clock;
+
+static zbx_hash_t	jsonpath_cache_hash_func(const void *data)
+{
+	const zbx_jsonpath_cache_entry_t	*entry = (const zbx_jsonpath_cache_entry_t *)data;
+
+	return ZBX_DEFAULT_STRING_HASH_FUNC(entry->path);
+}
+
+static int	jsonpath_cache_compare_func(const void *d1, const void *d2)
+{
+	const zbx_jsonpath_cache_entry_t	*e1 = (const zbx_jsonpath_cache_entry_t *)d1;
+	const zbx_jsonpath_cache_entry_t	*e2 = (const zbx_jsonpath_cache_entry_t *)d2;
+
+	return strcmp(e1->path, e2->path);
+}
+
+static void	jsonpath_cache_clean_func(void *data)
+{
+	zbx_jsonpath_cache_entry_t	*entry = (zbx_jsonpath_cache_entry_t *)data;
+
+	zbx_jsonpath_clear(&entry->jsonpath);
+	zbx_free(entry->path);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: jsonpath_cache_evict                                             *
+ *                                                                            *
+ * Purpose: removes the least recently used jsonpath that is not being used   *
+ *          by queries in progress from cache                                 *
+ *                                                                            *
+ ******************************************************************************/
+static void	jsonpath_cache_evict(void)
+{
+	zbx_hashset_iter_t		iter;
+	zbx_jsonpath_cache_entry_t	*entry, *entry_lru = NULL;
+
+	zbx_hashset_iter_reset(&jsonpath_cache, &iter);
+
+	while (NULL != (entry = (zbx_jsonpath_cache_entry_t *)zbx_hashset_iter_next(&iter)))
+	{
+		if (0 != entry->refcount)
+			continue;
+
+		if (NULL == entry_lru || entry->lastaccess < entry_lru->lastaccess)
+			entry_lru = entry;
+	}
+
+	if (NULL != entry_lru)
+		zbx_hashset_remove_direct(&jsonpath_cache, entry_lru);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_jsonpath_cache_acquire                                       *
+ *                                                                            *
+ * Purpose: get compiled jsonpath from cache, compiling it if necessary       *
+ *                                                                            *
+ * Parameters: path - [IN] the jsonpath                                       *
+ *                                                                            *
+ * Return value: the compiled jsonpath or NULL if path compilation failed     *
+ *                                                                            *
+ * Comments: The returned jsonpath is owned by cache and must be released     *
+ *           with zbx_jsonpath_cache_release() after use. Nested queries can  *
+ *           acquire other jsonpaths meanwhile - jsonpaths in use are never   *
+ *           evicted. Jsonpaths that failed to compile are not cached.        *
+ *                                                                            *
+ ******************************************************************************/
+zbx_jsonpath_t	*zbx_jsonpath_cache_acquire(const char *path)
+{
+	zbx_jsonpath_cache_entry_t	entry_local, *entry;
+
+	if (0 == jsonpath_cache.num_slots)
+	{
+		zbx_hashset_create_ext(&jsonpath_cache, 0, jsonpath_cache_hash_func, jsonpath_cache_compare_func,
+				jsonpath_cache_clean_func, ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC,
+				ZBX_DEFAULT_MEM_FREE_FUNC);
+	}
+
+	entry_local.path = (char *)path;
+
+	if (NULL == (entry = (zbx_jsonpath_cache_entry_t *)zbx_hashset_search(&jsonpath_cache, &entry_local)))
+	{
+		if (FAIL == zbx_jsonpath_compile(path, &entry_local.jsonpath))
+			return NULL;
+
+		if (ZBX_JSONPATH_CACHE_MAX <= jsonpath_cache.num_data)
+			jsonpath_cache_evict();
+
+		entry_local.path = zbx_strdup(NULL, path);
+		entry_local.refcount = 0;
+		entry = (zbx_jsonpath_cache_entry_t *)zbx_hashset_insert(&jsonpath_cache, &entry_local,
+				sizeof(entry_local));
+	}
+
+	entry->lastaccess = ++jsonpath_cache_clock;
+	entry->refcount++;
+
+	return &entry->jsonpath;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_jsonpath_cache_release                                       *
+ *                                                                            *
+ * Purpose: release jsonpath acquired with zbx_jsonpath_cache_acquire()       *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_jsonpath_cache_release(zbx_jsonpath_t *jsonpath)
+{
+	zbx_jsonpath_cache_entry_t	*entry;
+
+	entry = (zbx_jsonpath_cache_entry_t *)((char *)jsonpath - offsetof(zbx_jsonpath_cache_entry_t, jsonpath));
+	entry->refcount--;
+}
+
 /******************************************************************************
  *                                                                            *
  * Function: zbx_jsonpath_query                                               *
@@ -2488,34 +2618,34 @@ int	zbx_jsonpath_compile(const char *path, zbx_jsonpath_t *jsonpath)
  ******************************************************************************/
 int	zbx_jsonpath_query(const struct zbx_json_parse *jp, const char *path, char **output)
 {
-	zbx_jsonpath_t		jsonpath;
+	zbx_jsonpath_t		*jsonpath;
 	int			path_depth = 0, ret = SUCCEED;
 	zbx_vector_str_t	objects;
 
-	if (FAIL == zbx_jsonpath_compile(path, &jsonpath))
+	if (NULL == (jsonpath = zbx_jsonpath_cache_acquire(path)))
 		return FAIL;
 
 	zbx_vector_str_create(&objects);
 
 	if ('{' == *jp->start)
-		ret = jsonpath_query_object(jp, jp, &jsonpath, path_depth, &objects);
+		ret = jsonpath_query_object(jp, jp, jsonpath, path_depth, &objects);
 	else if ('[' == *jp->start)
-		ret = jsonpath_query_array(jp, jp, &jsonpath, path_depth, &objects);
+		ret = jsonpath_query_array(jp, jp, jsonpath, path_depth, &objects);
 
 	if (SUCCEED == ret)
 	{
-		path_depth = jsonpath.segments_num;
-		while (0 < path_depth && ZBX_JSONPATH_SEGMENT_FUNCTION == jsonpath.segments[path_depth - 1].type)
+		path_depth = jsonpath->segments_num;
+		while (0 < path_depth && ZBX_JSONPATH_SEGMENT_FUNCTION == jsonpath->segments[path_depth - 1].type)
 			path_depth--;
 
-		if (path_depth < jsonpath.segments_num)
-			ret = jsonpath_apply_functions(jp, &objects, &jsonpath, path_depth, output);
+		if (path_depth < jsonpath->segments_num)
+			ret = jsonpath_apply_functions(jp, &objects, jsonpath, path_depth, output);
 		else
-			ret = jsonpath_format_query_result(&objects, &jsonpath, output);
+			ret = jsonpath_format_query_result(&objects, jsonpath, output);
 	}
 
 	zbx_vector_str_destroy(&objects);
-	zbx_jsonpath_clear(&jsonpath);
+	zbx_jsonpath_cache_release(jsonpath);
 
 	return ret;
 }
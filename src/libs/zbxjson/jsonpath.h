@@ -155,5 +155,7 @@ typedef struct
 }
 zbx_jsonpath_token_t;
 
+zbx_jsonpath_t	*zbx_jsonpath_cache_acquire(const char *path);
+void		zbx_jsonpath_cache_release(zbx_jsonpath_t *jsonpath);
 
 #endif
@@ -106,6 +106,54 @@ static int	parse_log_level_options(const char *opt, size_t len, unsigned int *sc
 	return SUCCEED;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: parse_diaginfo_options                                           *
+ *                                                                            *
+ * Purpose: parse diagnostic information section option                       *
+ *                                                                            *
+ * Parameters: opt  - [IN] the command line argument                          *
+ *             len  - [IN] the runtime control option length                  *
+ *             data - [OUT] the diagnostic section flags                      *
+ *                                                                            *
+ * Return value: SUCCEED - the option was parsed successfully                 *
+ *               FAIL    - an error occurred                                  *
+ *                                                                            *
+ ******************************************************************************/
+static int	parse_diaginfo_options(const char *opt, size_t len, unsigned int *data)
+{
+	const char	*rtc_options;
+
+	rtc_options = opt + len;
+
+	if ('\0' == *rtc_options)
+	{
+		*data = ZBX_DIAGINFO_SECTION_ALL;
+		return SUCCEED;
+	}
+
+	if ('=' == *rtc_options++)
+	{
+		if (0 == strcmp(rtc_options, ZBX_DIAGINFO_VALUECACHE))
+		{
+			*data = ZBX_DIAGINFO_SECTION_VALUECACHE;
+			return SUCCEED;
+		}
+
+		if (0 == strcmp(rtc_options, ZBX_DIAGINFO_PREPROCESSING))
+		{
+			*data = ZBX_DIAGINFO_SECTION_PREPROCESSING;
+			return SUCCEED;
+		}
+
+		zbx_error("invalid diaginfo section: %s", rtc_options);
+		return FAIL;
+	}
+
+	zbx_error("invalid runtime control option: %s", opt);
+	return FAIL;
+}
+
 /******************************************************************************
  *                                                                            *
  * Function: parse_rtc_options                                                *
@@ -154,6 +202,15 @@ int	parse_rtc_options(const char *opt, unsigned char program_type, int *message)
 		scope = 0;
 		data = 0;
 	}
+	else if (0 != (program_type & ZBX_PROGRAM_TYPE_SERVER) &&
+			0 == strncmp(opt, ZBX_DIAGINFO, ZBX_CONST_STRLEN(ZBX_DIAGINFO)))
+	{
+		command = ZBX_RTC_DIAGINFO;
+		scope = 0;
+
+		if (SUCCEED != parse_diaginfo_options(opt, ZBX_CONST_STRLEN(ZBX_DIAGINFO), &data))
+			return FAIL;
+	}
 	else
 	{
 		zbx_error("invalid runtime control option: %s", opt);
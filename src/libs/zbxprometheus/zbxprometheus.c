@@ -84,6 +84,23 @@ typedef struct
 }
 zbx_prometheus_row_t;
 
+/* the prometheus data row parsed into reusable buffer */
+typedef struct
+{
+	/* metric name, metric value, raw row and label names and values separated by '\0' */
+	char			*data;
+	size_t			data_alloc;
+	size_t			data_offset;
+
+	/* metric value and raw row offsets in data, metric name is at the beginning */
+	size_t			value;
+	size_t			raw;
+
+	/* label name offsets in data, label value follows the label name */
+	zbx_vector_uint64_t	labels;
+}
+zbx_prometheus_row_buf_t;
+
 /* the prometheus metric HELP, TYPE hints in comments */
 typedef struct
 {
@@ -93,6 +110,14 @@ typedef struct
 }
 zbx_prometheus_hint_t;
 
+/* the prometheus data rows with the same metric name */
+typedef struct
+{
+	const char		*metric;
+	zbx_vector_ptr_t	rows;
+}
+zbx_prometheus_index_t;
+
 /* TYPE, HELP hint hashset support */
 
 static zbx_hash_t	prometheus_hint_hash(const void *d)
@@ -110,6 +135,30 @@ static int	prometheus_hint_compare(const void *d1, const void *d2)
 	return strcmp(hint1->metric, hint2->metric);
 }
 
+/* metric index hashset support */
+
+static zbx_hash_t	prometheus_index_hash(const void *d)
+{
+	const zbx_prometheus_index_t	*index = (const zbx_prometheus_index_t *)d;
+
+	return ZBX_DEFAULT_STRING_HASH_FUNC(index->metric);
+}
+
+static int	prometheus_index_compare(const void *d1, const void *d2)
+{
+	const zbx_prometheus_index_t	*index1 = (const zbx_prometheus_index_t *)d1;
+	const zbx_prometheus_index_t	*index2 = (const zbx_prometheus_index_t *)d2;
+
+	return strcmp(index1->metric, index2->metric);
+}
+
+static void	prometheus_index_clean(void *d)
+{
+	zbx_prometheus_index_t	*index = (zbx_prometheus_index_t *)d;
+
+	zbx_vector_ptr_destroy(&index->rows);
+}
+
 /******************************************************************************
  *                                                                            *
  * Function: str_loc_dup                                                      *
@@ -869,6 +918,140 @@ static void	prometheus_row_free(zbx_prometheus_row_t *row)
 	zbx_free(row);
 }
 
+/*
+ * Row buffer is reused between parsed rows, so rows can be parsed and
+ * processed one by one without allocating row objects.
+ */
+
+static void	prometheus_row_buf_init(zbx_prometheus_row_buf_t *row)
+{
+	memset(row, 0, sizeof(zbx_prometheus_row_buf_t));
+	zbx_vector_uint64_create(&row->labels);
+}
+
+static void	prometheus_row_buf_clear(zbx_prometheus_row_buf_t *row)
+{
+	zbx_free(row->data);
+	zbx_vector_uint64_destroy(&row->labels);
+}
+
+static void	prometheus_row_buf_reset(zbx_prometheus_row_buf_t *row)
+{
+	row->data_offset = 0;
+	zbx_vector_uint64_clear(&row->labels);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: prometheus_row_buf_add                                           *
+ *                                                                            *
+ * Purpose: copies substring at the specified location into row buffer        *
+ *                                                                            *
+ * Parameters: row - [IN/OUT] the row buffer                                  *
+ *             src - [IN] the source string                                   *
+ *             loc - [IN] the substring location                              *
+ *                                                                            *
+ * Return value: The offset of copied substring in row buffer.                *
+ *                                                                            *
+ ******************************************************************************/
+static size_t	prometheus_row_buf_add(zbx_prometheus_row_buf_t *row, const char *src, const zbx_strloc_t *loc)
+{
+	size_t	offset = row->data_offset;
+
+	zbx_strncpy_alloc(&row->data, &row->data_alloc, &row->data_offset, src + loc->l, loc->r - loc->l + 1);
+
+	/* keep the terminating zero */
+	row->data_offset++;
+
+	return offset;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: prometheus_row_buf_add_unquoted                                  *
+ *                                                                            *
+ * Purpose: copies unquoted substring at the specified location into row      *
+ *          buffer                                                            *
+ *                                                                            *
+ * Parameters: row - [IN/OUT] the row buffer                                  *
+ *             src - [IN] the source string                                   *
+ *             loc - [IN] the quoted substring location                       *
+ *                                                                            *
+ * Return value: The offset of unquoted substring in row buffer.              *
+ *                                                                            *
+ ******************************************************************************/
+static size_t	prometheus_row_buf_add_unquoted(zbx_prometheus_row_buf_t *row, const char *src,
+		const zbx_strloc_t *loc)
+{
+	size_t	offset;
+	char	*pin, *pout;
+
+	offset = prometheus_row_buf_add(row, src, loc);
+
+	/* unquote in place, the unquoted string is never longer than quoted */
+	for (pout = row->data + offset, pin = pout + 1; '"' != *pin; pin++)
+	{
+		if ('\\' == *pin)
+		{
+			switch (*(++pin))
+			{
+				case '\\':
+					*pout++ = '\\';
+					break;
+				case 'n':
+					*pout++ = '\n';
+					break;
+				case '"':
+					*pout++ = '"';
+					break;
+			}
+		}
+		else
+			*pout++ = *pin;
+	}
+	*pout++ = '\0';
+
+	row->data_offset = pout - row->data;
+
+	return offset;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: prometheus_row_create                                            *
+ *                                                                            *
+ * Purpose: creates row object from the parsed row buffer                     *
+ *                                                                            *
+ * Parameters: row - [IN] the row buffer                                      *
+ *                                                                            *
+ * Return value: The created row.                                             *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_prometheus_row_t	*prometheus_row_create(const zbx_prometheus_row_buf_t *row)
+{
+	zbx_prometheus_row_t	*prow;
+	zbx_prometheus_label_t	*label;
+	int			i;
+
+	prow = (zbx_prometheus_row_t *)zbx_malloc(NULL, sizeof(zbx_prometheus_row_t));
+	prow->metric = zbx_strdup(NULL, row->data);
+	prow->value = zbx_strdup(NULL, row->data + row->value);
+	prow->raw = zbx_strdup(NULL, row->data + row->raw);
+	zbx_vector_ptr_create(&prow->labels);
+
+	for (i = 0; i < row->labels.values_num; i++)
+	{
+		const char	*name = row->data + row->labels.values[i];
+
+		label = (zbx_prometheus_label_t *)zbx_malloc(NULL, sizeof(zbx_prometheus_label_t));
+		label->name = zbx_strdup(NULL, name);
+		label->value = zbx_strdup(NULL, name + strlen(name) + 1);
+		zbx_vector_ptr_append(&prow->labels, label);
+	}
+
+	return prow;
+}
+
 /******************************************************************************
  *                                                                            *
  * Function: condition_match_key_value                                        *
@@ -949,6 +1132,49 @@ static int	condition_match_metric_value(const char *pattern, const char *value)
 	return SUCCEED;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: prometheus_row_match                                             *
+ *                                                                            *
+ * Purpose: matches parsed row against filter conditions                      *
+ *                                                                            *
+ * Parameters: filter - [IN] the prometheus filter                            *
+ *             row    - [IN] the parsed row                                   *
+ *                                                                            *
+ * Return value: SUCCEED - the row matches all filter conditions              *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	prometheus_row_match(const zbx_prometheus_filter_t *filter, const zbx_prometheus_row_t *row)
+{
+	int	i, j;
+
+	if (NULL != filter->metric && SUCCEED != condition_match_key_value(filter->metric, NULL, row->metric))
+		return FAIL;
+
+	for (i = 0; i < filter->labels.values_num; i++)
+	{
+		const zbx_prometheus_condition_t	*condition = filter->labels.values[i];
+
+		for (j = 0; j < row->labels.values_num; j++)
+		{
+			const zbx_prometheus_label_t	*label = row->labels.values[j];
+
+			if (SUCCEED == condition_match_key_value(condition, label->name, label->value))
+				break;
+		}
+
+		/* no matching labels */
+		if (j == row->labels.values_num)
+			return FAIL;
+	}
+
+	if (NULL != filter->value && SUCCEED != condition_match_metric_value(filter->value->pattern, row->value))
+		return FAIL;
+
+	return SUCCEED;
+}
+
 /******************************************************************************
  *                                                                            *
  * Function: prometheus_metric_parse_labels                                   *
@@ -957,7 +1183,7 @@ static int	condition_match_metric_value(const char *pattern, const char *value)
  *                                                                            *
  * Parameters: data   - [IN] the metric data                                  *
  *             pos    - [IN] the starting position in metric data             *
- *             labels - [OUT] the parsed labels                               *
+ *             row    - [IN/OUT] the row buffer to store parsed labels        *
  *             loc    - [OUT] the location of label block                     *
  *             error  - [OUT] the error message                               *
  *                                                                            *
@@ -965,11 +1191,10 @@ static int	condition_match_metric_value(const char *pattern, const char *value)
  *               FAIL    - otherwise                                          *
  *                                                                            *
  ******************************************************************************/
-static int	prometheus_metric_parse_labels(const char *data, size_t pos, zbx_vector_ptr_t *labels,
+static int	prometheus_metric_parse_labels(const char *data, size_t pos, zbx_prometheus_row_buf_t *row,
 		zbx_strloc_t *loc, char **error)
 {
-	zbx_strloc_t		loc_key, loc_value, loc_op;
-	zbx_prometheus_label_t	*label;
+	zbx_strloc_t	loc_key, loc_value, loc_op;
 
 	pos = skip_spaces(data, pos + 1);
 	loc->l = pos;
@@ -991,10 +1216,8 @@ static int	prometheus_metric_parse_labels(const char *data, size_t pos, zbx_vect
 			return FAIL;
 		}
 
-		label = (zbx_prometheus_label_t *)zbx_malloc(NULL, sizeof(zbx_prometheus_label_t));
-		label->name = str_loc_dup(data, &loc_key);
-		label->value = str_loc_unquote_dyn(data, &loc_value);
-		zbx_vector_ptr_append(labels, label);
+		zbx_vector_uint64_append(&row->labels, prometheus_row_buf_add(row, data, &loc_key));
+		prometheus_row_buf_add_unquoted(row, data, &loc_value);
 
 		pos = skip_spaces(data, loc_value.r + 1);
 
@@ -1017,14 +1240,16 @@ static int	prometheus_metric_parse_labels(const char *data, size_t pos, zbx_vect
 
 /******************************************************************************
  *                                                                            *
- * Function: prometheus_parse_row                                             *
+ * Function: prometheus_parse_row_buf                                         *
  *                                                                            *
- * Purpose: parses metric row                                                 *
+ * Purpose: parses metric row into row buffer                                 *
  *                                                                            *
  * Parameters: filter  - [IN] the prometheus filter                           *
  *             data    - [IN] the metric data                                 *
  *             pos     - [IN] the starting position in metric data            *
- *             prow    - [OUT] the parsed row (NULL if did not match filter)  *
+ *             row     - [OUT] the parsed row                                 *
+ *             match   - [OUT] SUCCEED - the row matches filter               *
+ *                             FAIL    - otherwise                            *
  *             loc_row - [OUT] the location of row in prometheus data         *
  *             error   - [OUT] the error message                              *
  *                                                                            *
@@ -1032,21 +1257,19 @@ static int	prometheus_metric_parse_labels(const char *data, size_t pos, zbx_vect
  *               FAIL    - otherwise                                          *
  *                                                                            *
  * Comments: If there was no parsing errors, but the row does not match filter*
- *           conditions then success with NULL prow is be returned.           *
+ *           conditions then success with FAIL match is be returned.          *
  *                                                                            *
  ******************************************************************************/
-static int	prometheus_parse_row(zbx_prometheus_filter_t *filter, const char *data, size_t pos,
-		zbx_prometheus_row_t **prow, zbx_strloc_t *loc_row, char **error)
+static int	prometheus_parse_row_buf(zbx_prometheus_filter_t *filter, const char *data, size_t pos,
+		zbx_prometheus_row_buf_t *row, int *match, zbx_strloc_t *loc_row, char **error)
 {
-	zbx_strloc_t		loc;
-	zbx_prometheus_row_t	*row;
-	int			ret = FAIL, match = SUCCEED, i, j;
+	zbx_strloc_t	loc;
+	int		ret = FAIL, i, j;
 
 	loc_row->l = pos;
+	*match = SUCCEED;
 
-	row = (zbx_prometheus_row_t *)zbx_malloc(NULL, sizeof(zbx_prometheus_row_t));
-	memset(row, 0, sizeof(zbx_prometheus_row_t));
-	zbx_vector_ptr_create(&row->labels);
+	prometheus_row_buf_reset(row);
 
 	/* parse metric and check against the filter */
 
@@ -1056,11 +1279,11 @@ static int	prometheus_parse_row(zbx_prometheus_filter_t *filter, const char *dat
 		goto out;
 	}
 
-	row->metric = str_loc_dup(data, &loc);
+	prometheus_row_buf_add(row, data, &loc);
 
 	if (NULL != filter->metric)
 	{
-		if (FAIL == (match = condition_match_key_value(filter->metric, NULL, row->metric)))
+		if (FAIL == (*match = condition_match_key_value(filter->metric, NULL, row->data)))
 			goto out;
 	}
 
@@ -1070,7 +1293,7 @@ static int	prometheus_parse_row(zbx_prometheus_filter_t *filter, const char *dat
 
 	if ('{' == data[pos])
 	{
-		if (SUCCEED != prometheus_metric_parse_labels(data, pos, &row->labels, &loc, error))
+		if (SUCCEED != prometheus_metric_parse_labels(data, pos, row, &loc, error))
 			goto out;
 
 		for (i = 0; i < filter->labels.values_num; i++)
@@ -1079,16 +1302,16 @@ static int	prometheus_parse_row(zbx_prometheus_filter_t *filter, const char *dat
 
 			for (j = 0; j < row->labels.values_num; j++)
 			{
-				zbx_prometheus_label_t	*label = row->labels.values[j];
+				const char	*name = row->data + row->labels.values[j];
 
-				if (SUCCEED == condition_match_key_value(condition, label->name, label->value))
+				if (SUCCEED == condition_match_key_value(condition, name, name + strlen(name) + 1))
 					break;
 			}
 
 			if (j == row->labels.values_num)
 			{
 				/* no matching labels */
-				match = FAIL;
+				*match = FAIL;
 				goto out;
 			}
 		}
@@ -1118,11 +1341,11 @@ static int	prometheus_parse_row(zbx_prometheus_filter_t *filter, const char *dat
 		*error = zbx_strdup(*error, "cannot parse metric value");
 		goto out;
 	}
-	row->value = str_loc_dup(data, &loc);
+	row->value = prometheus_row_buf_add(row, data, &loc);
 
 	if (NULL != filter->value)
 	{
-		if (SUCCEED != (match = condition_match_metric_value(filter->value->pattern, row->value)))
+		if (SUCCEED != (*match = condition_match_metric_value(filter->value->pattern, row->data + row->value)))
 			goto out;
 	}
 
@@ -1137,17 +1360,9 @@ static int	prometheus_parse_row(zbx_prometheus_filter_t *filter, const char *dat
 	/* row was successfully parsed and matched all filter conditions */
 	ret = SUCCEED;
 out:
-	if (FAIL == ret)
-	{
-		prometheus_row_free(row);
-		*prow = NULL;
-
-		/* match failure, return success with NULL row */
-		if (FAIL == match)
-			ret = SUCCEED;
-	}
-	else
-		*prow = row;
+	/* match failure, return success */
+	if (FAIL == *match)
+		ret = SUCCEED;
 
 	if (SUCCEED == ret)
 	{
@@ -1158,11 +1373,51 @@ out:
 			pos--;
 
 		loc_row->r = pos;
+
+		if (SUCCEED == *match)
+			row->raw = prometheus_row_buf_add(row, data, loc_row);
 	}
 
 	return ret;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: prometheus_parse_row                                             *
+ *                                                                            *
+ * Purpose: parses metric row                                                 *
+ *                                                                            *
+ * Parameters: filter  - [IN] the prometheus filter                           *
+ *             data    - [IN] the metric data                                 *
+ *             pos     - [IN] the starting position in metric data            *
+ *             row     - [IN/OUT] the row buffer used for parsing             *
+ *             prow    - [OUT] the parsed row (NULL if did not match filter)  *
+ *             loc_row - [OUT] the location of row in prometheus data         *
+ *             error   - [OUT] the error message                              *
+ *                                                                            *
+ * Return value: SUCCEED - the row was parsed successfully                    *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: If there was no parsing errors, but the row does not match filter*
+ *           conditions then success with NULL prow is be returned.           *
+ *                                                                            *
+ ******************************************************************************/
+static int	prometheus_parse_row(zbx_prometheus_filter_t *filter, const char *data, size_t pos,
+		zbx_prometheus_row_buf_t *row, zbx_prometheus_row_t **prow, zbx_strloc_t *loc_row, char **error)
+{
+	int	match;
+
+	*prow = NULL;
+
+	if (SUCCEED != prometheus_parse_row_buf(filter, data, pos, row, &match, loc_row, error))
+		return FAIL;
+
+	if (SUCCEED == match)
+		*prow = prometheus_row_create(row);
+
+	return SUCCEED;
+}
+
 /******************************************************************************
  *                                                                            *
  * Function: parse_help                                                       *
@@ -1375,6 +1630,40 @@ static int	prometheus_parse_hint(zbx_prometheus_filter_t *filter, const char *da
 	return prometheus_register_hint(hints, data, metric, &loc_hint, hint_type, error);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: prometheus_format_row_error                                      *
+ *                                                                            *
+ * Purpose: formats row parsing error message                                 *
+ *                                                                            *
+ * Parameters: data    - [IN] the metric data                                 *
+ *             pos     - [IN] the position of failed row in metric data       *
+ *             row_num - [IN] the failed row number                           *
+ *             errmsg  - [IN] the row parsing error message                   *
+ *             error   - [OUT] the error message                              *
+ *                                                                            *
+ ******************************************************************************/
+static void	prometheus_format_row_error(const char *data, size_t pos, int row_num, const char *errmsg,
+		char **error)
+{
+	const char	*ptr, *suffix = "";
+	int		len;
+
+	if (NULL != (ptr = strchr(data + pos, '\n')))
+		len = ptr - data - pos;
+	else
+		len = strlen(data + pos);
+
+	if (ZBX_PROMEHTEUS_ERROR_MAX_ROW_LENGTH < len)
+	{
+		len = ZBX_PROMEHTEUS_ERROR_MAX_ROW_LENGTH;
+		suffix = "...";
+	}
+
+	*error = zbx_dsprintf(*error, "data parsing error at row %d \"%.*s%s\": %s", row_num, len, data + pos,
+			suffix, errmsg);
+}
+
 /******************************************************************************
  *                                                                            *
  * Function: prometheus_parse_rows                                            *
@@ -1384,7 +1673,6 @@ static int	prometheus_parse_hint(zbx_prometheus_filter_t *filter, const char *da
  * Parameters: filter  - [IN] the prometheus filter                           *
  *             data    - [IN] the metric data                                 *
  *             rows    - [OUT] the parsed rows                                *
- *             hints   - [OUT] the TYPE/HELP hint registry (optional)         *
  *             error   - [OUT] the error message                              *
  *                                                                            *
  * Return value: SUCCEED - the rows were parsed successfully                  *
@@ -1392,43 +1680,32 @@ static int	prometheus_parse_hint(zbx_prometheus_filter_t *filter, const char *da
  *                                                                            *
  ******************************************************************************/
 static int	prometheus_parse_rows(zbx_prometheus_filter_t *filter, const char *data, zbx_vector_ptr_t *rows,
-		zbx_hashset_t *hints, char **error)
+		char **error)
 {
-	size_t			pos = 0;
-	int			row_num = 1, ret = FAIL;
-	zbx_prometheus_row_t	*row;
-	char			*errmsg = NULL;
-	zbx_strloc_t		loc;
+	size_t				pos = 0;
+	int				row_num = 1, ret = FAIL;
+	zbx_prometheus_row_t		*prow;
+	zbx_prometheus_row_buf_t	row;
+	char				*errmsg = NULL;
+	zbx_strloc_t			loc;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
+	prometheus_row_buf_init(&row);
+
 	for (pos = 0; '\0' != data[pos]; pos = skip_row(data, pos), row_num++)
 	{
 		pos = skip_spaces(data, pos);
 
-		/* skip empty strings */
-		if ('\n' == data[pos])
+		/* skip empty strings and comments */
+		if ('\n' == data[pos] || '#' == data[pos])
 			continue;
 
-		if ('#' == data[pos])
-		{
-			if (NULL != hints)
-			{
-				if (SUCCEED != prometheus_parse_hint(filter, data, pos, hints, &loc, &errmsg))
-					goto out;
-				pos = loc.r + 1;
-			}
-			continue;
-		}
-
-		if (SUCCEED != prometheus_parse_row(filter, data, pos, &row, &loc, &errmsg))
+		if (SUCCEED != prometheus_parse_row(filter, data, pos, &row, &prow, &loc, &errmsg))
 			goto out;
 
-		if (NULL != row)
-		{
-			row->raw = str_loc_dup(data, &loc);
-			zbx_vector_ptr_append(rows, row);
-		}
+		if (NULL != prow)
+			zbx_vector_ptr_append(rows, prow);
 
 		pos = loc.r + 1;
 	}
@@ -1437,26 +1714,65 @@ static int	prometheus_parse_rows(zbx_prometheus_filter_t *filter, const char *da
 out:
 	if (SUCCEED != ret)
 	{
-		const char	*ptr, *suffix = "";
-		int		len;
+		prometheus_format_row_error(data, pos, row_num, errmsg, error);
+		zbx_free(errmsg);
+	}
 
-		if (NULL != (ptr = strchr(data + pos, '\n')))
-			len = ptr - data - pos;
-		else
-			len = strlen(data + pos);
+	prometheus_row_buf_clear(&row);
 
-		if (ZBX_PROMEHTEUS_ERROR_MAX_ROW_LENGTH < len)
-		{
-			len = ZBX_PROMEHTEUS_ERROR_MAX_ROW_LENGTH;
-			suffix = "...";
-		}
-		*error = zbx_dsprintf(*error, "data parsing error at row %d \"%.*s%s\": %s", row_num, len, data + pos,
-				suffix, errmsg);
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s rows:%d", __func__, zbx_result_string(ret), rows->values_num);
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: prometheus_parse_hints                                           *
+ *                                                                            *
+ * Purpose: parses TYPE/HELP hints from prometheus data                       *
+ *                                                                            *
+ * Parameters: filter  - [IN] the prometheus filter                           *
+ *             data    - [IN] the metric data                                 *
+ *             hints   - [OUT] the TYPE/HELP hint registry                    *
+ *             error   - [OUT] the error message                              *
+ *                                                                            *
+ * Return value: SUCCEED - the hints were parsed successfully                 *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: Only comment rows are parsed, metric rows are skipped.           *
+ *                                                                            *
+ ******************************************************************************/
+static int	prometheus_parse_hints(zbx_prometheus_filter_t *filter, const char *data, zbx_hashset_t *hints,
+		char **error)
+{
+	size_t		pos = 0;
+	int		row_num = 1, ret = FAIL;
+	char		*errmsg = NULL;
+	zbx_strloc_t	loc;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
+
+	for (pos = 0; '\0' != data[pos]; pos = skip_row(data, pos), row_num++)
+	{
+		pos = skip_spaces(data, pos);
+
+		if ('#' != data[pos])
+			continue;
+
+		if (SUCCEED != prometheus_parse_hint(filter, data, pos, hints, &loc, &errmsg))
+			goto out;
+
+		pos = loc.r + 1;
+	}
+
+	ret = SUCCEED;
+out:
+	if (SUCCEED != ret)
+	{
+		prometheus_format_row_error(data, pos, row_num, errmsg, error);
 		zbx_free(errmsg);
 	}
 
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s rows:%d hints:%d", __func__, zbx_result_string(ret),
-			rows->values_num, (NULL == hints ? 0 : hints->num_data));
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s hints:%d", __func__, zbx_result_string(ret), hints->num_data);
 	return ret;
 }
 
@@ -1576,7 +1892,7 @@ int	zbx_prometheus_pattern(const char *data, const char *filter_data, const char
 
 	zbx_vector_ptr_create(&rows);
 
-	if (FAIL == prometheus_parse_rows(&filter, data, &rows, NULL, error))
+	if (FAIL == prometheus_parse_rows(&filter, data, &rows, error))
 		goto cleanup;
 
 	if (FAIL == prometheus_extract_value(&rows, output, value, &errmsg))
@@ -1597,6 +1913,55 @@ out:
 	return ret;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: prometheus_row_to_json                                           *
+ *                                                                            *
+ * Purpose: writes parsed row to json                                         *
+ *                                                                            *
+ * Parameters: row   - [IN] the parsed row                                    *
+ *             hints - [IN] the TYPE/HELP hint registry                       *
+ *             json  - [IN/OUT] the output json                               *
+ *                                                                            *
+ ******************************************************************************/
+static void	prometheus_row_to_json(const zbx_prometheus_row_buf_t *row, zbx_hashset_t *hints,
+		struct zbx_json *json)
+{
+	zbx_prometheus_hint_t	*hint, hint_local;
+	const char		*hint_type;
+	int			i;
+
+	zbx_json_addobject(json, NULL);
+	zbx_json_addstring(json, ZBX_PROTO_TAG_NAME, row->data, ZBX_JSON_TYPE_STRING);
+	zbx_json_addstring(json, ZBX_PROTO_TAG_VALUE, row->data + row->value, ZBX_JSON_TYPE_STRING);
+	zbx_json_addstring(json, ZBX_PROTO_TAG_LINE_RAW, row->data + row->raw, ZBX_JSON_TYPE_STRING);
+
+	if (0 != row->labels.values_num)
+	{
+		zbx_json_addobject(json, ZBX_PROTO_TAG_LABELS);
+
+		for (i = 0; i < row->labels.values_num; i++)
+		{
+			const char	*name = row->data + row->labels.values[i];
+
+			zbx_json_addstring(json, name, name + strlen(name) + 1, ZBX_JSON_TYPE_STRING);
+		}
+
+		zbx_json_close(json);
+	}
+
+	hint_local.metric = row->data;
+	hint = (zbx_prometheus_hint_t *)zbx_hashset_search(hints, &hint_local);
+
+	hint_type = (NULL != hint && NULL != hint->type ? hint->type : ZBX_PROMETHEUS_TYPE_UNTYPED);
+	zbx_json_addstring(json, ZBX_PROTO_TAG_TYPE, hint_type, ZBX_JSON_TYPE_STRING);
+
+	if (NULL != hint && NULL != hint->help)
+		zbx_json_addstring(json, ZBX_PROTO_TAG_HELP, hint->help, ZBX_JSON_TYPE_STRING);
+
+	zbx_json_close(json);
+}
+
 /******************************************************************************
  *                                                                            *
  * Function: zbx_prometheus_to_json                                           *
@@ -1611,17 +1976,23 @@ out:
  * Return value: SUCCEED - the data was converted successfully                *
  *               FAIL    - otherwise                                          *
  *                                                                            *
+ * Comments: The metric rows are parsed and written to json one by one,       *
+ *           reusing the same row buffer. The TYPE/HELP hints are collected   *
+ *           before that, because they can follow the metric rows.            *
+ *                                                                            *
  ******************************************************************************/
 int	zbx_prometheus_to_json(const char *data, const char *filter_data, char **value, char **error)
 {
-	zbx_prometheus_filter_t	filter;
-	char			*errmsg = NULL;
-	int			ret = FAIL, i, j;
-	zbx_vector_ptr_t	rows;
-	zbx_hashset_t		hints;
-	zbx_prometheus_hint_t	*hint, hint_local;
-	zbx_hashset_iter_t	iter;
-	struct zbx_json		json;
+	zbx_prometheus_filter_t		filter;
+	char				*errmsg = NULL;
+	int				ret = FAIL, row_num = 1, match;
+	size_t				pos;
+	zbx_hashset_t			hints;
+	zbx_prometheus_hint_t		*hint;
+	zbx_hashset_iter_t		iter;
+	zbx_prometheus_row_buf_t	row;
+	zbx_strloc_t			loc;
+	struct zbx_json			json;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
@@ -1632,54 +2003,41 @@ int	zbx_prometheus_to_json(const char *data, const char *filter_data, char **val
 		goto out;
 	}
 
-	zbx_vector_ptr_create(&rows);
 	zbx_hashset_create(&hints, 100, prometheus_hint_hash, prometheus_hint_compare);
+	prometheus_row_buf_init(&row);
+	zbx_json_initarray(&json, ZBX_JSON_STAT_BUF_LEN);
 
-	if (FAIL == prometheus_parse_rows(&filter, data, &rows, &hints, error))
+	if (FAIL == prometheus_parse_hints(&filter, data, &hints, error))
 		goto cleanup;
 
-	zbx_json_initarray(&json, rows.values_num * 100);
-
-	for (i = 0; i < rows.values_num; i++)
+	for (pos = 0; '\0' != data[pos]; pos = skip_row(data, pos), row_num++)
 	{
-		zbx_prometheus_row_t	*row = (zbx_prometheus_row_t *)rows.values[i];
-		char			*hint_type;
+		pos = skip_spaces(data, pos);
 
-		zbx_json_addobject(&json, NULL);
-		zbx_json_addstring(&json, ZBX_PROTO_TAG_NAME, row->metric, ZBX_JSON_TYPE_STRING);
-		zbx_json_addstring(&json, ZBX_PROTO_TAG_VALUE, row->value, ZBX_JSON_TYPE_STRING);
-		zbx_json_addstring(&json, ZBX_PROTO_TAG_LINE_RAW, row->raw, ZBX_JSON_TYPE_STRING);
+		/* skip empty strings and comments */
+		if ('\n' == data[pos] || '#' == data[pos])
+			continue;
 
-		if (0 != row->labels.values_num)
+		if (SUCCEED != prometheus_parse_row_buf(&filter, data, pos, &row, &match, &loc, &errmsg))
 		{
-			zbx_json_addobject(&json, ZBX_PROTO_TAG_LABELS);
-
-			for (j = 0; j < row->labels.values_num; j++)
-			{
-				zbx_prometheus_label_t	*label = (zbx_prometheus_label_t *)row->labels.values[j];
-				zbx_json_addstring(&json, label->name, label->value, ZBX_JSON_TYPE_STRING);
-			}
-
-			zbx_json_close(&json);
+			prometheus_format_row_error(data, pos, row_num, errmsg, error);
+			zbx_free(errmsg);
+			goto cleanup;
 		}
 
-		hint_local.metric = row->metric;
-		hint = (zbx_prometheus_hint_t *)zbx_hashset_search(&hints, &hint_local);
+		if (SUCCEED == match)
+			prometheus_row_to_json(&row, &hints, &json);
 
-		hint_type = (NULL != hint && NULL != hint->type ? hint->type : ZBX_PROMETHEUS_TYPE_UNTYPED);
-		zbx_json_addstring(&json, ZBX_PROTO_TAG_TYPE, hint_type, ZBX_JSON_TYPE_STRING);
-
-		if (NULL != hint && NULL != hint->help)
-			zbx_json_addstring(&json, ZBX_PROTO_TAG_HELP, hint->help, ZBX_JSON_TYPE_STRING);
-
-		zbx_json_close(&json);
+		pos = loc.r + 1;
 	}
 
 	*value = zbx_strdup(NULL, json.buffer);
-	zbx_json_free(&json);
 	zabbix_log(LOG_LEVEL_DEBUG, "%s(): output:%s", __func__, *value);
 	ret = SUCCEED;
 cleanup:
+	zbx_json_free(&json);
+	prometheus_row_buf_clear(&row);
+
 	zbx_hashset_iter_reset(&hints, &iter);
 	while (NULL != (hint = (zbx_prometheus_hint_t *)zbx_hashset_iter_next(&iter)))
 	{
@@ -1689,7 +2047,162 @@ cleanup:
 	}
 	zbx_hashset_destroy(&hints);
 
-	zbx_vector_ptr_clear_ext(&rows, (zbx_clean_func_t)prometheus_row_free);
+	prometheus_filter_clear(&filter);
+out:
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_prometheus_init                                              *
+ *                                                                            *
+ * Purpose: parses prometheus data and indexes the rows by metric name        *
+ *                                                                            *
+ * Parameters: prom  - [OUT] the parsed prometheus data                       *
+ *             data  - [IN] the prometheus data                               *
+ *             error - [OUT] the error message                                *
+ *                                                                            *
+ * Return value: SUCCEED - the data was parsed successfully                   *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: The parsed data is used to extract values of several filters     *
+ *           with zbx_prometheus_pattern_ex() without parsing the data again. *
+ *           Data with rows that cannot be parsed is not indexed, because     *
+ *           the failure of zbx_prometheus_pattern() depends on filter.       *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_prometheus_init(zbx_prometheus_t *prom, const char *data, char **error)
+{
+	zbx_prometheus_filter_t	filter;
+	zbx_prometheus_index_t	*index, index_local;
+	int			i, ret = FAIL;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
+
+	zbx_vector_ptr_create(&prom->rows);
+	zbx_hashset_create_ext(&prom->index, 100, prometheus_index_hash, prometheus_index_compare,
+			prometheus_index_clean, ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC,
+			ZBX_DEFAULT_MEM_FREE_FUNC);
+
+	if (SUCCEED == (ret = prometheus_filter_init(&filter, "", error)))
+	{
+		ret = prometheus_parse_rows(&filter, data, &prom->rows, error);
+		prometheus_filter_clear(&filter);
+	}
+
+	if (SUCCEED != ret)
+	{
+		zbx_prometheus_clear(prom);
+		goto out;
+	}
+
+	for (i = 0; i < prom->rows.values_num; i++)
+	{
+		zbx_prometheus_row_t	*row = (zbx_prometheus_row_t *)prom->rows.values[i];
+
+		index_local.metric = row->metric;
+
+		if (NULL == (index = (zbx_prometheus_index_t *)zbx_hashset_search(&prom->index, &index_local)))
+		{
+			index = (zbx_prometheus_index_t *)zbx_hashset_insert(&prom->index, &index_local,
+					sizeof(index_local));
+			zbx_vector_ptr_create(&index->rows);
+		}
+
+		zbx_vector_ptr_append(&index->rows, row);
+	}
+out:
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s rows:%d metrics:%d", __func__, zbx_result_string(ret),
+			(SUCCEED == ret ? prom->rows.values_num : 0), (SUCCEED == ret ? prom->index.num_data : 0));
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_prometheus_clear                                             *
+ *                                                                            *
+ * Purpose: frees resources allocated by parsed prometheus data               *
+ *                                                                            *
+ * Parameters: prom - [IN] the parsed prometheus data                         *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_prometheus_clear(zbx_prometheus_t *prom)
+{
+	zbx_hashset_destroy(&prom->index);
+	zbx_vector_ptr_clear_ext(&prom->rows, (zbx_clean_func_t)prometheus_row_free);
+	zbx_vector_ptr_destroy(&prom->rows);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_prometheus_pattern_ex                                        *
+ *                                                                            *
+ * Purpose: extracts value from parsed prometheus data by the specified       *
+ *          filter                                                            *
+ *                                                                            *
+ * Parameters: prom        - [IN] the parsed prometheus data                  *
+ *             fitler_data - [IN] the filter in text format                   *
+ *             output      - [IN] the output template                         *
+ *             value       - [OUT] the extracted value                        *
+ *             error       - [OUT] the error message                          *
+ *                                                                            *
+ * Return value: SUCCEED - the value was extracted successfully               *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: If the filter has metric name, only the rows of that metric are  *
+ *           checked.                                                         *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_prometheus_pattern_ex(zbx_prometheus_t *prom, const char *filter_data, const char *output, char **value,
+		char **error)
+{
+	zbx_prometheus_filter_t	filter;
+	zbx_prometheus_index_t	*index, index_local;
+	zbx_vector_ptr_t	*rows_in, rows;
+	char			*errmsg = NULL;
+	int			i, ret = FAIL;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
+
+	if (FAIL == prometheus_filter_init(&filter, filter_data, &errmsg))
+	{
+		*error = zbx_dsprintf(*error, "pattern error: %s", errmsg);
+		zbx_free(errmsg);
+		goto out;
+	}
+
+	zbx_vector_ptr_create(&rows);
+
+	if (NULL != filter.metric && ZBX_PROMETHEUS_CONDITION_OP_EQUAL == filter.metric->op)
+	{
+		index_local.metric = filter.metric->pattern;
+
+		if (NULL != (index = (zbx_prometheus_index_t *)zbx_hashset_search(&prom->index, &index_local)))
+			rows_in = &index->rows;
+		else
+			rows_in = NULL;
+	}
+	else
+		rows_in = &prom->rows;
+
+	for (i = 0; NULL != rows_in && i < rows_in->values_num; i++)
+	{
+		if (SUCCEED == prometheus_row_match(&filter, (const zbx_prometheus_row_t *)rows_in->values[i]))
+			zbx_vector_ptr_append(&rows, rows_in->values[i]);
+	}
+
+	if (FAIL == prometheus_extract_value(&rows, output, value, &errmsg))
+	{
+		*error = zbx_dsprintf(*error, "data extraction error: %s", errmsg);
+		zbx_free(errmsg);
+		goto cleanup;
+	}
+
+	zabbix_log(LOG_LEVEL_DEBUG, "%s(): output:%s", __func__, *value);
+	ret = SUCCEED;
+cleanup:
 	zbx_vector_ptr_destroy(&rows);
 	prometheus_filter_clear(&filter);
 out:
@@ -51,6 +51,9 @@ zbx_regmatch_t;
  *                      NULL is not allowed.                                  *
  *     flags     - [IN] regexp compilation parameters passed to pcre_compile. *
  *                      PCRE_CASELESS, PCRE_NO_AUTO_CAPTURE, PCRE_MULTILINE.  *
+ *     jit       - [IN] 1 - compile to machine code where supported. It pays  *
+ *                      off only for regexps reused many times, the JIT cost  *
+ *                      exceeds matching cost of a single value.              *
  *     regexp    - [OUT] output regexp.                                       *
  *     err_msg_static - [OUT] error message if any. Do not deallocate with    *
  *                            zbx_free().                                     *
@@ -58,7 +61,8 @@ zbx_regmatch_t;
  * Return value: SUCCEED or FAIL                                              *
  *                                                                            *
  ******************************************************************************/
-static int	regexp_compile(const char *pattern, int flags, zbx_regexp_t **regexp, const char **err_msg_static)
+static int	regexp_compile(const char *pattern, int flags, int jit, zbx_regexp_t **regexp,
+		const char **err_msg_static)
 {
 	int			error_offset = -1;
 	pcre			*pcre_regexp;
@@ -94,7 +98,16 @@ static int	regexp_compile(const char *pattern, int flags, zbx_regexp_t **regexp,
 
 	if (NULL != regexp)
 	{
-		if (NULL == (extra = pcre_study(pcre_regexp, 0, err_msg_static)) && NULL != *err_msg_static)
+		int	study_flags = 0;
+
+#ifdef PCRE_STUDY_JIT_COMPILE
+		/* compile to machine code where supported, the interpreter is used otherwise */
+		if (0 != jit)
+			study_flags |= PCRE_STUDY_JIT_COMPILE;
+#else
+		ZBX_UNUSED(jit);
+#endif
+		if (NULL == (extra = pcre_study(pcre_regexp, study_flags, err_msg_static)) && NULL != *err_msg_static)
 		{
 			pcre_free(pcre_regexp);
 			return FAIL;
@@ -120,9 +133,9 @@ static int	regexp_compile(const char *pattern, int flags, zbx_regexp_t **regexp,
 int	zbx_regexp_compile(const char *pattern, zbx_regexp_t **regexp, const char **err_msg_static)
 {
 #ifdef PCRE_NO_AUTO_CAPTURE
-	return regexp_compile(pattern, PCRE_MULTILINE | PCRE_NO_AUTO_CAPTURE, regexp, err_msg_static);
+	return regexp_compile(pattern, PCRE_MULTILINE | PCRE_NO_AUTO_CAPTURE, 0, regexp, err_msg_static);
 #else
-	return regexp_compile(pattern, PCRE_MULTILINE, regexp, err_msg_static);
+	return regexp_compile(pattern, PCRE_MULTILINE, 0, regexp, err_msg_static);
 #endif
 }
 
@@ -135,46 +148,120 @@ int	zbx_regexp_compile(const char *pattern, zbx_regexp_t **regexp, const char **
  *******************************************************/
 int	zbx_regexp_compile_ext(const char *pattern, zbx_regexp_t **regexp, int flags, const char **err_msg_static)
 {
-	return regexp_compile(pattern, flags, regexp, err_msg_static);
+	return regexp_compile(pattern, flags, 0, regexp, err_msg_static);
+}
+
+/* compiled regular expression cache entry */
+typedef struct
+{
+	char		*pattern;
+	int		flags;
+	zbx_regexp_t	*regexp;
+	zbx_uint64_t	lastaccess;
+}
+zbx_regexp_cache_entry_t;
+
+#define ZBX_REGEXP_CACHE_MAX	256	/* max number of compiled regular expressions kept by a process or thread */
+
+static ZBX_THREAD_LOCAL zbx_hashset_t	regexp_cache;
+static ZBX_THREAD_LOCAL zbx_uint64_t	regexp_cache_clock;
+
+static zbx_hash_t	regexp_cache_hash_func(const void *data)
+{
+	const zbx_regexp_cache_entry_t	*entry = (const zbx_regexp_cache_entry_t *)data;
+	zbx_hash_t			hash;
+
+	hash = ZBX_DEFAULT_STRING_HASH_FUNC(entry->pattern);
+
+	return ZBX_DEFAULT_HASH_ALGO(&entry->flags, sizeof(entry->flags), hash);
+}
+
+static int	regexp_cache_compare_func(const void *d1, const void *d2)
+{
+	const zbx_regexp_cache_entry_t	*e1 = (const zbx_regexp_cache_entry_t *)d1;
+	const zbx_regexp_cache_entry_t	*e2 = (const zbx_regexp_cache_entry_t *)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(e1->flags, e2->flags);
+
+	return strcmp(e1->pattern, e2->pattern);
+}
+
+static void	regexp_cache_clean_func(void *data)
+{
+	zbx_regexp_cache_entry_t	*entry = (zbx_regexp_cache_entry_t *)data;
+
+	zbx_regexp_free(entry->regexp);
+	zbx_free(entry->pattern);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: regexp_cache_evict                                               *
+ *                                                                            *
+ * Purpose: removes the least recently used regexp from cache                 *
+ *                                                                            *
+ ******************************************************************************/
+static void	regexp_cache_evict(void)
+{
+	zbx_hashset_iter_t		iter;
+	zbx_regexp_cache_entry_t	*entry, *entry_lru = NULL;
+
+	zbx_hashset_iter_reset(&regexp_cache, &iter);
+
+	while (NULL != (entry = (zbx_regexp_cache_entry_t *)zbx_hashset_iter_next(&iter)))
+	{
+		if (NULL == entry_lru || entry->lastaccess < entry_lru->lastaccess)
+			entry_lru = entry;
+	}
+
+	if (NULL != entry_lru)
+		zbx_hashset_remove_direct(&regexp_cache, entry_lru);
 }
 
 /****************************************************************************************************
  *                                                                                                  *
  * Function: regexp_prepare                                                                         *
  *                                                                                                  *
- * Purpose: wrapper for zbx_regexp_compile. Caches and reuses the last used regexp.                 *
+ * Purpose: wrapper for zbx_regexp_compile. Caches and reuses the recently used regexps.            *
+ *                                                                                                  *
+ * Comments: The returned regexp is owned by cache and stays valid until the next regexp_prepare()  *
+ *           call, which might evict it. Regexps that failed to compile are not cached.             *
  *                                                                                                  *
  ****************************************************************************************************/
 static int	regexp_prepare(const char *pattern, int flags, zbx_regexp_t **regexp, const char **err_msg_static)
 {
-	static ZBX_THREAD_LOCAL zbx_regexp_t	*curr_regexp = NULL;
-	static ZBX_THREAD_LOCAL char		*curr_pattern = NULL;
-	static ZBX_THREAD_LOCAL int		curr_flags = 0;
-	int					ret = SUCCEED;
+	zbx_regexp_cache_entry_t	entry_local, *entry;
 
-	if (NULL == curr_regexp || 0 != strcmp(curr_pattern, pattern) || curr_flags != flags)
+	if (0 == regexp_cache.num_slots)
 	{
-		if (NULL != curr_regexp)
-		{
-			zbx_regexp_free(curr_regexp);
-			zbx_free(curr_pattern);
-		}
+		zbx_hashset_create_ext(&regexp_cache, 0, regexp_cache_hash_func, regexp_cache_compare_func,
+				regexp_cache_clean_func, ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC,
+				ZBX_DEFAULT_MEM_FREE_FUNC);
+	}
 
-		curr_regexp = NULL;
-		curr_pattern = NULL;
-		curr_flags = 0;
+	entry_local.pattern = (char *)pattern;
+	entry_local.flags = flags;
 
-		if (SUCCEED == regexp_compile(pattern, flags, &curr_regexp, err_msg_static))
+	if (NULL == (entry = (zbx_regexp_cache_entry_t *)zbx_hashset_search(&regexp_cache, &entry_local)))
+	{
+		/* cached regexps are reused, so the machine code compilation cost is worth it */
+		if (SUCCEED != regexp_compile(pattern, flags, 1, &entry_local.regexp, err_msg_static))
 		{
-			curr_pattern = zbx_strdup(curr_pattern, pattern);
-			curr_flags = flags;
+			*regexp = NULL;
+			return FAIL;
 		}
-		else
-			ret = FAIL;
+
+		if (ZBX_REGEXP_CACHE_MAX <= regexp_cache.num_data)
+			regexp_cache_evict();
+
+		entry_local.pattern = zbx_strdup(NULL, pattern);
+		entry = (zbx_regexp_cache_entry_t *)zbx_hashset_insert(&regexp_cache, &entry_local, sizeof(entry_local));
 	}
 
-	*regexp = curr_regexp;
-	return ret;
+	entry->lastaccess = ++regexp_cache_clock;
+	*regexp = entry->regexp;
+
+	return SUCCEED;
 }
 
 /***********************************************************************************
@@ -243,9 +330,19 @@ static int	regexp_exec(const char *string, const zbx_regexp_t *regexp, int flags
 #else
 	pextra->match_limit_recursion = recursion_limit;
 #endif
+#endif
+	r = pcre_exec(regexp->pcre_regexp, pextra, string, strlen(string), flags, 0, ovector, ovecsize);
+
+#if defined(PCRE_ERROR_JIT_STACKLIMIT) && defined(PCRE_EXTRA_EXECUTABLE_JIT)
+	/* default JIT stack is too small for this pattern and string, use the interpreter for this regexp */
+	if (PCRE_ERROR_JIT_STACKLIMIT == r)
+	{
+		pextra->flags &= ~PCRE_EXTRA_EXECUTABLE_JIT;
+		r = pcre_exec(regexp->pcre_regexp, pextra, string, strlen(string), flags, 0, ovector, ovecsize);
+	}
 #endif
 	/* see "man pcreapi" about pcre_exec() return value and 'ovector' size and layout */
-	if (0 <= (r = pcre_exec(regexp->pcre_regexp, pextra, string, strlen(string), flags, 0, ovector, ovecsize)))
+	if (0 <= r)
 	{
 		if (NULL != matches)
 			memcpy(matches, ovector, (size_t)((0 < r) ? MIN(r, count) : count) * sizeof(zbx_regmatch_t));
@@ -863,6 +863,46 @@ out:
 #undef OP_BAND
 #undef OP_MAX
 
+/******************************************************************************
+ *                                                                            *
+ * Function: get_numeric_values                                               *
+ *                                                                            *
+ * Purpose: get numeric item values packed into value array of the item       *
+ *          value type                                                        *
+ *                                                                            *
+ * Parameters: item        - [IN] the item                                    *
+ *             values_dbl  - [OUT] the values of floating point item          *
+ *             values_ui64 - [OUT] the values of unsigned integer item        *
+ *             seconds     - [IN] the time period to retrieve data for        *
+ *             count       - [IN] the number of history values to retrieve    *
+ *             ts          - [IN] the period end timestamp                    *
+ *             values_num  - [OUT] the number of retrieved values             *
+ *                                                                            *
+ * Return value: SUCCEED - the values were retrieved successfully             *
+ *               FAIL    - failed to retrieve values                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	get_numeric_values(const DC_ITEM *item, zbx_vector_dbl_t *values_dbl, zbx_vector_uint64_t *values_ui64,
+		int seconds, int count, const zbx_timespec_t *ts, int *values_num)
+{
+	if (ITEM_VALUE_TYPE_FLOAT == item->value_type)
+	{
+		if (FAIL == zbx_vc_get_values_dbl(item->itemid, values_dbl, seconds, count, ts))
+			return FAIL;
+
+		*values_num = values_dbl->values_num;
+	}
+	else
+	{
+		if (FAIL == zbx_vc_get_values_uint64(item->itemid, values_ui64, seconds, count, ts))
+			return FAIL;
+
+		*values_num = values_ui64->values_num;
+	}
+
+	return SUCCEED;
+}
+
 /******************************************************************************
  *                                                                            *
  * Function: evaluate_SUM                                                     *
@@ -878,15 +918,17 @@ out:
  ******************************************************************************/
 static int	evaluate_SUM(char *value, DC_ITEM *item, const char *parameters, const zbx_timespec_t *ts, char **error)
 {
-	int				nparams, arg1, i, ret = FAIL, seconds = 0, nvalues = 0;
-	zbx_value_type_t		arg1_type;
-	zbx_vector_history_record_t	values;
-	history_value_t			result;
-	zbx_timespec_t			ts_end = *ts;
+	int			nparams, arg1, ret = FAIL, seconds = 0, nvalues = 0, values_num;
+	zbx_value_type_t	arg1_type;
+	zbx_vector_dbl_t	values_dbl;
+	zbx_vector_uint64_t	values_ui64;
+	history_value_t		result;
+	zbx_timespec_t		ts_end = *ts;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
-	zbx_history_record_vector_create(&values);
+	zbx_vector_dbl_create(&values_dbl);
+	zbx_vector_uint64_create(&values_ui64);
 
 	if (ITEM_VALUE_TYPE_FLOAT != item->value_type && ITEM_VALUE_TYPE_UINT64 != item->value_type)
 	{
@@ -935,31 +977,22 @@ static int	evaluate_SUM(char *value, DC_ITEM *item, const char *parameters, cons
 			THIS_SHOULD_NEVER_HAPPEN;
 	}
 
-	if (FAIL == zbx_vc_get_values(item->itemid, item->value_type, &values, seconds, nvalues, &ts_end))
+	if (FAIL == get_numeric_values(item, &values_dbl, &values_ui64, seconds, nvalues, &ts_end, &values_num))
 	{
 		*error = zbx_strdup(*error, "cannot get values from value cache");
 		goto out;
 	}
 
 	if (ITEM_VALUE_TYPE_FLOAT == item->value_type)
-	{
-		result.dbl = 0;
-
-		for (i = 0; i < values.values_num; i++)
-			result.dbl += values.values[i].value.dbl;
-	}
+		result.dbl = zbx_dbl_array_sum(values_dbl.values, values_num);
 	else
-	{
-		result.ui64 = 0;
-
-		for (i = 0; i < values.values_num; i++)
-			result.ui64 += values.values[i].value.ui64;
-	}
+		result.ui64 = zbx_ui64_array_sum(values_ui64.values, values_num);
 
 	zbx_history_value2str(value, MAX_BUFFER_LEN, &result, item->value_type);
 	ret = SUCCEED;
 out:
-	zbx_history_record_vector_destroy(&values, item->value_type);
+	zbx_vector_uint64_destroy(&values_ui64);
+	zbx_vector_dbl_destroy(&values_dbl);
 
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
 
@@ -981,14 +1014,16 @@ out:
  ******************************************************************************/
 static int	evaluate_AVG(char *value, DC_ITEM *item, const char *parameters, const zbx_timespec_t *ts, char **error)
 {
-	int				nparams, arg1, ret = FAIL, i, seconds = 0, nvalues = 0;
-	zbx_value_type_t		arg1_type;
-	zbx_vector_history_record_t	values;
-	zbx_timespec_t			ts_end = *ts;
+	int			nparams, arg1, ret = FAIL, seconds = 0, nvalues = 0, values_num;
+	zbx_value_type_t	arg1_type;
+	zbx_vector_dbl_t	values_dbl;
+	zbx_vector_uint64_t	values_ui64;
+	zbx_timespec_t		ts_end = *ts;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
-	zbx_history_record_vector_create(&values);
+	zbx_vector_dbl_create(&values_dbl);
+	zbx_vector_uint64_create(&values_ui64);
 
 	if (ITEM_VALUE_TYPE_FLOAT != item->value_type && ITEM_VALUE_TYPE_UINT64 != item->value_type)
 	{
@@ -1037,27 +1072,22 @@ static int	evaluate_AVG(char *value, DC_ITEM *item, const char *parameters, cons
 			THIS_SHOULD_NEVER_HAPPEN;
 	}
 
-	if (FAIL == zbx_vc_get_values(item->itemid, item->value_type, &values, seconds, nvalues, &ts_end))
+	if (FAIL == get_numeric_values(item, &values_dbl, &values_ui64, seconds, nvalues, &ts_end, &values_num))
 	{
 		*error = zbx_strdup(*error, "cannot get values from value cache");
 		goto out;
 	}
 
-	if (0 < values.values_num)
+	if (0 < values_num)
 	{
-		double	sum = 0;
+		double	sum;
 
 		if (ITEM_VALUE_TYPE_FLOAT == item->value_type)
-		{
-			for (i = 0; i < values.values_num; i++)
-				sum += values.values[i].value.dbl;
-		}
+			sum = zbx_dbl_array_sum(values_dbl.values, values_num);
 		else
-		{
-			for (i = 0; i < values.values_num; i++)
-				sum += values.values[i].value.ui64;
-		}
-		zbx_snprintf(value, MAX_BUFFER_LEN, ZBX_FS_DBL, sum / values.values_num);
+			sum = zbx_ui64_array_sum_dbl(values_ui64.values, values_num);
+
+		zbx_snprintf(value, MAX_BUFFER_LEN, ZBX_FS_DBL, sum / values_num);
 
 		ret = SUCCEED;
 	}
@@ -1067,7 +1097,8 @@ static int	evaluate_AVG(char *value, DC_ITEM *item, const char *parameters, cons
 		*error = zbx_strdup(*error, "not enough data");
 	}
 out:
-	zbx_history_record_vector_destroy(&values, item->value_type);
+	zbx_vector_uint64_destroy(&values_ui64);
+	zbx_vector_dbl_destroy(&values_dbl);
 
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
 
@@ -1167,14 +1198,16 @@ out:
  ******************************************************************************/
 static int	evaluate_MIN(char *value, DC_ITEM *item, const char *parameters, const zbx_timespec_t *ts, char **error)
 {
-	int				nparams, arg1, i, ret = FAIL, seconds = 0, nvalues = 0;
-	zbx_value_type_t		arg1_type;
-	zbx_vector_history_record_t	values;
-	zbx_timespec_t			ts_end = *ts;
+	int			nparams, arg1, ret = FAIL, seconds = 0, nvalues = 0, values_num;
+	zbx_value_type_t	arg1_type;
+	zbx_vector_dbl_t	values_dbl;
+	zbx_vector_uint64_t	values_ui64;
+	zbx_timespec_t		ts_end = *ts;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
-	zbx_history_record_vector_create(&values);
+	zbx_vector_dbl_create(&values_dbl);
+	zbx_vector_uint64_create(&values_ui64);
 
 	if (ITEM_VALUE_TYPE_FLOAT != item->value_type && ITEM_VALUE_TYPE_UINT64 != item->value_type)
 	{
@@ -1223,33 +1256,22 @@ static int	evaluate_MIN(char *value, DC_ITEM *item, const char *parameters, cons
 			THIS_SHOULD_NEVER_HAPPEN;
 	}
 
-	if (FAIL == zbx_vc_get_values(item->itemid, item->value_type, &values, seconds, nvalues, &ts_end))
+	if (FAIL == get_numeric_values(item, &values_dbl, &values_ui64, seconds, nvalues, &ts_end, &values_num))
 	{
 		*error = zbx_strdup(*error, "cannot get values from value cache");
 		goto out;
 	}
 
-	if (0 < values.values_num)
+	if (0 < values_num)
 	{
-		int	index = 0;
+		history_value_t	result;
 
 		if (ITEM_VALUE_TYPE_UINT64 == item->value_type)
-		{
-			for (i = 1; i < values.values_num; i++)
-			{
-				if (values.values[i].value.ui64 < values.values[index].value.ui64)
-					index = i;
-			}
-		}
+			result.ui64 = zbx_ui64_array_min(values_ui64.values, values_num);
 		else
-		{
-			for (i = 1; i < values.values_num; i++)
-			{
-				if (values.values[i].value.dbl < values.values[index].value.dbl)
-					index = i;
-			}
-		}
-		zbx_history_value2str(value, MAX_BUFFER_LEN, &values.values[index].value, item->value_type);
+			result.dbl = zbx_dbl_array_min(values_dbl.values, values_num);
+
+		zbx_history_value2str(value, MAX_BUFFER_LEN, &result, item->value_type);
 
 		ret = SUCCEED;
 	}
@@ -1259,7 +1281,8 @@ static int	evaluate_MIN(char *value, DC_ITEM *item, const char *parameters, cons
 		*error = zbx_strdup(*error, "not enough data");
 	}
 out:
-	zbx_history_record_vector_destroy(&values, item->value_type);
+	zbx_vector_uint64_destroy(&values_ui64);
+	zbx_vector_dbl_destroy(&values_dbl);
 
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
 
@@ -1281,14 +1304,16 @@ out:
  ******************************************************************************/
 static int	evaluate_MAX(char *value, DC_ITEM *item, const char *parameters, const zbx_timespec_t *ts, char **error)
 {
-	int				nparams, arg1, ret = FAIL, i, seconds = 0, nvalues = 0;
-	zbx_value_type_t		arg1_type;
-	zbx_vector_history_record_t	values;
-	zbx_timespec_t			ts_end = *ts;
+	int			nparams, arg1, ret = FAIL, seconds = 0, nvalues = 0, values_num;
+	zbx_value_type_t	arg1_type;
+	zbx_vector_dbl_t	values_dbl;
+	zbx_vector_uint64_t	values_ui64;
+	zbx_timespec_t		ts_end = *ts;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
-	zbx_history_record_vector_create(&values);
+	zbx_vector_dbl_create(&values_dbl);
+	zbx_vector_uint64_create(&values_ui64);
 
 	if (ITEM_VALUE_TYPE_FLOAT != item->value_type && ITEM_VALUE_TYPE_UINT64 != item->value_type)
 	{
@@ -1337,33 +1362,22 @@ static int	evaluate_MAX(char *value, DC_ITEM *item, const char *parameters, cons
 			THIS_SHOULD_NEVER_HAPPEN;
 	}
 
-	if (FAIL == zbx_vc_get_values(item->itemid, item->value_type, &values, seconds, nvalues, &ts_end))
+	if (FAIL == get_numeric_values(item, &values_dbl, &values_ui64, seconds, nvalues, &ts_end, &values_num))
 	{
 		*error = zbx_strdup(*error, "cannot get values from value cache");
 		goto out;
 	}
 
-	if (0 < values.values_num)
+	if (0 < values_num)
 	{
-		int	index = 0;
+		history_value_t	result;
 
 		if (ITEM_VALUE_TYPE_UINT64 == item->value_type)
-		{
-			for (i = 1; i < values.values_num; i++)
-			{
-				if (values.values[i].value.ui64 > values.values[index].value.ui64)
-					index = i;
-			}
-		}
+			result.ui64 = zbx_ui64_array_max(values_ui64.values, values_num);
 		else
-		{
-			for (i = 1; i < values.values_num; i++)
-			{
-				if (values.values[i].value.dbl > values.values[index].value.dbl)
-					index = i;
-			}
-		}
-		zbx_history_value2str(value, MAX_BUFFER_LEN, &values.values[index].value, item->value_type);
+			result.dbl = zbx_dbl_array_max(values_dbl.values, values_num);
+
+		zbx_history_value2str(value, MAX_BUFFER_LEN, &result, item->value_type);
 
 		ret = SUCCEED;
 	}
@@ -1373,27 +1387,14 @@ static int	evaluate_MAX(char *value, DC_ITEM *item, const char *parameters, cons
 		*error = zbx_strdup(*error, "not enough data");
 	}
 out:
-	zbx_history_record_vector_destroy(&values, item->value_type);
+	zbx_vector_uint64_destroy(&values_ui64);
+	zbx_vector_dbl_destroy(&values_dbl);
 
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
 
 	return ret;
 }
 
-static int	__history_record_float_compare(const zbx_history_record_t *d1, const zbx_history_record_t *d2)
-{
-	ZBX_RETURN_IF_NOT_EQUAL(d1->value.dbl, d2->value.dbl);
-
-	return 0;
-}
-
-static int	__history_record_uint64_compare(const zbx_history_record_t *d1, const zbx_history_record_t *d2)
-{
-	ZBX_RETURN_IF_NOT_EQUAL(d1->value.ui64, d2->value.ui64);
-
-	return 0;
-}
-
 /******************************************************************************
  *                                                                            *
  * Function: evaluate_PERCENTILE                                              *
@@ -1412,15 +1413,17 @@ static int	__history_record_uint64_compare(const zbx_history_record_t *d1, const
 static int	evaluate_PERCENTILE(char *value, DC_ITEM *item, const char *parameters,
 		const zbx_timespec_t *ts, char **error)
 {
-	int				nparams, arg1, time_shift = 0, ret = FAIL, seconds = 0, nvalues = 0;
-	zbx_value_type_t		arg1_type, time_shift_type = ZBX_VALUE_SECONDS;
-	double				percentage;
-	zbx_vector_history_record_t	values;
-	zbx_timespec_t			ts_end = *ts;
+	int			nparams, arg1, time_shift = 0, ret = FAIL, seconds = 0, nvalues = 0, values_num;
+	zbx_value_type_t	arg1_type, time_shift_type = ZBX_VALUE_SECONDS;
+	double			percentage;
+	zbx_vector_dbl_t	values_dbl;
+	zbx_vector_uint64_t	values_ui64;
+	zbx_timespec_t		ts_end = *ts;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
-	zbx_history_record_vector_create(&values);
+	zbx_vector_dbl_create(&values_dbl);
+	zbx_vector_uint64_create(&values_ui64);
 
 	if (ITEM_VALUE_TYPE_FLOAT != item->value_type && ITEM_VALUE_TYPE_UINT64 != item->value_type)
 	{
@@ -1469,27 +1472,29 @@ static int	evaluate_PERCENTILE(char *value, DC_ITEM *item, const char *parameter
 		goto out;
 	}
 
-	if (FAIL == zbx_vc_get_values(item->itemid, item->value_type, &values, seconds, nvalues, &ts_end))
+	if (FAIL == get_numeric_values(item, &values_dbl, &values_ui64, seconds, nvalues, &ts_end, &values_num))
 	{
 		*error = zbx_strdup(*error, "cannot get values from value cache");
 		goto out;
 	}
 
-	if (0 < values.values_num)
+	if (0 < values_num)
 	{
-		int	index;
-
-		if (ITEM_VALUE_TYPE_FLOAT == item->value_type)
-			zbx_vector_history_record_sort(&values, (zbx_compare_func_t)__history_record_float_compare);
-		else
-			zbx_vector_history_record_sort(&values, (zbx_compare_func_t)__history_record_uint64_compare);
+		int		index;
+		history_value_t	result;
 
 		if (0 == percentage)
 			index = 1;
 		else
-			index = (int)ceil(values.values_num * (percentage / 100));
+			index = (int)ceil(values_num * (percentage / 100));
 
-		zbx_history_value2str(value, MAX_BUFFER_LEN, &values.values[index - 1].value, item->value_type);
+		/* select the value at percentile index without sorting the whole range */
+		if (ITEM_VALUE_TYPE_FLOAT == item->value_type)
+			result.dbl = zbx_dbl_array_select(values_dbl.values, values_num, index - 1);
+		else
+			result.ui64 = zbx_ui64_array_select(values_ui64.values, values_num, index - 1);
+
+		zbx_history_value2str(value, MAX_BUFFER_LEN, &result, item->value_type);
 
 		ret = SUCCEED;
 	}
@@ -1499,7 +1504,8 @@ static int	evaluate_PERCENTILE(char *value, DC_ITEM *item, const char *parameter
 		*error = zbx_strdup(*error, "not enough data");
 	}
 out:
-	zbx_history_record_vector_destroy(&values, item->value_type);
+	zbx_vector_uint64_destroy(&values_ui64);
+	zbx_vector_dbl_destroy(&values_dbl);
 
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
 
@@ -1635,75 +1641,148 @@ out:
 
 /******************************************************************************
  *                                                                            *
- * Function: evaluate_NODATA                                                  *
+ * Function: evaluate_nodata_functions                                        *
  *                                                                            *
- * Purpose: evaluate function 'nodata' for the item                           *
+ * Purpose: evaluate 'nodata' functions of the same item                      *
  *                                                                            *
- * Parameters: item - item (performance metric)                               *
- *             parameter - number of seconds                                  *
+ * Parameters: item      - [IN] item (performance metric)                     *
+ *             funcs     - [IN/OUT] the functions to evaluate                 *
+ *             funcs_num - [IN] the number of functions                       *
  *                                                                            *
- * Return value: SUCCEED - evaluated successfully, result is stored in 'value'*
- *               FAIL - failed to evaluate function                           *
+ * Comments: The latest item value is looked up once for the longest period   *
+ *           of all functions and the data expected from time is read only    *
+ *           when required, instead of doing both for each function.          *
  *                                                                            *
  ******************************************************************************/
-static int	evaluate_NODATA(char *value, DC_ITEM *item, const char *parameters, char **error)
+void	evaluate_nodata_functions(DC_ITEM *item, zbx_nodata_func_t *funcs, int funcs_num)
 {
-	int				arg1, ret = FAIL;
+	int				i, *periods, period_max = 0, data_expected_from = 0, expected_ret = FAIL,
+					expected_read = 0, found = 0, lastclock = 0;
 	zbx_value_type_t		arg1_type;
 	zbx_vector_history_record_t	values;
 	zbx_timespec_t			ts;
 
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() itemid:" ZBX_FS_UI64 " funcs_num:%d", __func__, item->itemid,
+			funcs_num);
 
-	zbx_history_record_vector_create(&values);
+	periods = (int *)zbx_malloc(NULL, sizeof(int) * (size_t)funcs_num);
 
-	if (1 < num_param(parameters))
+	for (i = 0; i < funcs_num; i++)
 	{
-		*error = zbx_strdup(*error, "invalid number of parameters");
-		goto out;
-	}
+		zbx_nodata_func_t	*func = &funcs[i];
 
-	if (SUCCEED != get_function_parameter_int(item->host.hostid, parameters, 1, ZBX_PARAM_MANDATORY, &arg1,
-			&arg1_type) || ZBX_VALUE_SECONDS != arg1_type || 0 >= arg1)
-	{
-		*error = zbx_strdup(*error, "invalid first parameter");
-		goto out;
+		func->ret = FAIL;
+		func->error = NULL;
+		periods[i] = 0;
+
+		if (1 < num_param(func->parameters))
+		{
+			func->error = zbx_strdup(NULL, "invalid number of parameters");
+			continue;
+		}
+
+		if (SUCCEED != get_function_parameter_int(item->host.hostid, func->parameters, 1, ZBX_PARAM_MANDATORY,
+				&periods[i], &arg1_type) || ZBX_VALUE_SECONDS != arg1_type || 0 >= periods[i])
+		{
+			func->error = zbx_strdup(NULL, "invalid first parameter");
+			periods[i] = 0;
+			continue;
+		}
+
+		if (period_max < periods[i])
+			period_max = periods[i];
 	}
 
 	zbx_timespec(&ts);
 
-	if (SUCCEED == zbx_vc_get_values(item->itemid, item->value_type, &values, arg1, 1, &ts) &&
-			1 == values.values_num)
+	if (0 != period_max)
 	{
-		zbx_strlcpy(value, "0", MAX_BUFFER_LEN);
+		zbx_history_record_vector_create(&values);
+
+		if (SUCCEED == zbx_vc_get_values(item->itemid, item->value_type, &values, period_max, 1, &ts) &&
+				1 == values.values_num)
+		{
+			lastclock = values.values[0].timestamp.sec;
+			found = 1;
+		}
+
+		zbx_history_record_vector_destroy(&values, item->value_type);
 	}
-	else
+
+	for (i = 0; i < funcs_num; i++)
 	{
-		int	seconds;
+		zbx_nodata_func_t	*func = &funcs[i];
+
+		if (0 == periods[i])
+			continue;
 
-		if (SUCCEED != DCget_data_expected_from(item->itemid, &seconds))
+		/* the latest value is within function period, compared with second precision like history requests */
+		if (0 != found && lastclock > ts.sec - periods[i])
 		{
-			*error = zbx_strdup(*error, "item does not exist, is disabled or belongs to a disabled host");
-			goto out;
+			func->value = 0;
+			func->ret = SUCCEED;
+			continue;
 		}
 
-		if (seconds + arg1 > ts.sec)
+		if (0 == expected_read)
 		{
-			*error = zbx_strdup(*error,
+			expected_ret = DCget_data_expected_from(item->itemid, &data_expected_from);
+			expected_read = 1;
+		}
+
+		if (SUCCEED != expected_ret)
+		{
+			func->error = zbx_strdup(NULL,
+					"item does not exist, is disabled or belongs to a disabled host");
+			continue;
+		}
+
+		if (data_expected_from + periods[i] > ts.sec)
+		{
+			func->error = zbx_strdup(NULL,
 					"item does not have enough data after server start or item creation");
-			goto out;
+			continue;
 		}
 
-		zbx_strlcpy(value, "1", MAX_BUFFER_LEN);
+		func->value = 1;
+		func->ret = SUCCEED;
 	}
 
-	ret = SUCCEED;
-out:
-	zbx_history_record_vector_destroy(&values, item->value_type);
+	zbx_free(periods);
 
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
+}
 
-	return ret;
+/******************************************************************************
+ *                                                                            *
+ * Function: evaluate_NODATA                                                  *
+ *                                                                            *
+ * Purpose: evaluate function 'nodata' for the item                           *
+ *                                                                            *
+ * Parameters: item - item (performance metric)                               *
+ *             parameter - number of seconds                                  *
+ *                                                                            *
+ * Return value: SUCCEED - evaluated successfully, result is stored in 'value'*
+ *               FAIL - failed to evaluate function                           *
+ *                                                                            *
+ ******************************************************************************/
+static int	evaluate_NODATA(char *value, DC_ITEM *item, const char *parameters, char **error)
+{
+	zbx_nodata_func_t	func;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
+
+	func.parameters = parameters;
+	evaluate_nodata_functions(item, &func, 1);
+
+	if (SUCCEED == func.ret)
+		zbx_snprintf(value, MAX_BUFFER_LEN, "%d", func.value);
+	else
+		*error = func.error;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(func.ret));
+
+	return func.ret;
 }
 
 /******************************************************************************
@@ -2300,6 +2379,237 @@ clean:
 	return ret;
 }
 
+/* streaming regression state of forecast() and timeleft() data window */
+typedef struct
+{
+	zbx_uint64_t			itemid;
+	int				value_type;
+	int				seconds;
+	int				nvalues;
+	int				time_shift;
+	zbx_fit_t			fit;
+	unsigned int			k;
+
+	/* the regression time frame origin */
+	zbx_timespec_t			ref;
+
+	/* the data window values converted to floating point, oldest first, starting with index first */
+	zbx_vector_history_record_t	values;
+	int				first;
+
+	zbx_regression_t		regression;
+}
+zbx_forecast_state_t;
+
+#define ZBX_FORECAST_STATES_MAX	1000
+
+static zbx_hashset_t	forecast_states;
+
+static zbx_hash_t	forecast_state_hash_func(const void *data)
+{
+	const zbx_forecast_state_t	*state = (const zbx_forecast_state_t *)data;
+	zbx_hash_t			hash;
+
+	hash = ZBX_DEFAULT_UINT64_HASH_FUNC(&state->itemid);
+	hash = ZBX_DEFAULT_HASH_ALGO(&state->seconds, sizeof(state->seconds), hash);
+	hash = ZBX_DEFAULT_HASH_ALGO(&state->nvalues, sizeof(state->nvalues), hash);
+	hash = ZBX_DEFAULT_HASH_ALGO(&state->time_shift, sizeof(state->time_shift), hash);
+
+	return ZBX_DEFAULT_HASH_ALGO(&state->k, sizeof(state->k), hash);
+}
+
+static int	forecast_state_compare_func(const void *d1, const void *d2)
+{
+	const zbx_forecast_state_t	*s1 = (const zbx_forecast_state_t *)d1;
+	const zbx_forecast_state_t	*s2 = (const zbx_forecast_state_t *)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(s1->itemid, s2->itemid);
+	ZBX_RETURN_IF_NOT_EQUAL(s1->value_type, s2->value_type);
+	ZBX_RETURN_IF_NOT_EQUAL(s1->seconds, s2->seconds);
+	ZBX_RETURN_IF_NOT_EQUAL(s1->nvalues, s2->nvalues);
+	ZBX_RETURN_IF_NOT_EQUAL(s1->time_shift, s2->time_shift);
+	ZBX_RETURN_IF_NOT_EQUAL(s1->fit, s2->fit);
+	ZBX_RETURN_IF_NOT_EQUAL(s1->k, s2->k);
+
+	return 0;
+}
+
+static void	forecast_state_clean_func(void *data)
+{
+	zbx_forecast_state_t	*state = (zbx_forecast_state_t *)data;
+
+	zbx_vector_history_record_destroy(&state->values);
+}
+
+static double	forecast_state_time(const zbx_forecast_state_t *state, const zbx_timespec_t *ts)
+{
+	return ts->sec - state->ref.sec + 1.0e-9 * (ts->ns - state->ref.ns + 1);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: forecast_state_shift                                             *
+ *                                                                            *
+ * Purpose: get offset of the regression time frame from the time frame       *
+ *          used by forecast() and timeleft() functions with the specified    *
+ *          origin                                                            *
+ *                                                                            *
+ ******************************************************************************/
+static double	forecast_state_shift(const zbx_forecast_state_t *state, const zbx_timespec_t *zero_time)
+{
+	return zero_time->sec - state->ref.sec + 1.0e-9 * (zero_time->ns - state->ref.ns);
+}
+
+static void	forecast_state_append(zbx_forecast_state_t *state, const zbx_history_record_t *value, int value_type)
+{
+	zbx_history_record_t	record;
+
+	record.timestamp = value->timestamp;
+	record.value.dbl = (ITEM_VALUE_TYPE_FLOAT == value_type ? value->value.dbl : (double)value->value.ui64);
+
+	zbx_vector_history_record_append(&state->values, record);
+	zbx_regression_add(&state->regression, forecast_state_time(state, &record.timestamp), record.value.dbl);
+}
+
+static void	forecast_state_rebuild(zbx_forecast_state_t *state, const zbx_vector_history_record_t *values)
+{
+	int	i;
+
+	zbx_regression_init(&state->regression, state->fit, state->k);
+	zbx_vector_history_record_clear(&state->values);
+	state->first = 0;
+	state->ref = values->values[values->values_num - 1].timestamp;
+
+	for (i = values->values_num - 1; 0 <= i; i--)
+		forecast_state_append(state, &values->values[i], state->value_type);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: forecast_state_update                                            *
+ *                                                                            *
+ * Purpose: synchronize regression state with the current data window         *
+ *                                                                            *
+ * Parameters: state  - [IN/OUT] the regression state                         *
+ *             values - [IN] the data window values, newest first             *
+ *                                                                            *
+ * Comments: Values that left the window are removed and new values are       *
+ *           added to the regression sums. The sums are rebuilt from scratch  *
+ *           if the window does not match the cached values or if the time    *
+ *           frame origin lags behind by more than ZBX_REGRESSION_LAG_MAX     *
+ *           part of the window length.                                       *
+ *                                                                            *
+ ******************************************************************************/
+static void	forecast_state_update(zbx_forecast_state_t *state, const zbx_vector_history_record_t *values)
+{
+	const zbx_timespec_t	*oldest = &values->values[values->values_num - 1].timestamp;
+	const zbx_timespec_t	*newest = &values->values[0].timestamp;
+	zbx_history_record_t	*record;
+	int			i;
+
+	if (forecast_state_shift(state, oldest) > ZBX_REGRESSION_LAG_MAX * (newest->sec - oldest->sec + 1.0e-9 *
+			(newest->ns - oldest->ns)))
+	{
+		goto rebuild;
+	}
+
+	while (state->first < state->values.values_num &&
+			0 > zbx_timespec_compare(&state->values.values[state->first].timestamp, oldest))
+	{
+		record = &state->values.values[state->first++];
+		zbx_regression_remove(&state->regression, forecast_state_time(state, &record->timestamp),
+				record->value.dbl);
+	}
+
+	if (state->first == state->values.values_num)
+		goto rebuild;
+
+	record = &state->values.values[state->values.values_num - 1];
+
+	for (i = 0; i < values->values_num && 0 < zbx_timespec_compare(&values->values[i].timestamp,
+			&record->timestamp); i++)
+		;
+
+	while (0 <= --i)
+		forecast_state_append(state, &values->values[i], state->value_type);
+
+	if (state->values.values_num - state->first != values->values_num ||
+			0 != zbx_timespec_compare(&state->values.values[state->first].timestamp, oldest))
+	{
+		goto rebuild;
+	}
+
+	if (state->first > state->values.values_num / 2)
+	{
+		memmove(state->values.values, state->values.values + state->first,
+				sizeof(zbx_history_record_t) * (state->values.values_num - state->first));
+		state->values.values_num -= state->first;
+		state->first = 0;
+	}
+
+	return;
+rebuild:
+	forecast_state_rebuild(state, values);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: forecast_state_get                                               *
+ *                                                                            *
+ * Purpose: get regression state matching the data window of forecast() or    *
+ *          timeleft() function                                               *
+ *                                                                            *
+ * Parameters: item       - [IN] the item                                     *
+ *             values     - [IN] the data window values, newest first         *
+ *             seconds    - [IN] the data window period                       *
+ *             nvalues    - [IN] the data window value count                  *
+ *             time_shift - [IN] the data window time shift                   *
+ *             fit        - [IN] the fit                                      *
+ *             k          - [IN] the polynomial degree                        *
+ *                                                                            *
+ * Return value: the regression state or NULL if the fit must be calculated   *
+ *               from the values directly                                     *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_forecast_state_t	*forecast_state_get(const DC_ITEM *item, const zbx_vector_history_record_t *values,
+		int seconds, int nvalues, int time_shift, zbx_fit_t fit, unsigned int k)
+{
+	zbx_forecast_state_t	state_local, *state;
+
+	if (2 > values->values_num || SUCCEED != zbx_regression_init(&state_local.regression, fit, k))
+		return NULL;
+
+	if (0 == forecast_states.num_slots)
+	{
+		zbx_hashset_create_ext(&forecast_states, 100, forecast_state_hash_func, forecast_state_compare_func,
+				forecast_state_clean_func, ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC,
+				ZBX_DEFAULT_MEM_FREE_FUNC);
+	}
+
+	state_local.itemid = item->itemid;
+	state_local.value_type = item->value_type;
+	state_local.seconds = seconds;
+	state_local.nvalues = nvalues;
+	state_local.time_shift = time_shift;
+	state_local.fit = fit;
+	state_local.k = k;
+
+	if (NULL != (state = (zbx_forecast_state_t *)zbx_hashset_search(&forecast_states, &state_local)))
+	{
+		forecast_state_update(state, values);
+		return state;
+	}
+
+	if (ZBX_FORECAST_STATES_MAX <= forecast_states.num_data)
+		zbx_hashset_clear(&forecast_states);
+
+	state = (zbx_forecast_state_t *)zbx_hashset_insert(&forecast_states, &state_local, sizeof(state_local));
+	zbx_vector_history_record_create(&state->values);
+	forecast_state_rebuild(state, values);
+
+	return state;
+}
+
 /******************************************************************************
  *                                                                            *
  * Function: evaluate_FORECAST                                                *
@@ -2323,6 +2633,7 @@ static int	evaluate_FORECAST(char *value, DC_ITEM *item, const char *parameters,
 	unsigned int			k = 0;
 	zbx_vector_history_record_t	values;
 	zbx_timespec_t			zero_time;
+	zbx_forecast_state_t		*state;
 	zbx_fit_t			fit;
 	zbx_mode_t			mode;
 	zbx_timespec_t			ts_end = *ts;
@@ -2412,7 +2723,14 @@ static int	evaluate_FORECAST(char *value, DC_ITEM *item, const char *parameters,
 		goto out;
 	}
 
-	if (0 < values.values_num)
+	if (NULL != (state = forecast_state_get(item, &values, seconds, nvalues, time_shift, fit, k)))
+	{
+		zero_time = values.values[values.values_num - 1].timestamp;
+		zbx_snprintf(value, MAX_BUFFER_LEN, ZBX_FS_DBL, zbx_regression_forecast(&state->regression,
+				forecast_state_shift(state, &zero_time), ts->sec - zero_time.sec - 1.0e-9 *
+				(zero_time.ns + 1), time, mode));
+	}
+	else if (0 < values.values_num)
 	{
 		t = (double *)zbx_malloc(t, values.values_num * sizeof(double));
 		x = (double *)zbx_malloc(x, values.values_num * sizeof(double));
@@ -2486,6 +2804,7 @@ static int	evaluate_TIMELEFT(char *value, DC_ITEM *item, const char *parameters,
 	unsigned			k = 0;
 	zbx_vector_history_record_t	values;
 	zbx_timespec_t			zero_time;
+	zbx_forecast_state_t		*state;
 	zbx_fit_t			fit;
 	zbx_timespec_t			ts_end = *ts;
 
@@ -2566,7 +2885,14 @@ static int	evaluate_TIMELEFT(char *value, DC_ITEM *item, const char *parameters,
 		goto out;
 	}
 
-	if (0 < values.values_num)
+	if (NULL != (state = forecast_state_get(item, &values, seconds, nvalues, time_shift, fit, k)))
+	{
+		zero_time = values.values[values.values_num - 1].timestamp;
+		zbx_snprintf(value, MAX_BUFFER_LEN, ZBX_FS_DBL, zbx_regression_timeleft(&state->regression,
+				forecast_state_shift(state, &zero_time), ts->sec - zero_time.sec - 1.0e-9 *
+				(zero_time.ns + 1), threshold));
+	}
+	else if (0 < values.values_num)
 	{
 		t = (double *)zbx_malloc(t, values.values_num * sizeof(double));
 		x = (double *)zbx_malloc(x, values.values_num * sizeof(double));
@@ -3256,6 +3582,66 @@ int	evaluate_macro_function(char **result, const char *host, const char *key, co
 	return ret;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: evaluate_function_period                                         *
+ *                                                                            *
+ * Purpose: get the time period of history values the function will request  *
+ *          from value cache                                                  *
+ *                                                                            *
+ * Parameters: item       - [IN] item (performance metric)                    *
+ *             function   - [IN] function name                                *
+ *             parameters - [IN] function parameters                          *
+ *             ts         - [IN] the function evaluation time                 *
+ *             seconds    - [OUT] the requested period length                 *
+ *             ts_end     - [OUT] the requested period end                    *
+ *                                                                            *
+ * Return value: SUCCEED - the function requests values for a time period     *
+ *               FAIL - the function does not request values for a time       *
+ *                      period or the parameters are invalid                  *
+ *                                                                            *
+ * Comments: Only the functions with time period as the first and time shift  *
+ *           as the following parameter are supported. The period is used to  *
+ *           prefetch values of multiple items before function evaluation.    *
+ *                                                                            *
+ ******************************************************************************/
+int	evaluate_function_period(const DC_ITEM *item, const char *function, const char *parameters,
+		const zbx_timespec_t *ts, int *seconds, zbx_timespec_t *ts_end)
+{
+	int			Nparam, time_shift = 0;
+	zbx_value_type_t	type, time_shift_type = ZBX_VALUE_SECONDS;
+
+	if (0 == strcmp(function, "avg") || 0 == strcmp(function, "min") || 0 == strcmp(function, "max") ||
+			0 == strcmp(function, "sum") || 0 == strcmp(function, "delta") ||
+			0 == strcmp(function, "percentile") || 0 == strcmp(function, "forecast") ||
+			0 == strcmp(function, "timeleft"))
+	{
+		Nparam = 2;
+	}
+	else if (0 == strcmp(function, "count"))
+		Nparam = 4;
+	else
+		return FAIL;
+
+	if (SUCCEED != get_function_parameter_int(item->host.hostid, parameters, 1, ZBX_PARAM_MANDATORY, seconds,
+			&type) || ZBX_VALUE_SECONDS != type || 0 >= *seconds)
+	{
+		return FAIL;
+	}
+
+	if (Nparam <= num_param(parameters) && (SUCCEED != get_function_parameter_int(item->host.hostid, parameters,
+			Nparam, ZBX_PARAM_OPTIONAL, &time_shift, &time_shift_type) ||
+			ZBX_VALUE_SECONDS != time_shift_type || 0 > time_shift))
+	{
+		return FAIL;
+	}
+
+	*ts_end = *ts;
+	ts_end->sec -= time_shift;
+
+	return SUCCEED;
+}
+
 /******************************************************************************
  *                                                                            *
  * Function: evaluatable_for_notsupported                                     *
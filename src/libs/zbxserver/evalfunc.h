@@ -20,8 +20,21 @@
 #ifndef ZABBIX_EVALFUNC_H
 #define ZABBIX_EVALFUNC_H
 
+/* nodata() function evaluated together with other nodata() functions of the same item */
+typedef struct
+{
+	const char	*parameters;	/* [IN] the function parameters */
+	int		value;		/* [OUT] the function value     */
+	int		ret;		/* [OUT] the evaluation result  */
+	char		*error;		/* [OUT] the evaluation error   */
+}
+zbx_nodata_func_t;
+
 int	evaluate_macro_function(char **result, const char *host, const char *key, const char *function,
 		const char *parameter);
 int	evaluatable_for_notsupported(const char *fn);
+int	evaluate_function_period(const DC_ITEM *item, const char *function, const char *parameters,
+		const zbx_timespec_t *ts, int *seconds, zbx_timespec_t *ts_end);
+void	evaluate_nodata_functions(DC_ITEM *item, zbx_nodata_func_t *funcs, int funcs_num);
 
 #endif
@@ -927,6 +927,175 @@ int	zbx_substitute_item_name_macros(DC_ITEM *dc_item, const char *name, char **r
 	return ret;
 }
 
+/* item and host properties used by DBget_item_value() */
+typedef struct
+{
+	zbx_uint64_t	itemid;
+	zbx_uint64_t	proxy_hostid;
+	char		*host_description;
+	char		*name;
+	char		*key;
+	char		*description;
+}
+zbx_macro_item_t;
+
+/* the item properties cached for macro resolving in event batch */
+static zbx_hashset_t	macro_items;
+static int		macro_items_batch = 0;
+
+static void	macro_item_clean(void *data)
+{
+	zbx_macro_item_t	*item = (zbx_macro_item_t *)data;
+
+	zbx_free(item->host_description);
+	zbx_free(item->name);
+	zbx_free(item->key);
+	zbx_free(item->description);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: macro_items_load                                                 *
+ *                                                                            *
+ * Purpose: load item and host properties required to resolve item macros     *
+ *          into macro item cache                                             *
+ *                                                                            *
+ * Parameters: itemids - [IN] the item identifiers, sorted                    *
+ *                                                                            *
+ ******************************************************************************/
+static void	macro_items_load(const zbx_vector_uint64_t *itemids)
+{
+	DB_RESULT		result;
+	DB_ROW			row;
+	char			*sql = NULL;
+	size_t			sql_alloc = 0, sql_offset = 0;
+	zbx_macro_item_t	item_local, *item;
+
+	if (0 == macro_items.num_slots)
+	{
+		zbx_hashset_create_ext(&macro_items, 100, ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC,
+				macro_item_clean, ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC,
+				ZBX_DEFAULT_MEM_FREE_FUNC);
+	}
+
+	zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset,
+			"select i.itemid,h.proxy_hostid,h.description,i.name,i.key_,i.description"
+			" from items i"
+				" join hosts h on h.hostid=i.hostid"
+			" where");
+	DBadd_condition_alloc(&sql, &sql_alloc, &sql_offset, "i.itemid", itemids->values, itemids->values_num);
+
+	result = DBselect("%s", sql);
+
+	while (NULL != (row = DBfetch(result)))
+	{
+		ZBX_STR2UINT64(item_local.itemid, row[0]);
+
+		if (NULL != zbx_hashset_search(&macro_items, &item_local))
+			continue;
+
+		item = (zbx_macro_item_t *)zbx_hashset_insert(&macro_items, &item_local, sizeof(item_local));
+		ZBX_DBROW2UINT64(item->proxy_hostid, row[1]);
+		item->host_description = zbx_strdup(NULL, row[2]);
+		item->name = zbx_strdup(NULL, row[3]);
+		item->key = zbx_strdup(NULL, row[4]);
+		item->description = zbx_strdup(NULL, row[5]);
+	}
+	DBfree_result(result);
+
+	zbx_free(sql);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_macro_items_cache_prepare                                    *
+ *                                                                            *
+ * Purpose: load properties of items used in trigger expressions of the event *
+ *          batch with a single query, so that item macros in notification    *
+ *          messages of these events are resolved without further queries     *
+ *                                                                            *
+ * Parameters: events - [IN] the events (DB_EVENT *) to be processed          *
+ *                                                                            *
+ * Comments: The cache is kept until zbx_macro_items_cache_clear() is called. *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_macro_items_cache_prepare(const zbx_vector_ptr_t *events)
+{
+	zbx_vector_uint64_t	functionids, itemids;
+	DC_FUNCTION		*functions;
+	int			i, *errcodes;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() events:%d", __func__, events->values_num);
+
+	macro_items_batch = 1;
+
+	zbx_vector_uint64_create(&functionids);
+	zbx_vector_uint64_create(&itemids);
+
+	for (i = 0; i < events->values_num; i++)
+	{
+		const DB_EVENT	*event = (const DB_EVENT *)events->values[i];
+
+		if (EVENT_SOURCE_TRIGGERS != event->source || EVENT_OBJECT_TRIGGER != event->object ||
+				0 == event->trigger.triggerid)
+		{
+			continue;
+		}
+
+		get_functionids(&functionids, event->trigger.expression);
+		get_functionids(&functionids, event->trigger.recovery_expression);
+	}
+
+	if (0 != functionids.values_num)
+	{
+		zbx_vector_uint64_sort(&functionids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+		zbx_vector_uint64_uniq(&functionids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+		functions = (DC_FUNCTION *)zbx_malloc(NULL, sizeof(DC_FUNCTION) * functionids.values_num);
+		errcodes = (int *)zbx_malloc(NULL, sizeof(int) * functionids.values_num);
+
+		DCconfig_get_functions_by_functionids(functions, functionids.values, errcodes, functionids.values_num);
+
+		for (i = 0; i < functionids.values_num; i++)
+		{
+			if (SUCCEED == errcodes[i])
+				zbx_vector_uint64_append(&itemids, functions[i].itemid);
+		}
+
+		DCconfig_clean_functions(functions, errcodes, functionids.values_num);
+		zbx_free(errcodes);
+		zbx_free(functions);
+	}
+
+	if (0 != itemids.values_num)
+	{
+		zbx_vector_uint64_sort(&itemids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+		zbx_vector_uint64_uniq(&itemids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+		macro_items_load(&itemids);
+	}
+
+	zbx_vector_uint64_destroy(&itemids);
+	zbx_vector_uint64_destroy(&functionids);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s() items:%d", __func__, 0 != macro_items.num_slots ?
+			macro_items.num_data : 0);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_macro_items_cache_clear                                      *
+ *                                                                            *
+ * Purpose: drop item properties cached for the event batch                   *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_macro_items_cache_clear(void)
+{
+	macro_items_batch = 0;
+
+	if (0 != macro_items.num_slots)
+		zbx_hashset_clear(&macro_items);
+}
+
 /******************************************************************************
  *                                                                            *
  * Function: DBget_item_value                                                 *
@@ -936,14 +1105,16 @@ int	zbx_substitute_item_name_macros(DC_ITEM *dc_item, const char *name, char **r
  * Return value: upon successful completion return SUCCEED                    *
  *               otherwise FAIL                                               *
  *                                                                            *
+ * Comments: Item properties are taken from the macro item cache when the     *
+ *           item was loaded by zbx_macro_items_cache_prepare(), otherwise    *
+ *           they are read from database.                                     *
+ *                                                                            *
  ******************************************************************************/
 static int	DBget_item_value(zbx_uint64_t itemid, char **replace_to, int request)
 {
-	DB_RESULT	result;
-	DB_ROW		row;
-	DC_ITEM		dc_item;
-	zbx_uint64_t	proxy_hostid;
-	int		ret = FAIL, errcode;
+	zbx_macro_item_t	*item;
+	DC_ITEM			dc_item;
+	int			ret = FAIL, errcode;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
@@ -960,29 +1131,36 @@ static int	DBget_item_value(zbx_uint64_t itemid, char **replace_to, int request)
 			return get_host_value(itemid, replace_to, request);
 	}
 
-	result = DBselect(
-			"select h.proxy_hostid,h.description,i.itemid,i.name,i.key_,i.description"
-			" from items i"
-				" join hosts h on h.hostid=i.hostid"
-			" where i.itemid=" ZBX_FS_UI64, itemid);
+	if (0 == macro_items.num_slots || NULL == (item = (zbx_macro_item_t *)zbx_hashset_search(&macro_items,
+			&itemid)))
+	{
+		zbx_vector_uint64_t	itemids;
 
-	if (NULL != (row = DBfetch(result)))
+		zbx_vector_uint64_create(&itemids);
+		zbx_vector_uint64_append(&itemids, itemid);
+		macro_items_load(&itemids);
+		zbx_vector_uint64_destroy(&itemids);
+
+		item = (zbx_macro_item_t *)zbx_hashset_search(&macro_items, &itemid);
+	}
+
+	if (NULL != item)
 	{
 		switch (request)
 		{
 			case ZBX_REQUEST_HOST_DESCRIPTION:
-				*replace_to = zbx_strdup(*replace_to, row[1]);
+				*replace_to = zbx_strdup(*replace_to, item->host_description);
 				ret = SUCCEED;
 				break;
 			case ZBX_REQUEST_ITEM_ID:
-				*replace_to = zbx_strdup(*replace_to, row[2]);
+				*replace_to = zbx_dsprintf(*replace_to, ZBX_FS_UI64, item->itemid);
 				ret = SUCCEED;
 				break;
 			case ZBX_REQUEST_ITEM_NAME:
 				DCconfig_get_items_by_itemids(&dc_item, &itemid, &errcode, 1);
 
 				if (SUCCEED == errcode)
-					ret = zbx_substitute_item_name_macros(&dc_item, row[3], replace_to);
+					ret = zbx_substitute_item_name_macros(&dc_item, item->name, replace_to);
 
 				DCconfig_clean_items(&dc_item, &errcode, 1);
 				break;
@@ -995,42 +1173,40 @@ static int	DBget_item_value(zbx_uint64_t itemid, char **replace_to, int request)
 				DCconfig_clean_items(&dc_item, &errcode, 1);
 				break;
 			case ZBX_REQUEST_ITEM_NAME_ORIG:
-				*replace_to = zbx_strdup(*replace_to, row[3]);
+				*replace_to = zbx_strdup(*replace_to, item->name);
 				ret = SUCCEED;
 				break;
 			case ZBX_REQUEST_ITEM_KEY_ORIG:
-				*replace_to = zbx_strdup(*replace_to, row[4]);
+				*replace_to = zbx_strdup(*replace_to, item->key);
 				ret = SUCCEED;
 				break;
 			case ZBX_REQUEST_ITEM_DESCRIPTION:
-				*replace_to = zbx_strdup(*replace_to, row[5]);
+				*replace_to = zbx_strdup(*replace_to, item->description);
 				ret = SUCCEED;
 				break;
 			case ZBX_REQUEST_PROXY_NAME:
-				ZBX_DBROW2UINT64(proxy_hostid, row[0]);
-
-				if (0 == proxy_hostid)
+				if (0 == item->proxy_hostid)
 				{
 					*replace_to = zbx_strdup(*replace_to, "");
 					ret = SUCCEED;
 				}
 				else
-					ret = DBget_host_value(proxy_hostid, replace_to, "host");
+					ret = DBget_host_value(item->proxy_hostid, replace_to, "host");
 				break;
 			case ZBX_REQUEST_PROXY_DESCRIPTION:
-				ZBX_DBROW2UINT64(proxy_hostid, row[0]);
-
-				if (0 == proxy_hostid)
+				if (0 == item->proxy_hostid)
 				{
 					*replace_to = zbx_strdup(*replace_to, "");
 					ret = SUCCEED;
 				}
 				else
-					ret = DBget_host_value(proxy_hostid, replace_to, "description");
+					ret = DBget_host_value(item->proxy_hostid, replace_to, "description");
 				break;
 		}
 	}
-	DBfree_result(result);
+
+	if (0 == macro_items_batch)
+		zbx_hashset_clear(&macro_items);
 
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
 
@@ -2753,6 +2929,73 @@ static void	resolve_opdata(const DB_EVENT *event, char **replace_to, char *error
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
 
+/* value of a macro already resolved in the same message */
+typedef struct
+{
+	char	*macro;
+	int	N_functionid;
+	int	raw_value;
+	int	ret;
+	char	*value;
+}
+zbx_macro_value_t;
+
+static void	macro_value_free(zbx_macro_value_t *macro_value)
+{
+	zbx_free(macro_value->macro);
+	zbx_free(macro_value->value);
+	zbx_free(macro_value);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: macro_values_find                                                *
+ *                                                                            *
+ * Purpose: find macro value resolved earlier in the same message             *
+ *                                                                            *
+ * Parameters: macro_values - [IN] the resolved macro values                  *
+ *             macro        - [IN] the macro name                             *
+ *             N_functionid - [IN] the macro index                            *
+ *             raw_value    - [IN] 1 - raw value was requested, 0 - otherwise *
+ *                                                                            *
+ * Return value: the resolved macro value or NULL if the macro was not        *
+ *               resolved yet                                                 *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_macro_value_t	*macro_values_find(const zbx_vector_ptr_t *macro_values, const char *macro,
+		int N_functionid, int raw_value)
+{
+	int	i;
+
+	for (i = 0; i < macro_values->values_num; i++)
+	{
+		zbx_macro_value_t	*macro_value = (zbx_macro_value_t *)macro_values->values[i];
+
+		if (N_functionid == macro_value->N_functionid && raw_value == macro_value->raw_value &&
+				0 == strcmp(macro, macro_value->macro))
+		{
+			return macro_value;
+		}
+	}
+
+	return NULL;
+}
+
+static void	macro_values_add(zbx_vector_ptr_t *macro_values, const char *macro, int N_functionid, int raw_value,
+		int ret, const char *value)
+{
+	zbx_macro_value_t	*macro_value;
+
+	macro_value = (zbx_macro_value_t *)zbx_malloc(NULL, sizeof(zbx_macro_value_t));
+	macro_value->macro = zbx_strdup(NULL, macro);
+	macro_value->N_functionid = N_functionid;
+	macro_value->raw_value = raw_value;
+	macro_value->ret = ret;
+	macro_value->value = (NULL != value ? zbx_strdup(NULL, value) : NULL);
+
+	zbx_vector_ptr_append(macro_values, macro_value);
+}
+
 /******************************************************************************
  *                                                                            *
  * Function: substitute_simple_macros                                         *
@@ -2761,6 +3004,9 @@ static void	resolve_opdata(const DB_EVENT *event, char **replace_to, char *error
  *                                                                            *
  * Author: Eugene Grigorjev                                                   *
  *                                                                            *
+ * Comments: In notification messages each distinct macro is resolved only    *
+ *           once, repeated occurrences reuse the first resolved value.       *
+ *                                                                            *
  ******************************************************************************/
 int	substitute_simple_macros(zbx_uint64_t *actionid, const DB_EVENT *event, const DB_EVENT *r_event,
 		zbx_uint64_t *userid, const zbx_uint64_t *hostid, const DC_HOST *dc_host, const DC_ITEM *dc_item,
@@ -2777,6 +3023,8 @@ int	substitute_simple_macros(zbx_uint64_t *actionid, const DB_EVENT *event, cons
 	zbx_token_t		token;
 	zbx_token_search_t	token_search;
 	char			*expression = NULL;
+	zbx_vector_ptr_t	macro_values;
+	zbx_macro_value_t	*macro_value;
 
 	if (NULL == data || NULL == *data || '\0' == **data)
 	{
@@ -2795,6 +3043,7 @@ int	substitute_simple_macros(zbx_uint64_t *actionid, const DB_EVENT *event, cons
 		return res;
 
 	zbx_vector_uint64_create(&hostids);
+	zbx_vector_ptr_create(&macro_values);
 
 	data_alloc = data_len = strlen(*data) + 1;
 
@@ -2872,8 +3121,20 @@ int	substitute_simple_macros(zbx_uint64_t *actionid, const DB_EVENT *event, cons
 		}
 
 		ret = SUCCEED;
+		macro_value = NULL;
 
 		if (0 != (macro_type & (MACRO_TYPE_MESSAGE_NORMAL | MACRO_TYPE_MESSAGE_RECOVERY |
+				MACRO_TYPE_MESSAGE_ACK)) &&
+				(ZBX_TOKEN_MACRO == token.type || ZBX_TOKEN_FUNC_MACRO == token.type) &&
+				NULL != (macro_value = macro_values_find(&macro_values, m, N_functionid, raw_value)))
+		{
+			/* the same macro was already resolved in this message */
+			if (NULL != macro_value->value)
+				replace_to = zbx_strdup(replace_to, macro_value->value);
+
+			ret = macro_value->ret;
+		}
+		else if (0 != (macro_type & (MACRO_TYPE_MESSAGE_NORMAL | MACRO_TYPE_MESSAGE_RECOVERY |
 				MACRO_TYPE_MESSAGE_ACK)))
 		{
 			const DB_EVENT	*c_event;
@@ -4466,6 +4727,14 @@ int	substitute_simple_macros(zbx_uint64_t *actionid, const DB_EVENT *event, cons
 			}
 		}
 
+		if (0 != (macro_type & (MACRO_TYPE_MESSAGE_NORMAL | MACRO_TYPE_MESSAGE_RECOVERY |
+				MACRO_TYPE_MESSAGE_ACK)) &&
+				(ZBX_TOKEN_MACRO == token.type || ZBX_TOKEN_FUNC_MACRO == token.type) &&
+				NULL == macro_value)
+		{
+			macro_values_add(&macro_values, m, N_functionid, raw_value, ret, replace_to);
+		}
+
 		if (0 != (macro_type & MACRO_TYPE_HTTP_JSON) && NULL != replace_to)
 			zbx_json_escape(&replace_to);
 
@@ -4541,6 +4810,8 @@ int	substitute_simple_macros(zbx_uint64_t *actionid, const DB_EVENT *event, cons
 
 	zbx_free(expression);
 	zbx_vector_uint64_destroy(&hostids);
+	zbx_vector_ptr_clear_ext(&macro_values, (zbx_clean_func_t)macro_value_free);
+	zbx_vector_ptr_destroy(&macro_values);
 
 	zabbix_log(LOG_LEVEL_DEBUG, "End %s() data:'%s'", __func__, *data);
 
@@ -4568,6 +4839,28 @@ static int	extract_expression_functionids(zbx_vector_uint64_t *functionids, cons
 	return (NULL == bl ? SUCCEED : FAIL);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: trigger_is_compiled                                              *
+ *                                                                            *
+ * Purpose: check if trigger expressions can be evaluated by compiled         *
+ *          programs                                                          *
+ *                                                                            *
+ * Comments: Either all expressions of the trigger are evaluated by compiled  *
+ *           programs or all are evaluated as text.                           *
+ *                                                                            *
+ ******************************************************************************/
+static int	trigger_is_compiled(const DC_TRIGGER *tr)
+{
+	if (NULL == tr->program)
+		return FAIL;
+
+	if (TRIGGER_RECOVERY_MODE_RECOVERY_EXPRESSION == tr->recovery_mode && NULL == tr->recovery_program)
+		return FAIL;
+
+	return SUCCEED;
+}
+
 static void	zbx_extract_functionids(zbx_vector_uint64_t *functionids, zbx_vector_ptr_t *triggers)
 {
 	DC_TRIGGER	*tr;
@@ -4584,6 +4877,16 @@ static void	zbx_extract_functionids(zbx_vector_uint64_t *functionids, zbx_vector
 		if (NULL != tr->new_error)
 			continue;
 
+		if (SUCCEED == trigger_is_compiled(tr))
+		{
+			zbx_expression_program_functionids(tr->program, functionids);
+
+			if (TRIGGER_RECOVERY_MODE_RECOVERY_EXPRESSION == tr->recovery_mode)
+				zbx_expression_program_functionids(tr->recovery_program, functionids);
+
+			continue;
+		}
+
 		values_num_save = functionids->values_num;
 
 		if (SUCCEED != extract_expression_functionids(functionids, tr->expression))
@@ -4687,11 +4990,21 @@ static void	zbx_link_triggers_with_functions(zbx_vector_ptr_t *triggers_func_pos
 		if (NULL != tr->new_error)
 			continue;
 
-		ev.value = tr->value;
+		if (NULL != tr->program)
+		{
+			zbx_expression_program_functionids(tr->program, &funcids);
+		}
+		else
+		{
+			ev.value = tr->value;
+
+			expand_trigger_macros(&ev, tr, NULL, 0);
 
-		expand_trigger_macros(&ev, tr, NULL, 0);
+			if (SUCCEED != extract_expression_functionids(&funcids, tr->expression))
+				zbx_vector_uint64_clear(&funcids);
+		}
 
-		if (SUCCEED == extract_expression_functionids(&funcids, tr->expression))
+		if (0 != funcids.values_num)
 		{
 			tr_func_pos = (zbx_trigger_func_position_t *)zbx_malloc(NULL, sizeof(zbx_trigger_func_position_t));
 			tr_func_pos->trigger = tr;
@@ -4786,6 +5099,11 @@ typedef struct
 	/* output data */
 	char		*value;
 	char		*error;
+
+	/* the output value converted for compiled trigger expressions, see zbx_func_set_numeric() */
+	int		numeric_ret;
+	double		numeric;
+	int		unknown_idx;
 }
 zbx_func_t;
 
@@ -4867,6 +5185,7 @@ static void	zbx_populate_function_items(const zbx_vector_uint64_t *functionids,
 
 	func_local.value = NULL;
 	func_local.error = NULL;
+	func_local.numeric_ret = FAIL;
 
 	functions = (DC_FUNCTION *)zbx_malloc(functions, sizeof(DC_FUNCTION) * functionids->values_num);
 	errcodes = (int *)zbx_malloc(errcodes, sizeof(int) * functionids->values_num);
@@ -4915,132 +5234,628 @@ static void	zbx_populate_function_items(const zbx_vector_uint64_t *functionids,
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s() ifuncs_num:%d", __func__, ifuncs->num_data);
 }
 
-static void	zbx_evaluate_item_functions(zbx_hashset_t *funcs, zbx_vector_ptr_t *unknown_msgs)
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_prefetch_item_functions                                      *
+ *                                                                            *
+ * Purpose: cache history values requested by time based functions of         *
+ *          multiple items with batched history storage requests              *
+ *                                                                            *
+ * Parameters: funcs    - [IN] the functions to evaluate                      *
+ *             itemids  - [IN] the sorted function item identifiers           *
+ *             items    - [IN] the function items                             *
+ *             errcodes - [IN] the item errors                                *
+ *                                                                            *
+ * Comments: Without prefetching each value cache miss is read from history   *
+ *           storage with a separate request, which is slow when many         *
+ *           triggers miss the cache at once (for example after value cache   *
+ *           reset).                                                          *
+ *                                                                            *
+ ******************************************************************************/
+static void	zbx_prefetch_item_functions(zbx_hashset_t *funcs, const zbx_vector_uint64_t *itemids,
+		const DC_ITEM *items, const int *errcodes)
 {
-	DC_ITEM			*items = NULL;
-	char			value[MAX_BUFFER_LEN], *error = NULL;
-	int			i;
+	zbx_vc_prefetch_t	*requests;
+	int			requests_num = 0, i;
 	zbx_func_t		*func;
-	zbx_vector_uint64_t	itemids;
-	int			*errcodes = NULL;
 	zbx_hashset_iter_t	iter;
 
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s() funcs_num:%d", __func__, funcs->num_data);
-
-	zbx_vector_uint64_create(&itemids);
-	zbx_vector_uint64_reserve(&itemids, funcs->num_data);
-
-	zbx_hashset_iter_reset(funcs, &iter);
-	while (NULL != (func = (zbx_func_t *)zbx_hashset_iter_next(&iter)))
-		zbx_vector_uint64_append(&itemids, func->itemid);
-
-	zbx_vector_uint64_sort(&itemids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
-	zbx_vector_uint64_uniq(&itemids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
-
-	items = (DC_ITEM *)zbx_malloc(items, sizeof(DC_ITEM) * (size_t)itemids.values_num);
-	errcodes = (int *)zbx_malloc(errcodes, sizeof(int) * (size_t)itemids.values_num);
-
-	DCconfig_get_items_by_itemids(items, itemids.values, errcodes, itemids.values_num);
+	requests = (zbx_vc_prefetch_t *)zbx_malloc(NULL, sizeof(zbx_vc_prefetch_t) * (size_t)funcs->num_data);
 
 	zbx_hashset_iter_reset(funcs, &iter);
 	while (NULL != (func = (zbx_func_t *)zbx_hashset_iter_next(&iter)))
 	{
-		int	ret_unknown = 0;	/* flag raised if current function evaluates to ZBX_UNKNOWN */
-		char	*unknown_msg;
+		zbx_vc_prefetch_t	*request = &requests[requests_num];
 
-		i = zbx_vector_uint64_bsearch(&itemids, func->itemid, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+		i = zbx_vector_uint64_bsearch(itemids, func->itemid, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
 
-		if (SUCCEED != errcodes[i])
+		if (SUCCEED != errcodes[i] || ITEM_STATUS_ACTIVE != items[i].status ||
+				HOST_STATUS_MONITORED != items[i].host.status)
 		{
-			func->error = zbx_dsprintf(func->error, "Cannot evaluate function \"%s(%s)\":"
-					" item does not exist.",
-					func->function, func->parameter);
 			continue;
 		}
 
-		/* do not evaluate if the item is disabled or belongs to a disabled host */
-
-		if (ITEM_STATUS_ACTIVE != items[i].status)
+		if (SUCCEED != evaluate_function_period(&items[i], func->function, func->parameter, &func->timespec,
+				&request->seconds, &request->ts))
 		{
-			func->error = zbx_dsprintf(func->error, "Cannot evaluate function \"%s:%s.%s(%s)\":"
-					" item is disabled.",
-					items[i].host.host, items[i].key_orig, func->function, func->parameter);
 			continue;
 		}
 
-		if (HOST_STATUS_MONITORED != items[i].host.status)
-		{
-			func->error = zbx_dsprintf(func->error, "Cannot evaluate function \"%s:%s.%s(%s)\":"
-					" item belongs to a disabled host.",
-					items[i].host.host, items[i].key_orig, func->function, func->parameter);
-			continue;
-		}
+		request->itemid = items[i].itemid;
+		request->value_type = items[i].value_type;
+		requests_num++;
+	}
 
-		/* If the item is NOTSUPPORTED then evaluation is allowed for:   */
-		/*   - time-based functions and nodata(). Their values can be    */
-		/*     evaluated to regular numbers even for NOTSUPPORTED items. */
-		/*   - other functions. Result of evaluation is ZBX_UNKNOWN.     */
+	/* a single request is read by function evaluation anyway */
+	if (1 < requests_num)
+		zbx_vc_prefetch_values(requests, requests_num);
 
-		if (ITEM_STATE_NOTSUPPORTED == items[i].state && FAIL == evaluatable_for_notsupported(func->function))
-		{
-			/* compose and store 'unknown' message for future use */
-			unknown_msg = zbx_dsprintf(NULL,
-					"Cannot evaluate function \"%s:%s.%s(%s)\": item is not supported.",
-					items[i].host.host, items[i].key_orig, func->function, func->parameter);
+	zbx_free(requests);
+}
 
-			zbx_free(func->error);
-			zbx_vector_ptr_append(unknown_msgs, unknown_msg);
-			ret_unknown = 1;
-		}
+/* the trigger function result cache, see func_result_get() */
+typedef struct
+{
+	zbx_uint64_t	itemid;
+	char		*function;
+	char		*parameter;
 
-		if (0 == ret_unknown && SUCCEED != evaluate_function(value, &items[i], func->function,
-				func->parameter, &func->timespec, &error))
-		{
-			/* compose and store error message for future use */
-			if (NULL != error)
-			{
-				unknown_msg = zbx_dsprintf(NULL,
-						"Cannot evaluate function \"%s:%s.%s(%s)\": %s.",
-						items[i].host.host, items[i].key_orig, func->function,
-						func->parameter, error);
+	/* the item data revision in value cache the value was calculated from */
+	zbx_uint64_t	revision;
 
-				zbx_free(func->error);
-				zbx_free(error);
-			}
-			else
-			{
-				unknown_msg = zbx_dsprintf(NULL,
-						"Cannot evaluate function \"%s:%s.%s(%s)\".",
-						items[i].host.host, items[i].key_orig,
-						func->function, func->parameter);
+	/* the evaluation batch the value was calculated in */
+	zbx_uint64_t	batch;
 
-				zbx_free(func->error);
-			}
+	char		*value;
+}
+zbx_func_result_t;
 
-			zbx_vector_ptr_append(unknown_msgs, unknown_msg);
-			ret_unknown = 1;
-		}
+/* the maximum number of cached function results, the cache is cleared when exceeded */
+#define ZBX_FUNC_RESULTS_MAX	100000
 
-		if (0 == ret_unknown)
-		{
-			func->value = zbx_strdup(func->value, value);
-		}
-		else
-		{
-			/* write a special token of unknown value with 'unknown' message number, like */
-			/* ZBX_UNKNOWN0, ZBX_UNKNOWN1 etc. not wrapped in () */
-			func->value = zbx_dsprintf(func->value, ZBX_UNKNOWN_STR "%d",
-					unknown_msgs->values_num - 1);
+static zbx_hashset_t	func_results;
+static zbx_uint64_t	func_results_batch, func_results_hits, func_results_misses;
+
+static zbx_hash_t	func_result_hash_func(const void *data)
+{
+	const zbx_func_result_t	*result = (const zbx_func_result_t *)data;
+	zbx_hash_t		hash;
+
+	hash = ZBX_DEFAULT_UINT64_HASH_FUNC(&result->itemid);
+	hash = ZBX_DEFAULT_STRING_HASH_ALGO(result->function, strlen(result->function), hash);
+
+	return ZBX_DEFAULT_STRING_HASH_ALGO(result->parameter, strlen(result->parameter), hash);
+}
+
+static int	func_result_compare_func(const void *d1, const void *d2)
+{
+	const zbx_func_result_t	*result1 = (const zbx_func_result_t *)d1;
+	const zbx_func_result_t	*result2 = (const zbx_func_result_t *)d2;
+	int			ret;
+
+	ZBX_RETURN_IF_NOT_EQUAL(result1->itemid, result2->itemid);
+
+	if (0 != (ret = strcmp(result1->function, result2->function)))
+		return ret;
+
+	return strcmp(result1->parameter, result2->parameter);
+}
+
+static void	func_result_clean(void *data)
+{
+	zbx_func_result_t	*result = (zbx_func_result_t *)data;
+
+	zbx_free(result->function);
+	zbx_free(result->parameter);
+	zbx_free(result->value);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: func_result_cacheable                                            *
+ *                                                                            *
+ * Purpose: check if function result depends only on the newest item values   *
+ *                                                                            *
+ * Comments: Results of such functions are the same for any evaluation time   *
+ *           after the newest item value and can be reused until new values   *
+ *           are added to item.                                               *
+ *                                                                            *
+ ******************************************************************************/
+static int	func_result_cacheable(const zbx_func_t *func)
+{
+	/* functions of the newest values with optional #num parameter and without time shift */
+	static const char	*value_functions[] = {"last", "strlen", "prev", "abschange", "change", "diff",
+				"logeventid", "logseverity", "logsource", NULL};
+	/* functions of the last #num values without time shift */
+	static const char	*count_functions[] = {"avg", "min", "max", "sum", "delta", NULL};
+	const char		**name;
+
+	/* user macro values and global regular expressions can change without changing item values */
+	if (NULL != strpbrk(func->parameter, "{@"))
+		return FAIL;
+
+	for (name = value_functions; NULL != *name; name++)
+	{
+		if (0 == strcmp(*name, func->function))
+			return 1 >= num_param(func->parameter) ? SUCCEED : FAIL;
+	}
+
+	for (name = count_functions; NULL != *name; name++)
+	{
+		if (0 == strcmp(*name, func->function))
+			return '#' == *func->parameter && 1 == num_param(func->parameter) ? SUCCEED : FAIL;
+	}
+
+	return FAIL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: func_result_valid                                                *
+ *                                                                            *
+ * Purpose: check if function result calculated at the specified item data    *
+ *          revision can be cached                                            *
+ *                                                                            *
+ ******************************************************************************/
+static int	func_result_valid(const zbx_func_t *func, const zbx_vc_revision_t *revision)
+{
+	/* the item has no values in value cache */
+	if (0 == revision->revision)
+		return FAIL;
+
+	/* function is evaluated in the past, the newest item values are not used */
+	if (0 > zbx_timespec_compare(&func->timespec, &revision->ts))
+		return FAIL;
+
+	return func_result_cacheable(func);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: func_result_get                                                  *
+ *                                                                            *
+ * Purpose: get cached function result                                        *
+ *                                                                            *
+ * Parameters: func     - [IN/OUT] the function                               *
+ *             revision - [IN] the function item data revision in value cache *
+ *             batch    - [OUT] 1 if the result was calculated by the current *
+ *                              evaluation batch, 0 otherwise                 *
+ *                                                                            *
+ * Return value: SUCCEED - the function value was taken from cache            *
+ *               FAIL    - the function must be evaluated                     *
+ *                                                                            *
+ * Comments: The cache is shared by all trigger evaluations of the process -  *
+ *           the same function is not evaluated again for triggers with       *
+ *           different timestamps in one history sync batch, nor in the       *
+ *           following batches while no new values are added to the item.     *
+ *                                                                            *
+ ******************************************************************************/
+static int	func_result_get(zbx_func_t *func, const zbx_vc_revision_t *revision, int *batch)
+{
+	zbx_func_result_t	*result, result_local;
+
+	if (SUCCEED != func_result_valid(func, revision))
+		return FAIL;
+
+	result_local.itemid = func->itemid;
+	result_local.function = func->function;
+	result_local.parameter = func->parameter;
+
+	if (NULL == (result = (zbx_func_result_t *)zbx_hashset_search(&func_results, &result_local)) ||
+			result->revision != revision->revision)
+	{
+		func_results_misses++;
+		return FAIL;
+	}
+
+	func->value = zbx_strdup(func->value, result->value);
+	*batch = (result->batch == func_results_batch);
+	func_results_hits++;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: func_result_put                                                  *
+ *                                                                            *
+ * Purpose: cache function result                                             *
+ *                                                                            *
+ * Parameters: func     - [IN] the evaluated function                         *
+ *             revision - [IN] the function item data revision in value cache *
+ *                             before function was evaluated                  *
+ *                                                                            *
+ ******************************************************************************/
+static void	func_result_put(const zbx_func_t *func, const zbx_vc_revision_t *revision)
+{
+	zbx_func_result_t	*result, result_local;
+
+	if (SUCCEED != func_result_valid(func, revision))
+		return;
+
+	result_local.itemid = func->itemid;
+	result_local.function = func->function;
+	result_local.parameter = func->parameter;
+
+	if (NULL == (result = (zbx_func_result_t *)zbx_hashset_search(&func_results, &result_local)))
+	{
+		if (ZBX_FUNC_RESULTS_MAX <= func_results.num_data)
+			zbx_hashset_clear(&func_results);
+
+		result = (zbx_func_result_t *)zbx_hashset_insert(&func_results, &result_local, sizeof(result_local));
+		result->function = zbx_strdup(NULL, func->function);
+		result->parameter = zbx_strdup(NULL, func->parameter);
+		result->value = NULL;
+	}
+
+	result->revision = revision->revision;
+	result->batch = func_results_batch;
+	result->value = zbx_strdup(result->value, func->value);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_get_function_results_stats                                   *
+ *                                                                            *
+ * Purpose: get function result cache statistics of the current process       *
+ *                                                                            *
+ * Parameters: hits   - [OUT] the number of function values taken from cache  *
+ *             misses - [OUT] the number of cacheable functions evaluated     *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_get_function_results_stats(zbx_uint64_t *hits, zbx_uint64_t *misses)
+{
+	*hits = func_results_hits;
+	*misses = func_results_misses;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_func_set_unknown                                             *
+ *                                                                            *
+ * Purpose: set function value to Unknown with the message about its origin   *
+ *                                                                            *
+ * Parameters: func         - [IN/OUT] the function                           *
+ *             item         - [IN] the function item                          *
+ *             error        - [IN] the evaluation error, optional; freed by   *
+ *                                 this function                              *
+ *             unknown_msgs - [IN/OUT] the Unknown messages                   *
+ *                                                                            *
+ ******************************************************************************/
+static void	zbx_func_set_unknown(zbx_func_t *func, const DC_ITEM *item, char *error,
+		zbx_vector_ptr_t *unknown_msgs)
+{
+	char	*unknown_msg;
+
+	/* compose and store error message for future use */
+	if (NULL != error)
+	{
+		unknown_msg = zbx_dsprintf(NULL, "Cannot evaluate function \"%s:%s.%s(%s)\": %s.", item->host.host,
+				item->key_orig, func->function, func->parameter, error);
+
+		zbx_free(error);
+	}
+	else
+	{
+		unknown_msg = zbx_dsprintf(NULL, "Cannot evaluate function \"%s:%s.%s(%s)\".", item->host.host,
+				item->key_orig, func->function, func->parameter);
+	}
+
+	zbx_free(func->error);
+	zbx_vector_ptr_append(unknown_msgs, unknown_msg);
+
+	/* write a special token of unknown value with 'unknown' message number, like */
+	/* ZBX_UNKNOWN0, ZBX_UNKNOWN1 etc. not wrapped in () */
+	func->value = zbx_dsprintf(func->value, ZBX_UNKNOWN_STR "%d", unknown_msgs->values_num - 1);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_evaluate_item_function                                       *
+ *                                                                            *
+ * Purpose: evaluate function, storing its value or Unknown with the message  *
+ *          about its origin                                                  *
+ *                                                                            *
+ * Return value: SUCCEED - the function was evaluated                         *
+ *               FAIL    - the function evaluates to Unknown                  *
+ *                                                                            *
+ ******************************************************************************/
+static int	zbx_evaluate_item_function(zbx_func_t *func, DC_ITEM *item, zbx_vector_ptr_t *unknown_msgs)
+{
+	char	value[MAX_BUFFER_LEN], *error = NULL;
+
+	if (SUCCEED == evaluate_function(value, item, func->function, func->parameter, &func->timespec, &error))
+	{
+		func->value = zbx_strdup(func->value, value);
+		return SUCCEED;
+	}
+
+	zbx_func_set_unknown(func, item, error, unknown_msgs);
+
+	return FAIL;
+}
+
+static int	zbx_func_compare_by_itemid(const void *d1, const void *d2)
+{
+	const zbx_func_t	*f1 = *(const zbx_func_t **)d1;
+	const zbx_func_t	*f2 = *(const zbx_func_t **)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(f1->itemid, f2->itemid);
+
+	return 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_evaluate_nodata_functions                                    *
+ *                                                                            *
+ * Purpose: evaluate nodata() functions grouped by items                      *
+ *                                                                            *
+ * Parameters: nodata_funcs - [IN/OUT] the nodata() functions                 *
+ *             itemids      - [IN] the sorted function itemids                *
+ *             items        - [IN] the function items                         *
+ *             unknown_msgs - [IN/OUT] the Unknown messages                   *
+ *                                                                            *
+ * Comments: Timer triggers are evaluated in batches with the same timestamp, *
+ *           so the same item usually has several nodata() functions with     *
+ *           different periods. Such functions share the latest item value    *
+ *           lookup instead of reading value cache for each of them.          *
+ *                                                                            *
+ ******************************************************************************/
+static void	zbx_evaluate_nodata_functions(zbx_vector_ptr_t *nodata_funcs, const zbx_vector_uint64_t *itemids,
+		DC_ITEM *items, zbx_vector_ptr_t *unknown_msgs)
+{
+	zbx_nodata_func_t	*evals;
+	int			i, j, k, index;
+
+	evals = (zbx_nodata_func_t *)zbx_malloc(NULL, sizeof(zbx_nodata_func_t) * (size_t)nodata_funcs->values_num);
+
+	zbx_vector_ptr_sort(nodata_funcs, zbx_func_compare_by_itemid);
+
+	for (i = 0; i < nodata_funcs->values_num; i = j)
+	{
+		zbx_func_t	*func = (zbx_func_t *)nodata_funcs->values[i];
+
+		for (j = i; j < nodata_funcs->values_num; j++)
+		{
+			if (((zbx_func_t *)nodata_funcs->values[j])->itemid != func->itemid)
+				break;
+
+			evals[j - i].parameters = ((zbx_func_t *)nodata_funcs->values[j])->parameter;
+		}
+
+		index = zbx_vector_uint64_bsearch(itemids, func->itemid, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+		evaluate_nodata_functions(&items[index], evals, j - i);
+
+		for (k = i; k < j; k++)
+		{
+			zbx_nodata_func_t	*eval = &evals[k - i];
+
+			func = (zbx_func_t *)nodata_funcs->values[k];
+
+			if (SUCCEED == eval->ret)
+				func->value = zbx_dsprintf(func->value, "%d", eval->value);
+			else
+				zbx_func_set_unknown(func, &items[index], eval->error, unknown_msgs);
+		}
+	}
+
+	zbx_free(evals);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_func_set_numeric                                             *
+ *                                                                            *
+ * Purpose: convert function value for compiled trigger expressions           *
+ *                                                                            *
+ * Comments: The value is converted once per evaluated function instead of    *
+ *           once per trigger expression using it. The conversion result is   *
+ *           SUCCEED for numbers and Unknown values, NOTSUPPORTED for values  *
+ *           that are not plain numbers and FAIL if there is no value.        *
+ *                                                                            *
+ ******************************************************************************/
+static void	zbx_func_set_numeric(zbx_func_t *func)
+{
+	const char	*ptr;
+	int		len;
+
+	func->numeric_ret = NOTSUPPORTED;
+
+	if (NULL == func->value)
+	{
+		func->numeric_ret = FAIL;
+		return;
+	}
+
+	if (0 == strncmp(func->value, ZBX_UNKNOWN_STR, ZBX_UNKNOWN_STR_LEN))
+	{
+		ptr = func->value + ZBX_UNKNOWN_STR_LEN;
+
+		if ('\0' == *ptr || strlen(ptr) != strspn(ptr, "0123456789"))
+			return;
+
+		func->numeric = ZBX_UNKNOWN;
+		func->unknown_idx = atoi(ptr);
+		func->numeric_ret = SUCCEED;
+
+		return;
+	}
+
+	ptr = ('-' == *func->value ? func->value + 1 : func->value);
+
+	if (SUCCEED != zbx_suffixed_number_parse(ptr, &len) || '\0' != ptr[len])
+		return;
+
+	func->numeric = atof(ptr) * suffix2factor(ptr[len - 1]);
+
+	if (ptr != func->value)
+		func->numeric = -func->numeric;
+
+	func->unknown_idx = -1;
+	func->numeric_ret = SUCCEED;
+}
+
+static void	zbx_evaluate_item_functions(zbx_hashset_t *funcs, zbx_vector_ptr_t *unknown_msgs)
+{
+	DC_ITEM			*items = NULL;
+	int			i, j, batch;
+	zbx_func_t		*func;
+	zbx_vector_uint64_t	itemids;
+	int			*errcodes = NULL;
+	zbx_hashset_iter_t	iter;
+	zbx_vc_revision_t	*revisions;
+	zbx_vector_ptr_t	rechecks, nodata_funcs;
+	zbx_uint64_t		hits = func_results_hits, misses = func_results_misses;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() funcs_num:%d", __func__, funcs->num_data);
+
+	if (0 == func_results.num_slots)
+	{
+		zbx_hashset_create_ext(&func_results, 100, func_result_hash_func, func_result_compare_func,
+				func_result_clean, ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC,
+				ZBX_DEFAULT_MEM_FREE_FUNC);
+	}
+
+	func_results_batch++;
+
+	zbx_vector_uint64_create(&itemids);
+	zbx_vector_uint64_reserve(&itemids, funcs->num_data);
+	zbx_vector_ptr_create(&rechecks);
+	zbx_vector_ptr_create(&nodata_funcs);
+
+	zbx_hashset_iter_reset(funcs, &iter);
+	while (NULL != (func = (zbx_func_t *)zbx_hashset_iter_next(&iter)))
+		zbx_vector_uint64_append(&itemids, func->itemid);
+
+	zbx_vector_uint64_sort(&itemids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	zbx_vector_uint64_uniq(&itemids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+	items = (DC_ITEM *)zbx_malloc(items, sizeof(DC_ITEM) * (size_t)itemids.values_num);
+	errcodes = (int *)zbx_malloc(errcodes, sizeof(int) * (size_t)itemids.values_num);
+	revisions = (zbx_vc_revision_t *)zbx_malloc(NULL, sizeof(zbx_vc_revision_t) * (size_t)itemids.values_num);
+
+	DCconfig_get_items_by_itemids(items, itemids.values, errcodes, itemids.values_num);
+
+	zbx_prefetch_item_functions(funcs, &itemids, items, errcodes);
+
+	/* cached function results are valid only if item revisions are read before evaluating functions */
+	zbx_vc_get_revisions(itemids.values, itemids.values_num, revisions);
+
+	zbx_hashset_iter_reset(funcs, &iter);
+	while (NULL != (func = (zbx_func_t *)zbx_hashset_iter_next(&iter)))
+	{
+		char	*unknown_msg;
+
+		i = zbx_vector_uint64_bsearch(&itemids, func->itemid, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+		if (SUCCEED != errcodes[i])
+		{
+			func->error = zbx_dsprintf(func->error, "Cannot evaluate function \"%s(%s)\":"
+					" item does not exist.",
+					func->function, func->parameter);
+			continue;
+		}
+
+		/* do not evaluate if the item is disabled or belongs to a disabled host */
+
+		if (ITEM_STATUS_ACTIVE != items[i].status)
+		{
+			func->error = zbx_dsprintf(func->error, "Cannot evaluate function \"%s:%s.%s(%s)\":"
+					" item is disabled.",
+					items[i].host.host, items[i].key_orig, func->function, func->parameter);
+			continue;
+		}
+
+		if (HOST_STATUS_MONITORED != items[i].host.status)
+		{
+			func->error = zbx_dsprintf(func->error, "Cannot evaluate function \"%s:%s.%s(%s)\":"
+					" item belongs to a disabled host.",
+					items[i].host.host, items[i].key_orig, func->function, func->parameter);
+			continue;
+		}
+
+		/* If the item is NOTSUPPORTED then evaluation is allowed for:   */
+		/*   - time-based functions and nodata(). Their values can be    */
+		/*     evaluated to regular numbers even for NOTSUPPORTED items. */
+		/*   - other functions. Result of evaluation is ZBX_UNKNOWN.     */
+
+		if (ITEM_STATE_NOTSUPPORTED == items[i].state && FAIL == evaluatable_for_notsupported(func->function))
+		{
+			/* compose and store 'unknown' message for future use */
+			unknown_msg = zbx_dsprintf(NULL,
+					"Cannot evaluate function \"%s:%s.%s(%s)\": item is not supported.",
+					items[i].host.host, items[i].key_orig, func->function, func->parameter);
+
+			zbx_free(func->error);
+			zbx_vector_ptr_append(unknown_msgs, unknown_msg);
+
+			/* write a special token of unknown value with 'unknown' message number, like */
+			/* ZBX_UNKNOWN0, ZBX_UNKNOWN1 etc. not wrapped in () */
+			func->value = zbx_dsprintf(func->value, ZBX_UNKNOWN_STR "%d",
+					unknown_msgs->values_num - 1);
+			continue;
+		}
+
+		if (0 == strcmp(func->function, "nodata"))
+		{
+			zbx_vector_ptr_append(&nodata_funcs, func);
+			continue;
+		}
+
+		if (SUCCEED == func_result_get(func, &revisions[i], &batch))
+		{
+			if (0 != batch)
+				zbx_vector_ptr_append(&rechecks, func);
+			continue;
+		}
+
+		if (SUCCEED == zbx_evaluate_item_function(func, &items[i], unknown_msgs))
+			func_result_put(func, &revisions[i]);
+	}
+
+	if (0 != nodata_funcs.values_num)
+		zbx_evaluate_nodata_functions(&nodata_funcs, &itemids, items, unknown_msgs);
+
+	/* Results calculated by this batch might include item values added by other processes after */
+	/* the revisions were read. Such values can be newer than the timestamps of functions reusing */
+	/* these results, so evaluate the functions again if their item revisions have changed.     */
+	if (0 != rechecks.values_num)
+	{
+		zbx_vc_revision_t	*revisions_now;
+
+		revisions_now = (zbx_vc_revision_t *)zbx_malloc(NULL,
+				sizeof(zbx_vc_revision_t) * (size_t)itemids.values_num);
+
+		zbx_vc_get_revisions(itemids.values, itemids.values_num, revisions_now);
+
+		for (j = 0; j < rechecks.values_num; j++)
+		{
+			func = (zbx_func_t *)rechecks.values[j];
+			i = zbx_vector_uint64_bsearch(&itemids, func->itemid, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+			if (revisions[i].revision != revisions_now[i].revision)
+				zbx_evaluate_item_function(func, &items[i], unknown_msgs);
 		}
+
+		zbx_free(revisions_now);
 	}
 
+	zbx_hashset_iter_reset(funcs, &iter);
+	while (NULL != (func = (zbx_func_t *)zbx_hashset_iter_next(&iter)))
+		zbx_func_set_numeric(func);
+
 	DCconfig_clean_items(items, errcodes, itemids.values_num);
 	zbx_vector_uint64_destroy(&itemids);
+	zbx_vector_ptr_destroy(&rechecks);
+	zbx_vector_ptr_destroy(&nodata_funcs);
 
+	zbx_free(revisions);
 	zbx_free(errcodes);
 	zbx_free(items);
 
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s() cached results:%d hits:" ZBX_FS_UI64 " misses:" ZBX_FS_UI64,
+			__func__, func_results.num_data, func_results_hits - hits, func_results_misses - misses);
 }
 
 static int	substitute_expression_functions_results(zbx_hashset_t *ifuncs, char *expression, char **out,
@@ -5123,7 +5938,8 @@ static void	zbx_substitute_functions_results(zbx_hashset_t *ifuncs, zbx_vector_p
 	{
 		tr = (DC_TRIGGER *)triggers->values[i];
 
-		if (NULL != tr->new_error)
+		/* compiled programs take function values directly from ifuncs */
+		if (NULL != tr->new_error || SUCCEED == trigger_is_compiled(tr))
 			continue;
 
 		if( SUCCEED != substitute_expression_functions_results(ifuncs, tr->expression, &out, &out_alloc,
@@ -5164,8 +5980,11 @@ static void	zbx_substitute_functions_results(zbx_hashset_t *ifuncs, zbx_vector_p
  *                                                                            *
  * Purpose: substitute expression functions with their values                 *
  *                                                                            *
- * Parameters: triggers - [IN] vector of DC_TRIGGGER pointers, sorted by      *
- *                             triggerids                                     *
+ * Parameters: triggers     - [IN] vector of DC_TRIGGGER pointers, sorted by  *
+ *                                 triggerids                                 *
+ *             funcs        - [OUT] functions indexed by itemid, name,        *
+ *                                  parameter, timestamp                      *
+ *             ifuncs       - [OUT] function index by functionid              *
  *             unknown_msgs - vector for storing messages for NOTSUPPORTED    *
  *                            items and failed functions                      *
  *                                                                            *
@@ -5173,11 +5992,14 @@ static void	zbx_substitute_functions_results(zbx_hashset_t *ifuncs, zbx_vector_p
  *                                                                            *
  * Comments: example: "({15}>10) or ({123}=1)" => "(26.416>10) or (0=1)"      *
  *                                                                            *
+ *           Expressions of compiled triggers are left unchanged, their       *
+ *           programs use function values from ifuncs index.                  *
+ *                                                                            *
  ******************************************************************************/
-static void	substitute_functions(zbx_vector_ptr_t *triggers, zbx_vector_ptr_t *unknown_msgs)
+static void	substitute_functions(zbx_vector_ptr_t *triggers, zbx_hashset_t *funcs, zbx_hashset_t *ifuncs,
+		zbx_vector_ptr_t *unknown_msgs)
 {
 	zbx_vector_uint64_t	functionids;
-	zbx_hashset_t		ifuncs, funcs;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
@@ -5187,28 +6009,146 @@ static void	substitute_functions(zbx_vector_ptr_t *triggers, zbx_vector_ptr_t *u
 	if (0 == functionids.values_num)
 		goto empty;
 
-	zbx_hashset_create(&ifuncs, triggers->values_num, ZBX_DEFAULT_UINT64_HASH_FUNC,
-			ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	zbx_populate_function_items(&functionids, funcs, ifuncs, triggers);
 
-	zbx_hashset_create_ext(&funcs, triggers->values_num, func_hash_func, func_compare_func, func_clean,
-				ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC, ZBX_DEFAULT_MEM_FREE_FUNC);
-
-	zbx_populate_function_items(&functionids, &funcs, &ifuncs, triggers);
-
-	if (0 != ifuncs.num_data)
+	if (0 != ifuncs->num_data)
 	{
-		zbx_evaluate_item_functions(&funcs, unknown_msgs);
-		zbx_substitute_functions_results(&ifuncs, triggers);
+		zbx_evaluate_item_functions(funcs, unknown_msgs);
+		zbx_substitute_functions_results(ifuncs, triggers);
 	}
-
-	zbx_hashset_destroy(&ifuncs);
-	zbx_hashset_destroy(&funcs);
 empty:
 	zbx_vector_uint64_destroy(&functionids);
 
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: trigger_function_value                                           *
+ *                                                                            *
+ * Purpose: get function value for compiled expression program                *
+ *                                                                            *
+ * Parameters: functionid    - [IN] the function identifier                   *
+ *             data          - [IN] the function index by functionid          *
+ *             value         - [OUT] the function value                       *
+ *             unknown_idx   - [OUT] the index of message about origin of     *
+ *                                   Unknown value                            *
+ *             error         - [OUT] the error message buffer                 *
+ *             max_error_len - [IN] the error buffer size                     *
+ *                                                                            *
+ * Return value: SUCCEED      - the function value was returned               *
+ *               FAIL         - the function was not evaluated                *
+ *               NOTSUPPORTED - the function value is not a plain number,     *
+ *                              expression must be evaluated as text          *
+ *                                                                            *
+ ******************************************************************************/
+static int	trigger_function_value(zbx_uint64_t functionid, void *data, double *value, int *unknown_idx,
+		char *error, size_t max_error_len)
+{
+	zbx_hashset_t	*ifuncs = (zbx_hashset_t *)data;
+	zbx_ifunc_t	*ifunc;
+	zbx_func_t	*func;
+
+	if (NULL == (ifunc = (zbx_ifunc_t *)zbx_hashset_search(ifuncs, &functionid)))
+	{
+		zbx_snprintf(error, max_error_len, "Cannot obtain function and item for functionid: " ZBX_FS_UI64,
+				functionid);
+		return FAIL;
+	}
+
+	func = ifunc->func;
+
+	if (NULL != func->error)
+	{
+		zbx_strlcpy(error, func->error, max_error_len);
+		return FAIL;
+	}
+
+	if (FAIL == func->numeric_ret)
+	{
+		zbx_strlcpy(error, "Unexpected error while processing a trigger expression", max_error_len);
+		return FAIL;
+	}
+
+	if (SUCCEED == func->numeric_ret)
+	{
+		*value = func->numeric;
+
+		if (0 <= func->unknown_idx)
+			*unknown_idx = func->unknown_idx;
+	}
+
+	return func->numeric_ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: evaluate_trigger_expression                                      *
+ *                                                                            *
+ * Purpose: evaluate trigger expression either by its compiled program or as  *
+ *          text with substituted function values                             *
+ *                                                                            *
+ * Parameters: result        - [OUT] the expression evaluation result         *
+ *             tr            - [IN] the trigger                               *
+ *             expression    - [IN] the expression                            *
+ *             program       - [IN] the compiled program, NULL if function    *
+ *                                  values are substituted in expression      *
+ *             ifuncs        - [IN] function index by functionid              *
+ *             unknown_msgs  - [IN] messages about origins of Unknown values  *
+ *             error         - [OUT] the error message buffer                 *
+ *             max_error_len - [IN] the error buffer size                     *
+ *                                                                            *
+ * Return value: SUCCEED - the expression was evaluated                       *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	evaluate_trigger_expression(double *result, const DC_TRIGGER *tr, const char *expression,
+		const unsigned char *program, zbx_hashset_t *ifuncs, zbx_vector_ptr_t *unknown_msgs, char *error,
+		size_t max_error_len)
+{
+	DB_EVENT	event;
+	char		*text, *out = NULL, *out_error = NULL;
+	size_t		out_alloc = 0;
+	int		ret;
+
+	if (NULL == program)
+		return evaluate(result, expression, error, max_error_len, unknown_msgs);
+
+	if (NOTSUPPORTED != (ret = zbx_expression_execute(result, program, tr->value, trigger_function_value,
+			ifuncs, unknown_msgs, error, max_error_len)))
+	{
+		return ret;
+	}
+
+	/* some function value cannot be used by compiled program, evaluate the expression as text */
+
+	zabbix_log(LOG_LEVEL_DEBUG, "%s() triggerid:" ZBX_FS_UI64 " falling back to text evaluation", __func__,
+			tr->triggerid);
+
+	event.object = EVENT_OBJECT_TRIGGER;
+	event.value = tr->value;
+	text = zbx_strdup(NULL, expression);
+
+	if (FAIL == substitute_simple_macros(NULL, &event, NULL, NULL, NULL, NULL, NULL, NULL, NULL, &text,
+			MACRO_TYPE_TRIGGER_EXPRESSION, error, max_error_len))
+	{
+		ret = FAIL;
+	}
+	else if (SUCCEED != substitute_expression_functions_results(ifuncs, text, &out, &out_alloc, &out_error))
+	{
+		zbx_strlcpy(error, out_error, max_error_len);
+		ret = FAIL;
+	}
+	else
+		ret = evaluate(result, out, error, max_error_len, unknown_msgs);
+
+	zbx_free(out_error);
+	zbx_free(out);
+	zbx_free(text);
+
+	return ret;
+}
+
 /******************************************************************************
  *                                                                            *
  * Function: evaluate_expressions                                             *
@@ -5229,6 +6169,8 @@ void	evaluate_expressions(zbx_vector_ptr_t *triggers)
 	double			expr_result;
 	zbx_vector_ptr_t	unknown_msgs;	    /* pointers to messages about origins of 'unknown' values */
 	char			err[MAX_STRING_LEN];
+	zbx_hashset_t		ifuncs, funcs;
+	const unsigned char	*program, *recovery_program;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() tr_num:%d", __func__, triggers->values_num);
 
@@ -5238,6 +6180,10 @@ void	evaluate_expressions(zbx_vector_ptr_t *triggers)
 	{
 		tr = (DC_TRIGGER *)triggers->values[i];
 
+		/* compiled programs resolve {TRIGGER.VALUE} macro during execution */
+		if (SUCCEED == trigger_is_compiled(tr))
+			continue;
+
 		event.value = tr->value;
 
 		if (SUCCEED != expand_trigger_macros(&event, tr, err, sizeof(err)))
@@ -5251,7 +6197,13 @@ void	evaluate_expressions(zbx_vector_ptr_t *triggers)
 	/* Therefore initialize error messages vector but do not reserve any space. */
 	zbx_vector_ptr_create(&unknown_msgs);
 
-	substitute_functions(triggers, &unknown_msgs);
+	zbx_hashset_create(&ifuncs, triggers->values_num, ZBX_DEFAULT_UINT64_HASH_FUNC,
+			ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+	zbx_hashset_create_ext(&funcs, triggers->values_num, func_hash_func, func_compare_func, func_clean,
+				ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC, ZBX_DEFAULT_MEM_FREE_FUNC);
+
+	substitute_functions(triggers, &funcs, &ifuncs, &unknown_msgs);
 
 	/* calculate new trigger values based on their recovery modes and expression evaluations */
 	for (i = 0; i < triggers->values_num; i++)
@@ -5261,7 +6213,16 @@ void	evaluate_expressions(zbx_vector_ptr_t *triggers)
 		if (NULL != tr->new_error)
 			continue;
 
-		if (SUCCEED != evaluate(&expr_result, tr->expression, err, sizeof(err), &unknown_msgs))
+		if (SUCCEED == trigger_is_compiled(tr))
+		{
+			program = tr->program;
+			recovery_program = tr->recovery_program;
+		}
+		else
+			program = recovery_program = NULL;
+
+		if (SUCCEED != evaluate_trigger_expression(&expr_result, tr, tr->expression, program, &ifuncs,
+				&unknown_msgs, err, sizeof(err)))
 		{
 			tr->new_error = zbx_strdup(tr->new_error, err);
 			tr->new_value = TRIGGER_VALUE_UNKNOWN;
@@ -5294,7 +6255,8 @@ void	evaluate_expressions(zbx_vector_ptr_t *triggers)
 			}
 
 			/* processing recovery expression mode */
-			if (SUCCEED != evaluate(&expr_result, tr->recovery_expression, err, sizeof(err), &unknown_msgs))
+			if (SUCCEED != evaluate_trigger_expression(&expr_result, tr, tr->recovery_expression,
+					recovery_program, &ifuncs, &unknown_msgs, err, sizeof(err)))
 			{
 				tr->new_error = zbx_strdup(tr->new_error, err);
 				tr->new_value = TRIGGER_VALUE_UNKNOWN;
@@ -5312,6 +6274,9 @@ void	evaluate_expressions(zbx_vector_ptr_t *triggers)
 		tr->new_value = TRIGGER_VALUE_NONE;
 	}
 
+	zbx_hashset_destroy(&ifuncs);
+	zbx_hashset_destroy(&funcs);
+
 	zbx_vector_ptr_clear_ext(&unknown_msgs, zbx_ptr_free);
 	zbx_vector_ptr_destroy(&unknown_msgs);
 
@@ -6262,3 +7227,7 @@ int	xml_xpath_check(const char *xpath, char *error, size_t errlen)
 	return SUCCEED;
 #endif
 }
+
+#ifdef HAVE_TESTS
+#	include "../../../tests/libs/zbxserver/expression_test.c"
+#endif
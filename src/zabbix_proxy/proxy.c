@@ -56,6 +56,7 @@
 #include "setproctitle.h"
 #include "zbxcrypto.h"
 #include "zbxipcservice.h"
+#include "preproc.h"
 #include "../zabbix_server/preprocessor/preproc_manager.h"
 #include "../zabbix_server/preprocessor/preproc_worker.h"
 
@@ -206,8 +207,16 @@ zbx_uint64_t	CONFIG_HISTORY_INDEX_CACHE_SIZE	= 4 * ZBX_MEBIBYTE;
 zbx_uint64_t	CONFIG_TRENDS_CACHE_SIZE	= 0;
 zbx_uint64_t	CONFIG_VALUE_CACHE_SIZE		= 0;
 zbx_uint64_t	CONFIG_VMWARE_CACHE_SIZE	= 8 * ZBX_MEBIBYTE;
+zbx_uint64_t	CONFIG_PREPROCESSING_CACHE_SIZE	= 16 * ZBX_MEBIBYTE;
 zbx_uint64_t	CONFIG_EXPORT_FILE_SIZE;
 
+int	CONFIG_VALUE_CACHE_EVICTION	= 0;
+int	CONFIG_VALUE_CACHE_QUOTA_FLOAT	= 0;
+int	CONFIG_VALUE_CACHE_QUOTA_STR	= 0;
+int	CONFIG_VALUE_CACHE_QUOTA_LOG	= 0;
+int	CONFIG_VALUE_CACHE_QUOTA_UINT64	= 0;
+int	CONFIG_VALUE_CACHE_QUOTA_TEXT	= 0;
+
 int	CONFIG_UNREACHABLE_PERIOD	= 45;
 int	CONFIG_UNREACHABLE_DELAY	= 15;
 int	CONFIG_UNAVAILABLE_DELAY	= 60;
@@ -276,6 +285,9 @@ static char	*CONFIG_SOCKET_PATH	= NULL;
 char	*CONFIG_HISTORY_STORAGE_URL		= NULL;
 char	*CONFIG_HISTORY_STORAGE_OPTS		= NULL;
 int	CONFIG_HISTORY_STORAGE_PIPELINES	= 0;
+int	CONFIG_HISTORY_STORAGE_DRAIN_TIMEOUT	= 0;
+char	*CONFIG_HISTORY_LOCAL_PATH		= NULL;
+int	CONFIG_HISTORY_LOCAL_RETENTION		= 7;
 
 char	*CONFIG_STATS_ALLOWED_IP	= NULL;
 
@@ -573,6 +585,20 @@ static void	zbx_validate_config(ZBX_TASK_EX *task)
 	/* because they have non-zero default values */
 #endif
 
+	if (CONFIG_PREPROCMAN_FORKS > CONFIG_PREPROCESSOR_FORKS)
+	{
+		zabbix_log(LOG_LEVEL_CRIT, "\"StartPreprocessingManagers\" configuration parameter must not be"
+				" greater than \"StartPreprocessors\"");
+		err = 1;
+	}
+
+	if (0 != CONFIG_PREPROCESSING_CACHE_SIZE && 128 * ZBX_KIBIBYTE > CONFIG_PREPROCESSING_CACHE_SIZE)
+	{
+		zabbix_log(LOG_LEVEL_CRIT, "\"PreprocessingCacheSize\" configuration parameter must be either 0"
+				" or greater than 128KB");
+		err = 1;
+	}
+
 	if (SUCCEED != zbx_validate_log_parameters(task))
 		err = 1;
 
@@ -774,6 +800,10 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 			PARM_OPT,	0,			0},
 		{"StartPreprocessors",		&CONFIG_PREPROCESSOR_FORKS,		TYPE_INT,
 			PARM_OPT,	1,			1000},
+		{"StartPreprocessingManagers",	&CONFIG_PREPROCMAN_FORKS,		TYPE_INT,
+			PARM_OPT,	1,			100},
+		{"PreprocessingCacheSize",	&CONFIG_PREPROCESSING_CACHE_SIZE,	TYPE_UINT64,
+			PARM_OPT,	0,			__UINT64_C(64) * ZBX_GIBIBYTE},
 		{NULL}
 	};
 
@@ -1039,6 +1069,13 @@ int	MAIN_ZABBIX_ENTRY(int flags)
 		exit(EXIT_FAILURE);
 	}
 
+	if (SUCCEED != zbx_preprocessor_init_cache(&error))
+	{
+		zabbix_log(LOG_LEVEL_CRIT, "cannot initialize preprocessing cache: %s", error);
+		zbx_free(error);
+		exit(EXIT_FAILURE);
+	}
+
 	if (SUCCEED != DBinit(&error))
 	{
 		zabbix_log(LOG_LEVEL_CRIT, "cannot initialize database: %s", error);
@@ -1223,6 +1260,8 @@ void	zbx_on_exit(int ret)
 	if (0 != CONFIG_VMWARE_FORKS)
 		zbx_vmware_destroy();
 
+	zbx_preprocessor_destroy_cache();
+
 	free_selfmon_collector();
 	free_proxy_history_lock();
 
@@ -27,6 +27,8 @@
 #include "dbcache.h"
 #include "dbsyncer.h"
 #include "export.h"
+#include "zbxserver.h"
+#include "zbxhistory.h"
 
 extern int		CONFIG_HISTSYNCER_FREQUENCY;
 extern unsigned char	process_type, program_type;
@@ -87,6 +89,7 @@ ZBX_THREAD_ENTRY(dbsyncer_thread, args)
 	char		*stats = NULL;
 	const char	*process_name;
 	size_t		stats_alloc = 0, stats_offset = 0;
+	zbx_uint64_t	func_hits, func_misses, last_func_hits = 0, last_func_misses = 0;
 
 	process_type = ((zbx_thread_args_t *)args)->process_type;
 	server_num = ((zbx_thread_args_t *)args)->server_num;
@@ -132,6 +135,11 @@ ZBX_THREAD_ENTRY(dbsyncer_thread, args)
 		/* database APIs might not handle signals correctly and hang, block signals to avoid hanging */
 		block_signals();
 		zbx_sync_history_cache(&values_num, &triggers_num, &more);
+
+		/* advance asynchronous history storage writes also when there were no new values */
+		if (0 != (program_type & ZBX_PROGRAM_TYPE_SERVER))
+			zbx_history_flush();
+
 		unblock_signals();
 
 		total_values_num += values_num;
@@ -149,6 +157,19 @@ ZBX_THREAD_ENTRY(dbsyncer_thread, args)
 			{
 				zbx_snprintf_alloc(&stats, &stats_alloc, &stats_offset, ", %d triggers",
 						total_triggers_num);
+
+				zbx_get_function_results_stats(&func_hits, &func_misses);
+
+				if (last_func_hits != func_hits || last_func_misses != func_misses)
+				{
+					zbx_snprintf_alloc(&stats, &stats_alloc, &stats_offset, " (" ZBX_FS_UI64 " of "
+							ZBX_FS_UI64 " cacheable functions reused)",
+							func_hits - last_func_hits,
+							func_hits - last_func_hits + func_misses - last_func_misses);
+
+					last_func_hits = func_hits;
+					last_func_misses = func_misses;
+				}
 			}
 
 			zbx_snprintf_alloc(&stats, &stats_alloc, &stats_offset, " in " ZBX_FS_DBL " sec", total_sec);
@@ -175,6 +196,10 @@ ZBX_THREAD_ENTRY(dbsyncer_thread, args)
 
 	zbx_log_sync_history_cache_progress();
 
+	/* send the history data still pending in asynchronous history storage */
+	if (0 != (program_type & ZBX_PROGRAM_TYPE_SERVER))
+		zbx_history_destroy();
+
 	zbx_free(stats);
 	DBclose();
 	exit(EXIT_SUCCESS);
@@ -2228,6 +2228,7 @@ static int	process_db_escalations(int now, int *nextcheck, zbx_vector_ptr_t *esc
 
 	get_db_actions_info(actionids, &actions);
 	zbx_db_get_events_by_eventids(eventids, &events);
+	zbx_macro_items_cache_prepare(&events);
 
 	for (i = 0; i < escalations->values_num; i++)
 	{
@@ -2461,6 +2462,8 @@ cancel_warning:
 
 	DBcommit();
 out:
+	zbx_macro_items_cache_clear();
+
 	zbx_vector_ptr_clear_ext(&diffs, zbx_ptr_free);
 	zbx_vector_ptr_destroy(&diffs);
 
@@ -43,6 +43,24 @@ static int	hk_period;
 /* global configuration data containing housekeeping configuration */
 static zbx_config_t	cfg;
 
+/* the periods of natively partitioned history and trends tables */
+#define HK_PARTITION_PERIOD_DAY		0
+#define HK_PARTITION_PERIOD_MONTH	1
+
+/* natively managed partitions are created this many seconds ahead */
+#define HK_PARTITION_AHEAD		SEC_PER_WEEK
+
+/* native history (trends) table partition */
+typedef struct
+{
+	char	*name;
+
+	/* the partition covers records with clock_from <= clock < clock_to */
+	int	clock_from;
+	int	clock_to;
+}
+zbx_hk_partition_t;
+
 /* Housekeeping rule definition.                                */
 /* A housekeeping rule describes table from which records older */
 /* than history setting must be removed according to optional   */
@@ -547,6 +565,479 @@ static void	hk_history_delete_queue_clear(zbx_hk_history_rule_t *rule)
 	zbx_vector_ptr_clear_ext(&rule->delete_queue, zbx_ptr_free);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: DBdelete_from_table                                              *
+ *                                                                            *
+ * Purpose: delete limited count of rows from table                           *
+ *                                                                            *
+ * Return value: number of deleted rows or less than 0 if an error occurred   *
+ *                                                                            *
+ ******************************************************************************/
+static int	DBdelete_from_table(const char *tablename, const char *filter, int limit)
+{
+	if (0 == limit)
+	{
+		return DBexecute(
+				"delete from %s"
+				" where %s",
+				tablename,
+				filter);
+	}
+	else
+	{
+#if defined(HAVE_ORACLE)
+		return DBexecute(
+				"delete from %s"
+				" where %s"
+					" and rownum<=%d",
+				tablename,
+				filter,
+				limit);
+#elif defined(HAVE_MYSQL)
+		return DBexecute(
+				"delete from %s"
+				" where %s limit %d",
+				tablename,
+				filter,
+				limit);
+#elif defined(HAVE_POSTGRESQL)
+		return DBexecute(
+				"delete from %s"
+				" where %s and ctid = any(array(select ctid from %s"
+					" where %s limit %d))",
+				tablename,
+				filter,
+				tablename,
+				filter,
+				limit);
+#elif defined(HAVE_SQLITE3)
+		return DBexecute(
+				"delete from %s"
+				" where %s",
+				tablename,
+				filter);
+#endif
+	}
+
+	return 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: hk_partition_period_start                                        *
+ *                                                                            *
+ * Purpose: gets start of the native partition period containing the          *
+ *          specified timestamp                                               *
+ *                                                                            *
+ * Parameters: clock  - [IN] the timestamp                                    *
+ *             period - [IN] the partition period, HK_PARTITION_PERIOD_*      *
+ *                                                                            *
+ * Return value: the partition period start in UTC                            *
+ *                                                                            *
+ ******************************************************************************/
+static int	hk_partition_period_start(int clock, unsigned char period)
+{
+	time_t		time_utc = (time_t)clock;
+	struct tm	*tm;
+	int		start;
+
+	if (HK_PARTITION_PERIOD_DAY == period)
+		return clock - clock % SEC_PER_DAY;
+
+	tm = gmtime(&time_utc);
+
+	if (SUCCEED != zbx_utc_time(tm->tm_year + 1900, tm->tm_mon + 1, 1, 0, 0, 0, &start))
+		return clock - clock % SEC_PER_DAY;
+
+	return start;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: hk_partition_period_next                                         *
+ *                                                                            *
+ * Purpose: gets start of the native partition period following the period    *
+ *          containing the specified timestamp                                *
+ *                                                                            *
+ * Parameters: start  - [IN] the partition start, can be inside a period for  *
+ *                           partitions created manually                      *
+ *             period - [IN] the partition period, HK_PARTITION_PERIOD_*      *
+ *                                                                            *
+ * Return value: the next partition period start in UTC                       *
+ *                                                                            *
+ ******************************************************************************/
+static int	hk_partition_period_next(int start, unsigned char period)
+{
+	start = hk_partition_period_start(start, period);
+
+	return hk_partition_period_start(start + (HK_PARTITION_PERIOD_DAY == period ? SEC_PER_DAY : 32 * SEC_PER_DAY),
+			period);
+}
+
+static void	hk_partition_free(zbx_hk_partition_t *partition)
+{
+	zbx_free(partition->name);
+	zbx_free(partition);
+}
+
+static int	hk_partition_compare(const void *d1, const void *d2)
+{
+	const zbx_hk_partition_t	*p1 = *(const zbx_hk_partition_t **)d1;
+	const zbx_hk_partition_t	*p2 = *(const zbx_hk_partition_t **)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(p1->clock_to, p2->clock_to);
+
+	return 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: hk_partitions_get                                                *
+ *                                                                            *
+ * Purpose: reads native range partitions of the specified table              *
+ *                                                                            *
+ * Parameters: table      - [IN] the table name                               *
+ *             partitions - [OUT] the table partitions sorted by their upper  *
+ *                                bounds                                      *
+ *             maxvalue   - [OUT] the name of MySQL MAXVALUE partition, NULL  *
+ *                                if there is no such partition               *
+ *                                                                            *
+ * Return value: SUCCEED - the table is partitioned by range of clock         *
+ *               FAIL    - the table is not partitioned or database error     *
+ *                                                                            *
+ * Comments: Partitions with other bounds (PostgreSQL default partition) are  *
+ *           ignored.                                                         *
+ *                                                                            *
+ ******************************************************************************/
+static int	hk_partitions_get(const char *table, zbx_vector_ptr_t *partitions, char **maxvalue)
+{
+	DB_RESULT		result;
+	DB_ROW			row;
+	zbx_hk_partition_t	*partition;
+	int			clock_from, clock_to, ret = FAIL;
+
+#if defined(HAVE_POSTGRESQL)
+	ZBX_UNUSED(maxvalue);
+
+	if (NULL == (result = DBselect("select null from pg_class where relname='%s' and relkind='p'"
+			" and pg_table_is_visible(oid)", table)))
+	{
+		return FAIL;
+	}
+
+	if (NULL != DBfetch(result))
+		ret = SUCCEED;
+
+	DBfree_result(result);
+
+	if (SUCCEED != ret)
+		return FAIL;
+
+	if (NULL == (result = DBselect(
+			"select c.relname,pg_get_expr(c.relpartbound,c.oid)"
+			" from pg_class p,pg_inherits i,pg_class c"
+			" where p.relname='%s'"
+				" and pg_table_is_visible(p.oid)"
+				" and i.inhparent=p.oid"
+				" and c.oid=i.inhrelid", table)))
+	{
+		return FAIL;
+	}
+
+	while (NULL != (row = DBfetch(result)))
+	{
+		if (2 != sscanf(row[1], "FOR VALUES FROM (%d) TO (%d)", &clock_from, &clock_to))
+			continue;
+
+		partition = (zbx_hk_partition_t *)zbx_malloc(NULL, sizeof(zbx_hk_partition_t));
+		partition->name = zbx_strdup(NULL, row[0]);
+		partition->clock_from = clock_from;
+		partition->clock_to = clock_to;
+		zbx_vector_ptr_append(partitions, partition);
+	}
+	DBfree_result(result);
+#elif defined(HAVE_MYSQL)
+	if (NULL == (result = DBselect(
+			"select partition_name,partition_description"
+			" from information_schema.partitions"
+			" where table_schema=database()"
+				" and table_name='%s'"
+				" and partition_method='RANGE'"
+			" order by partition_ordinal_position", table)))
+	{
+		return FAIL;
+	}
+
+	clock_from = 0;
+
+	while (NULL != (row = DBfetch(result)))
+	{
+		ret = SUCCEED;
+
+		if (SUCCEED == DBis_null(row[0]))
+			continue;
+
+		/* new partitions must be split from MAXVALUE partition, it cannot be followed by other partitions */
+		if (0 == strcmp(row[1], "MAXVALUE"))
+		{
+			*maxvalue = zbx_strdup(*maxvalue, row[0]);
+			continue;
+		}
+
+		if (SUCCEED != is_uint31(row[1], &clock_to))
+			continue;
+
+		partition = (zbx_hk_partition_t *)zbx_malloc(NULL, sizeof(zbx_hk_partition_t));
+		partition->name = zbx_strdup(NULL, row[0]);
+		partition->clock_from = clock_from;
+		partition->clock_to = clock_to;
+		zbx_vector_ptr_append(partitions, partition);
+
+		clock_from = clock_to;
+	}
+	DBfree_result(result);
+#else
+	ZBX_UNUSED(table);
+	ZBX_UNUSED(partitions);
+	ZBX_UNUSED(maxvalue);
+	ZBX_UNUSED(result);
+	ZBX_UNUSED(row);
+	ZBX_UNUSED(partition);
+	ZBX_UNUSED(clock_from);
+	ZBX_UNUSED(clock_to);
+#endif
+	zbx_vector_ptr_sort(partitions, hk_partition_compare);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: hk_partition_create                                              *
+ *                                                                            *
+ * Purpose: creates native range partition for the specified period           *
+ *                                                                            *
+ * Parameters: table      - [IN] the table name                               *
+ *             clock_from - [IN] the partition lower bound (including)        *
+ *             clock_to   - [IN] the partition upper bound (excluding)        *
+ *             maxvalue   - [IN] the MySQL MAXVALUE partition name or NULL    *
+ *                                                                            *
+ * Return value: SUCCEED - the partition was created                          *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: Partitions are named after the first day of their period, for    *
+ *           example history_p20191001 (PostgreSQL) or p20191001 (MySQL).     *
+ *           On MySQL new partition is split from MAXVALUE partition if the   *
+ *           table has one, because partitions cannot be added after it.      *
+ *                                                                            *
+ ******************************************************************************/
+static int	hk_partition_create(const char *table, int clock_from, int clock_to, const char *maxvalue)
+{
+	time_t		time_utc = (time_t)clock_from;
+	struct tm	*tm;
+	int		ret = FAIL;
+
+	tm = gmtime(&time_utc);
+
+#if defined(HAVE_POSTGRESQL)
+	ret = DBexecute("create table %s_p%04d%02d%02d partition of %s for values from (%d) to (%d)",
+			table, tm->tm_year + 1900, tm->tm_mon + 1, tm->tm_mday, table, clock_from, clock_to);
+	ZBX_UNUSED(maxvalue);
+#elif defined(HAVE_MYSQL)
+	if (NULL != maxvalue)
+	{
+		ret = DBexecute("alter table %s reorganize partition %s into"
+				" (partition p%04d%02d%02d values less than (%d),partition %s values less than maxvalue)",
+				table, maxvalue, tm->tm_year + 1900, tm->tm_mon + 1, tm->tm_mday, clock_to, maxvalue);
+	}
+	else
+	{
+		ret = DBexecute("alter table %s add partition (partition p%04d%02d%02d values less than (%d))",
+				table, tm->tm_year + 1900, tm->tm_mon + 1, tm->tm_mday, clock_to);
+	}
+#else
+	ZBX_UNUSED(table);
+	ZBX_UNUSED(clock_to);
+	ZBX_UNUSED(maxvalue);
+	ZBX_UNUSED(tm);
+#endif
+	if (ZBX_DB_OK > ret)
+	{
+		zabbix_log(LOG_LEVEL_ERR, "cannot create partition of table \"%s\" for period [%d,%d[", table,
+				clock_from, clock_to);
+		return FAIL;
+	}
+
+	zabbix_log(LOG_LEVEL_DEBUG, "created partition of table \"%s\" for period [%d,%d[", table, clock_from,
+			clock_to);
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: hk_partition_drop                                                *
+ *                                                                            *
+ * Purpose: drops native partition with all its data                          *
+ *                                                                            *
+ * Parameters: table     - [IN] the table name                                *
+ *             partition - [IN] the partition to drop                         *
+ *                                                                            *
+ * Return value: SUCCEED - the partition was dropped                          *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	hk_partition_drop(const char *table, const zbx_hk_partition_t *partition)
+{
+	int	ret = FAIL;
+
+#if defined(HAVE_POSTGRESQL)
+	ret = DBexecute("drop table %s", partition->name);
+#elif defined(HAVE_MYSQL)
+	ret = DBexecute("alter table %s drop partition %s", table, partition->name);
+#else
+	ZBX_UNUSED(table);
+#endif
+	if (ZBX_DB_OK > ret)
+	{
+		zabbix_log(LOG_LEVEL_ERR, "cannot drop partition \"%s\" of table \"%s\"", partition->name, table);
+		return FAIL;
+	}
+
+	zabbix_log(LOG_LEVEL_DEBUG, "dropped partition \"%s\" of table \"%s\" with data before %d", partition->name,
+			table, partition->clock_to);
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: hk_partitions_plan                                               *
+ *                                                                            *
+ * Purpose: finds native partitions to be created and dropped                 *
+ *                                                                            *
+ * Parameters: partitions - [IN] the existing partitions sorted by their      *
+ *                               upper bounds                                 *
+ *             period     - [IN] the partition period, HK_PARTITION_PERIOD_*  *
+ *             contiguous - [IN] 1 - new partitions must start at the upper   *
+ *                               bound of the last partition (MySQL)          *
+ *             now        - [IN] the current timestamp                        *
+ *             keep_from  - [IN] the oldest timestamp to keep                 *
+ *             create     - [OUT] the bounds of partitions to create          *
+ *             drop_num   - [OUT] the number of the oldest partitions to drop *
+ *                                                                            *
+ * Comments: Partitions are planned up to HK_PARTITION_AHEAD seconds ahead,   *
+ *           so housekeeping must run at least once during this period. Only  *
+ *           partitions with all data expired are dropped and the last        *
+ *           partition is always kept, MySQL does not allow dropping all      *
+ *           partitions.                                                      *
+ *                                                                            *
+ ******************************************************************************/
+static void	hk_partitions_plan(const zbx_vector_ptr_t *partitions, unsigned char period, int contiguous, int now,
+		int keep_from, zbx_vector_uint64_pair_t *create, int *drop_num)
+{
+	const zbx_hk_partition_t	*partition;
+	zbx_uint64_pair_t		bounds;
+	int				clock_from;
+
+	clock_from = hk_partition_period_start(now, period);
+
+	if (0 != partitions->values_num)
+	{
+		partition = (const zbx_hk_partition_t *)partitions->values[partitions->values_num - 1];
+
+		if (1 == contiguous)
+			clock_from = partition->clock_to;
+		else
+			clock_from = MAX(clock_from, partition->clock_to);
+	}
+
+	while (clock_from <= now + HK_PARTITION_AHEAD)
+	{
+		bounds.first = (zbx_uint64_t)clock_from;
+		clock_from = hk_partition_period_next(clock_from, period);
+		bounds.second = (zbx_uint64_t)clock_from;
+		zbx_vector_uint64_pair_append(create, bounds);
+	}
+
+	for (*drop_num = 0; *drop_num < partitions->values_num - 1; (*drop_num)++)
+	{
+		partition = (const zbx_hk_partition_t *)partitions->values[*drop_num];
+
+		if (partition->clock_to > keep_from)
+			break;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: hk_partitions_update                                             *
+ *                                                                            *
+ * Purpose: creates native partitions ahead of time and drops partitions      *
+ *          with expired data                                                 *
+ *                                                                            *
+ * Parameters: rule      - [IN] the history housekeeping rule                 *
+ *             now       - [IN] the current timestamp                         *
+ *             keep_from - [IN] the oldest timestamp to keep                  *
+ *                                                                            *
+ * Return value: SUCCEED - the table partitions were updated                  *
+ *               FAIL    - the table is not partitioned                       *
+ *                                                                            *
+ * Comments: History tables are partitioned by days and trends tables by      *
+ *           months. The cost does not depend on the number of rows.          *
+ *                                                                            *
+ ******************************************************************************/
+static int	hk_partitions_update(zbx_hk_history_rule_t *rule, int now, int keep_from)
+{
+	zbx_vector_ptr_t		partitions;
+	zbx_vector_uint64_pair_t	create;
+	unsigned char			period;
+	char				*maxvalue = NULL;
+	int				i, drop_num, created = 0, dropped = 0, contiguous = 0, ret;
+
+	zbx_vector_ptr_create(&partitions);
+	zbx_vector_uint64_pair_create(&create);
+
+	if (SUCCEED != (ret = hk_partitions_get(rule->table, &partitions, &maxvalue)))
+		goto out;
+
+	period = (0 == strcmp(rule->history, "trends") ? HK_PARTITION_PERIOD_MONTH : HK_PARTITION_PERIOD_DAY);
+
+#if defined(HAVE_MYSQL)
+	/* MySQL range partitions must be added in strictly increasing order */
+	contiguous = 1;
+#endif
+	hk_partitions_plan(&partitions, period, contiguous, now, keep_from, &create, &drop_num);
+
+	for (i = 0; i < create.values_num; i++)
+	{
+		if (SUCCEED != hk_partition_create(rule->table, (int)create.values[i].first, (int)create.values[i].second,
+				maxvalue))
+		{
+			break;
+		}
+
+		created++;
+	}
+
+	for (i = 0; i < drop_num; i++)
+	{
+		if (SUCCEED == hk_partition_drop(rule->table, (const zbx_hk_partition_t *)partitions.values[i]))
+			dropped++;
+	}
+
+	zabbix_log(LOG_LEVEL_DEBUG, "%s: table=%s partitions:%d created:%d dropped:%d", __func__, rule->table,
+			partitions.values_num, created, dropped);
+out:
+	zbx_free(maxvalue);
+	zbx_vector_uint64_pair_destroy(&create);
+	zbx_vector_ptr_clear_ext(&partitions, (zbx_clean_func_t)hk_partition_free);
+	zbx_vector_ptr_destroy(&partitions);
+
+	return ret;
+}
+
 /******************************************************************************
  *                                                                            *
  * Function: hk_drop_partition_for_rule                                       *
@@ -556,12 +1047,19 @@ static void	hk_history_delete_queue_clear(zbx_hk_history_rule_t *rule)
  * Parameters: rules - [IN/OUT] history housekeeping rules                    *
  *             now   - [IN] the current timestamp                             *
  *                                                                            *
- * Return value: the number of tables processed                               *
+ * Return value: the number of deleted records of tables that are not         *
+ *               partitioned                                                  *
+ *                                                                            *
+ * Comments: With native partitioning the partitions are also created ahead   *
+ *           of time. If the table is not partitioned the expired records are *
+ *           deleted using the global period, up to MaxHousekeeperDelete      *
+ *           records per housekeeping cycle.                                  *
  *                                                                            *
  ******************************************************************************/
-static void	hk_drop_partition_for_rule(zbx_hk_history_rule_t *rule, int now)
+static int	hk_drop_partition_for_rule(zbx_hk_history_rule_t *rule, int now)
 {
-	int		keep_from, history_seconds;
+	int		keep_from, history_seconds, deleted = 0;
+	char		filter[MAX_STRING_LEN];
 	DB_RESULT	result;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() now:%d", __func__, now);
@@ -571,22 +1069,42 @@ static void	hk_drop_partition_for_rule(zbx_hk_history_rule_t *rule, int now)
 	if (ZBX_HK_HISTORY_MIN > history_seconds || ZBX_HK_PERIOD_MAX < history_seconds)
 	{
 		zabbix_log(LOG_LEVEL_WARNING, "invalid history storage period for table '%s'", rule->table);
-		return;
+		return 0;
 	}
 
 	keep_from = now - history_seconds;
 	zabbix_log(LOG_LEVEL_TRACE, "%s: table=%s keep_from=%d", __func__, rule->table, keep_from);
 
+	if (0 == zbx_strcmp_null(cfg.db_extension, ZBX_CONFIG_DB_EXTENSION_PARTITIONS))
+	{
+		if (SUCCEED != hk_partitions_update(rule, now, keep_from))
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "table '%s' is not partitioned by clock, deleting old records",
+					rule->table);
+
+			zbx_snprintf(filter, sizeof(filter), "clock<%d", keep_from);
+
+			if (ZBX_DB_OK > (deleted = DBdelete_from_table(rule->table, filter,
+					CONFIG_MAX_HOUSEKEEPER_DELETE)))
+			{
+				zabbix_log(LOG_LEVEL_ERR, "cannot delete old records from %s", rule->table);
+				deleted = 0;
+			}
+		}
+
+		goto out;
+	}
+
 	result = DBselect("SELECT drop_chunks(%d,'%s')", keep_from, rule->table);
 
 	if (NULL == result)
 		zabbix_log(LOG_LEVEL_ERR, "cannot drop chunks for %s", rule->table);
 	else
 		DBfree_result(result);
+out:
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%d", __func__, deleted);
 
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
-
-	return;
+	return deleted;
 }
 
 /******************************************************************************
@@ -619,11 +1137,11 @@ static int	housekeeping_history_and_trends(int now)
 
 		/* If partitioning enabled for history and/or trends then drop partitions with expired history.  */
 		/* ZBX_HK_MODE_PARTITION is set during configuration sync based on the following: */
-		/* 1. "Override item history (or trend) period" must be on 2. DB must be PostgreSQL */
-		/* 3. config.db_extension must be set to "timescaledb" */
+		/* 1. "Override item history (or trend) period" must be on 2. config.db_extension must be set */
+		/* to "timescaledb" (PostgreSQL) or "partitions" (PostgreSQL or MySQL native partitioning) */
 		if (ZBX_HK_MODE_PARTITION == *rule->poption_mode)
 		{
-			hk_drop_partition_for_rule(rule, now);
+			deleted += hk_drop_partition_for_rule(rule, now);
 			continue;
 		}
 
@@ -752,64 +1270,6 @@ static int	housekeeping_process_rule(int now, zbx_hk_rule_t *rule)
 	return deleted;
 }
 
-/******************************************************************************
- *                                                                            *
- * Function: DBdelete_from_table                                              *
- *                                                                            *
- * Purpose: delete limited count of rows from table                           *
- *                                                                            *
- * Return value: number of deleted rows or less than 0 if an error occurred   *
- *                                                                            *
- ******************************************************************************/
-static int	DBdelete_from_table(const char *tablename, const char *filter, int limit)
-{
-	if (0 == limit)
-	{
-		return DBexecute(
-				"delete from %s"
-				" where %s",
-				tablename,
-				filter);
-	}
-	else
-	{
-#if defined(HAVE_ORACLE)
-		return DBexecute(
-				"delete from %s"
-				" where %s"
-					" and rownum<=%d",
-				tablename,
-				filter,
-				limit);
-#elif defined(HAVE_MYSQL)
-		return DBexecute(
-				"delete from %s"
-				" where %s limit %d",
-				tablename,
-				filter,
-				limit);
-#elif defined(HAVE_POSTGRESQL)
-		return DBexecute(
-				"delete from %s"
-				" where %s and ctid = any(array(select ctid from %s"
-					" where %s limit %d))",
-				tablename,
-				filter,
-				tablename,
-				filter,
-				limit);
-#elif defined(HAVE_SQLITE3)
-		return DBexecute(
-				"delete from %s"
-				" where %s",
-				tablename,
-				filter);
-#endif
-	}
-
-	return 0;
-}
-
 /******************************************************************************
  *                                                                            *
  * Function: hk_problem_cleanup                                               *
@@ -1200,6 +1660,9 @@ ZBX_THREAD_ENTRY(housekeeper_thread, args)
 		zbx_dc_cleanup_data_sessions();
 		zbx_vc_housekeeping_value_cache();
 
+		zbx_setproctitle("%s [compacting local history]", get_process_type_string(process_type));
+		zbx_history_housekeep();
+
 		zbx_setproctitle("%s [deleted %d hist/trends, %d items/triggers, %d events, %d sessions, %d alarms,"
 				" %d audit items, %d records in " ZBX_FS_DBL " sec, %s]",
 				get_process_type_string(process_type), d_history_and_trends, d_cleanup, d_events,
@@ -1214,3 +1677,7 @@ ZBX_THREAD_ENTRY(housekeeper_thread, args)
 	while (1)
 		zbx_sleep(SEC_PER_MIN);
 }
+
+#ifdef HAVE_TESTS
+#	include "../../../tests/zabbix_server/housekeeper/housekeeper_test.c"
+#endif
@@ -31,198 +31,86 @@
 #define ZBX_VALUE_FUNC_COUNT	4
 #define ZBX_VALUE_FUNC_LAST	5
 
-/******************************************************************************
- *                                                                            *
- * Function: evaluate_history_func_min                                        *
- *                                                                            *
- * Purpose: calculate minimum value from the history value vector             *
- *                                                                            *
- * Parameters: values      - [IN] a vector containing history values          *
- *             value_type  - [IN] the type of values. Only float/uint64       *
- *                           values are supported.                            *
- *             result      - [OUT] the resulting value                        *
- *                                                                            *
- ******************************************************************************/
-static void	evaluate_history_func_min(zbx_vector_history_record_t *values, int value_type, history_value_t *result)
-{
-	int	i;
+/* the maximum number of cached aggregate member lists per process */
+#define ZBX_AGGREGATE_MEMBERS_MAX	1000
 
-	*result = values->values[0].value;
-
-	if (ITEM_VALUE_TYPE_UINT64 == value_type)
-	{
-		for (i = 1; i < values->values_num; i++)
-			if (values->values[i].value.ui64 < result->ui64)
-				result->ui64 = values->values[i].value.ui64;
-	}
-	else
-	{
-		for (i = 1; i < values->values_num; i++)
-			if (values->values[i].value.dbl < result->dbl)
-				result->dbl = values->values[i].value.dbl;
-	}
-}
-
-/******************************************************************************
- *                                                                            *
- * Function: evaluate_history_func_max                                        *
- *                                                                            *
- * Purpose: calculate maximum value from the history value vector             *
- *                                                                            *
- * Parameters: values      - [IN] a vector containing history values          *
- *             value_type  - [IN] the type of values. Only float/uint64       *
- *                           values are supported.                            *
- *             result      - [OUT] the resulting value                        *
- *                                                                            *
- ******************************************************************************/
-static void	evaluate_history_func_max(zbx_vector_history_record_t *values, int value_type, history_value_t *result)
+/* aggregate item members resolved by host groups and item key */
+typedef struct
 {
-	int	i;
-
-	*result = values->values[0].value;
-
-	if (ITEM_VALUE_TYPE_UINT64 == value_type)
-	{
-		for (i = 1; i < values->values_num; i++)
-			if (values->values[i].value.ui64 > result->ui64)
-				result->ui64 = values->values[i].value.ui64;
-	}
-	else
-	{
-		for (i = 1; i < values->values_num; i++)
-			if (values->values[i].value.dbl > result->dbl)
-				result->dbl = values->values[i].value.dbl;
-	}
+	char			*groups;
+	char			*itemkey;
+	zbx_vector_uint64_t	itemids;
 }
+zbx_aggregate_members_t;
+
+static zbx_hashset_t	aggregate_members;
+static int		aggregate_members_sync_ts;
 
 /******************************************************************************
  *                                                                            *
- * Function: evaluate_history_func_sum                                        *
+ * Function: evaluate_dbl_func                                                *
+ *                                                                            *
+ * Purpose: calculate function with floating point values                     *
  *                                                                            *
- * Purpose: calculate sum of values from the history value vector             *
+ * Parameters: values     - [IN] the values in descending order of their      *
+ *                          timestamps                                        *
+ *             values_num - [IN] the number of values, must be positive       *
+ *             func       - [IN] the function to calculate, one of            *
+ *                          ZBX_VALUE_FUNC_* defines                          *
  *                                                                            *
- * Parameters: values      - [IN] a vector containing history values          *
- *             value_type  - [IN] the type of values. Only float/uint64       *
- *                           values are supported.                            *
- *             result      - [OUT] the resulting value                        *
+ * Return value: the calculated value                                         *
  *                                                                            *
  ******************************************************************************/
-static void	evaluate_history_func_sum(zbx_vector_history_record_t *values, int value_type, history_value_t *result)
+static double	evaluate_dbl_func(const double *values, int values_num, int func)
 {
-	int	i;
-
-	if (ITEM_VALUE_TYPE_UINT64 == value_type)
-	{
-		result->ui64 = 0;
-		for (i = 0; i < values->values_num; i++)
-			result->ui64 += values->values[i].value.ui64;
-	}
-	else
+	switch (func)
 	{
-		result->dbl = 0;
-		for (i = 0; i < values->values_num; i++)
-			result->dbl += values->values[i].value.dbl;
+		case ZBX_VALUE_FUNC_MIN:
+			return zbx_dbl_array_min(values, values_num);
+		case ZBX_VALUE_FUNC_AVG:
+			return zbx_dbl_array_sum(values, values_num) / values_num;
+		case ZBX_VALUE_FUNC_MAX:
+			return zbx_dbl_array_max(values, values_num);
+		case ZBX_VALUE_FUNC_SUM:
+			return zbx_dbl_array_sum(values, values_num);
+		case ZBX_VALUE_FUNC_COUNT:
+			return values_num;
+		default:
+			return values[0];
 	}
 }
 
 /******************************************************************************
  *                                                                            *
- * Function: evaluate_history_func_avg                                        *
- *                                                                            *
- * Purpose: calculate average value of values from the history value vector   *
- *                                                                            *
- * Parameters: values      - [IN] a vector containing history values          *
- *             value_type  - [IN] the type of values. Only float/uint64       *
- *                           values are supported.                            *
- *             result      - [OUT] the resulting value                        *
- *                                                                            *
- ******************************************************************************/
-static void	evaluate_history_func_avg(zbx_vector_history_record_t *values, int value_type, history_value_t *result)
-{
-	evaluate_history_func_sum(values, value_type, result);
-
-	if (ITEM_VALUE_TYPE_UINT64 == value_type)
-		result->ui64 /= values->values_num;
-	else
-		result->dbl /= values->values_num;
-}
-
-/******************************************************************************
- *                                                                            *
- * Function: evaluate_history_func_count                                      *
+ * Function: evaluate_ui64_func                                               *
  *                                                                            *
- * Purpose: calculate number of values in value vector                        *
+ * Purpose: calculate function with unsigned integer values                   *
  *                                                                            *
- * Parameters: values      - [IN] a vector containing history values          *
- *             value_type  - [IN] the type of values. Only float/uint64       *
- *                           values are supported.                            *
- *             result      - [OUT] the resulting value                        *
+ * Parameters: values     - [IN] the values in descending order of their      *
+ *                          timestamps                                        *
+ *             values_num - [IN] the number of values, must be positive       *
+ *             func       - [IN] the function to calculate, one of            *
+ *                          ZBX_VALUE_FUNC_* defines                          *
  *                                                                            *
- ******************************************************************************/
-static void	evaluate_history_func_count(zbx_vector_history_record_t *values, int value_type,
-		history_value_t *result)
-{
-	if (ITEM_VALUE_TYPE_UINT64 == value_type)
-		result->ui64 = values->values_num;
-	else
-		result->dbl = values->values_num;
-}
-
-/******************************************************************************
- *                                                                            *
- * Function: evaluate_history_func_last                                       *
- *                                                                            *
- * Purpose: calculate the last (newest) value in value vector                 *
- *                                                                            *
- * Parameters: values      - [IN] a vector containing history values          *
- *             result      - [OUT] the resulting value                        *
+ * Return value: the calculated value                                         *
  *                                                                            *
  ******************************************************************************/
-static void	evaluate_history_func_last(zbx_vector_history_record_t *values, history_value_t *result)
-{
-	*result = values->values[0].value;
-}
-
-/******************************************************************************
- *                                                                            *
- * Function: evaluate_history_func                                            *
- *                                                                            *
- * Purpose: calculate function with values from value vector                  *
- *                                                                            *
- * Parameters: values      - [IN] a vector containing history values          *
- *             value_type  - [IN] the type of values. Only float/uint64       *
- *                           values are supported.                            *
- *             func        - [IN] the function to calculate. Only             *
- *                           ZBX_VALUE_FUNC_MIN, ZBX_VALUE_FUNC_AVG,          *
- *                           ZBX_VALUE_FUNC_MAX, ZBX_VALUE_FUNC_SUM,          *
- *                           ZBX_VALUE_FUNC_COUNT, ZBX_VALUE_FUNC_LAST        *
- *                           functions are supported.                         *
- *             result      - [OUT] the resulting value                        *
- *                                                                            *
- ******************************************************************************/
-static void	evaluate_history_func(zbx_vector_history_record_t *values, int value_type, int func,
-		history_value_t *result)
+static zbx_uint64_t	evaluate_ui64_func(const zbx_uint64_t *values, int values_num, int func)
 {
 	switch (func)
 	{
 		case ZBX_VALUE_FUNC_MIN:
-			evaluate_history_func_min(values, value_type, result);
-			break;
+			return zbx_ui64_array_min(values, values_num);
 		case ZBX_VALUE_FUNC_AVG:
-			evaluate_history_func_avg(values, value_type, result);
-			break;
+			return zbx_ui64_array_sum(values, values_num) / values_num;
 		case ZBX_VALUE_FUNC_MAX:
-			evaluate_history_func_max(values, value_type, result);
-			break;
+			return zbx_ui64_array_max(values, values_num);
 		case ZBX_VALUE_FUNC_SUM:
-			evaluate_history_func_sum(values, value_type, result);
-			break;
+			return zbx_ui64_array_sum(values, values_num);
 		case ZBX_VALUE_FUNC_COUNT:
-			evaluate_history_func_count(values, value_type, result);
-			break;
-		case ZBX_VALUE_FUNC_LAST:
-			evaluate_history_func_last(values, result);
-			break;
+			return values_num;
+		default:
+			return values[0];
 	}
 }
 
@@ -349,16 +237,14 @@ static int	aggregate_get_items(zbx_vector_uint64_t *itemids, const char *groups,
 
 	zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
 			"select distinct i.itemid"
-			" from items i,hosts h,hosts_groups hg,item_rtdata ir"
+			" from items i,hosts h,hosts_groups hg"
 			" where i.hostid=h.hostid"
 				" and h.hostid=hg.hostid"
 				" and i.key_='%s'"
 				" and i.status=%d"
-				" and ir.itemid=i.itemid"
-				" and ir.state=%d"
 				" and h.status=%d"
 				" and",
-			esc, ITEM_STATUS_ACTIVE, ITEM_STATE_NORMAL, HOST_STATUS_MONITORED);
+			esc, ITEM_STATUS_ACTIVE, HOST_STATUS_MONITORED);
 
 	zbx_free(esc);
 
@@ -393,6 +279,97 @@ out:
 	return ret;
 }
 
+static zbx_hash_t	aggregate_members_hash(const void *data)
+{
+	const zbx_aggregate_members_t	*members = (const zbx_aggregate_members_t *)data;
+	zbx_hash_t			hash;
+
+	hash = ZBX_DEFAULT_STRING_HASH_FUNC(members->groups);
+
+	return ZBX_DEFAULT_STRING_HASH_ALGO(members->itemkey, strlen(members->itemkey), hash);
+}
+
+static int	aggregate_members_compare(const void *d1, const void *d2)
+{
+	const zbx_aggregate_members_t	*members1 = (const zbx_aggregate_members_t *)d1;
+	const zbx_aggregate_members_t	*members2 = (const zbx_aggregate_members_t *)d2;
+	int				ret;
+
+	if (0 != (ret = strcmp(members1->groups, members2->groups)))
+		return ret;
+
+	return strcmp(members1->itemkey, members2->itemkey);
+}
+
+static void	aggregate_members_clean(void *data)
+{
+	zbx_aggregate_members_t	*members = (zbx_aggregate_members_t *)data;
+
+	zbx_free(members->groups);
+	zbx_free(members->itemkey);
+	zbx_vector_uint64_destroy(&members->itemids);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: aggregate_get_members                                            *
+ *                                                                            *
+ * Purpose: get items specified by key for selected groups, resolving them    *
+ *          from database once per configuration cache synchronization        *
+ *                                                                            *
+ * Parameters: groups  - [IN] list of comma-separated host groups             *
+ *             itemkey - [IN] item key to aggregate                           *
+ *             error   - [OUT] the error message                              *
+ *                                                                            *
+ * Return value: the sorted member item identifiers or NULL if no items match *
+ *               the specified groups or keys                                 *
+ *                                                                            *
+ * Comments: The item and host status is checked again when aggregate is      *
+ *           evaluated, so only group membership and item key changes are     *
+ *           picked up with the next configuration cache synchronization.     *
+ *                                                                            *
+ ******************************************************************************/
+static const zbx_vector_uint64_t	*aggregate_get_members(const char *groups, const char *itemkey, char **error)
+{
+	zbx_aggregate_members_t	*members, members_local;
+	int			sync_ts;
+
+	sync_ts = DCconfig_get_last_sync_time();
+
+	if (0 == aggregate_members.num_slots)
+	{
+		zbx_hashset_create_ext(&aggregate_members, 0, aggregate_members_hash, aggregate_members_compare,
+				aggregate_members_clean, ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC,
+				ZBX_DEFAULT_MEM_FREE_FUNC);
+	}
+	else if (sync_ts != aggregate_members_sync_ts || ZBX_AGGREGATE_MEMBERS_MAX <= aggregate_members.num_data)
+		zbx_hashset_clear(&aggregate_members);
+
+	aggregate_members_sync_ts = sync_ts;
+
+	members_local.groups = (char *)groups;
+	members_local.itemkey = (char *)itemkey;
+
+	if (NULL != (members = (zbx_aggregate_members_t *)zbx_hashset_search(&aggregate_members, &members_local)))
+		return &members->itemids;
+
+	zbx_vector_uint64_create(&members_local.itemids);
+
+	if (FAIL == aggregate_get_items(&members_local.itemids, groups, itemkey, error))
+	{
+		zbx_vector_uint64_destroy(&members_local.itemids);
+		return NULL;
+	}
+
+	members_local.groups = zbx_strdup(NULL, groups);
+	members_local.itemkey = zbx_strdup(NULL, itemkey);
+
+	members = (zbx_aggregate_members_t *)zbx_hashset_insert(&aggregate_members, &members_local,
+			sizeof(members_local));
+
+	return &members->itemids;
+}
+
 /******************************************************************************
  *                                                                            *
  * Function: evaluate_aggregate                                               *
@@ -407,16 +384,17 @@ out:
  * Return value: SUCCEED - aggregate item evaluated successfully              *
  *               FAIL - otherwise                                             *
  *                                                                            *
+ * Comments: Values of all member items of the same value type are read from  *
+ *           value cache in one pass and aggregated as packed value arrays.   *
+ *                                                                            *
  ******************************************************************************/
 static int	evaluate_aggregate(DC_ITEM *item, AGENT_RESULT *res, int grp_func, const char *groups,
 		const char *itemkey, int item_func, const char *param)
 {
-	zbx_vector_uint64_t		itemids;
-	history_value_t			value, item_result;
-	zbx_history_record_t		group_value;
-	int				ret = FAIL, *errcodes = NULL, i, count, seconds;
-	DC_ITEM				*items = NULL;
-	zbx_vector_history_record_t	values, group_values;
+	const zbx_vector_uint64_t	*itemids;
+	zbx_vector_uint64_t		itemids_float, itemids_uint64, values_ui64, group_ui64;
+	zbx_vector_dbl_t		values_dbl, group_dbl;
+	int				ret = FAIL, *offsets = NULL, i, count, seconds, num;
 	char				*error = NULL;
 	zbx_timespec_t			ts;
 
@@ -425,21 +403,12 @@ static int	evaluate_aggregate(DC_ITEM *item, AGENT_RESULT *res, int grp_func, co
 
 	zbx_timespec(&ts);
 
-	zbx_vector_uint64_create(&itemids);
-	if (FAIL == aggregate_get_items(&itemids, groups, itemkey, &error))
+	if (NULL == (itemids = aggregate_get_members(groups, itemkey, &error)))
 	{
 		SET_MSG_RESULT(res, error);
-		goto clean1;
+		goto out;
 	}
 
-	memset(&value, 0, sizeof(value));
-	zbx_history_record_vector_create(&group_values);
-
-	items = (DC_ITEM *)zbx_malloc(items, sizeof(DC_ITEM) * itemids.values_num);
-	errcodes = (int *)zbx_malloc(errcodes, sizeof(int) * itemids.values_num);
-
-	DCconfig_get_items_by_itemids(items, itemids.values, errcodes, itemids.values_num);
-
 	if (ZBX_VALUE_FUNC_LAST == item_func)
 	{
 		count = 1;
@@ -450,49 +419,65 @@ static int	evaluate_aggregate(DC_ITEM *item, AGENT_RESULT *res, int grp_func, co
 		if (FAIL == is_time_suffix(param, &seconds, ZBX_LENGTH_UNLIMITED))
 		{
 			SET_MSG_RESULT(res, zbx_strdup(NULL, "Invalid fourth parameter."));
-			goto clean2;
+			goto out;
 		}
 		count = 0;
 	}
 
-	for (i = 0; i < itemids.values_num; i++)
+	zbx_vector_uint64_create(&itemids_float);
+	zbx_vector_uint64_create(&itemids_uint64);
+	zbx_vector_uint64_create(&values_ui64);
+	zbx_vector_uint64_create(&group_ui64);
+	zbx_vector_dbl_create(&values_dbl);
+	zbx_vector_dbl_create(&group_dbl);
+
+	zbx_dc_get_active_numeric_itemids(itemids->values, itemids->values_num, &itemids_float, &itemids_uint64);
+
+	offsets = (int *)zbx_malloc(offsets, sizeof(int) * (itemids->values_num + 1));
+
+	if (0 != itemids_float.values_num)
 	{
-		if (SUCCEED != errcodes[i])
-			continue;
+		zbx_vc_get_values_dbl_bulk(itemids_float.values, itemids_float.values_num, &values_dbl, offsets,
+				seconds, count, &ts);
 
-		if (ITEM_STATUS_ACTIVE != items[i].status)
-			continue;
+		for (i = 0; i < itemids_float.values_num; i++)
+		{
+			double	value;
 
-		if (HOST_STATUS_MONITORED != items[i].host.status)
-			continue;
+			if (0 == (num = offsets[i + 1] - offsets[i]))
+				continue;
 
-		if (ITEM_VALUE_TYPE_FLOAT != items[i].value_type && ITEM_VALUE_TYPE_UINT64 != items[i].value_type)
-			continue;
+			value = evaluate_dbl_func(values_dbl.values + offsets[i], num, item_func);
+
+			if (ITEM_VALUE_TYPE_FLOAT == item->value_type)
+				zbx_vector_dbl_append(&group_dbl, value);
+			else
+				zbx_vector_uint64_append(&group_ui64, (zbx_uint64_t)value);
+		}
+	}
 
-		zbx_history_record_vector_create(&values);
+	if (0 != itemids_uint64.values_num)
+	{
+		zbx_vc_get_values_uint64_bulk(itemids_uint64.values, itemids_uint64.values_num, &values_ui64, offsets,
+				seconds, count, &ts);
 
-		if (SUCCEED == zbx_vc_get_values(items[i].itemid, items[i].value_type, &values, seconds, count, &ts) &&
-				0 < values.values_num)
+		for (i = 0; i < itemids_uint64.values_num; i++)
 		{
-			evaluate_history_func(&values, items[i].value_type, item_func, &item_result);
+			zbx_uint64_t	value;
+
+			if (0 == (num = offsets[i + 1] - offsets[i]))
+				continue;
 
-			if (item->value_type == items[i].value_type)
-				group_value.value = item_result;
+			value = evaluate_ui64_func(values_ui64.values + offsets[i], num, item_func);
+
+			if (ITEM_VALUE_TYPE_FLOAT == item->value_type)
+				zbx_vector_dbl_append(&group_dbl, (double)value);
 			else
-			{
-				if (ITEM_VALUE_TYPE_UINT64 == item->value_type)
-					group_value.value.ui64 = (zbx_uint64_t)item_result.dbl;
-				else
-					group_value.value.dbl = (double)item_result.ui64;
-			}
-
-			zbx_vector_history_record_append_ptr(&group_values, &group_value);
+				zbx_vector_uint64_append(&group_ui64, value);
 		}
-
-		zbx_history_record_vector_destroy(&values, items[i].value_type);
 	}
 
-	if (0 == group_values.values_num)
+	if (0 == group_dbl.values_num && 0 == group_ui64.values_num)
 	{
 		char	*tmp = NULL;
 		size_t	tmp_alloc = 0, tmp_offset = 0;
@@ -501,26 +486,25 @@ static int	evaluate_aggregate(DC_ITEM *item, AGENT_RESULT *res, int grp_func, co
 		SET_MSG_RESULT(res, zbx_dsprintf(NULL, "No values for key \"%s\" in group(s) %s.", itemkey, tmp));
 		zbx_free(tmp);
 
-		goto clean2;
+		goto clean;
 	}
 
-	evaluate_history_func(&group_values, item->value_type, grp_func, &value);
-
 	if (ITEM_VALUE_TYPE_FLOAT == item->value_type)
-		SET_DBL_RESULT(res, value.dbl);
+		SET_DBL_RESULT(res, evaluate_dbl_func(group_dbl.values, group_dbl.values_num, grp_func));
 	else
-		SET_UI64_RESULT(res, value.ui64);
+		SET_UI64_RESULT(res, evaluate_ui64_func(group_ui64.values, group_ui64.values_num, grp_func));
 
 	ret = SUCCEED;
-clean2:
-	DCconfig_clean_items(items, errcodes, itemids.values_num);
-
-	zbx_free(errcodes);
-	zbx_free(items);
-	zbx_history_record_vector_destroy(&group_values, item->value_type);
-clean1:
-	zbx_vector_uint64_destroy(&itemids);
-
+clean:
+	zbx_free(offsets);
+
+	zbx_vector_dbl_destroy(&group_dbl);
+	zbx_vector_dbl_destroy(&values_dbl);
+	zbx_vector_uint64_destroy(&group_ui64);
+	zbx_vector_uint64_destroy(&values_ui64);
+	zbx_vector_uint64_destroy(&itemids_uint64);
+	zbx_vector_uint64_destroy(&itemids_float);
+out:
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
 
 	return ret;
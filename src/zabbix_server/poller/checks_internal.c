@@ -23,6 +23,7 @@
 #include "dbcache.h"
 #include "zbxself.h"
 #include "proxy.h"
+#include "preproc.h"
 
 #include "../vmware/vmware.h"
 #include "../../libs/zbxserver/zabbix_stats.h"
@@ -152,6 +153,166 @@ static int	zbx_host_interfaces_discovery(zbx_uint64_t hostid, struct zbx_json *j
 	return SUCCEED;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: get_preproc_time_value                                           *
+ *                                                                            *
+ * Purpose: get value of preprocessing time statistics                        *
+ *                                                                            *
+ * Parameters: stats  - [IN] the time statistics                              *
+ *             mode   - [IN] the statistics mode - time (default), count or   *
+ *                           max                                              *
+ *             result - [OUT] the statistics value                            *
+ *                                                                            *
+ * Return value: SUCCEED - the value was retrieved successfully               *
+ *               FAIL    - invalid mode                                       *
+ *                                                                            *
+ ******************************************************************************/
+static int	get_preproc_time_value(const zbx_preproc_time_stats_t *stats, const char *mode, AGENT_RESULT *result)
+{
+	if (NULL == mode || '\0' == *mode || 0 == strcmp(mode, "time"))
+		SET_DBL_RESULT(result, stats->time);
+	else if (0 == strcmp(mode, "count"))
+		SET_UI64_RESULT(result, stats->count);
+	else if (0 == strcmp(mode, "max"))
+		SET_DBL_RESULT(result, stats->time_max);
+	else
+		return FAIL;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: get_preprocessing_value                                          *
+ *                                                                            *
+ * Purpose: get preprocessing statistics value                                *
+ *                                                                            *
+ * Parameters: request - [IN] the zabbix[preprocessing,...] item request      *
+ *             result  - [OUT] the statistics value                           *
+ *                                                                            *
+ * Return value: SUCCEED - the value was retrieved successfully               *
+ *               FAIL    - otherwise, result contains the error message       *
+ *                                                                            *
+ * Comments: The counters are accumulated since preprocessing manager start,  *
+ *           use 'Change per second' preprocessing to get rates.              *
+ *                                                                            *
+ ******************************************************************************/
+static int	get_preprocessing_value(AGENT_REQUEST *request, AGENT_RESULT *result)
+{
+	zbx_preproc_stats_t	stats;
+	const char		*tmp, *tmp1;
+	char			*error = NULL;
+	int			i, nparams, num;
+	zbx_uint64_t		values_num = 0;
+	unsigned char		type;
+
+	nparams = get_rparams_num(request);
+	tmp = get_rparam(request, 1);
+
+	zbx_preprocessor_get_stats(&stats, 0);
+
+	if (0 == strcmp(tmp, "values"))			/* zabbix[preprocessing,values] */
+	{
+		if (2 != nparams)
+		{
+			error = zbx_strdup(NULL, "Invalid number of parameters.");
+			goto out;
+		}
+
+		for (i = 0; i < stats.workers.values_num; i++)
+			values_num += ((zbx_preproc_worker_stats_t *)stats.workers.values[i])->values_num;
+
+		SET_UI64_RESULT(result, values_num);
+	}
+	else if (0 == strcmp(tmp, "worker"))		/* zabbix[preprocessing,worker,<num>] */
+	{
+		if (3 != nparams)
+		{
+			error = zbx_strdup(NULL, "Invalid number of parameters.");
+			goto out;
+		}
+
+		if (SUCCEED != is_uint31(get_rparam(request, 2), &num))
+		{
+			error = zbx_strdup(NULL, "Invalid third parameter.");
+			goto out;
+		}
+
+		for (i = 0; i < stats.workers.values_num; i++)
+		{
+			const zbx_preproc_worker_stats_t	*worker;
+
+			worker = (const zbx_preproc_worker_stats_t *)stats.workers.values[i];
+
+			if (worker->process_num == num)
+				break;
+		}
+
+		if (i == stats.workers.values_num)
+		{
+			error = zbx_strdup(NULL, "Preprocessing worker statistics are not available.");
+			goto out;
+		}
+
+		SET_UI64_RESULT(result, ((zbx_preproc_worker_stats_t *)stats.workers.values[i])->values_num);
+	}
+	else if (0 == strcmp(tmp, "queue_time"))	/* zabbix[preprocessing,queue_time,<mode>] */
+	{
+		if (3 < nparams)
+		{
+			error = zbx_strdup(NULL, "Invalid number of parameters.");
+			goto out;
+		}
+
+		if (SUCCEED != get_preproc_time_value(&stats.queue, get_rparam(request, 2), result))
+		{
+			error = zbx_strdup(NULL, "Invalid third parameter.");
+			goto out;
+		}
+	}
+	else if (0 == strcmp(tmp, "step"))		/* zabbix[preprocessing,step,<type>,<mode>] */
+	{
+		if (3 > nparams || nparams > 4)
+		{
+			error = zbx_strdup(NULL, "Invalid number of parameters.");
+			goto out;
+		}
+
+		tmp1 = get_rparam(request, 2);
+
+		for (type = 1; type < ZBX_PREPROC_TYPE_MAX; type++)
+		{
+			if (0 == strcmp(tmp1, zbx_preproc_type_string(type)))
+				break;
+		}
+
+		if (ZBX_PREPROC_TYPE_MAX == type)
+		{
+			error = zbx_strdup(NULL, "Invalid third parameter.");
+			goto out;
+		}
+
+		if (SUCCEED != get_preproc_time_value(&stats.steps[type], get_rparam(request, 3), result))
+		{
+			error = zbx_strdup(NULL, "Invalid fourth parameter.");
+			goto out;
+		}
+	}
+	else
+		error = zbx_strdup(NULL, "Invalid second parameter.");
+out:
+	zbx_preprocessor_clear_stats(&stats);
+
+	if (NULL != error)
+	{
+		SET_MSG_RESULT(result, error);
+		return FAIL;
+	}
+
+	return SUCCEED;
+}
+
 /******************************************************************************
  *                                                                            *
  * Function: get_value_internal                                               *
@@ -804,6 +965,17 @@ int	get_value_internal(DC_ITEM *item, AGENT_RESULT *result)
 
 		SET_UI64_RESULT(result, zbx_preprocessor_get_queue_size());
 	}
+	else if (0 == strcmp(tmp, "preprocessing"))		/* zabbix[preprocessing,<stats>,...] */
+	{
+		if (2 > nparams || nparams > 4)
+		{
+			SET_MSG_RESULT(result, zbx_strdup(NULL, "Invalid number of parameters."));
+			goto out;
+		}
+
+		if (SUCCEED != get_preprocessing_value(&request, result))
+			goto out;
+	}
 	else
 	{
 		SET_MSG_RESULT(result, zbx_strdup(NULL, "Invalid first parameter."));
@@ -769,7 +769,7 @@ static int	get_values(unsigned char poller_type, int *nextcheck)
 			{
 				items[i].state = ITEM_STATE_NORMAL;
 				zbx_preprocess_item_value(items[i].itemid, items[i].value_type, items[i].flags,
-						&results[i], &timespec, items[i].state, NULL);
+						items[i].preprocessing, &results[i], &timespec, items[i].state, NULL);
 			}
 			else
 			{
@@ -786,15 +786,15 @@ static int	get_values(unsigned char poller_type, int *nextcheck)
 					{
 						items[i].state = ITEM_STATE_NOTSUPPORTED;
 						zbx_preprocess_item_value(items[i].itemid, items[i].value_type,
-								items[i].flags, NULL, &ts_tmp, items[i].state,
-								add_result->msg);
+								items[i].flags, items[i].preprocessing, NULL, &ts_tmp,
+								items[i].state, add_result->msg);
 					}
 					else
 					{
 						items[i].state = ITEM_STATE_NORMAL;
 						zbx_preprocess_item_value(items[i].itemid, items[i].value_type,
-								items[i].flags, add_result, &ts_tmp, items[i].state,
-								NULL);
+								items[i].flags, items[i].preprocessing, add_result, &ts_tmp,
+								items[i].state, NULL);
 					}
 
 					/* ensure that every log item value timestamp is unique */
@@ -809,8 +809,8 @@ static int	get_values(unsigned char poller_type, int *nextcheck)
 		else if (NOTSUPPORTED == errcodes[i] || AGENT_ERROR == errcodes[i] || CONFIG_ERROR == errcodes[i])
 		{
 			items[i].state = ITEM_STATE_NOTSUPPORTED;
-			zbx_preprocess_item_value(items[i].itemid, items[i].value_type, items[i].flags, NULL, &timespec,
-					items[i].state, results[i].msg);
+			zbx_preprocess_item_value(items[i].itemid, items[i].value_type, items[i].flags,
+					items[i].preprocessing, NULL, &timespec, items[i].state, results[i].msg);
 		}
 
 		DCpoller_requeue_items(&items[i].itemid, &items[i].state, &timespec.sec, &errcodes[i], 1, poller_type,
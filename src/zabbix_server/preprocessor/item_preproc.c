@@ -897,11 +897,12 @@ static int	item_preproc_regsub(zbx_variant_t *value, const char *params, char **
 
 /******************************************************************************
  *                                                                            *
- * Function: item_preproc_jsonpath_op                                         *
+ * Function: item_preproc_jsonpath_query                                      *
  *                                                                            *
- * Purpose: execute jsonpath query                                            *
+ * Purpose: execute jsonpath query on parsed json value                       *
  *                                                                            *
  * Parameters: value  - [IN/OUT] the value to process                         *
+ *             jp     - [IN] the parsed json data                             *
  *             params - [IN] the operation parameters                         *
  *             errmsg - [OUT] error message                                   *
  *                                                                            *
@@ -909,15 +910,12 @@ static int	item_preproc_regsub(zbx_variant_t *value, const char *params, char **
  *               FAIL - otherwise                                             *
  *                                                                            *
  ******************************************************************************/
-static int	item_preproc_jsonpath_op(zbx_variant_t *value, const char *params, char **errmsg)
+static int	item_preproc_jsonpath_query(zbx_variant_t *value, const struct zbx_json_parse *jp, const char *params,
+		char **errmsg)
 {
-	struct zbx_json_parse	jp;
-	char			*data = NULL;
+	char	*data = NULL;
 
-	if (FAIL == item_preproc_convert_value(value, ZBX_VARIANT_STR, errmsg))
-		return FAIL;
-
-	if (FAIL == zbx_json_open(value->data.str, &jp) || FAIL == zbx_jsonpath_query(&jp, params, &data))
+	if (FAIL == zbx_jsonpath_query(jp, params, &data))
 	{
 		*errmsg = zbx_strdup(*errmsg, zbx_json_strerror());
 		return FAIL;
@@ -937,7 +935,7 @@ static int	item_preproc_jsonpath_op(zbx_variant_t *value, const char *params, ch
 
 /******************************************************************************
  *                                                                            *
- * Function: item_preproc_jsonpath                                            *
+ * Function: item_preproc_jsonpath_op                                         *
  *                                                                            *
  * Purpose: execute jsonpath query                                            *
  *                                                                            *
@@ -949,11 +947,49 @@ static int	item_preproc_jsonpath_op(zbx_variant_t *value, const char *params, ch
  *               FAIL - otherwise                                             *
  *                                                                            *
  ******************************************************************************/
-static int	item_preproc_jsonpath(zbx_variant_t *value, const char *params, char **errmsg)
+static int	item_preproc_jsonpath_op(zbx_variant_t *value, const char *params, char **errmsg)
+{
+	struct zbx_json_parse	jp;
+
+	if (FAIL == item_preproc_convert_value(value, ZBX_VARIANT_STR, errmsg))
+		return FAIL;
+
+	if (FAIL == zbx_json_open(value->data.str, &jp))
+	{
+		*errmsg = zbx_strdup(*errmsg, zbx_json_strerror());
+		return FAIL;
+	}
+
+	return item_preproc_jsonpath_query(value, &jp, params, errmsg);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: item_preproc_jsonpath                                            *
+ *                                                                            *
+ * Purpose: execute jsonpath query                                            *
+ *                                                                            *
+ * Parameters: value    - [IN/OUT] the value to process                       *
+ *             jp_value - [IN] the parsed value (can be NULL)                 *
+ *             params   - [IN] the operation parameters                       *
+ *             errmsg   - [OUT] error message                                 *
+ *                                                                            *
+ * Return value: SUCCEED - the value was processed successfully               *
+ *               FAIL - otherwise                                             *
+ *                                                                            *
+ ******************************************************************************/
+static int	item_preproc_jsonpath(zbx_variant_t *value, const struct zbx_json_parse *jp_value, const char *params,
+		char **errmsg)
 {
 	char	*err = NULL;
+	int	ret;
+
+	if (NULL != jp_value)
+		ret = item_preproc_jsonpath_query(value, jp_value, params, &err);
+	else
+		ret = item_preproc_jsonpath_op(value, params, &err);
 
-	if (SUCCEED == item_preproc_jsonpath_op(value, params, &err))
+	if (SUCCEED == ret)
 		return SUCCEED;
 
 	*errmsg = zbx_dsprintf(*errmsg, "cannot extract value from json by path \"%s\": %s", params, err);
@@ -1669,6 +1705,7 @@ fail:
  * Purpose: parse Prometheus format metrics                                   *
  *                                                                            *
  * Parameters: value  - [IN/OUT] the value to process                         *
+ *             prom   - [IN] the parsed value (can be NULL)                   *
  *             params - [IN] the operation parameters                         *
  *             errmsg - [OUT] error message                                   *
  *                                                                            *
@@ -1676,10 +1713,12 @@ fail:
  *               FAIL - otherwise                                             *
  *                                                                            *
  ******************************************************************************/
-static int	item_preproc_prometheus_pattern(zbx_variant_t *value, const char *params, char **errmsg)
+static int	item_preproc_prometheus_pattern(zbx_variant_t *value, zbx_prometheus_t *prom, const char *params,
+		char **errmsg)
 {
 	char	pattern[ITEM_PREPROC_PARAMS_LEN * ZBX_MAX_BYTES_IN_UTF8_CHAR + 1], *output, *value_out = NULL,
 		*err = NULL;
+	int	ret;
 
 	if (FAIL == item_preproc_convert_value(value, ZBX_VARIANT_STR, errmsg))
 		return FAIL;
@@ -1694,7 +1733,12 @@ static int	item_preproc_prometheus_pattern(zbx_variant_t *value, const char *par
 
 	*output++ = '\0';
 
-	if (FAIL == zbx_prometheus_pattern(value->data.str, pattern, output, &value_out, &err))
+	if (NULL != prom)
+		ret = zbx_prometheus_pattern_ex(prom, pattern, output, &value_out, &err);
+	else
+		ret = zbx_prometheus_pattern(value->data.str, pattern, output, &value_out, &err);
+
+	if (FAIL == ret)
 	{
 		*errmsg = zbx_dsprintf(*errmsg, "cannot apply Prometheus pattern: %s", err);
 		zbx_free(err);
@@ -1838,10 +1882,10 @@ static int	item_preproc_csv_to_json(zbx_variant_t *value, const char *params, ch
 #define CSV_STATE_FIELD_QUOTED	2
 
 	unsigned int	fld_num = 0, fld_num_max = 0, hdr_line, state = CSV_STATE_DELIM;
-	char		*field, *field_esc = NULL, **field_names = NULL, *data, *value_out = NULL,
+	char		*field, **field_names = NULL, *data, *value_out = NULL,
 			delim[ZBX_MAX_BYTES_IN_UTF8_CHAR], quote[ZBX_MAX_BYTES_IN_UTF8_CHAR];
 	struct zbx_json	json;
-	size_t		data_len, delim_sz = 1, quote_sz = 0, step;
+	size_t		data_len, delim_sz = 1, quote_sz = 0, step, field_shift = 0;
 	int		ret = SUCCEED;
 
 	if (FAIL == item_preproc_convert_value(value, ZBX_VARIANT_STR, errmsg))
@@ -1957,7 +2001,6 @@ static int	item_preproc_csv_to_json(zbx_variant_t *value, const char *params, ch
 							goto out;
 
 						field = NULL;
-						zbx_free(field_esc);
 					} while (++fld_num < fld_num_max && 1 == hdr_line);
 
 					if (fld_num > fld_num_max)
@@ -1981,7 +2024,6 @@ static int	item_preproc_csv_to_json(zbx_variant_t *value, const char *params, ch
 					goto out;
 
 				field = NULL;
-				zbx_free(field_esc);
 				fld_num++;
 				state = CSV_STATE_DELIM;
 			}
@@ -2005,44 +2047,47 @@ static int	item_preproc_csv_to_json(zbx_variant_t *value, const char *params, ch
 
 			if (char_sz == quote_sz && 0 == memcmp(data_next, quote, quote_sz))
 			{
+				/* escaped quote - keep the first quote character and skip the second one */
 				if (NULL == field)
 					field = data;
+				else if (0 != field_shift)
+					memmove(data - field_shift, data, quote_sz);
 
-				*data_next = '\0';
-				field_esc = zbx_dsprintf(field_esc, "%s%s", ZBX_NULL2EMPTY_STR(field_esc), field);
-				field = NULL;
+				field_shift += quote_sz;
 				data = data_next;
 			}
 			else if ('\r' == *data_next || '\n' == *data_next || '\0' == *data_next ||
 					(char_sz == delim_sz && 0 == memcmp(data_next, delim, delim_sz)))
 			{
 				state = CSV_STATE_FIELD;
-				*data = '\0';
-
-				if (NULL != field_esc)
-				{
-					field_esc = zbx_dsprintf(field_esc, "%s%s", field_esc,
-							ZBX_NULL2EMPTY_STR(field));
-					field = field_esc;
-				}
+				*(data - field_shift) = '\0';
+				field_shift = 0;
 			}
 			else
 			{
 				*errmsg = zbx_dsprintf(*errmsg, "cannot convert CSV to JSON: delimiter character or "
 						"end of line are not detected after quoted field \"%.*s\"",
-						(int)(data - field), field);
+						(NULL == field ? 0 : (int)(data - field_shift - field)),
+						ZBX_NULL2EMPTY_STR(field));
 				ret = FAIL;
 				goto out;
 			}
 		}
-		else if (NULL == field)
+		else
 		{
-			field = data;
+			/* unescaped quoted field is moved in place over the removed escape characters */
+			if (NULL == field)
+				field = data;
+			else if (0 != field_shift)
+				memmove(data - field_shift, data, step);
 		}
 	}
 
 	if (CSV_STATE_FIELD_QUOTED == state)
 	{
+		if (NULL != field)
+			*(value->data.str + data_len - field_shift) = '\0';
+
 		*errmsg = zbx_dsprintf(*errmsg, "cannot convert CSV to JSON: unclosed quoted field \"%s\"", field);
 		ret = FAIL;
 	}
@@ -2066,7 +2111,6 @@ out:
 		zbx_free(field_names);
 	}
 
-	zbx_free(field_esc);
 	zbx_json_free(&json);
 
 	return ret;
@@ -2138,7 +2182,7 @@ int	zbx_item_preproc(unsigned char value_type, zbx_variant_t *value, const zbx_t
 			ret = item_preproc_xpath(value, op->params, error);
 			break;
 		case ZBX_PREPROC_JSONPATH:
-			ret = item_preproc_jsonpath(value, op->params, error);
+			ret = item_preproc_jsonpath(value, NULL, op->params, error);
 			break;
 		case ZBX_PREPROC_VALIDATE_RANGE:
 			ret = item_preproc_validate_range(value_type, value, op->params, error);
@@ -2169,7 +2213,7 @@ int	zbx_item_preproc(unsigned char value_type, zbx_variant_t *value, const zbx_t
 			ret = item_preproc_script(value, op->params, history_value, error);
 			break;
 		case ZBX_PREPROC_PROMETHEUS_PATTERN:
-			ret = item_preproc_prometheus_pattern(value, op->params, error);
+			ret = item_preproc_prometheus_pattern(value, NULL, op->params, error);
 			break;
 		case ZBX_PREPROC_PROMETHEUS_TO_JSON:
 			ret = item_preproc_prometheus_to_json(value, op->params, error);
@@ -2185,6 +2229,55 @@ int	zbx_item_preproc(unsigned char value_type, zbx_variant_t *value, const zbx_t
 	return ret;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_item_preproc_jsonpath                                        *
+ *                                                                            *
+ * Purpose: execute jsonpath preprocessing step on already parsed value       *
+ *                                                                            *
+ * Parameters: value    - [IN/OUT] the value to process                       *
+ *             jp_value - [IN] the parsed value                               *
+ *             op       - [IN] the jsonpath preprocessing operation           *
+ *             error    - [OUT] error message                                 *
+ *                                                                            *
+ * Return value: SUCCEED - the preprocessing step finished successfully       *
+ *               FAIL - otherwise, error contains the error message           *
+ *                                                                            *
+ * Comments: Used to extract values of several dependent items from the same  *
+ *           master item value without parsing it for each dependent item.    *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_item_preproc_jsonpath(zbx_variant_t *value, const struct zbx_json_parse *jp_value,
+		const zbx_preproc_op_t *op, char **error)
+{
+	return item_preproc_jsonpath(value, jp_value, op->params, error);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_item_preproc_prometheus_pattern                              *
+ *                                                                            *
+ * Purpose: execute Prometheus pattern preprocessing step on already parsed   *
+ *          value                                                             *
+ *                                                                            *
+ * Parameters: value - [IN/OUT] the value to process                          *
+ *             prom  - [IN] the parsed value                                  *
+ *             op    - [IN] the Prometheus pattern preprocessing operation    *
+ *             error - [OUT] error message                                    *
+ *                                                                            *
+ * Return value: SUCCEED - the preprocessing step finished successfully       *
+ *               FAIL - otherwise, error contains the error message           *
+ *                                                                            *
+ * Comments: Used to extract values of several dependent items from the same  *
+ *           master item value without parsing it for each dependent item.    *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_item_preproc_prometheus_pattern(zbx_variant_t *value, zbx_prometheus_t *prom, const zbx_preproc_op_t *op,
+		char **error)
+{
+	return item_preproc_prometheus_pattern(value, prom, op->params, error);
+}
+
 /******************************************************************************
  *                                                                            *
  * Function: zbx_item_preproc_handle_error                                    *
@@ -22,10 +22,18 @@
 
 #include "dbcache.h"
 #include "preproc.h"
+#include "zbxjson.h"
+#include "zbxprometheus.h"
 
 int	zbx_item_preproc(unsigned char value_type, zbx_variant_t *value, const zbx_timespec_t *ts,
 		const zbx_preproc_op_t *op, zbx_variant_t *history_value, zbx_timespec_t *history_ts, char **error);
 
+int	zbx_item_preproc_jsonpath(zbx_variant_t *value, const struct zbx_json_parse *jp_value,
+		const zbx_preproc_op_t *op, char **error);
+
+int	zbx_item_preproc_prometheus_pattern(zbx_variant_t *value, zbx_prometheus_t *prom, const zbx_preproc_op_t *op,
+		char **error);
+
 int	zbx_item_preproc_handle_error(zbx_variant_t *value, const zbx_preproc_op_t *op, char **error);
 
 int	zbx_item_preproc_convert_value_to_numeric(zbx_variant_t *value_num, const zbx_variant_t *value,
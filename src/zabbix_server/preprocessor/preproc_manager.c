@@ -35,13 +35,17 @@
 #include "preproc_history.h"
 
 extern unsigned char	process_type, program_type;
-extern int		server_num, process_num, CONFIG_PREPROCESSOR_FORKS;
+extern int		server_num, process_num, CONFIG_PREPROCESSOR_FORKS, CONFIG_PREPROCMAN_FORKS;
 
 #define ZBX_PREPROCESSING_MANAGER_DELAY	1
 
 #define ZBX_PREPROC_PRIORITY_NONE	0
 #define ZBX_PREPROC_PRIORITY_FIRST	1
 
+#define ZBX_PREPROC_DEP_TASK_MAX	100	/* max number of dependent item values in one worker task */
+#define ZBX_PREPROC_BATCH_MAX		64	/* max number of item values in one worker batch task */
+#define ZBX_PREPROC_ITEM_STATS_MAX	1000	/* max number of items with kept preprocessing statistics */
+
 typedef enum
 {
 	REQUEST_STATE_QUEUED		= 0,		/* requires preprocessing */
@@ -62,14 +66,18 @@ typedef struct preprocessing_request
 	int				steps_num;	/* number of preprocessing steps */
 	unsigned char			value_type;	/* value type from configuration */
 							/* at the beginning of preprocessing queue */
+	zbx_uint64_t			master_valueid;	/* identifier of master item value shared with */
+							/* other dependent items, 0 if not shared      */
+	double				time_queued;	/* the time when request was queued */
 }
 zbx_preprocessing_request_t;
 
 /* preprocessing worker data */
 typedef struct
 {
-	zbx_ipc_client_t	*client;	/* the connected preprocessing worker client */
-	void			*task;		/* the current task data */
+	zbx_ipc_client_t		*client;	/* the connected preprocessing worker client */
+	void				*task;		/* the current task data */
+	zbx_preproc_worker_stats_t	stats;		/* the statistics reported by worker */
 }
 zbx_preprocessing_worker_t;
 
@@ -94,6 +102,7 @@ typedef struct
 {
 	zbx_preprocessing_worker_t	*workers;	/* preprocessing worker array */
 	int				worker_count;	/* preprocessing worker count */
+	int				worker_max;	/* number of workers assigned to this manager */
 	zbx_list_t			queue;		/* queue of item values */
 	zbx_hashset_t			item_config;	/* item configuration L2 cache */
 	zbx_hashset_t			history_cache;	/* item value history cache */
@@ -106,6 +115,13 @@ typedef struct
 
 	zbx_list_t			direct_queue;	/* Queue of external requests that have to be */
 							/* forwarded to workers for preprocessing.    */
+	zbx_uint64_t			master_valueid;	/* last shared master item value identifier */
+
+	double				time_now;	/* the time of the last received message */
+	double				time_start;	/* the statistics collection start time */
+	zbx_preproc_time_stats_t	queue_stats;	/* time spent by values in queue */
+	zbx_preproc_time_stats_t	step_stats[ZBX_PREPROC_TYPE_MAX];	/* step time by step type */
+	zbx_hashset_t			item_stats;	/* item preprocessing and queue time */
 }
 zbx_preprocessing_manager_t;
 
@@ -200,46 +216,256 @@ static void	preprocessor_sync_configuration(zbx_preprocessing_manager_t *manager
 
 /******************************************************************************
  *                                                                            *
- * Function: preprocessor_create_task                                         *
+ * Function: preprocessor_get_request_value                                   *
  *                                                                            *
- * Purpose: create preprocessing task for request                             *
+ * Purpose: get request value as variant without copying it                   *
  *                                                                            *
- * Parameters: manager - [IN] preprocessing manager                           *
- *             request - [IN] preprocessing request                           *
- *             task    - [OUT] preprocessing task data                        *
+ * Parameters: request - [IN] preprocessing request                           *
+ *             value   - [OUT] the value pointing at request data             *
  *                                                                            *
  ******************************************************************************/
-static zbx_uint32_t	preprocessor_create_task(zbx_preprocessing_manager_t *manager,
-		zbx_preprocessing_request_t *request, unsigned char **task)
+static void	preprocessor_get_request_value(const zbx_preprocessing_request_t *request, zbx_variant_t *value)
 {
-	zbx_variant_t		value;
-	zbx_preproc_history_t	*vault;
-	zbx_vector_ptr_t	*phistory;
-
 	if (ISSET_LOG(request->value.result))
-		zbx_variant_set_str(&value, request->value.result->log->value);
+		zbx_variant_set_str(value, request->value.result->log->value);
 	else if (ISSET_UI64(request->value.result))
-		zbx_variant_set_ui64(&value, request->value.result->ui64);
+		zbx_variant_set_ui64(value, request->value.result->ui64);
 	else if (ISSET_DBL(request->value.result))
-		zbx_variant_set_dbl(&value, request->value.result->dbl);
+		zbx_variant_set_dbl(value, request->value.result->dbl);
 	else if (ISSET_STR(request->value.result))
-		zbx_variant_set_str(&value, request->value.result->str);
+		zbx_variant_set_str(value, request->value.result->str);
 	else if (ISSET_TEXT(request->value.result))
-		zbx_variant_set_str(&value, request->value.result->text);
+		zbx_variant_set_str(value, request->value.result->text);
 	else
 		THIS_SHOULD_NEVER_HAPPEN;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: preprocessor_get_request_history                                 *
+ *                                                                            *
+ * Purpose: get preprocessing history of request item                         *
+ *                                                                            *
+ * Parameters: manager - [IN] preprocessing manager                           *
+ *             request - [IN] preprocessing request                           *
+ *                                                                            *
+ * Return value: the preprocessing history or NULL if item has no history     *
+ *                                                                            *
+ ******************************************************************************/
+static const zbx_vector_ptr_t	*preprocessor_get_request_history(zbx_preprocessing_manager_t *manager,
+		const zbx_preprocessing_request_t *request)
+{
+	zbx_preproc_history_t	*vault;
 
 	if (NULL != (vault = (zbx_preproc_history_t *)zbx_hashset_search(&manager->history_cache,
 				&request->value.itemid)))
 	{
-		phistory = &vault->history;
+		return &vault->history;
 	}
-	else
-		phistory = NULL;
 
+	return NULL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: preprocessor_create_task                                         *
+ *                                                                            *
+ * Purpose: create preprocessing task for request                             *
+ *                                                                            *
+ * Parameters: manager - [IN] preprocessing manager                           *
+ *             request - [IN] preprocessing request                           *
+ *             message - [IN/OUT] the IPC message, the task is appended to it *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_uint32_t	preprocessor_create_task(zbx_preprocessing_manager_t *manager,
+		zbx_preprocessing_request_t *request, zbx_ipc_message_t *message)
+{
+	zbx_variant_t	value;
+
+	preprocessor_get_request_value(request, &value);
 
-	return zbx_preprocessor_pack_task(task, request->value.itemid, request->value_type, request->value.ts, &value,
-			phistory, request->steps, request->steps_num);
+	return zbx_preprocessor_pack_task(message, request->value.itemid, request->value_type, request->value.ts, &value,
+			preprocessor_get_request_history(manager, request), request->steps, request->steps_num);
+}
+
+static int	preprocessor_compare_item_stats_time(const void *d1, const void *d2)
+{
+	const zbx_preproc_item_stats_t	*s1 = *(const zbx_preproc_item_stats_t **)d1;
+	const zbx_preproc_item_stats_t	*s2 = *(const zbx_preproc_item_stats_t **)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(s2->time + s2->queue_time, s1->time + s1->queue_time);
+	ZBX_RETURN_IF_NOT_EQUAL(s1->itemid, s2->itemid);
+
+	return 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: preprocessor_trim_item_stats                                     *
+ *                                                                            *
+ * Purpose: keep statistics of the items with the most preprocessing time     *
+ *                                                                            *
+ * Parameters: manager - [IN] preprocessing manager                           *
+ *                                                                            *
+ * Comments: Statistics of removed items (including deleted items) are        *
+ *           collected again from zero if their values are preprocessed       *
+ *           later.                                                           *
+ *                                                                            *
+ ******************************************************************************/
+static void	preprocessor_trim_item_stats(zbx_preprocessing_manager_t *manager)
+{
+	zbx_vector_ptr_t		items;
+	zbx_hashset_iter_t		iter;
+	zbx_preproc_item_stats_t	*item;
+	int				i;
+
+	zbx_vector_ptr_create(&items);
+	zbx_vector_ptr_reserve(&items, manager->item_stats.num_data);
+
+	zbx_hashset_iter_reset(&manager->item_stats, &iter);
+	while (NULL != (item = (zbx_preproc_item_stats_t *)zbx_hashset_iter_next(&iter)))
+		zbx_vector_ptr_append(&items, item);
+
+	zbx_vector_ptr_sort(&items, preprocessor_compare_item_stats_time);
+
+	for (i = ZBX_PREPROC_ITEM_STATS_MAX; i < items.values_num; i++)
+		zbx_hashset_remove_direct(&manager->item_stats, items.values[i]);
+
+	zbx_vector_ptr_destroy(&items);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: preprocessor_get_item_stats                                      *
+ *                                                                            *
+ * Purpose: get preprocessing statistics of an item                           *
+ *                                                                            *
+ * Parameters: manager - [IN] preprocessing manager                           *
+ *             itemid  - [IN] the item identifier                             *
+ *                                                                            *
+ * Return value: the item statistics                                          *
+ *                                                                            *
+ * Comments: The statistics are trimmed to ZBX_PREPROC_ITEM_STATS_MAX items   *
+ *           when they grow twice as large, so the trimming cost is spread    *
+ *           over the added items.                                            *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_preproc_item_stats_t	*preprocessor_get_item_stats(zbx_preprocessing_manager_t *manager,
+		zbx_uint64_t itemid)
+{
+	zbx_preproc_item_stats_t	*item, item_local;
+
+	if (NULL != (item = (zbx_preproc_item_stats_t *)zbx_hashset_search(&manager->item_stats, &itemid)))
+		return item;
+
+	if (2 * ZBX_PREPROC_ITEM_STATS_MAX <= manager->item_stats.num_data)
+		preprocessor_trim_item_stats(manager);
+
+	memset(&item_local, 0, sizeof(item_local));
+	item_local.itemid = itemid;
+
+	return (zbx_preproc_item_stats_t *)zbx_hashset_insert(&manager->item_stats, &item_local, sizeof(item_local));
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: preprocessor_set_request_state_processing                        *
+ *                                                                            *
+ * Purpose: set request state to processing and account the time the request  *
+ *          spent in queue                                                    *
+ *                                                                            *
+ * Parameters: manager - [IN] preprocessing manager                           *
+ *             request - [IN] preprocessing request                           *
+ *                                                                            *
+ ******************************************************************************/
+static void	preprocessor_set_request_state_processing(zbx_preprocessing_manager_t *manager,
+		zbx_preprocessing_request_t *request)
+{
+	zbx_preproc_item_stats_t	*item;
+	double				queue_time = manager->time_now - request->time_queued;
+
+	request->state = REQUEST_STATE_PROCESSING;
+	zbx_preproc_time_stats_add(&manager->queue_stats, queue_time);
+
+	item = preprocessor_get_item_stats(manager, request->value.itemid);
+	item->queue_count++;
+	item->queue_time += queue_time;
+
+	if (item->queue_time_max < queue_time)
+		item->queue_time_max = queue_time;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: preprocessor_create_dep_task                                     *
+ *                                                                            *
+ * Purpose: create preprocessing task for dependent item requests sharing     *
+ *          the same master item value                                        *
+ *                                                                            *
+ * Parameters: manager - [IN] preprocessing manager                           *
+ *             first   - [IN] iterator pointing at the first queued request   *
+ *             message - [OUT] the serialized task to be sent                 *
+ *                                                                            *
+ * Return value: vector of the queued requests included in the task or NULL   *
+ *               if there are no other queued requests sharing the value      *
+ *                                                                            *
+ * Comments: The requests sharing master item value are enqueued next to each *
+ *           other. The master item value is packed only once and the worker  *
+ *           parses it only once for all dependent items in the task.         *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_vector_ptr_t	*preprocessor_create_dep_task(zbx_preprocessing_manager_t *manager,
+		const zbx_list_iterator_t *first, zbx_ipc_message_t *message)
+{
+	zbx_list_iterator_t		iterator = *first;
+	zbx_preprocessing_request_t	*first_request, *request;
+	zbx_vector_ptr_t		*queue_items;
+	zbx_variant_t			value;
+	int				i;
+
+	zbx_list_iterator_peek(&iterator, (void **)&first_request);
+
+	queue_items = (zbx_vector_ptr_t *)zbx_malloc(NULL, sizeof(zbx_vector_ptr_t));
+	zbx_vector_ptr_create(queue_items);
+	zbx_vector_ptr_append(queue_items, iterator.current);
+
+	while (ZBX_PREPROC_DEP_TASK_MAX > queue_items->values_num && SUCCEED == zbx_list_iterator_next(&iterator))
+	{
+		zbx_list_iterator_peek(&iterator, (void **)&request);
+
+		if (request->master_valueid != first_request->master_valueid)
+			break;
+
+		if (REQUEST_STATE_QUEUED == request->state)
+			zbx_vector_ptr_append(queue_items, iterator.current);
+	}
+
+	if (1 == queue_items->values_num)
+	{
+		zbx_vector_ptr_destroy(queue_items);
+		zbx_free(queue_items);
+
+		return NULL;
+	}
+
+	zbx_ipc_message_init(message);
+	message->code = ZBX_IPC_PREPROCESSOR_DEP_REQUEST;
+
+	preprocessor_get_request_value(first_request, &value);
+	zbx_preprocessor_pack_dep_request(message, first_request->value.ts, &value);
+
+	for (i = 0; i < queue_items->values_num; i++)
+	{
+		request = (zbx_preprocessing_request_t *)((zbx_list_item_t *)queue_items->values[i])->data;
+
+		zbx_preprocessor_pack_dep_request_item(message, request->value.itemid, request->value_type,
+				preprocessor_get_request_history(manager, request), request->steps, request->steps_num);
+
+		preprocessor_set_request_state_processing(manager, request);
+		request_free_steps(request);
+	}
+
+	return queue_items;
 }
 
 /******************************************************************************
@@ -271,6 +497,40 @@ static	void	preprocessor_set_request_state_done(zbx_preprocessing_manager_t *man
 	}
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: preprocessor_get_batch_size                                      *
+ *                                                                            *
+ * Purpose: get the number of item values to be sent to worker in one task    *
+ *                                                                            *
+ * Parameters: manager - [IN] preprocessing manager                           *
+ *                                                                            *
+ * Return value: the batch size                                               *
+ *                                                                            *
+ * Comments: Values waiting for preprocessing are spread evenly between       *
+ *           workers. With low load values are sent one by one, with high     *
+ *           load up to ZBX_PREPROC_BATCH_MAX values are sent in one task to  *
+ *           reduce IPC overhead.                                             *
+ *                                                                            *
+ ******************************************************************************/
+static int	preprocessor_get_batch_size(const zbx_preprocessing_manager_t *manager)
+{
+	zbx_uint64_t	batch_size;
+
+	if (0 == manager->worker_count)
+		return 1;
+
+	batch_size = manager->preproc_num / manager->worker_count;
+
+	if (ZBX_PREPROC_BATCH_MAX < batch_size)
+		return ZBX_PREPROC_BATCH_MAX;
+
+	if (0 == batch_size)
+		return 1;
+
+	return (int)batch_size;
+}
+
 /******************************************************************************
  *                                                                            *
  * Function: preprocessor_get_next_task                                       *
@@ -282,6 +542,9 @@ static	void	preprocessor_set_request_state_done(zbx_preprocessing_manager_t *man
  *                                                                            *
  * Return value: pointer to the task object                                   *
  *                                                                            *
+ * Comments: Batch and dependent item tasks are returned as vectors of the    *
+ *           queued requests included in the task.                            *
+ *                                                                            *
  ******************************************************************************/
 static void	*preprocessor_get_next_task(zbx_preprocessing_manager_t *manager, zbx_ipc_message_t *message)
 {
@@ -289,6 +552,8 @@ static void	*preprocessor_get_next_task(zbx_preprocessing_manager_t *manager, zb
 	zbx_preprocessing_request_t		*request = NULL;
 	void					*task = NULL;
 	zbx_preprocessing_direct_request_t	*direct_request;
+	zbx_vector_ptr_t			*queue_items = NULL;
+	int					batch_size;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
@@ -300,6 +565,8 @@ static void	*preprocessor_get_next_task(zbx_preprocessing_manager_t *manager, zb
 		goto out;
 	}
 
+	batch_size = preprocessor_get_batch_size(manager);
+
 	zbx_list_iterator_init(&manager->queue, &iterator);
 	while (SUCCEED == zbx_list_iterator_next(&iterator))
 	{
@@ -325,13 +592,45 @@ static void	*preprocessor_get_next_task(zbx_preprocessing_manager_t *manager, zb
 			continue;
 		}
 
-		task = iterator.current;
-		request->state = REQUEST_STATE_PROCESSING;
-		message->code = ZBX_IPC_PREPROCESSOR_REQUEST;
-		message->size = preprocessor_create_task(manager, request, &message->data);
+		/* dependent items sharing master item value are sent to worker in one task */
+		if (NULL == queue_items && 0 != request->master_valueid &&
+				NULL != (task = preprocessor_create_dep_task(manager, &iterator, message)))
+		{
+			break;
+		}
+
+		preprocessor_set_request_state_processing(manager, request);
+
+		if (1 == batch_size)
+		{
+			task = iterator.current;
+			zbx_ipc_message_init(message);
+			message->code = ZBX_IPC_PREPROCESSOR_REQUEST;
+			preprocessor_create_task(manager, request, message);
+			request_free_steps(request);
+			break;
+		}
+
+		if (NULL == queue_items)
+		{
+			queue_items = (zbx_vector_ptr_t *)zbx_malloc(NULL, sizeof(zbx_vector_ptr_t));
+			zbx_vector_ptr_create(queue_items);
+			zbx_vector_ptr_reserve(queue_items, (size_t)batch_size);
+
+			zbx_ipc_message_init(message);
+			message->code = ZBX_IPC_PREPROCESSOR_BATCH_REQUEST;
+		}
+
+		zbx_vector_ptr_append(queue_items, iterator.current);
+		preprocessor_create_task(manager, request, message);
 		request_free_steps(request);
-		break;
+
+		if (batch_size == queue_items->values_num)
+			break;
 	}
+
+	if (NULL != queue_items)
+		task = queue_items;
 out:
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 
@@ -652,14 +951,16 @@ static void	preprocessor_copy_value(zbx_preproc_item_value_t *target, zbx_prepro
  *                                                                            *
  * Purpose: enqueue preprocessing request                                     *
  *                                                                            *
- * Parameters: manage   - [IN] preprocessing manager                          *
- *             value    - [IN] item value                                     *
- *             master   - [IN] request should be enqueued after this item     *
- *                             (NULL for the end of the queue)                *
+ * Parameters: manage         - [IN] preprocessing manager                    *
+ *             value          - [IN] item value                               *
+ *             master         - [IN] request should be enqueued after this    *
+ *                                   item (NULL for the end of the queue)     *
+ *             master_valueid - [IN] identifier of master item value shared   *
+ *                                   with other dependent items, 0 if none    *
  *                                                                            *
  ******************************************************************************/
 static void	preprocessor_enqueue(zbx_preprocessing_manager_t *manager, zbx_preproc_item_value_t *value,
-		zbx_list_item_t *master)
+		zbx_list_item_t *master, zbx_uint64_t master_valueid)
 {
 	zbx_preprocessing_request_t	*request;
 	zbx_preproc_item_t		*item, item_local;
@@ -700,6 +1001,8 @@ static void	preprocessor_enqueue(zbx_preprocessing_manager_t *manager, zbx_prepr
 	memset(request, 0, sizeof(zbx_preprocessing_request_t));
 	memcpy(&request->value, value, sizeof(zbx_preproc_item_value_t));
 	request->state = state;
+	request->master_valueid = master_valueid;
+	request->time_queued = manager->time_now;
 
 	if (REQUEST_STATE_QUEUED == state && ITEM_STATE_NOTSUPPORTED != value->state)
 	{
@@ -777,6 +1080,7 @@ static void	preprocessor_enqueue_dependent(zbx_preprocessing_manager_t *manager,
 	int				i;
 	zbx_preproc_item_t		*item, item_local;
 	zbx_preproc_item_value_t	value;
+	zbx_uint64_t			master_valueid = 0;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() itemid: " ZBX_FS_UI64, __func__, source_value->itemid);
 
@@ -786,12 +1090,15 @@ static void	preprocessor_enqueue_dependent(zbx_preprocessing_manager_t *manager,
 		if (NULL != (item = (zbx_preproc_item_t *)zbx_hashset_search(&manager->item_config, &item_local)) &&
 				0 != item->dep_itemids_num)
 		{
+			if (1 < item->dep_itemids_num)
+				master_valueid = ++manager->master_valueid;
+
 			for (i = item->dep_itemids_num - 1; i >= 0; i--)
 			{
 				preprocessor_copy_value(&value, source_value);
 				value.itemid = item->dep_itemids[i].first;
 				value.item_flags = item->dep_itemids[i].second;
-				preprocessor_enqueue(manager, &value, master);
+				preprocessor_enqueue(manager, &value, master, master_valueid);
 			}
 
 			preprocessor_assign_tasks(manager);
@@ -824,7 +1131,7 @@ static void	preprocessor_add_request(zbx_preprocessing_manager_t *manager, zbx_i
 	while (offset < message->size)
 	{
 		offset += zbx_preprocessor_unpack_value(&value, message->data + offset);
-		preprocessor_enqueue(manager, &value, NULL);
+		preprocessor_enqueue(manager, &value, NULL, 0);
 	}
 
 	preprocessor_assign_tasks(manager);
@@ -972,34 +1279,26 @@ out:
 
 /******************************************************************************
  *                                                                            *
- * Function: preprocessor_add_result                                          *
+ * Function: preprocessor_set_result                                          *
  *                                                                            *
- * Purpose: handle preprocessing result                                       *
+ * Purpose: set preprocessing result of queued request                        *
  *                                                                            *
- * Parameters: manager - [IN] preprocessing manager                           *
- *             client  - [IN] IPC client                                      *
- *             message - [IN] packed preprocessing result                     *
+ * Parameters: manager    - [IN] preprocessing manager                        *
+ *             queue_item - [IN] the queued request                           *
+ *             value      - [IN/OUT] the preprocessed value                   *
+ *             history    - [IN/OUT] the new preprocessing history, the       *
+ *                                   history records are moved to manager     *
+ *             error      - [IN] preprocessing error (if any), the error is   *
+ *                               moved to request                             *
  *                                                                            *
  ******************************************************************************/
-static void	preprocessor_add_result(zbx_preprocessing_manager_t *manager, zbx_ipc_client_t *client,
-		zbx_ipc_message_t *message)
+static void	preprocessor_set_result(zbx_preprocessing_manager_t *manager, zbx_list_item_t *queue_item,
+		zbx_variant_t *value, zbx_vector_ptr_t *history, char *error)
 {
-	zbx_preprocessing_worker_t	*worker;
 	zbx_preprocessing_request_t	*request;
-	zbx_variant_t			value;
-	char				*error;
-	zbx_vector_ptr_t		history;
 	zbx_preproc_history_t		*vault;
-	zbx_list_item_t			*node;
-
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
-
-	worker = preprocessor_get_worker_by_client(manager, client);
-	node = (zbx_list_item_t *)worker->task;
-	request = (zbx_preprocessing_request_t *)node->data;
 
-	zbx_vector_ptr_create(&history);
-	zbx_preprocessor_unpack_result(&value, &history, &error, message->data);
+	request = (zbx_preprocessing_request_t *)queue_item->data;
 
 	if (NULL != (vault = (zbx_preproc_history_t *)zbx_hashset_search(&manager->history_cache,
 			&request->value.itemid)))
@@ -1007,7 +1306,7 @@ static void	preprocessor_add_result(zbx_preprocessing_manager_t *manager, zbx_ip
 		zbx_vector_ptr_clear_ext(&vault->history, (zbx_clean_func_t)zbx_preproc_op_history_free);
 	}
 
-	if (0 != history.values_num)
+	if (0 != history->values_num)
 	{
 		if (NULL == vault)
 		{
@@ -1019,8 +1318,8 @@ static void	preprocessor_add_result(zbx_preprocessing_manager_t *manager, zbx_ip
 			zbx_vector_ptr_create(&vault->history);
 		}
 
-		zbx_vector_ptr_append_array(&vault->history, history.values, history.values_num);
-		zbx_vector_ptr_clear(&history);
+		zbx_vector_ptr_append_array(&vault->history, history->values, history->values_num);
+		zbx_vector_ptr_clear(history);
 	}
 	else
 	{
@@ -1031,15 +1330,99 @@ static void	preprocessor_add_result(zbx_preprocessing_manager_t *manager, zbx_ip
 		}
 	}
 
-	preprocessor_set_request_state_done(manager, request, worker->task);
+	preprocessor_set_request_state_done(manager, request, queue_item);
+
+	if (FAIL != preprocessor_set_variant_result(request, value, error))
+		preprocessor_enqueue_dependent(manager, &request->value, queue_item);
 
-	if (FAIL != preprocessor_set_variant_result(request, &value, error))
-		preprocessor_enqueue_dependent(manager, &request->value, worker->task);
+	manager->preproc_num--;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: preprocessor_add_result                                          *
+ *                                                                            *
+ * Purpose: handle preprocessing result                                       *
+ *                                                                            *
+ * Parameters: manager - [IN] preprocessing manager                           *
+ *             client  - [IN] IPC client                                      *
+ *             message - [IN] packed preprocessing result                     *
+ *                                                                            *
+ ******************************************************************************/
+static void	preprocessor_add_result(zbx_preprocessing_manager_t *manager, zbx_ipc_client_t *client,
+		zbx_ipc_message_t *message)
+{
+	zbx_preprocessing_worker_t	*worker;
+	zbx_variant_t			value;
+	char				*error;
+	zbx_vector_ptr_t		history;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
+
+	worker = preprocessor_get_worker_by_client(manager, client);
+
+	zbx_vector_ptr_create(&history);
+	zbx_preprocessor_unpack_result(&value, &history, &error, message->data);
+
+	preprocessor_set_result(manager, (zbx_list_item_t *)worker->task, &value, &history, error);
 
 	worker->task = NULL;
 	zbx_variant_clear(&value);
 
-	manager->preproc_num--;
+	preprocessor_assign_tasks(manager);
+	preprocessing_flush_queue(manager);
+
+	zbx_vector_ptr_destroy(&history);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: preprocessor_add_batch_result                                    *
+ *                                                                            *
+ * Purpose: handle preprocessing results of batch or dependent item task      *
+ *                                                                            *
+ * Parameters: manager - [IN] preprocessing manager                           *
+ *             client  - [IN] IPC client                                      *
+ *             message - [IN] packed preprocessing results                    *
+ *                                                                            *
+ ******************************************************************************/
+static void	preprocessor_add_batch_result(zbx_preprocessing_manager_t *manager, zbx_ipc_client_t *client,
+		zbx_ipc_message_t *message)
+{
+	zbx_preprocessing_worker_t	*worker;
+	zbx_variant_t			value;
+	char				*error;
+	zbx_vector_ptr_t		history, *queue_items;
+	zbx_uint32_t			offset = 0;
+	int				i;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
+
+	worker = preprocessor_get_worker_by_client(manager, client);
+	queue_items = (zbx_vector_ptr_t *)worker->task;
+
+	zbx_vector_ptr_create(&history);
+
+	/* results are packed in the same order as requests in task */
+	for (i = 0; i < queue_items->values_num && offset < message->size; i++)
+	{
+		offset += zbx_preprocessor_unpack_result(&value, &history, &error, message->data + offset);
+
+		preprocessor_set_result(manager, (zbx_list_item_t *)queue_items->values[i], &value, &history, error);
+		zbx_variant_clear(&value);
+	}
+
+	if (i != queue_items->values_num)
+	{
+		THIS_SHOULD_NEVER_HAPPEN;
+		exit(EXIT_FAILURE);
+	}
+
+	worker->task = NULL;
+	zbx_vector_ptr_destroy(queue_items);
+	zbx_free(queue_items);
 
 	preprocessor_assign_tasks(manager);
 	preprocessing_flush_queue(manager);
@@ -1087,6 +1470,108 @@ static void	preprocessor_flush_test_result(zbx_preprocessing_manager_t *manager,
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: preprocessor_add_worker_stats                                    *
+ *                                                                            *
+ * Purpose: add preprocessing statistics reported by worker                   *
+ *                                                                            *
+ * Parameters: manager - [IN] preprocessing manager                           *
+ *             client  - [IN] IPC client                                      *
+ *             message - [IN] packed worker statistics                        *
+ *                                                                            *
+ ******************************************************************************/
+static void	preprocessor_add_worker_stats(zbx_preprocessing_manager_t *manager, zbx_ipc_client_t *client,
+		const zbx_ipc_message_t *message)
+{
+	zbx_preprocessing_worker_t	*worker;
+	zbx_preproc_worker_stats_t	worker_stats;
+	zbx_preproc_time_stats_t	steps[ZBX_PREPROC_TYPE_MAX];
+	zbx_preproc_item_stats_t	*item, *item_stats;
+	zbx_vector_ptr_t		items;
+	int				i;
+
+	worker = preprocessor_get_worker_by_client(manager, client);
+
+	zbx_vector_ptr_create(&items);
+	zbx_preprocessor_unpack_worker_stats(&worker_stats, steps, &items, message->data);
+
+	worker->stats.process_num = worker_stats.process_num;
+	worker->stats.values_num += worker_stats.values_num;
+
+	for (i = 0; i < ZBX_PREPROC_TYPE_MAX; i++)
+		zbx_preproc_time_stats_merge(&manager->step_stats[i], &steps[i]);
+
+	for (i = 0; i < items.values_num; i++)
+	{
+		item = (zbx_preproc_item_stats_t *)items.values[i];
+		item_stats = preprocessor_get_item_stats(manager, item->itemid);
+
+		item_stats->count += item->count;
+		item_stats->time += item->time;
+
+		if (item_stats->time_max < item->time_max)
+			item_stats->time_max = item->time_max;
+	}
+
+	zbx_vector_ptr_clear_ext(&items, zbx_ptr_free);
+	zbx_vector_ptr_destroy(&items);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: preprocessor_send_stats                                          *
+ *                                                                            *
+ * Purpose: send preprocessing statistics to the requesting client            *
+ *                                                                            *
+ * Parameters: manager - [IN] preprocessing manager                           *
+ *             client  - [IN] IPC client                                      *
+ *             message - [IN] the statistics request containing the number of *
+ *                            most expensive items to send                    *
+ *                                                                            *
+ ******************************************************************************/
+static void	preprocessor_send_stats(zbx_preprocessing_manager_t *manager, zbx_ipc_client_t *client,
+		const zbx_ipc_message_t *message)
+{
+	zbx_preproc_stats_t		stats;
+	zbx_hashset_iter_t		iter;
+	zbx_preproc_item_stats_t	*item;
+	unsigned char			*data;
+	zbx_uint32_t			size;
+	int				i, items_num;
+
+	memcpy(&items_num, message->data, sizeof(int));
+
+	stats.queue = manager->queue_stats;
+	memcpy(stats.steps, manager->step_stats, sizeof(stats.steps));
+	stats.time = manager->time_now - manager->time_start;
+
+	zbx_vector_ptr_create(&stats.workers);
+	zbx_vector_ptr_create(&stats.items);
+
+	for (i = 0; i < manager->worker_count; i++)
+		zbx_vector_ptr_append(&stats.workers, &manager->workers[i].stats);
+
+	if (0 < items_num)
+	{
+		zbx_hashset_iter_reset(&manager->item_stats, &iter);
+		while (NULL != (item = (zbx_preproc_item_stats_t *)zbx_hashset_iter_next(&iter)))
+			zbx_vector_ptr_append(&stats.items, item);
+
+		zbx_vector_ptr_sort(&stats.items, preprocessor_compare_item_stats_time);
+
+		while (items_num < stats.items.values_num)
+			zbx_vector_ptr_remove_noorder(&stats.items, stats.items.values_num - 1);
+	}
+
+	size = zbx_preprocessor_pack_stats(&data, &stats);
+	zbx_ipc_client_send(client, message->code, data, size);
+	zbx_free(data);
+
+	zbx_vector_ptr_destroy(&stats.items);
+	zbx_vector_ptr_destroy(&stats.workers);
+}
+
 /******************************************************************************
  *                                                                            *
  * Function: preprocessor_init_manager                                        *
@@ -1094,15 +1579,25 @@ static void	preprocessor_flush_test_result(zbx_preprocessing_manager_t *manager,
  * Purpose: initializes preprocessing manager                                 *
  *                                                                            *
  * Parameters: manager - [IN] the manager to initialize                       *
+ *             shard   - [IN] the manager shard index (0 based)               *
  *                                                                            *
  ******************************************************************************/
-static void	preprocessor_init_manager(zbx_preprocessing_manager_t *manager)
+static void	preprocessor_init_manager(zbx_preprocessing_manager_t *manager, int shard)
 {
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s() workers: %d", __func__, CONFIG_PREPROCESSOR_FORKS);
+	int	worker_max;
+
+	/* workers are distributed between manager shards in turn, see preprocessing_worker_thread() */
+	worker_max = CONFIG_PREPROCESSOR_FORKS / CONFIG_PREPROCMAN_FORKS;
+
+	if (shard < CONFIG_PREPROCESSOR_FORKS % CONFIG_PREPROCMAN_FORKS)
+		worker_max++;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() shard: %d workers: %d", __func__, shard, worker_max);
 
 	memset(manager, 0, sizeof(zbx_preprocessing_manager_t));
 
-	manager->workers = (zbx_preprocessing_worker_t *)zbx_calloc(NULL, CONFIG_PREPROCESSOR_FORKS,
+	manager->worker_max = worker_max;
+	manager->workers = (zbx_preprocessing_worker_t *)zbx_calloc(NULL, worker_max,
 			sizeof(zbx_preprocessing_worker_t));
 	zbx_list_create(&manager->queue);
 	zbx_list_create(&manager->direct_queue);
@@ -1112,6 +1607,9 @@ static void	preprocessor_init_manager(zbx_preprocessing_manager_t *manager)
 	zbx_hashset_create(&manager->linked_items, 0, ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
 	zbx_hashset_create(&manager->history_cache, 1000, ZBX_DEFAULT_UINT64_HASH_FUNC,
 			ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	zbx_hashset_create(&manager->item_stats, 100, ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+	manager->time_start = manager->time_now = zbx_time();
 
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
@@ -1132,10 +1630,13 @@ static void preprocessor_register_worker(zbx_preprocessing_manager_t *manager, z
 {
 	zbx_preprocessing_worker_t	*worker = NULL;
 	pid_t				ppid;
+	int				process_num;
+	const unsigned char		*ptr = message->data;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
-	memcpy(&ppid, message->data, sizeof(ppid));
+	ptr += zbx_deserialize_value(ptr, &ppid);
+	(void)zbx_deserialize_value(ptr, &process_num);
 
 	if (ppid != getppid())
 	{
@@ -1144,7 +1645,7 @@ static void preprocessor_register_worker(zbx_preprocessing_manager_t *manager, z
 	}
 	else
 	{
-		if (CONFIG_PREPROCESSOR_FORKS == manager->worker_count)
+		if (manager->worker_max == manager->worker_count)
 		{
 			THIS_SHOULD_NEVER_HAPPEN;
 			exit(EXIT_FAILURE);
@@ -1153,6 +1654,9 @@ static void preprocessor_register_worker(zbx_preprocessing_manager_t *manager, z
 		worker = (zbx_preprocessing_worker_t *)&manager->workers[manager->worker_count++];
 		worker->client = client;
 
+		/* report worker in statistics before it has sent any */
+		worker->stats.process_num = process_num;
+
 		preprocessor_assign_tasks(manager);
 	}
 
@@ -1189,12 +1693,13 @@ static void	preprocessor_destroy_manager(zbx_preprocessing_manager_t *manager)
 	zbx_hashset_destroy(&manager->item_config);
 	zbx_hashset_destroy(&manager->linked_items);
 	zbx_hashset_destroy(&manager->history_cache);
+	zbx_hashset_destroy(&manager->item_stats);
 }
 
 ZBX_THREAD_ENTRY(preprocessing_manager_thread, args)
 {
 	zbx_ipc_service_t		service;
-	char				*error = NULL;
+	char				*error = NULL, service_name[ZBX_IPC_SERVICE_PREPROCESSING_LEN];
 	zbx_ipc_client_t		*client;
 	zbx_ipc_message_t		*message;
 	zbx_preprocessing_manager_t	manager;
@@ -1213,14 +1718,17 @@ ZBX_THREAD_ENTRY(preprocessing_manager_thread, args)
 	zabbix_log(LOG_LEVEL_INFORMATION, "%s #%d started [%s #%d]", get_program_type_string(program_type),
 			server_num, get_process_type_string(process_type), process_num);
 
-	if (FAIL == zbx_ipc_service_start(&service, ZBX_IPC_SERVICE_PREPROCESSING, &error))
+	/* each manager shard has its own service, values are routed to shards by itemid */
+	zbx_preprocessor_get_service_name(process_num - 1, service_name, sizeof(service_name));
+
+	if (FAIL == zbx_ipc_service_start(&service, service_name, &error))
 	{
 		zabbix_log(LOG_LEVEL_CRIT, "cannot start preprocessing service: %s", error);
 		zbx_free(error);
 		exit(EXIT_FAILURE);
 	}
 
-	preprocessor_init_manager(&manager);
+	preprocessor_init_manager(&manager, process_num - 1);
 
 	/* initialize statistics */
 	time_stat = zbx_time();
@@ -1249,7 +1757,7 @@ ZBX_THREAD_ENTRY(preprocessing_manager_thread, args)
 		update_selfmon_counter(ZBX_PROCESS_STATE_IDLE);
 		ret = zbx_ipc_service_recv(&service, ZBX_PREPROCESSING_MANAGER_DELAY, &client, &message);
 		update_selfmon_counter(ZBX_PROCESS_STATE_BUSY);
-		sec = zbx_time();
+		manager.time_now = sec = zbx_time();
 		zbx_update_env(sec);
 
 		if (ZBX_IPC_RECV_IMMEDIATE != ret)
@@ -1268,6 +1776,10 @@ ZBX_THREAD_ENTRY(preprocessing_manager_thread, args)
 				case ZBX_IPC_PREPROCESSOR_RESULT:
 					preprocessor_add_result(&manager, client, message);
 					break;
+				case ZBX_IPC_PREPROCESSOR_DEP_RESULT:
+				case ZBX_IPC_PREPROCESSOR_BATCH_RESULT:
+					preprocessor_add_batch_result(&manager, client, message);
+					break;
 				case ZBX_IPC_PREPROCESSOR_QUEUE:
 					zbx_ipc_client_send(client, message->code, (unsigned char *)&manager.queued_num,
 							sizeof(zbx_uint64_t));
@@ -1278,6 +1790,12 @@ ZBX_THREAD_ENTRY(preprocessing_manager_thread, args)
 				case ZBX_IPC_PREPROCESSOR_TEST_RESULT:
 					preprocessor_flush_test_result(&manager, client, message);
 					break;
+				case ZBX_IPC_PREPROCESSOR_WORKER_STATS:
+					preprocessor_add_worker_stats(&manager, client, message);
+					break;
+				case ZBX_IPC_PREPROCESSOR_STATS:
+					preprocessor_send_stats(&manager, client, message);
+					break;
 			}
 
 			zbx_ipc_message_free(message);
@@ -32,12 +32,33 @@
 #include "preproc_history.h"
 
 extern unsigned char	process_type, program_type;
-extern int		server_num, process_num;
+extern int		server_num, process_num, CONFIG_PREPROCMAN_FORKS;
 
 #define ZBX_PREPROC_VALUE_PREVIEW_LEN		100
 
+/* period of logging javascript preprocessing script statistics */
+#define ZBX_PREPROC_SCRIPT_STATS_PERIOD		SEC_PER_HOUR
+
+/* period of sending preprocessing statistics to manager */
+#define ZBX_PREPROC_STATS_FLUSH_PERIOD		5
+
+/* items with lower total preprocessing time during statistics period are not reported to manager */
+#define ZBX_PREPROC_STATS_ITEM_TIME_MIN		0.001
+
+/* preprocessing statistics collected since the last flush to manager */
+typedef struct
+{
+	zbx_preproc_worker_stats_t	worker;
+	zbx_preproc_time_stats_t	steps[ZBX_PREPROC_TYPE_MAX];
+	zbx_hashset_t			items;
+	double				time_flush;
+}
+zbx_preproc_worker_data_t;
+
 zbx_es_t	es_engine;
 
+static zbx_preproc_worker_data_t	worker_data;
+
 /******************************************************************************
  *                                                                            *
  * Function: worker_format_value                                              *
@@ -203,6 +224,8 @@ static void	worker_format_error(const zbx_variant_t *value, zbx_preproc_result_t
  *             steps_num     - [IN] the number of preprocessing steps         *
  *             history_in    - [IN] the preprocessing history                 *
  *             history_out   - [OUT] the new preprocessing history            *
+ *             jp_value      - [IN] the parsed value (can be NULL)            *
+ *             prom_value    - [IN] the parsed Prometheus value (can be NULL) *
  *             results       - [OUT] the preprocessing step results           *
  *             results_num   - [OUT] the number of step results               *
  *             error         - [OUT] error message                            *
@@ -210,12 +233,20 @@ static void	worker_format_error(const zbx_variant_t *value, zbx_preproc_result_t
  * Return value: SUCCEED - the preprocessing steps finished successfully      *
  *               FAIL - otherwise, error contains the error message           *
  *                                                                            *
+ * Comments: The parsed values are used only by the first step if it is       *
+ *           JSONPath or Prometheus pattern, the following steps work with    *
+ *           the step results.                                                *
+ *           The execution time of steps is collected in worker statistics by *
+ *           step type.                                                       *
+ *                                                                            *
  ******************************************************************************/
 static int	worker_item_preproc_execute(unsigned char value_type, zbx_variant_t *value, const zbx_timespec_t *ts,
 		zbx_preproc_op_t *steps, int steps_num, zbx_vector_ptr_t *history_in, zbx_vector_ptr_t *history_out,
-		zbx_preproc_result_t *results, int *results_num, char **error)
+		const struct zbx_json_parse *jp_value, zbx_prometheus_t *prom_value, zbx_preproc_result_t *results,
+		int *results_num, char **error)
 {
 	int		i, ret = SUCCEED;
+	double		time_start;
 
 	for (i = 0; i < steps_num; i++)
 	{
@@ -225,7 +256,19 @@ static int	worker_item_preproc_execute(unsigned char value_type, zbx_variant_t *
 
 		zbx_preproc_history_pop_value(history_in, i, &history_value, &history_ts);
 
-		if (FAIL == (ret = zbx_item_preproc(value_type, value, ts, op, &history_value, &history_ts, error)))
+		time_start = zbx_time();
+
+		if (0 == i && NULL != jp_value && ZBX_PREPROC_JSONPATH == op->type)
+			ret = zbx_item_preproc_jsonpath(value, jp_value, op, error);
+		else if (0 == i && NULL != prom_value && ZBX_PREPROC_PROMETHEUS_PATTERN == op->type)
+			ret = zbx_item_preproc_prometheus_pattern(value, prom_value, op, error);
+		else
+			ret = zbx_item_preproc(value_type, value, ts, op, &history_value, &history_ts, error);
+
+		if (ZBX_PREPROC_TYPE_MAX > op->type)
+			zbx_preproc_time_stats_add(&worker_data.steps[op->type], zbx_time() - time_start);
+
+		if (FAIL == ret)
 		{
 			results[i].action = op->error_handler;
 			ret = zbx_item_preproc_handle_error(value, op, error);
@@ -275,39 +318,64 @@ static int	worker_item_preproc_execute(unsigned char value_type, zbx_variant_t *
 
 /******************************************************************************
  *                                                                            *
- * Function: worker_preprocess_value                                          *
+ * Function: worker_preprocess                                                *
  *                                                                            *
- * Purpose: handle item value preprocessing task                              *
+ * Purpose: preprocess item value and append the result to IPC message        *
  *                                                                            *
- * Parameters: socket  - [IN] IPC socket                                      *
- *             message - [IN] packed preprocessing task                       *
+ * Parameters: itemid     - [IN] the item identifier                          *
+ *             value_type - [IN] the item value type                          *
+ *             value      - [IN] the value to process, cleared afterwards     *
+ *             ts         - [IN] the value timestamp                          *
+ *             steps      - [IN] the preprocessing steps to execute           *
+ *             steps_num  - [IN] the number of preprocessing steps            *
+ *             history_in - [IN] the preprocessing history                    *
+ *             jp_value   - [IN] the parsed value (can be NULL)               *
+ *             prom_value - [IN] the parsed Prometheus value (can be NULL)    *
+ *             result     - [IN/OUT] the IPC message with packed results      *
  *                                                                            *
  ******************************************************************************/
-static void	worker_preprocess_value(zbx_ipc_socket_t *socket, zbx_ipc_message_t *message)
+static void	worker_preprocess(zbx_uint64_t itemid, unsigned char value_type, zbx_variant_t *value,
+		const zbx_timespec_t *ts, zbx_preproc_op_t *steps, int steps_num, zbx_vector_ptr_t *history_in,
+		const struct zbx_json_parse *jp_value, zbx_prometheus_t *prom_value, zbx_ipc_message_t *result)
 {
-	zbx_uint32_t		size = 0;
-	unsigned char		*data = NULL, value_type;
-	zbx_uint64_t		itemid;
-	zbx_variant_t		value, value_start;
-	int			i, steps_num, results_num, ret;
-	char			*errmsg = NULL, *error = NULL;
-	zbx_timespec_t		*ts;
-	zbx_preproc_op_t	*steps;
-	zbx_vector_ptr_t	history_in, history_out;
-	zbx_preproc_result_t	*results;
+	zbx_variant_t			value_start;
+	int				i, results_num, ret;
+	char				*errmsg = NULL, *error = NULL;
+	zbx_vector_ptr_t		history_out;
+	zbx_preproc_result_t		*results;
+	zbx_preproc_item_stats_t	*item, item_local;
+	double				time_start, time_exec;
 
-	zbx_vector_ptr_create(&history_in);
 	zbx_vector_ptr_create(&history_out);
 
-	zbx_preprocessor_unpack_task(&itemid, &value_type, &ts, &value, &history_in, &steps, &steps_num,
-			message->data);
-
-	zbx_variant_copy(&value_start, &value);
+	zbx_variant_copy(&value_start, value);
 	results = (zbx_preproc_result_t *)zbx_malloc(NULL, sizeof(zbx_preproc_result_t) * steps_num);
 	memset(results, 0, sizeof(zbx_preproc_result_t) * steps_num);
 
-	if (FAIL == (ret = worker_item_preproc_execute(value_type, &value, ts, steps, steps_num, &history_in,
-			&history_out, results, &results_num, &errmsg)) && 0 != results_num)
+	time_start = zbx_time();
+
+	ret = worker_item_preproc_execute(value_type, value, ts, steps, steps_num, history_in, &history_out, jp_value,
+			prom_value, results, &results_num, &errmsg);
+
+	time_exec = zbx_time() - time_start;
+
+	if (NULL == (item = (zbx_preproc_item_stats_t *)zbx_hashset_search(&worker_data.items, &itemid)))
+	{
+		memset(&item_local, 0, sizeof(item_local));
+		item_local.itemid = itemid;
+		item = (zbx_preproc_item_stats_t *)zbx_hashset_insert(&worker_data.items, &item_local,
+				sizeof(item_local));
+	}
+
+	item->count++;
+	item->time += time_exec;
+
+	if (item->time_max < time_exec)
+		item->time_max = time_exec;
+
+	worker_data.worker.values_num++;
+
+	if (FAIL == ret && 0 != results_num)
 	{
 		int action = results[results_num - 1].action;
 
@@ -322,37 +390,206 @@ static void	worker_preprocess_value(zbx_ipc_socket_t *socket, zbx_ipc_message_t
 
 	if (SUCCEED == ZBX_CHECK_LOG_LEVEL(LOG_LEVEL_DEBUG))
 	{
-		const char	*result;
+		const char	*result_desc;
 
-		result = (SUCCEED == ret ? zbx_variant_value_desc(&value) : error);
+		result_desc = (SUCCEED == ret ? zbx_variant_value_desc(value) : error);
 		zabbix_log(LOG_LEVEL_DEBUG, "%s(): %s", __func__, zbx_variant_value_desc(&value_start));
-		zabbix_log(LOG_LEVEL_DEBUG, "%s: %s %s",__func__,  zbx_result_string(ret), result);
+		zabbix_log(LOG_LEVEL_DEBUG, "%s: %s %s",__func__,  zbx_result_string(ret), result_desc);
 	}
 
-	size = zbx_preprocessor_pack_result(&data, &value, &history_out, error);
-	zbx_variant_clear(&value);
+	zbx_preprocessor_pack_result(result, value, &history_out, error);
+	zbx_variant_clear(value);
 	zbx_free(error);
+
+	zbx_variant_clear(&value_start);
+
+	for (i = 0; i < results_num; i++)
+		zbx_variant_clear(&results[i].value);
+	zbx_free(results);
+
+	zbx_vector_ptr_clear_ext(&history_out, (zbx_clean_func_t)zbx_preproc_op_history_free);
+	zbx_vector_ptr_destroy(&history_out);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: worker_preprocess_value                                          *
+ *                                                                            *
+ * Purpose: handle item value preprocessing task                              *
+ *                                                                            *
+ * Parameters: socket  - [IN] IPC socket                                      *
+ *             message - [IN] packed preprocessing task                       *
+ *                                                                            *
+ ******************************************************************************/
+static void	worker_preprocess_value(zbx_ipc_socket_t *socket, zbx_ipc_message_t *message)
+{
+	unsigned char		value_type;
+	zbx_uint64_t		itemid;
+	zbx_variant_t		value;
+	int			steps_num;
+	zbx_timespec_t		*ts;
+	zbx_preproc_op_t	*steps;
+	zbx_vector_ptr_t	history_in;
+	zbx_ipc_message_t	result;
+
+	zbx_vector_ptr_create(&history_in);
+	zbx_ipc_message_init(&result);
+
+	zbx_preprocessor_unpack_task(&itemid, &value_type, &ts, &value, &history_in, &steps, &steps_num,
+			message->data);
+
+	worker_preprocess(itemid, value_type, &value, ts, steps, steps_num, &history_in, NULL, NULL, &result);
+
 	zbx_free(ts);
 	zbx_free(steps);
 
-	if (FAIL == zbx_ipc_socket_write(socket, ZBX_IPC_PREPROCESSOR_RESULT, data, size))
+	if (FAIL == zbx_ipc_socket_write(socket, ZBX_IPC_PREPROCESSOR_RESULT, result.data, result.size))
 	{
 		zabbix_log(LOG_LEVEL_CRIT, "cannot send preprocessing result");
 		exit(EXIT_FAILURE);
 	}
 
-	zbx_free(data);
+	zbx_ipc_message_clean(&result);
 
-	zbx_variant_clear(&value_start);
+	zbx_vector_ptr_clear_ext(&history_in, (zbx_clean_func_t)zbx_preproc_op_history_free);
+	zbx_vector_ptr_destroy(&history_in);
+}
 
-	for (i = 0; i < results_num; i++)
-		zbx_variant_clear(&results[i].value);
-	zbx_free(results);
+/******************************************************************************
+ *                                                                            *
+ * Function: worker_preprocess_batch                                          *
+ *                                                                            *
+ * Purpose: handle batch of item value preprocessing tasks                    *
+ *                                                                            *
+ * Parameters: socket  - [IN] IPC socket                                      *
+ *             message - [IN] packed preprocessing tasks                      *
+ *                                                                            *
+ * Comments: The results are sent back in one message in the same order as    *
+ *           the tasks were packed.                                           *
+ *                                                                            *
+ ******************************************************************************/
+static void	worker_preprocess_batch(zbx_ipc_socket_t *socket, zbx_ipc_message_t *message)
+{
+	zbx_uint32_t		offset = 0;
+	unsigned char		value_type;
+	zbx_uint64_t		itemid;
+	zbx_variant_t		value;
+	int			steps_num, values_num = 0;
+	zbx_timespec_t		*ts;
+	zbx_preproc_op_t	*steps;
+	zbx_vector_ptr_t	history_in;
+	zbx_ipc_message_t	result;
 
-	zbx_vector_ptr_clear_ext(&history_out, (zbx_clean_func_t)zbx_preproc_op_history_free);
-	zbx_vector_ptr_destroy(&history_out);
+	zbx_vector_ptr_create(&history_in);
+	zbx_ipc_message_init(&result);
+
+	while (offset < message->size)
+	{
+		offset += zbx_preprocessor_unpack_task(&itemid, &value_type, &ts, &value, &history_in, &steps,
+				&steps_num, message->data + offset);
+
+		worker_preprocess(itemid, value_type, &value, ts, steps, steps_num, &history_in, NULL, NULL, &result);
+
+		zbx_free(ts);
+		zbx_free(steps);
+		zbx_vector_ptr_clear_ext(&history_in, (zbx_clean_func_t)zbx_preproc_op_history_free);
+		values_num++;
+	}
+
+	zabbix_log(LOG_LEVEL_DEBUG, "%s() preprocessed %d values", __func__, values_num);
+
+	if (FAIL == zbx_ipc_socket_write(socket, ZBX_IPC_PREPROCESSOR_BATCH_RESULT, result.data, result.size))
+	{
+		zabbix_log(LOG_LEVEL_CRIT, "cannot send preprocessing result");
+		exit(EXIT_FAILURE);
+	}
+
+	zbx_ipc_message_clean(&result);
+	zbx_vector_ptr_destroy(&history_in);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: worker_preprocess_dep_values                                     *
+ *                                                                            *
+ * Purpose: handle dependent item value preprocessing task                    *
+ *                                                                            *
+ * Parameters: socket  - [IN] IPC socket                                      *
+ *             message - [IN] packed dependent item preprocessing task        *
+ *                                                                            *
+ * Comments: The task contains master item value followed by dependent items  *
+ *           sharing it. The value is parsed as JSON at most once and the     *
+ *           leading JSONPath steps of all dependent items are executed on    *
+ *           the same parsed value. In the same way the value is parsed and   *
+ *           indexed as Prometheus data when the second dependent item with   *
+ *           leading Prometheus pattern step is found - building the index    *
+ *           costs more than a single pattern lookup in the unparsed value.   *
+ *                                                                            *
+ ******************************************************************************/
+static void	worker_preprocess_dep_values(zbx_ipc_socket_t *socket, zbx_ipc_message_t *message)
+{
+	zbx_uint32_t		offset;
+	unsigned char		value_type;
+	zbx_uint64_t		itemid;
+	zbx_variant_t		value_master, value;
+	int			steps_num, deps_num = 0, prom_num = 0, json_parsed = FAIL, prom_parsed = FAIL;
+	zbx_timespec_t		*ts;
+	zbx_preproc_op_t	*steps;
+	zbx_vector_ptr_t	history_in;
+	zbx_ipc_message_t	result;
+	struct zbx_json_parse	jp_master;
+	zbx_prometheus_t	prom_master;
+	char			*error = NULL;
+
+	zbx_vector_ptr_create(&history_in);
+	zbx_ipc_message_init(&result);
+
+	offset = zbx_preprocessor_unpack_dep_request(&ts, &value_master, message->data);
+
+	if (ZBX_VARIANT_STR == value_master.type)
+		json_parsed = zbx_json_open(value_master.data.str, &jp_master);
+
+	while (offset < message->size)
+	{
+		offset += zbx_preprocessor_unpack_dep_request_item(&itemid, &value_type, &history_in, &steps,
+				&steps_num, message->data + offset);
+
+		if (0 != steps_num && ZBX_PREPROC_PROMETHEUS_PATTERN == steps[0].type &&
+				ZBX_VARIANT_STR == value_master.type && 2 == ++prom_num)
+		{
+			/* data that cannot be parsed is processed by each dependent item to get its own error */
+			if (FAIL == (prom_parsed = zbx_prometheus_init(&prom_master, value_master.data.str, &error)))
+			{
+				zabbix_log(LOG_LEVEL_DEBUG, "cannot parse Prometheus data: %s", error);
+				zbx_free(error);
+			}
+		}
+
+		zbx_variant_copy(&value, &value_master);
+		worker_preprocess(itemid, value_type, &value, ts, steps, steps_num, &history_in,
+				(SUCCEED == json_parsed ? &jp_master : NULL), (SUCCEED == prom_parsed ? &prom_master : NULL),
+				&result);
+
+		zbx_free(steps);
+		zbx_vector_ptr_clear_ext(&history_in, (zbx_clean_func_t)zbx_preproc_op_history_free);
+		deps_num++;
+	}
+
+	zabbix_log(LOG_LEVEL_DEBUG, "%s() preprocessed %d dependent item values", __func__, deps_num);
+
+	if (FAIL == zbx_ipc_socket_write(socket, ZBX_IPC_PREPROCESSOR_DEP_RESULT, result.data, result.size))
+	{
+		zabbix_log(LOG_LEVEL_CRIT, "cannot send preprocessing result");
+		exit(EXIT_FAILURE);
+	}
+
+	if (SUCCEED == prom_parsed)
+		zbx_prometheus_clear(&prom_master);
+
+	zbx_ipc_message_clean(&result);
+	zbx_variant_clear(&value_master);
+	zbx_free(ts);
 
-	zbx_vector_ptr_clear_ext(&history_in, (zbx_clean_func_t)zbx_preproc_op_history_free);
 	zbx_vector_ptr_destroy(&history_in);
 }
 
@@ -422,12 +659,63 @@ static void	worker_test_value(zbx_ipc_socket_t *socket, zbx_ipc_message_t *messa
 	zbx_vector_ptr_destroy(&history_in);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: worker_flush_stats                                               *
+ *                                                                            *
+ * Purpose: send preprocessing statistics collected since the last flush to   *
+ *          preprocessing manager                                             *
+ *                                                                            *
+ * Parameters: socket   - [IN] IPC socket                                     *
+ *             time_now - [IN] the current time                               *
+ *                                                                            *
+ * Comments: Only items with noticeable preprocessing time are reported to    *
+ *           keep the statistics of cheap items from growing manager memory.  *
+ *                                                                            *
+ ******************************************************************************/
+static void	worker_flush_stats(zbx_ipc_socket_t *socket, double time_now)
+{
+	zbx_vector_ptr_t		items;
+	zbx_hashset_iter_t		iter;
+	zbx_preproc_item_stats_t	*item;
+	unsigned char			*data;
+	zbx_uint32_t			size;
+
+	zbx_vector_ptr_create(&items);
+
+	zbx_hashset_iter_reset(&worker_data.items, &iter);
+	while (NULL != (item = (zbx_preproc_item_stats_t *)zbx_hashset_iter_next(&iter)))
+	{
+		if (ZBX_PREPROC_STATS_ITEM_TIME_MIN <= item->time)
+			zbx_vector_ptr_append(&items, item);
+	}
+
+	size = zbx_preprocessor_pack_worker_stats(&data, &worker_data.worker, worker_data.steps, &items);
+
+	if (FAIL == zbx_ipc_socket_write(socket, ZBX_IPC_PREPROCESSOR_WORKER_STATS, data, size))
+	{
+		zabbix_log(LOG_LEVEL_CRIT, "cannot send preprocessing statistics");
+		exit(EXIT_FAILURE);
+	}
+
+	zbx_free(data);
+	zbx_vector_ptr_destroy(&items);
+
+	zbx_hashset_clear(&worker_data.items);
+	memset(worker_data.steps, 0, sizeof(worker_data.steps));
+	worker_data.worker.values_num = 0;
+	worker_data.time_flush = time_now;
+}
+
 ZBX_THREAD_ENTRY(preprocessing_worker_thread, args)
 {
 	pid_t			ppid;
-	char			*error = NULL;
+	char			*error = NULL, service[ZBX_IPC_SERVICE_PREPROCESSING_LEN];
+	unsigned char		data[sizeof(pid_t) + sizeof(int)], *ptr;
 	zbx_ipc_socket_t	socket;
 	zbx_ipc_message_t	message;
+	double			time_now, time_stats;
+	int			ret, timeout;
 
 	process_type = ((zbx_thread_args_t *)args)->process_type;
 	server_num = ((zbx_thread_args_t *)args)->server_num;
@@ -437,17 +725,28 @@ ZBX_THREAD_ENTRY(preprocessing_worker_thread, args)
 
 	zbx_es_init(&es_engine);
 
+	memset(&worker_data, 0, sizeof(worker_data));
+	worker_data.worker.process_num = process_num;
+	zbx_hashset_create(&worker_data.items, 100, ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
 	zbx_ipc_message_init(&message);
 
-	if (FAIL == zbx_ipc_socket_open(&socket, ZBX_IPC_SERVICE_PREPROCESSING, SEC_PER_MIN, &error))
+	/* workers are distributed between preprocessing manager shards in turn */
+	zbx_preprocessor_get_service_name((process_num - 1) % CONFIG_PREPROCMAN_FORKS, service, sizeof(service));
+
+	if (FAIL == zbx_ipc_socket_open(&socket, service, SEC_PER_MIN, &error))
 	{
 		zabbix_log(LOG_LEVEL_CRIT, "cannot connect to preprocessing service: %s", error);
 		zbx_free(error);
 		exit(EXIT_FAILURE);
 	}
 
+	/* worker registers with parent process identifier and its process number for statistics */
 	ppid = getppid();
-	zbx_ipc_socket_write(&socket, ZBX_IPC_PREPROCESSOR_WORKER, (unsigned char *)&ppid, sizeof(ppid));
+	ptr = data;
+	ptr += zbx_serialize_value(ptr, ppid);
+	(void)zbx_serialize_value(ptr, process_num);
+	zbx_ipc_socket_write(&socket, ZBX_IPC_PREPROCESSOR_WORKER, data, sizeof(data));
 
 	zabbix_log(LOG_LEVEL_INFORMATION, "%s #%d started [%s #%d]", get_program_type_string(program_type),
 			server_num, get_process_type_string(process_type), process_num);
@@ -456,10 +755,31 @@ ZBX_THREAD_ENTRY(preprocessing_worker_thread, args)
 
 	update_selfmon_counter(ZBX_PROCESS_STATE_BUSY);
 
+	worker_data.time_flush = time_stats = zbx_time();
+
 	while (ZBX_IS_RUNNING())
 	{
 		update_selfmon_counter(ZBX_PROCESS_STATE_IDLE);
 
+		/* flush the collected statistics if worker stays idle until the next flush time */
+		if (0 != worker_data.worker.values_num)
+		{
+			timeout = ZBX_PREPROC_STATS_FLUSH_PERIOD - (int)(zbx_time() - worker_data.time_flush);
+
+			if (FAIL == (ret = zbx_ipc_socket_wait(&socket, MAX(timeout, 0))))
+			{
+				zabbix_log(LOG_LEVEL_CRIT, "cannot read preprocessing service request");
+				exit(EXIT_FAILURE);
+			}
+
+			if (TIMEOUT_ERROR == ret)
+			{
+				update_selfmon_counter(ZBX_PROCESS_STATE_BUSY);
+				worker_flush_stats(&socket, zbx_time());
+				continue;
+			}
+		}
+
 		if (SUCCEED != zbx_ipc_socket_read(&socket, &message))
 		{
 			zabbix_log(LOG_LEVEL_CRIT, "cannot read preprocessing service request");
@@ -467,19 +787,35 @@ ZBX_THREAD_ENTRY(preprocessing_worker_thread, args)
 		}
 
 		update_selfmon_counter(ZBX_PROCESS_STATE_BUSY);
-		zbx_update_env(zbx_time());
+		time_now = zbx_time();
+		zbx_update_env(time_now);
+
+		if (ZBX_PREPROC_SCRIPT_STATS_PERIOD <= time_now - time_stats)
+		{
+			zbx_es_log_stats(&es_engine);
+			time_stats = time_now;
+		}
 
 		switch (message.code)
 		{
 			case ZBX_IPC_PREPROCESSOR_REQUEST:
 				worker_preprocess_value(&socket, &message);
 				break;
+			case ZBX_IPC_PREPROCESSOR_DEP_REQUEST:
+				worker_preprocess_dep_values(&socket, &message);
+				break;
+			case ZBX_IPC_PREPROCESSOR_BATCH_REQUEST:
+				worker_preprocess_batch(&socket, &message);
+				break;
 			case ZBX_IPC_PREPROCESSOR_TEST_REQUEST:
 				worker_test_value(&socket, &message);
 				break;
 		}
 
 		zbx_ipc_message_clean(&message);
+
+		if (ZBX_PREPROC_STATS_FLUSH_PERIOD <= time_now - worker_data.time_flush)
+			worker_flush_stats(&socket, time_now);
 	}
 
 	zbx_setproctitle("%s #%d [terminated]", get_process_type_string(process_type), process_num);
@@ -23,6 +23,7 @@
 #include "zbxserver.h"
 #include "zbxserialize.h"
 #include "zbxipcservice.h"
+#include "memalloc.h"
 
 #include "preproc.h"
 #include "preprocessing.h"
@@ -30,8 +31,14 @@
 
 #define PACKED_FIELD_RAW	0
 #define PACKED_FIELD_STRING	1
+#define PACKED_FIELD_SHARED	2
 #define MAX_VALUES_LOCAL	256
 
+/* string length marker of a value passed through preprocessing cache */
+#define ZBX_PREPROC_SHARED_MARKER	0xffffffff
+/* minimum size of a value to be passed through preprocessing cache */
+#define ZBX_PREPROC_SHARED_SIZE_MIN	(4 * ZBX_KIBIBYTE)
+
 /* packed field data description */
 typedef struct
 {
@@ -44,8 +51,154 @@ zbx_packed_field_t;
 #define PACKED_FIELD(value, size)	\
 		(zbx_packed_field_t){(value), (size), (0 == (size) ? PACKED_FIELD_STRING : PACKED_FIELD_RAW)};
 
-static zbx_ipc_message_t	cached_message;
-static int			cached_values;
+/* string value that is passed through preprocessing cache if it is large enough */
+#define PACKED_FIELD_VALUE(value)	\
+		(zbx_packed_field_t){(value), 0, PACKED_FIELD_SHARED};
+
+extern int		CONFIG_PREPROCMAN_FORKS;
+extern zbx_uint64_t	CONFIG_PREPROCESSING_CACHE_SIZE;
+
+/* connection and value batch of a preprocessing manager shard */
+typedef struct
+{
+	zbx_ipc_socket_t	socket;
+	zbx_ipc_message_t	cached_message;
+	int			cached_values;
+}
+zbx_preprocessor_shard_t;
+
+static zbx_preprocessor_shard_t	*shards = NULL;
+
+/* shared memory used to pass large values between processes without copying them through sockets */
+static zbx_mem_info_t	*preproc_mem = NULL;
+static zbx_mutex_t	preproc_lock = ZBX_MUTEX_NULL;
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_preprocessor_init_cache                                      *
+ *                                                                            *
+ * Purpose: create preprocessing cache used to pass large item values between *
+ *          processes                                                         *
+ *                                                                            *
+ * Parameters: error - [OUT] the error message                                *
+ *                                                                            *
+ * Return value: SUCCEED - the cache was created or is disabled               *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_preprocessor_init_cache(char **error)
+{
+	if (0 == CONFIG_PREPROCESSING_CACHE_SIZE)
+		return SUCCEED;
+
+	if (SUCCEED != zbx_mutex_create(&preproc_lock, ZBX_MUTEX_PREPROCESSING, error))
+		return FAIL;
+
+	return zbx_mem_create(&preproc_mem, CONFIG_PREPROCESSING_CACHE_SIZE, "preprocessing cache",
+			"PreprocessingCacheSize", 1, error);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_preprocessor_destroy_cache                                   *
+ *                                                                            *
+ * Purpose: destroy preprocessing cache                                       *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_preprocessor_destroy_cache(void)
+{
+	if (NULL != preproc_mem)
+	{
+		zbx_mutex_destroy(&preproc_lock);
+		preproc_mem = NULL;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: preprocessor_cache_put                                           *
+ *                                                                            *
+ * Purpose: copy value into preprocessing cache                               *
+ *                                                                            *
+ * Parameters: value - [IN] the value                                         *
+ *             size  - [IN] the value size including terminating zero         *
+ *                                                                            *
+ * Return value: the value copy in preprocessing cache or NULL if the cache   *
+ *               is disabled or full                                          *
+ *                                                                            *
+ ******************************************************************************/
+static void	*preprocessor_cache_put(const void *value, zbx_uint32_t size)
+{
+	void	*ptr;
+
+	if (NULL == preproc_mem || ZBX_PREPROC_SHARED_SIZE_MIN > size)
+		return NULL;
+
+	zbx_mutex_lock(preproc_lock);
+	ptr = zbx_mem_malloc(preproc_mem, NULL, size);
+	zbx_mutex_unlock(preproc_lock);
+
+	if (NULL != ptr)
+		memcpy(ptr, value, size);
+
+	return ptr;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: preprocessor_cache_take                                          *
+ *                                                                            *
+ * Purpose: move value from preprocessing cache to local memory               *
+ *                                                                            *
+ * Parameters: ptr - [IN] the value in preprocessing cache                    *
+ *                                                                            *
+ * Return value: the value copy in local memory                               *
+ *                                                                            *
+ ******************************************************************************/
+static char	*preprocessor_cache_take(char *ptr)
+{
+	char	*value;
+
+	value = zbx_strdup(NULL, ptr);
+
+	zbx_mutex_lock(preproc_lock);
+	zbx_mem_free(preproc_mem, ptr);
+	zbx_mutex_unlock(preproc_lock);
+
+	return value;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: preprocessor_deserialize_value                                   *
+ *                                                                            *
+ * Purpose: deserialize string value packed either inline or as a reference   *
+ *          to preprocessing cache                                            *
+ *                                                                            *
+ * Parameters: data  - [IN] the serialized data                               *
+ *             value - [OUT] the value                                        *
+ *                                                                            *
+ * Return value: The number of bytes parsed.                                  *
+ *                                                                            *
+ * Comments: The value is removed from preprocessing cache, so every packed   *
+ *           shared value must be unpacked exactly once.                      *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_uint32_t	preprocessor_deserialize_value(const unsigned char *data, char **value)
+{
+	zbx_uint32_t	value_len;
+	char		*ptr;
+
+	memcpy(&value_len, data, sizeof(zbx_uint32_t));
+
+	if (ZBX_PREPROC_SHARED_MARKER != value_len)
+		return zbx_deserialize_str(data, value, value_len);
+
+	memcpy(&ptr, data + sizeof(zbx_uint32_t), sizeof(ptr));
+	*value = preprocessor_cache_take(ptr);
+
+	return sizeof(zbx_uint32_t) + sizeof(ptr);
+}
 
 /******************************************************************************
  *                                                                            *
@@ -64,8 +217,9 @@ static int			cached_values;
 static zbx_uint32_t	message_pack_data(zbx_ipc_message_t *message, zbx_packed_field_t *fields, int count)
 {
 	int 		i;
-	zbx_uint32_t	field_size, data_size = 0;
+	zbx_uint32_t	field_size, data_size = 0, marker = ZBX_PREPROC_SHARED_MARKER;
 	unsigned char	*offset = NULL;
+	void		*ptr;
 
 	if (NULL != message)
 	{
@@ -89,6 +243,13 @@ static zbx_uint32_t	message_pack_data(zbx_ipc_message_t *message, zbx_packed_fie
 					memcpy(offset + sizeof(zbx_uint32_t), fields[i].value, field_size);
 				field_size += sizeof(zbx_uint32_t);
 			}
+			else if (PACKED_FIELD_SHARED == fields[i].type)
+			{
+				/* shared value is packed as marker followed by its location in preprocessing cache */
+				memcpy(offset, &marker, sizeof(zbx_uint32_t));
+				memcpy(offset + sizeof(zbx_uint32_t), &fields[i].value, field_size);
+				field_size += sizeof(zbx_uint32_t);
+			}
 			else
 				memcpy(offset, fields[i].value, field_size);
 
@@ -97,9 +258,22 @@ static zbx_uint32_t	message_pack_data(zbx_ipc_message_t *message, zbx_packed_fie
 		else
 		{
 			/* size calculation */
-			if (PACKED_FIELD_STRING == fields[i].type)
+			if (PACKED_FIELD_RAW != fields[i].type)
 			{
 				field_size = (NULL != fields[i].value) ? strlen((const char *)fields[i].value) + 1 : 0;
+
+				/* large values are copied to preprocessing cache during size calculation */
+				if (PACKED_FIELD_SHARED == fields[i].type)
+				{
+					if (NULL != (ptr = preprocessor_cache_put(fields[i].value, field_size)))
+					{
+						fields[i].value = ptr;
+						field_size = sizeof(ptr);
+					}
+					else
+						fields[i].type = PACKED_FIELD_STRING;
+				}
+
 				fields[i].size = field_size;
 				field_size += sizeof(zbx_uint32_t);
 			}
@@ -152,8 +326,8 @@ static zbx_uint32_t	preprocessor_pack_value(zbx_ipc_message_t *message, zbx_prep
 		*offset++ = PACKED_FIELD(&value->result->lastlogsize, sizeof(zbx_uint64_t));
 		*offset++ = PACKED_FIELD(&value->result->ui64, sizeof(zbx_uint64_t));
 		*offset++ = PACKED_FIELD(&value->result->dbl, sizeof(double));
-		*offset++ = PACKED_FIELD(value->result->str, 0);
-		*offset++ = PACKED_FIELD(value->result->text, 0);
+		*offset++ = PACKED_FIELD_VALUE(value->result->str);
+		*offset++ = PACKED_FIELD_VALUE(value->result->text);
 		*offset++ = PACKED_FIELD(value->result->msg, 0);
 		*offset++ = PACKED_FIELD(&value->result->type, sizeof(int));
 		*offset++ = PACKED_FIELD(&value->result->mtime, sizeof(int));
@@ -162,7 +336,7 @@ static zbx_uint32_t	preprocessor_pack_value(zbx_ipc_message_t *message, zbx_prep
 		*offset++ = PACKED_FIELD(&log_marker, sizeof(unsigned char));
 		if (NULL != value->result->log)
 		{
-			*offset++ = PACKED_FIELD(value->result->log->value, 0);
+			*offset++ = PACKED_FIELD_VALUE(value->result->log->value);
 			*offset++ = PACKED_FIELD(value->result->log->source, 0);
 			*offset++ = PACKED_FIELD(&value->result->log->timestamp, sizeof(int));
 			*offset++ = PACKED_FIELD(&value->result->log->severity, sizeof(int));
@@ -216,6 +390,33 @@ static int	preprocessor_pack_variant(zbx_packed_field_t *fields, const zbx_varia
 	return offset;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: preprocessor_pack_shared_variant                                 *
+ *                                                                            *
+ * Purpose: packs variant value for serialization, passing large string       *
+ *          values through preprocessing cache                                *
+ *                                                                            *
+ * Parameters: fields - [OUT] the packed fields                               *
+ *             value  - [IN] the value to pack                                *
+ *                                                                            *
+ * Return value: The number of fields used.                                   *
+ *                                                                            *
+ * Comments: Use only for messages that are always unpacked by the receiver.  *
+ *                                                                            *
+ ******************************************************************************/
+static int	preprocessor_pack_shared_variant(zbx_packed_field_t *fields, const zbx_variant_t *value)
+{
+	int	fields_num;
+
+	fields_num = preprocessor_pack_variant(fields, value);
+
+	if (ZBX_VARIANT_STR == value->type)
+		fields[fields_num - 1].type = PACKED_FIELD_SHARED;
+
+	return fields_num;
+}
+
 /******************************************************************************
  *                                                                            *
  * Function: preprocessor_pack_history                                        *
@@ -333,7 +534,7 @@ static int	preprocesser_unpack_variant(const unsigned char *data, zbx_variant_t
 			break;
 
 		case ZBX_VARIANT_STR:
-			offset += zbx_deserialize_str(offset, &value->data.str, value_len);
+			offset += preprocessor_deserialize_value(offset, &value->data.str);
 			break;
 
 		case ZBX_VARIANT_BIN:
@@ -445,10 +646,10 @@ static int	preprocessor_unpack_steps(const unsigned char *data, zbx_preproc_op_t
  *                                                                            *
  * Function: zbx_preprocessor_pack_task                                       *
  *                                                                            *
- * Purpose: pack preprocessing task data into a single buffer that can be     *
- *          used in IPC                                                       *
+ * Purpose: pack preprocessing task data into IPC message                     *
  *                                                                            *
- * Parameters: data          - [OUT] memory buffer for packed data            *
+ * Parameters: message       - [IN/OUT] IPC message, the data is appended to  *
+ *                                      it                                    *
  *             itemid        - [IN] item id                                   *
  *             value_type    - [IN] item value type                           *
  *             ts            - [IN] value timestamp                           *
@@ -459,16 +660,18 @@ static int	preprocessor_unpack_steps(const unsigned char *data, zbx_preproc_op_t
  *                                                                            *
  * Return value: size of packed data                                          *
  *                                                                            *
+ * Comments: Batch task values are appended one after another, the results    *
+ *           are returned in the same order.                                  *
+ *                                                                            *
  ******************************************************************************/
-zbx_uint32_t	zbx_preprocessor_pack_task(unsigned char **data, zbx_uint64_t itemid, unsigned char value_type,
-		zbx_timespec_t *ts, zbx_variant_t *value, const zbx_vector_ptr_t *history,
+zbx_uint32_t	zbx_preprocessor_pack_task(zbx_ipc_message_t *message, zbx_uint64_t itemid,
+		unsigned char value_type, zbx_timespec_t *ts, zbx_variant_t *value, const zbx_vector_ptr_t *history,
 		const zbx_preproc_op_t *steps, int steps_num)
 {
 	zbx_packed_field_t	*offset, *fields;
 	unsigned char		ts_marker;
 	zbx_uint32_t		size;
 	int			history_num;
-	zbx_ipc_message_t	message;
 
 	history_num = (NULL != history ? history->values_num : 0);
 
@@ -489,13 +692,11 @@ zbx_uint32_t	zbx_preprocessor_pack_task(unsigned char **data, zbx_uint64_t itemi
 		*offset++ = PACKED_FIELD(&ts->ns, sizeof(int));
 	}
 
-	offset += preprocessor_pack_variant(offset, value);
+	offset += preprocessor_pack_shared_variant(offset, value);
 	offset += preprocessor_pack_history(offset, history, &history_num);
 	offset += preprocessor_pack_steps(offset, steps, &steps_num);
 
-	zbx_ipc_message_init(&message);
-	size = message_pack_data(&message, fields, offset - fields);
-	*data = message.data;
+	size = message_pack_data(message, fields, offset - fields);
 	zbx_free(fields);
 
 	return size;
@@ -505,23 +706,24 @@ zbx_uint32_t	zbx_preprocessor_pack_task(unsigned char **data, zbx_uint64_t itemi
  *                                                                            *
  * Function: zbx_preprocessor_pack_result                                     *
  *                                                                            *
- * Purpose: pack preprocessing result data into a single buffer that can be   *
- *          used in IPC                                                       *
+ * Purpose: pack preprocessing result data into IPC message                   *
  *                                                                            *
- * Parameters: data          - [OUT] memory buffer for packed data            *
- *             value         - [IN] result value                              *
- *             history       - [IN] item history data                         *
- *             error         - [IN] preprocessing error                       *
+ * Parameters: message - [IN/OUT] IPC message, the data is appended to it     *
+ *             value   - [IN] result value                                    *
+ *             history - [IN] item history data                               *
+ *             error   - [IN] preprocessing error                             *
  *                                                                            *
  * Return value: size of packed data                                          *
  *                                                                            *
+ * Comments: Dependent item preprocessing results are appended in the same    *
+ *           order as the dependent items were packed in the task.            *
+ *                                                                            *
  ******************************************************************************/
-zbx_uint32_t	zbx_preprocessor_pack_result(unsigned char **data, zbx_variant_t *value,
-		const zbx_vector_ptr_t *history, char *error)
+zbx_uint32_t	zbx_preprocessor_pack_result(zbx_ipc_message_t *message, const zbx_variant_t *value,
+		const zbx_vector_ptr_t *history, const char *error)
 {
 	zbx_packed_field_t	*offset, *fields;
 	zbx_uint32_t		size;
-	zbx_ipc_message_t	message;
 	int			history_num;
 
 	history_num = history->values_num;
@@ -530,15 +732,12 @@ zbx_uint32_t	zbx_preprocessor_pack_result(unsigned char **data, zbx_variant_t *v
 	fields = (zbx_packed_field_t *)zbx_malloc(NULL, (4 + history_num * 5) * sizeof(zbx_packed_field_t));
 	offset = fields;
 
-	offset += preprocessor_pack_variant(offset, value);
+	offset += preprocessor_pack_shared_variant(offset, value);
 	offset += preprocessor_pack_history(offset, history, &history_num);
 
 	*offset++ = PACKED_FIELD(error, 0);
 
-	zbx_ipc_message_init(&message);
-	size = message_pack_data(&message, fields, offset - fields);
-	*data = message.data;
-
+	size = message_pack_data(message, fields, offset - fields);
 	zbx_free(fields);
 
 	return size;
@@ -642,8 +841,8 @@ zbx_uint32_t	zbx_preprocessor_unpack_value(zbx_preproc_item_value_t *value, unsi
 		offset += zbx_deserialize_uint64(offset, &agent_result->lastlogsize);
 		offset += zbx_deserialize_uint64(offset, &agent_result->ui64);
 		offset += zbx_deserialize_double(offset, &agent_result->dbl);
-		offset += zbx_deserialize_str(offset, &agent_result->str, value_len);
-		offset += zbx_deserialize_str(offset, &agent_result->text, value_len);
+		offset += preprocessor_deserialize_value(offset, &agent_result->str);
+		offset += preprocessor_deserialize_value(offset, &agent_result->text);
 		offset += zbx_deserialize_str(offset, &agent_result->msg, value_len);
 		offset += zbx_deserialize_int(offset, &agent_result->type);
 		offset += zbx_deserialize_int(offset, &agent_result->mtime);
@@ -653,7 +852,7 @@ zbx_uint32_t	zbx_preprocessor_unpack_value(zbx_preproc_item_value_t *value, unsi
 		{
 			log = (zbx_log_t *)zbx_malloc(NULL, sizeof(zbx_log_t));
 
-			offset += zbx_deserialize_str(offset, &log->value, value_len);
+			offset += preprocessor_deserialize_value(offset, &log->value);
 			offset += zbx_deserialize_str(offset, &log->source, value_len);
 			offset += zbx_deserialize_int(offset, &log->timestamp);
 			offset += zbx_deserialize_int(offset, &log->severity);
@@ -683,8 +882,10 @@ zbx_uint32_t	zbx_preprocessor_unpack_value(zbx_preproc_item_value_t *value, unsi
  *             steps_num     - [OUT] preprocessing step count                 *
  *             data          - [IN] IPC data buffer                           *
  *                                                                            *
+ * Return value: size of unpacked data                                        *
+ *                                                                            *
  ******************************************************************************/
-void	zbx_preprocessor_unpack_task(zbx_uint64_t *itemid, unsigned char *value_type, zbx_timespec_t **ts,
+zbx_uint32_t	zbx_preprocessor_unpack_task(zbx_uint64_t *itemid, unsigned char *value_type, zbx_timespec_t **ts,
 		zbx_variant_t *value, zbx_vector_ptr_t *history, zbx_preproc_op_t **steps,
 		int *steps_num, const unsigned char *data)
 {
@@ -708,7 +909,9 @@ void	zbx_preprocessor_unpack_task(zbx_uint64_t *itemid, unsigned char *value_typ
 
 	offset += preprocesser_unpack_variant(offset, value);
 	offset += preprocesser_unpack_history(offset, history);
-	(void)preprocessor_unpack_steps(offset, steps, steps_num);
+	offset += preprocessor_unpack_steps(offset, steps, steps_num);
+
+	return offset - data;
 }
 
 /******************************************************************************
@@ -722,8 +925,10 @@ void	zbx_preprocessor_unpack_task(zbx_uint64_t *itemid, unsigned char *value_typ
  *             error         - [OUT] preprocessing error                      *
  *             data          - [IN] IPC data buffer                           *
  *                                                                            *
+ * Return value: size of unpacked data                                        *
+ *                                                                            *
  ******************************************************************************/
-void	zbx_preprocessor_unpack_result(zbx_variant_t *value, zbx_vector_ptr_t *history, char **error,
+zbx_uint32_t	zbx_preprocessor_unpack_result(zbx_variant_t *value, zbx_vector_ptr_t *history, char **error,
 		const unsigned char *data)
 {
 	zbx_uint32_t		value_len;
@@ -731,8 +936,9 @@ void	zbx_preprocessor_unpack_result(zbx_variant_t *value, zbx_vector_ptr_t *hist
 
 	offset += preprocesser_unpack_variant(offset, value);
 	offset += preprocesser_unpack_history(offset, history);
+	offset += zbx_deserialize_str(offset, error, value_len);
 
-	(void)zbx_deserialize_str(offset, error, value_len);
+	return offset - data;
 }
 
 /******************************************************************************
@@ -772,46 +978,289 @@ void	zbx_preprocessor_unpack_test_result(zbx_vector_ptr_t *results, zbx_vector_p
 
 	(void)zbx_deserialize_str(offset, error, value_len);
 }
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_preprocessor_pack_dep_request                                *
+ *                                                                            *
+ * Purpose: start packing dependent item preprocessing task by appending the  *
+ *          master item value shared by all dependent items                   *
+ *                                                                            *
+ * Parameters: message - [IN/OUT] IPC message                                 *
+ *             ts      - [IN] value timestamp                                 *
+ *             value   - [IN] master item value                               *
+ *                                                                            *
+ * Return value: size of packed data                                          *
+ *                                                                            *
+ * Comments: The dependent items are appended to the message with             *
+ *           zbx_preprocessor_pack_dep_request_item() function.               *
+ *                                                                            *
+ ******************************************************************************/
+zbx_uint32_t	zbx_preprocessor_pack_dep_request(zbx_ipc_message_t *message, const zbx_timespec_t *ts,
+		const zbx_variant_t *value)
+{
+	zbx_packed_field_t	fields[5], *offset = fields;	/* 5 - max field count */
+	unsigned char		ts_marker;
+
+	ts_marker = (NULL != ts);
+
+	*offset++ = PACKED_FIELD(&ts_marker, sizeof(unsigned char));
+
+	if (NULL != ts)
+	{
+		*offset++ = PACKED_FIELD(&ts->sec, sizeof(int));
+		*offset++ = PACKED_FIELD(&ts->ns, sizeof(int));
+	}
+
+	offset += preprocessor_pack_shared_variant(offset, value);
+
+	return message_pack_data(message, fields, offset - fields);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_preprocessor_pack_dep_request_item                           *
+ *                                                                            *
+ * Purpose: append dependent item to dependent item preprocessing task        *
+ *                                                                            *
+ * Parameters: message    - [IN/OUT] IPC message                              *
+ *             itemid     - [IN] item id                                      *
+ *             value_type - [IN] item value type                              *
+ *             history    - [IN] history data (can be NULL)                   *
+ *             steps      - [IN] preprocessing steps                          *
+ *             steps_num  - [IN] preprocessing step count                     *
+ *                                                                            *
+ * Return value: size of packed data                                          *
+ *                                                                            *
+ ******************************************************************************/
+zbx_uint32_t	zbx_preprocessor_pack_dep_request_item(zbx_ipc_message_t *message, zbx_uint64_t itemid,
+		unsigned char value_type, const zbx_vector_ptr_t *history, const zbx_preproc_op_t *steps, int steps_num)
+{
+	zbx_packed_field_t	*offset, *fields;
+	zbx_uint32_t		size;
+	int			history_num;
+
+	history_num = (NULL != history ? history->values_num : 0);
+
+	/* 4 is a max field count (without preprocessing step and history fields) */
+	fields = (zbx_packed_field_t *)zbx_malloc(NULL, (4 + steps_num * 4 + history_num * 5)
+			* sizeof(zbx_packed_field_t));
+	offset = fields;
+
+	*offset++ = PACKED_FIELD(&itemid, sizeof(zbx_uint64_t));
+	*offset++ = PACKED_FIELD(&value_type, sizeof(unsigned char));
+	offset += preprocessor_pack_history(offset, history, &history_num);
+	offset += preprocessor_pack_steps(offset, steps, &steps_num);
+
+	size = message_pack_data(message, fields, offset - fields);
+	zbx_free(fields);
+
+	return size;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_preprocessor_unpack_dep_request                              *
+ *                                                                            *
+ * Purpose: unpack master item value of dependent item preprocessing task     *
+ *                                                                            *
+ * Parameters: ts    - [OUT] value timestamp                                  *
+ *             value - [OUT] master item value                                *
+ *             data  - [IN] IPC data buffer                                   *
+ *                                                                            *
+ * Return value: size of unpacked data                                        *
+ *                                                                            *
+ ******************************************************************************/
+zbx_uint32_t	zbx_preprocessor_unpack_dep_request(zbx_timespec_t **ts, zbx_variant_t *value,
+		const unsigned char *data)
+{
+	const unsigned char	*offset = data;
+	unsigned char		ts_marker;
+	zbx_timespec_t		*timespec = NULL;
+
+	offset += zbx_deserialize_char(offset, &ts_marker);
+
+	if (0 != ts_marker)
+	{
+		timespec = (zbx_timespec_t *)zbx_malloc(NULL, sizeof(zbx_timespec_t));
+
+		offset += zbx_deserialize_int(offset, &timespec->sec);
+		offset += zbx_deserialize_int(offset, &timespec->ns);
+	}
+
+	*ts = timespec;
+
+	offset += preprocesser_unpack_variant(offset, value);
+
+	return offset - data;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_preprocessor_unpack_dep_request_item                         *
+ *                                                                            *
+ * Purpose: unpack dependent item of dependent item preprocessing task        *
+ *                                                                            *
+ * Parameters: itemid     - [OUT] item id                                     *
+ *             value_type - [OUT] item value type                             *
+ *             history    - [OUT] history data                                *
+ *             steps      - [OUT] preprocessing steps                         *
+ *             steps_num  - [OUT] preprocessing step count                    *
+ *             data       - [IN] IPC data buffer                              *
+ *                                                                            *
+ * Return value: size of unpacked data                                        *
+ *                                                                            *
+ * Comments: The step parameters point to the IPC data buffer.                *
+ *                                                                            *
+ ******************************************************************************/
+zbx_uint32_t	zbx_preprocessor_unpack_dep_request_item(zbx_uint64_t *itemid, unsigned char *value_type,
+		zbx_vector_ptr_t *history, zbx_preproc_op_t **steps, int *steps_num, const unsigned char *data)
+{
+	const unsigned char	*offset = data;
+
+	offset += zbx_deserialize_uint64(offset, itemid);
+	offset += zbx_deserialize_char(offset, value_type);
+	offset += preprocesser_unpack_history(offset, history);
+	offset += preprocessor_unpack_steps(offset, steps, steps_num);
+
+	return offset - data;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_preprocessor_get_shard                                       *
+ *                                                                            *
+ * Purpose: get preprocessing manager shard responsible for the item          *
+ *                                                                            *
+ * Parameters: itemid - [IN] the item identifier                              *
+ *                                                                            *
+ * Return value: the shard index (0 based)                                    *
+ *                                                                            *
+ * Comments: Dependent items are preprocessed by the shard of their master    *
+ *           item, so the whole dependent item chain and the value order of   *
+ *           each item is kept within one shard.                              *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_preprocessor_get_shard(zbx_uint64_t itemid)
+{
+	if (1 >= CONFIG_PREPROCMAN_FORKS)
+		return 0;
+
+	return (int)(ZBX_DEFAULT_UINT64_HASH_FUNC(&itemid) % (zbx_hash_t)CONFIG_PREPROCMAN_FORKS);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_preprocessor_get_service_name                                *
+ *                                                                            *
+ * Purpose: get IPC service name of preprocessing manager shard               *
+ *                                                                            *
+ * Parameters: shard    - [IN] the shard index (0 based)                      *
+ *             name     - [OUT] the service name                              *
+ *             name_len - [IN] the size of name buffer                        *
+ *                                                                            *
+ * Comments: The first shard uses the default preprocessing service name, so  *
+ *           processes not aware of sharding (preprocessing tests) connect to *
+ *           it.                                                              *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_preprocessor_get_service_name(int shard, char *name, size_t name_len)
+{
+	if (0 == shard)
+		zbx_strlcpy(name, ZBX_IPC_SERVICE_PREPROCESSING, name_len);
+	else
+		zbx_snprintf(name, name_len, "%s%d", ZBX_IPC_SERVICE_PREPROCESSING, shard + 1);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: preprocessor_get_shard_data                                      *
+ *                                                                            *
+ * Purpose: get process local data of preprocessing manager shard             *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_preprocessor_shard_t	*preprocessor_get_shard_data(int shard)
+{
+	if (NULL == shards)
+	{
+		shards = (zbx_preprocessor_shard_t *)zbx_calloc(NULL, (size_t)MAX(CONFIG_PREPROCMAN_FORKS, 1),
+				sizeof(zbx_preprocessor_shard_t));
+	}
+
+	return &shards[shard];
+}
+
 /******************************************************************************
  *                                                                            *
  * Function: preprocessor_send                                                *
  *                                                                            *
  * Purpose: sends command to preprocessor manager                             *
  *                                                                            *
- * Parameters: code     - [IN] message code                                   *
+ * Parameters: shard    - [IN] preprocessing manager shard                    *
+ *             code     - [IN] message code                                   *
  *             data     - [IN] message data                                   *
  *             size     - [IN] message data size                              *
  *             response - [OUT] response message (can be NULL if response is  *
  *                              not requested)                                *
  *                                                                            *
  ******************************************************************************/
-static void	preprocessor_send(zbx_uint32_t code, unsigned char *data, zbx_uint32_t size,
+static void	preprocessor_send(int shard, zbx_uint32_t code, unsigned char *data, zbx_uint32_t size,
 		zbx_ipc_message_t *response)
 {
-	char			*error = NULL;
-	static zbx_ipc_socket_t	socket = {0};
+	char				*error = NULL, service[ZBX_IPC_SERVICE_PREPROCESSING_LEN];
+	zbx_preprocessor_shard_t	*shard_data;
+
+	shard_data = preprocessor_get_shard_data(shard);
 
-	/* each process has a permanent connection to preprocessing manager */
-	if (0 == socket.fd && FAIL == zbx_ipc_socket_open(&socket, ZBX_IPC_SERVICE_PREPROCESSING, SEC_PER_MIN,
-			&error))
+	/* each process has a permanent connection to every preprocessing manager */
+	if (0 == shard_data->socket.fd)
 	{
-		zabbix_log(LOG_LEVEL_CRIT, "cannot connect to preprocessing service: %s", error);
-		exit(EXIT_FAILURE);
+		zbx_preprocessor_get_service_name(shard, service, sizeof(service));
+
+		if (FAIL == zbx_ipc_socket_open(&shard_data->socket, service, SEC_PER_MIN, &error))
+		{
+			zabbix_log(LOG_LEVEL_CRIT, "cannot connect to preprocessing service: %s", error);
+			exit(EXIT_FAILURE);
+		}
 	}
 
-	if (FAIL == zbx_ipc_socket_write(&socket, code, data, size))
+	if (FAIL == zbx_ipc_socket_write(&shard_data->socket, code, data, size))
 	{
 		zabbix_log(LOG_LEVEL_CRIT, "cannot send data to preprocessing service");
 		exit(EXIT_FAILURE);
 	}
 
-	if (NULL != response && FAIL == zbx_ipc_socket_read(&socket, response))
+	if (NULL != response && FAIL == zbx_ipc_socket_read(&shard_data->socket, response))
 	{
 		zabbix_log(LOG_LEVEL_CRIT, "cannot receive data from preprocessing service");
 		exit(EXIT_FAILURE);
 	}
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: preprocessor_flush_shard                                         *
+ *                                                                            *
+ * Purpose: send cached values to preprocessing manager shard                 *
+ *                                                                            *
+ ******************************************************************************/
+static void	preprocessor_flush_shard(int shard)
+{
+	zbx_preprocessor_shard_t	*shard_data;
+
+	shard_data = preprocessor_get_shard_data(shard);
+
+	if (0 < shard_data->cached_message.size)
+	{
+		preprocessor_send(shard, ZBX_IPC_PREPROCESSOR_REQUEST, shard_data->cached_message.data,
+				shard_data->cached_message.size, NULL);
+
+		zbx_ipc_message_clean(&shard_data->cached_message);
+		zbx_ipc_message_init(&shard_data->cached_message);
+		shard_data->cached_values = 0;
+	}
+}
+
 /******************************************************************************
  *                                                                            *
  * Function: zbx_preprocess_item_value                                        *
@@ -821,6 +1270,12 @@ static void	preprocessor_send(zbx_uint32_t code, unsigned char *data, zbx_uint32
  * Parameters: itemid          - [IN] the itemid                              *
  *             item_value_type - [IN] the item value type                     *
  *             item_flags      - [IN] the item flags (e. g. lld rule)         *
+ *             preprocessing   - [IN] ZBX_ITEM_PREPROCESSING_NONE - the item  *
+ *                               has no preprocessing steps and dependent     *
+ *                               items, value is added to history cache       *
+ *                               directly                                     *
+ *                               ZBX_ITEM_PREPROCESSING_REQUIRED - value is   *
+ *                               sent to preprocessing manager                *
  *             result          - [IN] agent result containing the value       *
  *                               to add                                       *
  *             ts              - [IN] the value timestamp                     *
@@ -830,18 +1285,31 @@ static void	preprocessor_send(zbx_uint32_t code, unsigned char *data, zbx_uint32
  *                                                                            *
  ******************************************************************************/
 void	zbx_preprocess_item_value(zbx_uint64_t itemid, unsigned char item_value_type, unsigned char item_flags,
-		AGENT_RESULT *result, zbx_timespec_t *ts, unsigned char state, char *error)
+		unsigned char preprocessing, AGENT_RESULT *result, zbx_timespec_t *ts, unsigned char state,
+		char *error)
 {
 	zbx_preproc_item_value_t	value = {.itemid = itemid, .item_value_type = item_value_type, .result = result,
 					.error = error, .item_flags = item_flags, .state = state, .ts = ts};
+	zbx_preprocessor_shard_t	*shard_data;
+	int				shard;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
-	preprocessor_pack_value(&cached_message, &value);
+	/* skip the preprocessing manager, the value would be added to history cache as it is anyway */
+	if (ZBX_ITEM_PREPROCESSING_NONE == preprocessing)
+	{
+		dc_add_history(itemid, item_value_type, item_flags, result, ts, state, error);
+		goto out;
+	}
 
-	if (MAX_VALUES_LOCAL < ++cached_values)
-		zbx_preprocessor_flush();
+	shard = zbx_preprocessor_get_shard(itemid);
+	shard_data = preprocessor_get_shard_data(shard);
 
+	preprocessor_pack_value(&shard_data->cached_message, &value);
+
+	if (MAX_VALUES_LOCAL < ++shard_data->cached_values)
+		preprocessor_flush_shard(shard);
+out:
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
 
@@ -849,19 +1317,21 @@ void	zbx_preprocess_item_value(zbx_uint64_t itemid, unsigned char item_value_typ
  *                                                                            *
  * Function: zbx_preprocessor_flush                                           *
  *                                                                            *
- * Purpose: send flush command to preprocessing manager                       *
+ * Purpose: send flush command to preprocessing manager and flush values      *
+ *          added directly to the local history cache                         *
  *                                                                            *
  ******************************************************************************/
 void	zbx_preprocessor_flush(void)
 {
-	if (0 < cached_message.size)
-	{
-		preprocessor_send(ZBX_IPC_PREPROCESSOR_REQUEST, cached_message.data, cached_message.size, NULL);
+	int	shard;
 
-		zbx_ipc_message_clean(&cached_message);
-		zbx_ipc_message_init(&cached_message);
-		cached_values = 0;
-	}
+	dc_flush_history();
+
+	if (NULL == shards)
+		return;
+
+	for (shard = 0; shard < CONFIG_PREPROCMAN_FORKS; shard++)
+		preprocessor_flush_shard(shard);
 }
 
 /******************************************************************************
@@ -875,15 +1345,70 @@ void	zbx_preprocessor_flush(void)
  ******************************************************************************/
 zbx_uint64_t	zbx_preprocessor_get_queue_size(void)
 {
-	zbx_uint64_t		size;
+	zbx_uint64_t		size, total = 0;
 	zbx_ipc_message_t	message;
+	int			shard;
 
-	zbx_ipc_message_init(&message);
-	preprocessor_send(ZBX_IPC_PREPROCESSOR_QUEUE, NULL, 0, &message);
-	memcpy(&size, message.data, sizeof(zbx_uint64_t));
-	zbx_ipc_message_clean(&message);
+	for (shard = 0; shard < CONFIG_PREPROCMAN_FORKS; shard++)
+	{
+		zbx_ipc_message_init(&message);
+		preprocessor_send(shard, ZBX_IPC_PREPROCESSOR_QUEUE, NULL, 0, &message);
+		memcpy(&size, message.data, sizeof(zbx_uint64_t));
+		zbx_ipc_message_clean(&message);
 
-	return size;
+		total += size;
+	}
+
+	return total;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_preprocessor_get_stats                                       *
+ *                                                                            *
+ * Purpose: get preprocessing statistics from all preprocessing manager       *
+ *          shards                                                            *
+ *                                                                            *
+ * Parameters: stats     - [OUT] the preprocessing statistics                 *
+ *             items_num - [IN] the number of most expensive items to return  *
+ *                              from each shard, 0 - none                     *
+ *                                                                            *
+ * Comments: The returned statistics must be released with                    *
+ *           zbx_preprocessor_clear_stats() function.                         *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_preprocessor_get_stats(zbx_preproc_stats_t *stats, int items_num)
+{
+	zbx_ipc_message_t	message;
+	int			shard;
+
+	memset(stats, 0, sizeof(zbx_preproc_stats_t));
+	zbx_vector_ptr_create(&stats->workers);
+	zbx_vector_ptr_create(&stats->items);
+
+	for (shard = 0; shard < CONFIG_PREPROCMAN_FORKS; shard++)
+	{
+		zbx_ipc_message_init(&message);
+		preprocessor_send(shard, ZBX_IPC_PREPROCESSOR_STATS, (unsigned char *)&items_num, sizeof(int),
+				&message);
+		zbx_preprocessor_unpack_stats(stats, message.data);
+		zbx_ipc_message_clean(&message);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_preprocessor_clear_stats                                     *
+ *                                                                            *
+ * Purpose: release preprocessing statistics                                  *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_preprocessor_clear_stats(zbx_preproc_stats_t *stats)
+{
+	zbx_vector_ptr_clear_ext(&stats->workers, zbx_ptr_free);
+	zbx_vector_ptr_destroy(&stats->workers);
+	zbx_vector_ptr_clear_ext(&stats->items, zbx_ptr_free);
+	zbx_vector_ptr_destroy(&stats->items);
 }
 
 /******************************************************************************
@@ -914,6 +1439,247 @@ void	zbx_preproc_result_free(zbx_preproc_result_t *result)
 	zbx_free(result);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_preproc_type_string                                          *
+ *                                                                            *
+ * Purpose: get preprocessing step type name used in statistics               *
+ *                                                                            *
+ * Parameters: type - [IN] the preprocessing step type                        *
+ *                                                                            *
+ * Return value: the step type name or NULL for unknown step types            *
+ *                                                                            *
+ ******************************************************************************/
+const char	*zbx_preproc_type_string(unsigned char type)
+{
+	static const char	*types[ZBX_PREPROC_TYPE_MAX] = {NULL, "multiplier", "rtrim", "ltrim", "trim", "regsub",
+			"bool2dec", "oct2dec", "hex2dec", "delta_value", "delta_speed", "xpath", "jsonpath",
+			"validate_range", "validate_regex", "validate_not_regex", "error_field_json",
+			"error_field_xml", "error_field_regex", "throttle_value", "throttle_timed_value", "javascript",
+			"prometheus_pattern", "prometheus_to_json", "csv_to_json"};
+
+	if (ZBX_PREPROC_TYPE_MAX <= type)
+		return NULL;
+
+	return types[type];
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_preproc_time_stats_add                                       *
+ *                                                                            *
+ * Purpose: add duration to preprocessing time statistics                     *
+ *                                                                            *
+ * Parameters: stats    - [IN/OUT] the time statistics                        *
+ *             duration - [IN] the duration in seconds                        *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_preproc_time_stats_add(zbx_preproc_time_stats_t *stats, double duration)
+{
+	int	i;
+	double	limit = 0.000001;
+
+	for (i = 0; i < ZBX_PREPROC_TIME_BUCKETS - 1 && duration >= limit; i++)
+		limit *= 2;
+
+	stats->buckets[i]++;
+	stats->count++;
+	stats->time += duration;
+
+	if (stats->time_max < duration)
+		stats->time_max = duration;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_preproc_time_stats_merge                                     *
+ *                                                                            *
+ * Purpose: add preprocessing time statistics to other statistics             *
+ *                                                                            *
+ * Parameters: dst - [IN/OUT] the target time statistics                      *
+ *             src - [IN] the time statistics to add                          *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_preproc_time_stats_merge(zbx_preproc_time_stats_t *dst, const zbx_preproc_time_stats_t *src)
+{
+	int	i;
+
+	for (i = 0; i < ZBX_PREPROC_TIME_BUCKETS; i++)
+		dst->buckets[i] += src->buckets[i];
+
+	dst->count += src->count;
+	dst->time += src->time;
+
+	if (dst->time_max < src->time_max)
+		dst->time_max = src->time_max;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_preprocessor_pack_worker_stats                               *
+ *                                                                            *
+ * Purpose: pack preprocessing worker statistics into a single buffer that    *
+ *          can be used in IPC                                                *
+ *                                                                            *
+ * Parameters: data   - [OUT] memory buffer for packed data                   *
+ *             worker - [IN] the worker statistics                            *
+ *             steps  - [IN] the step execution time statistics by step type  *
+ *             items  - [IN] the item statistics                              *
+ *                                                                            *
+ * Return value: size of packed data                                          *
+ *                                                                            *
+ ******************************************************************************/
+zbx_uint32_t	zbx_preprocessor_pack_worker_stats(unsigned char **data, const zbx_preproc_worker_stats_t *worker,
+		const zbx_preproc_time_stats_t *steps, const zbx_vector_ptr_t *items)
+{
+	zbx_uint32_t	size, steps_size = sizeof(zbx_preproc_time_stats_t) * ZBX_PREPROC_TYPE_MAX;
+	unsigned char	*ptr;
+	int		i;
+
+	size = sizeof(zbx_preproc_worker_stats_t) + steps_size + sizeof(int) +
+			sizeof(zbx_preproc_item_stats_t) * items->values_num;
+
+	ptr = *data = (unsigned char *)zbx_malloc(NULL, size);
+
+	ptr += zbx_serialize_value(ptr, *worker);
+	memcpy(ptr, steps, steps_size);
+	ptr += steps_size;
+	ptr += zbx_serialize_value(ptr, items->values_num);
+
+	for (i = 0; i < items->values_num; i++)
+		ptr += zbx_serialize_value(ptr, *(zbx_preproc_item_stats_t *)items->values[i]);
+
+	return size;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_preprocessor_unpack_worker_stats                             *
+ *                                                                            *
+ * Purpose: unpack preprocessing worker statistics from IPC data buffer       *
+ *                                                                            *
+ * Parameters: worker - [OUT] the worker statistics                           *
+ *             steps  - [OUT] the step execution time statistics by step type *
+ *             items  - [OUT] the item statistics                             *
+ *             data   - [IN] IPC data buffer                                  *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_preprocessor_unpack_worker_stats(zbx_preproc_worker_stats_t *worker, zbx_preproc_time_stats_t *steps,
+		zbx_vector_ptr_t *items, const unsigned char *data)
+{
+	zbx_uint32_t			steps_size = sizeof(zbx_preproc_time_stats_t) * ZBX_PREPROC_TYPE_MAX;
+	int				i, items_num;
+	zbx_preproc_item_stats_t	*item;
+
+	data += zbx_deserialize_value(data, worker);
+	memcpy(steps, data, steps_size);
+	data += steps_size;
+	data += zbx_deserialize_value(data, &items_num);
+
+	zbx_vector_ptr_reserve(items, (size_t)(items->values_num + items_num));
+
+	for (i = 0; i < items_num; i++)
+	{
+		item = (zbx_preproc_item_stats_t *)zbx_malloc(NULL, sizeof(zbx_preproc_item_stats_t));
+		data += zbx_deserialize_value(data, item);
+		zbx_vector_ptr_append(items, item);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_preprocessor_pack_stats                                      *
+ *                                                                            *
+ * Purpose: pack preprocessing manager statistics into a single buffer that   *
+ *          can be used in IPC                                                *
+ *                                                                            *
+ * Parameters: data  - [OUT] memory buffer for packed data                    *
+ *             stats - [IN] the preprocessing statistics                      *
+ *                                                                            *
+ * Return value: size of packed data                                          *
+ *                                                                            *
+ ******************************************************************************/
+zbx_uint32_t	zbx_preprocessor_pack_stats(unsigned char **data, const zbx_preproc_stats_t *stats)
+{
+	zbx_uint32_t	size;
+	unsigned char	*ptr;
+	int		i;
+
+	size = sizeof(stats->queue) + sizeof(stats->steps) + sizeof(stats->time) + sizeof(int) * 2 +
+			sizeof(zbx_preproc_worker_stats_t) * stats->workers.values_num +
+			sizeof(zbx_preproc_item_stats_t) * stats->items.values_num;
+
+	ptr = *data = (unsigned char *)zbx_malloc(NULL, size);
+
+	ptr += zbx_serialize_value(ptr, stats->queue);
+	ptr += zbx_serialize_value(ptr, stats->steps);
+	ptr += zbx_serialize_value(ptr, stats->time);
+
+	ptr += zbx_serialize_value(ptr, stats->workers.values_num);
+	for (i = 0; i < stats->workers.values_num; i++)
+		ptr += zbx_serialize_value(ptr, *(zbx_preproc_worker_stats_t *)stats->workers.values[i]);
+
+	ptr += zbx_serialize_value(ptr, stats->items.values_num);
+	for (i = 0; i < stats->items.values_num; i++)
+		ptr += zbx_serialize_value(ptr, *(zbx_preproc_item_stats_t *)stats->items.values[i]);
+
+	return size;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_preprocessor_unpack_stats                                    *
+ *                                                                            *
+ * Purpose: unpack preprocessing manager statistics from IPC data buffer      *
+ *                                                                            *
+ * Parameters: stats - [IN/OUT] the preprocessing statistics                  *
+ *             data  - [IN] IPC data buffer                                   *
+ *                                                                            *
+ * Comments: The unpacked statistics are added to the existing statistics,    *
+ *           so the statistics of all manager shards can be combined.         *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_preprocessor_unpack_stats(zbx_preproc_stats_t *stats, const unsigned char *data)
+{
+	zbx_preproc_time_stats_t	time_stats, steps[ZBX_PREPROC_TYPE_MAX];
+	zbx_preproc_worker_stats_t	*worker;
+	zbx_preproc_item_stats_t	*item;
+	double				stats_time;
+	int				i, num;
+
+	data += zbx_deserialize_value(data, &time_stats);
+	zbx_preproc_time_stats_merge(&stats->queue, &time_stats);
+
+	memcpy(steps, data, sizeof(steps));
+	data += sizeof(steps);
+
+	for (i = 0; i < ZBX_PREPROC_TYPE_MAX; i++)
+		zbx_preproc_time_stats_merge(&stats->steps[i], &steps[i]);
+
+	data += zbx_deserialize_value(data, &stats_time);
+
+	if (stats->time < stats_time)
+		stats->time = stats_time;
+
+	data += zbx_deserialize_value(data, &num);
+
+	for (i = 0; i < num; i++)
+	{
+		worker = (zbx_preproc_worker_stats_t *)zbx_malloc(NULL, sizeof(zbx_preproc_worker_stats_t));
+		data += zbx_deserialize_value(data, worker);
+		zbx_vector_ptr_append(&stats->workers, worker);
+	}
+
+	data += zbx_deserialize_value(data, &num);
+
+	for (i = 0; i < num; i++)
+	{
+		item = (zbx_preproc_item_stats_t *)zbx_malloc(NULL, sizeof(zbx_preproc_item_stats_t));
+		data += zbx_deserialize_value(data, item);
+		zbx_vector_ptr_append(&stats->items, item);
+	}
+}
+
 /******************************************************************************
  *                                                                            *
  * Function: preprocessor_pack_test_request                                   *
@@ -25,8 +25,10 @@
 #include "dbcache.h"
 #include "preproc.h"
 #include "zbxalgo.h"
+#include "zbxipcservice.h"
 
 #define ZBX_IPC_SERVICE_PREPROCESSING	"preprocessing"
+#define ZBX_IPC_SERVICE_PREPROCESSING_LEN	64	/* max length of preprocessing manager shard service name */
 
 #define ZBX_IPC_PREPROCESSOR_WORKER		1
 #define ZBX_IPC_PREPROCESSOR_REQUEST		2
@@ -34,6 +36,12 @@
 #define ZBX_IPC_PREPROCESSOR_QUEUE		4
 #define ZBX_IPC_PREPROCESSOR_TEST_REQUEST	5
 #define ZBX_IPC_PREPROCESSOR_TEST_RESULT	6
+#define ZBX_IPC_PREPROCESSOR_DEP_REQUEST	7
+#define ZBX_IPC_PREPROCESSOR_DEP_RESULT		8
+#define ZBX_IPC_PREPROCESSOR_BATCH_REQUEST	9
+#define ZBX_IPC_PREPROCESSOR_BATCH_RESULT	10
+#define ZBX_IPC_PREPROCESSOR_WORKER_STATS	11
+#define ZBX_IPC_PREPROCESSOR_STATS		12
 
 /* item value data used in preprocessing manager */
 typedef struct
@@ -48,19 +56,32 @@ typedef struct
 }
 zbx_preproc_item_value_t;
 
-zbx_uint32_t	zbx_preprocessor_pack_task(unsigned char **data, zbx_uint64_t itemid, unsigned char value_type,
-		zbx_timespec_t *ts, zbx_variant_t *value, const zbx_vector_ptr_t *history,
+int	zbx_preprocessor_get_shard(zbx_uint64_t itemid);
+void	zbx_preprocessor_get_service_name(int shard, char *name, size_t name_len);
+
+zbx_uint32_t	zbx_preprocessor_pack_task(zbx_ipc_message_t *message, zbx_uint64_t itemid,
+		unsigned char value_type, zbx_timespec_t *ts, zbx_variant_t *value, const zbx_vector_ptr_t *history,
 		const zbx_preproc_op_t *steps, int steps_num);
-zbx_uint32_t	zbx_preprocessor_pack_result(unsigned char **data, zbx_variant_t *value,
-		const zbx_vector_ptr_t *history, char *error);
+zbx_uint32_t	zbx_preprocessor_pack_result(zbx_ipc_message_t *message, const zbx_variant_t *value,
+		const zbx_vector_ptr_t *history, const char *error);
 
 zbx_uint32_t	zbx_preprocessor_unpack_value(zbx_preproc_item_value_t *value, unsigned char *data);
-void	zbx_preprocessor_unpack_task(zbx_uint64_t *itemid, unsigned char *value_type, zbx_timespec_t **ts,
+zbx_uint32_t	zbx_preprocessor_unpack_task(zbx_uint64_t *itemid, unsigned char *value_type, zbx_timespec_t **ts,
 		zbx_variant_t *value, zbx_vector_ptr_t *history, zbx_preproc_op_t **steps,
 		int *steps_num, const unsigned char *data);
-void	zbx_preprocessor_unpack_result(zbx_variant_t *value, zbx_vector_ptr_t *history, char **error,
+zbx_uint32_t	zbx_preprocessor_unpack_result(zbx_variant_t *value, zbx_vector_ptr_t *history, char **error,
 		const unsigned char *data);
 
+zbx_uint32_t	zbx_preprocessor_pack_dep_request(zbx_ipc_message_t *message, const zbx_timespec_t *ts,
+		const zbx_variant_t *value);
+zbx_uint32_t	zbx_preprocessor_pack_dep_request_item(zbx_ipc_message_t *message, zbx_uint64_t itemid,
+		unsigned char value_type, const zbx_vector_ptr_t *history, const zbx_preproc_op_t *steps, int steps_num);
+
+zbx_uint32_t	zbx_preprocessor_unpack_dep_request(zbx_timespec_t **ts, zbx_variant_t *value,
+		const unsigned char *data);
+zbx_uint32_t	zbx_preprocessor_unpack_dep_request_item(zbx_uint64_t *itemid, unsigned char *value_type,
+		zbx_vector_ptr_t *history, zbx_preproc_op_t **steps, int *steps_num, const unsigned char *data);
+
 void	zbx_preprocessor_unpack_test_request(unsigned char *value_type, char **value, zbx_timespec_t *ts,
 		zbx_vector_ptr_t *history, zbx_preproc_op_t **steps, int *steps_num, const unsigned char *data);
 
@@ -70,4 +91,12 @@ zbx_uint32_t	zbx_preprocessor_pack_test_result(unsigned char **data, const zbx_p
 void	zbx_preprocessor_unpack_test_result(zbx_vector_ptr_t *results, zbx_vector_ptr_t *history,
 		char **error, const unsigned char *data);
 
+zbx_uint32_t	zbx_preprocessor_pack_worker_stats(unsigned char **data, const zbx_preproc_worker_stats_t *worker,
+		const zbx_preproc_time_stats_t *steps, const zbx_vector_ptr_t *items);
+void	zbx_preprocessor_unpack_worker_stats(zbx_preproc_worker_stats_t *worker, zbx_preproc_time_stats_t *steps,
+		zbx_vector_ptr_t *items, const unsigned char *data);
+
+zbx_uint32_t	zbx_preprocessor_pack_stats(unsigned char **data, const zbx_preproc_stats_t *stats);
+void	zbx_preprocessor_unpack_stats(zbx_preproc_stats_t *stats, const unsigned char *data);
+
 #endif /* ZABBIX_PREPROCESSING_H */
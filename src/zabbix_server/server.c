@@ -68,6 +68,7 @@
 #include "setproctitle.h"
 #include "zbxcrypto.h"
 #include "zbxipcservice.h"
+#include "preproc.h"
 #include "zbxhistory.h"
 #include "postinit.h"
 #include "export.h"
@@ -100,6 +101,9 @@ const char	*help_message[] = {
 	"    Runtime control options:",
 	"      " ZBX_CONFIG_CACHE_RELOAD "        Reload configuration cache",
 	"      " ZBX_HOUSEKEEPER_EXECUTE "        Execute the housekeeper",
+	"      " ZBX_DIAGINFO "=section         Log internal diagnostic information of the",
+	"                                 section (" ZBX_DIAGINFO_VALUECACHE ", " ZBX_DIAGINFO_PREPROCESSING ") or all",
+	"                                 sections if section is not specified",
 	"      " ZBX_LOG_LEVEL_INCREASE "=target  Increase log level, affects all processes if",
 	"                                 target is not specified",
 	"      " ZBX_LOG_LEVEL_DECREASE "=target  Decrease log level, affects all processes if",
@@ -213,8 +217,16 @@ zbx_uint64_t	CONFIG_HISTORY_INDEX_CACHE_SIZE	= 4 * ZBX_MEBIBYTE;
 zbx_uint64_t	CONFIG_TRENDS_CACHE_SIZE	= 4 * ZBX_MEBIBYTE;
 zbx_uint64_t	CONFIG_VALUE_CACHE_SIZE		= 8 * ZBX_MEBIBYTE;
 zbx_uint64_t	CONFIG_VMWARE_CACHE_SIZE	= 8 * ZBX_MEBIBYTE;
+zbx_uint64_t	CONFIG_PREPROCESSING_CACHE_SIZE	= 16 * ZBX_MEBIBYTE;
 zbx_uint64_t	CONFIG_EXPORT_FILE_SIZE		= ZBX_GIBIBYTE;
 
+int	CONFIG_VALUE_CACHE_EVICTION	= ZBX_VC_EVICTION_WEIGHT;
+int	CONFIG_VALUE_CACHE_QUOTA_FLOAT	= 0;
+int	CONFIG_VALUE_CACHE_QUOTA_STR	= 0;
+int	CONFIG_VALUE_CACHE_QUOTA_LOG	= 0;
+int	CONFIG_VALUE_CACHE_QUOTA_UINT64	= 0;
+int	CONFIG_VALUE_CACHE_QUOTA_TEXT	= 0;
+
 int	CONFIG_UNREACHABLE_PERIOD	= 45;
 int	CONFIG_UNREACHABLE_DELAY	= 15;
 int	CONFIG_UNAVAILABLE_DELAY	= 60;
@@ -287,6 +299,9 @@ static char	*CONFIG_SOCKET_PATH	= NULL;
 char	*CONFIG_HISTORY_STORAGE_URL		= NULL;
 char	*CONFIG_HISTORY_STORAGE_OPTS		= NULL;
 int	CONFIG_HISTORY_STORAGE_PIPELINES	= 0;
+int	CONFIG_HISTORY_STORAGE_DRAIN_TIMEOUT	= 0;
+char	*CONFIG_HISTORY_LOCAL_PATH		= NULL;
+int	CONFIG_HISTORY_LOCAL_RETENTION		= 7;
 
 char	*CONFIG_STATS_ALLOWED_IP	= NULL;
 
@@ -559,6 +574,8 @@ static void	zbx_validate_config(ZBX_TASK_EX *task)
 	err |= (FAIL == check_cfg_feature_str("HistoryStorageTypes", CONFIG_HISTORY_STORAGE_OPTS, "cURL library"));
 	err |= (FAIL == check_cfg_feature_int("HistoryStorageDateIndex", CONFIG_HISTORY_STORAGE_PIPELINES,
 			"cURL library"));
+	err |= (FAIL == check_cfg_feature_int("HistoryStorageDrainTimeout", CONFIG_HISTORY_STORAGE_DRAIN_TIMEOUT,
+			"cURL library"));
 #endif
 
 #if !defined(HAVE_LIBXML2) || !defined(HAVE_LIBCURL)
@@ -568,6 +585,20 @@ static void	zbx_validate_config(ZBX_TASK_EX *task)
 	/* because they have non-zero default values */
 #endif
 
+	if (CONFIG_PREPROCMAN_FORKS > CONFIG_PREPROCESSOR_FORKS)
+	{
+		zabbix_log(LOG_LEVEL_CRIT, "\"StartPreprocessingManagers\" configuration parameter must not be"
+				" greater than \"StartPreprocessors\"");
+		err = 1;
+	}
+
+	if (0 != CONFIG_PREPROCESSING_CACHE_SIZE && 128 * ZBX_KIBIBYTE > CONFIG_PREPROCESSING_CACHE_SIZE)
+	{
+		zabbix_log(LOG_LEVEL_CRIT, "\"PreprocessingCacheSize\" configuration parameter must be either 0"
+				" or greater than 128KB");
+		err = 1;
+	}
+
 	if (SUCCEED != zbx_validate_log_parameters(task))
 		err = 1;
 
@@ -646,6 +677,18 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 			PARM_OPT,	128 * ZBX_KIBIBYTE,	__UINT64_C(2) * ZBX_GIBIBYTE},
 		{"ValueCacheSize",		&CONFIG_VALUE_CACHE_SIZE,		TYPE_UINT64,
 			PARM_OPT,	0,			__UINT64_C(64) * ZBX_GIBIBYTE},
+		{"ValueCacheEvictionPolicy",	&CONFIG_VALUE_CACHE_EVICTION,		TYPE_INT,
+			PARM_OPT,	ZBX_VC_EVICTION_WEIGHT,	ZBX_VC_EVICTION_COST},
+		{"ValueCacheQuotaFloat",	&CONFIG_VALUE_CACHE_QUOTA_FLOAT,	TYPE_INT,
+			PARM_OPT,	0,			100},
+		{"ValueCacheQuotaStr",		&CONFIG_VALUE_CACHE_QUOTA_STR,		TYPE_INT,
+			PARM_OPT,	0,			100},
+		{"ValueCacheQuotaLog",		&CONFIG_VALUE_CACHE_QUOTA_LOG,		TYPE_INT,
+			PARM_OPT,	0,			100},
+		{"ValueCacheQuotaUint",		&CONFIG_VALUE_CACHE_QUOTA_UINT64,	TYPE_INT,
+			PARM_OPT,	0,			100},
+		{"ValueCacheQuotaText",		&CONFIG_VALUE_CACHE_QUOTA_TEXT,		TYPE_INT,
+			PARM_OPT,	0,			100},
 		{"CacheUpdateFrequency",	&CONFIG_CONFSYNCER_FREQUENCY,		TYPE_INT,
 			PARM_OPT,	1,			SEC_PER_HOUR},
 		{"HousekeepingFrequency",	&CONFIG_HOUSEKEEPING_FREQUENCY,		TYPE_INT,
@@ -750,12 +793,22 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 			PARM_OPT,	1,			100},
 		{"StartPreprocessors",		&CONFIG_PREPROCESSOR_FORKS,		TYPE_INT,
 			PARM_OPT,	1,			1000},
+		{"StartPreprocessingManagers",	&CONFIG_PREPROCMAN_FORKS,		TYPE_INT,
+			PARM_OPT,	1,			100},
+		{"PreprocessingCacheSize",	&CONFIG_PREPROCESSING_CACHE_SIZE,	TYPE_UINT64,
+			PARM_OPT,	0,			__UINT64_C(64) * ZBX_GIBIBYTE},
 		{"HistoryStorageURL",		&CONFIG_HISTORY_STORAGE_URL,		TYPE_STRING,
 			PARM_OPT,	0,			0},
 		{"HistoryStorageTypes",		&CONFIG_HISTORY_STORAGE_OPTS,		TYPE_STRING_LIST,
 			PARM_OPT,	0,			0},
 		{"HistoryStorageDateIndex",	&CONFIG_HISTORY_STORAGE_PIPELINES,	TYPE_INT,
 			PARM_OPT,	0,			1},
+		{"HistoryStorageDrainTimeout",	&CONFIG_HISTORY_STORAGE_DRAIN_TIMEOUT,	TYPE_INT,
+			PARM_OPT,	0,			SEC_PER_HOUR},
+		{"HistoryStorageLocalPath",	&CONFIG_HISTORY_LOCAL_PATH,		TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"HistoryStorageLocalRetention",	&CONFIG_HISTORY_LOCAL_RETENTION,	TYPE_INT,
+			PARM_OPT,	1,			3650},
 		{"ExportDir",			&CONFIG_EXPORT_DIR,			TYPE_STRING,
 			PARM_OPT,	0,			0},
 		{"ExportFileSize",		&CONFIG_EXPORT_FILE_SIZE,		TYPE_UINT64,
@@ -1027,6 +1080,13 @@ int	MAIN_ZABBIX_ENTRY(int flags)
 		exit(EXIT_FAILURE);
 	}
 
+	if (SUCCEED != zbx_preprocessor_init_cache(&error))
+	{
+		zabbix_log(LOG_LEVEL_CRIT, "cannot initialize preprocessing cache: %s", error);
+		zbx_free(error);
+		exit(EXIT_FAILURE);
+	}
+
 	if (SUCCEED != zbx_vc_init(&error))
 	{
 		zabbix_log(LOG_LEVEL_CRIT, "cannot initialize history value cache: %s", error);
@@ -1281,6 +1341,8 @@ void	zbx_on_exit(int ret)
 	if (0 != CONFIG_VMWARE_FORKS)
 		zbx_vmware_destroy();
 
+	zbx_preprocessor_destroy_cache();
+
 	free_selfmon_collector();
 
 	zbx_uninitialize_events();
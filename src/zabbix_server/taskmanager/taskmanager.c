@@ -27,6 +27,7 @@
 #include "../events.h"
 #include "../actions.h"
 #include "export.h"
+#include "zbxdiag.h"
 #include "taskmanager.h"
 
 #define ZBX_TM_PROCESS_PERIOD		5
@@ -592,6 +593,24 @@ static void	tm_remove_old_tasks(int now)
 	DBcommit();
 }
 
+static volatile unsigned int	diaginfo_flags = 0;
+
+/******************************************************************************
+ *                                                                            *
+ * Function: tm_sigusr_handler                                                *
+ *                                                                            *
+ * Purpose: handle diagnostic information runtime control request            *
+ *                                                                            *
+ ******************************************************************************/
+static void	tm_sigusr_handler(int flags)
+{
+	if (ZBX_RTC_DIAGINFO == ZBX_RTC_GET_MSG(flags))
+	{
+		diaginfo_flags |= (unsigned int)ZBX_RTC_GET_DATA(flags);
+		zbx_wakeup();
+	}
+}
+
 ZBX_THREAD_ENTRY(taskmanager_thread, args)
 {
 	static int	cleanup_time = 0;
@@ -617,10 +636,21 @@ ZBX_THREAD_ENTRY(taskmanager_thread, args)
 
 	zbx_setproctitle("%s [started, idle %d sec]", get_process_type_string(process_type), sleeptime);
 
+	zbx_set_sigusr_handler(tm_sigusr_handler);
+
 	while (ZBX_IS_RUNNING())
 	{
 		zbx_sleep_loop(sleeptime);
 
+		if (0 != diaginfo_flags)
+		{
+			unsigned int	flags = diaginfo_flags;
+
+			diaginfo_flags = 0;
+			zbx_setproctitle("%s [logging diagnostic information]", get_process_type_string(process_type));
+			zbx_diag_log_info(flags);
+		}
+
 		sec1 = zbx_time();
 		zbx_update_env(sec1);
 
@@ -26,6 +26,7 @@ AC_DEFUN([CONF_TESTS],[
 		tests/libs/zbxconf/Makefile
 		tests/libs/zbxdbcache/Makefile
 		tests/libs/zbxdbhigh/Makefile
+		tests/libs/zbxembed/Makefile
 		tests/libs/zbxhistory/Makefile
 		tests/libs/zbxjson/Makefile
 		tests/libs/zbxsysinfo/Makefile
@@ -35,10 +36,12 @@ AC_DEFUN([CONF_TESTS],[
 		tests/libs/zbxalgo/Makefile
 		tests/libs/zbxprometheus/Makefile
 		tests/zabbix_server/Makefile
+		tests/zabbix_server/housekeeper/Makefile
 		tests/zabbix_server/preprocessor/Makefile
 		tests/libs/zbxcomms/Makefile
 		tests/zabbix_server/trapper/Makefile
 		tests/libs/zbxregexp/Makefile
+		tests/libs/zbxserver/Makefile
 		])
 		AC_DEFINE([HAVE_TESTS], [1], ["Define to 1 if tests directory is present"])
 	])
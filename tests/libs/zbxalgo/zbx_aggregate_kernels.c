@@ -0,0 +1,251 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2019 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxalgo.h"
+#include "zbxhistory.h"
+
+/* aggregate results of the value range */
+typedef struct
+{
+	double	sum;
+	double	min;
+	double	max;
+	double	percentile;
+}
+mock_aggregate_t;
+
+static int	mock_percentile_index(int values_num, double percentage)
+{
+	if (0 == percentage)
+		return 0;
+
+	return (int)ceil(values_num * (percentage / 100)) - 1;
+}
+
+static int	mock_record_compare(const void *d1, const void *d2)
+{
+	const zbx_history_record_t	*r1 = (const zbx_history_record_t *)d1;
+	const zbx_history_record_t	*r2 = (const zbx_history_record_t *)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(r1->value.dbl, r2->value.dbl);
+
+	return 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: mock_aggregate_records                                           *
+ *                                                                            *
+ * Purpose: calculate aggregates the way trigger functions did before packed  *
+ *          value arrays - iterating history records and sorting the whole    *
+ *          range for percentile                                              *
+ *                                                                            *
+ ******************************************************************************/
+static void	mock_aggregate_records(zbx_history_record_t *records, int records_num, double percentage,
+		mock_aggregate_t *result)
+{
+	int	i, min = 0, max = 0;
+
+	result->sum = 0;
+
+	for (i = 0; i < records_num; i++)
+		result->sum += records[i].value.dbl;
+
+	for (i = 1; i < records_num; i++)
+	{
+		if (records[i].value.dbl < records[min].value.dbl)
+			min = i;
+	}
+
+	for (i = 1; i < records_num; i++)
+	{
+		if (records[i].value.dbl > records[max].value.dbl)
+			max = i;
+	}
+
+	result->min = records[min].value.dbl;
+	result->max = records[max].value.dbl;
+
+	qsort(records, (size_t)records_num, sizeof(zbx_history_record_t), mock_record_compare);
+	result->percentile = records[mock_percentile_index(records_num, percentage)].value.dbl;
+}
+
+static void	mock_aggregate_dbl(double *values, int values_num, double percentage, mock_aggregate_t *result)
+{
+	result->sum = zbx_dbl_array_sum(values, values_num);
+	result->min = zbx_dbl_array_min(values, values_num);
+	result->max = zbx_dbl_array_max(values, values_num);
+	result->percentile = zbx_dbl_array_select(values, values_num, mock_percentile_index(values_num, percentage));
+}
+
+static void	mock_aggregate_ui64(zbx_uint64_t *values, int values_num, double percentage, mock_aggregate_t *result)
+{
+	result->sum = (double)zbx_ui64_array_sum(values, values_num);
+	result->min = (double)zbx_ui64_array_min(values, values_num);
+	result->max = (double)zbx_ui64_array_max(values, values_num);
+	result->percentile = (double)zbx_ui64_array_select(values, values_num,
+			mock_percentile_index(values_num, percentage));
+
+	zbx_mock_assert_double_eq("sum as double", result->sum, zbx_ui64_array_sum_dbl(values, values_num));
+}
+
+static void	mock_check_aggregate(const char *prefix, const mock_aggregate_t *expected,
+		const mock_aggregate_t *returned)
+{
+	char	msg[64];
+
+	zbx_snprintf(msg, sizeof(msg), "%s sum", prefix);
+	zbx_mock_assert_double_eq(msg, expected->sum, returned->sum);
+	zbx_snprintf(msg, sizeof(msg), "%s min", prefix);
+	zbx_mock_assert_double_eq(msg, expected->min, returned->min);
+	zbx_snprintf(msg, sizeof(msg), "%s max", prefix);
+	zbx_mock_assert_double_eq(msg, expected->max, returned->max);
+	zbx_snprintf(msg, sizeof(msg), "%s percentile", prefix);
+	zbx_mock_assert_double_eq(msg, expected->percentile, returned->percentile);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: mock_benchmark                                                   *
+ *                                                                            *
+ * Purpose: compare history record based and packed array based aggregate    *
+ *          evaluation on generated value range                               *
+ *                                                                            *
+ ******************************************************************************/
+static void	mock_benchmark(int values_num, int iterations, double percentage)
+{
+	zbx_history_record_t	*records, *work_records;
+	double			*values, *work_values, time_start, time_records, time_packed;
+	zbx_uint64_t		seed = 1;
+	mock_aggregate_t	expected, returned;
+	int			i, n;
+
+	records = (zbx_history_record_t *)zbx_malloc(NULL, sizeof(zbx_history_record_t) * values_num);
+	work_records = (zbx_history_record_t *)zbx_malloc(NULL, sizeof(zbx_history_record_t) * values_num);
+	values = (double *)zbx_malloc(NULL, sizeof(double) * values_num);
+	work_values = (double *)zbx_malloc(NULL, sizeof(double) * values_num);
+
+	/* integer values keep the floating point sums exact regardless of summation order */
+	for (i = 0; i < values_num; i++)
+	{
+		seed = seed * __UINT64_C(6364136223846793005) + __UINT64_C(1442695040888963407);
+		records[i].timestamp.sec = i;
+		records[i].timestamp.ns = 0;
+		records[i].value.dbl = values[i] = (double)(seed >> 44);
+	}
+
+	time_start = zbx_time();
+
+	for (n = 0; n < iterations; n++)
+	{
+		memcpy(work_records, records, sizeof(zbx_history_record_t) * values_num);
+		mock_aggregate_records(work_records, values_num, percentage, &expected);
+	}
+
+	time_records = zbx_time() - time_start;
+	time_start = zbx_time();
+
+	for (n = 0; n < iterations; n++)
+	{
+		memcpy(work_values, values, sizeof(double) * values_num);
+		mock_aggregate_dbl(work_values, values_num, percentage, &returned);
+	}
+
+	time_packed = zbx_time() - time_start;
+
+	mock_check_aggregate("benchmark", &expected, &returned);
+
+	printf("\t%d values x %d iterations: history records " ZBX_FS_DBL " sec, packed arrays " ZBX_FS_DBL
+			" sec\n", values_num, iterations, time_records, time_packed);
+
+	zbx_free(work_values);
+	zbx_free(values);
+	zbx_free(work_records);
+	zbx_free(records);
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_mock_handle_t	handle, element;
+	double			percentage;
+	mock_aggregate_t	expected, returned;
+	const char		*str;
+
+	ZBX_UNUSED(state);
+
+	percentage = zbx_mock_get_parameter_float("in.percentage");
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_parameter_exists("in.benchmark"))
+	{
+		mock_benchmark((int)zbx_mock_get_parameter_uint64("in.benchmark.values"),
+				(int)zbx_mock_get_parameter_uint64("in.benchmark.iterations"), percentage);
+		return;
+	}
+
+	expected.sum = zbx_mock_get_parameter_float("out.sum");
+	expected.min = zbx_mock_get_parameter_float("out.min");
+	expected.max = zbx_mock_get_parameter_float("out.max");
+	expected.percentile = zbx_mock_get_parameter_float("out.percentile");
+
+	handle = zbx_mock_get_parameter_handle("in.values");
+
+	if (0 == strcmp(zbx_mock_get_parameter_string("in.type"), "ITEM_VALUE_TYPE_FLOAT"))
+	{
+		zbx_vector_dbl_t	values;
+		double			value;
+
+		zbx_vector_dbl_create(&values);
+
+		while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(handle, &element))
+		{
+			if (ZBX_MOCK_SUCCESS != zbx_mock_string(element, &str) || SUCCEED != is_double(str, &value))
+				fail_msg("invalid float value");
+
+			zbx_vector_dbl_append(&values, value);
+		}
+
+		mock_aggregate_dbl(values.values, values.values_num, percentage, &returned);
+		zbx_vector_dbl_destroy(&values);
+	}
+	else
+	{
+		zbx_vector_uint64_t	values;
+		zbx_uint64_t		value;
+
+		zbx_vector_uint64_create(&values);
+
+		while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(handle, &element))
+		{
+			if (ZBX_MOCK_SUCCESS != zbx_mock_uint64(element, &value))
+				fail_msg("invalid unsigned integer value");
+
+			zbx_vector_uint64_append(&values, value);
+		}
+
+		mock_aggregate_ui64(values.values, values.values_num, percentage, &returned);
+		zbx_vector_uint64_destroy(&values);
+	}
+
+	mock_check_aggregate("packed", &expected, &returned);
+}
@@ -0,0 +1,159 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2019 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxalgo.h"
+
+/* function values in the same format as trigger function results: number, ZBX_UNKNOWN<N> or error */
+static int	mock_function_value(zbx_uint64_t functionid, void *data, double *value, int *unknown_idx,
+		char *error, size_t max_error_len)
+{
+	zbx_mock_handle_t	functions, handle, error_handle;
+	const char		*str;
+
+	ZBX_UNUSED(data);
+
+	functions = zbx_mock_get_parameter_handle("in.functions");
+
+	while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(functions, &handle))
+	{
+		if (functionid != zbx_mock_get_object_member_uint64(handle, "functionid"))
+			continue;
+
+		if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(handle, "error", &error_handle))
+		{
+			if (ZBX_MOCK_SUCCESS != zbx_mock_string(error_handle, &str))
+				fail_msg("invalid function error");
+
+			zbx_strlcpy(error, str, max_error_len);
+			return FAIL;
+		}
+
+		str = zbx_mock_get_object_member_string(handle, "value");
+
+		if (0 == strncmp(str, ZBX_UNKNOWN_STR, ZBX_UNKNOWN_STR_LEN))
+		{
+			*value = ZBX_UNKNOWN;
+			*unknown_idx = atoi(str + ZBX_UNKNOWN_STR_LEN);
+			return SUCCEED;
+		}
+
+		if (SUCCEED != is_double(str, value))
+			return NOTSUPPORTED;
+
+		return SUCCEED;
+	}
+
+	zbx_snprintf(error, max_error_len, "Cannot obtain function and item for functionid: " ZBX_FS_UI64,
+			functionid);
+
+	return FAIL;
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	const char		*expression;
+	unsigned char		*program = NULL;
+	zbx_mock_handle_t	handle, element;
+	zbx_vector_ptr_t	unknown_msgs;
+	zbx_vector_uint64_t	functionids;
+	double			value;
+	char			error[256];
+	int			ret, trigger_value = 0;
+	const char		*str;
+
+	ZBX_UNUSED(state);
+
+	expression = zbx_mock_get_parameter_string("in.expression");
+
+	ret = zbx_expression_compile(expression, &program);
+	zbx_mock_assert_result_eq("zbx_expression_compile() return value",
+			zbx_mock_str_to_return_code(zbx_mock_get_parameter_string("out.compile")), ret);
+
+	if (SUCCEED != ret)
+		goto out;
+
+	zbx_vector_uint64_create(&functionids);
+	zbx_expression_program_functionids(program, &functionids);
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_parameter_exists("out.functionids"))
+	{
+		int	i = 0;
+
+		handle = zbx_mock_get_parameter_handle("out.functionids");
+
+		while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(handle, &element))
+		{
+			zbx_uint64_t	functionid;
+
+			if (ZBX_MOCK_SUCCESS != zbx_mock_uint64(element, &functionid))
+				fail_msg("invalid expected functionid");
+
+			if (i >= functionids.values_num)
+				fail_msg("too few functionids returned");
+
+			zbx_mock_assert_uint64_eq("functionid", functionid, functionids.values[i++]);
+		}
+
+		zbx_mock_assert_int_eq("functionids number", i, functionids.values_num);
+	}
+
+	zbx_vector_uint64_destroy(&functionids);
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_parameter_exists("in.trigger_value"))
+		trigger_value = (int)zbx_mock_get_parameter_uint64("in.trigger_value");
+
+	zbx_vector_ptr_create(&unknown_msgs);
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_parameter_exists("in.unknown"))
+	{
+		handle = zbx_mock_get_parameter_handle("in.unknown");
+
+		while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(handle, &element))
+		{
+			if (ZBX_MOCK_SUCCESS != zbx_mock_string(element, &str))
+				fail_msg("invalid unknown message");
+
+			zbx_vector_ptr_append(&unknown_msgs, zbx_strdup(NULL, str));
+		}
+	}
+
+	ret = zbx_expression_execute(&value, program, trigger_value, mock_function_value, NULL, &unknown_msgs, error,
+			sizeof(error));
+
+	zbx_mock_assert_result_eq("zbx_expression_execute() return value",
+			zbx_mock_str_to_return_code(zbx_mock_get_parameter_string("out.return")), ret);
+
+	if (SUCCEED == ret)
+	{
+		zbx_mock_assert_double_eq("expression value", zbx_mock_get_parameter_float("out.value"), value);
+	}
+	else if (FAIL == ret)
+		zbx_mock_assert_str_eq("error message", zbx_mock_get_parameter_string("out.error"), error);
+
+	zbx_vector_ptr_clear_ext(&unknown_msgs, zbx_ptr_free);
+	zbx_vector_ptr_destroy(&unknown_msgs);
+out:
+	zbx_free(program);
+}
@@ -0,0 +1,150 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2019 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxalgo.h"
+
+static void	mock_read_doubles(const char *path, zbx_vector_dbl_t *values)
+{
+	zbx_mock_handle_t	handle, element;
+	const char		*str;
+	double			value;
+
+	handle = zbx_mock_get_parameter_handle(path);
+
+	while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(handle, &element))
+	{
+		if (ZBX_MOCK_SUCCESS != zbx_mock_string(element, &str) || SUCCEED != is_double(str, &value))
+			fail_msg("invalid value in \"%s\"", path);
+
+		zbx_vector_dbl_append(values, value);
+	}
+}
+
+static void	mock_assert_result(const char *prefix, int offset, double expected, double returned)
+{
+	if (fabs(expected - returned) <= 1e-6 * MAX(1.0, fabs(expected)))
+		return;
+
+	fail_msg("%s at window offset %d: expected " ZBX_FS_DBL " while got " ZBX_FS_DBL, prefix, offset, expected,
+			returned);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_mock_test_entry                                              *
+ *                                                                            *
+ * Purpose: slide data window over the values updating streaming regression   *
+ *          state and compare its results with fit calculated from the whole  *
+ *          window                                                            *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_vector_dbl_t	t, x;
+	zbx_regression_t	regression;
+	zbx_fit_t		fit;
+	zbx_mode_t		mode;
+	unsigned int		k;
+	char			*fit_str, *mode_str, *error = NULL;
+	double			time, threshold, *window_t, now, shift, expected, returned;
+	int			window, origin, i, j, n, rebuilds = 0;
+	zbx_mock_handle_t	handle;
+
+	ZBX_UNUSED(state);
+
+	zbx_vector_dbl_create(&t);
+	zbx_vector_dbl_create(&x);
+
+	mock_read_doubles("in.t", &t);
+	mock_read_doubles("in.x", &x);
+
+	if (t.values_num != x.values_num)
+		fail_msg("time and value counts differ");
+
+	fit_str = zbx_strdup(NULL, zbx_mock_get_parameter_string("in.fit"));
+	mode_str = zbx_strdup(NULL, zbx_mock_get_parameter_string("in.mode"));
+
+	if (SUCCEED != zbx_fit_code(fit_str, &fit, &k, &error) || SUCCEED != zbx_mode_code(mode_str, &mode, &error))
+		fail_msg("invalid fit or mode: %s", error);
+
+	time = zbx_mock_get_parameter_float("in.time");
+	threshold = zbx_mock_get_parameter_float("in.threshold");
+	window = (int)zbx_mock_get_parameter_uint64("in.window");
+
+	zbx_mock_assert_int_eq("regression initialization", SUCCEED, zbx_regression_init(&regression, fit, k));
+
+	window_t = (double *)zbx_malloc(NULL, sizeof(double) * window);
+
+	/* Regression time frame starts at the origin value, evaluation time frame at the oldest window value. */
+	/* Like the trigger functions do, the sums are rebuilt when the origin lags behind by more than        */
+	/* ZBX_REGRESSION_LAG_MAX part of the window length.                                                   */
+	for (i = 0, origin = 0; i < t.values_num; i++)
+	{
+		zbx_regression_add(&regression, t.values[i] - t.values[origin], x.values[i]);
+
+		if (i >= window)
+		{
+			j = i - window;
+			zbx_regression_remove(&regression, t.values[j] - t.values[origin], x.values[j]);
+		}
+
+		if (i + 1 < window)
+			continue;
+
+		j = i + 1 - window;
+		now = t.values[i] - t.values[j];
+
+		if (t.values[j] - t.values[origin] > ZBX_REGRESSION_LAG_MAX * now)
+		{
+			zbx_regression_init(&regression, fit, k);
+
+			for (n = j, origin = j; n <= i; n++)
+				zbx_regression_add(&regression, t.values[n] - t.values[origin], x.values[n]);
+
+			rebuilds++;
+		}
+
+		shift = t.values[j] - t.values[origin];
+
+		for (n = 0; n < window; n++)
+			window_t[n] = t.values[j + n] - t.values[j];
+
+		expected = zbx_forecast(window_t, x.values + j, window, now, time, fit, k, mode);
+		returned = zbx_regression_forecast(&regression, shift, now, time, mode);
+		mock_assert_result("forecast", j, expected, returned);
+
+		expected = zbx_timeleft(window_t, x.values + j, window, now, threshold, fit, k);
+		returned = zbx_regression_timeleft(&regression, shift, now, threshold);
+		mock_assert_result("timeleft", j, expected, returned);
+	}
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_parameter("out.rebuilds", &handle))
+		zbx_mock_assert_int_eq("sum rebuilds", (int)zbx_mock_get_parameter_uint64("out.rebuilds"), rebuilds);
+
+	zbx_free(window_t);
+	zbx_free(mode_str);
+	zbx_free(fit_str);
+	zbx_vector_dbl_destroy(&x);
+	zbx_vector_dbl_destroy(&t);
+}
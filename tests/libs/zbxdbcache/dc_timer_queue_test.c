@@ -0,0 +1,93 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2019 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+
+#include "dc_timer_queue_test.h"
+
+#define DC_TIMER_QUEUE_TEST_HOSTID	1
+
+void	dc_timer_queue_test_init(void)
+{
+	ZBX_DC_HOST	host_local;
+	int		i;
+
+	config = (ZBX_DC_CONFIG *)zbx_malloc(NULL, sizeof(ZBX_DC_CONFIG));
+	memset(config, 0, sizeof(ZBX_DC_CONFIG));
+
+	zbx_hashset_create(&config->hosts, 0, ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	zbx_hashset_create(&config->items, 0, ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	zbx_hashset_create(&config->functions, 0, ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	zbx_hashset_create(&config->triggers, 0, ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+	for (i = 0; i < ZBX_TIMER_DELAY; i++)
+		zbx_vector_ptr_create(&config->timer_queue[i].triggers);
+
+	memset(&host_local, 0, sizeof(host_local));
+	host_local.hostid = DC_TIMER_QUEUE_TEST_HOSTID;
+	host_local.status = HOST_STATUS_MONITORED;
+	zbx_hashset_insert(&config->hosts, &host_local, sizeof(host_local));
+}
+
+void	dc_timer_queue_test_destroy(void)
+{
+	int	i;
+
+	for (i = 0; i < ZBX_TIMER_DELAY; i++)
+		zbx_vector_ptr_destroy(&config->timer_queue[i].triggers);
+
+	zbx_hashset_destroy(&config->triggers);
+	zbx_hashset_destroy(&config->functions);
+	zbx_hashset_destroy(&config->items);
+	zbx_hashset_destroy(&config->hosts);
+
+	zbx_free(config);
+}
+
+/* adds trigger with a single function, using item with the same identifier as trigger */
+void	dc_timer_queue_test_add_trigger(zbx_uint64_t triggerid, unsigned char status, unsigned char timer,
+		unsigned char locked)
+{
+	ZBX_DC_ITEM	item_local;
+	ZBX_DC_FUNCTION	function_local;
+	ZBX_DC_TRIGGER	trigger_local;
+
+	memset(&item_local, 0, sizeof(item_local));
+	item_local.itemid = triggerid;
+	item_local.hostid = DC_TIMER_QUEUE_TEST_HOSTID;
+	item_local.status = ITEM_STATUS_ACTIVE;
+	zbx_hashset_insert(&config->items, &item_local, sizeof(item_local));
+
+	memset(&function_local, 0, sizeof(function_local));
+	function_local.functionid = triggerid;
+	function_local.triggerid = triggerid;
+	function_local.itemid = triggerid;
+	function_local.timer = timer;
+	zbx_hashset_insert(&config->functions, &function_local, sizeof(function_local));
+
+	memset(&trigger_local, 0, sizeof(trigger_local));
+	trigger_local.triggerid = triggerid;
+	trigger_local.status = status;
+	trigger_local.locked = locked;
+	zbx_hashset_insert(&config->triggers, &trigger_local, sizeof(trigger_local));
+}
+
+void	dc_timer_queue_test_update(void)
+{
+	dc_trigger_update_cache();
+}
@@ -0,0 +1,30 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2019 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+
+#ifndef DC_TIMER_QUEUE_TEST_H
+#define DC_TIMER_QUEUE_TEST_H
+
+void	dc_timer_queue_test_init(void);
+void	dc_timer_queue_test_destroy(void);
+void	dc_timer_queue_test_add_trigger(zbx_uint64_t triggerid, unsigned char status, unsigned char timer,
+		unsigned char locked);
+void	dc_timer_queue_test_update(void);
+
+#endif /* DC_TIMER_QUEUE_TEST_H */
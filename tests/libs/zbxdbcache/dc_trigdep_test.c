@@ -0,0 +1,122 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2019 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+
+#include "dc_trigdep_test.h"
+
+void	dc_trigdep_test_init(void)
+{
+	config = (ZBX_DC_CONFIG *)zbx_malloc(NULL, sizeof(ZBX_DC_CONFIG));
+	memset(config, 0, sizeof(ZBX_DC_CONFIG));
+
+	zbx_hashset_create(&config->triggers, 0, ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	zbx_hashset_create(&config->trigdeps, 0, ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+}
+
+void	dc_trigdep_test_destroy(void)
+{
+	zbx_hashset_iter_t	iter;
+	ZBX_DC_TRIGGER_DEPLIST	*trigdep;
+
+	zbx_hashset_iter_reset(&config->trigdeps, &iter);
+	while (NULL != (trigdep = (ZBX_DC_TRIGGER_DEPLIST *)zbx_hashset_iter_next(&iter)))
+	{
+		zbx_vector_ptr_destroy(&trigdep->dependencies);
+		zbx_vector_ptr_destroy(&trigdep->masters);
+	}
+
+	zbx_hashset_destroy(&config->trigdeps);
+	zbx_hashset_destroy(&config->triggers);
+
+	zbx_free(config);
+}
+
+void	dc_trigdep_test_add_trigger(zbx_uint64_t triggerid)
+{
+	ZBX_DC_TRIGGER	trigger_local;
+
+	memset(&trigger_local, 0, sizeof(trigger_local));
+	trigger_local.triggerid = triggerid;
+	zbx_hashset_insert(&config->triggers, &trigger_local, sizeof(trigger_local));
+}
+
+static void	dc_trigdep_test_add_rows(zbx_dbsync_t *sync, const zbx_vector_uint64_pair_t *deps, unsigned char tag)
+{
+	zbx_dbsync_row_t	*row;
+	int			i;
+
+	for (i = 0; i < deps->values_num; i++)
+	{
+		row = (zbx_dbsync_row_t *)zbx_malloc(NULL, sizeof(zbx_dbsync_row_t));
+		row->rowid = 0;
+		row->tag = tag;
+		row->row = (char **)zbx_malloc(NULL, sizeof(char *) * 2);
+		row->row[0] = zbx_dsprintf(NULL, ZBX_FS_UI64, deps->values[i].first);
+		row->row[1] = zbx_dsprintf(NULL, ZBX_FS_UI64, deps->values[i].second);
+		zbx_vector_ptr_append(&sync->rows, row);
+	}
+}
+
+static void	dc_trigdep_test_free_row(zbx_dbsync_row_t *row)
+{
+	zbx_free(row->row[0]);
+	zbx_free(row->row[1]);
+	zbx_free(row->row);
+	zbx_free(row);
+}
+
+/* synchronizes added and removed dependencies (pairs of dependent and master trigger identifiers) */
+void	dc_trigdep_test_sync(const zbx_vector_uint64_pair_t *added, const zbx_vector_uint64_pair_t *removed)
+{
+	zbx_dbsync_t		sync;
+	zbx_vector_ptr_t	trigdeps;
+
+	zbx_dbsync_init(&sync, ZBX_DBSYNC_UPDATE);
+	sync.columns_num = 2;
+
+	/* removed rows are always added at the end */
+	dc_trigdep_test_add_rows(&sync, added, ZBX_DBSYNC_ROW_ADD);
+	dc_trigdep_test_add_rows(&sync, removed, ZBX_DBSYNC_ROW_REMOVE);
+
+	zbx_vector_ptr_create(&trigdeps);
+
+	DCsync_trigdeps(&sync, &trigdeps);
+	dc_trigger_update_topology(&trigdeps);
+
+	zbx_vector_ptr_destroy(&trigdeps);
+
+	zbx_vector_ptr_clear_ext(&sync.rows, (zbx_clean_func_t)dc_trigdep_test_free_row);
+	zbx_vector_ptr_destroy(&sync.rows);
+	zbx_vector_ptr_destroy(&sync.columns);
+}
+
+/* gets sorted master trigger identifiers, triggers without dependencies have no dependency list */
+void	dc_trigdep_test_get_masters(zbx_uint64_t triggerid, zbx_vector_uint64_t *masterids)
+{
+	ZBX_DC_TRIGGER_DEPLIST	*trigdep;
+	int			i;
+
+	if (NULL == (trigdep = (ZBX_DC_TRIGGER_DEPLIST *)zbx_hashset_search(&config->trigdeps, &triggerid)))
+		return;
+
+	for (i = 0; i < trigdep->masters.values_num; i++)
+		zbx_vector_uint64_append(masterids, ((ZBX_DC_TRIGGER_DEPLIST *)trigdep->masters.values[i])->triggerid);
+
+	zbx_vector_uint64_sort(masterids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+}
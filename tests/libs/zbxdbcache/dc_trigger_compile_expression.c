@@ -0,0 +1,190 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2019 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "common.h"
+#include "mutexs.h"
+#include "memalloc.h"
+#define ZBX_DBCONFIG_IMPL
+#include "dbcache.h"
+#include "dbconfig.h"
+#include "dc_trigger_compile_expression_test.h"
+
+void	*__wrap___zbx_mem_malloc(const char *file, int line, zbx_mem_info_t *info, const void *old, size_t size);
+void	*__wrap___zbx_mem_realloc(const char *file, int line, zbx_mem_info_t *info, void *old, size_t size);
+void	__wrap___zbx_mem_free(const char *file, int line, zbx_mem_info_t *info, void *ptr);
+
+void	*__wrap___zbx_mem_malloc(const char *file, int line, zbx_mem_info_t *info, const void *old, size_t size)
+{
+	ZBX_UNUSED(file);
+	ZBX_UNUSED(line);
+	ZBX_UNUSED(info);
+
+	zbx_mock_assert_ptr_eq("Allocating unfreed memory", NULL, old);
+
+	return zbx_malloc(NULL, size);
+}
+
+void	*__wrap___zbx_mem_realloc(const char *file, int line, zbx_mem_info_t *info, void *old, size_t size)
+{
+	ZBX_UNUSED(file);
+	ZBX_UNUSED(line);
+	ZBX_UNUSED(info);
+
+	return zbx_realloc(old, size);
+}
+
+void	__wrap___zbx_mem_free(const char *file, int line, zbx_mem_info_t *info, void *ptr)
+{
+	ZBX_UNUSED(file);
+	ZBX_UNUSED(line);
+	ZBX_UNUSED(info);
+
+	zbx_free(ptr);
+}
+
+typedef struct
+{
+	zbx_uint64_t	functionid;
+	double		value;
+}
+zbx_test_function_t;
+
+static int	test_function_value(zbx_uint64_t functionid, void *data, double *value, int *unknown_idx, char *error,
+		size_t max_error_len)
+{
+	zbx_vector_ptr_t	*functions = (zbx_vector_ptr_t *)data;
+	int			i;
+
+	ZBX_UNUSED(unknown_idx);
+
+	for (i = 0; i < functions->values_num; i++)
+	{
+		zbx_test_function_t	*function = (zbx_test_function_t *)functions->values[i];
+
+		if (function->functionid == functionid)
+		{
+			*value = function->value;
+			return SUCCEED;
+		}
+	}
+
+	zbx_snprintf(error, max_error_len, "unknown functionid " ZBX_FS_UI64, functionid);
+
+	return FAIL;
+}
+
+static void	set_macros(zbx_mock_handle_t hmacros)
+{
+	zbx_mock_handle_t	hmacro;
+	zbx_mock_error_t	err;
+	const char		*macro;
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = zbx_mock_vector_element(hmacros, &hmacro)))
+	{
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("Cannot read macro: %s", zbx_mock_error_string(err));
+
+		macro = zbx_mock_get_object_member_string(hmacro, "macro");
+
+		if (SUCCEED != dc_trigger_compile_test_set_macro(
+				zbx_mock_get_object_member_uint64(hmacro, "hostid"), macro,
+				zbx_mock_get_object_member_string(hmacro, "value")))
+		{
+			fail_msg("Invalid user macro \"%s\"", macro);
+		}
+	}
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_mock_handle_t	hfunctions, hfunction, hsteps, hstep;
+	zbx_mock_error_t	err;
+	zbx_vector_ptr_t	functions;
+	zbx_test_function_t	*function;
+	const unsigned char	*program;
+	double			result;
+	int			step = 0;
+	char			msg[64], error[MAX_STRING_LEN];
+
+	ZBX_UNUSED(state);
+
+	zbx_vector_ptr_create(&functions);
+	dc_trigger_compile_test_init();
+
+	hfunctions = zbx_mock_get_parameter_handle("in.functions");
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = zbx_mock_vector_element(hfunctions, &hfunction)))
+	{
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("Cannot read function: %s", zbx_mock_error_string(err));
+
+		function = (zbx_test_function_t *)zbx_malloc(NULL, sizeof(zbx_test_function_t));
+		function->functionid = zbx_mock_get_object_member_uint64(hfunction, "functionid");
+		function->value = atof(zbx_mock_get_object_member_string(hfunction, "value"));
+		zbx_vector_ptr_append(&functions, function);
+
+		dc_trigger_compile_test_add_function(function->functionid,
+				zbx_mock_get_object_member_uint64(hfunction, "hostid"));
+	}
+
+	hsteps = zbx_mock_get_parameter_handle("in.steps");
+
+	/* the first step syncs the trigger, the following steps sync user macro changes */
+	while (ZBX_MOCK_END_OF_VECTOR != (err = zbx_mock_vector_element(hsteps, &hstep)))
+	{
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("Cannot read step: %s", zbx_mock_error_string(err));
+
+		set_macros(zbx_mock_get_object_member_handle(hstep, "macros"));
+
+		if (0 == step++)
+			program = dc_trigger_compile_test_add_trigger(zbx_mock_get_parameter_string("in.expression"));
+		else
+			program = dc_trigger_compile_test_update_macros();
+
+		zbx_snprintf(msg, sizeof(msg), "step #%d compiled", step);
+
+		if (0 == strcmp(zbx_mock_get_object_member_string(hstep, "compiled"), "no"))
+		{
+			zbx_mock_assert_ptr_eq(msg, NULL, program);
+			continue;
+		}
+
+		zbx_mock_assert_ptr_ne(msg, NULL, program);
+
+		if (SUCCEED != zbx_expression_execute(&result, program, TRIGGER_VALUE_OK, test_function_value, &functions,
+				NULL, error, sizeof(error)))
+		{
+			fail_msg("step #%d: cannot execute compiled expression: %s", step, error);
+		}
+
+		zbx_snprintf(msg, sizeof(msg), "step #%d result", step);
+		zbx_mock_assert_double_eq(msg, atof(zbx_mock_get_object_member_string(hstep, "result")), result);
+	}
+
+	dc_trigger_compile_test_destroy();
+	zbx_vector_ptr_clear_ext(&functions, zbx_ptr_free);
+	zbx_vector_ptr_destroy(&functions);
+}
@@ -0,0 +1,238 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2019 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+
+#include "dc_trigger_compile_expression_test.h"
+
+static ZBX_DC_TRIGGER	*test_trigger;
+
+void	dc_trigger_compile_test_init(void)
+{
+	config = (ZBX_DC_CONFIG *)zbx_malloc(NULL, sizeof(ZBX_DC_CONFIG));
+	memset(config, 0, sizeof(ZBX_DC_CONFIG));
+
+	zbx_hashset_create(&config->items, 0, ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	zbx_hashset_create(&config->functions, 0, ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	zbx_hashset_create(&config->triggers, 0, ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	zbx_hashset_create(&config->htmpls, 0, ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	zbx_hashset_create(&config->gmacros_m, 0, __config_gmacro_m_hash, __config_gmacro_m_compare);
+	zbx_hashset_create(&config->hmacros_hm, 0, __config_hmacro_hm_hash, __config_hmacro_hm_compare);
+
+	test_trigger = NULL;
+}
+
+static void	dc_trigger_compile_test_free_str(const char *str)
+{
+	char	*ptr = (char *)str;
+
+	zbx_free(ptr);
+}
+
+static void	dc_trigger_compile_test_free_gmacro(ZBX_DC_GMACRO *gmacro)
+{
+	dc_trigger_compile_test_free_str(gmacro->macro);
+	dc_trigger_compile_test_free_str(gmacro->context);
+	dc_trigger_compile_test_free_str(gmacro->value);
+	zbx_free(gmacro);
+}
+
+static void	dc_trigger_compile_test_free_hmacro(ZBX_DC_HMACRO *hmacro)
+{
+	dc_trigger_compile_test_free_str(hmacro->macro);
+	dc_trigger_compile_test_free_str(hmacro->context);
+	dc_trigger_compile_test_free_str(hmacro->value);
+	zbx_free(hmacro);
+}
+
+void	dc_trigger_compile_test_destroy(void)
+{
+	zbx_hashset_iter_t	iter;
+	ZBX_DC_GMACRO_M		*gmacro_m;
+	ZBX_DC_HMACRO_HM	*hmacro_hm;
+
+	if (NULL != test_trigger)
+	{
+		zbx_free(test_trigger->program);
+		zbx_free(test_trigger->recovery_program);
+	}
+
+	zbx_hashset_iter_reset(&config->gmacros_m, &iter);
+	while (NULL != (gmacro_m = (ZBX_DC_GMACRO_M *)zbx_hashset_iter_next(&iter)))
+	{
+		dc_trigger_compile_test_free_str(gmacro_m->macro);
+		zbx_vector_ptr_clear_ext(&gmacro_m->gmacros, (zbx_clean_func_t)dc_trigger_compile_test_free_gmacro);
+		zbx_vector_ptr_destroy(&gmacro_m->gmacros);
+	}
+
+	zbx_hashset_iter_reset(&config->hmacros_hm, &iter);
+	while (NULL != (hmacro_hm = (ZBX_DC_HMACRO_HM *)zbx_hashset_iter_next(&iter)))
+	{
+		dc_trigger_compile_test_free_str(hmacro_hm->macro);
+		zbx_vector_ptr_clear_ext(&hmacro_hm->hmacros, (zbx_clean_func_t)dc_trigger_compile_test_free_hmacro);
+		zbx_vector_ptr_destroy(&hmacro_hm->hmacros);
+	}
+
+	zbx_hashset_destroy(&config->hmacros_hm);
+	zbx_hashset_destroy(&config->gmacros_m);
+	zbx_hashset_destroy(&config->htmpls);
+	zbx_hashset_destroy(&config->triggers);
+	zbx_hashset_destroy(&config->functions);
+	zbx_hashset_destroy(&config->items);
+
+	zbx_free(config);
+}
+
+void	dc_trigger_compile_test_add_function(zbx_uint64_t functionid, zbx_uint64_t hostid)
+{
+	ZBX_DC_FUNCTION	function_local;
+	ZBX_DC_ITEM	item_local;
+
+	memset(&function_local, 0, sizeof(function_local));
+	function_local.functionid = functionid;
+	function_local.itemid = functionid;
+	zbx_hashset_insert(&config->functions, &function_local, sizeof(function_local));
+
+	memset(&item_local, 0, sizeof(item_local));
+	item_local.itemid = functionid;
+	item_local.hostid = hostid;
+	zbx_hashset_insert(&config->items, &item_local, sizeof(item_local));
+}
+
+static void	dc_trigger_compile_test_set_gmacro(zbx_vector_ptr_t *gmacros, char *name, char *context,
+		const char *value)
+{
+	ZBX_DC_GMACRO	*gmacro;
+	int		i;
+
+	for (i = 0; i < gmacros->values_num; i++)
+	{
+		gmacro = (ZBX_DC_GMACRO *)gmacros->values[i];
+
+		if (0 == zbx_strcmp_null(gmacro->context, context))
+		{
+			dc_trigger_compile_test_free_str(gmacro->value);
+			gmacro->value = zbx_strdup(NULL, value);
+			zbx_free(name);
+			zbx_free(context);
+			return;
+		}
+	}
+
+	gmacro = (ZBX_DC_GMACRO *)zbx_malloc(NULL, sizeof(ZBX_DC_GMACRO));
+	gmacro->globalmacroid = 0;
+	gmacro->macro = name;
+	gmacro->context = context;
+	gmacro->value = zbx_strdup(NULL, value);
+	zbx_vector_ptr_append(gmacros, gmacro);
+}
+
+static void	dc_trigger_compile_test_set_hmacro(zbx_vector_ptr_t *hmacros, zbx_uint64_t hostid, char *name,
+		char *context, const char *value)
+{
+	ZBX_DC_HMACRO	*hmacro;
+	int		i;
+
+	for (i = 0; i < hmacros->values_num; i++)
+	{
+		hmacro = (ZBX_DC_HMACRO *)hmacros->values[i];
+
+		if (0 == zbx_strcmp_null(hmacro->context, context))
+		{
+			dc_trigger_compile_test_free_str(hmacro->value);
+			hmacro->value = zbx_strdup(NULL, value);
+			zbx_free(name);
+			zbx_free(context);
+			return;
+		}
+	}
+
+	hmacro = (ZBX_DC_HMACRO *)zbx_malloc(NULL, sizeof(ZBX_DC_HMACRO));
+	hmacro->hostmacroid = 0;
+	hmacro->hostid = hostid;
+	hmacro->macro = name;
+	hmacro->context = context;
+	hmacro->value = zbx_strdup(NULL, value);
+	zbx_vector_ptr_append(hmacros, hmacro);
+}
+
+/* host macro is set if hostid is not 0, otherwise global macro is set */
+int	dc_trigger_compile_test_set_macro(zbx_uint64_t hostid, const char *macro, const char *value)
+{
+	char			*name = NULL, *context = NULL;
+	ZBX_DC_GMACRO_M		*gmacro_m, gmacro_m_local;
+	ZBX_DC_HMACRO_HM	*hmacro_hm, hmacro_hm_local;
+
+	if (SUCCEED != zbx_user_macro_parse_dyn(macro, &name, &context, NULL))
+		return FAIL;
+
+	if (0 == hostid)
+	{
+		gmacro_m_local.macro = name;
+
+		if (NULL == (gmacro_m = (ZBX_DC_GMACRO_M *)zbx_hashset_search(&config->gmacros_m, &gmacro_m_local)))
+		{
+			gmacro_m_local.macro = zbx_strdup(NULL, name);
+			zbx_vector_ptr_create(&gmacro_m_local.gmacros);
+			gmacro_m = (ZBX_DC_GMACRO_M *)zbx_hashset_insert(&config->gmacros_m, &gmacro_m_local,
+					sizeof(gmacro_m_local));
+		}
+
+		dc_trigger_compile_test_set_gmacro(&gmacro_m->gmacros, name, context, value);
+	}
+	else
+	{
+		hmacro_hm_local.hostid = hostid;
+		hmacro_hm_local.macro = name;
+
+		if (NULL == (hmacro_hm = (ZBX_DC_HMACRO_HM *)zbx_hashset_search(&config->hmacros_hm, &hmacro_hm_local)))
+		{
+			hmacro_hm_local.macro = zbx_strdup(NULL, name);
+			zbx_vector_ptr_create(&hmacro_hm_local.hmacros);
+			hmacro_hm = (ZBX_DC_HMACRO_HM *)zbx_hashset_insert(&config->hmacros_hm, &hmacro_hm_local,
+					sizeof(hmacro_hm_local));
+		}
+
+		dc_trigger_compile_test_set_hmacro(&hmacro_hm->hmacros, hostid, name, context, value);
+	}
+
+	return SUCCEED;
+}
+
+const unsigned char	*dc_trigger_compile_test_add_trigger(const char *expression)
+{
+	ZBX_DC_TRIGGER	trigger_local;
+
+	memset(&trigger_local, 0, sizeof(trigger_local));
+	trigger_local.triggerid = 1;
+	trigger_local.expression = expression;
+	trigger_local.recovery_expression = "";
+
+	test_trigger = (ZBX_DC_TRIGGER *)zbx_hashset_insert(&config->triggers, &trigger_local, sizeof(trigger_local));
+
+	dc_trigger_compile_expression(&test_trigger->program, test_trigger->expression);
+
+	return test_trigger->program;
+}
+
+const unsigned char	*dc_trigger_compile_test_update_macros(void)
+{
+	dc_trigger_compile_macro_expressions();
+
+	return test_trigger->program;
+}
@@ -0,0 +1,169 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2019 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "common.h"
+#include "mutexs.h"
+#include "memalloc.h"
+#define ZBX_DBCONFIG_IMPL
+#include "dbcache.h"
+#include "dbconfig.h"
+#include "dc_trigdep_test.h"
+
+void	*__wrap___zbx_mem_malloc(const char *file, int line, zbx_mem_info_t *info, const void *old, size_t size);
+void	*__wrap___zbx_mem_realloc(const char *file, int line, zbx_mem_info_t *info, void *old, size_t size);
+void	__wrap___zbx_mem_free(const char *file, int line, zbx_mem_info_t *info, void *ptr);
+
+void	*__wrap___zbx_mem_malloc(const char *file, int line, zbx_mem_info_t *info, const void *old, size_t size)
+{
+	ZBX_UNUSED(file);
+	ZBX_UNUSED(line);
+	ZBX_UNUSED(info);
+
+	zbx_mock_assert_ptr_eq("Allocating unfreed memory", NULL, old);
+
+	return zbx_malloc(NULL, size);
+}
+
+void	*__wrap___zbx_mem_realloc(const char *file, int line, zbx_mem_info_t *info, void *old, size_t size)
+{
+	ZBX_UNUSED(file);
+	ZBX_UNUSED(line);
+	ZBX_UNUSED(info);
+
+	return zbx_realloc(old, size);
+}
+
+void	__wrap___zbx_mem_free(const char *file, int line, zbx_mem_info_t *info, void *ptr)
+{
+	ZBX_UNUSED(file);
+	ZBX_UNUSED(line);
+	ZBX_UNUSED(info);
+
+	zbx_free(ptr);
+}
+
+static void	read_dependencies(zbx_mock_handle_t hstep, const char *name, zbx_vector_uint64_pair_t *deps)
+{
+	zbx_mock_handle_t	hdeps, hdep;
+	zbx_uint64_pair_t	dep;
+
+	if (ZBX_MOCK_SUCCESS != zbx_mock_object_member(hstep, name, &hdeps))
+		return;
+
+	while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hdeps, &hdep))
+	{
+		dep.first = zbx_mock_get_object_member_uint64(hdep, "down");
+		dep.second = zbx_mock_get_object_member_uint64(hdep, "up");
+		zbx_vector_uint64_pair_append(deps, dep);
+	}
+}
+
+static void	check_masters(zbx_mock_handle_t hstep, int step)
+{
+	zbx_mock_handle_t	htriggers, htrigger, hmasters, hmaster;
+	zbx_vector_uint64_t	masterids, expected;
+	zbx_uint64_t		triggerid, masterid;
+	char			msg[64];
+	int			i;
+
+	zbx_vector_uint64_create(&masterids);
+	zbx_vector_uint64_create(&expected);
+
+	htriggers = zbx_mock_get_object_member_handle(hstep, "masters");
+
+	while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(htriggers, &htrigger))
+	{
+		triggerid = zbx_mock_get_object_member_uint64(htrigger, "triggerid");
+		hmasters = zbx_mock_get_object_member_handle(htrigger, "masters");
+
+		while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hmasters, &hmaster))
+		{
+			if (ZBX_MOCK_SUCCESS != zbx_mock_uint64(hmaster, &masterid))
+				fail_msg("cannot read master of trigger " ZBX_FS_UI64 " at step #%d", triggerid, step);
+
+			zbx_vector_uint64_append(&expected, masterid);
+		}
+
+		zbx_vector_uint64_sort(&expected, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+		dc_trigdep_test_get_masters(triggerid, &masterids);
+
+		zbx_snprintf(msg, sizeof(msg), "step #%d trigger " ZBX_FS_UI64 " masters", step, triggerid);
+		zbx_mock_assert_int_eq(msg, expected.values_num, masterids.values_num);
+
+		for (i = 0; i < expected.values_num; i++)
+			zbx_mock_assert_uint64_eq(msg, expected.values[i], masterids.values[i]);
+
+		zbx_vector_uint64_clear(&expected);
+		zbx_vector_uint64_clear(&masterids);
+	}
+
+	zbx_vector_uint64_destroy(&expected);
+	zbx_vector_uint64_destroy(&masterids);
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_mock_handle_t		htriggers, htrigger, hsteps, hstep;
+	zbx_vector_uint64_pair_t	added, removed;
+	zbx_uint64_t			triggerid;
+	int				step = 0;
+
+	ZBX_UNUSED(state);
+
+	dc_trigdep_test_init();
+
+	htriggers = zbx_mock_get_parameter_handle("in.triggers");
+
+	while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(htriggers, &htrigger))
+	{
+		if (ZBX_MOCK_SUCCESS != zbx_mock_uint64(htrigger, &triggerid))
+			fail_msg("cannot read triggerid");
+
+		dc_trigdep_test_add_trigger(triggerid);
+	}
+
+	zbx_vector_uint64_pair_create(&added);
+	zbx_vector_uint64_pair_create(&removed);
+
+	hsteps = zbx_mock_get_parameter_handle("in.steps");
+
+	while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hsteps, &hstep))
+	{
+		read_dependencies(hstep, "add", &added);
+		read_dependencies(hstep, "remove", &removed);
+
+		dc_trigdep_test_sync(&added, &removed);
+		check_masters(hstep, step++);
+
+		zbx_vector_uint64_pair_clear(&added);
+		zbx_vector_uint64_pair_clear(&removed);
+	}
+
+	zbx_vector_uint64_pair_destroy(&removed);
+	zbx_vector_uint64_pair_destroy(&added);
+
+	dc_trigdep_test_destroy();
+}
@@ -41,6 +41,7 @@
  */
 static zbx_vcmock_ds_t	vc_ds;
 static time_t	vcmock_time;
+static int	vcmock_multi_requests;
 
 int	__wrap_zbx_mutex_create(zbx_mutex_t *mutex, zbx_mutex_name_t name, char **error);
 void	__wrap_zbx_mutex_destroy(zbx_mutex_t *mutex);
@@ -51,9 +52,11 @@ void	*__wrap___zbx_mem_realloc(const char *file, int line, zbx_mem_info_t *info,
 void	__wrap___zbx_mem_free(const char *file, int line, zbx_mem_info_t *info, void *ptr);
 int	__wrap_zbx_history_get_values(zbx_uint64_t itemid, int value_type, int start, int count, int end,
 		zbx_vector_history_record_t *values);
+int	__wrap_zbx_history_get_values_multi(int value_type, zbx_vector_ptr_t *requests);
 int	__wrap_zbx_history_add_values(const zbx_vector_ptr_t *history);
 int	__wrap_zbx_history_sql_init(zbx_history_iface_t *hist, unsigned char value_type, char **error);
 int	__wrap_zbx_history_elastic_init(zbx_history_iface_t *hist, unsigned char value_type, char **error);
+int	__wrap_zbx_history_column_init(zbx_history_iface_t *hist, unsigned char value_type, char **error);
 time_t	__wrap_time(time_t *ptr);
 
 /* comparison function to sort history record vector by timestamps in ascending order */
@@ -242,6 +245,7 @@ void	zbx_vcmock_ds_init(void)
 	tzset();
 
 	zbx_hashset_create(&vc_ds.items, 10, ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	vcmock_multi_requests = 0;
 
 	hitems = zbx_mock_get_parameter_handle("in.history");
 
@@ -257,6 +261,30 @@ void	zbx_vcmock_ds_init(void)
 	}
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_vcmock_ds_add_item                                           *
+ *                                                                            *
+ * Purpose: adds item with generated history data to history data storage     *
+ *                                                                            *
+ * Parameters: itemid     - [IN] the item identifier                          *
+ *             value_type - [IN] the item value type                          *
+ *             data       - [IN] the item history data, the vector is owned   *
+ *                               by data storage afterwards                   *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_vcmock_ds_add_item(zbx_uint64_t itemid, unsigned char value_type, zbx_vector_history_record_t *data)
+{
+	zbx_vcmock_ds_item_t	item;
+
+	item.itemid = itemid;
+	item.value_type = value_type;
+	item.data = *data;
+	zbx_vector_history_record_sort(&item.data, history_compare);
+
+	zbx_hashset_insert(&vc_ds.items, &item, sizeof(item));
+}
+
 /******************************************************************************
  *                                                                            *
  * Function: zbx_vcmock_ds_destroy                                            *
@@ -609,6 +637,28 @@ int	__wrap_zbx_history_get_values(zbx_uint64_t itemid, int value_type, int start
 	return SUCCEED;
 }
 
+int	__wrap_zbx_history_get_values_multi(int value_type, zbx_vector_ptr_t *requests)
+{
+	int	i;
+
+	for (i = 0; i < requests->values_num; i++)
+	{
+		zbx_history_request_t	*request = (zbx_history_request_t *)requests->values[i];
+
+		__wrap_zbx_history_get_values(request->itemid, value_type, request->start, 0, request->end,
+				&request->values);
+	}
+
+	vcmock_multi_requests++;
+
+	return SUCCEED;
+}
+
+int	zbx_vcmock_get_multi_requests(void)
+{
+	return vcmock_multi_requests;
+}
+
 int	__wrap_zbx_history_add_values(const zbx_vector_ptr_t *history)
 {
 	int			i;
@@ -658,6 +708,15 @@ int	__wrap_zbx_history_elastic_init(zbx_history_iface_t *hist, unsigned char val
 	return SUCCEED;
 }
 
+int	__wrap_zbx_history_column_init(zbx_history_iface_t *hist, unsigned char value_type, char **error)
+{
+	ZBX_UNUSED(hist);
+	ZBX_UNUSED(value_type);
+	ZBX_UNUSED(error);
+
+	return SUCCEED;
+}
+
 /*
  * cache allocator size limit handling
  */
@@ -38,6 +38,7 @@ unsigned char	zbx_mock_str_to_value_type(const char *value_type);
 
 void	zbx_vcmock_ds_init(void);
 void	zbx_vcmock_ds_destroy(void);
+void	zbx_vcmock_ds_add_item(zbx_uint64_t itemid, unsigned char value_type, zbx_vector_history_record_t *data);
 void	zbx_vcmock_ds_dump(void);
 
 int	zbx_vcmock_str_to_cache_mode(const char *mode);
@@ -55,6 +56,7 @@ void	zbx_vcmock_set_cache_size(zbx_mock_handle_t hitem, const char *key);
 void	zbx_vcmock_get_request_params(zbx_mock_handle_t handle, zbx_uint64_t *itemid, unsigned char *value_type,
 		int *seconds, int *count, zbx_timespec_t *end);
 void	zbx_vcmock_set_mode(zbx_mock_handle_t hitem, const char *key);
+int	zbx_vcmock_get_multi_requests(void);
 
 void	zbx_vcmock_get_dc_history(zbx_mock_handle_t handle, zbx_vector_ptr_t *history);
 void	zbx_vcmock_free_dc_history(void *ptr);
@@ -68,7 +68,7 @@ int	zbx_vc_precache_values(zbx_uint64_t itemid, int value_type, int seconds, int
 	/* perform request to cache values */
 	vc_item_addref(item);
 	zbx_history_record_vector_create(&values);
-	ret = vch_item_get_values(item, &values, seconds, count, ts);
+	ret = vch_item_get_values(item, &values, vc_history_record_vector_append, seconds, count, ts);
 	zbx_history_record_vector_destroy(&values, value_type);
 	vc_item_release(item);
 
@@ -119,3 +119,64 @@ int	zbx_vc_get_cache_state(int *mode, zbx_uint64_t *hits, zbx_uint64_t *misses)
 
 	return SUCCEED;
 }
+
+int	zbx_vc_set_item_stats(zbx_uint64_t itemid, int last_accessed, zbx_uint64_t hits, zbx_uint64_t db_fetches,
+		double db_fetch_time)
+{
+	zbx_vc_item_t	*item;
+	int		ret = FAIL;
+
+	vc_try_lock();
+
+	if (NULL != (item = (zbx_vc_item_t *)zbx_hashset_search(&vc_cache->items, &itemid)))
+	{
+		item->last_accessed = last_accessed;
+		item->hits = hits;
+		item->db_fetches = db_fetches;
+		item->db_fetch_time = db_fetch_time;
+
+		ret = SUCCEED;
+	}
+
+	vc_try_unlock();
+
+	return ret;
+}
+
+size_t	zbx_vc_release_items(int value_type, size_t space)
+{
+	size_t	freed;
+
+	vc_try_lock();
+	freed = vc_release_weighted_items(value_type, space);
+	vc_try_unlock();
+
+	return freed;
+}
+
+int	zbx_vc_reserve_quota(zbx_uint64_t itemid, size_t quota, size_t size)
+{
+	zbx_vc_item_t	*item;
+	int		ret = FAIL;
+
+	vc_try_lock();
+
+	if (NULL != (item = (zbx_vc_item_t *)zbx_hashset_search(&vc_cache->items, &itemid)))
+	{
+		vc_cache->quota[item->value_type] = quota;
+
+		/* the requesting item is referenced and cannot be dropped */
+		vc_item_addref(item);
+		ret = vc_item_reserve_quota(item, size);
+		vc_item_release(item);
+	}
+
+	vc_try_unlock();
+
+	return ret;
+}
+
+size_t	zbx_vc_get_type_memory(int value_type)
+{
+	return vc_cache->memory[value_type];
+}
@@ -26,5 +26,10 @@ int	zbx_vc_precache_values(zbx_uint64_t itemid, int value_type, int seconds, int
 int	zbx_vc_get_item_state(zbx_uint64_t itemid, int *status, int *active_range, int *values_total,
 		int *db_cached_from);
 int	zbx_vc_get_cache_state(int *mode, zbx_uint64_t *hits, zbx_uint64_t *misses);
+int	zbx_vc_set_item_stats(zbx_uint64_t itemid, int last_accessed, zbx_uint64_t hits, zbx_uint64_t db_fetches,
+		double db_fetch_time);
+size_t	zbx_vc_release_items(int value_type, size_t space);
+int	zbx_vc_reserve_quota(zbx_uint64_t itemid, size_t quota, size_t size);
+size_t	zbx_vc_get_type_memory(int value_type);
 
 #endif
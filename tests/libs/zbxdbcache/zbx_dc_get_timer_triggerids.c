@@ -0,0 +1,151 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2019 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "common.h"
+#include "mutexs.h"
+#define ZBX_DBCONFIG_IMPL
+#include "dbcache.h"
+#include "dbconfig.h"
+#include "dc_timer_queue_test.h"
+
+static time_t	mock_time;
+
+time_t	__wrap_time(time_t *ptr);
+
+time_t	__wrap_time(time_t *ptr)
+{
+	if (NULL != ptr)
+		*ptr = mock_time;
+
+	return mock_time;
+}
+
+static void	mock_read_triggerids(zbx_mock_handle_t handle, zbx_vector_uint64_t *triggerids)
+{
+	zbx_mock_handle_t	htriggerid;
+	zbx_mock_error_t	err;
+	const char		*str;
+	zbx_uint64_t		triggerid;
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = zbx_mock_vector_element(handle, &htriggerid)))
+	{
+		if (ZBX_MOCK_SUCCESS != err || ZBX_MOCK_SUCCESS != zbx_mock_string(htriggerid, &str) ||
+				SUCCEED != is_uint64(str, &triggerid))
+		{
+			fail_msg("Cannot read trigger identifier");
+		}
+
+		zbx_vector_uint64_append(triggerids, triggerid);
+	}
+
+	zbx_vector_uint64_sort(triggerids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+}
+
+static unsigned char	mock_get_flag(zbx_mock_handle_t handle, const char *name, unsigned char value)
+{
+	zbx_mock_handle_t	hflag;
+
+	if (ZBX_MOCK_SUCCESS != zbx_mock_object_member(handle, name, &hflag))
+		return value;
+
+	return (unsigned char)zbx_mock_get_object_member_uint64(handle, name);
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_mock_handle_t	htriggers, htrigger, hcalls, hcall, hexpected;
+	zbx_mock_error_t	err;
+	zbx_vector_uint64_t	triggerids, expected;
+	int			i, call = 0;
+	char			msg[64];
+
+	ZBX_UNUSED(state);
+
+	zbx_vector_uint64_create(&triggerids);
+	zbx_vector_uint64_create(&expected);
+
+	dc_timer_queue_test_init();
+
+	htriggers = zbx_mock_get_parameter_handle("in.triggers");
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = zbx_mock_vector_element(htriggers, &htrigger)))
+	{
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("Cannot read trigger: %s", zbx_mock_error_string(err));
+
+		dc_timer_queue_test_add_trigger(zbx_mock_get_object_member_uint64(htrigger, "triggerid"),
+				mock_get_flag(htrigger, "status", TRIGGER_STATUS_ENABLED),
+				mock_get_flag(htrigger, "timer", 1), mock_get_flag(htrigger, "locked", 0));
+	}
+
+	/* timer queue is built when configuration cache is synced */
+	mock_time = (time_t)zbx_mock_get_parameter_uint64("in.sync");
+	dc_timer_queue_test_update();
+
+	hcalls = zbx_mock_get_parameter_handle("in.calls");
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = zbx_mock_vector_element(hcalls, &hcall)))
+	{
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("Cannot read call: %s", zbx_mock_error_string(err));
+
+		call++;
+
+		zbx_vector_uint64_clear(&triggerids);
+		zbx_dc_get_timer_triggerids(&triggerids, (int)zbx_mock_get_object_member_uint64(hcall, "now"),
+				(int)zbx_mock_get_object_member_uint64(hcall, "limit"));
+		zbx_vector_uint64_sort(&triggerids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+		zbx_snprintf(msg, sizeof(msg), "call #%d returned trigger count", call);
+
+		/* the order of triggers within slot is not defined, so partially processed slots are checked by count */
+		if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hcall, "count", &hexpected))
+		{
+			zbx_mock_assert_int_eq(msg, (int)zbx_mock_get_object_member_uint64(hcall, "count"),
+					triggerids.values_num);
+		}
+		else
+		{
+			zbx_vector_uint64_clear(&expected);
+			mock_read_triggerids(zbx_mock_get_object_member_handle(hcall, "triggerids"), &expected);
+
+			zbx_mock_assert_int_eq(msg, expected.values_num, triggerids.values_num);
+
+			for (i = 0; i < expected.values_num; i++)
+			{
+				zbx_snprintf(msg, sizeof(msg), "call #%d triggerid #%d", call, i + 1);
+				zbx_mock_assert_uint64_eq(msg, expected.values[i], triggerids.values[i]);
+			}
+		}
+
+		/* returned triggers are unlocked after being processed by history syncer */
+		DCconfig_unlock_triggers(&triggerids);
+	}
+
+	dc_timer_queue_test_destroy();
+
+	zbx_vector_uint64_destroy(&expected);
+	zbx_vector_uint64_destroy(&triggerids);
+}
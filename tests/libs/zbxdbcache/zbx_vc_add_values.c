@@ -47,6 +47,7 @@ void	zbx_mock_test_entry(void **state)
 	unsigned char			value_type;
 	zbx_vector_ptr_t		history;
 	zbx_timespec_t			ts;
+	zbx_vc_revision_t		revision;
 
 	ZBX_UNUSED(state);
 
@@ -142,6 +143,19 @@ void	zbx_mock_test_entry(void **state)
 
 			zbx_vcmock_check_records("Cached values", value_type, &expected, &returned);
 
+			zbx_vc_get_revisions(&itemid, 1, &revision);
+
+			if (0 != returned.values_num)
+			{
+				if (0 == revision.revision)
+					fail_msg("Expected non-zero item revision");
+
+				zbx_mock_assert_timespec_eq("item revision timestamp",
+						&returned.values[returned.values_num - 1].timestamp, &revision.ts);
+			}
+			else
+				zbx_mock_assert_uint64_eq("item revision", 0, revision.revision);
+
 			zbx_history_record_vector_clean(&expected, value_type);
 			zbx_history_record_vector_clean(&returned, value_type);
 		}
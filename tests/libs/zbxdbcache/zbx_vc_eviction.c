@@ -0,0 +1,195 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2019 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "common.h"
+#include "valuecache.h"
+#include "valuecache_test.h"
+#include "valuecache_mock.h"
+
+extern zbx_uint64_t	CONFIG_VALUE_CACHE_SIZE;
+extern int		CONFIG_VALUE_CACHE_EVICTION;
+
+static int	vcmock_str_to_eviction(const char *str)
+{
+	if (0 == strcmp(str, "ZBX_VC_EVICTION_WEIGHT"))
+		return ZBX_VC_EVICTION_WEIGHT;
+
+	if (0 == strcmp(str, "ZBX_VC_EVICTION_LRU"))
+		return ZBX_VC_EVICTION_LRU;
+
+	if (0 == strcmp(str, "ZBX_VC_EVICTION_LFU"))
+		return ZBX_VC_EVICTION_LFU;
+
+	if (0 == strcmp(str, "ZBX_VC_EVICTION_COST"))
+		return ZBX_VC_EVICTION_COST;
+
+	fail_msg("Unknown eviction policy \"%s\"", str);
+
+	return FAIL;
+}
+
+static int	vcmock_str_to_value_type(const char *str)
+{
+	if (0 == strcmp(str, "ITEM_VALUE_TYPE_MAX"))
+		return ITEM_VALUE_TYPE_MAX;
+
+	return zbx_mock_str_to_value_type(str);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: vcmock_check_items                                               *
+ *                                                                            *
+ * Purpose: checks if the items listed in the specified step member are       *
+ *          (or are not) cached                                               *
+ *                                                                            *
+ ******************************************************************************/
+static void	vcmock_check_items(zbx_mock_handle_t hstep, const char *key, int expected)
+{
+	zbx_mock_handle_t	hitems, hitem;
+	zbx_uint64_t		itemid;
+	int			status, active_range, values_total, db_cached_from;
+	const char		*data;
+
+	if (ZBX_MOCK_SUCCESS != zbx_mock_object_member(hstep, key, &hitems))
+		return;
+
+	while (ZBX_MOCK_END_OF_VECTOR != zbx_mock_vector_element(hitems, &hitem))
+	{
+		if (ZBX_MOCK_SUCCESS != zbx_mock_string(hitem, &data) || SUCCEED != is_uint64(data, &itemid))
+			fail_msg("Invalid \"%s\" itemid", key);
+
+		if (expected != zbx_vc_get_item_state(itemid, &status, &active_range, &values_total, &db_cached_from))
+		{
+			fail_msg("Item " ZBX_FS_UI64 " is expected %sto be cached", itemid,
+					SUCCEED == expected ? "" : "not ");
+		}
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_mock_test_entry                                              *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_mock_test_entry(void **state)
+{
+	int			err, seconds, count, step = 0;
+	char			*error;
+	const char		*op;
+	zbx_mock_handle_t	hsteps, hstep;
+	zbx_uint64_t		itemid;
+	unsigned char		value_type;
+	zbx_timespec_t		ts;
+
+	ZBX_UNUSED(state);
+
+	/* set small cache size to force smaller cache free request size (5% of cache size) */
+	CONFIG_VALUE_CACHE_SIZE = ZBX_KIBIBYTE;
+	CONFIG_VALUE_CACHE_EVICTION = vcmock_str_to_eviction(zbx_mock_get_parameter_string("in.eviction"));
+
+	err = zbx_vc_init(&error);
+	zbx_mock_assert_result_eq("Value cache initialization failed", SUCCEED, err);
+
+	zbx_vc_enable();
+	zbx_vcmock_ds_init();
+
+	hsteps = zbx_mock_get_parameter_handle("in.steps");
+
+	while (ZBX_MOCK_END_OF_VECTOR != zbx_mock_vector_element(hsteps, &hstep))
+	{
+		op = zbx_mock_get_object_member_string(hstep, "op");
+
+		if (0 == strcmp(op, "precache"))
+		{
+			zbx_vcmock_set_time(hstep, "time");
+			zbx_vcmock_get_request_params(hstep, &itemid, &value_type, &seconds, &count, &ts);
+			zbx_vc_precache_values(itemid, value_type, seconds, count, &ts);
+		}
+		else if (0 == strcmp(op, "stats"))
+		{
+			itemid = zbx_mock_get_object_member_uint64(hstep, "itemid");
+
+			if (ZBX_MOCK_SUCCESS != zbx_strtime_to_timespec(
+					zbx_mock_get_object_member_string(hstep, "accessed"), &ts))
+			{
+				fail_msg("Cannot read step #%d access time", step);
+			}
+
+			err = zbx_vc_set_item_stats(itemid, ts.sec, zbx_mock_get_object_member_uint64(hstep, "hits"),
+					zbx_mock_get_object_member_uint64(hstep, "db fetches"),
+					zbx_mock_get_object_member_float(hstep, "db fetch time"));
+			zbx_mock_assert_result_eq("zbx_vc_set_item_stats()", SUCCEED, err);
+		}
+		else if (0 == strcmp(op, "release"))
+		{
+			size_t	freed;
+			int	type;
+
+			type = vcmock_str_to_value_type(zbx_mock_get_object_member_string(hstep, "value type"));
+			freed = zbx_vc_release_items(type, zbx_mock_get_object_member_uint64(hstep, "space"));
+
+			if (0 == freed)
+				fail_msg("Step #%d did not free any space", step);
+		}
+		else if (0 == strcmp(op, "reserve"))
+		{
+			const char	*quota;
+			size_t		quota_size = 0;
+			zbx_uint64_t	value;
+
+			zbx_vcmock_set_time(hstep, "time");
+			itemid = zbx_mock_get_object_member_uint64(hstep, "itemid");
+			value_type = zbx_mock_str_to_value_type(zbx_mock_get_object_member_string(hstep, "value type"));
+
+			/* "used" sets quota to the memory currently used by values of the item value type */
+			quota = zbx_mock_get_object_member_string(hstep, "quota");
+
+			if (0 == strcmp(quota, "used"))
+				quota_size = zbx_vc_get_type_memory(value_type);
+			else if (SUCCEED == is_uint64(quota, &value))
+				quota_size = (size_t)value;
+			else
+				fail_msg("Invalid step #%d quota \"%s\"", step, quota);
+
+			err = zbx_vc_reserve_quota(itemid, quota_size, zbx_mock_get_object_member_uint64(hstep, "size"));
+			zbx_mock_assert_result_eq("zbx_vc_reserve_quota()",
+					zbx_mock_str_to_return_code(zbx_mock_get_object_member_string(hstep, "return")),
+					err);
+		}
+		else
+			fail_msg("Unknown step #%d operation \"%s\"", step, op);
+
+		vcmock_check_items(hstep, "cached", SUCCEED);
+		vcmock_check_items(hstep, "dropped", FAIL);
+
+		step++;
+	}
+
+	zbx_vcmock_ds_destroy();
+
+	zbx_vc_reset();
+	zbx_vc_destroy();
+}
@@ -0,0 +1,153 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2019 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "common.h"
+#include "valuecache.h"
+#include "valuecache_test.h"
+#include "valuecache_mock.h"
+
+extern zbx_uint64_t	CONFIG_VALUE_CACHE_SIZE;
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_mock_test_entry                                              *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_mock_test_entry(void **state)
+{
+	char				*error = NULL, msg[64];
+	int				err, seconds, count, *offsets, i, j;
+	zbx_vector_history_record_t	expected;
+	zbx_vector_uint64_t		itemids, values_ui64;
+	zbx_vector_dbl_t		values_dbl;
+	zbx_timespec_t			ts;
+	zbx_uint64_t			itemid;
+	unsigned char			value_type;
+	zbx_mock_handle_t		handle, hitems, hitem;
+	zbx_mock_error_t		mock_err;
+
+	ZBX_UNUSED(state);
+
+	/* set small cache size to force smaller cache free request size (5% of cache size) */
+	CONFIG_VALUE_CACHE_SIZE = ZBX_KIBIBYTE;
+
+	err = zbx_vc_init(&error);
+	zbx_mock_assert_result_eq("Value cache initialization failed", SUCCEED, err);
+
+	zbx_vc_enable();
+
+	zbx_vcmock_ds_init();
+	zbx_history_record_vector_create(&expected);
+	zbx_vector_uint64_create(&itemids);
+	zbx_vector_uint64_create(&values_ui64);
+	zbx_vector_dbl_create(&values_dbl);
+
+	/* precache values */
+	if (ZBX_MOCK_SUCCESS == zbx_mock_parameter("in.precache", &handle))
+	{
+		while (ZBX_MOCK_END_OF_VECTOR != (mock_err = (zbx_mock_vector_element(handle, &hitem))))
+		{
+			zbx_vcmock_set_time(hitem, "time");
+			zbx_vcmock_get_request_params(hitem, &itemid, &value_type, &seconds, &count, &ts);
+			zbx_vc_precache_values(itemid, value_type, seconds, count, &ts);
+		}
+	}
+
+	/* perform request */
+
+	handle = zbx_mock_get_parameter_handle("in.test");
+	zbx_vcmock_set_time(handle, "time");
+	zbx_vcmock_set_mode(handle, "cache mode");
+
+	value_type = zbx_mock_str_to_value_type(zbx_mock_get_object_member_string(handle, "value type"));
+	seconds = atoi(zbx_mock_get_object_member_string(handle, "seconds"));
+	count = atoi(zbx_mock_get_object_member_string(handle, "count"));
+	zbx_strtime_to_timespec(zbx_mock_get_object_member_string(handle, "end"), &ts);
+
+	hitems = zbx_mock_get_object_member_handle(handle, "itemids");
+
+	while (ZBX_MOCK_END_OF_VECTOR != (mock_err = (zbx_mock_vector_element(hitems, &hitem))))
+	{
+		if (ZBX_MOCK_SUCCESS != zbx_mock_uint64(hitem, &itemid))
+			fail_msg("Invalid itemid");
+
+		zbx_vector_uint64_append(&itemids, itemid);
+	}
+
+	offsets = (int *)zbx_malloc(NULL, sizeof(int) * (itemids.values_num + 1));
+
+	if (ITEM_VALUE_TYPE_FLOAT == value_type)
+		zbx_vc_get_values_dbl_bulk(itemids.values, itemids.values_num, &values_dbl, offsets, seconds, count, &ts);
+	else
+		zbx_vc_get_values_uint64_bulk(itemids.values, itemids.values_num, &values_ui64, offsets, seconds, count,
+				&ts);
+
+	/* validate results */
+
+	hitems = zbx_mock_get_parameter_handle("out.items");
+
+	for (i = 0; ZBX_MOCK_END_OF_VECTOR != (mock_err = (zbx_mock_vector_element(hitems, &hitem))); i++)
+	{
+		if (i >= itemids.values_num)
+			fail_msg("too many items in output data");
+
+		zbx_vcmock_read_values(zbx_mock_get_object_member_handle(hitem, "values"), value_type, &expected);
+
+		zbx_snprintf(msg, sizeof(msg), "item #%d number of values", i + 1);
+		zbx_mock_assert_int_eq(msg, expected.values_num, offsets[i + 1] - offsets[i]);
+
+		for (j = 0; j < expected.values_num; j++)
+		{
+			zbx_snprintf(msg, sizeof(msg), "item #%d value #%d", i + 1, j + 1);
+
+			if (ITEM_VALUE_TYPE_FLOAT == value_type)
+			{
+				zbx_mock_assert_double_eq(msg, expected.values[j].value.dbl,
+						values_dbl.values[offsets[i] + j]);
+			}
+			else
+			{
+				zbx_mock_assert_uint64_eq(msg, expected.values[j].value.ui64,
+						values_ui64.values[offsets[i] + j]);
+			}
+		}
+
+		zbx_history_record_vector_clean(&expected, value_type);
+	}
+
+	zbx_mock_assert_int_eq("number of items", itemids.values_num, i);
+
+	/* cleanup */
+
+	zbx_free(offsets);
+	zbx_vector_dbl_destroy(&values_dbl);
+	zbx_vector_uint64_destroy(&values_ui64);
+	zbx_vector_uint64_destroy(&itemids);
+	zbx_vector_history_record_destroy(&expected);
+
+	zbx_vcmock_ds_destroy();
+
+	zbx_vc_reset();
+	zbx_vc_destroy();
+}
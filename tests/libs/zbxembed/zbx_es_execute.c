@@ -0,0 +1,154 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2019 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "common.h"
+#include "zbxembed.h"
+
+#include "../../../src/libs/zbxembed/embed.h"
+
+static zbx_es_func_t	*mock_es_func_find(zbx_es_t *es, const char *script)
+{
+	zbx_hashset_iter_t	iter;
+	zbx_es_func_t		*func;
+
+	zbx_hashset_iter_reset(&es->env->funcs, &iter);
+	while (NULL != (func = (zbx_es_func_t *)zbx_hashset_iter_next(&iter)))
+	{
+		if (0 == strcmp(func->name, script))
+			return func;
+	}
+
+	return NULL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: mock_es_execute                                                  *
+ *                                                                            *
+ * Purpose: executes script the same way as preprocessing does, resetting the *
+ *          scripting environment after fatal errors                          *
+ *                                                                            *
+ ******************************************************************************/
+static void	mock_es_execute(zbx_es_t *es, const char *script, int expected_ret)
+{
+	char	*code = NULL, *output = NULL, *error = NULL;
+	int	size, ret;
+
+	if (SUCCEED != zbx_es_is_env_initialized(es) && SUCCEED != zbx_es_init_env(es, &error))
+		fail_msg("cannot initialize scripting environment: %s", error);
+
+	if (SUCCEED != zbx_es_compile(es, script, &code, &size, &error))
+		fail_msg("cannot compile script \"%s\": %s", script, error);
+
+	ret = zbx_es_execute(es, script, code, size, "value", &output, &error);
+	zbx_mock_assert_result_eq(script, expected_ret, ret);
+
+	if (SUCCEED != ret && SUCCEED == zbx_es_fatal_error(es))
+	{
+		zbx_free(error);
+
+		if (SUCCEED != zbx_es_destroy_env(es, &error))
+			fail_msg("cannot destroy scripting environment: %s", error);
+	}
+
+	zbx_free(error);
+	zbx_free(output);
+	zbx_free(code);
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_es_t		es;
+	zbx_es_func_t		*func;
+	zbx_mock_handle_t	hsteps, hstep, hfuncs, hfunc;
+	const char		*script;
+	char			buffer[64];
+	int			i, repeat, expected_ret;
+
+	ZBX_UNUSED(state);
+
+	zbx_es_init(&es);
+
+	hsteps = zbx_mock_get_parameter_handle("in.steps");
+
+	while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hsteps, &hstep))
+	{
+		if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hstep, "generated", &hfunc))
+		{
+			repeat = (int)zbx_mock_get_object_member_uint64(hstep, "generated");
+
+			for (i = 0; i < repeat; i++)
+			{
+				zbx_snprintf(buffer, sizeof(buffer), "return 'script %d';", i);
+				mock_es_execute(&es, buffer, SUCCEED);
+			}
+
+			continue;
+		}
+
+		script = zbx_mock_get_object_member_string(hstep, "script");
+
+		if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hstep, "repeat", &hfunc))
+			repeat = (int)zbx_mock_get_object_member_uint64(hstep, "repeat");
+		else
+			repeat = 1;
+
+		if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hstep, "result", &hfunc))
+			expected_ret = zbx_mock_str_to_return_code(zbx_mock_get_object_member_string(hstep, "result"));
+		else
+			expected_ret = SUCCEED;
+
+		for (i = 0; i < repeat; i++)
+			mock_es_execute(&es, script, expected_ret);
+	}
+
+	zbx_mock_assert_int_eq("cached functions", (int)zbx_mock_get_parameter_uint64("out.cached"),
+			es.env->funcs.num_data);
+
+	hfuncs = zbx_mock_get_parameter_handle("out.funcs");
+
+	while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hfuncs, &hfunc))
+	{
+		script = zbx_mock_get_object_member_string(hfunc, "script");
+
+		if (NULL == (func = mock_es_func_find(&es, script)))
+			fail_msg("script \"%s\" is not cached", script);
+
+		zbx_mock_assert_uint64_eq(script, zbx_mock_get_object_member_uint64(hfunc, "calls"), func->calls);
+	}
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_parameter("out.evicted", &hfuncs))
+	{
+		while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hfuncs, &hfunc))
+		{
+			zbx_mock_string(hfunc, &script);
+
+			if (NULL != mock_es_func_find(&es, script))
+				fail_msg("script \"%s\" is still cached", script);
+		}
+	}
+
+	zbx_es_destroy(&es);
+}
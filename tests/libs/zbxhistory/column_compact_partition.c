@@ -0,0 +1,290 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2019 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "common.h"
+#include "zbxalgo.h"
+#include "dbcache.h"
+#include "zbxhistory.h"
+#include "history.h"
+#include "history_column_test.h"
+
+extern char	*CONFIG_HISTORY_LOCAL_PATH;
+
+/* the history storage to compact when a history file is being locked for writing */
+static zbx_history_iface_t	*compact_on_lock = NULL;
+
+int	__wrap_zbx_history_sql_init(zbx_history_iface_t *hist, unsigned char value_type, char **error);
+int	__wrap_zbx_history_elastic_init(zbx_history_iface_t *hist, unsigned char value_type, char **error);
+int	__wrap_fcntl(int fd, int cmd, ...);
+int	__real_fcntl(int fd, int cmd, ...);
+
+int	__wrap_zbx_history_sql_init(zbx_history_iface_t *hist, unsigned char value_type, char **error)
+{
+	ZBX_UNUSED(hist);
+	ZBX_UNUSED(value_type);
+	ZBX_UNUSED(error);
+
+	return SUCCEED;
+}
+
+int	__wrap_zbx_history_elastic_init(zbx_history_iface_t *hist, unsigned char value_type, char **error)
+{
+	ZBX_UNUSED(hist);
+	ZBX_UNUSED(value_type);
+	ZBX_UNUSED(error);
+
+	return SUCCEED;
+}
+
+/* compacts partitions after writer has opened its file and before it has locked it */
+int	__wrap_fcntl(int fd, int cmd, ...)
+{
+	zbx_history_iface_t	*hist = compact_on_lock;
+	struct flock		*fl;
+	va_list			args;
+
+	va_start(args, cmd);
+	fl = va_arg(args, struct flock *);
+	va_end(args);
+
+	if (NULL != hist && F_SETLKW == cmd && F_WRLCK == fl->l_type)
+	{
+		compact_on_lock = NULL;
+		zbx_column_test_compact(hist, ZBX_COLUMN_TEST_INTERRUPT_NONE);
+	}
+
+	return __real_fcntl(fd, cmd, fl);
+}
+
+static void	read_timespec(const char *str, zbx_timespec_t *ts)
+{
+	zbx_mock_error_t	err;
+
+	if (ZBX_MOCK_SUCCESS != (err = zbx_strtime_to_timespec(str, ts)))
+		fail_msg("Invalid timestamp \"%s\": %s", str, zbx_mock_error_string(err));
+}
+
+static void	read_value(zbx_mock_handle_t hvalue, unsigned char value_type, zbx_timespec_t *ts,
+		history_value_t *value)
+{
+	const char	*str;
+
+	read_timespec(zbx_mock_get_object_member_string(hvalue, "ts"), ts);
+	str = zbx_mock_get_object_member_string(hvalue, "value");
+
+	if (ITEM_VALUE_TYPE_FLOAT == value_type)
+		value->dbl = atof(str);
+	else if (SUCCEED != is_uint64(str, &value->ui64))
+		fail_msg("Invalid unsigned value \"%s\"", str);
+}
+
+static void	write_values(zbx_history_iface_t *hist, zbx_mock_handle_t hvalues)
+{
+	zbx_mock_handle_t	hvalue;
+	zbx_mock_error_t	err;
+	zbx_vector_ptr_t	history;
+	ZBX_DC_HISTORY		*h;
+
+	zbx_vector_ptr_create(&history);
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = zbx_mock_vector_element(hvalues, &hvalue)))
+	{
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("Cannot read value: %s", zbx_mock_error_string(err));
+
+		h = (ZBX_DC_HISTORY *)zbx_malloc(NULL, sizeof(ZBX_DC_HISTORY));
+		memset(h, 0, sizeof(ZBX_DC_HISTORY));
+		h->itemid = zbx_mock_get_object_member_uint64(hvalue, "itemid");
+		h->value_type = hist->value_type;
+		read_value(hvalue, hist->value_type, &h->ts, &h->value);
+		zbx_vector_ptr_append(&history, h);
+	}
+
+	hist->add_values(hist, &history);
+	zbx_mock_assert_result_eq("flush result", SUCCEED, hist->flush(hist));
+
+	zbx_vector_ptr_clear_ext(&history, zbx_ptr_free);
+	zbx_vector_ptr_destroy(&history);
+}
+
+static int	str_to_interrupt(const char *str)
+{
+	if (0 == strcmp(str, "no"))
+		return ZBX_COLUMN_TEST_INTERRUPT_NONE;
+
+	if (0 == strcmp(str, "merge"))
+		return ZBX_COLUMN_TEST_INTERRUPT_MERGE;
+
+	if (0 == strcmp(str, "publish"))
+		return ZBX_COLUMN_TEST_INTERRUPT_PUBLISH;
+
+	fail_msg("Unknown compaction interrupt stage \"%s\"", str);
+
+	return FAIL;
+}
+
+static void	check_values(zbx_history_iface_t *hist, zbx_mock_handle_t hread)
+{
+	zbx_vector_history_record_t	values;
+	zbx_mock_handle_t		hvalues, hvalue;
+	zbx_mock_error_t		err;
+	zbx_timespec_t			start, end, ts;
+	history_value_t			value;
+	int				i = 0;
+
+	zbx_history_record_vector_create(&values);
+
+	read_timespec(zbx_mock_get_object_member_string(hread, "start"), &start);
+	read_timespec(zbx_mock_get_object_member_string(hread, "end"), &end);
+
+	zbx_mock_assert_result_eq("get_values result", SUCCEED, hist->get_values(hist,
+			zbx_mock_get_object_member_uint64(hread, "itemid"), start.sec, 0, end.sec, &values));
+
+	hvalues = zbx_mock_get_object_member_handle(hread, "values");
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = zbx_mock_vector_element(hvalues, &hvalue)))
+	{
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("Cannot read value: %s", zbx_mock_error_string(err));
+
+		if (i >= values.values_num)
+			fail_msg("Expected more than %d values", values.values_num);
+
+		read_value(hvalue, hist->value_type, &ts, &value);
+		zbx_mock_assert_timespec_eq("value timestamp", &ts, &values.values[i].timestamp);
+
+		if (ITEM_VALUE_TYPE_FLOAT == hist->value_type)
+			zbx_mock_assert_double_eq("float value", value.dbl, values.values[i].value.dbl);
+		else
+			zbx_mock_assert_uint64_eq("unsigned value", value.ui64, values.values[i].value.ui64);
+
+		i++;
+	}
+
+	zbx_mock_assert_int_eq("number of values", i, values.values_num);
+
+	zbx_history_record_vector_destroy(&values, hist->value_type);
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_history_iface_t	hist;
+	zbx_mock_handle_t	hsteps, hstep, hreads, hread, handle;
+	zbx_mock_error_t	err;
+	char			path[] = "/tmp/zbx_column_XXXXXX", *error = NULL;
+	const char		*op;
+	int			readable, stored;
+
+	ZBX_UNUSED(state);
+
+	if (NULL == mkdtemp(path))
+		fail_msg("Cannot create history directory: %s", zbx_strerror(errno));
+
+	zbx_mock_set_real_dir(path);
+	CONFIG_HISTORY_LOCAL_PATH = path;
+	memset(&hist, 0, sizeof(hist));
+
+	if (SUCCEED != zbx_history_column_init(&hist, zbx_mock_str_to_value_type(
+			zbx_mock_get_parameter_string("in.value_type")), &error))
+	{
+		fail_msg("Cannot initialize history storage: %s", error);
+	}
+
+	hsteps = zbx_mock_get_parameter_handle("in.steps");
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = zbx_mock_vector_element(hsteps, &hstep)))
+	{
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("Cannot read step: %s", zbx_mock_error_string(err));
+
+		op = zbx_mock_get_object_member_string(hstep, "op");
+
+		if (0 == strcmp(op, "write"))
+		{
+			if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hstep, "compact", &handle))
+			{
+				const char	*compact;
+
+				if (ZBX_MOCK_SUCCESS != (err = zbx_mock_string(handle, &compact)))
+					fail_msg("Cannot read compaction mode: %s", zbx_mock_error_string(err));
+
+				if (0 != strcmp(compact, "during"))
+					fail_msg("Unknown compaction mode \"%s\"", compact);
+
+				compact_on_lock = &hist;
+			}
+
+			write_values(&hist, zbx_mock_get_object_member_handle(hstep, "values"));
+			compact_on_lock = NULL;
+		}
+		else if (0 == strcmp(op, "tear"))
+		{
+			zbx_column_test_tear(&hist);
+		}
+		else if (0 == strcmp(op, "compact"))
+		{
+			const char	*interrupt = "no";
+
+			if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hstep, "interrupt", &handle) &&
+					ZBX_MOCK_SUCCESS != (err = zbx_mock_string(handle, &interrupt)))
+			{
+				fail_msg("Cannot read interrupt stage: %s", zbx_mock_error_string(err));
+			}
+
+			zbx_column_test_compact(&hist, str_to_interrupt(interrupt));
+		}
+		else
+			fail_msg("Unknown step operation \"%s\"", op);
+
+		zbx_column_test_count_files(&hist, &readable, &stored);
+
+		if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hstep, "files", &handle))
+		{
+			zbx_mock_assert_int_eq("readable files", (int)zbx_mock_get_object_member_uint64(hstep,
+					"files"), readable);
+		}
+
+		if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hstep, "stored", &handle))
+		{
+			zbx_mock_assert_int_eq("stored files", (int)zbx_mock_get_object_member_uint64(hstep,
+					"stored"), stored);
+		}
+	}
+
+	hreads = zbx_mock_get_parameter_handle("out.reads");
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = zbx_mock_vector_element(hreads, &hread)))
+	{
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("Cannot read request: %s", zbx_mock_error_string(err));
+
+		check_values(&hist, hread);
+	}
+
+	zbx_column_test_clear(&hist);
+	hist.destroy(&hist);
+	rmdir(path);
+	zbx_mock_set_real_dir(NULL);
+}
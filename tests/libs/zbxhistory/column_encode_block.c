@@ -0,0 +1,168 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2019 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "common.h"
+#include "zbxalgo.h"
+#include "zbxhistory.h"
+#include "history.h"
+#include "history_column_test.h"
+
+int	__wrap_zbx_history_sql_init(zbx_history_iface_t *hist, unsigned char value_type, char **error);
+int	__wrap_zbx_history_elastic_init(zbx_history_iface_t *hist, unsigned char value_type, char **error);
+
+int	__wrap_zbx_history_sql_init(zbx_history_iface_t *hist, unsigned char value_type, char **error)
+{
+	ZBX_UNUSED(hist);
+	ZBX_UNUSED(value_type);
+	ZBX_UNUSED(error);
+
+	return SUCCEED;
+}
+
+int	__wrap_zbx_history_elastic_init(zbx_history_iface_t *hist, unsigned char value_type, char **error)
+{
+	ZBX_UNUSED(hist);
+	ZBX_UNUSED(value_type);
+	ZBX_UNUSED(error);
+
+	return SUCCEED;
+}
+
+static void	read_values(zbx_mock_handle_t handle, unsigned char value_type, zbx_vector_history_record_t *values)
+{
+	zbx_mock_handle_t	hvalue;
+	zbx_mock_error_t	err;
+	zbx_history_record_t	record;
+	const char		*str;
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = zbx_mock_vector_element(handle, &hvalue)))
+	{
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("Cannot read value: %s", zbx_mock_error_string(err));
+
+		str = zbx_mock_get_object_member_string(hvalue, "ts");
+		if (ZBX_MOCK_SUCCESS != (err = zbx_strtime_to_timespec(str, &record.timestamp)))
+			fail_msg("Invalid value timestamp \"%s\": %s", str, zbx_mock_error_string(err));
+
+		str = zbx_mock_get_object_member_string(hvalue, "value");
+
+		if (ITEM_VALUE_TYPE_FLOAT == value_type)
+			record.value.dbl = atof(str);
+		else if (SUCCEED != is_uint64(str, &record.value.ui64))
+			fail_msg("Invalid unsigned value \"%s\"", str);
+
+		zbx_vector_history_record_append_ptr(values, &record);
+	}
+}
+
+static int	read_clock(const char *path, int default_clock)
+{
+	zbx_mock_handle_t	handle;
+	zbx_timespec_t		ts;
+	zbx_mock_error_t	err;
+	const char		*str;
+
+	if (ZBX_MOCK_SUCCESS != zbx_mock_parameter(path, &handle))
+		return default_clock;
+
+	if (ZBX_MOCK_SUCCESS != (err = zbx_mock_string(handle, &str)) ||
+			ZBX_MOCK_SUCCESS != (err = zbx_strtime_to_timespec(str, &ts)))
+	{
+		fail_msg("Invalid parameter \"%s\": %s", path, zbx_mock_error_string(err));
+	}
+
+	return ts.sec;
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_vector_history_record_t	values, decoded, expected;
+	unsigned char			value_type, *data;
+	size_t				size, truncate = 0;
+	int				i, ret, start, end;
+	zbx_mock_handle_t		handle;
+
+	ZBX_UNUSED(state);
+
+	zbx_history_record_vector_create(&values);
+	zbx_history_record_vector_create(&decoded);
+	zbx_history_record_vector_create(&expected);
+
+	value_type = zbx_mock_str_to_value_type(zbx_mock_get_parameter_string("in.value_type"));
+	read_values(zbx_mock_get_parameter_handle("in.values"), value_type, &values);
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_parameter("in.truncate", &handle))
+		truncate = (size_t)zbx_mock_get_parameter_uint64("in.truncate");
+
+	start = read_clock("in.start", 0);
+	end = read_clock("in.end", ZBX_JAN_2038);
+
+	size = zbx_column_test_encode(value_type, &values, &data);
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_parameter("out.size", &handle))
+		zbx_mock_assert_uint64_eq("encoded size", zbx_mock_get_parameter_uint64("out.size"), size);
+
+	ret = zbx_column_test_decode(value_type, data, size - truncate, values.values_num,
+			values.values[0].timestamp.sec, start, end, &decoded);
+
+	zbx_mock_assert_result_eq("decode result", zbx_mock_str_to_return_code(
+			zbx_mock_get_parameter_string("out.return")), ret);
+
+	if (SUCCEED == ret)
+	{
+		if (ZBX_MOCK_SUCCESS == zbx_mock_parameter("out.values", &handle))
+			read_values(handle, value_type, &expected);
+		else
+			zbx_vector_history_record_append_array(&expected, values.values, values.values_num);
+
+		zbx_mock_assert_int_eq("number of decoded values", expected.values_num, decoded.values_num);
+
+		for (i = 0; i < expected.values_num; i++)
+		{
+			zbx_mock_assert_timespec_eq("value timestamp", &expected.values[i].timestamp,
+					&decoded.values[i].timestamp);
+
+			if (ITEM_VALUE_TYPE_FLOAT == value_type)
+			{
+				zbx_uint64_t	expected_bits, decoded_bits;
+
+				/* floating point values must be restored exactly */
+				memcpy(&expected_bits, &expected.values[i].value.dbl, sizeof(expected_bits));
+				memcpy(&decoded_bits, &decoded.values[i].value.dbl, sizeof(decoded_bits));
+				zbx_mock_assert_uint64_eq("float value", expected_bits, decoded_bits);
+			}
+			else
+			{
+				zbx_mock_assert_uint64_eq("unsigned value", expected.values[i].value.ui64,
+						decoded.values[i].value.ui64);
+			}
+		}
+	}
+
+	zbx_free(data);
+	zbx_vector_history_record_destroy(&expected);
+	zbx_vector_history_record_destroy(&decoded);
+	zbx_vector_history_record_destroy(&values);
+}
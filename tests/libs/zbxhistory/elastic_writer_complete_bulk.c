@@ -0,0 +1,216 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2019 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "common.h"
+#include "zbxalgo.h"
+#include "zbxhistory.h"
+#include "history.h"
+#include "history_elastic_test.h"
+
+#if defined(HAVE_LIBCURL) && LIBCURL_VERSION_NUM >= 0x071c00
+
+static time_t	mock_time;
+
+int	__wrap_zbx_history_sql_init(zbx_history_iface_t *hist, unsigned char value_type, char **error);
+int	__wrap_zbx_history_column_init(zbx_history_iface_t *hist, unsigned char value_type, char **error);
+time_t	__wrap_time(time_t *ptr);
+
+int	__wrap_zbx_history_sql_init(zbx_history_iface_t *hist, unsigned char value_type, char **error)
+{
+	ZBX_UNUSED(hist);
+	ZBX_UNUSED(value_type);
+	ZBX_UNUSED(error);
+
+	return SUCCEED;
+}
+
+int	__wrap_zbx_history_column_init(zbx_history_iface_t *hist, unsigned char value_type, char **error)
+{
+	ZBX_UNUSED(hist);
+	ZBX_UNUSED(value_type);
+	ZBX_UNUSED(error);
+
+	return SUCCEED;
+}
+
+time_t	__wrap_time(time_t *ptr)
+{
+	if (NULL != ptr)
+		*ptr = mock_time;
+
+	return mock_time;
+}
+
+static CURLcode	mock_str_to_curl_code(const char *str)
+{
+	if (0 == strcmp(str, "CURLE_OK"))
+		return CURLE_OK;
+
+	if (0 == strcmp(str, "CURLE_COULDNT_CONNECT"))
+		return CURLE_COULDNT_CONNECT;
+
+	if (0 == strcmp(str, "CURLE_OPERATION_TIMEDOUT"))
+		return CURLE_OPERATION_TIMEDOUT;
+
+	if (0 == strcmp(str, "CURLE_HTTP_RETURNED_ERROR"))
+		return CURLE_HTTP_RETURNED_ERROR;
+
+	fail_msg("Unknown cURL result \"%s\"", str);
+
+	return CURLE_OK;
+}
+
+static time_t	mock_get_time(zbx_mock_handle_t handle, const char *key)
+{
+	zbx_timespec_t	ts;
+
+	if (ZBX_MOCK_SUCCESS != zbx_strtime_to_timespec(zbx_mock_get_object_member_string(handle, key), &ts))
+		fail_msg("Cannot read \"%s\" timestamp", key);
+
+	return ts.sec;
+}
+
+/* documents are listed without the terminating newline of bulk api lines */
+static void	mock_read_docs(zbx_mock_handle_t hdocs, zbx_vector_str_t *docs)
+{
+	zbx_mock_handle_t	hdoc;
+	const char		*doc;
+
+	while (ZBX_MOCK_END_OF_VECTOR != zbx_mock_vector_element(hdocs, &hdoc))
+	{
+		if (ZBX_MOCK_SUCCESS != zbx_mock_string(hdoc, &doc))
+			fail_msg("Cannot read document");
+
+		zbx_vector_str_append(docs, zbx_dsprintf(NULL, "%s\n", doc));
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_mock_test_entry                                              *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_mock_handle_t	hrequests, hrequest, hmember, hdelayed, hbulk, hsteps, hstep;
+	zbx_vector_str_t	docs, expected;
+	const char		*response;
+	time_t			retry_time;
+	int			i, index = 0, inflight_num, delayed_num;
+	char			buffer[MAX_STRING_LEN];
+
+	ZBX_UNUSED(state);
+
+	zbx_vector_str_create(&docs);
+	zbx_vector_str_create(&expected);
+
+	mock_time = mock_get_time(zbx_mock_get_parameter_handle("in"), "time");
+	zbx_elastic_writer_test_init();
+
+	/* complete the sent bulk requests */
+
+	hrequests = zbx_mock_get_parameter_handle("in.requests");
+
+	while (ZBX_MOCK_END_OF_VECTOR != zbx_mock_vector_element(hrequests, &hrequest))
+	{
+		long int	http_code = 0;
+
+		mock_read_docs(zbx_mock_get_object_member_handle(hrequest, "docs"), &docs);
+
+		if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hrequest, "http code", &hmember))
+			http_code = atol(zbx_mock_get_object_member_string(hrequest, "http code"));
+
+		if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hrequest, "response", &hmember))
+			response = zbx_mock_get_object_member_string(hrequest, "response");
+		else
+			response = NULL;
+
+		zbx_elastic_writer_test_complete(&docs,
+				mock_str_to_curl_code(zbx_mock_get_object_member_string(hrequest, "result")), http_code,
+				response);
+
+		zbx_vector_str_clear_ext(&docs, zbx_str_free);
+	}
+
+	/* check the requests scheduled for resending, in order */
+
+	hdelayed = zbx_mock_get_parameter_handle("out.delayed");
+
+	while (ZBX_MOCK_END_OF_VECTOR != zbx_mock_vector_element(hdelayed, &hbulk))
+	{
+		if (SUCCEED != zbx_elastic_writer_test_get_delayed(index, &docs, &retry_time))
+			fail_msg("Expected delayed bulk request #%d", index);
+
+		mock_read_docs(zbx_mock_get_object_member_handle(hbulk, "docs"), &expected);
+
+		zbx_snprintf(buffer, sizeof(buffer), "delayed bulk request #%d documents", index);
+		zbx_mock_assert_int_eq(buffer, expected.values_num, docs.values_num);
+
+		for (i = 0; i < docs.values_num; i++)
+			zbx_mock_assert_str_eq(buffer, expected.values[i], docs.values[i]);
+
+		zbx_snprintf(buffer, sizeof(buffer), "delayed bulk request #%d retry time", index);
+		zbx_mock_assert_time_eq(buffer, mock_get_time(hbulk, "retry"), retry_time);
+
+		zbx_vector_str_clear_ext(&docs, zbx_str_free);
+		zbx_vector_str_clear_ext(&expected, zbx_str_free);
+		index++;
+	}
+
+	if (SUCCEED == zbx_elastic_writer_test_get_delayed(index, &docs, &retry_time))
+		fail_msg("Unexpected delayed bulk request #%d", index);
+
+	/* check that delayed requests are resent only after the retry delay */
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_parameter("out.resend", &hsteps))
+	{
+		while (ZBX_MOCK_END_OF_VECTOR != zbx_mock_vector_element(hsteps, &hstep))
+		{
+			zbx_elastic_writer_test_start_delayed(mock_get_time(hstep, "time"), &inflight_num,
+					&delayed_num);
+
+			zbx_mock_assert_int_eq("inflight requests",
+					atoi(zbx_mock_get_object_member_string(hstep, "inflight")), inflight_num);
+			zbx_mock_assert_int_eq("delayed requests",
+					atoi(zbx_mock_get_object_member_string(hstep, "delayed")), delayed_num);
+		}
+	}
+
+	zbx_elastic_writer_test_release();
+
+	zbx_vector_str_destroy(&expected);
+	zbx_vector_str_destroy(&docs);
+}
+
+#else
+
+void	zbx_mock_test_entry(void **state)
+{
+	ZBX_UNUSED(state);
+
+	skip();
+}
+
+#endif
@@ -0,0 +1,241 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2019 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+
+#include "history_column_test.h"
+
+static void	column_test_get_dirs(const zbx_column_data_t *data, zbx_vector_str_t *dirs)
+{
+	zbx_vector_uint64_t	partitions;
+	int			i;
+
+	zbx_vector_uint64_create(&partitions);
+	column_get_partitions(data, &partitions);
+
+	for (i = 0; i < partitions.values_num; i++)
+		zbx_vector_str_append(dirs, zbx_dsprintf(NULL, "%s/" ZBX_FS_UI64, data->path, partitions.values[i]));
+
+	zbx_vector_uint64_destroy(&partitions);
+}
+
+size_t	zbx_column_test_encode(unsigned char value_type, const zbx_vector_history_record_t *records,
+		unsigned char **data)
+{
+	zbx_column_buf_t	buf = {0};
+
+	column_encode_block(&buf, value_type, records->values, records->values_num);
+	*data = buf.data;
+
+	return buf.offset;
+}
+
+int	zbx_column_test_decode(unsigned char value_type, const unsigned char *data, size_t size, int values_num,
+		int clock_min, int start, int end, zbx_vector_history_record_t *values)
+{
+	zbx_column_item_t	item;
+
+	memset(&item, 0, sizeof(item));
+	item.size = (zbx_uint32_t)size;
+	item.values_num = (zbx_uint32_t)values_num;
+	item.clock_min = clock_min;
+
+	return column_decode_block(value_type, data, &item, start, end, values);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_column_test_compact                                          *
+ *                                                                            *
+ * Purpose: compacts all partitions, optionally simulating compaction         *
+ *          interrupted by a crash                                            *
+ *                                                                            *
+ * Parameters: hist      - [IN] the history storage interface                 *
+ *             interrupt - [IN] the compaction stage to interrupt, see        *
+ *                              ZBX_COLUMN_TEST_INTERRUPT_* defines           *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_column_test_compact(zbx_history_iface_t *hist, int interrupt)
+{
+	zbx_column_data_t	*data = (zbx_column_data_t *)hist->data;
+	zbx_vector_str_t	dirs, files;
+	char			*src = NULL, *dst = NULL;
+	int			i, j, fd;
+
+	zbx_vector_str_create(&dirs);
+	zbx_vector_str_create(&files);
+	column_test_get_dirs(data, &dirs);
+
+	for (i = 0; i < dirs.values_num; i++)
+	{
+		column_get_files(dirs.values[i], &files);
+
+		switch (interrupt)
+		{
+			case ZBX_COLUMN_TEST_INTERRUPT_MERGE:
+				/* sources were renamed, the compacted file was being written */
+				for (j = 0; j < files.values_num; j++)
+				{
+					if (SUCCEED == column_is_merging_file(files.values[j]))
+						continue;
+
+					src = zbx_dsprintf(src, "%s/%s", dirs.values[i], files.values[j]);
+					dst = zbx_dsprintf(dst, "%s" ZBX_COLUMN_MERGE_EXT, src);
+					rename(src, dst);
+				}
+
+				dst = zbx_dsprintf(dst, "%s/" ZBX_COLUMN_COMPACT_TMP, dirs.values[i]);
+
+				if (-1 != (fd = open(dst, O_WRONLY | O_CREAT | O_TRUNC, 0640)))
+				{
+					column_write(fd, "ZHC1", 4);
+					close(fd);
+				}
+				break;
+			case ZBX_COLUMN_TEST_INTERRUPT_PUBLISH:
+				/* the compacted file was published, sources were not removed */
+				for (j = 0; j < files.values_num; j++)
+				{
+					src = zbx_dsprintf(src, "%s/%s", dirs.values[i], files.values[j]);
+					dst = zbx_dsprintf(dst, "%s.keep", src);
+					link(src, dst);
+				}
+
+				column_compact_partition(hist->value_type, dirs.values[i]);
+
+				for (j = 0; j < files.values_num; j++)
+				{
+					src = zbx_dsprintf(src, "%s/%s.keep", dirs.values[i], files.values[j]);
+					dst = zbx_dsprintf(dst, "%s/%s%s", dirs.values[i], files.values[j],
+							SUCCEED == column_is_merging_file(files.values[j]) ? "" :
+							ZBX_COLUMN_MERGE_EXT);
+					rename(src, dst);
+				}
+				break;
+			default:
+				column_compact_partition(hist->value_type, dirs.values[i]);
+		}
+
+		zbx_vector_str_clear_ext(&files, zbx_str_free);
+	}
+
+	zbx_free(src);
+	zbx_free(dst);
+	zbx_vector_str_destroy(&files);
+	zbx_vector_str_clear_ext(&dirs, zbx_str_free);
+	zbx_vector_str_destroy(&dirs);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_column_test_count_files                                      *
+ *                                                                            *
+ * Purpose: counts data files of all partitions                               *
+ *                                                                            *
+ * Parameters: hist     - [IN] the history storage interface                  *
+ *             readable - [OUT] the number of files read by readers           *
+ *             stored   - [OUT] the number of files on disk                   *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_column_test_count_files(zbx_history_iface_t *hist, int *readable, int *stored)
+{
+	zbx_column_data_t	*data = (zbx_column_data_t *)hist->data;
+	zbx_vector_str_t	dirs, files;
+	int			i;
+
+	*readable = 0;
+	*stored = 0;
+
+	zbx_vector_str_create(&dirs);
+	zbx_vector_str_create(&files);
+	column_test_get_dirs(data, &dirs);
+
+	for (i = 0; i < dirs.values_num; i++)
+	{
+		column_get_files(dirs.values[i], &files);
+		*stored += files.values_num;
+
+		column_skip_merged(dirs.values[i], &files, 0);
+		*readable += files.values_num;
+
+		zbx_vector_str_clear_ext(&files, zbx_str_free);
+	}
+
+	zbx_vector_str_destroy(&files);
+	zbx_vector_str_clear_ext(&dirs, zbx_str_free);
+	zbx_vector_str_destroy(&dirs);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_column_test_tear                                             *
+ *                                                                            *
+ * Purpose: appends a torn chunk to the files written by this process,        *
+ *          simulating a crash while the chunk was being written              *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_column_test_tear(zbx_history_iface_t *hist)
+{
+	zbx_column_data_t	*data = (zbx_column_data_t *)hist->data;
+	zbx_vector_str_t	dirs;
+	zbx_column_chunk_t	chunk;
+	char			*filename = NULL;
+	int			i, fd;
+
+	zbx_vector_str_create(&dirs);
+	column_test_get_dirs(data, &dirs);
+
+	chunk.magic = ZBX_COLUMN_CHUNK_MAGIC;
+	chunk.items_num = 1;
+	chunk.size = ZBX_KIBIBYTE;
+	chunk.table_offset = chunk.size - sizeof(zbx_column_item_t);
+
+	for (i = 0; i < dirs.values_num; i++)
+	{
+		filename = zbx_dsprintf(filename, "%s/%d" ZBX_COLUMN_FILE_EXT, dirs.values[i], (int)getpid());
+
+		if (-1 == (fd = open(filename, O_WRONLY | O_APPEND)))
+			continue;
+
+		column_write(fd, &chunk, sizeof(chunk));
+		column_write(fd, "torn", 4);
+		close(fd);
+	}
+
+	zbx_free(filename);
+	zbx_vector_str_clear_ext(&dirs, zbx_str_free);
+	zbx_vector_str_destroy(&dirs);
+}
+
+void	zbx_column_test_clear(zbx_history_iface_t *hist)
+{
+	zbx_column_data_t	*data = (zbx_column_data_t *)hist->data;
+	zbx_vector_str_t	dirs;
+	int			i;
+
+	zbx_vector_str_create(&dirs);
+	column_test_get_dirs(data, &dirs);
+
+	for (i = 0; i < dirs.values_num; i++)
+		column_remove_dir(dirs.values[i]);
+
+	rmdir(data->path);
+
+	zbx_vector_str_clear_ext(&dirs, zbx_str_free);
+	zbx_vector_str_destroy(&dirs);
+}
@@ -0,0 +1,37 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2019 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+
+#ifndef ZABBIX_HISTORY_COLUMN_TEST_H
+#define ZABBIX_HISTORY_COLUMN_TEST_H
+
+#define ZBX_COLUMN_TEST_INTERRUPT_NONE		0
+#define ZBX_COLUMN_TEST_INTERRUPT_MERGE		1
+#define ZBX_COLUMN_TEST_INTERRUPT_PUBLISH	2
+
+size_t	zbx_column_test_encode(unsigned char value_type, const zbx_vector_history_record_t *records,
+		unsigned char **data);
+int	zbx_column_test_decode(unsigned char value_type, const unsigned char *data, size_t size, int values_num,
+		int clock_min, int start, int end, zbx_vector_history_record_t *values);
+void	zbx_column_test_compact(zbx_history_iface_t *hist, int interrupt);
+void	zbx_column_test_count_files(zbx_history_iface_t *hist, int *readable, int *stored);
+void	zbx_column_test_tear(zbx_history_iface_t *hist);
+void	zbx_column_test_clear(zbx_history_iface_t *hist);
+
+#endif
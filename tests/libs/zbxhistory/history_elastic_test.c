@@ -0,0 +1,83 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2019 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+
+#include "history_elastic_test.h"
+
+void	zbx_elastic_writer_test_init(void)
+{
+	elastic_writer_init();
+}
+
+void	zbx_elastic_writer_test_release(void)
+{
+	elastic_writer_release();
+}
+
+void	zbx_elastic_writer_test_complete(const zbx_vector_str_t *docs, CURLcode result, long int http_code,
+		const char *response)
+{
+	zbx_elastic_bulk_t	*bulk;
+	int			i;
+
+	bulk = elastic_bulk_create("http://localhost/_bulk");
+
+	for (i = 0; i < docs->values_num; i++)
+		elastic_bulk_add_doc(bulk, docs->values[i], strlen(docs->values[i]));
+
+	if (NULL != response)
+	{
+		bulk->page.data = zbx_strdup(NULL, response);
+		bulk->page.alloc = strlen(response) + 1;
+		bulk->page.offset = bulk->page.alloc - 1;
+	}
+
+	elastic_writer_complete_bulk(bulk, result, http_code);
+}
+
+int	zbx_elastic_writer_test_get_delayed(int index, zbx_vector_str_t *docs, time_t *retry_time)
+{
+	zbx_elastic_bulk_t	*bulk;
+	int			i;
+
+	if (index >= writer.delayed.values_num)
+		return FAIL;
+
+	bulk = (zbx_elastic_bulk_t *)writer.delayed.values[index];
+
+	for (i = 0; i < bulk->docs_num; i++)
+	{
+		size_t	end = (i + 1 < bulk->docs_num ? bulk->docs[i + 1] : bulk->body_offset);
+
+		zbx_vector_str_append(docs, zbx_dsprintf(NULL, "%.*s", (int)(end - bulk->docs[i]),
+				bulk->body + bulk->docs[i]));
+	}
+
+	*retry_time = bulk->retry_time;
+
+	return SUCCEED;
+}
+
+void	zbx_elastic_writer_test_start_delayed(time_t now, int *inflight_num, int *delayed_num)
+{
+	elastic_writer_start_delayed(now);
+
+	*inflight_num = writer.inflight.values_num;
+	*delayed_num = writer.delayed.values_num;
+}
@@ -0,0 +1,35 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2019 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+
+#ifndef ZABBIX_HISTORY_ELASTIC_TEST_H
+#define ZABBIX_HISTORY_ELASTIC_TEST_H
+
+#if defined(HAVE_LIBCURL) && LIBCURL_VERSION_NUM >= 0x071c00
+
+void	zbx_elastic_writer_test_init(void);
+void	zbx_elastic_writer_test_release(void);
+void	zbx_elastic_writer_test_complete(const zbx_vector_str_t *docs, CURLcode result, long int http_code,
+		const char *response);
+int	zbx_elastic_writer_test_get_delayed(int index, zbx_vector_str_t *docs, time_t *retry_time);
+void	zbx_elastic_writer_test_start_delayed(time_t now, int *inflight_num, int *delayed_num);
+
+#endif
+
+#endif
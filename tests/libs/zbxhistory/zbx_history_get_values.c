@@ -26,6 +26,7 @@
 #include "common.h"
 #include "zbxalgo.h"
 #include "zbxhistory.h"
+#include "dbcache.h"
 #include "zbxdb.h"
 #include "db.h"
 
@@ -40,6 +41,8 @@ int	__wrap_zbx_add_event(unsigned char source, unsigned char object, zbx_uint64_
 		unsigned char trigger_value, const char *trigger_opdata, const char *error);
 int	__wrap_zbx_process_events(zbx_vector_ptr_t *trigger_diff, zbx_vector_uint64_t *triggerids_lock);
 void	__wrap_zbx_clean_events(void);
+void	__wrap_zbx_config_get(zbx_config_t *cfg, zbx_uint64_t flags);
+void	__wrap_zbx_config_clean(zbx_config_t *cfg);
 void	zbx_vcmock_read_values(zbx_mock_handle_t hdata, unsigned char value_type, zbx_vector_history_record_t *values);
 void	zbx_vcmock_check_records(const char *prefix, unsigned char value_type,
 		const zbx_vector_history_record_t *expected_values, const zbx_vector_history_record_t *returned_values);
@@ -100,6 +103,17 @@ void	__wrap_zbx_clean_events(void)
 {
 }
 
+void	__wrap_zbx_config_get(zbx_config_t *cfg, zbx_uint64_t flags)
+{
+	ZBX_UNUSED(flags);
+	memset(cfg, 0, sizeof(zbx_config_t));
+}
+
+void	__wrap_zbx_config_clean(zbx_config_t *cfg)
+{
+	ZBX_UNUSED(cfg);
+}
+
 /******************************************************************************
  *                                                                            *
  * Function: zbx_vcmock_history_dump                                          *
@@ -295,6 +309,85 @@ static int	vc_history_record_compare_desc_func(const zbx_history_record_t *d1, c
 	return d2->timestamp.sec - d1->timestamp.sec;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: vcmock_get_values_multi                                          *
+ *                                                                            *
+ * Purpose: reads history of multiple items with zbx_history_get_values_multi *
+ *          and checks the values returned for each request                   *
+ *                                                                            *
+ ******************************************************************************/
+static void	vcmock_get_values_multi(zbx_mock_handle_t hrequests)
+{
+	int				err, value_type, i;
+	zbx_mock_handle_t		hrequest;
+	zbx_timespec_t			ts;
+	zbx_vector_ptr_t		requests;
+	zbx_history_request_t		*request;
+	zbx_vector_history_record_t	values_expected;
+	char				buffer[MAX_STRING_LEN];
+
+	value_type = zbx_mock_str_to_value_type(zbx_mock_get_parameter_string("in['value type']"));
+	zbx_vector_ptr_create(&requests);
+
+	while (ZBX_MOCK_END_OF_VECTOR != zbx_mock_vector_element(hrequests, &hrequest))
+	{
+		request = (zbx_history_request_t *)zbx_malloc(NULL, sizeof(zbx_history_request_t));
+		request->itemid = zbx_mock_get_object_member_uint64(hrequest, "itemid");
+		zbx_strtime_to_timespec(zbx_mock_get_object_member_string(hrequest, "start"), &ts);
+		request->start = ts.sec;
+		zbx_strtime_to_timespec(zbx_mock_get_object_member_string(hrequest, "end"), &ts);
+		request->end = ts.sec;
+		zbx_history_record_vector_create(&request->values);
+		zbx_vector_ptr_append(&requests, request);
+	}
+
+	err = zbx_history_get_values_multi(value_type, &requests);
+	zbx_mock_assert_result_eq("zbx_history_get_values_multi()", SUCCEED, err);
+
+	/* requests are reordered by history backend, so read the expected values again in input order */
+	i = 0;
+	zbx_history_record_vector_create(&values_expected);
+	hrequests = zbx_mock_get_parameter_handle("in.requests");
+
+	while (ZBX_MOCK_END_OF_VECTOR != zbx_mock_vector_element(hrequests, &hrequest))
+	{
+		int	j;
+
+		for (j = 0; j < requests.values_num; j++)
+		{
+			request = (zbx_history_request_t *)requests.values[j];
+
+			if (request->itemid == zbx_mock_get_object_member_uint64(hrequest, "itemid"))
+				break;
+		}
+
+		if (j == requests.values_num)
+			fail_msg("Request #%d was not found", i);
+
+		zbx_vector_history_record_sort(&request->values,
+				(zbx_compare_func_t)vc_history_record_compare_desc_func);
+
+		zbx_vcmock_read_values(zbx_mock_get_object_member_handle(hrequest, "values"), value_type,
+				&values_expected);
+		zbx_snprintf(buffer, sizeof(buffer), "Returned values of item " ZBX_FS_UI64, request->itemid);
+		zbx_vcmock_check_records(buffer, value_type, &values_expected, &request->values);
+		zbx_history_record_vector_clean(&values_expected, value_type);
+		i++;
+	}
+
+	zbx_history_record_vector_destroy(&values_expected, value_type);
+
+	for (i = 0; i < requests.values_num; i++)
+	{
+		request = (zbx_history_request_t *)requests.values[i];
+		zbx_history_record_vector_destroy(&request->values, value_type);
+		zbx_free(request);
+	}
+
+	zbx_vector_ptr_destroy(&requests);
+}
+
 /******************************************************************************
  *                                                                            *
  * Function: zbx_mock_test_entry                                              *
@@ -307,6 +400,7 @@ void	zbx_mock_test_entry(void **state)
 	zbx_uint64_t			itemid;
 	zbx_timespec_t			ts;
 	zbx_vector_history_record_t	values_received, values_expected;
+	zbx_mock_handle_t		hrequests;
 
 	ZBX_UNUSED(state);
 
@@ -315,6 +409,12 @@ void	zbx_mock_test_entry(void **state)
 	err = zbx_history_init(&error);
 	zbx_mock_assert_result_eq("zbx_history_init()", SUCCEED, err);
 
+	if (ZBX_MOCK_SUCCESS == zbx_mock_parameter("in.requests", &hrequests))
+	{
+		vcmock_get_values_multi(hrequests);
+		goto out;
+	}
+
 	if (FAIL == is_uint64(zbx_mock_get_parameter_string("in.itemid"), &itemid))
 		fail_msg("Invalid itemid value");
 
@@ -338,7 +438,7 @@ void	zbx_mock_test_entry(void **state)
 
 	zbx_history_record_vector_destroy(&values_expected, value_type);
 	zbx_history_record_vector_destroy(&values_received, value_type);
-
+out:
 	zbx_history_destroy();
 
 	zbx_mockdb_destroy();
@@ -55,7 +55,7 @@ void	zbx_mock_test_entry(void **state)
 {
 	const char		*data, *path;
 	struct zbx_json_parse	jp;
-	char			*output = NULL;
+	char			*output = NULL, *output_cached = NULL;
 	int			expected_ret, returned_ret;
 	zbx_mock_handle_t	handle;
 
@@ -96,5 +96,21 @@ void	zbx_mock_test_entry(void **state)
 	else
 		zbx_mock_assert_str_ne("tzbx_jsonpath_query() error", "", zbx_json_strerror());
 
+	/* repeated query must use cached jsonpath and return the same result */
+	zbx_set_json_strerror("%s", "");
+	returned_ret = zbx_jsonpath_query(&jp, path, &output_cached);
+	zbx_mock_assert_result_eq("cached zbx_jsonpath_query() return value", expected_ret, returned_ret);
+
+	if (SUCCEED == returned_ret)
+	{
+		if (NULL != output)
+			zbx_mock_assert_str_eq("Cached query result", output, output_cached);
+		else
+			zbx_mock_assert_ptr_eq("Cached query result", NULL, output_cached);
+	}
+	else
+		zbx_mock_assert_str_ne("cached zbx_jsonpath_query() error", "", zbx_json_strerror());
+
+	zbx_free(output_cached);
 	zbx_free(output);
 }
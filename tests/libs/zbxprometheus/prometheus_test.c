@@ -75,9 +75,10 @@ int	zbx_prometheus_filter_parse(const char *data, zbx_prometheus_condition_test_
 int	zbx_prometheus_row_parse(const char *data, char **metric, zbx_vector_ptr_pair_t *labels, char **value,
 		zbx_strloc_t *loc, char **error)
 {
-	zbx_prometheus_filter_t	filter;
-	int			i;
-	zbx_prometheus_row_t	*prow;
+	zbx_prometheus_filter_t		filter;
+	int				i, ret;
+	zbx_prometheus_row_t		*prow;
+	zbx_prometheus_row_buf_t	row;
 
 	if (FAIL == prometheus_filter_init(&filter, "", error))
 	{
@@ -85,7 +86,11 @@ int	zbx_prometheus_row_parse(const char *data, char **metric, zbx_vector_ptr_pai
 		return FAIL;
 	}
 
-	if (FAIL == prometheus_parse_row(&filter, data, 0, &prow, loc, error))
+	prometheus_row_buf_init(&row);
+	ret = prometheus_parse_row(&filter, data, 0, &row, &prow, loc, error);
+	prometheus_row_buf_clear(&row);
+
+	if (FAIL == ret)
 	{
 		zabbix_log(LOG_LEVEL_DEBUG, "failed to parse prometheus row: %s", *error);
 		return FAIL;
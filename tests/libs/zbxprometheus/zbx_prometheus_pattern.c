@@ -27,9 +27,10 @@
 
 void	zbx_mock_test_entry(void **state)
 {
-	const char	*data, *params, *value_type;
-	char		*ret_err = NULL, *ret_output = NULL;
-	int		ret, expected_ret;
+	const char		*data, *params, *value_type;
+	char			*ret_err = NULL, *ret_output = NULL;
+	int			ret, expected_ret;
+	zbx_prometheus_t	prom;
 
 	ZBX_UNUSED(state);
 
@@ -53,4 +54,24 @@ void	zbx_mock_test_entry(void **state)
 	}
 	else
 		zbx_free(ret_err);
+
+	/* the same pattern must give the same result when matched against indexed data */
+	if (SUCCEED == zbx_prometheus_init(&prom, data, &ret_err))
+	{
+		ret = zbx_prometheus_pattern_ex(&prom, params, value_type, &ret_output, &ret_err);
+		zbx_mock_assert_result_eq("Invalid zbx_prometheus_pattern_ex() return value", expected_ret, ret);
+
+		if (SUCCEED == ret)
+		{
+			zbx_mock_assert_str_eq("Invalid zbx_prometheus_pattern_ex() returned output",
+					zbx_mock_get_parameter_string("out.output"), ret_output);
+			zbx_free(ret_output);
+		}
+		else
+			zbx_free(ret_err);
+
+		zbx_prometheus_clear(&prom);
+	}
+	else
+		zbx_free(ret_err);
 }
@@ -0,0 +1,113 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2019 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxregexp.h"
+
+static int	mock_str_to_match_result(const char *str)
+{
+	if (0 == strcmp(str, "ZBX_REGEXP_MATCH"))
+		return ZBX_REGEXP_MATCH;
+
+	if (0 == strcmp(str, "ZBX_REGEXP_NO_MATCH"))
+		return ZBX_REGEXP_NO_MATCH;
+
+	if (0 == strcmp(str, "FAIL"))
+		return FAIL;
+
+	fail_msg("unknown regexp match result \"%s\"", str);
+
+	return FAIL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: mock_match_generated                                             *
+ *                                                                            *
+ * Purpose: match values against generated patterns in several rounds, so   *
+ *          that the compiled regexps are both reused and evicted from cache  *
+ *                                                                            *
+ ******************************************************************************/
+static void	mock_match_generated(int patterns_num, int rounds)
+{
+	char	pattern[64], value[64];
+	int	i, n;
+
+	for (n = 0; n < rounds; n++)
+	{
+		for (i = 0; i < patterns_num; i++)
+		{
+			zbx_snprintf(pattern, sizeof(pattern), "^value%d$", i);
+
+			zbx_snprintf(value, sizeof(value), "value%d", i);
+			zbx_mock_assert_int_eq(value, ZBX_REGEXP_MATCH, regexp_match_ex(NULL, value, pattern,
+					ZBX_CASE_SENSITIVE));
+
+			zbx_snprintf(value, sizeof(value), "VALUE%d", i);
+			zbx_mock_assert_int_eq(value, ZBX_REGEXP_MATCH, regexp_match_ex(NULL, value, pattern,
+					ZBX_IGNORE_CASE));
+			zbx_mock_assert_int_eq(value, ZBX_REGEXP_NO_MATCH, regexp_match_ex(NULL, value, pattern,
+					ZBX_CASE_SENSITIVE));
+
+			zbx_snprintf(value, sizeof(value), "value%d", i + 1);
+			zbx_mock_assert_int_eq(value, ZBX_REGEXP_NO_MATCH, regexp_match_ex(NULL, value, pattern,
+					ZBX_CASE_SENSITIVE));
+		}
+	}
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	const char		*pattern, *str;
+	zbx_mock_handle_t	hvalues, hvalue;
+	int			case_sensitive, ret, expected_ret;
+
+	ZBX_UNUSED(state);
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_parameter_exists("in.generated"))
+	{
+		mock_match_generated((int)zbx_mock_get_parameter_uint64("in.generated.patterns"),
+				(int)zbx_mock_get_parameter_uint64("in.generated.rounds"));
+		return;
+	}
+
+	pattern = zbx_mock_get_parameter_string("in.pattern");
+
+	if (0 == strcmp(zbx_mock_get_parameter_string("in.case"), "ZBX_IGNORE_CASE"))
+		case_sensitive = ZBX_IGNORE_CASE;
+	else
+		case_sensitive = ZBX_CASE_SENSITIVE;
+
+	hvalues = zbx_mock_get_parameter_handle("out.values");
+
+	while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hvalues, &hvalue))
+	{
+		str = zbx_mock_get_object_member_string(hvalue, "value");
+		expected_ret = mock_str_to_match_result(zbx_mock_get_object_member_string(hvalue, "result"));
+		ret = regexp_match_ex(NULL, str, pattern, case_sensitive);
+
+		if (ret != expected_ret)
+			fail_msg("String \"%s\" match against regexp \"%s\" returned %d instead of %d",
+					str, pattern, ret, expected_ret);
+	}
+}
@@ -0,0 +1,426 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2019 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "common.h"
+#include "zbxalgo.h"
+#include "dbcache.h"
+#include "zbxserver.h"
+#include "valuecache.h"
+#include "valuecache_mock.h"
+
+/*
+ * Trigger evaluation microbenchmark.
+ *
+ * Trigger functions are generated from function templates - function of N-th
+ * trigger and K-th template has functionid N * <templates> + K + 1 and is
+ * calculated for item with the same identifier. Each item has the configured
+ * number of values one second apart, ending at the evaluation time. One more
+ * value is added a second later, so function results are never reused from
+ * function result cache and every iteration evaluates the functions.
+ */
+
+extern zbx_uint64_t	CONFIG_VALUE_CACHE_SIZE;
+
+typedef struct
+{
+	const char	*function;
+	const char	*parameter;
+}
+mock_function_t;
+
+static mock_function_t	*mock_functions;
+static int		mock_functions_num, mock_triggers_num;
+static unsigned char	mock_value_type;
+
+void	__wrap_DCconfig_get_functions_by_functionids(DC_FUNCTION *functions, zbx_uint64_t *functionids,
+		int *errcodes, size_t num);
+void	__wrap_DCconfig_get_items_by_itemids(DC_ITEM *items, const zbx_uint64_t *itemids, int *errcodes,
+		size_t num);
+
+void	__wrap_DCconfig_get_functions_by_functionids(DC_FUNCTION *functions, zbx_uint64_t *functionids,
+		int *errcodes, size_t num)
+{
+	size_t	i, sz_function, sz_parameter;
+
+	for (i = 0; i < num; i++)
+	{
+		const mock_function_t	*function;
+
+		if (0 == functionids[i] || (zbx_uint64_t)(mock_triggers_num * mock_functions_num) < functionids[i])
+		{
+			errcodes[i] = FAIL;
+			continue;
+		}
+
+		function = &mock_functions[(functionids[i] - 1) % mock_functions_num];
+
+		functions[i].functionid = functionids[i];
+		functions[i].triggerid = (functionids[i] - 1) / mock_functions_num + 1;
+		functions[i].itemid = functionids[i];
+
+		sz_function = strlen(function->function) + 1;
+		sz_parameter = strlen(function->parameter) + 1;
+		functions[i].function = (char *)zbx_malloc(NULL, sz_function + sz_parameter);
+		functions[i].parameter = functions[i].function + sz_function;
+		memcpy(functions[i].function, function->function, sz_function);
+		memcpy(functions[i].parameter, function->parameter, sz_parameter);
+
+		errcodes[i] = SUCCEED;
+	}
+}
+
+static void	mock_item_init(DC_ITEM *item, zbx_uint64_t itemid)
+{
+	memset(item, 0, sizeof(DC_ITEM));
+
+	item->itemid = itemid;
+	item->value_type = mock_value_type;
+	item->status = ITEM_STATUS_ACTIVE;
+	item->state = ITEM_STATE_NORMAL;
+	item->host.hostid = 1;
+	item->host.status = HOST_STATUS_MONITORED;
+	strscpy(item->host.host, "Benchmark host");
+	zbx_snprintf(item->key_orig, sizeof(item->key_orig), "benchmark[" ZBX_FS_UI64 "]", itemid);
+}
+
+void	__wrap_DCconfig_get_items_by_itemids(DC_ITEM *items, const zbx_uint64_t *itemids, int *errcodes,
+		size_t num)
+{
+	size_t	i;
+
+	for (i = 0; i < num; i++)
+	{
+		mock_item_init(&items[i], itemids[i]);
+		errcodes[i] = SUCCEED;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: mock_generate_history                                            *
+ *                                                                            *
+ * Purpose: generate history of all trigger function items                    *
+ *                                                                            *
+ ******************************************************************************/
+static void	mock_generate_history(int values_num, int now)
+{
+	zbx_uint64_t			itemid;
+	zbx_vector_history_record_t	data;
+	zbx_history_record_t		record;
+	int				i;
+
+	for (itemid = 1; itemid <= (zbx_uint64_t)(mock_triggers_num * mock_functions_num); itemid++)
+	{
+		zbx_history_record_vector_create(&data);
+		zbx_vector_history_record_reserve(&data, values_num + 1);
+
+		for (i = 0; i <= values_num; i++)
+		{
+			record.timestamp.sec = now - values_num + 1 + i;
+			record.timestamp.ns = 0;
+
+			if (ITEM_VALUE_TYPE_FLOAT == mock_value_type)
+				record.value.dbl = i % 100;
+			else
+				record.value.ui64 = i % 100;
+
+			zbx_vector_history_record_append_ptr(&data, &record);
+		}
+
+		zbx_vcmock_ds_add_item(itemid, mock_value_type, &data);
+	}
+}
+
+static void	mock_report(const char *name, int ops, double elapsed)
+{
+	printf("\t%s: %d ops, " ZBX_FS_DBL " ns/op\n", name, ops, elapsed * 1e9 / ops);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: mock_benchmark_evaluate                                          *
+ *                                                                            *
+ * Purpose: benchmark evaluate() with expression without functions            *
+ *                                                                            *
+ ******************************************************************************/
+static void	mock_benchmark_evaluate(const char *expression, int iterations)
+{
+	double	value = 0, time_start;
+	char	error[MAX_STRING_LEN];
+	int	i;
+
+	time_start = zbx_time();
+
+	for (i = 0; i < iterations; i++)
+	{
+		if (SUCCEED != evaluate(&value, expression, error, sizeof(error), NULL))
+			fail_msg("cannot evaluate expression \"%s\": %s", expression, error);
+	}
+
+	mock_report("evaluate()", iterations, zbx_time() - time_start);
+
+	zbx_mock_assert_double_eq("expression value", zbx_mock_get_parameter_float("out.value"), value);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: mock_benchmark_evaluate_function                                 *
+ *                                                                            *
+ * Purpose: benchmark evaluate_function() with the first function template    *
+ *                                                                            *
+ ******************************************************************************/
+static void	mock_benchmark_evaluate_function(int iterations, const zbx_timespec_t *ts)
+{
+	DC_ITEM	item;
+	double	time_start;
+	char	value[MAX_BUFFER_LEN], *error = NULL;
+	int	i;
+
+	mock_item_init(&item, 1);
+
+	/* warm up value cache */
+	if (SUCCEED != evaluate_function(value, &item, mock_functions[0].function, mock_functions[0].parameter, ts,
+			&error))
+	{
+		fail_msg("cannot evaluate function: %s", ZBX_NULL2STR(error));
+	}
+
+	time_start = zbx_time();
+
+	for (i = 0; i < iterations; i++)
+	{
+		if (SUCCEED != evaluate_function(value, &item, mock_functions[0].function,
+				mock_functions[0].parameter, ts, &error))
+		{
+			fail_msg("cannot evaluate function: %s", ZBX_NULL2STR(error));
+		}
+	}
+
+	mock_report("evaluate_function()", iterations, zbx_time() - time_start);
+
+	zbx_mock_assert_str_eq("function value", zbx_mock_get_parameter_string("out.value"), value);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: mock_trigger_expression                                          *
+ *                                                                            *
+ * Purpose: create trigger expression from template by replacing {K}          *
+ *          function references with the trigger function identifiers         *
+ *                                                                            *
+ ******************************************************************************/
+static char	*mock_trigger_expression(const char *template, int trigger_index)
+{
+	char		*expression = NULL;
+	size_t		expression_alloc = 0, expression_offset = 0;
+	const char	*ptr;
+	int		index;
+
+	for (ptr = template; '\0' != *ptr; ptr++)
+	{
+		if ('{' == *ptr && 1 == sscanf(ptr + 1, "%d}", &index) && 0 < index && index <= mock_functions_num)
+		{
+			zbx_snprintf_alloc(&expression, &expression_alloc, &expression_offset, "{%d}",
+					trigger_index * mock_functions_num + index);
+			ptr = strchr(ptr, '}');
+			continue;
+		}
+
+		zbx_chrcpy_alloc(&expression, &expression_alloc, &expression_offset, *ptr);
+	}
+
+	return expression;
+}
+
+static void	mock_trigger_reset(DC_TRIGGER *trigger, const char *expression)
+{
+	trigger->expression = zbx_strdup(trigger->expression, expression);
+	trigger->recovery_expression = zbx_strdup(trigger->recovery_expression, "");
+	zbx_free(trigger->new_error);
+	trigger->new_value = TRIGGER_VALUE_UNKNOWN;
+}
+
+static void	mock_trigger_free(void *ptr)
+{
+	DC_TRIGGER	*trigger = (DC_TRIGGER *)ptr;
+
+	zbx_free(trigger->expression_orig);
+	zbx_free(trigger->expression);
+	zbx_free(trigger->recovery_expression);
+	zbx_free(trigger->program);
+	zbx_free(trigger->new_error);
+	zbx_free(trigger);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: mock_benchmark_evaluate_expressions                              *
+ *                                                                            *
+ * Purpose: benchmark evaluate_expressions() with generated triggers          *
+ *                                                                            *
+ ******************************************************************************/
+static void	mock_benchmark_evaluate_expressions(const char *template, int compiled, int iterations,
+		const zbx_timespec_t *ts)
+{
+	zbx_vector_ptr_t	triggers;
+	DC_TRIGGER		*trigger;
+	double			time_start;
+	int			i, n;
+	unsigned char		expected_value;
+
+	zbx_vector_ptr_create(&triggers);
+
+	for (i = 0; i < mock_triggers_num; i++)
+	{
+		trigger = (DC_TRIGGER *)zbx_malloc(NULL, sizeof(DC_TRIGGER));
+		memset(trigger, 0, sizeof(DC_TRIGGER));
+
+		trigger->triggerid = i + 1;
+		trigger->expression_orig = mock_trigger_expression(template, i);
+		trigger->timespec = *ts;
+		trigger->value = TRIGGER_VALUE_PROBLEM;
+		trigger->recovery_mode = TRIGGER_RECOVERY_MODE_EXPRESSION;
+		trigger->flags = ZBX_DC_TRIGGER_PROBLEM_EXPRESSION;
+
+		if (0 != compiled && SUCCEED != zbx_expression_compile(trigger->expression_orig, &trigger->program))
+			fail_msg("cannot compile trigger expression \"%s\"", trigger->expression_orig);
+
+		zbx_vector_ptr_append(&triggers, trigger);
+	}
+
+	/* warm up value cache */
+	for (i = 0; i < triggers.values_num; i++)
+	{
+		trigger = (DC_TRIGGER *)triggers.values[i];
+		mock_trigger_reset(trigger, trigger->expression_orig);
+	}
+
+	evaluate_expressions(&triggers);
+
+	time_start = zbx_time();
+
+	for (n = 0; n < iterations; n++)
+	{
+		for (i = 0; i < triggers.values_num; i++)
+		{
+			trigger = (DC_TRIGGER *)triggers.values[i];
+			mock_trigger_reset(trigger, trigger->expression_orig);
+		}
+
+		evaluate_expressions(&triggers);
+	}
+
+	mock_report(0 != compiled ? "evaluate_expressions() compiled" : "evaluate_expressions()",
+			iterations * triggers.values_num, zbx_time() - time_start);
+
+	expected_value = (0 == strcmp(zbx_mock_get_parameter_string("out.value"), "PROBLEM") ?
+			TRIGGER_VALUE_PROBLEM : TRIGGER_VALUE_OK);
+
+	for (i = 0; i < triggers.values_num; i++)
+	{
+		trigger = (DC_TRIGGER *)triggers.values[i];
+
+		if (NULL != trigger->new_error)
+			fail_msg("trigger \"%s\" evaluation failed: %s", trigger->expression_orig, trigger->new_error);
+
+		zbx_mock_assert_int_eq("trigger value", expected_value, trigger->new_value);
+	}
+
+	zbx_vector_ptr_clear_ext(&triggers, mock_trigger_free);
+	zbx_vector_ptr_destroy(&triggers);
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	char			*error = NULL;
+	const char		*mode;
+	zbx_mock_handle_t	handle, hfunctions, hfunction;
+	zbx_timespec_t		ts;
+	int			iterations, values_num = 0;
+
+	ZBX_UNUSED(state);
+
+	CONFIG_VALUE_CACHE_SIZE = 256 * ZBX_MEBIBYTE;
+
+	if (SUCCEED != zbx_vc_init(&error))
+		fail_msg("Value cache initialization failed: %s", error);
+
+	zbx_vc_enable();
+	zbx_vcmock_ds_init();
+
+	handle = zbx_mock_get_parameter_handle("in");
+	zbx_vcmock_set_time(handle, "time");
+
+	if (ZBX_MOCK_SUCCESS != zbx_strtime_to_timespec(zbx_mock_get_parameter_string("in.time"), &ts))
+		fail_msg("invalid evaluation time");
+
+	mode = zbx_mock_get_parameter_string("in.mode");
+	iterations = (int)zbx_mock_get_parameter_uint64("in.iterations");
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_parameter_exists("in.functions"))
+	{
+		hfunctions = zbx_mock_get_parameter_handle("in.functions");
+
+		while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hfunctions, &hfunction))
+		{
+			mock_functions = (mock_function_t *)zbx_realloc(mock_functions,
+					sizeof(mock_function_t) * (mock_functions_num + 1));
+			mock_functions[mock_functions_num].function =
+					zbx_mock_get_object_member_string(hfunction, "function");
+			mock_functions[mock_functions_num].parameter =
+					zbx_mock_get_object_member_string(hfunction, "parameter");
+			mock_functions_num++;
+		}
+
+		mock_value_type = zbx_mock_str_to_value_type(zbx_mock_get_object_member_string(handle, "value type"));
+		values_num = (int)zbx_mock_get_parameter_uint64("in.values");
+	}
+
+	if (0 == strcmp(mode, "evaluate"))
+	{
+		mock_benchmark_evaluate(zbx_mock_get_parameter_string("in.expression"), iterations);
+	}
+	else if (0 == strcmp(mode, "evaluate_function"))
+	{
+		mock_triggers_num = 1;
+		mock_generate_history(values_num, ts.sec);
+		mock_benchmark_evaluate_function(iterations, &ts);
+	}
+	else if (0 == strcmp(mode, "evaluate_expressions"))
+	{
+		mock_triggers_num = (int)zbx_mock_get_parameter_uint64("in.triggers");
+		mock_generate_history(values_num, ts.sec);
+		mock_benchmark_evaluate_expressions(zbx_mock_get_parameter_string("in.expression"),
+				0 == strcmp(zbx_mock_get_parameter_string("in.compiled"), "yes"), iterations, &ts);
+	}
+	else
+		fail_msg("unknown benchmark mode \"%s\"", mode);
+
+	zbx_free(mock_functions);
+
+	zbx_vcmock_ds_destroy();
+
+	zbx_vc_reset();
+	zbx_vc_destroy();
+}
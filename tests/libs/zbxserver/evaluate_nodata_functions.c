@@ -0,0 +1,188 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2019 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "common.h"
+#include "dbcache.h"
+#include "valuecache.h"
+
+#include "../../../src/libs/zbxserver/evalfunc.h"
+
+static zbx_timespec_t	mock_now, mock_lastclock;
+static int		mock_lastclock_set, mock_expected_from_set, mock_expected_from, mock_vc_requests;
+
+void	__wrap_zbx_timespec(zbx_timespec_t *ts);
+int	__wrap_zbx_vc_get_values(zbx_uint64_t itemid, int value_type, zbx_vector_history_record_t *values, int seconds,
+		int count, const zbx_timespec_t *ts);
+int	__wrap_DCget_data_expected_from(zbx_uint64_t itemid, int *seconds);
+int	__wrap_substitute_simple_macros(zbx_uint64_t *actionid, const DB_EVENT *event, const DB_EVENT *r_event,
+		zbx_uint64_t *userid, const zbx_uint64_t *hostid, const DC_HOST *dc_host, const DC_ITEM *dc_item,
+		DB_ALERT *alert, const DB_ACKNOWLEDGE *ack, char **data, int macro_type, char *error, int maxerrlen);
+
+void	__wrap_zbx_timespec(zbx_timespec_t *ts)
+{
+	*ts = mock_now;
+}
+
+/* returns the latest item value within the requested period the same way as value cache does */
+int	__wrap_zbx_vc_get_values(zbx_uint64_t itemid, int value_type, zbx_vector_history_record_t *values, int seconds,
+		int count, const zbx_timespec_t *ts)
+{
+	zbx_timespec_t		start = {ts->sec - seconds, ts->ns};
+	zbx_history_record_t	record;
+
+	ZBX_UNUSED(itemid);
+	ZBX_UNUSED(value_type);
+
+	zbx_mock_assert_int_eq("requested value count", 1, count);
+	mock_vc_requests++;
+
+	if (0 != mock_lastclock_set && 0 < zbx_timespec_compare(&mock_lastclock, &start) &&
+			0 >= zbx_timespec_compare(&mock_lastclock, ts))
+	{
+		record.timestamp = mock_lastclock;
+		record.value.ui64 = 0;
+		zbx_vector_history_record_append_ptr(values, &record);
+	}
+
+	return SUCCEED;
+}
+
+int	__wrap_DCget_data_expected_from(zbx_uint64_t itemid, int *seconds)
+{
+	ZBX_UNUSED(itemid);
+
+	if (0 == mock_expected_from_set)
+		return FAIL;
+
+	*seconds = mock_expected_from;
+
+	return SUCCEED;
+}
+
+int	__wrap_substitute_simple_macros(zbx_uint64_t *actionid, const DB_EVENT *event, const DB_EVENT *r_event,
+		zbx_uint64_t *userid, const zbx_uint64_t *hostid, const DC_HOST *dc_host, const DC_ITEM *dc_item,
+		DB_ALERT *alert, const DB_ACKNOWLEDGE *ack, char **data, int macro_type, char *error, int maxerrlen)
+{
+	ZBX_UNUSED(actionid);
+	ZBX_UNUSED(event);
+	ZBX_UNUSED(r_event);
+	ZBX_UNUSED(userid);
+	ZBX_UNUSED(hostid);
+	ZBX_UNUSED(dc_host);
+	ZBX_UNUSED(dc_item);
+	ZBX_UNUSED(alert);
+	ZBX_UNUSED(ack);
+	ZBX_UNUSED(data);
+	ZBX_UNUSED(macro_type);
+	ZBX_UNUSED(error);
+	ZBX_UNUSED(maxerrlen);
+
+	return SUCCEED;
+}
+
+static void	mock_read_timespec(const char *path, zbx_timespec_t *ts)
+{
+	zbx_mock_handle_t	handle;
+
+	handle = zbx_mock_get_parameter_handle(path);
+	ts->sec = (int)zbx_mock_get_object_member_uint64(handle, "sec");
+	ts->ns = (int)zbx_mock_get_object_member_uint64(handle, "ns");
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	DC_ITEM			item;
+	zbx_mock_handle_t	hfuncs, hfunc;
+	zbx_nodata_func_t	*funcs;
+	int			i, funcs_num = 0;
+	char			msg[64];
+
+	ZBX_UNUSED(state);
+
+	mock_read_timespec("in.now", &mock_now);
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_parameter_exists("in.lastclock"))
+	{
+		mock_read_timespec("in.lastclock", &mock_lastclock);
+		mock_lastclock_set = 1;
+	}
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_parameter_exists("in.data_expected_from"))
+	{
+		mock_expected_from = (int)zbx_mock_get_parameter_uint64("in.data_expected_from");
+		mock_expected_from_set = 1;
+	}
+
+	memset(&item, 0, sizeof(item));
+	item.itemid = 1;
+	item.host.hostid = 1;
+	item.value_type = ITEM_VALUE_TYPE_UINT64;
+
+	hfuncs = zbx_mock_get_parameter_handle("in.functions");
+
+	while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hfuncs, &hfunc))
+		funcs_num++;
+
+	funcs = (zbx_nodata_func_t *)zbx_malloc(NULL, sizeof(zbx_nodata_func_t) * (size_t)funcs_num);
+
+	hfuncs = zbx_mock_get_parameter_handle("in.functions");
+
+	for (i = 0; ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hfuncs, &hfunc); i++)
+		funcs[i].parameters = zbx_mock_get_object_member_string(hfunc, "parameters");
+
+	evaluate_nodata_functions(&item, funcs, funcs_num);
+
+	zbx_mock_assert_int_eq("value cache requests", (int)zbx_mock_get_parameter_uint64("out.vc_requests"),
+			mock_vc_requests);
+
+	hfuncs = zbx_mock_get_parameter_handle("out.results");
+
+	for (i = 0; ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hfuncs, &hfunc); i++)
+	{
+		zbx_snprintf(msg, sizeof(msg), "function #%d nodata(%s)", i + 1, funcs[i].parameters);
+
+		if (i >= funcs_num)
+			fail_msg("too many expected results");
+
+		zbx_mock_assert_result_eq(msg, zbx_mock_str_to_return_code(
+				zbx_mock_get_object_member_string(hfunc, "result")), funcs[i].ret);
+
+		if (SUCCEED == funcs[i].ret)
+		{
+			zbx_mock_assert_int_eq(msg, (int)zbx_mock_get_object_member_uint64(hfunc, "value"),
+					funcs[i].value);
+		}
+		else
+		{
+			zbx_mock_assert_str_eq(msg, zbx_mock_get_object_member_string(hfunc, "error"),
+					funcs[i].error);
+			zbx_free(funcs[i].error);
+		}
+	}
+
+	zbx_mock_assert_int_eq("number of results", funcs_num, i);
+
+	zbx_free(funcs);
+}
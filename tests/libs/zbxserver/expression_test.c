@@ -0,0 +1,84 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2019 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+
+#include "expression_test.h"
+
+/******************************************************************************
+ *                                                                            *
+ * Function: expression_test_evaluate_functions                               *
+ *                                                                            *
+ * Purpose: evaluates trigger functions as one evaluation batch               *
+ *                                                                            *
+ * Parameters: itemids    - [IN] the function itemids                         *
+ *             functions  - [IN] the function names                           *
+ *             parameters - [IN] the function parameters                      *
+ *             ts         - [IN] the function evaluation timestamps           *
+ *             values     - [OUT] the function values, must be freed by      *
+ *                                caller                                      *
+ *             funcs_num  - [IN] the number of functions                      *
+ *                                                                            *
+ ******************************************************************************/
+void	expression_test_evaluate_functions(const zbx_uint64_t *itemids, const char **functions,
+		const char **parameters, const zbx_timespec_t *ts, char **values, int funcs_num)
+{
+	zbx_hashset_t		funcs;
+	zbx_vector_ptr_t	unknown_msgs;
+	zbx_func_t		*func, func_local;
+	int			i;
+
+	zbx_hashset_create_ext(&funcs, (size_t)funcs_num, func_hash_func, func_compare_func, func_clean,
+			ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC, ZBX_DEFAULT_MEM_FREE_FUNC);
+	zbx_vector_ptr_create(&unknown_msgs);
+
+	memset(&func_local, 0, sizeof(func_local));
+	func_local.numeric_ret = FAIL;
+
+	for (i = 0; i < funcs_num; i++)
+	{
+		func_local.itemid = itemids[i];
+		func_local.function = (char *)functions[i];
+		func_local.parameter = (char *)parameters[i];
+		func_local.timespec = ts[i];
+
+		if (NULL != zbx_hashset_search(&funcs, &func_local))
+			continue;
+
+		func = (zbx_func_t *)zbx_hashset_insert(&funcs, &func_local, sizeof(func_local));
+		func->function = zbx_strdup(NULL, functions[i]);
+		func->parameter = zbx_strdup(NULL, parameters[i]);
+	}
+
+	zbx_evaluate_item_functions(&funcs, &unknown_msgs);
+
+	for (i = 0; i < funcs_num; i++)
+	{
+		func_local.itemid = itemids[i];
+		func_local.function = (char *)functions[i];
+		func_local.parameter = (char *)parameters[i];
+		func_local.timespec = ts[i];
+
+		func = (zbx_func_t *)zbx_hashset_search(&funcs, &func_local);
+		values[i] = zbx_strdup(NULL, ZBX_NULL2EMPTY_STR(func->value));
+	}
+
+	zbx_vector_ptr_clear_ext(&unknown_msgs, zbx_ptr_free);
+	zbx_vector_ptr_destroy(&unknown_msgs);
+	zbx_hashset_destroy(&funcs);
+}
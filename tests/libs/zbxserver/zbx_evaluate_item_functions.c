@@ -0,0 +1,259 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2019 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "common.h"
+#include "zbxserver.h"
+#include "dbcache.h"
+#include "valuecache.h"
+
+#include "../../../src/libs/zbxserver/evalfunc.h"
+#include "expression_test.h"
+
+#define MOCK_REVISIONS_MAX	16
+
+typedef struct
+{
+	zbx_uint64_t		itemid;
+	zbx_vc_revision_t	revision;
+}
+mock_revision_t;
+
+static mock_revision_t	mock_revisions[2][MOCK_REVISIONS_MAX];
+static int		mock_revisions_num[2], mock_revisions_read, mock_evaluations;
+
+void	__wrap_DCconfig_get_items_by_itemids(DC_ITEM *items, const zbx_uint64_t *itemids, int *errcodes, size_t num);
+void	__wrap_DCconfig_clean_items(DC_ITEM *items, int *errcodes, size_t num);
+void	__wrap_zbx_vc_get_revisions(const zbx_uint64_t *itemids, int itemids_num, zbx_vc_revision_t *revisions);
+int	__wrap_evaluate_function_period(const DC_ITEM *item, const char *function, const char *parameters,
+		const zbx_timespec_t *ts, int *seconds, zbx_timespec_t *ts_end);
+int	__wrap_evaluate_function(char *value, DC_ITEM *item, const char *function, const char *parameters,
+		const zbx_timespec_t *ts, char **error);
+void	__wrap_evaluate_nodata_functions(DC_ITEM *item, zbx_nodata_func_t *funcs, int funcs_num);
+
+void	__wrap_DCconfig_get_items_by_itemids(DC_ITEM *items, const zbx_uint64_t *itemids, int *errcodes, size_t num)
+{
+	size_t	i;
+
+	memset(items, 0, sizeof(DC_ITEM) * num);
+
+	for (i = 0; i < num; i++)
+	{
+		items[i].itemid = itemids[i];
+		items[i].value_type = ITEM_VALUE_TYPE_UINT64;
+		items[i].status = ITEM_STATUS_ACTIVE;
+		items[i].state = ITEM_STATE_NORMAL;
+		items[i].host.status = HOST_STATUS_MONITORED;
+		errcodes[i] = SUCCEED;
+	}
+}
+
+void	__wrap_DCconfig_clean_items(DC_ITEM *items, int *errcodes, size_t num)
+{
+	ZBX_UNUSED(items);
+	ZBX_UNUSED(errcodes);
+	ZBX_UNUSED(num);
+}
+
+/* returns the item revisions before evaluating functions and when evaluated functions are rechecked */
+void	__wrap_zbx_vc_get_revisions(const zbx_uint64_t *itemids, int itemids_num, zbx_vc_revision_t *revisions)
+{
+	int	i, j, index;
+
+	index = (0 == mock_revisions_read++ ? 0 : 1);
+
+	for (i = 0; i < itemids_num; i++)
+	{
+		memset(&revisions[i], 0, sizeof(zbx_vc_revision_t));
+
+		for (j = 0; j < mock_revisions_num[index]; j++)
+		{
+			if (itemids[i] == mock_revisions[index][j].itemid)
+				revisions[i] = mock_revisions[index][j].revision;
+		}
+	}
+}
+
+static void	mock_read_revisions(zbx_mock_handle_t hrevisions, int index)
+{
+	zbx_mock_handle_t	hrevision;
+	mock_revision_t		*revision;
+
+	for (mock_revisions_num[index] = 0; ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hrevisions, &hrevision);
+			mock_revisions_num[index]++)
+	{
+		if (MOCK_REVISIONS_MAX == mock_revisions_num[index])
+			fail_msg("too many item revisions");
+
+		revision = &mock_revisions[index][mock_revisions_num[index]];
+		revision->itemid = zbx_mock_get_object_member_uint64(hrevision, "itemid");
+		revision->revision.revision = zbx_mock_get_object_member_uint64(hrevision, "revision");
+		revision->revision.ts.sec = (int)zbx_mock_get_object_member_uint64(hrevision, "sec");
+		revision->revision.ts.ns = 0;
+	}
+}
+
+int	__wrap_evaluate_function_period(const DC_ITEM *item, const char *function, const char *parameters,
+		const zbx_timespec_t *ts, int *seconds, zbx_timespec_t *ts_end)
+{
+	ZBX_UNUSED(item);
+	ZBX_UNUSED(function);
+	ZBX_UNUSED(parameters);
+	ZBX_UNUSED(ts);
+	ZBX_UNUSED(seconds);
+	ZBX_UNUSED(ts_end);
+
+	return FAIL;
+}
+
+/* every evaluation returns a new value, so the values taken from cache can be told apart */
+int	__wrap_evaluate_function(char *value, DC_ITEM *item, const char *function, const char *parameters,
+		const zbx_timespec_t *ts, char **error)
+{
+	ZBX_UNUSED(item);
+	ZBX_UNUSED(function);
+	ZBX_UNUSED(parameters);
+	ZBX_UNUSED(ts);
+	ZBX_UNUSED(error);
+
+	zbx_snprintf(value, MAX_BUFFER_LEN, "%d", ++mock_evaluations);
+
+	return SUCCEED;
+}
+
+void	__wrap_evaluate_nodata_functions(DC_ITEM *item, zbx_nodata_func_t *funcs, int funcs_num)
+{
+	int	i;
+
+	ZBX_UNUSED(item);
+
+	for (i = 0; i < funcs_num; i++)
+	{
+		funcs[i].value = ++mock_evaluations;
+		funcs[i].ret = SUCCEED;
+		funcs[i].error = NULL;
+	}
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_mock_handle_t	hin_batches, hout_batches, hin_batch, hout_batch, hrevisions, hfuncs, hfunc, hvalues,
+				hvalue;
+	zbx_uint64_t		hits, misses, hits_old = 0, misses_old = 0, *itemids;
+	const char		**functions, **parameters;
+	zbx_timespec_t		*ts;
+	char			**values, msg[64];
+	int			i, funcs_num, batch = 0, evaluations;
+
+	ZBX_UNUSED(state);
+
+	hin_batches = zbx_mock_get_parameter_handle("in.batches");
+	hout_batches = zbx_mock_get_parameter_handle("out.batches");
+
+	while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hin_batches, &hin_batch))
+	{
+		if (ZBX_MOCK_SUCCESS != zbx_mock_vector_element(hout_batches, &hout_batch))
+			fail_msg("missing expected results of batch #%d", batch);
+
+		mock_read_revisions(zbx_mock_get_object_member_handle(hin_batch, "revisions"), 0);
+
+		/* item values added by other processes while the batch was evaluated */
+		if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hin_batch, "revisions after", &hrevisions))
+			mock_read_revisions(hrevisions, 1);
+		else
+			mock_read_revisions(zbx_mock_get_object_member_handle(hin_batch, "revisions"), 1);
+
+		mock_revisions_read = 0;
+
+		hfuncs = zbx_mock_get_object_member_handle(hin_batch, "functions");
+
+		for (funcs_num = 0; ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hfuncs, &hfunc); funcs_num++)
+			;
+
+		itemids = (zbx_uint64_t *)zbx_malloc(NULL, sizeof(zbx_uint64_t) * (size_t)funcs_num);
+		functions = (const char **)zbx_malloc(NULL, sizeof(char *) * (size_t)funcs_num);
+		parameters = (const char **)zbx_malloc(NULL, sizeof(char *) * (size_t)funcs_num);
+		ts = (zbx_timespec_t *)zbx_malloc(NULL, sizeof(zbx_timespec_t) * (size_t)funcs_num);
+		values = (char **)zbx_malloc(NULL, sizeof(char *) * (size_t)funcs_num);
+
+		hfuncs = zbx_mock_get_object_member_handle(hin_batch, "functions");
+
+		for (i = 0; ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hfuncs, &hfunc); i++)
+		{
+			itemids[i] = zbx_mock_get_object_member_uint64(hfunc, "itemid");
+			functions[i] = zbx_mock_get_object_member_string(hfunc, "function");
+			parameters[i] = zbx_mock_get_object_member_string(hfunc, "parameter");
+			ts[i].sec = (int)zbx_mock_get_object_member_uint64(hfunc, "sec");
+			ts[i].ns = 0;
+		}
+
+		evaluations = mock_evaluations;
+		expression_test_evaluate_functions(itemids, functions, parameters, ts, values, funcs_num);
+		zbx_get_function_results_stats(&hits, &misses);
+
+		zbx_snprintf(msg, sizeof(msg), "batch #%d evaluations", batch);
+		zbx_mock_assert_int_eq(msg, (int)zbx_mock_get_object_member_uint64(hout_batch, "evaluations"),
+				mock_evaluations - evaluations);
+
+		zbx_snprintf(msg, sizeof(msg), "batch #%d cache hits", batch);
+		zbx_mock_assert_uint64_eq(msg, zbx_mock_get_object_member_uint64(hout_batch, "hits"), hits - hits_old);
+
+		zbx_snprintf(msg, sizeof(msg), "batch #%d cache misses", batch);
+		zbx_mock_assert_uint64_eq(msg, zbx_mock_get_object_member_uint64(hout_batch, "misses"),
+				misses - misses_old);
+
+		/* optional, as evaluated values depend on the order the functions are evaluated in */
+		if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hout_batch, "values", &hvalues))
+		{
+			for (i = 0; ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hvalues, &hvalue); i++)
+			{
+				const char	*value;
+
+				if (i >= funcs_num)
+					fail_msg("too many expected values in batch #%d", batch);
+
+				if (ZBX_MOCK_SUCCESS != zbx_mock_string(hvalue, &value))
+					fail_msg("cannot read expected value #%d of batch #%d", i, batch);
+
+				zbx_snprintf(msg, sizeof(msg), "batch #%d function #%d value", batch, i);
+				zbx_mock_assert_str_eq(msg, value, values[i]);
+			}
+
+			zbx_mock_assert_int_eq("number of values", funcs_num, i);
+		}
+
+		for (i = 0; i < funcs_num; i++)
+			zbx_free(values[i]);
+
+		zbx_free(values);
+		zbx_free(ts);
+		zbx_free(parameters);
+		zbx_free(functions);
+		zbx_free(itemids);
+
+		hits_old = hits;
+		misses_old = misses;
+		batch++;
+	}
+}
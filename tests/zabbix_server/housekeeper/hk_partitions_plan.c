@@ -0,0 +1,259 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2019 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "common.h"
+#include "zbxalgo.h"
+#include "dbcache.h"
+#include "zbxserver.h"
+#include "housekeeper_test.h"
+
+/* renamed by the test build flags to avoid clashing with thread local mock globals */
+unsigned char	process_type;
+int		server_num, process_num;
+
+int	__wrap_substitute_simple_macros(zbx_uint64_t *actionid, const DB_EVENT *event, const DB_EVENT *r_event,
+		zbx_uint64_t *userid, const zbx_uint64_t *hostid, const DC_HOST *dc_host, const DC_ITEM *dc_item,
+		DB_ALERT *alert, const DB_ACKNOWLEDGE *ack, char **data, int macro_type, char *error, int maxerrlen);
+zbx_uint64_t	__wrap_DCget_nextid(const char *table_name, int num);
+int	__wrap_zbx_host_availability_is_set(const zbx_host_availability_t *ha);
+int	__wrap_zbx_add_event(unsigned char source, unsigned char object, zbx_uint64_t objectid,
+		const zbx_timespec_t *timespec, int value, const char *trigger_description,
+		const char *trigger_expression, const char *trigger_recovery_expression, unsigned char trigger_priority,
+		unsigned char trigger_type, const zbx_vector_ptr_t *trigger_tags,
+		unsigned char trigger_correlation_mode, const char *trigger_correlation_tag,
+		unsigned char trigger_value, const char *trigger_opdata, const char *error);
+int	__wrap_zbx_process_events(zbx_vector_ptr_t *trigger_diff, zbx_vector_uint64_t *triggerids_lock);
+void	__wrap_zbx_clean_events(void);
+void	__wrap_zbx_config_get(zbx_config_t *cfg, zbx_uint64_t flags);
+void	__wrap_zbx_config_clean(zbx_config_t *cfg);
+void	__wrap_zbx_dc_cleanup_data_sessions(void);
+void	__wrap_zbx_vc_housekeeping_value_cache(void);
+void	__wrap_zbx_history_housekeep(void);
+void	__wrap_zbx_sleep_loop(int sleeptime);
+void	__wrap_zbx_sleep_forever(void);
+int	__wrap_zbx_sleep_get_remainder(void);
+void	__wrap_zbx_wakeup(void);
+void	__wrap_zbx_set_sigusr_handler(void (*handler)(int flags));
+
+int	__wrap_substitute_simple_macros(zbx_uint64_t *actionid, const DB_EVENT *event, const DB_EVENT *r_event,
+		zbx_uint64_t *userid, const zbx_uint64_t *hostid, const DC_HOST *dc_host, const DC_ITEM *dc_item,
+		DB_ALERT *alert, const DB_ACKNOWLEDGE *ack, char **data, int macro_type, char *error, int maxerrlen)
+{
+	ZBX_UNUSED(actionid);
+	ZBX_UNUSED(event);
+	ZBX_UNUSED(r_event);
+	ZBX_UNUSED(userid);
+	ZBX_UNUSED(hostid);
+	ZBX_UNUSED(dc_host);
+	ZBX_UNUSED(dc_item);
+	ZBX_UNUSED(alert);
+	ZBX_UNUSED(ack);
+	ZBX_UNUSED(data);
+	ZBX_UNUSED(macro_type);
+	ZBX_UNUSED(error);
+	ZBX_UNUSED(maxerrlen);
+
+	return SUCCEED;
+}
+
+zbx_uint64_t	__wrap_DCget_nextid(const char *table_name, int num)
+{
+	ZBX_UNUSED(table_name);
+	ZBX_UNUSED(num);
+
+	return 0;
+}
+
+int	__wrap_zbx_host_availability_is_set(const zbx_host_availability_t *ha)
+{
+	ZBX_UNUSED(ha);
+
+	return SUCCEED;
+}
+
+int	__wrap_zbx_add_event(unsigned char source, unsigned char object, zbx_uint64_t objectid,
+		const zbx_timespec_t *timespec, int value, const char *trigger_description,
+		const char *trigger_expression, const char *trigger_recovery_expression, unsigned char trigger_priority,
+		unsigned char trigger_type, const zbx_vector_ptr_t *trigger_tags,
+		unsigned char trigger_correlation_mode, const char *trigger_correlation_tag,
+		unsigned char trigger_value, const char *trigger_opdata, const char *error)
+{
+	ZBX_UNUSED(source);
+	ZBX_UNUSED(object);
+	ZBX_UNUSED(objectid);
+	ZBX_UNUSED(timespec);
+	ZBX_UNUSED(value);
+	ZBX_UNUSED(trigger_description);
+	ZBX_UNUSED(trigger_expression);
+	ZBX_UNUSED(trigger_recovery_expression);
+	ZBX_UNUSED(trigger_priority);
+	ZBX_UNUSED(trigger_type);
+	ZBX_UNUSED(trigger_tags);
+	ZBX_UNUSED(trigger_correlation_mode);
+	ZBX_UNUSED(trigger_correlation_tag);
+	ZBX_UNUSED(trigger_value);
+	ZBX_UNUSED(trigger_opdata);
+	ZBX_UNUSED(error);
+
+	return SUCCEED;
+}
+
+int	__wrap_zbx_process_events(zbx_vector_ptr_t *trigger_diff, zbx_vector_uint64_t *triggerids_lock)
+{
+	ZBX_UNUSED(trigger_diff);
+	ZBX_UNUSED(triggerids_lock);
+
+	return SUCCEED;
+}
+
+void	__wrap_zbx_clean_events(void)
+{
+}
+
+void	__wrap_zbx_config_get(zbx_config_t *cfg, zbx_uint64_t flags)
+{
+	ZBX_UNUSED(flags);
+	memset(cfg, 0, sizeof(zbx_config_t));
+}
+
+void	__wrap_zbx_config_clean(zbx_config_t *cfg)
+{
+	ZBX_UNUSED(cfg);
+}
+
+void	__wrap_zbx_dc_cleanup_data_sessions(void)
+{
+}
+
+void	__wrap_zbx_vc_housekeeping_value_cache(void)
+{
+}
+
+void	__wrap_zbx_history_housekeep(void)
+{
+}
+
+void	__wrap_zbx_sleep_loop(int sleeptime)
+{
+	ZBX_UNUSED(sleeptime);
+}
+
+void	__wrap_zbx_sleep_forever(void)
+{
+}
+
+int	__wrap_zbx_sleep_get_remainder(void)
+{
+	return 0;
+}
+
+void	__wrap_zbx_wakeup(void)
+{
+}
+
+void	__wrap_zbx_set_sigusr_handler(void (*handler)(int flags))
+{
+	ZBX_UNUSED(handler);
+}
+
+static int	read_clock(zbx_mock_handle_t handle)
+{
+	zbx_timespec_t		ts;
+	zbx_mock_error_t	err;
+	const char		*str;
+
+	if (ZBX_MOCK_SUCCESS != (err = zbx_mock_string(handle, &str)) ||
+			ZBX_MOCK_SUCCESS != (err = zbx_strtime_to_timespec(str, &ts)))
+	{
+		fail_msg("Cannot read timestamp: %s", zbx_mock_error_string(err));
+	}
+
+	return ts.sec;
+}
+
+static void	read_bounds(zbx_mock_handle_t hbounds, zbx_vector_uint64_pair_t *bounds)
+{
+	zbx_mock_handle_t	hbound;
+	zbx_mock_error_t	err;
+	zbx_uint64_pair_t	pair;
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = zbx_mock_vector_element(hbounds, &hbound)))
+	{
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("Cannot read partition bounds: %s", zbx_mock_error_string(err));
+
+		pair.first = (zbx_uint64_t)read_clock(zbx_mock_get_object_member_handle(hbound, "from"));
+		pair.second = (zbx_uint64_t)read_clock(zbx_mock_get_object_member_handle(hbound, "to"));
+		zbx_vector_uint64_pair_append(bounds, pair);
+	}
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_vector_uint64_pair_t	partitions, create, expected;
+	int				i, drop_num, trends, contiguous;
+	const char			*period;
+	char				msg[64];
+
+	ZBX_UNUSED(state);
+
+	zbx_vector_uint64_pair_create(&partitions);
+	zbx_vector_uint64_pair_create(&create);
+	zbx_vector_uint64_pair_create(&expected);
+
+	period = zbx_mock_get_parameter_string("in.period");
+
+	if (0 == strcmp(period, "month"))
+		trends = 1;
+	else if (0 == strcmp(period, "day"))
+		trends = 0;
+	else
+		fail_msg("Unknown partition period \"%s\"", period);
+
+	contiguous = (0 == strcmp(zbx_mock_get_parameter_string("in.contiguous"), "yes") ? 1 : 0);
+
+	read_bounds(zbx_mock_get_parameter_handle("in.partitions"), &partitions);
+	read_bounds(zbx_mock_get_parameter_handle("out.create"), &expected);
+
+	zbx_hk_partitions_plan(&partitions, trends, contiguous, read_clock(zbx_mock_get_parameter_handle("in.now")),
+			read_clock(zbx_mock_get_parameter_handle("in.keep_from")), &create, &drop_num);
+
+	zbx_mock_assert_int_eq("number of partitions to create", expected.values_num, create.values_num);
+
+	for (i = 0; i < expected.values_num; i++)
+	{
+		zbx_snprintf(msg, sizeof(msg), "partition #%d lower bound", i);
+		zbx_mock_assert_uint64_eq(msg, expected.values[i].first, create.values[i].first);
+		zbx_snprintf(msg, sizeof(msg), "partition #%d upper bound", i);
+		zbx_mock_assert_uint64_eq(msg, expected.values[i].second, create.values[i].second);
+	}
+
+	zbx_mock_assert_int_eq("number of partitions to drop", (int)zbx_mock_get_parameter_uint64("out.drop"),
+			drop_num);
+
+	zbx_vector_uint64_pair_destroy(&expected);
+	zbx_vector_uint64_pair_destroy(&create);
+	zbx_vector_uint64_pair_destroy(&partitions);
+}
@@ -0,0 +1,48 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2019 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+
+#include "housekeeper_test.h"
+
+void	zbx_hk_partitions_plan(const zbx_vector_uint64_pair_t *bounds, int trends, int contiguous, int now,
+		int keep_from, zbx_vector_uint64_pair_t *create, int *drop_num)
+{
+	zbx_vector_ptr_t	partitions;
+	zbx_hk_partition_t	*partition;
+	int			i;
+
+	zbx_vector_ptr_create(&partitions);
+
+	for (i = 0; i < bounds->values_num; i++)
+	{
+		partition = (zbx_hk_partition_t *)zbx_malloc(NULL, sizeof(zbx_hk_partition_t));
+		partition->name = zbx_dsprintf(NULL, "p%d", i);
+		partition->clock_from = (int)bounds->values[i].first;
+		partition->clock_to = (int)bounds->values[i].second;
+		zbx_vector_ptr_append(&partitions, partition);
+	}
+
+	zbx_vector_ptr_sort(&partitions, hk_partition_compare);
+
+	hk_partitions_plan(&partitions, 0 != trends ? HK_PARTITION_PERIOD_MONTH : HK_PARTITION_PERIOD_DAY, contiguous,
+			now, keep_from, create, drop_num);
+
+	zbx_vector_ptr_clear_ext(&partitions, (zbx_clean_func_t)hk_partition_free);
+	zbx_vector_ptr_destroy(&partitions);
+}
@@ -0,0 +1,39 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2019 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "common.h"
+#include "sysinfo.h"
+
+/* preprocessing manager passes results to history cache, which is not available in tests */
+
+void	__wrap_dc_add_history(zbx_uint64_t itemid, unsigned char item_value_type, unsigned char item_flags,
+		AGENT_RESULT *result, const zbx_timespec_t *ts, unsigned char state, const char *error)
+{
+	ZBX_UNUSED(itemid);
+	ZBX_UNUSED(item_value_type);
+	ZBX_UNUSED(item_flags);
+	ZBX_UNUSED(result);
+	ZBX_UNUSED(ts);
+	ZBX_UNUSED(state);
+	ZBX_UNUSED(error);
+}
+
+void	__wrap_dc_flush_history(void)
+{
+}
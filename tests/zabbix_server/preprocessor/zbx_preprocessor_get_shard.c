@@ -0,0 +1,79 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2019 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockutil.h"
+#include "zbxmockassert.h"
+
+#include "common.h"
+#include "../../../src/zabbix_server/preprocessor/preprocessing.h"
+
+extern int	CONFIG_PREPROCMAN_FORKS;
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_uint64_t		itemid;
+	int			i, shard, items_num, *counts, deviation;
+	zbx_mock_handle_t	hnames, hname;
+	char			name[ZBX_IPC_SERVICE_PREPROCESSING_LEN];
+
+	ZBX_UNUSED(state);
+
+	CONFIG_PREPROCMAN_FORKS = (int)zbx_mock_get_parameter_uint64("in.managers");
+	items_num = (int)zbx_mock_get_parameter_uint64("in.items");
+	deviation = (int)zbx_mock_get_parameter_uint64("out.deviation");
+
+	counts = (int *)zbx_calloc(NULL, (size_t)CONFIG_PREPROCMAN_FORKS, sizeof(int));
+
+	for (itemid = 1; itemid <= (zbx_uint64_t)items_num; itemid++)
+	{
+		shard = zbx_preprocessor_get_shard(itemid);
+
+		if (0 > shard || CONFIG_PREPROCMAN_FORKS <= shard)
+			fail_msg("item " ZBX_FS_UI64 " assigned to invalid shard %d", itemid, shard);
+
+		zbx_mock_assert_int_eq("repeated shard", shard, zbx_preprocessor_get_shard(itemid));
+		counts[shard]++;
+	}
+
+	/* items must be spread between all shards within the expected deviation percentage */
+	for (i = 0; i < CONFIG_PREPROCMAN_FORKS; i++)
+	{
+		int	expected = items_num / CONFIG_PREPROCMAN_FORKS;
+
+		if (abs(counts[i] - expected) * 100 > expected * deviation)
+			fail_msg("shard %d has %d items while %d were expected", i, counts[i], expected);
+	}
+
+	zbx_free(counts);
+
+	hnames = zbx_mock_get_parameter_handle("out.services");
+
+	for (i = 0; ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hnames, &hname); i++)
+	{
+		const char	*expected_name;
+
+		if (ZBX_MOCK_SUCCESS != zbx_mock_string(hname, &expected_name))
+			fail_msg("invalid service name");
+
+		zbx_preprocessor_get_service_name(i, name, sizeof(name));
+		zbx_mock_assert_str_eq("service name", expected_name, name);
+	}
+}
@@ -0,0 +1,204 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2019 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockutil.h"
+#include "zbxmockassert.h"
+
+#include "common.h"
+#include "../../../src/zabbix_server/preprocessor/preprocessing.h"
+
+/* dependent item data read from test case */
+typedef struct
+{
+	zbx_uint64_t		itemid;
+	unsigned char		value_type;
+	zbx_preproc_op_t	*steps;
+	int			steps_num;
+	const char		*result;
+	const char		*error;
+}
+mock_dep_item_t;
+
+static void	mock_read_dep_items(zbx_vector_ptr_t *items)
+{
+	zbx_mock_handle_t	hitems, hitem, hsteps, hstep;
+	mock_dep_item_t		*item;
+
+	hitems = zbx_mock_get_parameter_handle("in.items");
+
+	while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hitems, &hitem))
+	{
+		item = (mock_dep_item_t *)zbx_malloc(NULL, sizeof(mock_dep_item_t));
+		item->itemid = zbx_mock_get_object_member_uint64(hitem, "itemid");
+		item->value_type = zbx_mock_str_to_value_type(zbx_mock_get_object_member_string(hitem, "value_type"));
+		item->result = zbx_mock_get_object_member_string(hitem, "result");
+
+		if (ZBX_MOCK_SUCCESS != zbx_mock_object_member(hitem, "error", &hstep) ||
+				ZBX_MOCK_SUCCESS != zbx_mock_string(hstep, &item->error))
+		{
+			item->error = NULL;
+		}
+
+		item->steps = NULL;
+		item->steps_num = 0;
+
+		hsteps = zbx_mock_get_object_member_handle(hitem, "steps");
+
+		while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hsteps, &hstep))
+		{
+			zbx_preproc_op_t	*op;
+
+			item->steps = (zbx_preproc_op_t *)zbx_realloc(item->steps,
+					sizeof(zbx_preproc_op_t) * (item->steps_num + 1));
+			op = &item->steps[item->steps_num++];
+
+			op->type = (unsigned char)zbx_mock_get_object_member_uint64(hstep, "type");
+			op->params = (char *)zbx_mock_get_object_member_string(hstep, "params");
+			op->error_handler = ZBX_PREPROC_FAIL_DEFAULT;
+			op->error_handler_params = "";
+		}
+
+		zbx_vector_ptr_append(items, item);
+	}
+}
+
+static void	mock_dep_item_free(mock_dep_item_t *item)
+{
+	zbx_free(item->steps);
+	zbx_free(item);
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_vector_ptr_t	items, history;
+	zbx_ipc_message_t	message;
+	zbx_timespec_t		ts, *ts_out;
+	zbx_variant_t		value, value_out;
+	zbx_uint32_t		offset;
+	int			i, j, steps_num;
+	zbx_uint64_t		itemid;
+	unsigned char		value_type;
+	zbx_preproc_op_t	*steps;
+	char			*error;
+
+	ZBX_UNUSED(state);
+
+	zbx_vector_ptr_create(&items);
+	zbx_vector_ptr_create(&history);
+	mock_read_dep_items(&items);
+
+	ts.sec = 1;
+	ts.ns = 2;
+	zbx_variant_set_str(&value, zbx_strdup(NULL, zbx_mock_get_parameter_string("in.value")));
+
+	/* pack master item value followed by dependent items */
+
+	zbx_ipc_message_init(&message);
+	zbx_preprocessor_pack_dep_request(&message, &ts, &value);
+
+	for (i = 0; i < items.values_num; i++)
+	{
+		mock_dep_item_t	*item = (mock_dep_item_t *)items.values[i];
+
+		zbx_preprocessor_pack_dep_request_item(&message, item->itemid, item->value_type, NULL, item->steps,
+				item->steps_num);
+	}
+
+	/* unpack it as worker would */
+
+	offset = zbx_preprocessor_unpack_dep_request(&ts_out, &value_out, message.data);
+
+	zbx_mock_assert_ptr_ne("timestamp", NULL, ts_out);
+	zbx_mock_assert_int_eq("timestamp seconds", ts.sec, ts_out->sec);
+	zbx_mock_assert_int_eq("timestamp nanoseconds", ts.ns, ts_out->ns);
+	zbx_mock_assert_int_eq("value type", ZBX_VARIANT_STR, value_out.type);
+	zbx_mock_assert_str_eq("value", value.data.str, value_out.data.str);
+	zbx_free(ts_out);
+	zbx_variant_clear(&value_out);
+
+	for (i = 0; offset < message.size; i++)
+	{
+		mock_dep_item_t	*item;
+
+		if (i >= items.values_num)
+			fail_msg("unpacked more dependent items than were packed");
+
+		item = (mock_dep_item_t *)items.values[i];
+
+		offset += zbx_preprocessor_unpack_dep_request_item(&itemid, &value_type, &history, &steps, &steps_num,
+				message.data + offset);
+
+		zbx_mock_assert_uint64_eq("itemid", item->itemid, itemid);
+		zbx_mock_assert_int_eq("value type", item->value_type, value_type);
+		zbx_mock_assert_int_eq("history size", 0, history.values_num);
+		zbx_mock_assert_int_eq("step count", item->steps_num, steps_num);
+
+		for (j = 0; j < steps_num; j++)
+		{
+			zbx_mock_assert_int_eq("step type", item->steps[j].type, steps[j].type);
+			zbx_mock_assert_str_eq("step params", item->steps[j].params, steps[j].params);
+		}
+
+		zbx_free(steps);
+	}
+
+	zbx_mock_assert_int_eq("unpacked dependent items", items.values_num, i);
+	zbx_ipc_message_clean(&message);
+
+	/* pack the results in the same order and unpack them as manager would */
+
+	zbx_ipc_message_init(&message);
+
+	for (i = 0; i < items.values_num; i++)
+	{
+		mock_dep_item_t	*item = (mock_dep_item_t *)items.values[i];
+		zbx_variant_t	result;
+
+		zbx_variant_set_str(&result, (char *)item->result);
+		zbx_preprocessor_pack_result(&message, &result, &history, item->error);
+	}
+
+	for (i = 0, offset = 0; i < items.values_num; i++)
+	{
+		mock_dep_item_t	*item = (mock_dep_item_t *)items.values[i];
+
+		offset += zbx_preprocessor_unpack_result(&value_out, &history, &error, message.data + offset);
+
+		zbx_mock_assert_int_eq("result type", ZBX_VARIANT_STR, value_out.type);
+		zbx_mock_assert_str_eq("result", item->result, value_out.data.str);
+
+		if (NULL == item->error)
+			zbx_mock_assert_ptr_eq("error", NULL, error);
+		else
+			zbx_mock_assert_str_eq("error", item->error, error);
+
+		zbx_variant_clear(&value_out);
+		zbx_free(error);
+	}
+
+	zbx_mock_assert_int_eq("unpacked result size", message.size, offset);
+	zbx_ipc_message_clean(&message);
+
+	zbx_variant_clear(&value);
+	zbx_vector_ptr_destroy(&history);
+	zbx_vector_ptr_clear_ext(&items, (zbx_clean_func_t)mock_dep_item_free);
+	zbx_vector_ptr_destroy(&items);
+}
@@ -0,0 +1,156 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2019 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockutil.h"
+#include "zbxmockassert.h"
+
+#include "common.h"
+#include "memalloc.h"
+#include "preproc.h"
+#include "../../../src/zabbix_server/preprocessor/preprocessing.h"
+
+extern zbx_uint64_t	CONFIG_PREPROCESSING_CACHE_SIZE;
+
+static zbx_mem_info_t	mock_mem;
+static int		mock_mem_full, mock_mem_chunks;
+
+int	__wrap_zbx_mutex_create(zbx_mutex_t *mutex, zbx_mutex_name_t name, char **error)
+{
+	ZBX_UNUSED(mutex);
+	ZBX_UNUSED(name);
+	ZBX_UNUSED(error);
+
+	return SUCCEED;
+}
+
+void	__wrap_zbx_mutex_destroy(zbx_mutex_t *mutex)
+{
+	ZBX_UNUSED(mutex);
+}
+
+void	__wrap___zbx_mutex_lock(const char *filename, int line, zbx_mutex_t mutex)
+{
+	ZBX_UNUSED(filename);
+	ZBX_UNUSED(line);
+	ZBX_UNUSED(mutex);
+}
+
+void	__wrap___zbx_mutex_unlock(const char *filename, int line, zbx_mutex_t mutex)
+{
+	ZBX_UNUSED(filename);
+	ZBX_UNUSED(line);
+	ZBX_UNUSED(mutex);
+}
+
+int	__wrap_zbx_mem_create(zbx_mem_info_t **info, zbx_uint64_t size, const char *descr, const char *param,
+		int allow_oom, char **error)
+{
+	ZBX_UNUSED(size);
+	ZBX_UNUSED(descr);
+	ZBX_UNUSED(param);
+	ZBX_UNUSED(error);
+
+	zbx_mock_assert_int_eq("allow out of memory", 1, allow_oom);
+	*info = &mock_mem;
+
+	return SUCCEED;
+}
+
+void	*__wrap___zbx_mem_malloc(const char *file, int line, zbx_mem_info_t *info, const void *old, size_t size)
+{
+	ZBX_UNUSED(file);
+	ZBX_UNUSED(line);
+
+	zbx_mock_assert_ptr_eq("memory info", &mock_mem, info);
+	zbx_mock_assert_ptr_eq("allocating unfreed memory", NULL, old);
+
+	if (0 != mock_mem_full)
+		return NULL;
+
+	mock_mem_chunks++;
+
+	return zbx_malloc(NULL, size);
+}
+
+void	__wrap___zbx_mem_free(const char *file, int line, zbx_mem_info_t *info, void *ptr)
+{
+	ZBX_UNUSED(file);
+	ZBX_UNUSED(line);
+
+	zbx_mock_assert_ptr_eq("memory info", &mock_mem, info);
+
+	mock_mem_chunks--;
+	zbx_free(ptr);
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_ipc_message_t	message;
+	zbx_variant_t		value, value_out;
+	zbx_vector_ptr_t	history;
+	char			*str, *error;
+	size_t			size;
+	zbx_uint32_t		offset;
+	int			shared;
+
+	ZBX_UNUSED(state);
+
+	CONFIG_PREPROCESSING_CACHE_SIZE = ZBX_MEBIBYTE;
+
+	if (SUCCEED != zbx_preprocessor_init_cache(&error))
+		fail_msg("cannot initialize preprocessing cache: %s", error);
+
+	size = (size_t)zbx_mock_get_parameter_uint64("in.size");
+	mock_mem_full = (0 == strcmp(zbx_mock_get_parameter_string("in.cache"), "full"));
+	shared = (0 == strcmp(zbx_mock_get_parameter_string("out.packing"), "shared"));
+
+	str = (char *)zbx_malloc(NULL, size + 1);
+	memset(str, 'x', size);
+	str[size] = '\0';
+
+	zbx_vector_ptr_create(&history);
+	zbx_ipc_message_init(&message);
+	zbx_variant_set_str(&value, str);
+
+	zbx_preprocessor_pack_result(&message, &value, &history, NULL);
+
+	zbx_mock_assert_int_eq("values in preprocessing cache", shared, mock_mem_chunks);
+
+	if (0 != shared)
+		zbx_mock_assert_int_eq("value packed inline", 1, message.size < size);
+	else
+		zbx_mock_assert_int_eq("value packed inline", 1, message.size > size);
+
+	offset = zbx_preprocessor_unpack_result(&value_out, &history, &error, message.data);
+
+	zbx_mock_assert_int_eq("unpacked size", message.size, offset);
+	zbx_mock_assert_int_eq("values in preprocessing cache", 0, mock_mem_chunks);
+	zbx_mock_assert_int_eq("value type", ZBX_VARIANT_STR, value_out.type);
+	zbx_mock_assert_str_eq("value", str, value_out.data.str);
+	zbx_mock_assert_ptr_eq("error", NULL, error);
+
+	zbx_variant_clear(&value_out);
+	zbx_variant_clear(&value);
+	zbx_ipc_message_clean(&message);
+	zbx_vector_ptr_destroy(&history);
+
+	zbx_preprocessor_destroy_cache();
+}
@@ -0,0 +1,167 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2019 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockutil.h"
+#include "zbxmockassert.h"
+
+#include "common.h"
+#include "preproc.h"
+#include "../../../src/zabbix_server/preprocessor/preprocessing.h"
+
+/******************************************************************************
+ *                                                                            *
+ * Function: mock_read_shard_stats                                            *
+ *                                                                            *
+ * Purpose: read statistics of one preprocessing manager shard                *
+ *                                                                            *
+ * Comments: The durations are added both to queue and XPath step statistics. *
+ *                                                                            *
+ ******************************************************************************/
+static void	mock_read_shard_stats(zbx_mock_handle_t hshard, zbx_preproc_stats_t *stats)
+{
+	zbx_mock_handle_t		hvector, helement;
+	const char			*str;
+	double				duration;
+	zbx_preproc_worker_stats_t	*worker;
+	zbx_preproc_item_stats_t	*item;
+
+	memset(stats, 0, sizeof(zbx_preproc_stats_t));
+	zbx_vector_ptr_create(&stats->workers);
+	zbx_vector_ptr_create(&stats->items);
+
+	stats->time = zbx_mock_get_object_member_float(hshard, "time");
+
+	hvector = zbx_mock_get_object_member_handle(hshard, "durations");
+
+	while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hvector, &helement))
+	{
+		if (ZBX_MOCK_SUCCESS != zbx_mock_string(helement, &str) || SUCCEED != is_double(str, &duration))
+			fail_msg("invalid duration");
+
+		zbx_preproc_time_stats_add(&stats->queue, duration);
+		zbx_preproc_time_stats_add(&stats->steps[ZBX_PREPROC_XPATH], duration);
+	}
+
+	hvector = zbx_mock_get_object_member_handle(hshard, "workers");
+
+	while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hvector, &helement))
+	{
+		worker = (zbx_preproc_worker_stats_t *)zbx_malloc(NULL, sizeof(zbx_preproc_worker_stats_t));
+		worker->process_num = (int)zbx_mock_get_object_member_uint64(helement, "num");
+		worker->values_num = zbx_mock_get_object_member_uint64(helement, "values");
+		zbx_vector_ptr_append(&stats->workers, worker);
+	}
+
+	hvector = zbx_mock_get_object_member_handle(hshard, "items");
+
+	while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hvector, &helement))
+	{
+		item = (zbx_preproc_item_stats_t *)zbx_malloc(NULL, sizeof(zbx_preproc_item_stats_t));
+		memset(item, 0, sizeof(zbx_preproc_item_stats_t));
+		item->itemid = zbx_mock_get_object_member_uint64(helement, "itemid");
+		item->count = zbx_mock_get_object_member_uint64(helement, "count");
+		item->time = zbx_mock_get_object_member_float(helement, "time");
+		item->time_max = zbx_mock_get_object_member_float(helement, "max");
+		zbx_vector_ptr_append(&stats->items, item);
+	}
+}
+
+static void	mock_check_time_stats(const char *prefix, const zbx_preproc_time_stats_t *stats)
+{
+	zbx_mock_handle_t	hbuckets, hbucket;
+	zbx_uint64_t		buckets[ZBX_PREPROC_TIME_BUCKETS] = {0};
+	int			i;
+	char			msg[64];
+
+	zbx_snprintf(msg, sizeof(msg), "%s count", prefix);
+	zbx_mock_assert_uint64_eq(msg, zbx_mock_get_parameter_uint64("out.count"), stats->count);
+	zbx_snprintf(msg, sizeof(msg), "%s time", prefix);
+	zbx_mock_assert_double_eq(msg, zbx_mock_get_parameter_float("out.time"), stats->time);
+	zbx_snprintf(msg, sizeof(msg), "%s max", prefix);
+	zbx_mock_assert_double_eq(msg, zbx_mock_get_parameter_float("out.max"), stats->time_max);
+
+	hbuckets = zbx_mock_get_parameter_handle("out.buckets");
+
+	while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hbuckets, &hbucket))
+	{
+		i = (int)zbx_mock_get_object_member_uint64(hbucket, "bucket");
+
+		if (0 > i || ZBX_PREPROC_TIME_BUCKETS <= i)
+			fail_msg("invalid bucket index %d", i);
+
+		buckets[i] = zbx_mock_get_object_member_uint64(hbucket, "count");
+	}
+
+	for (i = 0; i < ZBX_PREPROC_TIME_BUCKETS; i++)
+	{
+		zbx_snprintf(msg, sizeof(msg), "%s bucket %d", prefix, i);
+		zbx_mock_assert_uint64_eq(msg, buckets[i], stats->buckets[i]);
+	}
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_mock_handle_t	hshards, hshard;
+	zbx_preproc_stats_t	stats, shard_stats;
+	unsigned char		*data;
+	zbx_uint64_t		values_num = 0;
+	int			i;
+
+	ZBX_UNUSED(state);
+
+	memset(&stats, 0, sizeof(stats));
+	zbx_vector_ptr_create(&stats.workers);
+	zbx_vector_ptr_create(&stats.items);
+
+	/* statistics of all shards are packed and combined like zbx_preprocessor_get_stats() does */
+	hshards = zbx_mock_get_parameter_handle("in.shards");
+
+	while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hshards, &hshard))
+	{
+		mock_read_shard_stats(hshard, &shard_stats);
+
+		zbx_preprocessor_pack_stats(&data, &shard_stats);
+		zbx_preprocessor_clear_stats(&shard_stats);
+
+		zbx_preprocessor_unpack_stats(&stats, data);
+		zbx_free(data);
+	}
+
+	mock_check_time_stats("queue", &stats.queue);
+	mock_check_time_stats("xpath", &stats.steps[ZBX_PREPROC_XPATH]);
+
+	for (i = 0; i < ZBX_PREPROC_TYPE_MAX; i++)
+	{
+		if (ZBX_PREPROC_XPATH != i)
+			zbx_mock_assert_uint64_eq("step count", 0, stats.steps[i].count);
+	}
+
+	zbx_mock_assert_double_eq("statistics period", zbx_mock_get_parameter_float("out.period"), stats.time);
+
+	for (i = 0; i < stats.workers.values_num; i++)
+		values_num += ((zbx_preproc_worker_stats_t *)stats.workers.values[i])->values_num;
+
+	zbx_mock_assert_int_eq("workers", (int)zbx_mock_get_parameter_uint64("out.workers"), stats.workers.values_num);
+	zbx_mock_assert_uint64_eq("values", zbx_mock_get_parameter_uint64("out.values"), values_num);
+	zbx_mock_assert_int_eq("items", (int)zbx_mock_get_parameter_uint64("out.items"), stats.items.values_num);
+
+	zbx_preprocessor_clear_stats(&stats);
+}
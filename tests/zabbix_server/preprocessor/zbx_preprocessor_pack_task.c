@@ -0,0 +1,102 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2019 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockutil.h"
+#include "zbxmockassert.h"
+
+#include "common.h"
+#include "../../../src/zabbix_server/preprocessor/preprocessing.h"
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_mock_handle_t	htasks, htask;
+	zbx_vector_ptr_t	history;
+	zbx_ipc_message_t	message;
+	zbx_timespec_t		ts, *ts_out;
+	zbx_variant_t		value, value_out;
+	zbx_uint32_t		offset = 0;
+	int			i, tasks_num = 0, steps_num;
+	zbx_uint64_t		itemid;
+	unsigned char		value_type;
+	zbx_preproc_op_t	step, *steps;
+
+	ZBX_UNUSED(state);
+
+	zbx_vector_ptr_create(&history);
+	zbx_ipc_message_init(&message);
+
+	/* pack the tasks one after another into the same message */
+
+	htasks = zbx_mock_get_parameter_handle("in.tasks");
+
+	while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(htasks, &htask))
+	{
+		step.type = (unsigned char)zbx_mock_get_object_member_uint64(htask, "step");
+		step.params = (char *)zbx_mock_get_object_member_string(htask, "params");
+		step.error_handler = ZBX_PREPROC_FAIL_DEFAULT;
+		step.error_handler_params = "";
+
+		ts.sec = tasks_num;
+		ts.ns = 0;
+
+		zbx_variant_set_str(&value, (char *)zbx_mock_get_object_member_string(htask, "value"));
+		zbx_preprocessor_pack_task(&message, zbx_mock_get_object_member_uint64(htask, "itemid"),
+				ITEM_VALUE_TYPE_TEXT, &ts, &value, NULL, &step, 1);
+
+		tasks_num++;
+	}
+
+	/* unpack them as worker would */
+
+	htasks = zbx_mock_get_parameter_handle("in.tasks");
+
+	for (i = 0; offset < message.size; i++)
+	{
+		if (ZBX_MOCK_SUCCESS != zbx_mock_vector_element(htasks, &htask))
+			fail_msg("unpacked more tasks than were packed");
+
+		offset += zbx_preprocessor_unpack_task(&itemid, &value_type, &ts_out, &value_out, &history, &steps,
+				&steps_num, message.data + offset);
+
+		zbx_mock_assert_uint64_eq("itemid", zbx_mock_get_object_member_uint64(htask, "itemid"), itemid);
+		zbx_mock_assert_int_eq("value type", ITEM_VALUE_TYPE_TEXT, value_type);
+		zbx_mock_assert_ptr_ne("timestamp", NULL, ts_out);
+		zbx_mock_assert_int_eq("timestamp seconds", i, ts_out->sec);
+		zbx_mock_assert_int_eq("value type", ZBX_VARIANT_STR, value_out.type);
+		zbx_mock_assert_str_eq("value", zbx_mock_get_object_member_string(htask, "value"), value_out.data.str);
+		zbx_mock_assert_int_eq("history size", 0, history.values_num);
+		zbx_mock_assert_int_eq("step count", 1, steps_num);
+		zbx_mock_assert_int_eq("step type", (int)zbx_mock_get_object_member_uint64(htask, "step"),
+				steps[0].type);
+		zbx_mock_assert_str_eq("step params", zbx_mock_get_object_member_string(htask, "params"),
+				steps[0].params);
+
+		zbx_free(ts_out);
+		zbx_free(steps);
+		zbx_variant_clear(&value_out);
+	}
+
+	zbx_mock_assert_int_eq("unpacked tasks", tasks_num, i);
+	zbx_mock_assert_int_eq("unpacked size", message.size, offset);
+
+	zbx_ipc_message_clean(&message);
+	zbx_vector_ptr_destroy(&history);
+}
@@ -92,6 +92,22 @@ int	__wrap_DBget_user_by_active_session(const char *sessionid, zbx_user_t *user)
 	return SUCCEED;
 }
 
+void	__wrap_dc_add_history(zbx_uint64_t itemid, unsigned char item_value_type, unsigned char item_flags,
+		AGENT_RESULT *result, const zbx_timespec_t *ts, unsigned char state, const char *error)
+{
+	ZBX_UNUSED(itemid);
+	ZBX_UNUSED(item_value_type);
+	ZBX_UNUSED(item_flags);
+	ZBX_UNUSED(result);
+	ZBX_UNUSED(ts);
+	ZBX_UNUSED(state);
+	ZBX_UNUSED(error);
+}
+
+void	__wrap_dc_flush_history(void)
+{
+}
+
 void	zbx_mock_test_entry(void **state)
 {
 	const char		*request;
@@ -30,9 +30,13 @@
 
 #include "common.h"
 
+DIR		*__real_opendir(const char *name);
+struct dirent	*__real_readdir(DIR *dirp);
+
 DIR	*__wrap_opendir(const char *name)
 {
-	ZBX_UNUSED(name);
+	if (SUCCEED == zbx_mock_is_real_path(name))
+		return __real_opendir(name);
 
 	errno = ENOENT;
 	return NULL;
@@ -40,7 +44,9 @@ DIR	*__wrap_opendir(const char *name)
 
 struct dirent	*__wrap_readdir(DIR *dirp)
 {
-	ZBX_UNUSED(dirp);
+	/* only directories opened with real opendir() can be read */
+	if (NULL != dirp)
+		return __real_readdir(dirp);
 
 	errno = EBADF;
 	return NULL;
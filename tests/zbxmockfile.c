@@ -36,6 +36,7 @@
 void	*mock_streams[ZBX_MOCK_MAX_FILES];
 
 static zbx_mock_handle_t	fragments;
+static char			*real_dir;
 
 struct zbx_mock_IO_FILE
 {
@@ -72,6 +73,49 @@ static int	is_profiler_path(const char *path)
 	return FAIL;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_mock_set_real_dir                                            *
+ *                                                                            *
+ * Purpose: sets directory where files are accessed with real I/O functions   *
+ *                                                                            *
+ * Parameters: dir - [IN] the directory, NULL to mock all files               *
+ *                                                                            *
+ * Comments: Used by tests of code managing its own files, the directory      *
+ *           should be a temporary directory created by the test.             *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_mock_set_real_dir(const char *dir)
+{
+	zbx_free(real_dir);
+
+	if (NULL != dir)
+		real_dir = zbx_strdup(NULL, dir);
+}
+
+int	zbx_mock_is_real_path(const char *path)
+{
+	size_t	len;
+
+	if (NULL == real_dir)
+		return FAIL;
+
+	len = strlen(real_dir);
+
+	if (0 != strncmp(path, real_dir, len) || ('/' != path[len] && '\0' != path[len]))
+		return FAIL;
+
+	return SUCCEED;
+}
+
+static int	is_real_io_path(const char *path)
+{
+	if (SUCCEED == is_profiler_path(path))
+		return SUCCEED;
+
+	return zbx_mock_is_real_path(path);
+}
+
 static int	is_mock_stream(FILE *stream)
 {
 	int	i;
@@ -92,7 +136,7 @@ FILE	*__wrap_fopen(const char *path, const char *mode)
 	const char		*contents;
 	struct zbx_mock_IO_FILE	*file = NULL;
 
-	if (SUCCEED == is_profiler_path(path))
+	if (SUCCEED == is_real_io_path(path))
 		return __real_fopen(path, mode);
 
 	if (0 != strcmp(mode, "r"))
@@ -184,7 +228,7 @@ int	__wrap_connect(int socket, __CONST_SOCKADDR_ARG addr, socklen_t address_len)
 
 int	__wrap_open(const char *path, int oflag, ...)
 {
-	if (SUCCEED == is_profiler_path(path))
+	if (SUCCEED == is_real_io_path(path))
 	{
 		va_list	args;
 		int	fd;
@@ -251,7 +295,7 @@ int	__wrap_stat(const char *path, struct stat *buf)
 	zbx_mock_error_t	error;
 	zbx_mock_handle_t	handle;
 
-	if (SUCCEED == is_profiler_path(path))
+	if (SUCCEED == is_real_io_path(path))
 		return __real_stat(path, buf);
 
 	if (ZBX_MOCK_SUCCESS == (error = zbx_mock_file(path, &handle)))
@@ -277,7 +321,7 @@ int	__wrap___xstat(int ver, const char *pathname, struct stat *buf)
 {
 	ZBX_UNUSED(ver);
 
-	if (SUCCEED == is_profiler_path(pathname))
+	if (SUCCEED == is_real_io_path(pathname))
 		return __real_stat(pathname, buf);
 
 	return __wrap_stat(pathname, buf);
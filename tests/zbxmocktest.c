@@ -78,8 +78,16 @@ zbx_uint64_t	CONFIG_HISTORY_INDEX_CACHE_SIZE	= 4 * 0;
 zbx_uint64_t	CONFIG_TRENDS_CACHE_SIZE	= 4 * 0;
 zbx_uint64_t	CONFIG_VALUE_CACHE_SIZE		= 8 * 0;
 zbx_uint64_t	CONFIG_VMWARE_CACHE_SIZE	= 8 * 0;
+zbx_uint64_t	CONFIG_PREPROCESSING_CACHE_SIZE	= 0;
 zbx_uint64_t	CONFIG_EXPORT_FILE_SIZE;
 
+int	CONFIG_VALUE_CACHE_EVICTION	= 0;
+int	CONFIG_VALUE_CACHE_QUOTA_FLOAT	= 0;
+int	CONFIG_VALUE_CACHE_QUOTA_STR	= 0;
+int	CONFIG_VALUE_CACHE_QUOTA_LOG	= 0;
+int	CONFIG_VALUE_CACHE_QUOTA_UINT64	= 0;
+int	CONFIG_VALUE_CACHE_QUOTA_TEXT	= 0;
+
 int	CONFIG_UNREACHABLE_PERIOD	= 45;
 int	CONFIG_UNREACHABLE_DELAY	= 15;
 int	CONFIG_UNAVAILABLE_DELAY	= 60;
@@ -151,6 +159,9 @@ char	*CONFIG_SOCKET_PATH			= NULL;
 char	*CONFIG_HISTORY_STORAGE_URL		= NULL;
 char	*CONFIG_HISTORY_STORAGE_OPTS		= NULL;
 int	CONFIG_HISTORY_STORAGE_PIPELINES	= 0;
+int	CONFIG_HISTORY_STORAGE_DRAIN_TIMEOUT	= 0;
+char	*CONFIG_HISTORY_LOCAL_PATH		= NULL;
+int	CONFIG_HISTORY_LOCAL_RETENTION		= 7;
 
 const char	title_message[] = "mock_title_message";
 const char	*usage_message[] = {"mock_usage_message", NULL};